@@ -92,6 +92,8 @@ OBJS += src/ap/authsrv.c
 OBJS += src/ap/ieee802_1x.c
 OBJS += src/ap/ap_config.c
 OBJS += src/ap/eap_user_db.c
+OBJS += src/ap/eap_user_index.c
+OBJS += src/ap/mac_acl.c
 OBJS += src/ap/ieee802_11_auth.c
 OBJS += src/ap/sta_info.c
 OBJS += src/ap/wpa_auth.c
@@ -144,9 +146,14 @@ ifdef CONFIG_ELOOP_EPOLL
 L_CFLAGS += -DCONFIG_ELOOP_EPOLL
 endif
 
+ifdef CONFIG_WPABUF_POOL
+L_CFLAGS += -DCONFIG_WPABUF_POOL
+endif
+
 OBJS += src/utils/common.c
 OBJS += src/utils/wpa_debug.c
 OBJS += src/utils/wpabuf.c
+OBJS += src/utils/objpool.c
 OBJS += src/utils/os_$(CONFIG_OS).c
 OBJS += src/utils/ip_addr.c
 OBJS += src/utils/crc32.c
@@ -171,6 +178,7 @@ L_CFLAGS += -DCONFIG_NO_RADIUS
 CONFIG_NO_ACCOUNTING=y
 else
 OBJS += src/radius/radius.c
+OBJS += src/crypto/md5-mb.c
 OBJS += src/radius/radius_client.c
 OBJS += src/radius/radius_das.c
 endif
@@ -661,6 +669,10 @@ ifdef TLS_FUNCS
 OBJS += src/crypto/tls_openssl.c
 OBJS += src/crypto/tls_openssl_ocsp.c
 LIBS += -lssl
+ifdef CONFIG_TLS_SESSION_CACHE
+L_CFLAGS += -DCONFIG_TLS_SESSION_CACHE
+OBJS += src/crypto/tls_session_cache.c
+endif
 endif
 OBJS += src/crypto/crypto_openssl.c
 HOBJS += src/crypto/crypto_openssl.c
@@ -741,6 +753,7 @@ endif
 ifdef NEED_MODEXP
 OBJS += src/crypto/crypto_internal-modexp.c
 OBJS += src/tls/bignum.c
+L_CFLAGS += -DCONFIG_INTERNAL_BIGNUM
 endif
 ifeq ($(CONFIG_CRYPTO), libtomcrypt)
 OBJS += src/crypto/crypto_libtomcrypt.c
@@ -927,6 +940,10 @@ OBJS += src/crypto/sha256-prf.c
 ifdef CONFIG_INTERNAL_SHA256
 OBJS += src/crypto/sha256-internal.c
 endif
+ifdef CONFIG_INTERNAL_CRYPTO_ACCEL
+L_CFLAGS += -DCONFIG_INTERNAL_CRYPTO_ACCEL
+OBJS += src/crypto/crypto_accel.c
+endif
 ifdef NEED_TLS_PRF_SHA256
 OBJS += src/crypto/sha256-tlsprf.c
 endif
@@ -16,8 +16,10 @@
 #include "utils/crc32.h"
 #include "common/ieee802_11_defs.h"
 #include "common/sae.h"
+#include "crypto/crypto.h"
 #include "crypto/sha256.h"
 #include "crypto/tls.h"
+#include "crypto/tls_session_cache.h"
 #include "drivers/driver.h"
 #include "eap_server/eap.h"
 #include "radius/radius_client.h"
@@ -118,54 +120,8 @@ static int hostapd_config_read_vlan_file(struct hostapd_bss_config *bss,
 #endif /* CONFIG_NO_VLAN */
 
 
-int hostapd_acl_comp(const void *a, const void *b)
-{
-	const struct mac_acl_entry *aa = a;
-	const struct mac_acl_entry *bb = b;
-	return os_memcmp(aa->addr, bb->addr, sizeof(macaddr));
-}
-
-
-int hostapd_add_acl_maclist(struct mac_acl_entry **acl, int *num,
-			    int vlan_id, const u8 *addr)
-{
-	struct mac_acl_entry *newacl;
-
-	newacl = os_realloc_array(*acl, *num + 1, sizeof(**acl));
-	if (!newacl) {
-		wpa_printf(MSG_ERROR, "MAC list reallocation failed");
-		return -1;
-	}
-
-	*acl = newacl;
-	os_memcpy((*acl)[*num].addr, addr, ETH_ALEN);
-	os_memset(&(*acl)[*num].vlan_id, 0, sizeof((*acl)[*num].vlan_id));
-	(*acl)[*num].vlan_id.untagged = vlan_id;
-	(*acl)[*num].vlan_id.notempty = !!vlan_id;
-	(*num)++;
-
-	return 0;
-}
-
-
-void hostapd_remove_acl_mac(struct mac_acl_entry **acl, int *num,
-			    const u8 *addr)
-{
-	int i = 0;
-
-	while (i < *num) {
-		if (os_memcmp((*acl)[i].addr, addr, ETH_ALEN) == 0) {
-			os_remove_in_array(*acl, *num, sizeof(**acl), i);
-			(*num)--;
-		} else {
-			i++;
-		}
-	}
-}
-
-
 static int hostapd_config_read_maclist(const char *fname,
-				       struct mac_acl_entry **acl, int *num)
+				       struct hostapd_mac_acl *acl)
 {
 	FILE *f;
 	char buf[128], *pos;
@@ -210,7 +166,7 @@ static int hostapd_config_read_maclist(const char *fname,
 		}
 
 		if (rem) {
-			hostapd_remove_acl_mac(acl, num, addr);
+			hostapd_mac_acl_del(acl, addr);
 			continue;
 		}
 		vlan_id = 0;
@@ -222,7 +178,7 @@ static int hostapd_config_read_maclist(const char *fname,
 		if (*pos != '\0')
 			vlan_id = atoi(pos);
 
-		if (hostapd_add_acl_maclist(acl, num, vlan_id, addr) < 0) {
+		if (hostapd_mac_acl_add(acl, addr, vlan_id) < 0) {
 			fclose(f);
 			return -1;
 		}
@@ -230,9 +186,6 @@ static int hostapd_config_read_maclist(const char *fname,
 
 	fclose(f);
 
-	if (*acl)
-		qsort(*acl, *num, sizeof(**acl), hostapd_acl_comp);
-
 	return 0;
 }
 
@@ -614,8 +567,11 @@ static int hostapd_config_read_eap_user(const char *fname,
 	fclose(f);
 
 	if (ret == 0) {
+		hostapd_eap_user_index_free(conf->eap_user_index);
 		hostapd_config_free_eap_users(conf->eap_user);
 		conf->eap_user = new_user;
+		/* Without the index, lookups fall back to walking the list */
+		conf->eap_user_index = hostapd_eap_user_index_build(new_user);
 	} else {
 		hostapd_config_free_eap_users(new_user);
 	}
@@ -2154,6 +2110,8 @@ static unsigned int parse_tls_flags(const char *val)
 		flags |= TLS_CONN_SUITEB;
 	if (os_strstr(val, "[SUITEB-NO-ECDH]"))
 		flags |= TLS_CONN_SUITEB_NO_ECDH | TLS_CONN_SUITEB;
+	if (os_strstr(val, "[DISABLE-CERT-COMPRESSION]"))
+		flags |= TLS_CONN_DISABLE_CERT_COMPRESSION;
 
 	return flags;
 }
@@ -2349,20 +2307,27 @@ static int get_hex_config(u8 *buf, size_t max_len, int line,
 }
 
 
+/* Compare the configuration item name in buf against a keyword literal */
+#define CFG_ITEM(s) STR_HASH_MATCH(item_key, buf, s)
+
+
 static int hostapd_config_fill(struct hostapd_config *conf,
 			       struct hostapd_bss_config *bss,
 			       const char *buf, char *pos, int line)
 {
-	if (os_strcmp(buf, "interface") == 0) {
+	size_t item_len = os_strlen(buf);
+	u32 item_key = STR_HASH_KEY(buf, item_len);
+
+	if (CFG_ITEM("interface")) {
 		os_strlcpy(conf->bss[0]->iface, pos,
 			   sizeof(conf->bss[0]->iface));
-	} else if (os_strcmp(buf, "bridge") == 0) {
+	} else if (CFG_ITEM("bridge")) {
 		os_strlcpy(bss->bridge, pos, sizeof(bss->bridge));
-	} else if (os_strcmp(buf, "vlan_bridge") == 0) {
+	} else if (CFG_ITEM("vlan_bridge")) {
 		os_strlcpy(bss->vlan_bridge, pos, sizeof(bss->vlan_bridge));
-	} else if (os_strcmp(buf, "wds_bridge") == 0) {
+	} else if (CFG_ITEM("wds_bridge")) {
 		os_strlcpy(bss->wds_bridge, pos, sizeof(bss->wds_bridge));
-	} else if (os_strcmp(buf, "driver") == 0) {
+	} else if (CFG_ITEM("driver")) {
 		int j;
 		const struct wpa_driver_ops *driver = NULL;
 
@@ -2379,24 +2344,24 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		conf->driver = driver;
-	} else if (os_strcmp(buf, "driver_params") == 0) {
+	} else if (CFG_ITEM("driver_params")) {
 		os_free(conf->driver_params);
 		conf->driver_params = os_strdup(pos);
-	} else if (os_strcmp(buf, "debug") == 0) {
+	} else if (CFG_ITEM("debug")) {
 		wpa_printf(MSG_DEBUG, "Line %d: DEPRECATED: 'debug' configuration variable is not used anymore",
 			   line);
-	} else if (os_strcmp(buf, "logger_syslog_level") == 0) {
+	} else if (CFG_ITEM("logger_syslog_level")) {
 		bss->logger_syslog_level = atoi(pos);
-	} else if (os_strcmp(buf, "logger_stdout_level") == 0) {
+	} else if (CFG_ITEM("logger_stdout_level")) {
 		bss->logger_stdout_level = atoi(pos);
-	} else if (os_strcmp(buf, "logger_syslog") == 0) {
+	} else if (CFG_ITEM("logger_syslog")) {
 		bss->logger_syslog = atoi(pos);
-	} else if (os_strcmp(buf, "logger_stdout") == 0) {
+	} else if (CFG_ITEM("logger_stdout")) {
 		bss->logger_stdout = atoi(pos);
-	} else if (os_strcmp(buf, "dump_file") == 0) {
+	} else if (CFG_ITEM("dump_file")) {
 		wpa_printf(MSG_INFO, "Line %d: DEPRECATED: 'dump_file' configuration variable is not used anymore",
 			   line);
-	} else if (os_strcmp(buf, "ssid") == 0) {
+	} else if (CFG_ITEM("ssid")) {
 		struct hostapd_ssid *ssid = &bss->ssid;
 
 		ssid->ssid_len = os_strlen(pos);
@@ -2408,7 +2373,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		os_memcpy(ssid->ssid, pos, ssid->ssid_len);
 		ssid->ssid_set = 1;
 		ssid->short_ssid = crc32(ssid->ssid, ssid->ssid_len);
-	} else if (os_strcmp(buf, "ssid2") == 0) {
+	} else if (CFG_ITEM("ssid2")) {
 		struct hostapd_ssid *ssid = &bss->ssid;
 		size_t slen;
 		char *str = wpa_config_parse_string(pos, &slen);
@@ -2423,9 +2388,9 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		ssid->ssid_set = 1;
 		ssid->short_ssid = crc32(ssid->ssid, ssid->ssid_len);
 		os_free(str);
-	} else if (os_strcmp(buf, "utf8_ssid") == 0) {
+	} else if (CFG_ITEM("utf8_ssid")) {
 		bss->ssid.utf8_ssid = atoi(pos) > 0;
-	} else if (os_strcmp(buf, "macaddr_acl") == 0) {
+	} else if (CFG_ITEM("macaddr_acl")) {
 		enum macaddr_acl acl = atoi(pos);
 
 		if (acl != ACCEPT_UNLESS_DENIED &&
@@ -2436,31 +2401,49 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		bss->macaddr_acl = acl;
-	} else if (os_strcmp(buf, "accept_mac_file") == 0) {
-		if (hostapd_config_read_maclist(pos, &bss->accept_mac,
-						&bss->num_accept_mac)) {
+	} else if (CFG_ITEM("radius_acl_cache_ttl")) {
+		int val = atoi(pos);
+
+		if (val < 0 || val > 86400) {
+			wpa_printf(MSG_ERROR,
+				   "Line %d: invalid radius_acl_cache_ttl value",
+				   line);
+			return 1;
+		}
+		bss->radius_acl_cache_ttl = val;
+	} else if (CFG_ITEM("radius_acl_negative_ttl")) {
+		int val = atoi(pos);
+
+		if (val < 0 || val > 86400) {
+			wpa_printf(MSG_ERROR,
+				   "Line %d: invalid radius_acl_negative_ttl value",
+				   line);
+			return 1;
+		}
+		bss->radius_acl_negative_ttl = val;
+	} else if (CFG_ITEM("accept_mac_file")) {
+		if (hostapd_config_read_maclist(pos, &bss->accept_mac)) {
 			wpa_printf(MSG_ERROR, "Line %d: Failed to read accept_mac_file '%s'",
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "deny_mac_file") == 0) {
-		if (hostapd_config_read_maclist(pos, &bss->deny_mac,
-						&bss->num_deny_mac)) {
+	} else if (CFG_ITEM("deny_mac_file")) {
+		if (hostapd_config_read_maclist(pos, &bss->deny_mac)) {
 			wpa_printf(MSG_ERROR, "Line %d: Failed to read deny_mac_file '%s'",
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "wds_sta") == 0) {
+	} else if (CFG_ITEM("wds_sta")) {
 		bss->wds_sta = atoi(pos);
-	} else if (os_strcmp(buf, "start_disabled") == 0) {
+	} else if (CFG_ITEM("start_disabled")) {
 		bss->start_disabled = atoi(pos);
-	} else if (os_strcmp(buf, "ap_isolate") == 0) {
+	} else if (CFG_ITEM("ap_isolate")) {
 		bss->isolate = atoi(pos);
-	} else if (os_strcmp(buf, "ap_max_inactivity") == 0) {
+	} else if (CFG_ITEM("ap_max_inactivity")) {
 		bss->ap_max_inactivity = atoi(pos);
-	} else if (os_strcmp(buf, "skip_inactivity_poll") == 0) {
+	} else if (CFG_ITEM("skip_inactivity_poll")) {
 		bss->skip_inactivity_poll = atoi(pos);
-	} else if (os_strcmp(buf, "country_code") == 0) {
+	} else if (CFG_ITEM("country_code")) {
 		if (pos[0] < 'A' || pos[0] > 'Z' ||
 		    pos[1] < 'A' || pos[1] > 'Z') {
 			wpa_printf(MSG_ERROR,
@@ -2469,15 +2452,15 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		os_memcpy(conf->country, pos, 2);
-	} else if (os_strcmp(buf, "country3") == 0) {
+	} else if (CFG_ITEM("country3")) {
 		conf->country[2] = strtol(pos, NULL, 16);
-	} else if (os_strcmp(buf, "ieee80211d") == 0) {
+	} else if (CFG_ITEM("ieee80211d")) {
 		conf->ieee80211d = atoi(pos);
-	} else if (os_strcmp(buf, "ieee80211h") == 0) {
+	} else if (CFG_ITEM("ieee80211h")) {
 		conf->ieee80211h = atoi(pos);
-	} else if (os_strcmp(buf, "ieee8021x") == 0) {
+	} else if (CFG_ITEM("ieee8021x")) {
 		bss->ieee802_1x = atoi(pos);
-	} else if (os_strcmp(buf, "eapol_version") == 0) {
+	} else if (CFG_ITEM("eapol_version")) {
 		int eapol_version = atoi(pos);
 #ifdef CONFIG_MACSEC
 		int max_ver = 3;
@@ -2494,36 +2477,46 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		bss->eapol_version = eapol_version;
 		wpa_printf(MSG_DEBUG, "eapol_version=%d", bss->eapol_version);
 #ifdef EAP_SERVER
-	} else if (os_strcmp(buf, "eap_authenticator") == 0) {
+	} else if (CFG_ITEM("eap_authenticator")) {
 		bss->eap_server = atoi(pos);
 		wpa_printf(MSG_ERROR, "Line %d: obsolete eap_authenticator used; this has been renamed to eap_server", line);
-	} else if (os_strcmp(buf, "eap_server") == 0) {
+	} else if (CFG_ITEM("eap_server")) {
 		bss->eap_server = atoi(pos);
-	} else if (os_strcmp(buf, "eap_user_file") == 0) {
+	} else if (CFG_ITEM("eap_user_file")) {
 		if (hostapd_config_read_eap_user(pos, bss))
 			return 1;
-	} else if (os_strcmp(buf, "ca_cert") == 0) {
+	} else if (CFG_ITEM("eap_user_sqlite_cache")) {
+		int val = atoi(pos);
+
+		if (val < 0 || val > 65536) {
+			wpa_printf(MSG_ERROR,
+				   "Line %d: invalid eap_user_sqlite_cache value",
+				   line);
+			return 1;
+		}
+		bss->eap_user_sqlite_cache = val;
+	} else if (CFG_ITEM("ca_cert")) {
 		os_free(bss->ca_cert);
 		bss->ca_cert = os_strdup(pos);
-	} else if (os_strcmp(buf, "server_cert") == 0) {
+	} else if (CFG_ITEM("server_cert")) {
 		os_free(bss->server_cert);
 		bss->server_cert = os_strdup(pos);
-	} else if (os_strcmp(buf, "server_cert2") == 0) {
+	} else if (CFG_ITEM("server_cert2")) {
 		os_free(bss->server_cert2);
 		bss->server_cert2 = os_strdup(pos);
-	} else if (os_strcmp(buf, "private_key") == 0) {
+	} else if (CFG_ITEM("private_key")) {
 		os_free(bss->private_key);
 		bss->private_key = os_strdup(pos);
-	} else if (os_strcmp(buf, "private_key2") == 0) {
+	} else if (CFG_ITEM("private_key2")) {
 		os_free(bss->private_key2);
 		bss->private_key2 = os_strdup(pos);
-	} else if (os_strcmp(buf, "private_key_passwd") == 0) {
+	} else if (CFG_ITEM("private_key_passwd")) {
 		os_free(bss->private_key_passwd);
 		bss->private_key_passwd = os_strdup(pos);
-	} else if (os_strcmp(buf, "private_key_passwd2") == 0) {
+	} else if (CFG_ITEM("private_key_passwd2")) {
 		os_free(bss->private_key_passwd2);
 		bss->private_key_passwd2 = os_strdup(pos);
-	} else if (os_strcmp(buf, "check_cert_subject") == 0) {
+	} else if (CFG_ITEM("check_cert_subject")) {
 		if (!pos[0]) {
 			wpa_printf(MSG_ERROR, "Line %d: unknown check_cert_subject '%s'",
 				   line, pos);
@@ -2533,39 +2526,75 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		bss->check_cert_subject = os_strdup(pos);
 		if (!bss->check_cert_subject)
 			return 1;
-	} else if (os_strcmp(buf, "check_crl") == 0) {
+	} else if (CFG_ITEM("check_crl")) {
 		bss->check_crl = atoi(pos);
-	} else if (os_strcmp(buf, "check_crl_strict") == 0) {
+	} else if (CFG_ITEM("check_crl_strict")) {
 		bss->check_crl_strict = atoi(pos);
-	} else if (os_strcmp(buf, "crl_reload_interval") == 0) {
+	} else if (CFG_ITEM("crl_reload_interval")) {
 		bss->crl_reload_interval = atoi(pos);
-	} else if (os_strcmp(buf, "tls_session_lifetime") == 0) {
+	} else if (CFG_ITEM("tls_session_lifetime")) {
 		bss->tls_session_lifetime = atoi(pos);
-	} else if (os_strcmp(buf, "tls_flags") == 0) {
+	} else if (CFG_ITEM("tls_session_cache")) {
+		os_free(bss->tls_session_cache);
+		bss->tls_session_cache = os_strdup(pos);
+	} else if (CFG_ITEM("tls_session_cache_size")) {
+		int val = atoi(pos);
+
+		if (val < 0 || val > TLS_SESSION_CACHE_MAX_ENTRIES) {
+			wpa_printf(MSG_ERROR,
+				   "Line %d: invalid tls_session_cache_size value",
+				   line);
+			return 1;
+		}
+		bss->tls_session_cache_size = val;
+	} else if (CFG_ITEM("tls_verify_cache_size")) {
+		int val = atoi(pos);
+
+		if (val < 0) {
+			wpa_printf(MSG_ERROR,
+				   "Line %d: invalid tls_verify_cache_size value",
+				   line);
+			return 1;
+		}
+		bss->tls_verify_cache_size = val;
+	} else if (CFG_ITEM("tls_verify_cache_lifetime")) {
+		int val = atoi(pos);
+
+		if (val < 0 || val > 86400) {
+			wpa_printf(MSG_ERROR,
+				   "Line %d: invalid tls_verify_cache_lifetime value",
+				   line);
+			return 1;
+		}
+		bss->tls_verify_cache_lifetime = val;
+	} else if (CFG_ITEM("tls_flags")) {
 		bss->tls_flags = parse_tls_flags(pos);
-	} else if (os_strcmp(buf, "max_auth_rounds") == 0) {
+	} else if (CFG_ITEM("max_auth_rounds")) {
 		bss->max_auth_rounds = atoi(pos);
-	} else if (os_strcmp(buf, "max_auth_rounds_short") == 0) {
+	} else if (CFG_ITEM("max_auth_rounds_short")) {
 		bss->max_auth_rounds_short = atoi(pos);
-	} else if (os_strcmp(buf, "ocsp_stapling_response") == 0) {
+	} else if (CFG_ITEM("ocsp_stapling_response")) {
 		os_free(bss->ocsp_stapling_response);
 		bss->ocsp_stapling_response = os_strdup(pos);
-	} else if (os_strcmp(buf, "ocsp_stapling_response_multi") == 0) {
+	} else if (CFG_ITEM("ocsp_stapling_response2")) {
+		os_free(bss->ocsp_stapling_response2);
+		bss->ocsp_stapling_response2 = os_strdup(pos);
+	} else if (CFG_ITEM("ocsp_stapling_response_multi")) {
 		os_free(bss->ocsp_stapling_response_multi);
 		bss->ocsp_stapling_response_multi = os_strdup(pos);
-	} else if (os_strcmp(buf, "dh_file") == 0) {
+	} else if (CFG_ITEM("dh_file")) {
 		os_free(bss->dh_file);
 		bss->dh_file = os_strdup(pos);
-	} else if (os_strcmp(buf, "openssl_ciphers") == 0) {
+	} else if (CFG_ITEM("openssl_ciphers")) {
 		os_free(bss->openssl_ciphers);
 		bss->openssl_ciphers = os_strdup(pos);
-	} else if (os_strcmp(buf, "openssl_ecdh_curves") == 0) {
+	} else if (CFG_ITEM("openssl_ecdh_curves")) {
 		os_free(bss->openssl_ecdh_curves);
 		bss->openssl_ecdh_curves = os_strdup(pos);
-	} else if (os_strcmp(buf, "fragment_size") == 0) {
+	} else if (CFG_ITEM("fragment_size")) {
 		bss->fragment_size = atoi(pos);
 #ifdef EAP_SERVER_FAST
-	} else if (os_strcmp(buf, "pac_opaque_encr_key") == 0) {
+	} else if (CFG_ITEM("pac_opaque_encr_key")) {
 		os_free(bss->pac_opaque_encr_key);
 		bss->pac_opaque_encr_key = os_malloc(16);
 		if (bss->pac_opaque_encr_key == NULL) {
@@ -2578,7 +2607,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "eap_fast_a_id") == 0) {
+	} else if (CFG_ITEM("eap_fast_a_id")) {
 		size_t idlen = os_strlen(pos);
 		if (idlen & 1) {
 			wpa_printf(MSG_ERROR, "Line %d: Invalid eap_fast_a_id",
@@ -2597,18 +2626,18 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		} else {
 			bss->eap_fast_a_id_len = idlen / 2;
 		}
-	} else if (os_strcmp(buf, "eap_fast_a_id_info") == 0) {
+	} else if (CFG_ITEM("eap_fast_a_id_info")) {
 		os_free(bss->eap_fast_a_id_info);
 		bss->eap_fast_a_id_info = os_strdup(pos);
-	} else if (os_strcmp(buf, "eap_fast_prov") == 0) {
+	} else if (CFG_ITEM("eap_fast_prov")) {
 		bss->eap_fast_prov = atoi(pos);
-	} else if (os_strcmp(buf, "pac_key_lifetime") == 0) {
+	} else if (CFG_ITEM("pac_key_lifetime")) {
 		bss->pac_key_lifetime = atoi(pos);
-	} else if (os_strcmp(buf, "pac_key_refresh_time") == 0) {
+	} else if (CFG_ITEM("pac_key_refresh_time")) {
 		bss->pac_key_refresh_time = atoi(pos);
 #endif /* EAP_SERVER_FAST */
 #ifdef EAP_SERVER_TEAP
-	} else if (os_strcmp(buf, "eap_teap_auth") == 0) {
+	} else if (CFG_ITEM("eap_teap_auth")) {
 		int val = atoi(pos);
 
 		if (val < 0 || val > 2) {
@@ -2618,38 +2647,38 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		bss->eap_teap_auth = val;
-	} else if (os_strcmp(buf, "eap_teap_pac_no_inner") == 0) {
+	} else if (CFG_ITEM("eap_teap_pac_no_inner")) {
 		bss->eap_teap_pac_no_inner = atoi(pos);
-	} else if (os_strcmp(buf, "eap_teap_separate_result") == 0) {
+	} else if (CFG_ITEM("eap_teap_separate_result")) {
 		bss->eap_teap_separate_result = atoi(pos);
-	} else if (os_strcmp(buf, "eap_teap_id") == 0) {
+	} else if (CFG_ITEM("eap_teap_id")) {
 		bss->eap_teap_id = atoi(pos);
 #endif /* EAP_SERVER_TEAP */
 #ifdef EAP_SERVER_SIM
-	} else if (os_strcmp(buf, "eap_sim_db") == 0) {
+	} else if (CFG_ITEM("eap_sim_db")) {
 		os_free(bss->eap_sim_db);
 		bss->eap_sim_db = os_strdup(pos);
-	} else if (os_strcmp(buf, "eap_sim_db_timeout") == 0) {
+	} else if (CFG_ITEM("eap_sim_db_timeout")) {
 		bss->eap_sim_db_timeout = atoi(pos);
-	} else if (os_strcmp(buf, "eap_sim_aka_result_ind") == 0) {
+	} else if (CFG_ITEM("eap_sim_aka_result_ind")) {
 		bss->eap_sim_aka_result_ind = atoi(pos);
-	} else if (os_strcmp(buf, "eap_sim_id") == 0) {
+	} else if (CFG_ITEM("eap_sim_id")) {
 		bss->eap_sim_id = atoi(pos);
 #endif /* EAP_SERVER_SIM */
 #ifdef EAP_SERVER_TNC
-	} else if (os_strcmp(buf, "tnc") == 0) {
+	} else if (CFG_ITEM("tnc")) {
 		bss->tnc = atoi(pos);
 #endif /* EAP_SERVER_TNC */
 #ifdef EAP_SERVER_PWD
-	} else if (os_strcmp(buf, "pwd_group") == 0) {
+	} else if (CFG_ITEM("pwd_group")) {
 		bss->pwd_group = atoi(pos);
 #endif /* EAP_SERVER_PWD */
 #ifdef CONFIG_ERP
-	} else if (os_strcmp(buf, "eap_server_erp") == 0) {
+	} else if (CFG_ITEM("eap_server_erp")) {
 		bss->eap_server_erp = atoi(pos);
 #endif /* CONFIG_ERP */
 #endif /* EAP_SERVER */
-	} else if (os_strcmp(buf, "eap_message") == 0) {
+	} else if (CFG_ITEM("eap_message")) {
 		char *term;
 		os_free(bss->eap_req_id_text);
 		bss->eap_req_id_text = os_strdup(pos);
@@ -2667,13 +2696,13 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   (term - bss->eap_req_id_text) - 1);
 			bss->eap_req_id_text_len--;
 		}
-	} else if (os_strcmp(buf, "erp_send_reauth_start") == 0) {
+	} else if (CFG_ITEM("erp_send_reauth_start")) {
 		bss->erp_send_reauth_start = atoi(pos);
-	} else if (os_strcmp(buf, "erp_domain") == 0) {
+	} else if (CFG_ITEM("erp_domain")) {
 		os_free(bss->erp_domain);
 		bss->erp_domain = os_strdup(pos);
 #ifdef CONFIG_WEP
-	} else if (os_strcmp(buf, "wep_key_len_broadcast") == 0) {
+	} else if (CFG_ITEM("wep_key_len_broadcast")) {
 		int val = atoi(pos);
 
 		if (val < 0 || val > 13) {
@@ -2683,7 +2712,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		bss->default_wep_key_len = val;
-	} else if (os_strcmp(buf, "wep_key_len_unicast") == 0) {
+	} else if (CFG_ITEM("wep_key_len_unicast")) {
 		int val = atoi(pos);
 
 		if (val < 0 || val > 13) {
@@ -2693,7 +2722,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		bss->individual_wep_key_len = val;
-	} else if (os_strcmp(buf, "wep_rekey_period") == 0) {
+	} else if (CFG_ITEM("wep_rekey_period")) {
 		bss->wep_rekeying_period = atoi(pos);
 		if (bss->wep_rekeying_period < 0) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid period %d",
@@ -2701,31 +2730,31 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 #endif /* CONFIG_WEP */
-	} else if (os_strcmp(buf, "eap_reauth_period") == 0) {
+	} else if (CFG_ITEM("eap_reauth_period")) {
 		bss->eap_reauth_period = atoi(pos);
 		if (bss->eap_reauth_period < 0) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid period %d",
 				   line, bss->eap_reauth_period);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "eapol_key_index_workaround") == 0) {
+	} else if (CFG_ITEM("eapol_key_index_workaround")) {
 		bss->eapol_key_index_workaround = atoi(pos);
 #ifdef CONFIG_IAPP
-	} else if (os_strcmp(buf, "iapp_interface") == 0) {
+	} else if (CFG_ITEM("iapp_interface")) {
 		wpa_printf(MSG_INFO, "DEPRECATED: iapp_interface not used");
 #endif /* CONFIG_IAPP */
-	} else if (os_strcmp(buf, "own_ip_addr") == 0) {
+	} else if (CFG_ITEM("own_ip_addr")) {
 		if (hostapd_parse_ip_addr(pos, &bss->own_ip_addr)) {
 			wpa_printf(MSG_ERROR,
 				   "Line %d: invalid IP address '%s'",
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "nas_identifier") == 0) {
+	} else if (CFG_ITEM("nas_identifier")) {
 		os_free(bss->nas_identifier);
 		bss->nas_identifier = os_strdup(pos);
 #ifndef CONFIG_NO_RADIUS
-	} else if (os_strcmp(buf, "radius_client_addr") == 0) {
+	} else if (CFG_ITEM("radius_client_addr")) {
 		if (hostapd_parse_ip_addr(pos, &bss->radius->client_addr)) {
 			wpa_printf(MSG_ERROR,
 				   "Line %d: invalid IP address '%s'",
@@ -2733,10 +2762,10 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		bss->radius->force_client_addr = 1;
-	} else if (os_strcmp(buf, "radius_client_dev") == 0) {
+	} else if (CFG_ITEM("radius_client_dev")) {
 			os_free(bss->radius->force_client_dev);
 			bss->radius->force_client_dev = os_strdup(pos);
-	} else if (os_strcmp(buf, "auth_server_addr") == 0) {
+	} else if (CFG_ITEM("auth_server_addr")) {
 		if (hostapd_config_read_radius_addr(
 			    &bss->radius->auth_servers,
 			    &bss->radius->num_auth_servers, pos, 1812,
@@ -2747,7 +2776,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 	} else if (bss->radius->auth_server &&
-		   os_strcmp(buf, "auth_server_addr_replace") == 0) {
+		   CFG_ITEM("auth_server_addr_replace")) {
 		if (hostapd_parse_ip_addr(pos,
 					  &bss->radius->auth_server->addr)) {
 			wpa_printf(MSG_ERROR,
@@ -2756,10 +2785,10 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 	} else if (bss->radius->auth_server &&
-		   os_strcmp(buf, "auth_server_port") == 0) {
+		   CFG_ITEM("auth_server_port")) {
 		bss->radius->auth_server->port = atoi(pos);
 	} else if (bss->radius->auth_server &&
-		   os_strcmp(buf, "auth_server_shared_secret") == 0) {
+		   CFG_ITEM("auth_server_shared_secret")) {
 		int len = os_strlen(pos);
 		if (len == 0) {
 			/* RFC 2865, Ch. 3 */
@@ -2770,7 +2799,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		os_free(bss->radius->auth_server->shared_secret);
 		bss->radius->auth_server->shared_secret = (u8 *) os_strdup(pos);
 		bss->radius->auth_server->shared_secret_len = len;
-	} else if (os_strcmp(buf, "acct_server_addr") == 0) {
+	} else if (CFG_ITEM("acct_server_addr")) {
 		if (hostapd_config_read_radius_addr(
 			    &bss->radius->acct_servers,
 			    &bss->radius->num_acct_servers, pos, 1813,
@@ -2781,7 +2810,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 	} else if (bss->radius->acct_server &&
-		   os_strcmp(buf, "acct_server_addr_replace") == 0) {
+		   CFG_ITEM("acct_server_addr_replace")) {
 		if (hostapd_parse_ip_addr(pos,
 					  &bss->radius->acct_server->addr)) {
 			wpa_printf(MSG_ERROR,
@@ -2790,10 +2819,10 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 	} else if (bss->radius->acct_server &&
-		   os_strcmp(buf, "acct_server_port") == 0) {
+		   CFG_ITEM("acct_server_port")) {
 		bss->radius->acct_server->port = atoi(pos);
 	} else if (bss->radius->acct_server &&
-		   os_strcmp(buf, "acct_server_shared_secret") == 0) {
+		   CFG_ITEM("acct_server_shared_secret")) {
 		int len = os_strlen(pos);
 		if (len == 0) {
 			/* RFC 2865, Ch. 3 */
@@ -2804,13 +2833,23 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		os_free(bss->radius->acct_server->shared_secret);
 		bss->radius->acct_server->shared_secret = (u8 *) os_strdup(pos);
 		bss->radius->acct_server->shared_secret_len = len;
-	} else if (os_strcmp(buf, "radius_retry_primary_interval") == 0) {
+	} else if (CFG_ITEM("radius_retry_primary_interval")) {
 		bss->radius->retry_primary_interval = atoi(pos);
-	} else if (os_strcmp(buf, "radius_acct_interim_interval") == 0) {
+	} else if (CFG_ITEM("radius_acct_interim_interval")) {
 		bss->acct_interim_interval = atoi(pos);
-	} else if (os_strcmp(buf, "radius_request_cui") == 0) {
+	} else if (CFG_ITEM("radius_request_cui")) {
 		bss->radius_request_cui = atoi(pos);
-	} else if (os_strcmp(buf, "radius_auth_req_attr") == 0) {
+	} else if (CFG_ITEM("radius_framed_mtu")) {
+		int val = atoi(pos);
+
+		if (val < 100 || val > 4000) {
+			wpa_printf(MSG_ERROR,
+				   "Line %d: invalid radius_framed_mtu %d",
+				   line, val);
+			return 1;
+		}
+		bss->radius_framed_mtu = val;
+	} else if (CFG_ITEM("radius_auth_req_attr")) {
 		struct hostapd_radius_attr *attr, *a;
 		attr = hostapd_parse_radius_attr(pos);
 		if (attr == NULL) {
@@ -2826,7 +2865,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				a = a->next;
 			a->next = attr;
 		}
-	} else if (os_strcmp(buf, "radius_acct_req_attr") == 0) {
+	} else if (CFG_ITEM("radius_acct_req_attr")) {
 		struct hostapd_radius_attr *attr, *a;
 		attr = hostapd_parse_radius_attr(pos);
 		if (attr == NULL) {
@@ -2842,33 +2881,32 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				a = a->next;
 			a->next = attr;
 		}
-	} else if (os_strcmp(buf, "radius_req_attr_sqlite") == 0) {
+	} else if (CFG_ITEM("radius_req_attr_sqlite")) {
 		os_free(bss->radius_req_attr_sqlite);
 		bss->radius_req_attr_sqlite = os_strdup(pos);
-	} else if (os_strcmp(buf, "radius_das_port") == 0) {
+	} else if (CFG_ITEM("radius_das_port")) {
 		bss->radius_das_port = atoi(pos);
-	} else if (os_strcmp(buf, "radius_das_client") == 0) {
+	} else if (CFG_ITEM("radius_das_client")) {
 		if (hostapd_parse_das_client(bss, pos) < 0) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid DAS client",
 				   line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "radius_das_time_window") == 0) {
+	} else if (CFG_ITEM("radius_das_time_window")) {
 		bss->radius_das_time_window = atoi(pos);
-	} else if (os_strcmp(buf, "radius_das_require_event_timestamp") == 0) {
+	} else if (CFG_ITEM("radius_das_require_event_timestamp")) {
 		bss->radius_das_require_event_timestamp = atoi(pos);
-	} else if (os_strcmp(buf, "radius_das_require_message_authenticator") ==
-		   0) {
+	} else if (CFG_ITEM("radius_das_require_message_authenticator")) {
 		bss->radius_das_require_message_authenticator = atoi(pos);
 #endif /* CONFIG_NO_RADIUS */
-	} else if (os_strcmp(buf, "auth_algs") == 0) {
+	} else if (CFG_ITEM("auth_algs")) {
 		bss->auth_algs = atoi(pos);
 		if (bss->auth_algs == 0) {
 			wpa_printf(MSG_ERROR, "Line %d: no authentication algorithms allowed",
 				   line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "max_num_sta") == 0) {
+	} else if (CFG_ITEM("max_num_sta")) {
 		bss->max_num_sta = atoi(pos);
 		if (bss->max_num_sta < 0 ||
 		    bss->max_num_sta > MAX_STA_COUNT) {
@@ -2876,9 +2914,29 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line, bss->max_num_sta, MAX_STA_COUNT);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "wpa") == 0) {
+	} else if (CFG_ITEM("sta_pool_prealloc")) {
+		int val = atoi(pos);
+
+		if (val < 0 || val > MAX_STA_COUNT) {
+			wpa_printf(MSG_ERROR,
+				   "Line %d: Invalid sta_pool_prealloc=%d; allowed range 0..%d",
+				   line, val, MAX_STA_COUNT);
+			return 1;
+		}
+		bss->sta_pool_prealloc = val;
+	} else if (CFG_ITEM("sta_pool_max")) {
+		int val = atoi(pos);
+
+		if (val < 0 || val > MAX_STA_COUNT) {
+			wpa_printf(MSG_ERROR,
+				   "Line %d: Invalid sta_pool_max=%d; allowed range 0..%d",
+				   line, val, MAX_STA_COUNT);
+			return 1;
+		}
+		bss->sta_pool_max = val;
+	} else if (CFG_ITEM("wpa")) {
 		bss->wpa = atoi(pos);
-	} else if (os_strcmp(buf, "extended_key_id") == 0) {
+	} else if (CFG_ITEM("extended_key_id")) {
 		int val = atoi(pos);
 
 		if (val < 0 || val > 2) {
@@ -2888,16 +2946,16 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		bss->extended_key_id = val;
-	} else if (os_strcmp(buf, "wpa_group_rekey") == 0) {
+	} else if (CFG_ITEM("wpa_group_rekey")) {
 		bss->wpa_group_rekey = atoi(pos);
 		bss->wpa_group_rekey_set = 1;
-	} else if (os_strcmp(buf, "wpa_strict_rekey") == 0) {
+	} else if (CFG_ITEM("wpa_strict_rekey")) {
 		bss->wpa_strict_rekey = atoi(pos);
-	} else if (os_strcmp(buf, "wpa_gmk_rekey") == 0) {
+	} else if (CFG_ITEM("wpa_gmk_rekey")) {
 		bss->wpa_gmk_rekey = atoi(pos);
-	} else if (os_strcmp(buf, "wpa_ptk_rekey") == 0) {
+	} else if (CFG_ITEM("wpa_ptk_rekey")) {
 		bss->wpa_ptk_rekey = atoi(pos);
-	} else if (os_strcmp(buf, "wpa_deny_ptk0_rekey") == 0) {
+	} else if (CFG_ITEM("wpa_deny_ptk0_rekey")) {
 		bss->wpa_deny_ptk0_rekey = atoi(pos);
 		if (bss->wpa_deny_ptk0_rekey < 0 ||
 		    bss->wpa_deny_ptk0_rekey > 2) {
@@ -2906,7 +2964,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line, bss->wpa_deny_ptk0_rekey);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "wpa_group_update_count") == 0) {
+	} else if (CFG_ITEM("wpa_group_update_count")) {
 		char *endp;
 		unsigned long val = strtoul(pos, &endp, 0);
 
@@ -2917,7 +2975,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		bss->wpa_group_update_count = (u32) val;
-	} else if (os_strcmp(buf, "wpa_pairwise_update_count") == 0) {
+	} else if (CFG_ITEM("wpa_pairwise_update_count")) {
 		char *endp;
 		unsigned long val = strtoul(pos, &endp, 0);
 
@@ -2928,9 +2986,9 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		bss->wpa_pairwise_update_count = (u32) val;
-	} else if (os_strcmp(buf, "wpa_disable_eapol_key_retries") == 0) {
+	} else if (CFG_ITEM("wpa_disable_eapol_key_retries")) {
 		bss->wpa_disable_eapol_key_retries = atoi(pos);
-	} else if (os_strcmp(buf, "wpa_passphrase") == 0) {
+	} else if (CFG_ITEM("wpa_passphrase")) {
 		int len = os_strlen(pos);
 		if (len < 8 || len > 63) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid WPA passphrase length %d (expected 8..63)",
@@ -2943,7 +3001,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			hostapd_config_clear_wpa_psk(&bss->ssid.wpa_psk);
 			bss->ssid.wpa_passphrase_set = 1;
 		}
-	} else if (os_strcmp(buf, "wpa_psk") == 0) {
+	} else if (CFG_ITEM("wpa_psk")) {
 		hostapd_config_clear_wpa_psk(&bss->ssid.wpa_psk);
 		bss->ssid.wpa_psk = os_zalloc(sizeof(struct hostapd_wpa_psk));
 		if (bss->ssid.wpa_psk == NULL)
@@ -2959,7 +3017,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		os_free(bss->ssid.wpa_passphrase);
 		bss->ssid.wpa_passphrase = NULL;
 		bss->ssid.wpa_psk_set = 1;
-	} else if (os_strcmp(buf, "wpa_psk_file") == 0) {
+	} else if (CFG_ITEM("wpa_psk_file")) {
 		os_free(bss->ssid.wpa_psk_file);
 		bss->ssid.wpa_psk_file = os_strdup(pos);
 		if (!bss->ssid.wpa_psk_file) {
@@ -2967,11 +3025,11 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "wpa_key_mgmt") == 0) {
+	} else if (CFG_ITEM("wpa_key_mgmt")) {
 		bss->wpa_key_mgmt = hostapd_config_parse_key_mgmt(line, pos);
 		if (bss->wpa_key_mgmt == -1)
 			return 1;
-	} else if (os_strcmp(buf, "wpa_psk_radius") == 0) {
+	} else if (CFG_ITEM("wpa_psk_radius")) {
 		bss->wpa_psk_radius = atoi(pos);
 		if (bss->wpa_psk_radius != PSK_RADIUS_IGNORED &&
 		    bss->wpa_psk_radius != PSK_RADIUS_ACCEPTED &&
@@ -2981,7 +3039,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line, bss->wpa_psk_radius);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "wpa_pairwise") == 0) {
+	} else if (CFG_ITEM("wpa_pairwise")) {
 		bss->wpa_pairwise = hostapd_config_parse_cipher(line, pos);
 		if (bss->wpa_pairwise == -1 || bss->wpa_pairwise == 0)
 			return 1;
@@ -2991,7 +3049,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "rsn_pairwise") == 0) {
+	} else if (CFG_ITEM("rsn_pairwise")) {
 		bss->rsn_pairwise = hostapd_config_parse_cipher(line, pos);
 		if (bss->rsn_pairwise == -1 || bss->rsn_pairwise == 0)
 			return 1;
@@ -3001,7 +3059,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "group_cipher") == 0) {
+	} else if (CFG_ITEM("group_cipher")) {
 		bss->group_cipher = hostapd_config_parse_cipher(line, pos);
 		if (bss->group_cipher == -1 || bss->group_cipher == 0)
 			return 1;
@@ -3016,17 +3074,17 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 #ifdef CONFIG_RSN_PREAUTH
-	} else if (os_strcmp(buf, "rsn_preauth") == 0) {
+	} else if (CFG_ITEM("rsn_preauth")) {
 		bss->rsn_preauth = atoi(pos);
-	} else if (os_strcmp(buf, "rsn_preauth_interfaces") == 0) {
+	} else if (CFG_ITEM("rsn_preauth_interfaces")) {
 		os_free(bss->rsn_preauth_interfaces);
 		bss->rsn_preauth_interfaces = os_strdup(pos);
 #endif /* CONFIG_RSN_PREAUTH */
-	} else if (os_strcmp(buf, "peerkey") == 0) {
+	} else if (CFG_ITEM("peerkey")) {
 		wpa_printf(MSG_INFO,
 			   "Line %d: Obsolete peerkey parameter ignored", line);
 #ifdef CONFIG_IEEE80211R_AP
-	} else if (os_strcmp(buf, "mobility_domain") == 0) {
+	} else if (CFG_ITEM("mobility_domain")) {
 		if (os_strlen(pos) != 2 * MOBILITY_DOMAIN_ID_LEN ||
 		    hexstr2bin(pos, bss->mobility_domain,
 			       MOBILITY_DOMAIN_ID_LEN) != 0) {
@@ -3035,7 +3093,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "r1_key_holder") == 0) {
+	} else if (CFG_ITEM("r1_key_holder")) {
 		if (os_strlen(pos) != 2 * FT_R1KH_ID_LEN ||
 		    hexstr2bin(pos, bss->r1_key_holder, FT_R1KH_ID_LEN) != 0) {
 			wpa_printf(MSG_ERROR,
@@ -3043,47 +3101,47 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "r0_key_lifetime") == 0) {
+	} else if (CFG_ITEM("r0_key_lifetime")) {
 		/* DEPRECATED: Use ft_r0_key_lifetime instead. */
 		bss->r0_key_lifetime = atoi(pos) * 60;
-	} else if (os_strcmp(buf, "ft_r0_key_lifetime") == 0) {
+	} else if (CFG_ITEM("ft_r0_key_lifetime")) {
 		bss->r0_key_lifetime = atoi(pos);
-	} else if (os_strcmp(buf, "r1_max_key_lifetime") == 0) {
+	} else if (CFG_ITEM("r1_max_key_lifetime")) {
 		bss->r1_max_key_lifetime = atoi(pos);
-	} else if (os_strcmp(buf, "reassociation_deadline") == 0) {
+	} else if (CFG_ITEM("reassociation_deadline")) {
 		bss->reassociation_deadline = atoi(pos);
-	} else if (os_strcmp(buf, "rkh_pos_timeout") == 0) {
+	} else if (CFG_ITEM("rkh_pos_timeout")) {
 		bss->rkh_pos_timeout = atoi(pos);
-	} else if (os_strcmp(buf, "rkh_neg_timeout") == 0) {
+	} else if (CFG_ITEM("rkh_neg_timeout")) {
 		bss->rkh_neg_timeout = atoi(pos);
-	} else if (os_strcmp(buf, "rkh_pull_timeout") == 0) {
+	} else if (CFG_ITEM("rkh_pull_timeout")) {
 		bss->rkh_pull_timeout = atoi(pos);
-	} else if (os_strcmp(buf, "rkh_pull_retries") == 0) {
+	} else if (CFG_ITEM("rkh_pull_retries")) {
 		bss->rkh_pull_retries = atoi(pos);
-	} else if (os_strcmp(buf, "r0kh") == 0) {
+	} else if (CFG_ITEM("r0kh")) {
 		if (add_r0kh(bss, pos) < 0) {
 			wpa_printf(MSG_DEBUG, "Line %d: Invalid r0kh '%s'",
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "r1kh") == 0) {
+	} else if (CFG_ITEM("r1kh")) {
 		if (add_r1kh(bss, pos) < 0) {
 			wpa_printf(MSG_DEBUG, "Line %d: Invalid r1kh '%s'",
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "pmk_r1_push") == 0) {
+	} else if (CFG_ITEM("pmk_r1_push")) {
 		bss->pmk_r1_push = atoi(pos);
-	} else if (os_strcmp(buf, "ft_over_ds") == 0) {
+	} else if (CFG_ITEM("ft_over_ds")) {
 		bss->ft_over_ds = atoi(pos);
-	} else if (os_strcmp(buf, "ft_psk_generate_local") == 0) {
+	} else if (CFG_ITEM("ft_psk_generate_local")) {
 		bss->ft_psk_generate_local = atoi(pos);
 #endif /* CONFIG_IEEE80211R_AP */
 #ifndef CONFIG_NO_CTRL_IFACE
-	} else if (os_strcmp(buf, "ctrl_interface") == 0) {
+	} else if (CFG_ITEM("ctrl_interface")) {
 		os_free(bss->ctrl_interface);
 		bss->ctrl_interface = os_strdup(pos);
-	} else if (os_strcmp(buf, "ctrl_interface_group") == 0) {
+	} else if (CFG_ITEM("ctrl_interface_group")) {
 #ifndef CONFIG_NATIVE_WINDOWS
 		struct group *grp;
 		char *endp;
@@ -3111,19 +3169,19 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 #endif /* CONFIG_NATIVE_WINDOWS */
 #endif /* CONFIG_NO_CTRL_IFACE */
 #ifdef RADIUS_SERVER
-	} else if (os_strcmp(buf, "radius_server_clients") == 0) {
+	} else if (CFG_ITEM("radius_server_clients")) {
 		os_free(bss->radius_server_clients);
 		bss->radius_server_clients = os_strdup(pos);
-	} else if (os_strcmp(buf, "radius_server_auth_port") == 0) {
+	} else if (CFG_ITEM("radius_server_auth_port")) {
 		bss->radius_server_auth_port = atoi(pos);
-	} else if (os_strcmp(buf, "radius_server_acct_port") == 0) {
+	} else if (CFG_ITEM("radius_server_acct_port")) {
 		bss->radius_server_acct_port = atoi(pos);
-	} else if (os_strcmp(buf, "radius_server_ipv6") == 0) {
+	} else if (CFG_ITEM("radius_server_ipv6")) {
 		bss->radius_server_ipv6 = atoi(pos);
 #endif /* RADIUS_SERVER */
-	} else if (os_strcmp(buf, "use_pae_group_addr") == 0) {
+	} else if (CFG_ITEM("use_pae_group_addr")) {
 		bss->use_pae_group_addr = atoi(pos);
-	} else if (os_strcmp(buf, "hw_mode") == 0) {
+	} else if (CFG_ITEM("hw_mode")) {
 		if (os_strcmp(pos, "a") == 0)
 			conf->hw_mode = HOSTAPD_MODE_IEEE80211A;
 		else if (os_strcmp(pos, "b") == 0)
@@ -3139,7 +3197,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "wps_rf_bands") == 0) {
+	} else if (CFG_ITEM("wps_rf_bands")) {
 		if (os_strcmp(pos, "ad") == 0)
 			bss->wps_rf_bands = WPS_RF_60GHZ;
 		else if (os_strcmp(pos, "a") == 0)
@@ -3156,11 +3214,11 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "acs_exclude_dfs") == 0) {
+	} else if (CFG_ITEM("acs_exclude_dfs")) {
 		conf->acs_exclude_dfs = atoi(pos);
-	} else if (os_strcmp(buf, "op_class") == 0) {
+	} else if (CFG_ITEM("op_class")) {
 		conf->op_class = atoi(pos);
-	} else if (os_strcmp(buf, "channel") == 0) {
+	} else if (CFG_ITEM("channel")) {
 		if (os_strcmp(pos, "acs_survey") == 0) {
 #ifndef CONFIG_ACS
 			wpa_printf(MSG_ERROR, "Line %d: tries to enable ACS but CONFIG_ACS disabled",
@@ -3174,26 +3232,26 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			conf->channel = atoi(pos);
 			conf->acs = conf->channel == 0;
 		}
-	} else if (os_strcmp(buf, "edmg_channel") == 0) {
+	} else if (CFG_ITEM("edmg_channel")) {
 		conf->edmg_channel = atoi(pos);
-	} else if (os_strcmp(buf, "enable_edmg") == 0) {
+	} else if (CFG_ITEM("enable_edmg")) {
 		conf->enable_edmg = atoi(pos);
-	} else if (os_strcmp(buf, "chanlist") == 0) {
+	} else if (CFG_ITEM("chanlist")) {
 		if (hostapd_parse_chanlist(conf, pos)) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid channel list",
 				   line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "freqlist") == 0) {
+	} else if (CFG_ITEM("freqlist")) {
 		if (freq_range_list_parse(&conf->acs_freq_list, pos)) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid frequency list",
 				   line);
 			return 1;
 		}
 		conf->acs_freq_list_present = 1;
-	} else if (os_strcmp(buf, "acs_exclude_6ghz_non_psc") == 0) {
+	} else if (CFG_ITEM("acs_exclude_6ghz_non_psc")) {
 		conf->acs_exclude_6ghz_non_psc = atoi(pos);
-	} else if (os_strcmp(buf, "min_tx_power") == 0) {
+	} else if (CFG_ITEM("min_tx_power")) {
 		int val = atoi(pos);
 
 		if (val < 0 || val > 255) {
@@ -3203,7 +3261,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		conf->min_tx_power = val;
-	} else if (os_strcmp(buf, "beacon_int") == 0) {
+	} else if (CFG_ITEM("beacon_int")) {
 		int val = atoi(pos);
 		/* MIB defines range as 1..65535, but very small values
 		 * cause problems with the current implementation.
@@ -3218,7 +3276,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		}
 		conf->beacon_int = val;
 #ifdef CONFIG_ACS
-	} else if (os_strcmp(buf, "acs_num_scans") == 0) {
+	} else if (CFG_ITEM("acs_num_scans")) {
 		int val = atoi(pos);
 		if (val <= 0 || val > 100) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid acs_num_scans %d (expected 1..100)",
@@ -3226,14 +3284,14 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		conf->acs_num_scans = val;
-	} else if (os_strcmp(buf, "acs_chan_bias") == 0) {
+	} else if (CFG_ITEM("acs_chan_bias")) {
 		if (hostapd_config_parse_acs_chan_bias(conf, pos)) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid acs_chan_bias",
 				   line);
 			return -1;
 		}
 #endif /* CONFIG_ACS */
-	} else if (os_strcmp(buf, "dtim_period") == 0) {
+	} else if (CFG_ITEM("dtim_period")) {
 		int val = atoi(pos);
 
 		if (val < 1 || val > 255) {
@@ -3242,7 +3300,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		bss->dtim_period = val;
-	} else if (os_strcmp(buf, "bss_load_update_period") == 0) {
+	} else if (CFG_ITEM("bss_load_update_period")) {
 		int val = atoi(pos);
 
 		if (val < 0 || val > 100) {
@@ -3252,7 +3310,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		bss->bss_load_update_period = val;
-	} else if (os_strcmp(buf, "chan_util_avg_period") == 0) {
+	} else if (CFG_ITEM("chan_util_avg_period")) {
 		int val = atoi(pos);
 
 		if (val < 0) {
@@ -3262,7 +3320,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		bss->chan_util_avg_period = val;
-	} else if (os_strcmp(buf, "rts_threshold") == 0) {
+	} else if (CFG_ITEM("rts_threshold")) {
 		conf->rts_threshold = atoi(pos);
 		if (conf->rts_threshold < -1 || conf->rts_threshold > 65535) {
 			wpa_printf(MSG_ERROR,
@@ -3270,7 +3328,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line, conf->rts_threshold);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "fragm_threshold") == 0) {
+	} else if (CFG_ITEM("fragm_threshold")) {
 		conf->fragm_threshold = atoi(pos);
 		if (conf->fragm_threshold == -1) {
 			/* allow a value of -1 */
@@ -3281,7 +3339,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line, conf->fragm_threshold);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "send_probe_response") == 0) {
+	} else if (CFG_ITEM("send_probe_response")) {
 		int val = atoi(pos);
 		if (val != 0 && val != 1) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid send_probe_response %d (expected 0 or 1)",
@@ -3289,19 +3347,19 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		bss->send_probe_response = val;
-	} else if (os_strcmp(buf, "supported_rates") == 0) {
+	} else if (CFG_ITEM("supported_rates")) {
 		if (hostapd_parse_intlist(&conf->supported_rates, pos)) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid rate list",
 				   line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "basic_rates") == 0) {
+	} else if (CFG_ITEM("basic_rates")) {
 		if (hostapd_parse_intlist(&conf->basic_rates, pos)) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid rate list",
 				   line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "beacon_rate") == 0) {
+	} else if (CFG_ITEM("beacon_rate")) {
 		int val;
 
 		if (os_strncmp(pos, "ht:", 3) == 0) {
@@ -3345,17 +3403,17 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			conf->rate_type = BEACON_RATE_LEGACY;
 			conf->beacon_rate = val;
 		}
-	} else if (os_strcmp(buf, "preamble") == 0) {
+	} else if (CFG_ITEM("preamble")) {
 		if (atoi(pos))
 			conf->preamble = SHORT_PREAMBLE;
 		else
 			conf->preamble = LONG_PREAMBLE;
-	} else if (os_strcmp(buf, "ignore_broadcast_ssid") == 0) {
+	} else if (CFG_ITEM("ignore_broadcast_ssid")) {
 		bss->ignore_broadcast_ssid = atoi(pos);
-	} else if (os_strcmp(buf, "no_probe_resp_if_max_sta") == 0) {
+	} else if (CFG_ITEM("no_probe_resp_if_max_sta")) {
 		bss->no_probe_resp_if_max_sta = atoi(pos);
 #ifdef CONFIG_WEP
-	} else if (os_strcmp(buf, "wep_default_key") == 0) {
+	} else if (CFG_ITEM("wep_default_key")) {
 		bss->ssid.wep.idx = atoi(pos);
 		if (bss->ssid.wep.idx > 3) {
 			wpa_printf(MSG_ERROR,
@@ -3363,10 +3421,10 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   bss->ssid.wep.idx);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "wep_key0") == 0 ||
-		   os_strcmp(buf, "wep_key1") == 0 ||
-		   os_strcmp(buf, "wep_key2") == 0 ||
-		   os_strcmp(buf, "wep_key3") == 0) {
+	} else if (CFG_ITEM("wep_key0") ||
+		   CFG_ITEM("wep_key1") ||
+		   CFG_ITEM("wep_key2") ||
+		   CFG_ITEM("wep_key3")) {
 		if (hostapd_config_read_wep(&bss->ssid.wep,
 					    buf[7] - '0', pos)) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid WEP key '%s'",
@@ -3375,17 +3433,17 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		}
 #endif /* CONFIG_WEP */
 #ifndef CONFIG_NO_VLAN
-	} else if (os_strcmp(buf, "dynamic_vlan") == 0) {
+	} else if (CFG_ITEM("dynamic_vlan")) {
 		bss->ssid.dynamic_vlan = atoi(pos);
-	} else if (os_strcmp(buf, "per_sta_vif") == 0) {
+	} else if (CFG_ITEM("per_sta_vif")) {
 		bss->ssid.per_sta_vif = atoi(pos);
-	} else if (os_strcmp(buf, "vlan_file") == 0) {
+	} else if (CFG_ITEM("vlan_file")) {
 		if (hostapd_config_read_vlan_file(bss, pos)) {
 			wpa_printf(MSG_ERROR, "Line %d: failed to read VLAN file '%s'",
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "vlan_naming") == 0) {
+	} else if (CFG_ITEM("vlan_naming")) {
 		bss->ssid.vlan_naming = atoi(pos);
 		if (bss->ssid.vlan_naming >= DYNAMIC_VLAN_NAMING_END ||
 		    bss->ssid.vlan_naming < 0) {
@@ -3395,14 +3453,14 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 #ifdef CONFIG_FULL_DYNAMIC_VLAN
-	} else if (os_strcmp(buf, "vlan_tagged_interface") == 0) {
+	} else if (CFG_ITEM("vlan_tagged_interface")) {
 		os_free(bss->ssid.vlan_tagged_interface);
 		bss->ssid.vlan_tagged_interface = os_strdup(pos);
 #endif /* CONFIG_FULL_DYNAMIC_VLAN */
 #endif /* CONFIG_NO_VLAN */
-	} else if (os_strcmp(buf, "ap_table_max_size") == 0) {
+	} else if (CFG_ITEM("ap_table_max_size")) {
 		conf->ap_table_max_size = atoi(pos);
-	} else if (os_strcmp(buf, "ap_table_expiration_time") == 0) {
+	} else if (CFG_ITEM("ap_table_expiration_time")) {
 		conf->ap_table_expiration_time = atoi(pos);
 	} else if (os_strncmp(buf, "tx_queue_", 9) == 0) {
 		if (hostapd_config_tx_queue(conf->tx_queue, buf, pos)) {
@@ -3410,10 +3468,10 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "wme_enabled") == 0 ||
-		   os_strcmp(buf, "wmm_enabled") == 0) {
+	} else if (CFG_ITEM("wme_enabled") ||
+		   CFG_ITEM("wmm_enabled")) {
 		bss->wmm_enabled = atoi(pos);
-	} else if (os_strcmp(buf, "uapsd_advertisement_enabled") == 0) {
+	} else if (CFG_ITEM("uapsd_advertisement_enabled")) {
 		bss->wmm_uapsd = atoi(pos);
 	} else if (os_strncmp(buf, "wme_ac_", 7) == 0 ||
 		   os_strncmp(buf, "wmm_ac_", 7) == 0) {
@@ -3422,23 +3480,23 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "bss") == 0) {
+	} else if (CFG_ITEM("bss")) {
 		if (hostapd_config_bss(conf, pos)) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid bss item",
 				   line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "bssid") == 0) {
+	} else if (CFG_ITEM("bssid")) {
 		if (hwaddr_aton(pos, bss->bssid)) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid bssid item",
 				   line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "use_driver_iface_addr") == 0) {
+	} else if (CFG_ITEM("use_driver_iface_addr")) {
 		conf->use_driver_iface_addr = atoi(pos);
-	} else if (os_strcmp(buf, "ieee80211w") == 0) {
+	} else if (CFG_ITEM("ieee80211w")) {
 		bss->ieee80211w = atoi(pos);
-	} else if (os_strcmp(buf, "group_mgmt_cipher") == 0) {
+	} else if (CFG_ITEM("group_mgmt_cipher")) {
 		if (os_strcmp(pos, "AES-128-CMAC") == 0) {
 			bss->group_mgmt_cipher = WPA_CIPHER_AES_128_CMAC;
 		} else if (os_strcmp(pos, "BIP-GMAC-128") == 0) {
@@ -3452,16 +3510,16 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "beacon_prot") == 0) {
+	} else if (CFG_ITEM("beacon_prot")) {
 		bss->beacon_prot = atoi(pos);
-	} else if (os_strcmp(buf, "assoc_sa_query_max_timeout") == 0) {
+	} else if (CFG_ITEM("assoc_sa_query_max_timeout")) {
 		bss->assoc_sa_query_max_timeout = atoi(pos);
 		if (bss->assoc_sa_query_max_timeout == 0) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid assoc_sa_query_max_timeout",
 				   line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "assoc_sa_query_retry_timeout") == 0) {
+	} else if (CFG_ITEM("assoc_sa_query_retry_timeout")) {
 		bss->assoc_sa_query_retry_timeout = atoi(pos);
 		if (bss->assoc_sa_query_retry_timeout == 0) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid assoc_sa_query_retry_timeout",
@@ -3469,164 +3527,164 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 #ifdef CONFIG_OCV
-	} else if (os_strcmp(buf, "ocv") == 0) {
+	} else if (CFG_ITEM("ocv")) {
 		bss->ocv = atoi(pos);
 		if (bss->ocv && !bss->ieee80211w)
 			bss->ieee80211w = 1;
 #endif /* CONFIG_OCV */
-	} else if (os_strcmp(buf, "ieee80211n") == 0) {
+	} else if (CFG_ITEM("ieee80211n")) {
 		conf->ieee80211n = atoi(pos);
-	} else if (os_strcmp(buf, "ht_capab") == 0) {
+	} else if (CFG_ITEM("ht_capab")) {
 		if (hostapd_config_ht_capab(conf, pos) < 0) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid ht_capab",
 				   line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "require_ht") == 0) {
+	} else if (CFG_ITEM("require_ht")) {
 		conf->require_ht = atoi(pos);
-	} else if (os_strcmp(buf, "obss_interval") == 0) {
+	} else if (CFG_ITEM("obss_interval")) {
 		conf->obss_interval = atoi(pos);
 #ifdef CONFIG_IEEE80211AC
-	} else if (os_strcmp(buf, "ieee80211ac") == 0) {
+	} else if (CFG_ITEM("ieee80211ac")) {
 		conf->ieee80211ac = atoi(pos);
-	} else if (os_strcmp(buf, "vht_capab") == 0) {
+	} else if (CFG_ITEM("vht_capab")) {
 		if (hostapd_config_vht_capab(conf, pos) < 0) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid vht_capab",
 				   line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "require_vht") == 0) {
+	} else if (CFG_ITEM("require_vht")) {
 		conf->require_vht = atoi(pos);
-	} else if (os_strcmp(buf, "vht_oper_chwidth") == 0) {
+	} else if (CFG_ITEM("vht_oper_chwidth")) {
 		conf->vht_oper_chwidth = atoi(pos);
-	} else if (os_strcmp(buf, "vht_oper_centr_freq_seg0_idx") == 0) {
+	} else if (CFG_ITEM("vht_oper_centr_freq_seg0_idx")) {
 		conf->vht_oper_centr_freq_seg0_idx = atoi(pos);
-	} else if (os_strcmp(buf, "vht_oper_centr_freq_seg1_idx") == 0) {
+	} else if (CFG_ITEM("vht_oper_centr_freq_seg1_idx")) {
 		conf->vht_oper_centr_freq_seg1_idx = atoi(pos);
-	} else if (os_strcmp(buf, "vendor_vht") == 0) {
+	} else if (CFG_ITEM("vendor_vht")) {
 		bss->vendor_vht = atoi(pos);
-	} else if (os_strcmp(buf, "use_sta_nsts") == 0) {
+	} else if (CFG_ITEM("use_sta_nsts")) {
 		bss->use_sta_nsts = atoi(pos);
 #endif /* CONFIG_IEEE80211AC */
 #ifdef CONFIG_IEEE80211AX
-	} else if (os_strcmp(buf, "ieee80211ax") == 0) {
+	} else if (CFG_ITEM("ieee80211ax")) {
 		conf->ieee80211ax = atoi(pos);
-	} else if (os_strcmp(buf, "he_su_beamformer") == 0) {
+	} else if (CFG_ITEM("he_su_beamformer")) {
 		conf->he_phy_capab.he_su_beamformer = atoi(pos);
-	} else if (os_strcmp(buf, "he_su_beamformee") == 0) {
+	} else if (CFG_ITEM("he_su_beamformee")) {
 		conf->he_phy_capab.he_su_beamformee = atoi(pos);
-	} else if (os_strcmp(buf, "he_mu_beamformer") == 0) {
+	} else if (CFG_ITEM("he_mu_beamformer")) {
 		conf->he_phy_capab.he_mu_beamformer = atoi(pos);
-	} else if (os_strcmp(buf, "he_bss_color") == 0) {
+	} else if (CFG_ITEM("he_bss_color")) {
 		conf->he_op.he_bss_color = atoi(pos) & 0x3f;
 		conf->he_op.he_bss_color_disabled = 0;
-	} else if (os_strcmp(buf, "he_bss_color_partial") == 0) {
+	} else if (CFG_ITEM("he_bss_color_partial")) {
 		conf->he_op.he_bss_color_partial = atoi(pos);
-	} else if (os_strcmp(buf, "he_default_pe_duration") == 0) {
+	} else if (CFG_ITEM("he_default_pe_duration")) {
 		conf->he_op.he_default_pe_duration = atoi(pos);
-	} else if (os_strcmp(buf, "he_twt_required") == 0) {
+	} else if (CFG_ITEM("he_twt_required")) {
 		conf->he_op.he_twt_required = atoi(pos);
-	} else if (os_strcmp(buf, "he_twt_responder") == 0) {
+	} else if (CFG_ITEM("he_twt_responder")) {
 		conf->he_op.he_twt_responder = atoi(pos);
-	} else if (os_strcmp(buf, "he_rts_threshold") == 0) {
+	} else if (CFG_ITEM("he_rts_threshold")) {
 		conf->he_op.he_rts_threshold = atoi(pos);
-	} else if (os_strcmp(buf, "he_er_su_disable") == 0) {
+	} else if (CFG_ITEM("he_er_su_disable")) {
 		conf->he_op.he_er_su_disable = atoi(pos);
-	} else if (os_strcmp(buf, "he_basic_mcs_nss_set") == 0) {
+	} else if (CFG_ITEM("he_basic_mcs_nss_set")) {
 		conf->he_op.he_basic_mcs_nss_set = atoi(pos);
-	} else if (os_strcmp(buf, "he_mu_edca_qos_info_param_count") == 0) {
+	} else if (CFG_ITEM("he_mu_edca_qos_info_param_count")) {
 		conf->he_mu_edca.he_qos_info |=
 			set_he_cap(atoi(pos), HE_QOS_INFO_EDCA_PARAM_SET_COUNT);
-	} else if (os_strcmp(buf, "he_mu_edca_qos_info_q_ack") == 0) {
+	} else if (CFG_ITEM("he_mu_edca_qos_info_q_ack")) {
 		conf->he_mu_edca.he_qos_info |=
 			set_he_cap(atoi(pos), HE_QOS_INFO_Q_ACK);
-	} else if (os_strcmp(buf, "he_mu_edca_qos_info_queue_request") == 0) {
+	} else if (CFG_ITEM("he_mu_edca_qos_info_queue_request")) {
 		conf->he_mu_edca.he_qos_info |=
 			set_he_cap(atoi(pos), HE_QOS_INFO_QUEUE_REQUEST);
-	} else if (os_strcmp(buf, "he_mu_edca_qos_info_txop_request") == 0) {
+	} else if (CFG_ITEM("he_mu_edca_qos_info_txop_request")) {
 		conf->he_mu_edca.he_qos_info |=
 			set_he_cap(atoi(pos), HE_QOS_INFO_TXOP_REQUEST);
-	} else if (os_strcmp(buf, "he_mu_edca_ac_be_aifsn") == 0) {
+	} else if (CFG_ITEM("he_mu_edca_ac_be_aifsn")) {
 		conf->he_mu_edca.he_mu_ac_be_param[HE_MU_AC_PARAM_ACI_IDX] |=
 			set_he_cap(atoi(pos), HE_MU_AC_PARAM_AIFSN);
-	} else if (os_strcmp(buf, "he_mu_edca_ac_be_acm") == 0) {
+	} else if (CFG_ITEM("he_mu_edca_ac_be_acm")) {
 		conf->he_mu_edca.he_mu_ac_be_param[HE_MU_AC_PARAM_ACI_IDX] |=
 			set_he_cap(atoi(pos), HE_MU_AC_PARAM_ACM);
-	} else if (os_strcmp(buf, "he_mu_edca_ac_be_aci") == 0) {
+	} else if (CFG_ITEM("he_mu_edca_ac_be_aci")) {
 		conf->he_mu_edca.he_mu_ac_be_param[HE_MU_AC_PARAM_ACI_IDX] |=
 			set_he_cap(atoi(pos), HE_MU_AC_PARAM_ACI);
-	} else if (os_strcmp(buf, "he_mu_edca_ac_be_ecwmin") == 0) {
+	} else if (CFG_ITEM("he_mu_edca_ac_be_ecwmin")) {
 		conf->he_mu_edca.he_mu_ac_be_param[HE_MU_AC_PARAM_ECW_IDX] |=
 			set_he_cap(atoi(pos), HE_MU_AC_PARAM_ECWMIN);
-	} else if (os_strcmp(buf, "he_mu_edca_ac_be_ecwmax") == 0) {
+	} else if (CFG_ITEM("he_mu_edca_ac_be_ecwmax")) {
 		conf->he_mu_edca.he_mu_ac_be_param[HE_MU_AC_PARAM_ECW_IDX] |=
 			set_he_cap(atoi(pos), HE_MU_AC_PARAM_ECWMAX);
-	} else if (os_strcmp(buf, "he_mu_edca_ac_be_timer") == 0) {
+	} else if (CFG_ITEM("he_mu_edca_ac_be_timer")) {
 		conf->he_mu_edca.he_mu_ac_be_param[HE_MU_AC_PARAM_TIMER_IDX] =
 			atoi(pos) & 0xff;
-	} else if (os_strcmp(buf, "he_mu_edca_ac_bk_aifsn") == 0) {
+	} else if (CFG_ITEM("he_mu_edca_ac_bk_aifsn")) {
 		conf->he_mu_edca.he_mu_ac_bk_param[HE_MU_AC_PARAM_ACI_IDX] |=
 			set_he_cap(atoi(pos), HE_MU_AC_PARAM_AIFSN);
-	} else if (os_strcmp(buf, "he_mu_edca_ac_bk_acm") == 0) {
+	} else if (CFG_ITEM("he_mu_edca_ac_bk_acm")) {
 		conf->he_mu_edca.he_mu_ac_bk_param[HE_MU_AC_PARAM_ACI_IDX] |=
 			set_he_cap(atoi(pos), HE_MU_AC_PARAM_ACM);
-	} else if (os_strcmp(buf, "he_mu_edca_ac_bk_aci") == 0) {
+	} else if (CFG_ITEM("he_mu_edca_ac_bk_aci")) {
 		conf->he_mu_edca.he_mu_ac_bk_param[HE_MU_AC_PARAM_ACI_IDX] |=
 			set_he_cap(atoi(pos), HE_MU_AC_PARAM_ACI);
-	} else if (os_strcmp(buf, "he_mu_edca_ac_bk_ecwmin") == 0) {
+	} else if (CFG_ITEM("he_mu_edca_ac_bk_ecwmin")) {
 		conf->he_mu_edca.he_mu_ac_bk_param[HE_MU_AC_PARAM_ECW_IDX] |=
 			set_he_cap(atoi(pos), HE_MU_AC_PARAM_ECWMIN);
-	} else if (os_strcmp(buf, "he_mu_edca_ac_bk_ecwmax") == 0) {
+	} else if (CFG_ITEM("he_mu_edca_ac_bk_ecwmax")) {
 		conf->he_mu_edca.he_mu_ac_bk_param[HE_MU_AC_PARAM_ECW_IDX] |=
 			set_he_cap(atoi(pos), HE_MU_AC_PARAM_ECWMAX);
-	} else if (os_strcmp(buf, "he_mu_edca_ac_bk_timer") == 0) {
+	} else if (CFG_ITEM("he_mu_edca_ac_bk_timer")) {
 		conf->he_mu_edca.he_mu_ac_bk_param[HE_MU_AC_PARAM_TIMER_IDX] =
 			atoi(pos) & 0xff;
-	} else if (os_strcmp(buf, "he_mu_edca_ac_vi_aifsn") == 0) {
+	} else if (CFG_ITEM("he_mu_edca_ac_vi_aifsn")) {
 		conf->he_mu_edca.he_mu_ac_vi_param[HE_MU_AC_PARAM_ACI_IDX] |=
 			set_he_cap(atoi(pos), HE_MU_AC_PARAM_AIFSN);
-	} else if (os_strcmp(buf, "he_mu_edca_ac_vi_acm") == 0) {
+	} else if (CFG_ITEM("he_mu_edca_ac_vi_acm")) {
 		conf->he_mu_edca.he_mu_ac_vi_param[HE_MU_AC_PARAM_ACI_IDX] |=
 			set_he_cap(atoi(pos), HE_MU_AC_PARAM_ACM);
-	} else if (os_strcmp(buf, "he_mu_edca_ac_vi_aci") == 0) {
+	} else if (CFG_ITEM("he_mu_edca_ac_vi_aci")) {
 		conf->he_mu_edca.he_mu_ac_vi_param[HE_MU_AC_PARAM_ACI_IDX] |=
 			set_he_cap(atoi(pos), HE_MU_AC_PARAM_ACI);
-	} else if (os_strcmp(buf, "he_mu_edca_ac_vi_ecwmin") == 0) {
+	} else if (CFG_ITEM("he_mu_edca_ac_vi_ecwmin")) {
 		conf->he_mu_edca.he_mu_ac_vi_param[HE_MU_AC_PARAM_ECW_IDX] |=
 			set_he_cap(atoi(pos), HE_MU_AC_PARAM_ECWMIN);
-	} else if (os_strcmp(buf, "he_mu_edca_ac_vi_ecwmax") == 0) {
+	} else if (CFG_ITEM("he_mu_edca_ac_vi_ecwmax")) {
 		conf->he_mu_edca.he_mu_ac_vi_param[HE_MU_AC_PARAM_ECW_IDX] |=
 			set_he_cap(atoi(pos), HE_MU_AC_PARAM_ECWMAX);
-	} else if (os_strcmp(buf, "he_mu_edca_ac_vi_timer") == 0) {
+	} else if (CFG_ITEM("he_mu_edca_ac_vi_timer")) {
 		conf->he_mu_edca.he_mu_ac_vi_param[HE_MU_AC_PARAM_TIMER_IDX] =
 			atoi(pos) & 0xff;
-	} else if (os_strcmp(buf, "he_mu_edca_ac_vo_aifsn") == 0) {
+	} else if (CFG_ITEM("he_mu_edca_ac_vo_aifsn")) {
 		conf->he_mu_edca.he_mu_ac_vo_param[HE_MU_AC_PARAM_ACI_IDX] |=
 			set_he_cap(atoi(pos), HE_MU_AC_PARAM_AIFSN);
-	} else if (os_strcmp(buf, "he_mu_edca_ac_vo_acm") == 0) {
+	} else if (CFG_ITEM("he_mu_edca_ac_vo_acm")) {
 		conf->he_mu_edca.he_mu_ac_vo_param[HE_MU_AC_PARAM_ACI_IDX] |=
 			set_he_cap(atoi(pos), HE_MU_AC_PARAM_ACM);
-	} else if (os_strcmp(buf, "he_mu_edca_ac_vo_aci") == 0) {
+	} else if (CFG_ITEM("he_mu_edca_ac_vo_aci")) {
 		conf->he_mu_edca.he_mu_ac_vo_param[HE_MU_AC_PARAM_ACI_IDX] |=
 			set_he_cap(atoi(pos), HE_MU_AC_PARAM_ACI);
-	} else if (os_strcmp(buf, "he_mu_edca_ac_vo_ecwmin") == 0) {
+	} else if (CFG_ITEM("he_mu_edca_ac_vo_ecwmin")) {
 		conf->he_mu_edca.he_mu_ac_vo_param[HE_MU_AC_PARAM_ECW_IDX] |=
 			set_he_cap(atoi(pos), HE_MU_AC_PARAM_ECWMIN);
-	} else if (os_strcmp(buf, "he_mu_edca_ac_vo_ecwmax") == 0) {
+	} else if (CFG_ITEM("he_mu_edca_ac_vo_ecwmax")) {
 		conf->he_mu_edca.he_mu_ac_vo_param[HE_MU_AC_PARAM_ECW_IDX] |=
 			set_he_cap(atoi(pos), HE_MU_AC_PARAM_ECWMAX);
-	} else if (os_strcmp(buf, "he_mu_edca_ac_vo_timer") == 0) {
+	} else if (CFG_ITEM("he_mu_edca_ac_vo_timer")) {
 		conf->he_mu_edca.he_mu_ac_vo_param[HE_MU_AC_PARAM_TIMER_IDX] =
 			atoi(pos) & 0xff;
-	} else if (os_strcmp(buf, "he_spr_sr_control") == 0) {
+	} else if (CFG_ITEM("he_spr_sr_control")) {
 		conf->spr.sr_control = atoi(pos) & 0x1f;
-	} else if (os_strcmp(buf, "he_spr_non_srg_obss_pd_max_offset") == 0) {
+	} else if (CFG_ITEM("he_spr_non_srg_obss_pd_max_offset")) {
 		conf->spr.non_srg_obss_pd_max_offset = atoi(pos);
-	} else if (os_strcmp(buf, "he_spr_srg_obss_pd_min_offset") == 0) {
+	} else if (CFG_ITEM("he_spr_srg_obss_pd_min_offset")) {
 		conf->spr.srg_obss_pd_min_offset = atoi(pos);
-	} else if (os_strcmp(buf, "he_spr_srg_obss_pd_max_offset") == 0) {
+	} else if (CFG_ITEM("he_spr_srg_obss_pd_max_offset")) {
 		conf->spr.srg_obss_pd_max_offset = atoi(pos);
-	} else if (os_strcmp(buf, "he_spr_srg_bss_colors") == 0) {
+	} else if (CFG_ITEM("he_spr_srg_bss_colors")) {
 		if (hostapd_parse_he_srg_bitmap(
 			conf->spr.srg_bss_color_bitmap, pos)) {
 			wpa_printf(MSG_ERROR,
@@ -3634,7 +3692,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "he_spr_srg_partial_bssid") == 0) {
+	} else if (CFG_ITEM("he_spr_srg_partial_bssid")) {
 		if (hostapd_parse_he_srg_bitmap(
 			conf->spr.srg_partial_bssid_bitmap, pos)) {
 			wpa_printf(MSG_ERROR,
@@ -3642,21 +3700,21 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "he_oper_chwidth") == 0) {
+	} else if (CFG_ITEM("he_oper_chwidth")) {
 		conf->he_oper_chwidth = atoi(pos);
-	} else if (os_strcmp(buf, "he_oper_centr_freq_seg0_idx") == 0) {
+	} else if (CFG_ITEM("he_oper_centr_freq_seg0_idx")) {
 		conf->he_oper_centr_freq_seg0_idx = atoi(pos);
-	} else if (os_strcmp(buf, "he_oper_centr_freq_seg1_idx") == 0) {
+	} else if (CFG_ITEM("he_oper_centr_freq_seg1_idx")) {
 		conf->he_oper_centr_freq_seg1_idx = atoi(pos);
-	} else if (os_strcmp(buf, "he_6ghz_max_mpdu") == 0) {
+	} else if (CFG_ITEM("he_6ghz_max_mpdu")) {
 		conf->he_6ghz_max_mpdu = atoi(pos);
-	} else if (os_strcmp(buf, "he_6ghz_max_ampdu_len_exp") == 0) {
+	} else if (CFG_ITEM("he_6ghz_max_ampdu_len_exp")) {
 		conf->he_6ghz_max_ampdu_len_exp = atoi(pos);
-	} else if (os_strcmp(buf, "he_6ghz_rx_ant_pat") == 0) {
+	} else if (CFG_ITEM("he_6ghz_rx_ant_pat")) {
 		conf->he_6ghz_rx_ant_pat = atoi(pos);
-	} else if (os_strcmp(buf, "he_6ghz_tx_ant_pat") == 0) {
+	} else if (CFG_ITEM("he_6ghz_tx_ant_pat")) {
 		conf->he_6ghz_tx_ant_pat = atoi(pos);
-	} else if (os_strcmp(buf, "unsol_bcast_probe_resp_interval") == 0) {
+	} else if (CFG_ITEM("unsol_bcast_probe_resp_interval")) {
 		int val = atoi(pos);
 
 		if (val < 0 || val > 20) {
@@ -3667,35 +3725,35 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		}
 		bss->unsol_bcast_probe_resp_interval = val;
 #endif /* CONFIG_IEEE80211AX */
-	} else if (os_strcmp(buf, "max_listen_interval") == 0) {
+	} else if (CFG_ITEM("max_listen_interval")) {
 		bss->max_listen_interval = atoi(pos);
-	} else if (os_strcmp(buf, "disable_pmksa_caching") == 0) {
+	} else if (CFG_ITEM("disable_pmksa_caching")) {
 		bss->disable_pmksa_caching = atoi(pos);
-	} else if (os_strcmp(buf, "dot11RSNAConfigPMKLifetime") == 0) {
+	} else if (CFG_ITEM("dot11RSNAConfigPMKLifetime")) {
 		bss->dot11RSNAConfigPMKLifetime = atoi(pos);
-	} else if (os_strcmp(buf, "okc") == 0) {
+	} else if (CFG_ITEM("okc")) {
 		bss->okc = atoi(pos);
 #ifdef CONFIG_WPS
-	} else if (os_strcmp(buf, "wps_state") == 0) {
+	} else if (CFG_ITEM("wps_state")) {
 		bss->wps_state = atoi(pos);
 		if (bss->wps_state < 0 || bss->wps_state > 2) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid wps_state",
 				   line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "wps_independent") == 0) {
+	} else if (CFG_ITEM("wps_independent")) {
 		bss->wps_independent = atoi(pos);
-	} else if (os_strcmp(buf, "ap_setup_locked") == 0) {
+	} else if (CFG_ITEM("ap_setup_locked")) {
 		bss->ap_setup_locked = atoi(pos);
-	} else if (os_strcmp(buf, "uuid") == 0) {
+	} else if (CFG_ITEM("uuid")) {
 		if (uuid_str2bin(pos, bss->uuid)) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid UUID", line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "wps_pin_requests") == 0) {
+	} else if (CFG_ITEM("wps_pin_requests")) {
 		os_free(bss->wps_pin_requests);
 		bss->wps_pin_requests = os_strdup(pos);
-	} else if (os_strcmp(buf, "device_name") == 0) {
+	} else if (CFG_ITEM("device_name")) {
 		if (os_strlen(pos) > WPS_DEV_NAME_MAX_LEN) {
 			wpa_printf(MSG_ERROR, "Line %d: Too long "
 				   "device_name", line);
@@ -3703,7 +3761,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		}
 		os_free(bss->device_name);
 		bss->device_name = os_strdup(pos);
-	} else if (os_strcmp(buf, "manufacturer") == 0) {
+	} else if (CFG_ITEM("manufacturer")) {
 		if (os_strlen(pos) > 64) {
 			wpa_printf(MSG_ERROR, "Line %d: Too long manufacturer",
 				   line);
@@ -3711,7 +3769,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		}
 		os_free(bss->manufacturer);
 		bss->manufacturer = os_strdup(pos);
-	} else if (os_strcmp(buf, "model_name") == 0) {
+	} else if (CFG_ITEM("model_name")) {
 		if (os_strlen(pos) > 32) {
 			wpa_printf(MSG_ERROR, "Line %d: Too long model_name",
 				   line);
@@ -3719,7 +3777,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		}
 		os_free(bss->model_name);
 		bss->model_name = os_strdup(pos);
-	} else if (os_strcmp(buf, "model_number") == 0) {
+	} else if (CFG_ITEM("model_number")) {
 		if (os_strlen(pos) > 32) {
 			wpa_printf(MSG_ERROR, "Line %d: Too long model_number",
 				   line);
@@ -3727,7 +3785,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		}
 		os_free(bss->model_number);
 		bss->model_number = os_strdup(pos);
-	} else if (os_strcmp(buf, "serial_number") == 0) {
+	} else if (CFG_ITEM("serial_number")) {
 		if (os_strlen(pos) > 32) {
 			wpa_printf(MSG_ERROR, "Line %d: Too long serial_number",
 				   line);
@@ -3735,27 +3793,27 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		}
 		os_free(bss->serial_number);
 		bss->serial_number = os_strdup(pos);
-	} else if (os_strcmp(buf, "device_type") == 0) {
+	} else if (CFG_ITEM("device_type")) {
 		if (wps_dev_type_str2bin(pos, bss->device_type))
 			return 1;
-	} else if (os_strcmp(buf, "config_methods") == 0) {
+	} else if (CFG_ITEM("config_methods")) {
 		os_free(bss->config_methods);
 		bss->config_methods = os_strdup(pos);
-	} else if (os_strcmp(buf, "os_version") == 0) {
+	} else if (CFG_ITEM("os_version")) {
 		if (hexstr2bin(pos, bss->os_version, 4)) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid os_version",
 				   line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "ap_pin") == 0) {
+	} else if (CFG_ITEM("ap_pin")) {
 		os_free(bss->ap_pin);
 		if (*pos == '\0')
 			bss->ap_pin = NULL;
 		else
 			bss->ap_pin = os_strdup(pos);
-	} else if (os_strcmp(buf, "skip_cred_build") == 0) {
+	} else if (CFG_ITEM("skip_cred_build")) {
 		bss->skip_cred_build = atoi(pos);
-	} else if (os_strcmp(buf, "extra_cred") == 0) {
+	} else if (CFG_ITEM("extra_cred")) {
 		os_free(bss->extra_cred);
 		bss->extra_cred = (u8 *) os_readfile(pos, &bss->extra_cred_len);
 		if (bss->extra_cred == NULL) {
@@ -3763,11 +3821,11 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "wps_cred_processing") == 0) {
+	} else if (CFG_ITEM("wps_cred_processing")) {
 		bss->wps_cred_processing = atoi(pos);
-	} else if (os_strcmp(buf, "wps_cred_add_sae") == 0) {
+	} else if (CFG_ITEM("wps_cred_add_sae")) {
 		bss->wps_cred_add_sae = atoi(pos);
-	} else if (os_strcmp(buf, "ap_settings") == 0) {
+	} else if (CFG_ITEM("ap_settings")) {
 		os_free(bss->ap_settings);
 		bss->ap_settings =
 			(u8 *) os_readfile(pos, &bss->ap_settings_len);
@@ -3776,7 +3834,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "multi_ap_backhaul_ssid") == 0) {
+	} else if (CFG_ITEM("multi_ap_backhaul_ssid")) {
 		size_t slen;
 		char *str = wpa_config_parse_string(pos, &slen);
 
@@ -3790,7 +3848,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		bss->multi_ap_backhaul_ssid.ssid_len = slen;
 		bss->multi_ap_backhaul_ssid.ssid_set = 1;
 		os_free(str);
-	} else if (os_strcmp(buf, "multi_ap_backhaul_wpa_passphrase") == 0) {
+	} else if (CFG_ITEM("multi_ap_backhaul_wpa_passphrase")) {
 		int len = os_strlen(pos);
 
 		if (len < 8 || len > 63) {
@@ -3806,7 +3864,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				&bss->multi_ap_backhaul_ssid.wpa_psk);
 			bss->multi_ap_backhaul_ssid.wpa_passphrase_set = 1;
 		}
-	} else if (os_strcmp(buf, "multi_ap_backhaul_wpa_psk") == 0) {
+	} else if (CFG_ITEM("multi_ap_backhaul_wpa_psk")) {
 		hostapd_config_clear_wpa_psk(
 			&bss->multi_ap_backhaul_ssid.wpa_psk);
 		bss->multi_ap_backhaul_ssid.wpa_psk =
@@ -3826,34 +3884,34 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		os_free(bss->multi_ap_backhaul_ssid.wpa_passphrase);
 		bss->multi_ap_backhaul_ssid.wpa_passphrase = NULL;
 		bss->multi_ap_backhaul_ssid.wpa_psk_set = 1;
-	} else if (os_strcmp(buf, "upnp_iface") == 0) {
+	} else if (CFG_ITEM("upnp_iface")) {
 		os_free(bss->upnp_iface);
 		bss->upnp_iface = os_strdup(pos);
-	} else if (os_strcmp(buf, "friendly_name") == 0) {
+	} else if (CFG_ITEM("friendly_name")) {
 		os_free(bss->friendly_name);
 		bss->friendly_name = os_strdup(pos);
-	} else if (os_strcmp(buf, "manufacturer_url") == 0) {
+	} else if (CFG_ITEM("manufacturer_url")) {
 		os_free(bss->manufacturer_url);
 		bss->manufacturer_url = os_strdup(pos);
-	} else if (os_strcmp(buf, "model_description") == 0) {
+	} else if (CFG_ITEM("model_description")) {
 		os_free(bss->model_description);
 		bss->model_description = os_strdup(pos);
-	} else if (os_strcmp(buf, "model_url") == 0) {
+	} else if (CFG_ITEM("model_url")) {
 		os_free(bss->model_url);
 		bss->model_url = os_strdup(pos);
-	} else if (os_strcmp(buf, "upc") == 0) {
+	} else if (CFG_ITEM("upc")) {
 		os_free(bss->upc);
 		bss->upc = os_strdup(pos);
-	} else if (os_strcmp(buf, "pbc_in_m1") == 0) {
+	} else if (CFG_ITEM("pbc_in_m1")) {
 		bss->pbc_in_m1 = atoi(pos);
-	} else if (os_strcmp(buf, "server_id") == 0) {
+	} else if (CFG_ITEM("server_id")) {
 		os_free(bss->server_id);
 		bss->server_id = os_strdup(pos);
-	} else if (os_strcmp(buf, "wps_application_ext") == 0) {
+	} else if (CFG_ITEM("wps_application_ext")) {
 		wpabuf_free(bss->wps_application_ext);
 		bss->wps_application_ext = wpabuf_parse_bin(pos);
 #ifdef CONFIG_WPS_NFC
-	} else if (os_strcmp(buf, "wps_nfc_dev_pw_id") == 0) {
+	} else if (CFG_ITEM("wps_nfc_dev_pw_id")) {
 		bss->wps_nfc_dev_pw_id = atoi(pos);
 		if (bss->wps_nfc_dev_pw_id < 0x10 ||
 		    bss->wps_nfc_dev_pw_id > 0xffff) {
@@ -3862,52 +3920,52 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		bss->wps_nfc_pw_from_config = 1;
-	} else if (os_strcmp(buf, "wps_nfc_dh_pubkey") == 0) {
+	} else if (CFG_ITEM("wps_nfc_dh_pubkey")) {
 		wpabuf_free(bss->wps_nfc_dh_pubkey);
 		bss->wps_nfc_dh_pubkey = wpabuf_parse_bin(pos);
 		bss->wps_nfc_pw_from_config = 1;
-	} else if (os_strcmp(buf, "wps_nfc_dh_privkey") == 0) {
+	} else if (CFG_ITEM("wps_nfc_dh_privkey")) {
 		wpabuf_free(bss->wps_nfc_dh_privkey);
 		bss->wps_nfc_dh_privkey = wpabuf_parse_bin(pos);
 		bss->wps_nfc_pw_from_config = 1;
-	} else if (os_strcmp(buf, "wps_nfc_dev_pw") == 0) {
+	} else if (CFG_ITEM("wps_nfc_dev_pw")) {
 		wpabuf_free(bss->wps_nfc_dev_pw);
 		bss->wps_nfc_dev_pw = wpabuf_parse_bin(pos);
 		bss->wps_nfc_pw_from_config = 1;
 #endif /* CONFIG_WPS_NFC */
 #endif /* CONFIG_WPS */
 #ifdef CONFIG_P2P_MANAGER
-	} else if (os_strcmp(buf, "manage_p2p") == 0) {
+	} else if (CFG_ITEM("manage_p2p")) {
 		if (atoi(pos))
 			bss->p2p |= P2P_MANAGE;
 		else
 			bss->p2p &= ~P2P_MANAGE;
-	} else if (os_strcmp(buf, "allow_cross_connection") == 0) {
+	} else if (CFG_ITEM("allow_cross_connection")) {
 		if (atoi(pos))
 			bss->p2p |= P2P_ALLOW_CROSS_CONNECTION;
 		else
 			bss->p2p &= ~P2P_ALLOW_CROSS_CONNECTION;
 #endif /* CONFIG_P2P_MANAGER */
-	} else if (os_strcmp(buf, "disassoc_low_ack") == 0) {
+	} else if (CFG_ITEM("disassoc_low_ack")) {
 		bss->disassoc_low_ack = atoi(pos);
-	} else if (os_strcmp(buf, "tdls_prohibit") == 0) {
+	} else if (CFG_ITEM("tdls_prohibit")) {
 		if (atoi(pos))
 			bss->tdls |= TDLS_PROHIBIT;
 		else
 			bss->tdls &= ~TDLS_PROHIBIT;
-	} else if (os_strcmp(buf, "tdls_prohibit_chan_switch") == 0) {
+	} else if (CFG_ITEM("tdls_prohibit_chan_switch")) {
 		if (atoi(pos))
 			bss->tdls |= TDLS_PROHIBIT_CHAN_SWITCH;
 		else
 			bss->tdls &= ~TDLS_PROHIBIT_CHAN_SWITCH;
 #ifdef CONFIG_RSN_TESTING
-	} else if (os_strcmp(buf, "rsn_testing") == 0) {
+	} else if (CFG_ITEM("rsn_testing")) {
 		extern int rsn_testing;
 		rsn_testing = atoi(pos);
 #endif /* CONFIG_RSN_TESTING */
-	} else if (os_strcmp(buf, "time_advertisement") == 0) {
+	} else if (CFG_ITEM("time_advertisement")) {
 		bss->time_advertisement = atoi(pos);
-	} else if (os_strcmp(buf, "time_zone") == 0) {
+	} else if (CFG_ITEM("time_zone")) {
 		size_t tz_len = os_strlen(pos);
 		if (tz_len < 4 || tz_len > 255) {
 			wpa_printf(MSG_DEBUG, "Line %d: invalid time_zone",
@@ -3919,17 +3977,17 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		if (bss->time_zone == NULL)
 			return 1;
 #ifdef CONFIG_WNM_AP
-	} else if (os_strcmp(buf, "wnm_sleep_mode") == 0) {
+	} else if (CFG_ITEM("wnm_sleep_mode")) {
 		bss->wnm_sleep_mode = atoi(pos);
-	} else if (os_strcmp(buf, "wnm_sleep_mode_no_keys") == 0) {
+	} else if (CFG_ITEM("wnm_sleep_mode_no_keys")) {
 		bss->wnm_sleep_mode_no_keys = atoi(pos);
-	} else if (os_strcmp(buf, "bss_transition") == 0) {
+	} else if (CFG_ITEM("bss_transition")) {
 		bss->bss_transition = atoi(pos);
 #endif /* CONFIG_WNM_AP */
 #ifdef CONFIG_INTERWORKING
-	} else if (os_strcmp(buf, "interworking") == 0) {
+	} else if (CFG_ITEM("interworking")) {
 		bss->interworking = atoi(pos);
-	} else if (os_strcmp(buf, "access_network_type") == 0) {
+	} else if (CFG_ITEM("access_network_type")) {
 		bss->access_network_type = atoi(pos);
 		if (bss->access_network_type < 0 ||
 		    bss->access_network_type > 15) {
@@ -3938,35 +3996,35 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "internet") == 0) {
+	} else if (CFG_ITEM("internet")) {
 		bss->internet = atoi(pos);
-	} else if (os_strcmp(buf, "asra") == 0) {
+	} else if (CFG_ITEM("asra")) {
 		bss->asra = atoi(pos);
-	} else if (os_strcmp(buf, "esr") == 0) {
+	} else if (CFG_ITEM("esr")) {
 		bss->esr = atoi(pos);
-	} else if (os_strcmp(buf, "uesa") == 0) {
+	} else if (CFG_ITEM("uesa")) {
 		bss->uesa = atoi(pos);
-	} else if (os_strcmp(buf, "venue_group") == 0) {
+	} else if (CFG_ITEM("venue_group")) {
 		bss->venue_group = atoi(pos);
 		bss->venue_info_set = 1;
-	} else if (os_strcmp(buf, "venue_type") == 0) {
+	} else if (CFG_ITEM("venue_type")) {
 		bss->venue_type = atoi(pos);
 		bss->venue_info_set = 1;
-	} else if (os_strcmp(buf, "hessid") == 0) {
+	} else if (CFG_ITEM("hessid")) {
 		if (hwaddr_aton(pos, bss->hessid)) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid hessid", line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "roaming_consortium") == 0) {
+	} else if (CFG_ITEM("roaming_consortium")) {
 		if (parse_roaming_consortium(bss, pos, line) < 0)
 			return 1;
-	} else if (os_strcmp(buf, "venue_name") == 0) {
+	} else if (CFG_ITEM("venue_name")) {
 		if (parse_venue_name(bss, pos, line) < 0)
 			return 1;
-	} else if (os_strcmp(buf, "venue_url") == 0) {
+	} else if (CFG_ITEM("venue_url")) {
 		if (parse_venue_url(bss, pos, line) < 0)
 			return 1;
-	} else if (os_strcmp(buf, "network_auth_type") == 0) {
+	} else if (CFG_ITEM("network_auth_type")) {
 		u8 auth_type;
 		u16 redirect_url_len;
 		if (hexstr2bin(pos, &auth_type, 1)) {
@@ -3989,7 +4047,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			os_memcpy(bss->network_auth_type + 3, pos + 2,
 				  redirect_url_len);
 		bss->network_auth_type_len = 3 + redirect_url_len;
-	} else if (os_strcmp(buf, "ipaddr_type_availability") == 0) {
+	} else if (CFG_ITEM("ipaddr_type_availability")) {
 		if (hexstr2bin(pos, &bss->ipaddr_type_availability, 1)) {
 			wpa_printf(MSG_ERROR, "Line %d: Invalid ipaddr_type_availability '%s'",
 				   line, pos);
@@ -3997,7 +4055,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		bss->ipaddr_type_configured = 1;
-	} else if (os_strcmp(buf, "domain_name") == 0) {
+	} else if (CFG_ITEM("domain_name")) {
 		int j, num_domains, domain_len, domain_list_len = 0;
 		char *tok_start, *tok_prev;
 		u8 *domain_list, *domain_ptr;
@@ -4034,16 +4092,16 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		os_free(bss->domain_name);
 		bss->domain_name = domain_list;
 		bss->domain_name_len = domain_list_len;
-	} else if (os_strcmp(buf, "anqp_3gpp_cell_net") == 0) {
+	} else if (CFG_ITEM("anqp_3gpp_cell_net")) {
 		if (parse_3gpp_cell_net(bss, pos, line) < 0)
 			return 1;
-	} else if (os_strcmp(buf, "nai_realm") == 0) {
+	} else if (CFG_ITEM("nai_realm")) {
 		if (parse_nai_realm(bss, pos, line) < 0)
 			return 1;
-	} else if (os_strcmp(buf, "anqp_elem") == 0) {
+	} else if (CFG_ITEM("anqp_elem")) {
 		if (parse_anqp_elem(bss, pos, line) < 0)
 			return 1;
-	} else if (os_strcmp(buf, "gas_frag_limit") == 0) {
+	} else if (CFG_ITEM("gas_frag_limit")) {
 		int val = atoi(pos);
 
 		if (val <= 0) {
@@ -4053,25 +4111,35 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		bss->gas_frag_limit = val;
-	} else if (os_strcmp(buf, "gas_comeback_delay") == 0) {
+	} else if (CFG_ITEM("gas_comeback_delay")) {
 		bss->gas_comeback_delay = atoi(pos);
-	} else if (os_strcmp(buf, "qos_map_set") == 0) {
+	} else if (CFG_ITEM("gas_dialog_mem_limit")) {
+		int val = atoi(pos);
+
+		if (val <= 0) {
+			wpa_printf(MSG_ERROR,
+				   "Line %d: Invalid gas_dialog_mem_limit '%s'",
+				   line, pos);
+			return 1;
+		}
+		bss->gas_dialog_mem_limit = val;
+	} else if (CFG_ITEM("qos_map_set")) {
 		if (parse_qos_map_set(bss, pos, line) < 0)
 			return 1;
 #endif /* CONFIG_INTERWORKING */
 #ifdef CONFIG_RADIUS_TEST
-	} else if (os_strcmp(buf, "dump_msk_file") == 0) {
+	} else if (CFG_ITEM("dump_msk_file")) {
 		os_free(bss->dump_msk_file);
 		bss->dump_msk_file = os_strdup(pos);
 #endif /* CONFIG_RADIUS_TEST */
 #ifdef CONFIG_PROXYARP
-	} else if (os_strcmp(buf, "proxy_arp") == 0) {
+	} else if (CFG_ITEM("proxy_arp")) {
 		bss->proxy_arp = atoi(pos);
 #endif /* CONFIG_PROXYARP */
 #ifdef CONFIG_HS20
-	} else if (os_strcmp(buf, "hs20") == 0) {
+	} else if (CFG_ITEM("hs20")) {
 		bss->hs20 = atoi(pos);
-	} else if (os_strcmp(buf, "hs20_release") == 0) {
+	} else if (CFG_ITEM("hs20_release")) {
 		int val = atoi(pos);
 
 		if (val < 1 || val > (HS20_VERSION >> 4) + 1) {
@@ -4081,27 +4149,27 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		bss->hs20_release = val;
-	} else if (os_strcmp(buf, "disable_dgaf") == 0) {
+	} else if (CFG_ITEM("disable_dgaf")) {
 		bss->disable_dgaf = atoi(pos);
-	} else if (os_strcmp(buf, "na_mcast_to_ucast") == 0) {
+	} else if (CFG_ITEM("na_mcast_to_ucast")) {
 		bss->na_mcast_to_ucast = atoi(pos);
-	} else if (os_strcmp(buf, "osen") == 0) {
+	} else if (CFG_ITEM("osen")) {
 		bss->osen = atoi(pos);
-	} else if (os_strcmp(buf, "anqp_domain_id") == 0) {
+	} else if (CFG_ITEM("anqp_domain_id")) {
 		bss->anqp_domain_id = atoi(pos);
-	} else if (os_strcmp(buf, "hs20_deauth_req_timeout") == 0) {
+	} else if (CFG_ITEM("hs20_deauth_req_timeout")) {
 		bss->hs20_deauth_req_timeout = atoi(pos);
-	} else if (os_strcmp(buf, "hs20_oper_friendly_name") == 0) {
+	} else if (CFG_ITEM("hs20_oper_friendly_name")) {
 		if (hs20_parse_oper_friendly_name(bss, pos, line) < 0)
 			return 1;
-	} else if (os_strcmp(buf, "hs20_wan_metrics") == 0) {
+	} else if (CFG_ITEM("hs20_wan_metrics")) {
 		if (hs20_parse_wan_metrics(bss, pos, line) < 0)
 			return 1;
-	} else if (os_strcmp(buf, "hs20_conn_capab") == 0) {
+	} else if (CFG_ITEM("hs20_conn_capab")) {
 		if (hs20_parse_conn_capab(bss, pos, line) < 0) {
 			return 1;
 		}
-	} else if (os_strcmp(buf, "hs20_operating_class") == 0) {
+	} else if (CFG_ITEM("hs20_operating_class")) {
 		u8 *oper_class;
 		size_t oper_class_len;
 		oper_class_len = os_strlen(pos);
@@ -4125,67 +4193,67 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		os_free(bss->hs20_operating_class);
 		bss->hs20_operating_class = oper_class;
 		bss->hs20_operating_class_len = oper_class_len;
-	} else if (os_strcmp(buf, "hs20_icon") == 0) {
+	} else if (CFG_ITEM("hs20_icon")) {
 		if (hs20_parse_icon(bss, pos) < 0) {
 			wpa_printf(MSG_ERROR, "Line %d: Invalid hs20_icon '%s'",
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "osu_ssid") == 0) {
+	} else if (CFG_ITEM("osu_ssid")) {
 		if (hs20_parse_osu_ssid(bss, pos, line) < 0)
 			return 1;
-	} else if (os_strcmp(buf, "osu_server_uri") == 0) {
+	} else if (CFG_ITEM("osu_server_uri")) {
 		if (hs20_parse_osu_server_uri(bss, pos, line) < 0)
 			return 1;
-	} else if (os_strcmp(buf, "osu_friendly_name") == 0) {
+	} else if (CFG_ITEM("osu_friendly_name")) {
 		if (hs20_parse_osu_friendly_name(bss, pos, line) < 0)
 			return 1;
-	} else if (os_strcmp(buf, "osu_nai") == 0) {
+	} else if (CFG_ITEM("osu_nai")) {
 		if (hs20_parse_osu_nai(bss, pos, line) < 0)
 			return 1;
-	} else if (os_strcmp(buf, "osu_nai2") == 0) {
+	} else if (CFG_ITEM("osu_nai2")) {
 		if (hs20_parse_osu_nai2(bss, pos, line) < 0)
 			return 1;
-	} else if (os_strcmp(buf, "osu_method_list") == 0) {
+	} else if (CFG_ITEM("osu_method_list")) {
 		if (hs20_parse_osu_method_list(bss, pos, line) < 0)
 			return 1;
-	} else if (os_strcmp(buf, "osu_icon") == 0) {
+	} else if (CFG_ITEM("osu_icon")) {
 		if (hs20_parse_osu_icon(bss, pos, line) < 0)
 			return 1;
-	} else if (os_strcmp(buf, "osu_service_desc") == 0) {
+	} else if (CFG_ITEM("osu_service_desc")) {
 		if (hs20_parse_osu_service_desc(bss, pos, line) < 0)
 			return 1;
-	} else if (os_strcmp(buf, "operator_icon") == 0) {
+	} else if (CFG_ITEM("operator_icon")) {
 		if (hs20_parse_operator_icon(bss, pos, line) < 0)
 			return 1;
-	} else if (os_strcmp(buf, "subscr_remediation_url") == 0) {
+	} else if (CFG_ITEM("subscr_remediation_url")) {
 		os_free(bss->subscr_remediation_url);
 		bss->subscr_remediation_url = os_strdup(pos);
-	} else if (os_strcmp(buf, "subscr_remediation_method") == 0) {
+	} else if (CFG_ITEM("subscr_remediation_method")) {
 		bss->subscr_remediation_method = atoi(pos);
-	} else if (os_strcmp(buf, "hs20_t_c_filename") == 0) {
+	} else if (CFG_ITEM("hs20_t_c_filename")) {
 		os_free(bss->t_c_filename);
 		bss->t_c_filename = os_strdup(pos);
-	} else if (os_strcmp(buf, "hs20_t_c_timestamp") == 0) {
+	} else if (CFG_ITEM("hs20_t_c_timestamp")) {
 		bss->t_c_timestamp = strtol(pos, NULL, 0);
-	} else if (os_strcmp(buf, "hs20_t_c_server_url") == 0) {
+	} else if (CFG_ITEM("hs20_t_c_server_url")) {
 		os_free(bss->t_c_server_url);
 		bss->t_c_server_url = os_strdup(pos);
-	} else if (os_strcmp(buf, "hs20_sim_provisioning_url") == 0) {
+	} else if (CFG_ITEM("hs20_sim_provisioning_url")) {
 		os_free(bss->hs20_sim_provisioning_url);
 		bss->hs20_sim_provisioning_url = os_strdup(pos);
 #endif /* CONFIG_HS20 */
 #ifdef CONFIG_MBO
-	} else if (os_strcmp(buf, "mbo") == 0) {
+	} else if (CFG_ITEM("mbo")) {
 		bss->mbo_enabled = atoi(pos);
-	} else if (os_strcmp(buf, "mbo_cell_data_conn_pref") == 0) {
+	} else if (CFG_ITEM("mbo_cell_data_conn_pref")) {
 		bss->mbo_cell_data_conn_pref = atoi(pos);
-	} else if (os_strcmp(buf, "oce") == 0) {
+	} else if (CFG_ITEM("oce")) {
 		bss->oce = atoi(pos);
 #endif /* CONFIG_MBO */
 #ifdef CONFIG_TESTING_OPTIONS
 #define PARSE_TEST_PROBABILITY(_val)				\
-	} else if (os_strcmp(buf, #_val) == 0) {		\
+	} else if (CFG_ITEM(#_val)) {			\
 		char *end;					\
 								\
 		conf->_val = strtod(pos, &end);			\
@@ -4201,9 +4269,9 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 	PARSE_TEST_PROBABILITY(ignore_assoc_probability)
 	PARSE_TEST_PROBABILITY(ignore_reassoc_probability)
 	PARSE_TEST_PROBABILITY(corrupt_gtk_rekey_mic_probability)
-	} else if (os_strcmp(buf, "ecsa_ie_only") == 0) {
+	} else if (CFG_ITEM("ecsa_ie_only")) {
 		conf->ecsa_ie_only = atoi(pos);
-	} else if (os_strcmp(buf, "bss_load_test") == 0) {
+	} else if (CFG_ITEM("bss_load_test")) {
 		WPA_PUT_LE16(bss->bss_load_test, atoi(pos));
 		pos = os_strchr(pos, ':');
 		if (pos == NULL) {
@@ -4222,7 +4290,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		pos++;
 		WPA_PUT_LE16(&bss->bss_load_test[3], atoi(pos));
 		bss->bss_load_test_set = 1;
-	} else if (os_strcmp(buf, "radio_measurements") == 0) {
+	} else if (CFG_ITEM("radio_measurements")) {
 		/*
 		 * DEPRECATED: This parameter will be removed in the future.
 		 * Use rrm_neighbor_report instead.
@@ -4232,7 +4300,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		if (val & BIT(0))
 			bss->radio_measurements[0] |=
 				WLAN_RRM_CAPS_NEIGHBOR_REPORT;
-	} else if (os_strcmp(buf, "own_ie_override") == 0) {
+	} else if (CFG_ITEM("own_ie_override")) {
 		struct wpabuf *tmp;
 		size_t len = os_strlen(pos) / 2;
 
@@ -4250,89 +4318,89 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 
 		wpabuf_free(bss->own_ie_override);
 		bss->own_ie_override = tmp;
-	} else if (os_strcmp(buf, "sae_reflection_attack") == 0) {
+	} else if (CFG_ITEM("sae_reflection_attack")) {
 		bss->sae_reflection_attack = atoi(pos);
-	} else if (os_strcmp(buf, "sae_commit_status") == 0) {
+	} else if (CFG_ITEM("sae_commit_status")) {
 		bss->sae_commit_status = atoi(pos);
-	} else if (os_strcmp(buf, "sae_pk_omit") == 0) {
+	} else if (CFG_ITEM("sae_pk_omit")) {
 		bss->sae_pk_omit = atoi(pos);
-	} else if (os_strcmp(buf, "sae_pk_password_check_skip") == 0) {
+	} else if (CFG_ITEM("sae_pk_password_check_skip")) {
 		bss->sae_pk_password_check_skip = atoi(pos);
-	} else if (os_strcmp(buf, "sae_commit_override") == 0) {
+	} else if (CFG_ITEM("sae_commit_override")) {
 		wpabuf_free(bss->sae_commit_override);
 		bss->sae_commit_override = wpabuf_parse_bin(pos);
-	} else if (os_strcmp(buf, "rsne_override_eapol") == 0) {
+	} else if (CFG_ITEM("rsne_override_eapol")) {
 		wpabuf_free(bss->rsne_override_eapol);
 		bss->rsne_override_eapol = wpabuf_parse_bin(pos);
-	} else if (os_strcmp(buf, "rsnxe_override_eapol") == 0) {
+	} else if (CFG_ITEM("rsnxe_override_eapol")) {
 		wpabuf_free(bss->rsnxe_override_eapol);
 		bss->rsnxe_override_eapol = wpabuf_parse_bin(pos);
-	} else if (os_strcmp(buf, "rsne_override_ft") == 0) {
+	} else if (CFG_ITEM("rsne_override_ft")) {
 		wpabuf_free(bss->rsne_override_ft);
 		bss->rsne_override_ft = wpabuf_parse_bin(pos);
-	} else if (os_strcmp(buf, "rsnxe_override_ft") == 0) {
+	} else if (CFG_ITEM("rsnxe_override_ft")) {
 		wpabuf_free(bss->rsnxe_override_ft);
 		bss->rsnxe_override_ft = wpabuf_parse_bin(pos);
-	} else if (os_strcmp(buf, "gtk_rsc_override") == 0) {
+	} else if (CFG_ITEM("gtk_rsc_override")) {
 		wpabuf_free(bss->gtk_rsc_override);
 		bss->gtk_rsc_override = wpabuf_parse_bin(pos);
-	} else if (os_strcmp(buf, "igtk_rsc_override") == 0) {
+	} else if (CFG_ITEM("igtk_rsc_override")) {
 		wpabuf_free(bss->igtk_rsc_override);
 		bss->igtk_rsc_override = wpabuf_parse_bin(pos);
-	} else if (os_strcmp(buf, "no_beacon_rsnxe") == 0) {
+	} else if (CFG_ITEM("no_beacon_rsnxe")) {
 		bss->no_beacon_rsnxe = atoi(pos);
-	} else if (os_strcmp(buf, "skip_prune_assoc") == 0) {
+	} else if (CFG_ITEM("skip_prune_assoc")) {
 		bss->skip_prune_assoc = atoi(pos);
-	} else if (os_strcmp(buf, "ft_rsnxe_used") == 0) {
+	} else if (CFG_ITEM("ft_rsnxe_used")) {
 		bss->ft_rsnxe_used = atoi(pos);
-	} else if (os_strcmp(buf, "oci_freq_override_eapol_m3") == 0) {
+	} else if (CFG_ITEM("oci_freq_override_eapol_m3")) {
 		bss->oci_freq_override_eapol_m3 = atoi(pos);
-	} else if (os_strcmp(buf, "oci_freq_override_eapol_g1") == 0) {
+	} else if (CFG_ITEM("oci_freq_override_eapol_g1")) {
 		bss->oci_freq_override_eapol_g1 = atoi(pos);
-	} else if (os_strcmp(buf, "oci_freq_override_saquery_req") == 0) {
+	} else if (CFG_ITEM("oci_freq_override_saquery_req")) {
 		bss->oci_freq_override_saquery_req = atoi(pos);
-	} else if (os_strcmp(buf, "oci_freq_override_saquery_resp") == 0) {
+	} else if (CFG_ITEM("oci_freq_override_saquery_resp")) {
 		bss->oci_freq_override_saquery_resp = atoi(pos);
-	} else if (os_strcmp(buf, "oci_freq_override_ft_assoc") == 0) {
+	} else if (CFG_ITEM("oci_freq_override_ft_assoc")) {
 		bss->oci_freq_override_ft_assoc = atoi(pos);
-	} else if (os_strcmp(buf, "oci_freq_override_fils_assoc") == 0) {
+	} else if (CFG_ITEM("oci_freq_override_fils_assoc")) {
 		bss->oci_freq_override_fils_assoc = atoi(pos);
-	} else if (os_strcmp(buf, "oci_freq_override_wnm_sleep") == 0) {
+	} else if (CFG_ITEM("oci_freq_override_wnm_sleep")) {
 		bss->oci_freq_override_wnm_sleep = atoi(pos);
 #endif /* CONFIG_TESTING_OPTIONS */
 #ifdef CONFIG_SAE
-	} else if (os_strcmp(buf, "sae_password") == 0) {
+	} else if (CFG_ITEM("sae_password")) {
 		if (parse_sae_password(bss, pos) < 0) {
 			wpa_printf(MSG_ERROR, "Line %d: Invalid sae_password",
 				   line);
 			return 1;
 		}
 #endif /* CONFIG_SAE */
-	} else if (os_strcmp(buf, "vendor_elements") == 0) {
+	} else if (CFG_ITEM("vendor_elements")) {
 		if (parse_wpabuf_hex(line, buf, &bss->vendor_elements, pos))
 			return 1;
-	} else if (os_strcmp(buf, "assocresp_elements") == 0) {
+	} else if (CFG_ITEM("assocresp_elements")) {
 		if (parse_wpabuf_hex(line, buf, &bss->assocresp_elements, pos))
 			return 1;
-	} else if (os_strcmp(buf, "sae_anti_clogging_threshold") == 0 ||
-		   os_strcmp(buf, "anti_clogging_threshold") == 0) {
+	} else if (CFG_ITEM("sae_anti_clogging_threshold") ||
+		   CFG_ITEM("anti_clogging_threshold")) {
 		bss->anti_clogging_threshold = atoi(pos);
-	} else if (os_strcmp(buf, "sae_sync") == 0) {
+	} else if (CFG_ITEM("sae_sync")) {
 		bss->sae_sync = atoi(pos);
-	} else if (os_strcmp(buf, "sae_groups") == 0) {
+	} else if (CFG_ITEM("sae_groups")) {
 		if (hostapd_parse_intlist(&bss->sae_groups, pos)) {
 			wpa_printf(MSG_ERROR,
 				   "Line %d: Invalid sae_groups value '%s'",
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "sae_require_mfp") == 0) {
+	} else if (CFG_ITEM("sae_require_mfp")) {
 		bss->sae_require_mfp = atoi(pos);
-	} else if (os_strcmp(buf, "sae_confirm_immediate") == 0) {
+	} else if (CFG_ITEM("sae_confirm_immediate")) {
 		bss->sae_confirm_immediate = atoi(pos);
-	} else if (os_strcmp(buf, "sae_pwe") == 0) {
+	} else if (CFG_ITEM("sae_pwe")) {
 		bss->sae_pwe = atoi(pos);
-	} else if (os_strcmp(buf, "local_pwr_constraint") == 0) {
+	} else if (CFG_ITEM("local_pwr_constraint")) {
 		int val = atoi(pos);
 		if (val < 0 || val > 255) {
 			wpa_printf(MSG_ERROR, "Line %d: Invalid local_pwr_constraint %d (expected 0..255)",
@@ -4340,13 +4408,13 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		conf->local_pwr_constraint = val;
-	} else if (os_strcmp(buf, "spectrum_mgmt_required") == 0) {
+	} else if (CFG_ITEM("spectrum_mgmt_required")) {
 		conf->spectrum_mgmt_required = atoi(pos);
-	} else if (os_strcmp(buf, "wowlan_triggers") == 0) {
+	} else if (CFG_ITEM("wowlan_triggers")) {
 		os_free(bss->wowlan_triggers);
 		bss->wowlan_triggers = os_strdup(pos);
 #ifdef CONFIG_FST
-	} else if (os_strcmp(buf, "fst_group_id") == 0) {
+	} else if (CFG_ITEM("fst_group_id")) {
 		size_t len = os_strlen(pos);
 
 		if (!len || len >= sizeof(conf->fst_cfg.group_id)) {
@@ -4365,7 +4433,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 
 		os_strlcpy(conf->fst_cfg.group_id, pos,
 			   sizeof(conf->fst_cfg.group_id));
-	} else if (os_strcmp(buf, "fst_priority") == 0) {
+	} else if (CFG_ITEM("fst_priority")) {
 		char *endp;
 		long int val;
 
@@ -4384,7 +4452,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		conf->fst_cfg.priority = (u8) val;
-	} else if (os_strcmp(buf, "fst_llt") == 0) {
+	} else if (CFG_ITEM("fst_llt")) {
 		char *endp;
 		long int val;
 
@@ -4404,50 +4472,50 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		}
 		conf->fst_cfg.llt = (u32) val;
 #endif /* CONFIG_FST */
-	} else if (os_strcmp(buf, "track_sta_max_num") == 0) {
+	} else if (CFG_ITEM("track_sta_max_num")) {
 		conf->track_sta_max_num = atoi(pos);
-	} else if (os_strcmp(buf, "track_sta_max_age") == 0) {
+	} else if (CFG_ITEM("track_sta_max_age")) {
 		conf->track_sta_max_age = atoi(pos);
-	} else if (os_strcmp(buf, "no_probe_resp_if_seen_on") == 0) {
+	} else if (CFG_ITEM("no_probe_resp_if_seen_on")) {
 		os_free(bss->no_probe_resp_if_seen_on);
 		bss->no_probe_resp_if_seen_on = os_strdup(pos);
-	} else if (os_strcmp(buf, "no_auth_if_seen_on") == 0) {
+	} else if (CFG_ITEM("no_auth_if_seen_on")) {
 		os_free(bss->no_auth_if_seen_on);
 		bss->no_auth_if_seen_on = os_strdup(pos);
-	} else if (os_strcmp(buf, "lci") == 0) {
+	} else if (CFG_ITEM("lci")) {
 		wpabuf_free(conf->lci);
 		conf->lci = wpabuf_parse_bin(pos);
 		if (conf->lci && wpabuf_len(conf->lci) == 0) {
 			wpabuf_free(conf->lci);
 			conf->lci = NULL;
 		}
-	} else if (os_strcmp(buf, "civic") == 0) {
+	} else if (CFG_ITEM("civic")) {
 		wpabuf_free(conf->civic);
 		conf->civic = wpabuf_parse_bin(pos);
 		if (conf->civic && wpabuf_len(conf->civic) == 0) {
 			wpabuf_free(conf->civic);
 			conf->civic = NULL;
 		}
-	} else if (os_strcmp(buf, "rrm_neighbor_report") == 0) {
+	} else if (CFG_ITEM("rrm_neighbor_report")) {
 		if (atoi(pos))
 			bss->radio_measurements[0] |=
 				WLAN_RRM_CAPS_NEIGHBOR_REPORT;
-	} else if (os_strcmp(buf, "rrm_beacon_report") == 0) {
+	} else if (CFG_ITEM("rrm_beacon_report")) {
 		if (atoi(pos))
 			bss->radio_measurements[0] |=
 				WLAN_RRM_CAPS_BEACON_REPORT_PASSIVE |
 				WLAN_RRM_CAPS_BEACON_REPORT_ACTIVE |
 				WLAN_RRM_CAPS_BEACON_REPORT_TABLE;
-	} else if (os_strcmp(buf, "gas_address3") == 0) {
+	} else if (CFG_ITEM("gas_address3")) {
 		bss->gas_address3 = atoi(pos);
-	} else if (os_strcmp(buf, "stationary_ap") == 0) {
+	} else if (CFG_ITEM("stationary_ap")) {
 		conf->stationary_ap = atoi(pos);
-	} else if (os_strcmp(buf, "ftm_responder") == 0) {
+	} else if (CFG_ITEM("ftm_responder")) {
 		bss->ftm_responder = atoi(pos);
-	} else if (os_strcmp(buf, "ftm_initiator") == 0) {
+	} else if (CFG_ITEM("ftm_initiator")) {
 		bss->ftm_initiator = atoi(pos);
 #ifdef CONFIG_FILS
-	} else if (os_strcmp(buf, "fils_cache_id") == 0) {
+	} else if (CFG_ITEM("fils_cache_id")) {
 		if (hexstr2bin(pos, bss->fils_cache_id, FILS_CACHE_ID_LEN)) {
 			wpa_printf(MSG_ERROR,
 				   "Line %d: Invalid fils_cache_id '%s'",
@@ -4455,62 +4523,62 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		bss->fils_cache_id_set = 1;
-	} else if (os_strcmp(buf, "fils_realm") == 0) {
+	} else if (CFG_ITEM("fils_realm")) {
 		if (parse_fils_realm(bss, pos) < 0)
 			return 1;
-	} else if (os_strcmp(buf, "fils_dh_group") == 0) {
+	} else if (CFG_ITEM("fils_dh_group")) {
 		bss->fils_dh_group = atoi(pos);
-	} else if (os_strcmp(buf, "dhcp_server") == 0) {
+	} else if (CFG_ITEM("dhcp_server")) {
 		if (hostapd_parse_ip_addr(pos, &bss->dhcp_server)) {
 			wpa_printf(MSG_ERROR,
 				   "Line %d: invalid IP address '%s'",
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "dhcp_rapid_commit_proxy") == 0) {
+	} else if (CFG_ITEM("dhcp_rapid_commit_proxy")) {
 		bss->dhcp_rapid_commit_proxy = atoi(pos);
-	} else if (os_strcmp(buf, "fils_hlp_wait_time") == 0) {
+	} else if (CFG_ITEM("fils_hlp_wait_time")) {
 		bss->fils_hlp_wait_time = atoi(pos);
-	} else if (os_strcmp(buf, "dhcp_server_port") == 0) {
+	} else if (CFG_ITEM("dhcp_server_port")) {
 		bss->dhcp_server_port = atoi(pos);
-	} else if (os_strcmp(buf, "dhcp_relay_port") == 0) {
+	} else if (CFG_ITEM("dhcp_relay_port")) {
 		bss->dhcp_relay_port = atoi(pos);
-	} else if (os_strcmp(buf, "fils_discovery_min_interval") == 0) {
+	} else if (CFG_ITEM("fils_discovery_min_interval")) {
 		bss->fils_discovery_min_int = atoi(pos);
-	} else if (os_strcmp(buf, "fils_discovery_max_interval") == 0) {
+	} else if (CFG_ITEM("fils_discovery_max_interval")) {
 		bss->fils_discovery_max_int = atoi(pos);
 #endif /* CONFIG_FILS */
-	} else if (os_strcmp(buf, "multicast_to_unicast") == 0) {
+	} else if (CFG_ITEM("multicast_to_unicast")) {
 		bss->multicast_to_unicast = atoi(pos);
-	} else if (os_strcmp(buf, "broadcast_deauth") == 0) {
+	} else if (CFG_ITEM("broadcast_deauth")) {
 		bss->broadcast_deauth = atoi(pos);
-	} else if (os_strcmp(buf, "notify_mgmt_frames") == 0) {
+	} else if (CFG_ITEM("notify_mgmt_frames")) {
 		bss->notify_mgmt_frames = atoi(pos);
 #ifdef CONFIG_DPP
-	} else if (os_strcmp(buf, "dpp_name") == 0) {
+	} else if (CFG_ITEM("dpp_name")) {
 		os_free(bss->dpp_name);
 		bss->dpp_name = os_strdup(pos);
-	} else if (os_strcmp(buf, "dpp_mud_url") == 0) {
+	} else if (CFG_ITEM("dpp_mud_url")) {
 		os_free(bss->dpp_mud_url);
 		bss->dpp_mud_url = os_strdup(pos);
-	} else if (os_strcmp(buf, "dpp_connector") == 0) {
+	} else if (CFG_ITEM("dpp_connector")) {
 		os_free(bss->dpp_connector);
 		bss->dpp_connector = os_strdup(pos);
-	} else if (os_strcmp(buf, "dpp_netaccesskey") == 0) {
+	} else if (CFG_ITEM("dpp_netaccesskey")) {
 		if (parse_wpabuf_hex(line, buf, &bss->dpp_netaccesskey, pos))
 			return 1;
-	} else if (os_strcmp(buf, "dpp_netaccesskey_expiry") == 0) {
+	} else if (CFG_ITEM("dpp_netaccesskey_expiry")) {
 		bss->dpp_netaccesskey_expiry = strtol(pos, NULL, 0);
-	} else if (os_strcmp(buf, "dpp_csign") == 0) {
+	} else if (CFG_ITEM("dpp_csign")) {
 		if (parse_wpabuf_hex(line, buf, &bss->dpp_csign, pos))
 			return 1;
 #ifdef CONFIG_DPP2
-	} else if (os_strcmp(buf, "dpp_controller") == 0) {
+	} else if (CFG_ITEM("dpp_controller")) {
 		if (hostapd_dpp_controller_parse(bss, pos))
 			return 1;
-	} else if (os_strcmp(buf, "dpp_configurator_connectivity") == 0) {
+	} else if (CFG_ITEM("dpp_configurator_connectivity")) {
 		bss->dpp_configurator_connectivity = atoi(pos);
-	} else if (os_strcmp(buf, "dpp_pfs") == 0) {
+	} else if (CFG_ITEM("dpp_pfs")) {
 		int val = atoi(pos);
 
 		if (val < 0 || val > 2) {
@@ -4523,14 +4591,14 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 #endif /* CONFIG_DPP2 */
 #endif /* CONFIG_DPP */
 #ifdef CONFIG_OWE
-	} else if (os_strcmp(buf, "owe_transition_bssid") == 0) {
+	} else if (CFG_ITEM("owe_transition_bssid")) {
 		if (hwaddr_aton(pos, bss->owe_transition_bssid)) {
 			wpa_printf(MSG_ERROR,
 				   "Line %d: invalid owe_transition_bssid",
 				   line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "owe_transition_ssid") == 0) {
+	} else if (CFG_ITEM("owe_transition_ssid")) {
 		size_t slen;
 		char *str = wpa_config_parse_string(pos, &slen);
 
@@ -4543,22 +4611,22 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		os_memcpy(bss->owe_transition_ssid, str, slen);
 		bss->owe_transition_ssid_len = slen;
 		os_free(str);
-	} else if (os_strcmp(buf, "owe_transition_ifname") == 0) {
+	} else if (CFG_ITEM("owe_transition_ifname")) {
 		os_strlcpy(bss->owe_transition_ifname, pos,
 			   sizeof(bss->owe_transition_ifname));
-	} else if (os_strcmp(buf, "owe_groups") == 0) {
+	} else if (CFG_ITEM("owe_groups")) {
 		if (hostapd_parse_intlist(&bss->owe_groups, pos)) {
 			wpa_printf(MSG_ERROR,
 				   "Line %d: Invalid owe_groups value '%s'",
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "owe_ptk_workaround") == 0) {
+	} else if (CFG_ITEM("owe_ptk_workaround")) {
 		bss->owe_ptk_workaround = atoi(pos);
 #endif /* CONFIG_OWE */
-	} else if (os_strcmp(buf, "coloc_intf_reporting") == 0) {
+	} else if (CFG_ITEM("coloc_intf_reporting")) {
 		bss->coloc_intf_reporting = atoi(pos);
-	} else if (os_strcmp(buf, "multi_ap") == 0) {
+	} else if (CFG_ITEM("multi_ap")) {
 		int val = atoi(pos);
 
 		if (val < 0 || val > 3) {
@@ -4568,18 +4636,18 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		}
 
 		bss->multi_ap = val;
-	} else if (os_strcmp(buf, "rssi_reject_assoc_rssi") == 0) {
+	} else if (CFG_ITEM("rssi_reject_assoc_rssi")) {
 		conf->rssi_reject_assoc_rssi = atoi(pos);
-	} else if (os_strcmp(buf, "rssi_reject_assoc_timeout") == 0) {
+	} else if (CFG_ITEM("rssi_reject_assoc_timeout")) {
 		conf->rssi_reject_assoc_timeout = atoi(pos);
-	} else if (os_strcmp(buf, "rssi_ignore_probe_request") == 0) {
+	} else if (CFG_ITEM("rssi_ignore_probe_request")) {
 		conf->rssi_ignore_probe_request = atoi(pos);
-	} else if (os_strcmp(buf, "pbss") == 0) {
+	} else if (CFG_ITEM("pbss")) {
 		bss->pbss = atoi(pos);
-	} else if (os_strcmp(buf, "transition_disable") == 0) {
+	} else if (CFG_ITEM("transition_disable")) {
 		bss->transition_disable = strtol(pos, NULL, 16);
 #ifdef CONFIG_AIRTIME_POLICY
-	} else if (os_strcmp(buf, "airtime_mode") == 0) {
+	} else if (CFG_ITEM("airtime_mode")) {
 		int val = atoi(pos);
 
 		if (val < 0 || val > AIRTIME_MODE_MAX) {
@@ -4588,11 +4656,11 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		conf->airtime_mode = val;
-	} else if (os_strcmp(buf, "airtime_update_interval") == 0) {
+	} else if (CFG_ITEM("airtime_update_interval")) {
 		conf->airtime_update_interval = atoi(pos);
-	} else if (os_strcmp(buf, "airtime_bss_weight") == 0) {
+	} else if (CFG_ITEM("airtime_bss_weight")) {
 		bss->airtime_weight = atoi(pos);
-	} else if (os_strcmp(buf, "airtime_bss_limit") == 0) {
+	} else if (CFG_ITEM("airtime_bss_limit")) {
 		int val = atoi(pos);
 
 		if (val < 0 || val > 1) {
@@ -4602,7 +4670,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		bss->airtime_limit = val;
-	} else if (os_strcmp(buf, "airtime_sta_weight") == 0) {
+	} else if (CFG_ITEM("airtime_sta_weight")) {
 		if (add_airtime_weight(bss, pos) < 0) {
 			wpa_printf(MSG_ERROR,
 				   "Line %d: Invalid airtime weight '%s'",
@@ -4611,7 +4679,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		}
 #endif /* CONFIG_AIRTIME_POLICY */
 #ifdef CONFIG_MACSEC
-	} else if (os_strcmp(buf, "macsec_policy") == 0) {
+	} else if (CFG_ITEM("macsec_policy")) {
 		int macsec_policy = atoi(pos);
 
 		if (macsec_policy < 0 || macsec_policy > 1) {
@@ -4621,7 +4689,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		bss->macsec_policy = macsec_policy;
-	} else if (os_strcmp(buf, "macsec_integ_only") == 0) {
+	} else if (CFG_ITEM("macsec_integ_only")) {
 		int macsec_integ_only = atoi(pos);
 
 		if (macsec_integ_only < 0 || macsec_integ_only > 1) {
@@ -4631,7 +4699,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		bss->macsec_integ_only = macsec_integ_only;
-	} else if (os_strcmp(buf, "macsec_replay_protect") == 0) {
+	} else if (CFG_ITEM("macsec_replay_protect")) {
 		int macsec_replay_protect = atoi(pos);
 
 		if (macsec_replay_protect < 0 || macsec_replay_protect > 1) {
@@ -4641,9 +4709,9 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		bss->macsec_replay_protect = macsec_replay_protect;
-	} else if (os_strcmp(buf, "macsec_replay_window") == 0) {
+	} else if (CFG_ITEM("macsec_replay_window")) {
 		bss->macsec_replay_window = atoi(pos);
-	} else if (os_strcmp(buf, "macsec_port") == 0) {
+	} else if (CFG_ITEM("macsec_port")) {
 		int macsec_port = atoi(pos);
 
 		if (macsec_port < 1 || macsec_port > 65534) {
@@ -4653,7 +4721,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		bss->macsec_port = macsec_port;
-	} else if (os_strcmp(buf, "mka_priority") == 0) {
+	} else if (CFG_ITEM("mka_priority")) {
 		int mka_priority = atoi(pos);
 
 		if (mka_priority < 0 || mka_priority > 255) {
@@ -4663,7 +4731,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		bss->mka_priority = mka_priority;
-	} else if (os_strcmp(buf, "mka_cak") == 0) {
+	} else if (CFG_ITEM("mka_cak")) {
 		size_t len = os_strlen(pos);
 
 		if (len > 2 * MACSEC_CAK_MAX_LEN ||
@@ -4675,7 +4743,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		}
 		bss->mka_cak_len = len / 2;
 		bss->mka_psk_set |= MKA_PSK_SET_CAK;
-	} else if (os_strcmp(buf, "mka_ckn") == 0) {
+	} else if (CFG_ITEM("mka_ckn")) {
 		size_t len = os_strlen(pos);
 
 		if (len > 2 * MACSEC_CKN_MAX_LEN || /* too long */
@@ -4693,38 +4761,38 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		}
 		bss->mka_psk_set |= MKA_PSK_SET_CKN;
 #endif /* CONFIG_MACSEC */
-	} else if (os_strcmp(buf, "disable_11n") == 0) {
+	} else if (CFG_ITEM("disable_11n")) {
 		bss->disable_11n = !!atoi(pos);
-	} else if (os_strcmp(buf, "disable_11ac") == 0) {
+	} else if (CFG_ITEM("disable_11ac")) {
 		bss->disable_11ac = !!atoi(pos);
-	} else if (os_strcmp(buf, "disable_11ax") == 0) {
+	} else if (CFG_ITEM("disable_11ax")) {
 		bss->disable_11ax = !!atoi(pos);
 #ifdef CONFIG_PASN
 #ifdef CONFIG_TESTING_OPTIONS
-	} else if (os_strcmp(buf, "force_kdk_derivation") == 0) {
+	} else if (CFG_ITEM("force_kdk_derivation")) {
 		bss->force_kdk_derivation = atoi(pos);
-	} else if (os_strcmp(buf, "pasn_corrupt_mic") == 0) {
+	} else if (CFG_ITEM("pasn_corrupt_mic")) {
 		bss->pasn_corrupt_mic = atoi(pos);
 #endif /* CONFIG_TESTING_OPTIONS */
-	} else if (os_strcmp(buf, "pasn_groups") == 0) {
+	} else if (CFG_ITEM("pasn_groups")) {
 		if (hostapd_parse_intlist(&bss->pasn_groups, pos)) {
 			wpa_printf(MSG_ERROR,
 				   "Line %d: Invalid pasn_groups value '%s'",
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "pasn_comeback_after") == 0) {
+	} else if (CFG_ITEM("pasn_comeback_after")) {
 		bss->pasn_comeback_after = atoi(pos);
 #endif /* CONFIG_PASN */
-	} else if (os_strcmp(buf, "ext_capa_mask") == 0) {
+	} else if (CFG_ITEM("ext_capa_mask")) {
 		if (get_hex_config(bss->ext_capa_mask, EXT_CAPA_MAX_LEN,
 				   line, "ext_capa_mask", pos))
 			return 1;
-	} else if (os_strcmp(buf, "ext_capa") == 0) {
+	} else if (CFG_ITEM("ext_capa")) {
 		if (get_hex_config(bss->ext_capa, EXT_CAPA_MAX_LEN,
 				   line, "ext_capa", pos))
 			return 1;
-	} else if (os_strcmp(buf, "rnr") == 0) {
+	} else if (CFG_ITEM("rnr")) {
 		bss->rnr = atoi(pos);
 	} else {
 		wpa_printf(MSG_ERROR,
@@ -4742,13 +4810,52 @@ static int hostapd_config_fill(struct hostapd_config *conf,
  * @fname: Configuration file name (including path, if needed)
  * Returns: Allocated configuration data structure
  */
+/*
+ * Record a configuration item for comparing configurations on reload. Items
+ * that refer to a file whose contents are parsed into the configuration are
+ * recorded with a hash of the file so that modified files are noticed, too.
+ */
+static void hostapd_config_record_item(struct hostapd_bss_config *bss,
+				       const char *name, const char *value)
+{
+	static const char *file_items[] = {
+		"accept_mac_file", "deny_mac_file", "wpa_psk_file",
+		"vlan_file", NULL
+	};
+	const char **item;
+	char *data;
+	size_t len;
+	u8 hash[SHA256_MAC_LEN];
+	char txt[2 * 16 + 1];
+
+	for (item = file_items; *item; item++) {
+		if (os_strcmp(name, *item) == 0)
+			break;
+	}
+	if (!*item) {
+		hostapd_bss_config_add_item(bss, name, value, NULL);
+		return;
+	}
+
+	data = os_readfile(value, &len);
+	if (!data) {
+		hostapd_bss_config_add_item(bss, name, value, NULL);
+		return;
+	}
+	sha256_vector(1, (const u8 **) &data, &len, hash);
+	bin_clear_free(data, len);
+	wpa_snprintf_hex(txt, sizeof(txt), hash, 16);
+	hostapd_bss_config_add_item(bss, name, value, txt);
+}
+
+
 struct hostapd_config * hostapd_config_read(const char *fname)
 {
 	struct hostapd_config *conf;
 	FILE *f;
 	char buf[4096], *pos;
 	int line = 0;
-	int errors = 0;
+	int errors = 0, res;
 	size_t i;
 
 	f = fopen(fname, "r");
@@ -4803,7 +4910,10 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 		}
 		*pos = '\0';
 		pos++;
-		errors += hostapd_config_fill(conf, bss, buf, pos, line);
+		res = hostapd_config_fill(conf, bss, buf, pos, line);
+		if (res == 0)
+			hostapd_config_record_item(conf->last_bss, buf, pos);
+		errors += res;
 	}
 
 	fclose(f);
@@ -4840,6 +4950,7 @@ int hostapd_set_iface(struct hostapd_config *conf,
 			   "to value '%s'", field, value);
 		return -1;
 	}
+	hostapd_config_invalidate_items(conf);
 
 	for (i = 0; i < conf->num_bss; i++)
 		hostapd_set_security_params(conf->bss[i], 0);
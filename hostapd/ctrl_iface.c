@@ -30,6 +30,7 @@
 #include "utils/common.h"
 #include "utils/eloop.h"
 #include "utils/module_tests.h"
+#include "utils/objpool.h"
 #include "common/version.h"
 #include "common/ieee802_11_defs.h"
 #include "common/ctrl_iface_common.h"
@@ -40,6 +41,7 @@
 #include "common/ptksa_cache.h"
 #include "crypto/tls.h"
 #include "drivers/driver.h"
+#include "eap_server/eap.h"
 #include "eapol_auth/eapol_auth_sm.h"
 #include "radius/radius_client.h"
 #include "radius/radius_server.h"
@@ -50,6 +52,7 @@
 #include "ap/wpa_auth.h"
 #include "ap/pmksa_cache_auth.h"
 #include "ap/ieee802_11.h"
+#include "ap/ieee802_11_auth.h"
 #include "ap/sta_info.h"
 #include "ap/wps_hostapd.h"
 #include "ap/ctrl_iface_ap.h"
@@ -62,6 +65,7 @@
 #include "ap/rrm.h"
 #include "ap/dpp_hostapd.h"
 #include "ap/dfs.h"
+#include "ap/gas_serv.h"
 #include "wps/wps_defs.h"
 #include "wps/wps.h"
 #include "fst/fst_ctrl_iface.h"
@@ -1362,43 +1366,6 @@ static int hostapd_ctrl_iface_get_config(struct hostapd_data *hapd,
 }
 
 
-static void hostapd_disassoc_accept_mac(struct hostapd_data *hapd)
-{
-	struct sta_info *sta;
-	struct vlan_description vlan_id;
-
-	if (hapd->conf->macaddr_acl != DENY_UNLESS_ACCEPTED)
-		return;
-
-	for (sta = hapd->sta_list; sta; sta = sta->next) {
-		if (!hostapd_maclist_found(hapd->conf->accept_mac,
-					   hapd->conf->num_accept_mac,
-					   sta->addr, &vlan_id) ||
-		    (vlan_id.notempty &&
-		     vlan_compare(&vlan_id, sta->vlan_desc)))
-			ap_sta_disconnect(hapd, sta, sta->addr,
-					  WLAN_REASON_UNSPECIFIED);
-	}
-}
-
-
-static void hostapd_disassoc_deny_mac(struct hostapd_data *hapd)
-{
-	struct sta_info *sta;
-	struct vlan_description vlan_id;
-
-	for (sta = hapd->sta_list; sta; sta = sta->next) {
-		if (hostapd_maclist_found(hapd->conf->deny_mac,
-					  hapd->conf->num_deny_mac, sta->addr,
-					  &vlan_id) &&
-		    (!vlan_id.notempty ||
-		     !vlan_compare(&vlan_id, sta->vlan_desc)))
-			ap_sta_disconnect(hapd, sta, sta->addr,
-					  WLAN_REASON_UNSPECIFIED);
-	}
-}
-
-
 static int hostapd_ctrl_iface_set_band(struct hostapd_data *hapd,
 				       const char *bands)
 {
@@ -1536,6 +1503,9 @@ static int hostapd_ctrl_iface_set(struct hostapd_data *hapd, char *cmd)
 		ret = hostapd_set_iface(hapd->iconf, hapd->conf, cmd, value);
 		if (ret)
 			return ret;
+#ifdef CONFIG_INTERWORKING
+		gas_serv_flush_cache(hapd);
+#endif /* CONFIG_INTERWORKING */
 
 		if (os_strcasecmp(cmd, "deny_mac_file") == 0) {
 			hostapd_disassoc_deny_mac(hapd);
@@ -2856,6 +2826,26 @@ static int hostapd_ctrl_iface_chan_switch(struct hostapd_iface *iface,
 static int hostapd_ctrl_iface_mib(struct hostapd_data *hapd, char *reply,
 				  int reply_size, const char *param)
 {
+	if (os_strcmp(param, "sta_pool") == 0) {
+		int len;
+
+		len = objpool_get_mib(hapd->sta_pool, reply, reply_size);
+		len += wpa_get_pool_mib(hapd->wpa_auth, reply + len,
+					reply_size - len);
+		len += eapol_auth_get_pool_mib(hapd->eapol_auth, reply + len,
+					       reply_size - len);
+		return len;
+	}
+	if (os_strcmp(param, "wpabuf") == 0)
+		return wpabuf_pool_get_stats(reply, reply_size);
+	if (os_strcmp(param, "acl") == 0)
+		return hostapd_acl_get_mib(hapd, reply, reply_size);
+#ifdef CONFIG_INTERWORKING
+	if (os_strcmp(param, "anqp") == 0)
+		return gas_serv_get_mib(hapd, reply, reply_size);
+#endif /* CONFIG_INTERWORKING */
+	if (os_strcmp(param, "eap_server") == 0)
+		return eap_server_get_mib(hapd->eap_cfg, reply, reply_size);
 #ifdef RADIUS_SERVER
 	if (os_strcmp(param, "radius_server") == 0) {
 		return radius_server_get_mib(hapd->radius_srv, reply,
@@ -3379,46 +3369,33 @@ static int hostapd_ctrl_driver_flags2(struct hostapd_iface *iface, char *buf,
 }
 
 
-static int hostapd_ctrl_iface_acl_del_mac(struct mac_acl_entry **acl, int *num,
+static int hostapd_ctrl_iface_acl_del_mac(struct hostapd_mac_acl *acl,
 					  const char *txtaddr)
 {
 	u8 addr[ETH_ALEN];
-	struct vlan_description vlan_id;
 
-	if (!(*num))
+	if (!acl->num)
 		return 0;
 
 	if (hwaddr_aton(txtaddr, addr))
 		return -1;
 
-	if (hostapd_maclist_found(*acl, *num, addr, &vlan_id))
-		hostapd_remove_acl_mac(acl, num, addr);
+	hostapd_mac_acl_del(acl, addr);
 
 	return 0;
 }
 
 
-static void hostapd_ctrl_iface_acl_clear_list(struct mac_acl_entry **acl,
-					      int *num)
-{
-	while (*num)
-		hostapd_remove_acl_mac(acl, num, (*acl)[0].addr);
-}
-
-
-static int hostapd_ctrl_iface_acl_show_mac(struct mac_acl_entry *acl, int num,
+static int hostapd_ctrl_iface_acl_show_mac(const struct hostapd_mac_acl *acl,
 					   char *buf, size_t buflen)
 {
 	int i = 0, len = 0, ret = 0;
 
-	if (!acl)
-		return 0;
-
-	while (i < num) {
+	while (i < acl->num) {
 		ret = os_snprintf(buf + len, buflen - len,
 				  MACSTR " VLAN_ID=%d\n",
-				  MAC2STR(acl[i].addr),
-				  acl[i].vlan_id.untagged);
+				  MAC2STR(acl->entries[i].addr),
+				  acl->entries[i].vlan_id.untagged);
 		if (ret < 0 || (size_t) ret >= buflen - len)
 			return len;
 		i++;
@@ -3428,12 +3405,11 @@ static int hostapd_ctrl_iface_acl_show_mac(struct mac_acl_entry *acl, int num,
 }
 
 
-static int hostapd_ctrl_iface_acl_add_mac(struct mac_acl_entry **acl, int *num,
+static int hostapd_ctrl_iface_acl_add_mac(struct hostapd_mac_acl *acl,
 					  const char *cmd)
 {
 	u8 addr[ETH_ALEN];
-	struct vlan_description vlan_id;
-	int ret = 0, vlanid = 0;
+	int vlanid = 0;
 	const char *pos;
 
 	if (hwaddr_aton(cmd, addr))
@@ -3443,13 +3419,7 @@ static int hostapd_ctrl_iface_acl_add_mac(struct mac_acl_entry **acl, int *num,
 	if (pos)
 		vlanid = atoi(pos + 8);
 
-	if (!hostapd_maclist_found(*acl, *num, addr, &vlan_id)) {
-		ret = hostapd_add_acl_maclist(acl, num, vlanid, addr);
-		if (ret != -1 && *acl)
-			qsort(*acl, *num, sizeof(**acl), hostapd_acl_comp);
-	}
-
-	return ret < 0 ? -1 : 0;
+	return hostapd_mac_acl_add(acl, addr, vlanid) < 0 ? -1 : 0;
 }
 
 
@@ -3515,6 +3485,11 @@ static int hostapd_ctrl_iface_wl_cmd(struct hostapd_data *hapd, char *cmd,
 }
 #endif /* CONFIG_DRIVER_BRCM_WL */
 
+
+/* Compare the command in buf against a command name literal */
+#define CTRL_CMD(s) STR_HASH_MATCH(cmd_key, buf, s)
+
+
 static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 					      char *buf, char *reply,
 					      int reply_size,
@@ -3522,11 +3497,13 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 					      socklen_t fromlen)
 {
 	int reply_len, res;
+	size_t cmd_len = os_strlen(buf);
+	u32 cmd_key = STR_HASH_KEY(buf, cmd_len);
 
 	os_memcpy(reply, "OK\n", 3);
 	reply_len = 3;
 
-	if (os_strcmp(buf, "PING") == 0) {
+	if (CTRL_CMD("PING")) {
 		os_memcpy(reply, "PONG\n", 5);
 		reply_len = 5;
 	} else if (os_strncmp(buf, "RELOG", 5) == 0) {
@@ -3534,12 +3511,12 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 			reply_len = -1;
 	} else if (os_strncmp(buf, "NOTE ", 5) == 0) {
 		wpa_printf(MSG_INFO, "NOTE: %s", buf + 5);
-	} else if (os_strcmp(buf, "STATUS") == 0) {
+	} else if (CTRL_CMD("STATUS")) {
 		reply_len = hostapd_ctrl_iface_status(hapd, reply,
 						      reply_size);
-	} else if (os_strcmp(buf, "STATUS-DRIVER") == 0) {
+	} else if (CTRL_CMD("STATUS-DRIVER")) {
 		reply_len = hostapd_drv_status(hapd, reply, reply_size);
-	} else if (os_strcmp(buf, "MIB") == 0) {
+	} else if (CTRL_CMD("MIB")) {
 		reply_len = ieee802_11_get_mib(hapd, reply, reply_size);
 		if (reply_len >= 0) {
 			res = wpa_get_mib(hapd->wpa_auth, reply + reply_len,
@@ -3571,7 +3548,7 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 	} else if (os_strncmp(buf, "MIB ", 4) == 0) {
 		reply_len = hostapd_ctrl_iface_mib(hapd, reply, reply_size,
 						   buf + 4);
-	} else if (os_strcmp(buf, "STA-FIRST") == 0) {
+	} else if (CTRL_CMD("STA-FIRST")) {
 		reply_len = hostapd_ctrl_iface_sta_first(hapd, reply,
 							 reply_size);
 	} else if (os_strncmp(buf, "STA ", 4) == 0) {
@@ -3580,13 +3557,13 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 	} else if (os_strncmp(buf, "STA-NEXT ", 9) == 0) {
 		reply_len = hostapd_ctrl_iface_sta_next(hapd, buf + 9, reply,
 							reply_size);
-	} else if (os_strcmp(buf, "ATTACH") == 0) {
+	} else if (CTRL_CMD("ATTACH")) {
 		if (hostapd_ctrl_iface_attach(hapd, from, fromlen, NULL))
 			reply_len = -1;
 	} else if (os_strncmp(buf, "ATTACH ", 7) == 0) {
 		if (hostapd_ctrl_iface_attach(hapd, from, fromlen, buf + 7))
 			reply_len = -1;
-	} else if (os_strcmp(buf, "DETACH") == 0) {
+	} else if (CTRL_CMD("DETACH")) {
 		if (hostapd_ctrl_iface_detach(hapd, from, fromlen))
 			reply_len = -1;
 	} else if (os_strncmp(buf, "LEVEL ", 6) == 0) {
@@ -3610,7 +3587,7 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 	} else if (os_strncmp(buf, "POLL_STA ", 9) == 0) {
 		if (hostapd_ctrl_iface_poll_sta(hapd, buf + 9))
 			reply_len = -1;
-	} else if (os_strcmp(buf, "STOP_AP") == 0) {
+	} else if (CTRL_CMD("STOP_AP")) {
 		if (hostapd_ctrl_iface_stop_ap(hapd))
 			reply_len = -1;
 #ifdef NEED_AP_MLME
@@ -3625,10 +3602,10 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 	} else if (os_strncmp(buf, "WPS_CHECK_PIN ", 14) == 0) {
 		reply_len = hostapd_ctrl_iface_wps_check_pin(
 			hapd, buf + 14, reply, reply_size);
-	} else if (os_strcmp(buf, "WPS_PBC") == 0) {
+	} else if (CTRL_CMD("WPS_PBC")) {
 		if (hostapd_wps_button_pushed(hapd, NULL))
 			reply_len = -1;
-	} else if (os_strcmp(buf, "WPS_CANCEL") == 0) {
+	} else if (CTRL_CMD("WPS_CANCEL")) {
 		if (hostapd_wps_cancel(hapd))
 			reply_len = -1;
 	} else if (os_strncmp(buf, "WPS_AP_PIN ", 11) == 0) {
@@ -3688,7 +3665,7 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 		if (hostapd_ctrl_iface_coloc_intf_req(hapd, buf + 15))
 			reply_len = -1;
 #endif /* CONFIG_WNM_AP */
-	} else if (os_strcmp(buf, "GET_CONFIG") == 0) {
+	} else if (CTRL_CMD("GET_CONFIG")) {
 		reply_len = hostapd_ctrl_iface_get_config(hapd, reply,
 							  reply_size);
 	} else if (os_strncmp(buf, "SET ", 4) == 0) {
@@ -3700,7 +3677,7 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 	} else if (os_strncmp(buf, "ENABLE", 6) == 0) {
 		if (hostapd_ctrl_iface_enable(hapd->iface))
 			reply_len = -1;
-	} else if (os_strcmp(buf, "RELOAD_WPA_PSK") == 0) {
+	} else if (CTRL_CMD("RELOAD_WPA_PSK")) {
 		if (hostapd_ctrl_iface_reload_wpa_psk(hapd))
 			reply_len = -1;
 	} else if (os_strncmp(buf, "RELOAD", 6) == 0) {
@@ -3709,7 +3686,7 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 	} else if (os_strncmp(buf, "DISABLE", 7) == 0) {
 		if (hostapd_ctrl_iface_disable(hapd->iface))
 			reply_len = -1;
-	} else if (os_strcmp(buf, "UPDATE_BEACON") == 0) {
+	} else if (CTRL_CMD("UPDATE_BEACON")) {
 		if (ieee802_11_set_beacon(hapd))
 			reply_len = -1;
 #ifdef CONFIG_TESTING_OPTIONS
@@ -3744,13 +3721,13 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 	} else if (os_strncmp(buf, "TEST_ALLOC_FAIL ", 16) == 0) {
 		if (hostapd_ctrl_test_alloc_fail(hapd, buf + 16) < 0)
 			reply_len = -1;
-	} else if (os_strcmp(buf, "GET_ALLOC_FAIL") == 0) {
+	} else if (CTRL_CMD("GET_ALLOC_FAIL")) {
 		reply_len = hostapd_ctrl_get_alloc_fail(hapd, reply,
 							reply_size);
 	} else if (os_strncmp(buf, "TEST_FAIL ", 10) == 0) {
 		if (hostapd_ctrl_test_fail(hapd, buf + 10) < 0)
 			reply_len = -1;
-	} else if (os_strcmp(buf, "GET_FAIL") == 0) {
+	} else if (CTRL_CMD("GET_FAIL")) {
 		reply_len = hostapd_ctrl_get_fail(hapd, reply, reply_size);
 	} else if (os_strncmp(buf, "RESET_PN ", 9) == 0) {
 		if (hostapd_ctrl_reset_pn(hapd, buf + 9) < 0)
@@ -3770,7 +3747,7 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 	} else if (os_strncmp(buf, "REKEY_PTK ", 10) == 0) {
 		if (hostapd_ctrl_rekey_ptk(hapd, buf + 10) < 0)
 			reply_len = -1;
-	} else if (os_strcmp(buf, "REKEY_GTK") == 0) {
+	} else if (CTRL_CMD("REKEY_GTK")) {
 		if (wpa_auth_rekey_gtk(hapd->wpa_auth) < 0)
 			reply_len = -1;
 	} else if (os_strncmp(buf, "GET_PMK ", 8) == 0) {
@@ -3786,7 +3763,7 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 	} else if (os_strncmp(buf, "VENDOR ", 7) == 0) {
 		reply_len = hostapd_ctrl_iface_vendor(hapd, buf + 7, reply,
 						      reply_size);
-	} else if (os_strcmp(buf, "ERP_FLUSH") == 0) {
+	} else if (CTRL_CMD("ERP_FLUSH")) {
 		ieee802_1x_erp_flush(hapd);
 #ifdef RADIUS_SERVER
 		radius_server_erp_flush(hapd->radius_srv);
@@ -3801,14 +3778,14 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 		reply_len = hostapd_ctrl_iface_log_level(
 			hapd, buf + 9, reply, reply_size);
 #ifdef NEED_AP_MLME
-	} else if (os_strcmp(buf, "TRACK_STA_LIST") == 0) {
+	} else if (CTRL_CMD("TRACK_STA_LIST")) {
 		reply_len = hostapd_ctrl_iface_track_sta_list(
 			hapd, reply, reply_size);
 #endif /* NEED_AP_MLME */
-	} else if (os_strcmp(buf, "PMKSA") == 0) {
+	} else if (CTRL_CMD("PMKSA")) {
 		reply_len = hostapd_ctrl_iface_pmksa_list(hapd, reply,
 							  reply_size);
-	} else if (os_strcmp(buf, "PMKSA_FLUSH") == 0) {
+	} else if (CTRL_CMD("PMKSA_FLUSH")) {
 		hostapd_ctrl_iface_pmksa_flush(hapd);
 	} else if (os_strncmp(buf, "PMKSA_ADD ", 10) == 0) {
 		if (hostapd_ctrl_iface_pmksa_add(hapd, buf + 10) < 0)
@@ -3816,7 +3793,7 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 	} else if (os_strncmp(buf, "SET_NEIGHBOR ", 13) == 0) {
 		if (hostapd_ctrl_iface_set_neighbor(hapd, buf + 13))
 			reply_len = -1;
-	} else if (os_strcmp(buf, "SHOW_NEIGHBOR") == 0) {
+	} else if (CTRL_CMD("SHOW_NEIGHBOR")) {
 		reply_len = hostapd_ctrl_iface_show_neighbor(hapd, reply,
 							     reply_size);
 	} else if (os_strncmp(buf, "REMOVE_NEIGHBOR ", 16) == 0) {
@@ -3831,58 +3808,48 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 	} else if (os_strncmp(buf, "REQ_BEACON ", 11) == 0) {
 		reply_len = hostapd_ctrl_iface_req_beacon(hapd, buf + 11,
 							  reply, reply_size);
-	} else if (os_strcmp(buf, "DRIVER_FLAGS") == 0) {
+	} else if (CTRL_CMD("DRIVER_FLAGS")) {
 		reply_len = hostapd_ctrl_driver_flags(hapd->iface, reply,
 						      reply_size);
-	} else if (os_strcmp(buf, "DRIVER_FLAGS2") == 0) {
+	} else if (CTRL_CMD("DRIVER_FLAGS2")) {
 		reply_len = hostapd_ctrl_driver_flags2(hapd->iface, reply,
 						       reply_size);
-	} else if (os_strcmp(buf, "TERMINATE") == 0) {
+	} else if (CTRL_CMD("TERMINATE")) {
 		eloop_terminate();
 	} else if (os_strncmp(buf, "ACCEPT_ACL ", 11) == 0) {
 		if (os_strncmp(buf + 11, "ADD_MAC ", 8) == 0) {
 			if (hostapd_ctrl_iface_acl_add_mac(
-				    &hapd->conf->accept_mac,
-				    &hapd->conf->num_accept_mac, buf + 19))
+				    &hapd->conf->accept_mac, buf + 19))
 				reply_len = -1;
 		} else if (os_strncmp((buf + 11), "DEL_MAC ", 8) == 0) {
 			if (!hostapd_ctrl_iface_acl_del_mac(
-				    &hapd->conf->accept_mac,
-				    &hapd->conf->num_accept_mac, buf + 19))
+				    &hapd->conf->accept_mac, buf + 19))
 				hostapd_disassoc_accept_mac(hapd);
 			else
 				reply_len = -1;
 		} else if (os_strcmp(buf + 11, "SHOW") == 0) {
 			reply_len = hostapd_ctrl_iface_acl_show_mac(
-				hapd->conf->accept_mac,
-				hapd->conf->num_accept_mac, reply, reply_size);
+				&hapd->conf->accept_mac, reply, reply_size);
 		} else if (os_strcmp(buf + 11, "CLEAR") == 0) {
-			hostapd_ctrl_iface_acl_clear_list(
-				&hapd->conf->accept_mac,
-				&hapd->conf->num_accept_mac);
+			hostapd_mac_acl_clear(&hapd->conf->accept_mac);
 			hostapd_disassoc_accept_mac(hapd);
 		}
 	} else if (os_strncmp(buf, "DENY_ACL ", 9) == 0) {
 		if (os_strncmp(buf + 9, "ADD_MAC ", 8) == 0) {
 			if (!hostapd_ctrl_iface_acl_add_mac(
-				    &hapd->conf->deny_mac,
-				    &hapd->conf->num_deny_mac, buf + 17))
+				    &hapd->conf->deny_mac, buf + 17))
 				hostapd_disassoc_deny_mac(hapd);
 			else
 				reply_len = -1;
 		} else if (os_strncmp(buf + 9, "DEL_MAC ", 8) == 0) {
 			if (hostapd_ctrl_iface_acl_del_mac(
-				    &hapd->conf->deny_mac,
-				    &hapd->conf->num_deny_mac, buf + 17))
+				    &hapd->conf->deny_mac, buf + 17))
 				reply_len = -1;
 		} else if (os_strcmp(buf + 9, "SHOW") == 0) {
 			reply_len = hostapd_ctrl_iface_acl_show_mac(
-				hapd->conf->deny_mac,
-				hapd->conf->num_deny_mac, reply, reply_size);
+				&hapd->conf->deny_mac, reply, reply_size);
 		} else if (os_strcmp(buf + 9, "CLEAR") == 0) {
-			hostapd_ctrl_iface_acl_clear_list(
-				&hapd->conf->deny_mac,
-				&hapd->conf->num_deny_mac);
+			hostapd_mac_acl_clear(&hapd->conf->deny_mac);
 		}
 #ifdef CONFIG_DPP
 	} else if (os_strncmp(buf, "DPP_QR_CODE ", 12) == 0) {
@@ -3961,7 +3928,7 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 	} else if (os_strncmp(buf, "DPP_LISTEN ", 11) == 0) {
 		if (hostapd_dpp_listen(hapd, buf + 11) < 0)
 			reply_len = -1;
-	} else if (os_strcmp(buf, "DPP_STOP_LISTEN") == 0) {
+	} else if (CTRL_CMD("DPP_STOP_LISTEN")) {
 		hostapd_dpp_stop(hapd);
 		hostapd_dpp_listen_stop(hapd);
 	} else if (os_strncmp(buf, "DPP_CONFIGURATOR_ADD", 20) == 0) {
@@ -4002,15 +3969,15 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 	} else if (os_strncmp(buf, "DPP_CONTROLLER_START ", 21) == 0) {
 		if (hostapd_dpp_controller_start(hapd, buf + 20) < 0)
 			reply_len = -1;
-	} else if (os_strcmp(buf, "DPP_CONTROLLER_START") == 0) {
+	} else if (CTRL_CMD("DPP_CONTROLLER_START")) {
 		if (hostapd_dpp_controller_start(hapd, NULL) < 0)
 			reply_len = -1;
-	} else if (os_strcmp(buf, "DPP_CONTROLLER_STOP") == 0) {
+	} else if (CTRL_CMD("DPP_CONTROLLER_STOP")) {
 		dpp_controller_stop(hapd->iface->interfaces->dpp);
 	} else if (os_strncmp(buf, "DPP_CHIRP ", 10) == 0) {
 		if (hostapd_dpp_chirp(hapd, buf + 9) < 0)
 			reply_len = -1;
-	} else if (os_strcmp(buf, "DPP_STOP_CHIRP") == 0) {
+	} else if (CTRL_CMD("DPP_STOP_CHIRP")) {
 		hostapd_dpp_chirp_stop(hapd);
 #endif /* CONFIG_DPP2 */
 #endif /* CONFIG_DPP */
@@ -4023,7 +3990,7 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 		reply_len = hostapd_ctrl_iface_get_capability(
 			hapd, buf + 15, reply, reply_size);
 #ifdef CONFIG_PASN
-	} else if (os_strcmp(buf, "PTKSA_CACHE_LIST") == 0) {
+	} else if (CTRL_CMD("PTKSA_CACHE_LIST")) {
 		reply_len = ptksa_cache_list(hapd->ptksa, reply, reply_size);
 #endif /* CONFIG_PASN */
 #ifdef ANDROID
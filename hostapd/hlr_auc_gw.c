@@ -81,6 +81,7 @@ static struct gsm_triplet *gsm_db = NULL, *gsm_db_pos = NULL;
 /* OPc and AMF parameters for Milenage (Example algorithms for AKA). */
 struct milenage_parameters {
 	struct milenage_parameters *next;
+	struct milenage_parameters *hnext; /* next entry in IMSI hash chain */
 	char imsi[20];
 	u8 ki[16];
 	u8 opc[16];
@@ -91,6 +92,8 @@ struct milenage_parameters {
 };
 
 static struct milenage_parameters *milenage_db = NULL;
+static struct milenage_parameters **milenage_hash = NULL;
+static unsigned int milenage_hash_size = 0; /* power of two */
 
 #define EAP_SIM_MAX_CHAL 3
 
@@ -106,8 +109,32 @@ static struct milenage_parameters *milenage_db = NULL;
 #ifdef CONFIG_SQLITE
 
 static sqlite3 *sqlite_db = NULL;
+static sqlite3_stmt *db_get_stmt = NULL;
+static sqlite3_stmt *db_update_stmt = NULL;
 static struct milenage_parameters db_tmp_milenage;
 
+/*
+ * SQN updates are written in a transaction that is committed when no more
+ * requests are queued on the socket or when DB_MAX_PENDING responses are
+ * waiting. The responses to the requests processed during the transaction are
+ * sent only after the commit, so a SQN value is never used before it has been
+ * stored.
+ */
+#define DB_MAX_PENDING 100
+
+/* How long to wait for a database lock held by an external writer */
+#define DB_BUSY_TIMEOUT_MS 500
+
+struct db_pending_resp {
+	struct sockaddr_un addr;
+	socklen_t addrlen;
+	char *resp;
+};
+
+static int db_in_transaction = 0;
+static struct db_pending_resp db_pending[DB_MAX_PENDING];
+static unsigned int db_num_pending = 0;
+
 
 static int db_table_exists(sqlite3 *db, const char *name)
 {
@@ -152,99 +179,203 @@ static sqlite3 * db_open(const char *db_file)
 		return NULL;
 	}
 
+	sqlite3_busy_timeout(db, DB_BUSY_TIMEOUT_MS);
+
 	if (!db_table_exists(db, "milenage") &&
 	    db_table_create_milenage(db) < 0) {
 		sqlite3_close(db);
 		return NULL;
 	}
 
+	if (sqlite3_prepare_v2(db, "SELECT ki,opc,amf,sqn,res_len FROM milenage "
+			       "WHERE imsi=?;", -1, &db_get_stmt,
+			       NULL) != SQLITE_OK ||
+	    sqlite3_prepare_v2(db, "UPDATE milenage SET sqn=? WHERE imsi=?;",
+			       -1, &db_update_stmt, NULL) != SQLITE_OK) {
+		printf("Failed to prepare SQL statements: %s\n",
+		       sqlite3_errmsg(db));
+		sqlite3_finalize(db_get_stmt);
+		db_get_stmt = NULL;
+		sqlite3_close(db);
+		return NULL;
+	}
+
 	return db;
 }
 
 
-static int get_milenage_cb(void *ctx, int argc, char *argv[], char *col[])
+static void db_close(void)
 {
-	struct milenage_parameters *m = ctx;
-	int i;
-
-	m->set = 1;
-
-	for (i = 0; i < argc; i++) {
-		if (os_strcmp(col[i], "ki") == 0 && argv[i] &&
-		    hexstr2bin(argv[i], m->ki, sizeof(m->ki))) {
-			printf("Invalid ki value in database\n");
-			return -1;
-		}
+	sqlite3_finalize(db_get_stmt);
+	db_get_stmt = NULL;
+	sqlite3_finalize(db_update_stmt);
+	db_update_stmt = NULL;
+	sqlite3_close(sqlite_db);
+	sqlite_db = NULL;
+}
 
-		if (os_strcmp(col[i], "opc") == 0 && argv[i] &&
-		    hexstr2bin(argv[i], m->opc, sizeof(m->opc))) {
-			printf("Invalid opcvalue in database\n");
-			return -1;
-		}
 
-		if (os_strcmp(col[i], "amf") == 0 && argv[i] &&
-		    hexstr2bin(argv[i], m->amf, sizeof(m->amf))) {
-			printf("Invalid amf value in database\n");
-			return -1;
-		}
-
-		if (os_strcmp(col[i], "sqn") == 0 && argv[i] &&
-		    hexstr2bin(argv[i], m->sqn, sizeof(m->sqn))) {
-			printf("Invalid sqn value in database\n");
-			return -1;
-		}
+static int db_get_hex(int col, u8 *buf, size_t len, const char *name)
+{
+	const char *val;
 
-		if (os_strcmp(col[i], "res_len") == 0 && argv[i]) {
-			m->res_len = atoi(argv[i]);
-		}
+	val = (const char *) sqlite3_column_text(db_get_stmt, col);
+	if (val && hexstr2bin(val, buf, len)) {
+		printf("Invalid %s value in database\n", name);
+		return -1;
 	}
-
 	return 0;
 }
 
 
 static struct milenage_parameters * db_get_milenage(const char *imsi_txt)
 {
-	char cmd[128];
+	struct milenage_parameters *m = &db_tmp_milenage;
 	unsigned long long imsi;
+	int ret;
 
-	os_memset(&db_tmp_milenage, 0, sizeof(db_tmp_milenage));
+	os_memset(m, 0, sizeof(*m));
 	imsi = atoll(imsi_txt);
-	os_snprintf(db_tmp_milenage.imsi, sizeof(db_tmp_milenage.imsi),
-		    "%llu", imsi);
-	os_snprintf(cmd, sizeof(cmd),
-		    "SELECT * FROM milenage WHERE imsi=%llu;", imsi);
-	if (sqlite3_exec(sqlite_db, cmd, get_milenage_cb, &db_tmp_milenage,
-			 NULL) != SQLITE_OK)
+	os_snprintf(m->imsi, sizeof(m->imsi), "%llu", imsi);
+
+	sqlite3_reset(db_get_stmt);
+	if (sqlite3_bind_int64(db_get_stmt, 1, imsi) != SQLITE_OK)
 		return NULL;
+	ret = sqlite3_step(db_get_stmt);
+	if (ret == SQLITE_ROW &&
+	    db_get_hex(0, m->ki, sizeof(m->ki), "ki") == 0 &&
+	    db_get_hex(1, m->opc, sizeof(m->opc), "opc") == 0 &&
+	    db_get_hex(2, m->amf, sizeof(m->amf), "amf") == 0 &&
+	    db_get_hex(3, m->sqn, sizeof(m->sqn), "sqn") == 0) {
+		if (sqlite3_column_type(db_get_stmt, 4) != SQLITE_NULL)
+			m->res_len = sqlite3_column_int(db_get_stmt, 4);
+		m->set = 1;
+	}
+	sqlite3_reset(db_get_stmt);
 
-	if (!db_tmp_milenage.set)
+	if (!m->set)
 		return NULL;
-	return &db_tmp_milenage;
+	return m;
 }
 
 
 static int db_update_milenage_sqn(struct milenage_parameters *m)
 {
-	char cmd[128], val[13], *pos;
+	char val[13];
 
 	if (sqlite_db == NULL)
 		return 0;
 
-	pos = val;
-	pos += wpa_snprintf_hex(pos, sizeof(val), m->sqn, 6);
-	*pos = '\0';
-	os_snprintf(cmd, sizeof(cmd),
-		    "UPDATE milenage SET sqn='%s' WHERE imsi=%s;",
-		    val, m->imsi);
-	if (sqlite3_exec(sqlite_db, cmd, NULL, NULL, NULL) != SQLITE_OK) {
+	if (!db_in_transaction) {
+		if (sqlite3_exec(sqlite_db, "BEGIN;", NULL, NULL, NULL) ==
+		    SQLITE_OK) {
+			db_in_transaction = 1;
+		} else if (!sqlite3_get_autocommit(sqlite_db)) {
+			/* A transaction is still open after a failed
+			 * ROLLBACK; include the update in it so that the
+			 * response is held until it has been committed. */
+			db_in_transaction = 1;
+		} else {
+			printf("Failed to start database transaction: %s\n",
+			       sqlite3_errmsg(sqlite_db));
+		}
+	}
+
+	wpa_snprintf_hex(val, sizeof(val), m->sqn, 6);
+	sqlite3_reset(db_update_stmt);
+	if (sqlite3_bind_text(db_update_stmt, 1, val, -1,
+			      SQLITE_TRANSIENT) != SQLITE_OK ||
+	    sqlite3_bind_int64(db_update_stmt, 2, atoll(m->imsi)) !=
+	    SQLITE_OK ||
+	    sqlite3_step(db_update_stmt) != SQLITE_DONE) {
 		printf("Failed to update SQN in database for IMSI %s\n",
 		       m->imsi);
+		sqlite3_reset(db_update_stmt);
 		return -1;
 	}
+	sqlite3_reset(db_update_stmt);
 	return 0;
 }
 
+
+static void send_resp(int s, const char *resp, const struct sockaddr_un *from,
+		      socklen_t fromlen);
+
+/* Reply with "<type> <IMSI> FAILURE" to a request whose response was not
+ * sent since the SQN update was not stored */
+static void db_send_failure(int s, const struct db_pending_resp *p)
+{
+	char resp[100];
+	const char *pos;
+
+	pos = os_strchr(p->resp, ' ');
+	if (pos)
+		pos = os_strchr(pos + 1, ' ');
+	if (!pos || pos - p->resp > 80)
+		return;
+	os_snprintf(resp, sizeof(resp), "%.*s FAILURE",
+		    (int) (pos - p->resp), p->resp);
+	send_resp(s, resp, &p->addr, p->addrlen);
+}
+
+
+static void db_commit(int s)
+{
+	unsigned int i;
+	int failed = 0;
+
+	if (db_in_transaction) {
+		if (sqlite3_exec(sqlite_db, "COMMIT;", NULL, NULL, NULL) !=
+		    SQLITE_OK) {
+			printf("Failed to commit database transaction: %s\n",
+			       sqlite3_errmsg(sqlite_db));
+			/* SQLite keeps the transaction open after a failed
+			 * COMMIT (e.g., SQLITE_BUSY). Roll it back so that the
+			 * SQN values that were not stored are not given out
+			 * and the next update starts a new transaction. */
+			if (sqlite3_exec(sqlite_db, "ROLLBACK;", NULL, NULL,
+					 NULL) != SQLITE_OK)
+				printf("Failed to roll back database transaction: %s\n",
+				       sqlite3_errmsg(sqlite_db));
+			failed = 1;
+		}
+		db_in_transaction = 0;
+	}
+
+	for (i = 0; i < db_num_pending; i++) {
+		if (s >= 0 && failed)
+			db_send_failure(s, &db_pending[i]);
+		else if (s >= 0)
+			send_resp(s, db_pending[i].resp, &db_pending[i].addr,
+				  db_pending[i].addrlen);
+		os_free(db_pending[i].resp);
+	}
+	db_num_pending = 0;
+}
+
+
+/* Returns 1 if the response was queued to be sent after the commit */
+static int db_queue_resp(int s, const char *resp,
+			 const struct sockaddr_un *from, socklen_t fromlen)
+{
+	struct db_pending_resp *p;
+
+	if (!db_in_transaction)
+		return 0;
+
+	p = &db_pending[db_num_pending];
+	p->resp = os_strdup(resp);
+	if (!p->resp) {
+		db_commit(s);
+		return 0;
+	}
+	os_memcpy(&p->addr, from, fromlen);
+	p->addrlen = fromlen;
+	if (++db_num_pending == DB_MAX_PENDING)
+		db_commit(s);
+	return 1;
+}
+
 #endif /* CONFIG_SQLITE */
 
 
@@ -384,6 +515,60 @@ static struct gsm_triplet * get_gsm_triplet(const char *imsi)
 }
 
 
+static unsigned int milenage_hash_imsi(const char *imsi)
+{
+	unsigned int hash = 2166136261U; /* FNV-1a */
+
+	while (*imsi) {
+		hash ^= (u8) *imsi++;
+		hash *= 16777619;
+	}
+	return hash & (milenage_hash_size - 1);
+}
+
+
+static struct milenage_parameters * milenage_hash_get(const char *imsi)
+{
+	struct milenage_parameters *m;
+
+	if (!milenage_hash)
+		return NULL;
+	for (m = milenage_hash[milenage_hash_imsi(imsi)]; m; m = m->hnext) {
+		if (strcmp(m->imsi, imsi) == 0)
+			break;
+	}
+	return m;
+}
+
+
+static int milenage_hash_build(void)
+{
+	struct milenage_parameters *m;
+	unsigned int count = 0, idx;
+
+	for (m = milenage_db; m; m = m->next)
+		count++;
+	milenage_hash_size = 16;
+	while (milenage_hash_size < count)
+		milenage_hash_size <<= 1;
+	milenage_hash = os_calloc(milenage_hash_size, sizeof(*milenage_hash));
+	if (!milenage_hash)
+		return -1;
+
+	/* The first entry in milenage_db (the last one in the file) is used
+	 * for an IMSI that is listed more than once */
+	for (m = milenage_db; m; m = m->next) {
+		if (milenage_hash_get(m->imsi))
+			continue;
+		idx = milenage_hash_imsi(m->imsi);
+		m->hnext = milenage_hash[idx];
+		milenage_hash[idx] = m;
+	}
+
+	return 0;
+}
+
+
 static int read_milenage(const char *fname)
 {
 	FILE *f;
@@ -489,6 +674,9 @@ static int read_milenage(const char *fname)
 
 	fclose(f);
 
+	if (ret == 0)
+		ret = milenage_hash_build();
+
 	return ret;
 }
 
@@ -499,6 +687,7 @@ static void update_milenage_file(const char *fname)
 	char name[500], buf[500], *pos;
 	char *end = buf + sizeof(buf);
 	struct milenage_parameters *m;
+	char imsi[20];
 	size_t imsi_len;
 
 	f = fopen(fname, "r");
@@ -524,12 +713,9 @@ static void update_milenage_file(const char *fname)
 			goto no_update;
 
 		imsi_len = pos - buf;
-
-		for (m = milenage_db; m; m = m->next) {
-			if (strncmp(buf, m->imsi, imsi_len) == 0 &&
-			    m->imsi[imsi_len] == '\0')
-				break;
-		}
+		os_memcpy(imsi, buf, imsi_len);
+		imsi[imsi_len] = '\0';
+		m = milenage_hash_get(imsi);
 
 		if (!m)
 			goto no_update;
@@ -569,13 +755,9 @@ static void update_milenage_file(const char *fname)
 
 static struct milenage_parameters * get_milenage(const char *imsi)
 {
-	struct milenage_parameters *m = milenage_db;
+	struct milenage_parameters *m;
 
-	while (m) {
-		if (strcmp(m->imsi, imsi) == 0)
-			break;
-		m = m->next;
-	}
+	m = milenage_hash_get(imsi);
 
 #ifdef CONFIG_SQLITE
 	if (!m)
@@ -614,17 +796,20 @@ static int sim_req_auth(char *imsi, char *resp, size_t resp_len)
 
 	m = get_milenage(imsi);
 	if (m) {
-		u8 _rand[16], sres[4], kc[8];
+		u8 _rand[EAP_SIM_MAX_CHAL][16], sres[4], kc[8];
+
+		/* Fetch all RANDs at once; each call reads /dev/urandom */
+		if (random_get_bytes(_rand[0], max_chal * 16) < 0)
+			return -1;
 		for (count = 0; count < max_chal; count++) {
-			if (random_get_bytes(_rand, 16) < 0)
-				return -1;
-			gsm_milenage(m->opc, m->ki, _rand, sres, kc);
+			gsm_milenage(m->opc, m->ki, _rand[count], sres, kc);
 			*rpos++ = ' ';
 			rpos += wpa_snprintf_hex(rpos, rend - rpos, kc, 8);
 			*rpos++ = ':';
 			rpos += wpa_snprintf_hex(rpos, rend - rpos, sres, 4);
 			*rpos++ = ':';
-			rpos += wpa_snprintf_hex(rpos, rend - rpos, _rand, 16);
+			rpos += wpa_snprintf_hex(rpos, rend - rpos,
+						 _rand[count], 16);
 		}
 		*rpos = '\0';
 		return 0;
@@ -882,6 +1067,15 @@ static int process_cmd(char *cmd, char *resp, size_t resp_len)
 }
 
 
+static void send_resp(int s, const char *resp, const struct sockaddr_un *from,
+		      socklen_t fromlen)
+{
+	if (sendto(s, resp, os_strlen(resp), 0, (const struct sockaddr *) from,
+		   fromlen) < 0)
+		perror("send");
+}
+
+
 static int process(int s)
 {
 	char buf[1000], resp[1000];
@@ -918,19 +1112,41 @@ static int process(int s)
 
 	printf("Send: %s\n", resp);
 
-	if (sendto(s, resp, os_strlen(resp), 0, (struct sockaddr *) &from,
-		   fromlen) < 0)
-		perror("send");
+#ifdef CONFIG_SQLITE
+	if (db_queue_resp(s, resp, &from, fromlen))
+		return 0;
+#endif /* CONFIG_SQLITE */
+	send_resp(s, resp, &from, fromlen);
 
 	return 0;
 }
 
 
+#ifdef CONFIG_SQLITE
+static int socket_idle(int s)
+{
+	fd_set rfds;
+	struct timeval tv;
+
+	FD_ZERO(&rfds);
+	FD_SET(s, &rfds);
+	tv.tv_sec = 0;
+	tv.tv_usec = 0;
+	return select(s + 1, &rfds, NULL, NULL, &tv) == 0;
+}
+#endif /* CONFIG_SQLITE */
+
+
 static void cleanup(void)
 {
 	struct gsm_triplet *g, *gprev;
 	struct milenage_parameters *m, *prev;
 
+#ifdef CONFIG_SQLITE
+	if (sqlite_db)
+		db_commit(serv_sock);
+#endif /* CONFIG_SQLITE */
+
 	if (update_milenage && milenage_file && sqn_changes)
 		update_milenage_file(milenage_file);
 
@@ -947,6 +1163,7 @@ static void cleanup(void)
 		m = m->next;
 		os_free(prev);
 	}
+	os_free(milenage_hash);
 
 	if (serv_sock >= 0)
 		close(serv_sock);
@@ -954,10 +1171,8 @@ static void cleanup(void)
 		unlink(socket_path);
 
 #ifdef CONFIG_SQLITE
-	if (sqlite_db) {
-		sqlite3_close(sqlite_db);
-		sqlite_db = NULL;
-	}
+	if (sqlite_db)
+		db_close();
 #endif /* CONFIG_SQLITE */
 }
 
@@ -1081,8 +1296,14 @@ int main(int argc, char *argv[])
 		signal(SIGTERM, handle_term);
 		signal(SIGINT, handle_term);
 
-		for (;;)
+		for (;;) {
+#ifdef CONFIG_SQLITE
+			if ((db_in_transaction || db_num_pending) &&
+			    socket_idle(serv_sock))
+				db_commit(serv_sock);
+#endif /* CONFIG_SQLITE */
 			process(serv_sock);
+		}
 	} else {
 		char buf[1000];
 		socket_path = NULL;
@@ -1097,10 +1318,8 @@ int main(int argc, char *argv[])
 	}
 
 #ifdef CONFIG_SQLITE
-	if (sqlite_db) {
-		sqlite3_close(sqlite_db);
-		sqlite_db = NULL;
-	}
+	if (sqlite_db)
+		db_close();
 #endif /* CONFIG_SQLITE */
 
 	os_program_deinit();
@@ -934,6 +934,7 @@ int main(int argc, char *argv[])
 
 	fst_global_deinit();
 
+	wpabuf_pool_flush();
 	os_program_deinit();
 
 	return ret;
@@ -65,6 +65,7 @@ void hostapd_config_defaults_bss(struct hostapd_bss_config *bss)
 	bss->auth_algs = WPA_AUTH_ALG_OPEN;
 #endif /* CONFIG_WEP */
 	bss->eap_reauth_period = 3600;
+	bss->eap_user_sqlite_cache = 256;
 
 	bss->wpa_group_rekey = 600;
 	bss->wpa_gmk_rekey = 86400;
@@ -120,11 +121,14 @@ void hostapd_config_defaults_bss(struct hostapd_bss_config *bss)
 #endif /* CONFIG_IEEE80211R_AP */
 
 	bss->radius_das_time_window = 300;
+	bss->radius_acl_cache_ttl = 30;
+	bss->radius_acl_negative_ttl = 30;
 
 	bss->anti_clogging_threshold = 5;
 	bss->sae_sync = 5;
 
 	bss->gas_frag_limit = 1400;
+	bss->gas_dialog_mem_limit = 1048576;
 
 #ifdef CONFIG_FILS
 	dl_list_init(&bss->fils_realms);
@@ -147,6 +151,8 @@ void hostapd_config_defaults_bss(struct hostapd_bss_config *bss)
 
 	bss->max_auth_rounds = 100;
 	bss->max_auth_rounds_short = 50;
+	bss->radius_framed_mtu = 1400;
+	bss->tls_verify_cache_lifetime = 300;
 
 	bss->send_probe_response = 1;
 
@@ -772,13 +778,14 @@ void hostapd_config_free_bss(struct hostapd_bss_config *conf)
 	sae_deinit_pt(conf->ssid.pt);
 #endif /* CONFIG_SAE */
 
+	hostapd_eap_user_index_free(conf->eap_user_index);
 	hostapd_config_free_eap_users(conf->eap_user);
 	os_free(conf->eap_user_sqlite);
 
 	os_free(conf->eap_req_id_text);
 	os_free(conf->erp_domain);
-	os_free(conf->accept_mac);
-	os_free(conf->deny_mac);
+	hostapd_mac_acl_clear(&conf->accept_mac);
+	hostapd_mac_acl_clear(&conf->deny_mac);
 	os_free(conf->nas_identifier);
 	if (conf->radius) {
 		hostapd_config_free_radius(conf->radius->auth_servers,
@@ -800,7 +807,9 @@ void hostapd_config_free_bss(struct hostapd_bss_config *conf)
 	os_free(conf->private_key_passwd);
 	os_free(conf->private_key_passwd2);
 	os_free(conf->check_cert_subject);
+	os_free(conf->tls_session_cache);
 	os_free(conf->ocsp_stapling_response);
+	os_free(conf->ocsp_stapling_response2);
 	os_free(conf->ocsp_stapling_response_multi);
 	os_free(conf->dh_file);
 	os_free(conf->openssl_ciphers);
@@ -971,6 +980,8 @@ void hostapd_config_free_bss(struct hostapd_bss_config *conf)
 	os_free(conf->pasn_groups);
 #endif /* CONFIG_PASN */
 
+	wpabuf_clear_free(conf->config_items);
+
 	os_free(conf);
 }
 
@@ -1004,42 +1015,6 @@ void hostapd_config_free(struct hostapd_config *conf)
 }
 
 
-/**
- * hostapd_maclist_found - Find a MAC address from a list
- * @list: MAC address list
- * @num_entries: Number of addresses in the list
- * @addr: Address to search for
- * @vlan_id: Buffer for returning VLAN ID or %NULL if not needed
- * Returns: 1 if address is in the list or 0 if not.
- *
- * Perform a binary search for given MAC address from a pre-sorted list.
- */
-int hostapd_maclist_found(struct mac_acl_entry *list, int num_entries,
-			  const u8 *addr, struct vlan_description *vlan_id)
-{
-	int start, end, middle, res;
-
-	start = 0;
-	end = num_entries - 1;
-
-	while (start <= end) {
-		middle = (start + end) / 2;
-		res = os_memcmp(list[middle].addr, addr, ETH_ALEN);
-		if (res == 0) {
-			if (vlan_id)
-				*vlan_id = list[middle].vlan_id;
-			return 1;
-		}
-		if (res < 0)
-			start = middle + 1;
-		else
-			end = middle - 1;
-	}
-
-	return 0;
-}
-
-
 int hostapd_rate_found(int *list, int rate)
 {
 	int i;
@@ -1653,3 +1628,361 @@ bool hostapd_sae_pk_exclusively(struct hostapd_bss_config *conf)
 	return with_pk;
 }
 #endif /* CONFIG_SAE_PK */
+
+
+void hostapd_bss_config_add_item(struct hostapd_bss_config *bss,
+				 const char *name, const char *value,
+				 const char *extra)
+{
+	struct wpabuf *buf;
+	size_t len;
+
+	if (bss->config_items_invalid)
+		return;
+
+	len = os_strlen(name) + os_strlen(value) + 3 +
+		(extra ? os_strlen(extra) : 0);
+	if (!bss->config_items ||
+	    wpabuf_tailroom(bss->config_items) < len) {
+		size_t add = bss->config_items ?
+			wpabuf_len(bss->config_items) : 1024;
+
+		/*
+		 * The items include keys and passphrases, so do not use
+		 * realloc() that could leave a copy of the old buffer behind.
+		 */
+		buf = wpabuf_alloc((bss->config_items ?
+				    wpabuf_len(bss->config_items) : 0) +
+				   (add > len ? add : len));
+		if (buf && bss->config_items)
+			wpabuf_put_buf(buf, bss->config_items);
+		wpabuf_clear_free(bss->config_items);
+		bss->config_items = buf;
+		if (!buf) {
+			bss->config_items_invalid = true;
+			return;
+		}
+	}
+
+	wpabuf_printf(bss->config_items, "%s=%s%s%s\n", name, value,
+		      extra ? " " : "", extra ? extra : "");
+}
+
+
+/**
+ * hostapd_config_invalidate_items - Mark configuration as modified
+ * @conf: Configuration data
+ *
+ * This is called when the configuration is modified after it has been read
+ * from a file so that a reload does not assume that unchanged configuration
+ * file items mean an unchanged configuration.
+ */
+void hostapd_config_invalidate_items(struct hostapd_config *conf)
+{
+	size_t i;
+
+	for (i = 0; i < conf->num_bss; i++) {
+		wpabuf_clear_free(conf->bss[i]->config_items);
+		conf->bss[i]->config_items = NULL;
+		conf->bss[i]->config_items_invalid = true;
+	}
+}
+
+
+/*
+ * BSS configuration items that can be changed without reinitializing the BSS.
+ * Any other changed item requires the full reload sequence.
+ */
+static const struct hostapd_config_item_change {
+	const char *name;
+	unsigned int change;
+} hostapd_config_item_changes[] = {
+	{ "ignore_broadcast_ssid", HOSTAPD_BSS_CHANGE_BEACON },
+	{ "dtim_period", HOSTAPD_BSS_CHANGE_BEACON },
+	{ "utf8_ssid", HOSTAPD_BSS_CHANGE_BEACON },
+	{ "uapsd_advertisement_enabled", HOSTAPD_BSS_CHANGE_BEACON },
+	{ "bss_transition", HOSTAPD_BSS_CHANGE_BEACON },
+	{ "rrm_neighbor_report", HOSTAPD_BSS_CHANGE_BEACON },
+	{ "rrm_beacon_report", HOSTAPD_BSS_CHANGE_BEACON },
+	{ "vendor_elements", HOSTAPD_BSS_CHANGE_BEACON },
+	{ "assocresp_elements", HOSTAPD_BSS_CHANGE_BEACON },
+	{ "interworking", HOSTAPD_BSS_CHANGE_BEACON },
+	{ "access_network_type", HOSTAPD_BSS_CHANGE_BEACON },
+	{ "internet", HOSTAPD_BSS_CHANGE_BEACON },
+	{ "asra", HOSTAPD_BSS_CHANGE_BEACON },
+	{ "esr", HOSTAPD_BSS_CHANGE_BEACON },
+	{ "uesa", HOSTAPD_BSS_CHANGE_BEACON },
+	{ "venue_group", HOSTAPD_BSS_CHANGE_BEACON },
+	{ "venue_type", HOSTAPD_BSS_CHANGE_BEACON },
+	{ "hessid", HOSTAPD_BSS_CHANGE_BEACON },
+	{ "roaming_consortium", HOSTAPD_BSS_CHANGE_BEACON },
+	{ "macaddr_acl", HOSTAPD_BSS_CHANGE_ACL },
+	{ "accept_mac_file", HOSTAPD_BSS_CHANGE_ACL },
+	{ "deny_mac_file", HOSTAPD_BSS_CHANGE_ACL },
+	{ "radius_acl_cache_ttl", HOSTAPD_BSS_CHANGE_ACL },
+	{ "radius_acl_negative_ttl", HOSTAPD_BSS_CHANGE_ACL },
+	{ "auth_server_addr", HOSTAPD_BSS_CHANGE_RADIUS },
+	{ "auth_server_port", HOSTAPD_BSS_CHANGE_RADIUS },
+	{ "auth_server_shared_secret", HOSTAPD_BSS_CHANGE_RADIUS },
+	{ "acct_server_addr", HOSTAPD_BSS_CHANGE_RADIUS },
+	{ "acct_server_port", HOSTAPD_BSS_CHANGE_RADIUS },
+	{ "acct_server_shared_secret", HOSTAPD_BSS_CHANGE_RADIUS },
+	{ "radius_retry_primary_interval", HOSTAPD_BSS_CHANGE_RADIUS },
+	{ "radius_acct_interim_interval", HOSTAPD_BSS_CHANGE_RADIUS },
+	{ "radius_client_addr", HOSTAPD_BSS_CHANGE_RADIUS },
+	{ "radius_client_dev", HOSTAPD_BSS_CHANGE_RADIUS },
+	{ "radius_auth_req_attr", HOSTAPD_BSS_CHANGE_RADIUS },
+	{ "radius_acct_req_attr", HOSTAPD_BSS_CHANGE_RADIUS },
+	{ "nas_identifier", HOSTAPD_BSS_CHANGE_RADIUS },
+	{ "logger_syslog", HOSTAPD_BSS_CHANGE_OTHER },
+	{ "logger_syslog_level", HOSTAPD_BSS_CHANGE_OTHER },
+	{ "logger_stdout", HOSTAPD_BSS_CHANGE_OTHER },
+	{ "logger_stdout_level", HOSTAPD_BSS_CHANGE_OTHER },
+	{ "ap_max_inactivity", HOSTAPD_BSS_CHANGE_OTHER },
+	{ "skip_inactivity_poll", HOSTAPD_BSS_CHANGE_OTHER },
+	{ "max_listen_interval", HOSTAPD_BSS_CHANGE_OTHER },
+	{ "disassoc_low_ack", HOSTAPD_BSS_CHANGE_OTHER },
+	{ "eap_user_file", HOSTAPD_BSS_CHANGE_OTHER },
+	{ "eap_user_sqlite", HOSTAPD_BSS_CHANGE_OTHER },
+	{ "network_auth_type", HOSTAPD_BSS_CHANGE_OTHER },
+	{ "ipaddr_type_availability", HOSTAPD_BSS_CHANGE_OTHER },
+	{ "domain_name", HOSTAPD_BSS_CHANGE_OTHER },
+	{ "anqp_3gpp_cell_net", HOSTAPD_BSS_CHANGE_OTHER },
+	{ "nai_realm", HOSTAPD_BSS_CHANGE_OTHER },
+	{ "anqp_elem", HOSTAPD_BSS_CHANGE_OTHER },
+	{ "venue_name", HOSTAPD_BSS_CHANGE_OTHER },
+	{ "venue_url", HOSTAPD_BSS_CHANGE_OTHER },
+	{ "hs20_oper_friendly_name", HOSTAPD_BSS_CHANGE_OTHER },
+	{ "hs20_wan_metrics", HOSTAPD_BSS_CHANGE_OTHER },
+	{ "hs20_conn_capab", HOSTAPD_BSS_CHANGE_OTHER },
+	{ "hs20_operating_class", HOSTAPD_BSS_CHANGE_OTHER },
+	{ NULL, 0 }
+};
+
+
+struct hostapd_config_line {
+	const char *pos;
+	size_t len;
+	unsigned int change;
+};
+
+
+static struct hostapd_config_line *
+hostapd_config_lines(const struct wpabuf *items, size_t *num)
+{
+	const char *pos, *end, *eol, *eq;
+	const struct hostapd_config_item_change *item;
+	struct hostapd_config_line *lines;
+	size_t count = 0;
+
+	pos = wpabuf_head(items);
+	end = pos + wpabuf_len(items);
+	for (eol = pos; eol < end; eol++) {
+		if (*eol == '\n')
+			count++;
+	}
+
+	lines = os_calloc(count ? count : 1, sizeof(*lines));
+	if (!lines)
+		return NULL;
+
+	count = 0;
+	while (pos < end) {
+		for (eol = pos, eq = NULL; eol < end && *eol != '\n'; eol++) {
+			if (!eq && *eol == '=')
+				eq = eol;
+		}
+		if (eol == end)
+			break;
+		lines[count].pos = pos;
+		lines[count].len = eol - pos;
+		lines[count].change = HOSTAPD_BSS_CHANGE_FULL;
+		for (item = hostapd_config_item_changes; eq && item->name;
+		     item++) {
+			if ((size_t) (eq - pos) == os_strlen(item->name) &&
+			    os_memcmp(pos, item->name, eq - pos) == 0) {
+				lines[count].change = item->change;
+				break;
+			}
+		}
+		count++;
+		pos = eol + 1;
+	}
+
+	*num = count;
+	return lines;
+}
+
+
+static int hostapd_config_lines_equal(const struct hostapd_config_line *a,
+				      size_t num_a,
+				      const struct hostapd_config_line *b,
+				      size_t num_b, unsigned int change)
+{
+	size_t i = 0, j = 0;
+
+	for (;;) {
+		while (i < num_a && a[i].change != change)
+			i++;
+		while (j < num_b && b[j].change != change)
+			j++;
+		if (i == num_a || j == num_b)
+			return i == num_a && j == num_b;
+		if (a[i].len != b[j].len ||
+		    os_memcmp(a[i].pos, b[j].pos, a[i].len) != 0)
+			return 0;
+		i++;
+		j++;
+	}
+}
+
+
+/**
+ * hostapd_bss_config_diff - Compare two BSS configurations
+ * @old: Configuration currently in use
+ * @new: Configuration read from the configuration file
+ * Returns: Bitmap of HOSTAPD_BSS_CHANGE_* values
+ *
+ * The configurations are compared item by item based on the configuration
+ * file lines recorded when the configurations were read. The items of each
+ * change class are compared as ordered sequences since later items may
+ * modify the earlier ones (e.g., RADIUS server address and port).
+ */
+unsigned int hostapd_bss_config_diff(const struct hostapd_bss_config *old,
+				     const struct hostapd_bss_config *new)
+{
+	static const unsigned int classes[] = {
+		HOSTAPD_BSS_CHANGE_BEACON, HOSTAPD_BSS_CHANGE_ACL,
+		HOSTAPD_BSS_CHANGE_RADIUS, HOSTAPD_BSS_CHANGE_OTHER,
+		HOSTAPD_BSS_CHANGE_FULL
+	};
+	struct hostapd_config_line *a, *b;
+	size_t num_a, num_b, i;
+	unsigned int changes = 0;
+
+	if (!old->config_items || !new->config_items)
+		return HOSTAPD_BSS_CHANGE_FULL;
+
+	if (wpabuf_len(old->config_items) == wpabuf_len(new->config_items) &&
+	    os_memcmp(wpabuf_head(old->config_items),
+		      wpabuf_head(new->config_items),
+		      wpabuf_len(new->config_items)) == 0)
+		goto acl;
+
+	a = hostapd_config_lines(old->config_items, &num_a);
+	b = hostapd_config_lines(new->config_items, &num_b);
+	if (!a || !b) {
+		os_free(a);
+		os_free(b);
+		return HOSTAPD_BSS_CHANGE_FULL;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(classes); i++) {
+		if (!hostapd_config_lines_equal(a, num_a, b, num_b, classes[i]))
+			changes |= classes[i];
+	}
+
+	os_free(a);
+	os_free(b);
+
+acl:
+	/* The ACLs may have been modified through the control interface */
+	if (!hostapd_mac_acl_equal(&old->accept_mac, &new->accept_mac) ||
+	    !hostapd_mac_acl_equal(&old->deny_mac, &new->deny_mac))
+		changes |= HOSTAPD_BSS_CHANGE_ACL;
+
+	return changes;
+}
+
+
+int hostapd_bss_changes_txt(unsigned int changes, char *buf, size_t buflen)
+{
+	static const struct {
+		unsigned int change;
+		const char *name;
+	} names[] = {
+		{ HOSTAPD_BSS_CHANGE_BEACON, "beacon" },
+		{ HOSTAPD_BSS_CHANGE_ACL, "acl" },
+		{ HOSTAPD_BSS_CHANGE_RADIUS, "radius" },
+		{ HOSTAPD_BSS_CHANGE_OTHER, "other" },
+		{ HOSTAPD_BSS_CHANGE_FULL, "full" },
+	};
+	char *pos = buf, *end = buf + buflen;
+	size_t i;
+	int ret;
+
+	if (buflen == 0)
+		return 0;
+	*buf = '\0';
+
+	for (i = 0; i < ARRAY_SIZE(names); i++) {
+		if (!(changes & names[i].change))
+			continue;
+		ret = os_snprintf(pos, end - pos, "%s%s",
+				  pos == buf ? "" : ",", names[i].name);
+		if (os_snprintf_error(end - pos, ret))
+			return pos - buf;
+		pos += ret;
+	}
+
+	if (pos == buf) {
+		ret = os_snprintf(pos, end - pos, "none");
+		if (!os_snprintf_error(end - pos, ret))
+			pos += ret;
+	}
+
+	return pos - buf;
+}
+
+
+/**
+ * hostapd_bss_config_move_state - Move run time state to a new configuration
+ * @conf: New BSS configuration
+ * @old: Current BSS configuration that will be freed
+ *
+ * This is used when a reloaded configuration replaces the current one without
+ * reinitializing the BSS. hostapd_bss_config_diff() must not have reported
+ * HOSTAPD_BSS_CHANGE_FULL, i.e., SSID, passphrases, PSK file, and VLAN
+ * configuration are unchanged, so the derived PSKs and SAE PTs can be reused
+ * instead of being derived again, and the VLAN list with its dynamically added
+ * entries stays valid.
+ */
+void hostapd_bss_config_move_state(struct hostapd_bss_config *conf,
+				   struct hostapd_bss_config *old)
+{
+	struct hostapd_wpa_psk *psk;
+	struct hostapd_vlan *vlan;
+#ifdef CONFIG_SAE
+	struct sae_password_entry *pw, *opw;
+	struct sae_pt *pt;
+#endif /* CONFIG_SAE */
+
+	psk = conf->ssid.wpa_psk;
+	conf->ssid.wpa_psk = old->ssid.wpa_psk;
+	old->ssid.wpa_psk = psk;
+
+	vlan = conf->vlan;
+	conf->vlan = old->vlan;
+	old->vlan = vlan;
+
+#ifdef CONFIG_SAE
+	pt = conf->ssid.pt;
+	conf->ssid.pt = old->ssid.pt;
+	old->ssid.pt = pt;
+
+	for (pw = conf->sae_passwords, opw = old->sae_passwords; pw && opw;
+	     pw = pw->next, opw = opw->next) {
+		pt = pw->pt;
+		pw->pt = opw->pt;
+		opw->pt = pt;
+	}
+#endif /* CONFIG_SAE */
+
+#ifdef CONFIG_OWE
+	os_memcpy(conf->owe_transition_bssid, old->owe_transition_bssid,
+		  ETH_ALEN);
+	os_memcpy(conf->owe_transition_ssid, old->owe_transition_ssid,
+		  old->owe_transition_ssid_len);
+	conf->owe_transition_ssid_len = old->owe_transition_ssid_len;
+#endif /* CONFIG_OWE */
+}
@@ -64,6 +64,24 @@ struct mac_acl_entry {
 	struct vlan_description vlan_id;
 };
 
+/**
+ * struct hostapd_mac_acl - MAC address access control list
+ * @entries: ACL entries in no particular order
+ * @num: Number of entries in @entries
+ * @entries_size: Number of entries allocated for @entries
+ * @table: Hash table of @entries indexes (see mac_acl.c)
+ * @table_size: Number of slots in @table (a power of two)
+ * @table_used: Number of used (including deleted) slots in @table
+ */
+struct hostapd_mac_acl {
+	struct mac_acl_entry *entries;
+	int num;
+	unsigned int entries_size;
+	u32 *table;
+	unsigned int table_size;
+	unsigned int table_used;
+};
+
 struct hostapd_radius_servers;
 struct ft_remote_r0kh;
 struct ft_remote_r1kh;
@@ -285,6 +303,9 @@ struct hostapd_bss_config {
 	unsigned int logger_stdout; /* module bitfield */
 
 	int max_num_sta; /* maximum number of STAs in station table */
+	/* Per-station object pools (sta_info, WPA and EAPOL state machines) */
+	unsigned int sta_pool_prealloc; /* objects preallocated per pool */
+	unsigned int sta_pool_max; /* objects in use per pool; 0 = no limit */
 
 	int dtim_period;
 	unsigned int bss_load_update_period;
@@ -295,7 +316,9 @@ struct hostapd_bss_config {
 	int eap_server; /* Use internal EAP server instead of external
 			 * RADIUS server */
 	struct hostapd_eap_user *eap_user;
+	struct hostapd_eap_user_index *eap_user_index;
 	char *eap_user_sqlite;
+	unsigned int eap_user_sqlite_cache;
 	char *eap_sim_db;
 	unsigned int eap_sim_db_timeout;
 	int eap_server_erp; /* Whether ERP is enabled on internal EAP server */
@@ -304,6 +327,7 @@ struct hostapd_bss_config {
 	struct hostapd_radius_servers *radius;
 	int acct_interim_interval;
 	int radius_request_cui;
+	int radius_framed_mtu;
 	struct hostapd_radius_attr *radius_auth_req_attr;
 	struct hostapd_radius_attr *radius_acct_req_attr;
 	char *radius_req_attr_sqlite;
@@ -337,10 +361,10 @@ struct hostapd_bss_config {
 		DENY_UNLESS_ACCEPTED = 1,
 		USE_EXTERNAL_RADIUS_AUTH = 2
 	} macaddr_acl;
-	struct mac_acl_entry *accept_mac;
-	int num_accept_mac;
-	struct mac_acl_entry *deny_mac;
-	int num_deny_mac;
+	struct hostapd_mac_acl accept_mac;
+	struct hostapd_mac_acl deny_mac;
+	unsigned int radius_acl_cache_ttl;
+	unsigned int radius_acl_negative_ttl;
 	int wds_sta;
 	int isolate;
 	int start_disabled;
@@ -418,10 +442,15 @@ struct hostapd_bss_config {
 	int check_crl_strict;
 	unsigned int crl_reload_interval;
 	unsigned int tls_session_lifetime;
+	char *tls_session_cache;
+	unsigned int tls_session_cache_size;
+	unsigned int tls_verify_cache_size;
+	unsigned int tls_verify_cache_lifetime;
 	unsigned int tls_flags;
 	unsigned int max_auth_rounds;
 	unsigned int max_auth_rounds_short;
 	char *ocsp_stapling_response;
+	char *ocsp_stapling_response2;
 	char *ocsp_stapling_response_multi;
 	char *dh_file;
 	char *openssl_ciphers;
@@ -592,6 +621,7 @@ struct hostapd_bss_config {
 
 	u16 gas_comeback_delay;
 	size_t gas_frag_limit;
+	size_t gas_dialog_mem_limit;
 	int gas_address3;
 
 	u8 qos_map_set[16 + 2 * 21];
@@ -900,8 +930,23 @@ struct hostapd_bss_config {
 	u8 rnr;
 
 	unsigned int dot11RSNAConfigPMKLifetime;
+
+	/*
+	 * Configuration file items of this BSS ("name=value" lines) for
+	 * comparing configurations on reload. config_items_invalid is set if
+	 * the BSS configuration was modified in some other way.
+	 */
+	struct wpabuf *config_items;
+	bool config_items_invalid;
 };
 
+/* Subsystems affected by the changes between two BSS configurations */
+#define HOSTAPD_BSS_CHANGE_BEACON BIT(0)
+#define HOSTAPD_BSS_CHANGE_ACL BIT(1)
+#define HOSTAPD_BSS_CHANGE_RADIUS BIT(2)
+#define HOSTAPD_BSS_CHANGE_OTHER BIT(3) /* used directly from the config */
+#define HOSTAPD_BSS_CHANGE_FULL BIT(4) /* requires BSS reinitialization */
+
 /**
  * struct he_phy_capabilities_info - HE PHY capabilities
  */
@@ -1173,11 +1218,30 @@ void hostapd_config_defaults_bss(struct hostapd_bss_config *bss);
 void hostapd_config_free_radius_attr(struct hostapd_radius_attr *attr);
 void hostapd_config_free_eap_user(struct hostapd_eap_user *user);
 void hostapd_config_free_eap_users(struct hostapd_eap_user *user);
+struct hostapd_eap_user *
+hostapd_eap_user_find(struct hostapd_eap_user *user, const u8 *identity,
+		      size_t identity_len, int phase2);
+struct hostapd_eap_user_index *
+hostapd_eap_user_index_build(struct hostapd_eap_user *users);
+void hostapd_eap_user_index_free(struct hostapd_eap_user_index *idx);
+struct hostapd_eap_user *
+hostapd_eap_user_index_lookup(const struct hostapd_eap_user_index *idx,
+			      const u8 *identity, size_t identity_len,
+			      int phase2);
 void hostapd_config_clear_wpa_psk(struct hostapd_wpa_psk **p);
 void hostapd_config_free_bss(struct hostapd_bss_config *conf);
 void hostapd_config_free(struct hostapd_config *conf);
-int hostapd_maclist_found(struct mac_acl_entry *list, int num_entries,
-			  const u8 *addr, struct vlan_description *vlan_id);
+int hostapd_mac_acl_reserve(struct hostapd_mac_acl *acl, unsigned int num);
+int hostapd_mac_acl_add(struct hostapd_mac_acl *acl, const u8 *addr,
+			int vlan_id);
+int hostapd_mac_acl_del(struct hostapd_mac_acl *acl, const u8 *addr);
+const struct mac_acl_entry *
+hostapd_mac_acl_get(const struct hostapd_mac_acl *acl, const u8 *addr);
+void hostapd_mac_acl_clear(struct hostapd_mac_acl *acl);
+int hostapd_mac_acl_equal(const struct hostapd_mac_acl *a,
+			  const struct hostapd_mac_acl *b);
+int hostapd_maclist_found(const struct hostapd_mac_acl *acl, const u8 *addr,
+			  struct vlan_description *vlan_id);
 int hostapd_rate_found(int *list, int rate);
 const u8 * hostapd_get_psk(const struct hostapd_bss_config *conf,
 			   const u8 *addr, const u8 *p2p_dev_addr,
@@ -1197,5 +1261,14 @@ int hostapd_sae_pw_id_in_use(struct hostapd_bss_config *conf);
 bool hostapd_sae_pk_in_use(struct hostapd_bss_config *conf);
 bool hostapd_sae_pk_exclusively(struct hostapd_bss_config *conf);
 int hostapd_setup_sae_pt(struct hostapd_bss_config *conf);
+void hostapd_bss_config_add_item(struct hostapd_bss_config *bss,
+				 const char *name, const char *value,
+				 const char *extra);
+void hostapd_config_invalidate_items(struct hostapd_config *conf);
+unsigned int hostapd_bss_config_diff(const struct hostapd_bss_config *old,
+				     const struct hostapd_bss_config *new);
+int hostapd_bss_changes_txt(unsigned int changes, char *buf, size_t buflen);
+void hostapd_bss_config_move_state(struct hostapd_bss_config *conf,
+				   struct hostapd_bss_config *old);
 
 #endif /* HOSTAPD_CONFIG_H */
@@ -222,6 +222,7 @@ static struct eap_config * authsrv_eap_config(struct hostapd_data *hapd)
 		cfg->server_id_len = 7;
 	}
 	cfg->erp = hapd->conf->eap_server_erp;
+	cfg->stats = os_zalloc(sizeof(*cfg->stats));
 
 	return cfg;
 }
@@ -239,6 +240,11 @@ int authsrv_init(struct hostapd_data *hapd)
 
 		os_memset(&conf, 0, sizeof(conf));
 		conf.tls_session_lifetime = hapd->conf->tls_session_lifetime;
+		conf.tls_session_cache = hapd->conf->tls_session_cache;
+		conf.tls_session_cache_size = hapd->conf->tls_session_cache_size;
+		conf.tls_verify_cache_size = hapd->conf->tls_verify_cache_size;
+		conf.tls_verify_cache_lifetime =
+			hapd->conf->tls_verify_cache_lifetime;
 		if (hapd->conf->crl_reload_interval > 0 &&
 		    hapd->conf->check_crl <= 0) {
 			wpa_printf(MSG_INFO,
@@ -272,9 +278,13 @@ int authsrv_init(struct hostapd_data *hapd)
 		params.openssl_ecdh_curves = hapd->conf->openssl_ecdh_curves;
 		params.ocsp_stapling_response =
 			hapd->conf->ocsp_stapling_response;
+		params.ocsp_stapling_response2 =
+			hapd->conf->ocsp_stapling_response2;
 		params.ocsp_stapling_response_multi =
 			hapd->conf->ocsp_stapling_response_multi;
 		params.check_cert_subject = hapd->conf->check_cert_subject;
+		params.flags = hapd->conf->tls_flags &
+			TLS_CONN_DISABLE_CERT_COMPRESSION;
 
 		if (tls_global_set_params(hapd->ssl_ctx, &params)) {
 			wpa_printf(MSG_ERROR, "Failed to set TLS parameters");
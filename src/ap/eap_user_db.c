@@ -9,9 +9,11 @@
 #include "includes.h"
 #ifdef CONFIG_SQLITE
 #include <sqlite3.h>
+#include <sys/stat.h>
 #endif /* CONFIG_SQLITE */
 
 #include "common.h"
+#include "utils/eloop.h"
 #include "eap_common/eap_wsc_common.h"
 #include "eap_server/eap_methods.h"
 #include "eap_server/eap.h"
@@ -76,23 +78,260 @@ static void set_user_methods(struct hostapd_eap_user *user, const char *methods)
 }
 
 
-static int get_user_cb(void *ctx, int argc, char *argv[], char *col[])
+/*
+ * Resolved lookups are kept in a bounded LRU cache. The cache is flushed when
+ * the database content changes (PRAGMA data_version) and the connection is
+ * reopened when the database file is replaced.
+ */
+
+#define EAP_USER_DB_HASH_SIZE 256
+#define EAP_USER_DB_DEFAULT_CACHE 256
+
+struct eap_user_db_entry {
+	struct dl_list list; /* LRU order, most recently used first */
+	struct dl_list hlist; /* hash bucket */
+	int phase2;
+	bool found;
+	size_t key_len;
+	u8 *key;
+	struct hostapd_eap_user user;
+};
+
+struct eap_user_db_prefetch {
+	struct dl_list list;
+	size_t identity_len;
+	u8 identity[];
+};
+
+struct eap_user_db {
+	char *path;
+	sqlite3 *db;
+	sqlite3_stmt *user_stmt;
+	sqlite3_stmt *wildcard_stmt;
+	sqlite3_stmt *version_stmt;
+	int data_version;
+	dev_t dev;
+	ino_t ino;
+	time_t mtime;
+
+	struct dl_list lru;
+	struct dl_list hash[EAP_USER_DB_HASH_SIZE];
+	unsigned int count;
+
+	struct dl_list prefetch;
+
+	unsigned int hits;
+	unsigned int misses;
+	unsigned int flushes;
+};
+
+
+static unsigned int eap_user_db_hash(const u8 *key, size_t key_len, int phase2)
 {
-	struct hostapd_eap_user *user = ctx;
-	int i;
+	u32 h = 2166136261U;
+	size_t i;
+
+	/* FNV-1a */
+	for (i = 0; i < key_len; i++) {
+		h ^= key[i];
+		h *= 16777619U;
+	}
+	h ^= !!phase2;
+	h *= 16777619U;
+
+	return h & (EAP_USER_DB_HASH_SIZE - 1);
+}
+
+
+static void eap_user_db_clear_user(struct hostapd_eap_user *user)
+{
+	bin_clear_free(user->identity, user->identity_len);
+	bin_clear_free(user->password, user->password_len);
+	os_memset(user, 0, sizeof(*user));
+}
+
+
+static void eap_user_db_entry_free(struct eap_user_db *db,
+				   struct eap_user_db_entry *e)
+{
+	dl_list_del(&e->list);
+	dl_list_del(&e->hlist);
+	db->count--;
+	eap_user_db_clear_user(&e->user);
+	bin_clear_free(e->key, e->key_len);
+	os_free(e);
+}
+
+
+static void eap_user_db_flush(struct eap_user_db *db)
+{
+	struct eap_user_db_entry *e, *tmp;
+
+	dl_list_for_each_safe(e, tmp, &db->lru, struct eap_user_db_entry, list)
+		eap_user_db_entry_free(db, e);
+}
+
+
+static void eap_user_db_close(struct eap_user_db *db)
+{
+	eap_user_db_flush(db);
+	sqlite3_finalize(db->user_stmt);
+	sqlite3_finalize(db->wildcard_stmt);
+	sqlite3_finalize(db->version_stmt);
+	db->user_stmt = NULL;
+	db->wildcard_stmt = NULL;
+	db->version_stmt = NULL;
+	if (db->db) {
+		sqlite3_close(db->db);
+		db->db = NULL;
+	}
+	os_free(db->path);
+	db->path = NULL;
+}
+
+
+static int eap_user_db_prepare(struct eap_user_db *db, const char *sql,
+			       sqlite3_stmt **stmt)
+{
+	if (sqlite3_prepare_v2(db->db, sql, -1, stmt, NULL) != SQLITE_OK) {
+		wpa_printf(MSG_INFO, "DB: Failed to prepare SQL statement: %s",
+			   sqlite3_errmsg(db->db));
+		return -1;
+	}
+	return 0;
+}
+
+
+static int eap_user_db_get_data_version(struct eap_user_db *db)
+{
+	int val = -1;
+
+	if (sqlite3_step(db->version_stmt) == SQLITE_ROW)
+		val = sqlite3_column_int(db->version_stmt, 0);
+	sqlite3_reset(db->version_stmt);
+	return val;
+}
+
+
+static int eap_user_db_open(struct eap_user_db *db, const char *path)
+{
+	struct stat st;
+
+	db->path = os_strdup(path);
+	if (!db->path)
+		return -1;
+	if (sqlite3_open(path, &db->db)) {
+		wpa_printf(MSG_INFO, "DB: Failed to open database %s: %s",
+			   path, sqlite3_errmsg(db->db));
+		goto fail;
+	}
+
+	/* The wildcards table is optional, so the statement for it is
+	 * prepared only when needed. */
+	if (eap_user_db_prepare(
+		    db, "SELECT * FROM users WHERE identity=?1 AND phase2=?2;",
+		    &db->user_stmt) < 0 ||
+	    eap_user_db_prepare(db, "PRAGMA data_version;",
+				&db->version_stmt) < 0)
+		goto fail;
+
+	db->data_version = eap_user_db_get_data_version(db);
+	if (stat(path, &st) == 0) {
+		db->dev = st.st_dev;
+		db->ino = st.st_ino;
+		db->mtime = st.st_mtime;
+	}
+
+	wpa_printf(MSG_DEBUG, "DB: Opened EAP user database %s", path);
+	return 0;
+
+fail:
+	eap_user_db_close(db);
+	return -1;
+}
+
+
+/* Make sure the connection is open and the cache is up to date with the
+ * database content */
+static int eap_user_db_check(struct eap_user_db *db, const char *path)
+{
+	struct stat st;
+	bool st_ok;
+	int ver;
+
+	if (db->db && os_strcmp(db->path, path) != 0) {
+		wpa_printf(MSG_DEBUG, "DB: EAP user database changed to %s",
+			   path);
+		eap_user_db_close(db);
+	}
+
+	st_ok = stat(path, &st) == 0;
+	if (db->db && st_ok &&
+	    (st.st_dev != db->dev || st.st_ino != db->ino)) {
+		wpa_printf(MSG_DEBUG, "DB: EAP user database %s replaced",
+			   path);
+		db->flushes++;
+		eap_user_db_close(db);
+	}
+
+	if (!db->db)
+		return eap_user_db_open(db, path);
+
+	ver = eap_user_db_get_data_version(db);
+	if (ver != db->data_version || (st_ok && st.st_mtime != db->mtime)) {
+		if (db->count)
+			wpa_printf(MSG_DEBUG,
+				   "DB: EAP user database modified - flush %u cached entries",
+				   db->count);
+		eap_user_db_flush(db);
+		db->flushes++;
+		db->data_version = ver;
+		if (st_ok)
+			db->mtime = st.st_mtime;
+	}
+
+	return 0;
+}
+
+
+static struct eap_user_db_entry *
+eap_user_db_cache_get(struct eap_user_db *db, const u8 *identity,
+		      size_t identity_len, int phase2)
+{
+	struct eap_user_db_entry *e;
+	unsigned int h = eap_user_db_hash(identity, identity_len, phase2);
+
+	dl_list_for_each(e, &db->hash[h], struct eap_user_db_entry, hlist) {
+		if (e->phase2 == phase2 && e->key_len == identity_len &&
+		    os_memcmp(e->key, identity, identity_len) == 0)
+			return e;
+	}
+
+	return NULL;
+}
+
+
+static int get_user_row(struct hostapd_eap_user *user, sqlite3_stmt *stmt)
+{
+	int i, num = sqlite3_column_count(stmt);
+
+	for (i = 0; i < num; i++) {
+		const char *col = sqlite3_column_name(stmt, i);
+		const char *val = (const char *) sqlite3_column_text(stmt, i);
 
-	for (i = 0; i < argc; i++) {
-		if (os_strcmp(col[i], "password") == 0 && argv[i]) {
+		if (!col || !val)
+			continue;
+		if (os_strcmp(col, "password") == 0) {
 			bin_clear_free(user->password, user->password_len);
-			user->password_len = os_strlen(argv[i]);
-			user->password = (u8 *) os_strdup(argv[i]);
+			user->password_len = os_strlen(val);
+			user->password = (u8 *) os_strdup(val);
 			user->next = (void *) 1;
-		} else if (os_strcmp(col[i], "methods") == 0 && argv[i]) {
-			set_user_methods(user, argv[i]);
-		} else if (os_strcmp(col[i], "remediation") == 0 && argv[i]) {
-			user->remediation = strlen(argv[i]) > 0;
-		} else if (os_strcmp(col[i], "t_c_timestamp") == 0 && argv[i]) {
-			user->t_c_timestamp = strtol(argv[i], NULL, 10);
+		} else if (os_strcmp(col, "methods") == 0) {
+			set_user_methods(user, val);
+		} else if (os_strcmp(col, "remediation") == 0) {
+			user->remediation = os_strlen(val) > 0;
+		} else if (os_strcmp(col, "t_c_timestamp") == 0) {
+			user->t_c_timestamp = strtol(val, NULL, 10);
 		}
 	}
 
@@ -100,34 +339,184 @@ static int get_user_cb(void *ctx, int argc, char *argv[], char *col[])
 }
 
 
-static int get_wildcard_cb(void *ctx, int argc, char *argv[], char *col[])
+static bool eap_user_db_query(struct eap_user_db *db, const char *id_str,
+			      int phase2, struct hostapd_eap_user *user)
 {
-	struct hostapd_eap_user *user = ctx;
-	int i, id = -1, methods = -1;
-	size_t len;
-
-	for (i = 0; i < argc; i++) {
-		if (os_strcmp(col[i], "identity") == 0 && argv[i])
-			id = i;
-		else if (os_strcmp(col[i], "methods") == 0 && argv[i])
-			methods = i;
+	sqlite3_stmt *stmt = db->user_stmt;
+	int res;
+
+	sqlite3_bind_text(stmt, 1, id_str, -1, SQLITE_STATIC);
+	sqlite3_bind_int(stmt, 2, phase2);
+	while ((res = sqlite3_step(stmt)) == SQLITE_ROW)
+		get_user_row(user, stmt);
+	if (res != SQLITE_DONE)
+		wpa_printf(MSG_DEBUG,
+			   "DB: Failed to complete SQL operation: %s  db: %s",
+			   sqlite3_errmsg(db->db), db->path);
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
+	if (user->next)
+		return true;
+
+	if (phase2)
+		return false;
+
+	/* Longest matching prefix; the first one in table order on a tie */
+	if (!db->wildcard_stmt &&
+	    eap_user_db_prepare(
+		    db,
+		    "SELECT identity,methods FROM wildcards WHERE identity IS NOT NULL AND methods IS NOT NULL AND identity=substr(?1,1,length(identity)) ORDER BY length(identity) DESC, rowid LIMIT 1;",
+		    &db->wildcard_stmt) < 0)
+		return false;
+
+	stmt = db->wildcard_stmt;
+	sqlite3_bind_text(stmt, 1, id_str, -1, SQLITE_STATIC);
+	res = sqlite3_step(stmt);
+	if (res == SQLITE_ROW) {
+		const char *id = (const char *) sqlite3_column_text(stmt, 0);
+		const char *methods = (const char *) sqlite3_column_text(stmt,
+									 1);
+
+		if (id && methods) {
+			user->identity_len = os_strlen(id);
+			user->identity = (u8 *) os_strdup(id);
+			if (user->identity)
+				user->next = (void *) 1;
+			set_user_methods(user, methods);
+		}
+	} else if (res != SQLITE_DONE) {
+		wpa_printf(MSG_DEBUG,
+			   "DB: Failed to complete SQL operation: %s  db: %s",
+			   sqlite3_errmsg(db->db), db->path);
 	}
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
 
-	if (id < 0 || methods < 0)
-		return 0;
-
-	len = os_strlen(argv[id]);
-	if (len <= user->identity_len &&
-	    os_memcmp(argv[id], user->identity, len) == 0 &&
-	    (user->password == NULL || len > user->password_len)) {
-		bin_clear_free(user->password, user->password_len);
-		user->password_len = os_strlen(argv[id]);
-		user->password = (u8 *) os_strdup(argv[id]);
-		user->next = (void *) 1;
-		set_user_methods(user, argv[methods]);
+	return !!user->next;
+}
+
+
+/* Resolve an identity from the cache or the database. id_str is the
+ * identity as a nul terminated string (identity_len characters). The
+ * returned entry remains valid until the next lookup. */
+static struct eap_user_db_entry *
+eap_user_db_lookup(struct hostapd_data *hapd, const char *id_str,
+		   size_t identity_len, int phase2)
+{
+	struct eap_user_db *db = hapd->eap_user_db;
+	unsigned int max = hapd->conf->eap_user_sqlite_cache;
+	struct eap_user_db_entry *e, *old;
+
+	if (!max)
+		eap_user_db_flush(db);
+
+	e = eap_user_db_cache_get(db, (const u8 *) id_str, identity_len,
+				  phase2);
+	if (e) {
+		db->hits++;
+		dl_list_del(&e->list);
+		dl_list_add(&db->lru, &e->list);
+		return e;
 	}
+	db->misses++;
 
-	return 0;
+	e = os_zalloc(sizeof(*e));
+	if (!e)
+		return NULL;
+	e->key = os_memdup(id_str, identity_len + 1);
+	if (!e->key) {
+		os_free(e);
+		return NULL;
+	}
+	e->key_len = identity_len;
+	e->phase2 = phase2;
+	e->found = eap_user_db_query(db, id_str, phase2, &e->user);
+	e->user.next = NULL;
+
+	dl_list_add(&db->lru, &e->list);
+	dl_list_add(&db->hash[eap_user_db_hash(e->key, e->key_len, phase2)],
+		    &e->hlist);
+	db->count++;
+	while (db->count > max &&
+	       (old = dl_list_last(&db->lru, struct eap_user_db_entry,
+				   list)) != e)
+		eap_user_db_entry_free(db, old);
+
+	return e;
+}
+
+
+static void eap_user_db_prefetch_run(void *eloop_ctx, void *timeout_ctx)
+{
+	struct hostapd_data *hapd = eloop_ctx;
+	struct eap_user_db *db = hapd->eap_user_db;
+	struct eap_user_db_prefetch *p;
+
+	if (!hapd->conf->eap_user_sqlite ||
+	    eap_user_db_check(db, hapd->conf->eap_user_sqlite) < 0)
+		return;
+
+	while ((p = dl_list_first(&db->prefetch, struct eap_user_db_prefetch,
+				  list))) {
+		dl_list_del(&p->list);
+		if (!eap_user_db_cache_get(db, p->identity, p->identity_len,
+					   1)) {
+			wpa_printf(MSG_DEBUG,
+				   "DB: Prefetch Phase 2 user entry for '%s'",
+				   (const char *) p->identity);
+			eap_user_db_lookup(hapd, (const char *) p->identity,
+					   p->identity_len, 1);
+		}
+		bin_clear_free(p, sizeof(*p) + p->identity_len + 1);
+	}
+}
+
+
+/* A Phase 1 identity is often also used as the Phase 2 identity in a tunneled
+ * method, so resolve that entry from the event loop while the TLS handshake is
+ * in progress. */
+static void eap_user_db_prefetch(struct hostapd_data *hapd, const char *id_str,
+				 size_t identity_len)
+{
+	struct eap_user_db *db = hapd->eap_user_db;
+	struct eap_user_db_prefetch *p;
+
+	if (hapd->conf->eap_user_sqlite_cache < 2 ||
+	    eap_user_db_cache_get(db, (const u8 *) id_str, identity_len, 1))
+		return;
+	dl_list_for_each(p, &db->prefetch, struct eap_user_db_prefetch, list) {
+		if (p->identity_len == identity_len &&
+		    os_memcmp(p->identity, id_str, identity_len) == 0)
+			return;
+	}
+
+	p = os_zalloc(sizeof(*p) + identity_len + 1);
+	if (!p)
+		return;
+	p->identity_len = identity_len;
+	os_memcpy(p->identity, id_str, identity_len);
+	dl_list_add_tail(&db->prefetch, &p->list);
+	if (!eloop_is_timeout_registered(eap_user_db_prefetch_run, hapd, NULL))
+		eloop_register_timeout(0, 0, eap_user_db_prefetch_run, hapd,
+				       NULL);
+}
+
+
+static bool eap_user_db_tunneled(const struct hostapd_eap_user *user)
+{
+	int i;
+
+	for (i = 0; i < EAP_MAX_METHODS; i++) {
+		if (user->methods[i].vendor != EAP_VENDOR_IETF)
+			continue;
+		if (user->methods[i].method == EAP_TYPE_PEAP ||
+		    user->methods[i].method == EAP_TYPE_TTLS ||
+		    user->methods[i].method == EAP_TYPE_FAST ||
+		    user->methods[i].method == EAP_TYPE_TEAP)
+			return true;
+	}
+
+	return false;
 }
 
 
@@ -135,11 +524,11 @@ static const struct hostapd_eap_user *
 eap_user_sqlite_get(struct hostapd_data *hapd, const u8 *identity,
 		    size_t identity_len, int phase2)
 {
-	sqlite3 *db;
-	struct hostapd_eap_user *user = NULL;
-	char id_str[256], cmd[300];
+	struct hostapd_eap_user *user = &hapd->tmp_eap_user;
+	struct eap_user_db_entry *e;
+	char id_str[256];
 	size_t i;
-	int res;
+	int j;
 
 	if (identity_len >= sizeof(id_str)) {
 		wpa_printf(MSG_DEBUG, "%s: identity len too big: %d >= %d",
@@ -165,64 +554,96 @@ eap_user_sqlite_get(struct hostapd_data *hapd, const u8 *identity,
 		return NULL;
 	}
 
-	bin_clear_free(hapd->tmp_eap_user.identity,
-		       hapd->tmp_eap_user.identity_len);
-	bin_clear_free(hapd->tmp_eap_user.password,
-		       hapd->tmp_eap_user.password_len);
-	os_memset(&hapd->tmp_eap_user, 0, sizeof(hapd->tmp_eap_user));
-	hapd->tmp_eap_user.phase2 = phase2;
-	hapd->tmp_eap_user.identity = os_zalloc(identity_len + 1);
-	if (hapd->tmp_eap_user.identity == NULL)
+	eap_user_db_clear_user(user);
+
+	if (!hapd->eap_user_db) {
+		struct eap_user_db *db;
+
+		db = os_zalloc(sizeof(*db));
+		if (!db)
+			return NULL;
+		dl_list_init(&db->lru);
+		for (j = 0; j < EAP_USER_DB_HASH_SIZE; j++)
+			dl_list_init(&db->hash[j]);
+		dl_list_init(&db->prefetch);
+		hapd->eap_user_db = db;
+	}
+
+	if (eap_user_db_check(hapd->eap_user_db,
+			      hapd->conf->eap_user_sqlite) < 0)
 		return NULL;
-	os_memcpy(hapd->tmp_eap_user.identity, identity, identity_len);
-	hapd->tmp_eap_user.identity_len = identity_len;
 
-	if (sqlite3_open(hapd->conf->eap_user_sqlite, &db)) {
-		wpa_printf(MSG_INFO, "DB: Failed to open database %s: %s",
-			   hapd->conf->eap_user_sqlite, sqlite3_errmsg(db));
-		sqlite3_close(db);
+	e = eap_user_db_lookup(hapd, id_str, identity_len, phase2);
+	if (!e)
+		return NULL;
+	wpa_printf(MSG_DEBUG,
+		   "DB: User '%s' phase2=%d %s (cache hits=%u misses=%u)",
+		   id_str, phase2, e->found ? "found" : "not found",
+		   hapd->eap_user_db->hits, hapd->eap_user_db->misses);
+	if (!e->found)
 		return NULL;
-	}
 
-	res = os_snprintf(cmd, sizeof(cmd),
-			  "SELECT * FROM users WHERE identity='%s' AND phase2=%d;",
-			  id_str, phase2);
-	if (os_snprintf_error(sizeof(cmd), res))
+	/* Return a copy since the cache entry may be evicted by the next
+	 * lookup */
+	os_memcpy(user, &e->user, sizeof(*user));
+	user->phase2 = phase2;
+	user->password = NULL;
+	user->password_len = 0;
+	if (e->user.password) {
+		user->password = os_memdup(e->user.password,
+					   e->user.password_len + 1);
+		if (!user->password)
+			goto fail;
+		user->password_len = e->user.password_len;
+	}
+	if (e->user.identity) {
+		/* Wildcard match - identity is the matched prefix */
+		user->identity = os_memdup(e->user.identity,
+					   e->user.identity_len + 1);
+	} else {
+		user->identity = os_memdup(id_str, identity_len + 1);
+		user->identity_len = identity_len;
+	}
+	if (!user->identity)
 		goto fail;
 
-	wpa_printf(MSG_DEBUG, "DB: %s", cmd);
-	if (sqlite3_exec(db, cmd, get_user_cb, &hapd->tmp_eap_user, NULL) !=
-	    SQLITE_OK) {
-		wpa_printf(MSG_DEBUG,
-			   "DB: Failed to complete SQL operation: %s  db: %s",
-			   sqlite3_errmsg(db), hapd->conf->eap_user_sqlite);
-	} else if (hapd->tmp_eap_user.next)
-		user = &hapd->tmp_eap_user;
-
-	if (user == NULL && !phase2) {
-		os_snprintf(cmd, sizeof(cmd),
-			    "SELECT identity,methods FROM wildcards;");
-		wpa_printf(MSG_DEBUG, "DB: %s", cmd);
-		if (sqlite3_exec(db, cmd, get_wildcard_cb, &hapd->tmp_eap_user,
-				 NULL) != SQLITE_OK) {
-			wpa_printf(MSG_DEBUG,
-				   "DB: Failed to complete SQL operation: %s  db: %s",
-				   sqlite3_errmsg(db),
-				   hapd->conf->eap_user_sqlite);
-		} else if (hapd->tmp_eap_user.next) {
-			user = &hapd->tmp_eap_user;
-			os_free(user->identity);
-			user->identity = user->password;
-			user->identity_len = user->password_len;
-			user->password = NULL;
-			user->password_len = 0;
-		}
-	}
+	if (!phase2 && eap_user_db_tunneled(user))
+		eap_user_db_prefetch(hapd, id_str, identity_len);
+
+	return user;
 
 fail:
-	sqlite3_close(db);
+	user->identity = NULL;
+	eap_user_db_clear_user(user);
+	return NULL;
+}
 
-	return user;
+
+/**
+ * hostapd_eap_user_db_deinit - Close the SQLite EAP user database
+ * @hapd: Pointer to BSS data
+ */
+void hostapd_eap_user_db_deinit(struct hostapd_data *hapd)
+{
+	struct eap_user_db *db = hapd->eap_user_db;
+	struct eap_user_db_prefetch *p, *tmp;
+
+	eap_user_db_clear_user(&hapd->tmp_eap_user);
+	if (!db)
+		return;
+
+	eloop_cancel_timeout(eap_user_db_prefetch_run, hapd, NULL);
+	dl_list_for_each_safe(p, tmp, &db->prefetch,
+			      struct eap_user_db_prefetch, list) {
+		dl_list_del(&p->list);
+		bin_clear_free(p, sizeof(*p) + p->identity_len + 1);
+	}
+	wpa_printf(MSG_DEBUG,
+		   "DB: EAP user cache: hits=%u misses=%u flushes=%u",
+		   db->hits, db->misses, db->flushes);
+	eap_user_db_close(db);
+	os_free(db);
+	hapd->eap_user_db = NULL;
 }
 
 #endif /* CONFIG_SQLITE */
@@ -233,7 +654,7 @@ hostapd_get_eap_user(struct hostapd_data *hapd, const u8 *identity,
 		     size_t identity_len, int phase2)
 {
 	const struct hostapd_bss_config *conf = hapd->conf;
-	struct hostapd_eap_user *user = conf->eap_user;
+	struct hostapd_eap_user *user;
 
 #ifdef CONFIG_WPS
 	if (conf->wps_state && identity_len == WSC_ID_ENROLLEE_LEN &&
@@ -258,26 +679,13 @@ hostapd_get_eap_user(struct hostapd_data *hapd, const u8 *identity,
 	}
 #endif /* CONFIG_WPS */
 
-	while (user) {
-		if (!phase2 && user->identity == NULL) {
-			/* Wildcard match */
-			break;
-		}
-
-		if (user->phase2 == !!phase2 && user->wildcard_prefix &&
-		    identity_len >= user->identity_len &&
-		    os_memcmp(user->identity, identity, user->identity_len) ==
-		    0) {
-			/* Wildcard prefix match */
-			break;
-		}
-
-		if (user->phase2 == !!phase2 &&
-		    user->identity_len == identity_len &&
-		    os_memcmp(user->identity, identity, identity_len) == 0)
-			break;
-		user = user->next;
-	}
+	if (conf->eap_user_index)
+		user = hostapd_eap_user_index_lookup(conf->eap_user_index,
+						     identity, identity_len,
+						     phase2);
+	else
+		user = hostapd_eap_user_find(conf->eap_user, identity,
+					     identity_len, phase2);
 
 #ifdef CONFIG_SQLITE
 	if (user == NULL && conf->eap_user_sqlite) {
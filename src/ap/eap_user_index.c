@@ -0,0 +1,308 @@
+/*
+ * hostapd / EAP user lookup index
+ * Copyright (c) 2026, Infineon Technologies AG
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "ap_config.h"
+
+
+/**
+ * hostapd_eap_user_find - Find the first matching EAP user from a list
+ * @user: EAP user list
+ * @identity: Identity to look for
+ * @identity_len: Length of the identity
+ * @phase2: Whether this is a Phase 2 lookup
+ * Returns: The first matching entry or %NULL if no entry matches
+ */
+struct hostapd_eap_user *
+hostapd_eap_user_find(struct hostapd_eap_user *user, const u8 *identity,
+		      size_t identity_len, int phase2)
+{
+	while (user) {
+		if (!phase2 && user->identity == NULL) {
+			/* Wildcard match */
+			break;
+		}
+
+		if (user->phase2 == !!phase2 && user->wildcard_prefix &&
+		    identity_len >= user->identity_len &&
+		    os_memcmp(user->identity, identity, user->identity_len) ==
+		    0) {
+			/* Wildcard prefix match */
+			break;
+		}
+
+		if (user->phase2 == !!phase2 &&
+		    user->identity_len == identity_len &&
+		    os_memcmp(user->identity, identity, identity_len) == 0)
+			break;
+		user = user->next;
+	}
+
+	return user;
+}
+
+
+/*
+ * EAP user index
+ *
+ * The EAP user list is matched in order and the first entry that matches
+ * wins. The index finds the same entry without walking the list: exact
+ * identities are stored in a hash table and wildcard prefixes in a trie with
+ * the list position of each entry, so that the lowest position among the
+ * matching candidates can be selected.
+ */
+
+#define EAP_USER_POS_NONE ((unsigned int) -1)
+
+struct eap_user_index_entry {
+	struct eap_user_index_entry *next;
+	struct hostapd_eap_user *user;
+	unsigned int pos;
+};
+
+struct eap_user_trie_node {
+	struct eap_user_trie_node *child;
+	struct eap_user_trie_node *sibling;
+	struct hostapd_eap_user *user;
+	unsigned int pos;
+	u8 c;
+};
+
+struct hostapd_eap_user_index {
+	struct eap_user_index_entry **hash;
+	unsigned int hash_mask;
+	struct eap_user_index_entry *entries;
+	struct eap_user_trie_node *prefix[2]; /* Phase 1 / Phase 2 */
+	struct hostapd_eap_user *any; /* First "*" user for Phase 1 */
+	unsigned int any_pos;
+	unsigned int num_users;
+};
+
+
+static unsigned int eap_user_index_hash(const u8 *identity, size_t len,
+					int phase2)
+{
+	u32 h = 2166136261U;
+	size_t i;
+
+	/* FNV-1a */
+	for (i = 0; i < len; i++) {
+		h ^= identity[i];
+		h *= 16777619U;
+	}
+	h ^= phase2;
+	h *= 16777619U;
+
+	return h;
+}
+
+
+static void eap_user_trie_free(struct eap_user_trie_node *node)
+{
+	struct eap_user_trie_node *next;
+
+	while (node) {
+		next = node->sibling;
+		eap_user_trie_free(node->child);
+		os_free(node);
+		node = next;
+	}
+}
+
+
+static int eap_user_trie_add(struct eap_user_trie_node **root,
+			     struct hostapd_eap_user *user, unsigned int pos)
+{
+	struct eap_user_trie_node *node, **link = root;
+	size_t i;
+
+	if (!*root) {
+		*root = os_zalloc(sizeof(**root));
+		if (!*root)
+			return -1;
+		(*root)->pos = EAP_USER_POS_NONE;
+	}
+	node = *root;
+
+	for (i = 0; i < user->identity_len; i++) {
+		struct eap_user_trie_node *c;
+
+		link = &node->child;
+		for (c = node->child; c; c = c->sibling) {
+			if (c->c == user->identity[i])
+				break;
+			link = &c->sibling;
+		}
+		if (!c) {
+			c = os_zalloc(sizeof(*c));
+			if (!c)
+				return -1;
+			c->c = user->identity[i];
+			c->pos = EAP_USER_POS_NONE;
+			*link = c;
+		}
+		node = c;
+	}
+
+	if (pos < node->pos) {
+		node->pos = pos;
+		node->user = user;
+	}
+
+	return 0;
+}
+
+
+void hostapd_eap_user_index_free(struct hostapd_eap_user_index *idx)
+{
+	if (!idx)
+		return;
+	eap_user_trie_free(idx->prefix[0]);
+	eap_user_trie_free(idx->prefix[1]);
+	os_free(idx->hash);
+	os_free(idx->entries);
+	os_free(idx);
+}
+
+
+/**
+ * hostapd_eap_user_index_build - Build lookup index for EAP users
+ * @users: EAP user list
+ * Returns: Index or %NULL on failure
+ *
+ * The index refers to the entries of @users, so it needs to be rebuilt (or
+ * freed) whenever the list is modified.
+ */
+struct hostapd_eap_user_index *
+hostapd_eap_user_index_build(struct hostapd_eap_user *users)
+{
+	struct hostapd_eap_user_index *idx;
+	struct hostapd_eap_user *user;
+	unsigned int num = 0, size = 16, pos;
+
+	for (user = users; user; user = user->next)
+		num++;
+
+	idx = os_zalloc(sizeof(*idx));
+	if (!idx)
+		return NULL;
+	idx->num_users = num;
+	idx->any_pos = EAP_USER_POS_NONE;
+	while (size < num)
+		size <<= 1;
+	idx->hash_mask = size - 1;
+	idx->hash = os_calloc(size, sizeof(*idx->hash));
+	idx->entries = os_calloc(num ? num : 1, sizeof(*idx->entries));
+	if (!idx->hash || !idx->entries)
+		goto fail;
+
+	for (user = users, pos = 0; user; user = user->next, pos++) {
+		struct eap_user_index_entry *e, **bucket;
+
+		if (!user->identity && !idx->any) {
+			idx->any = user;
+			idx->any_pos = pos;
+		}
+
+		if (user->wildcard_prefix) {
+			if (eap_user_trie_add(&idx->prefix[!!user->phase2],
+					      user, pos) < 0)
+				goto fail;
+			continue;
+		}
+
+		bucket = &idx->hash[eap_user_index_hash(user->identity,
+							user->identity_len,
+							!!user->phase2) &
+				    idx->hash_mask];
+		for (e = *bucket; e; e = e->next) {
+			if (!!e->user->phase2 == !!user->phase2 &&
+			    e->user->identity_len == user->identity_len &&
+			    (!user->identity_len ||
+			     os_memcmp(e->user->identity, user->identity,
+				       user->identity_len) == 0))
+				break;
+		}
+		if (e)
+			continue; /* an earlier entry always matches first */
+		e = &idx->entries[pos];
+		e->user = user;
+		e->pos = pos;
+		e->next = *bucket;
+		*bucket = e;
+	}
+
+	return idx;
+
+fail:
+	hostapd_eap_user_index_free(idx);
+	return NULL;
+}
+
+
+/**
+ * hostapd_eap_user_index_lookup - Find the first matching EAP user
+ * @idx: Index from hostapd_eap_user_index_build()
+ * @identity: Identity to look for
+ * @identity_len: Length of the identity
+ * @phase2: Whether this is a Phase 2 lookup
+ * Returns: The same entry as a linear walk of the user list would return or
+ * %NULL if no entry matches
+ */
+struct hostapd_eap_user *
+hostapd_eap_user_index_lookup(const struct hostapd_eap_user_index *idx,
+			      const u8 *identity, size_t identity_len,
+			      int phase2)
+{
+	struct hostapd_eap_user *best = NULL;
+	unsigned int best_pos = EAP_USER_POS_NONE;
+	const struct eap_user_index_entry *e;
+	const struct eap_user_trie_node *node;
+	size_t i;
+
+	phase2 = !!phase2;
+	if (!phase2) {
+		best = idx->any;
+		best_pos = idx->any_pos;
+	}
+
+	e = idx->hash[eap_user_index_hash(identity, identity_len, phase2) &
+		      idx->hash_mask];
+	for (; e; e = e->next) {
+		if (!!e->user->phase2 == phase2 &&
+		    e->user->identity_len == identity_len &&
+		    (!identity_len ||
+		     os_memcmp(e->user->identity, identity,
+			       identity_len) == 0)) {
+			if (e->pos < best_pos) {
+				best = e->user;
+				best_pos = e->pos;
+			}
+			break;
+		}
+	}
+
+	node = idx->prefix[phase2];
+	for (i = 0; node; i++) {
+		if (node->pos < best_pos) {
+			best = node->user;
+			best_pos = node->pos;
+		}
+		if (i == identity_len)
+			break;
+		for (node = node->child; node; node = node->sibling) {
+			if (node->c == identity[i])
+				break;
+		}
+	}
+
+	return best;
+}
+
@@ -21,6 +21,43 @@
 #include "gas_serv.h"
 
 
+/*
+ * ANQP response cache
+ *
+ * Most ANQP-elements depend only on the BSS configuration. They are encoded
+ * on the first request and the following responses copy the encoded elements.
+ * Hotspot 2.0 icon files are read once and kept in memory as Icon Binary File
+ * elements. The cache is flushed with gas_serv_flush_cache() whenever the
+ * configuration changes. The NAI Home Realm Query response depends on the
+ * query and is always built.
+ */
+
+/* Cache entries 0..31 are indexed by the ANQP_REQ_* bit number */
+#define ANQP_CACHE_VENUE_URL 32
+#define ANQP_CACHE_FILS_REALM_INFO 33
+#define ANQP_CACHE_ENTRIES 34
+
+/* ANQP-element header and the maximum payload */
+#define ANQP_CACHE_MAX_ELEM (2 + 2 + 65535)
+
+struct anqp_cache {
+	struct wpabuf *elem[ANQP_CACHE_ENTRIES];
+	struct wpabuf **icons; /* per hs20_icons[] entry */
+	size_t num_icons;
+
+	/* Statistics (not cleared on flush) */
+	unsigned int queries;
+	unsigned int elem_hits;
+	unsigned int elem_builds;
+	unsigned int icon_hits;
+	unsigned int icon_loads;
+	unsigned int flushes;
+	unsigned int latency_last; /* usec */
+	unsigned int latency_max;
+	u64 latency_total;
+};
+
+
 #ifdef CONFIG_DPP
 static void gas_serv_write_dpp_adv_proto(struct wpabuf *buf)
 {
@@ -43,117 +80,373 @@ static void convert_to_protected_dual(struct wpabuf *msg)
 }
 
 
-static struct gas_dialog_info *
-gas_dialog_create(struct hostapd_data *hapd, const u8 *addr, u8 dialog_token)
-{
-	struct sta_info *sta;
-	struct gas_dialog_info *dia = NULL;
-	int i, j;
-
-	sta = ap_get_sta(hapd, addr);
-	if (!sta) {
-		/*
-		 * We need a STA entry to be able to maintain state for
-		 * the GAS query.
-		 */
-		wpa_printf(MSG_DEBUG, "ANQP: Add a temporary STA entry for "
-			   "GAS query");
-		sta = ap_sta_add(hapd, addr);
-		if (!sta) {
-			wpa_printf(MSG_DEBUG, "Failed to add STA " MACSTR
-				   " for GAS query", MAC2STR(addr));
-			return NULL;
-		}
-		sta->flags |= WLAN_STA_GAS;
-		/*
-		 * The default inactivity is 300 seconds. We don't need
-		 * it to be that long. Use five second timeout and increase this
-		 * with the comeback_delay for testing cases.
-		 */
-		ap_sta_session_timeout(hapd, sta,
-				       hapd->conf->gas_comeback_delay / 1024 +
-				       5);
-	} else {
-		ap_sta_replenish_timeout(hapd, sta, 5);
-	}
+/*
+ * Pending GAS dialogs
+ *
+ * Responses that do not fit in the GAS Initial Response frame are sent in GAS
+ * Comeback Response fragments. The pending dialogs are kept in a table that is
+ * indexed by the peer address and the dialog token; no STA entry is needed for
+ * the peer. The response of a dialog is a list of segments that point to the
+ * ANQP response cache where possible and each fragment is copied from the
+ * segments when the peer requests it. Only the parts that depend on the query
+ * are stored for the dialog. The total memory used by the pending dialogs is
+ * limited with gas_dialog_mem_limit.
+ */
 
-	if (sta->gas_dialog == NULL) {
-		sta->gas_dialog = os_calloc(GAS_DIALOG_MAX,
-					    sizeof(struct gas_dialog_info));
-		if (sta->gas_dialog == NULL)
-			return NULL;
-	}
+#define GAS_DIALOG_MAX 8 /* Max concurrent dialogs per peer */
+#define GAS_DIALOG_HASH_SIZE 64
+#define GAS_DIALOG_HASH(a) ((a)[5] & (GAS_DIALOG_HASH_SIZE - 1))
+#define GAS_DIALOG_TIMEOUT 5 /* seconds */
 
-	for (i = sta->gas_dialog_next, j = 0; j < GAS_DIALOG_MAX; i++, j++) {
-		if (i == GAS_DIALOG_MAX)
-			i = 0;
-		if (sta->gas_dialog[i].valid)
-			continue;
-		dia = &sta->gas_dialog[i];
-		dia->valid = 1;
-		dia->dialog_token = dialog_token;
-		sta->gas_dialog_next = (++i == GAS_DIALOG_MAX) ? 0 : i;
-		return dia;
+struct gas_resp_seg {
+	const struct wpabuf *buf;
+	size_t pos;
+	size_t len;
+};
+
+struct gas_resp {
+	struct gas_resp_seg *seg;
+	unsigned int num_seg;
+	unsigned int max_seg;
+	struct wpabuf *own; /* query specific parts of the response */
+	size_t len;
+};
+
+struct gas_dialog_info {
+	struct dl_list list; /* in the order of expiration */
+	struct gas_dialog_info *hnext; /* next entry in hash table list */
+	u8 addr[ETH_ALEN];
+	u8 dialog_token;
+	u8 frag_id;
+	int prot; /* whether Protected Dual of Public Action frame is used */
+	int dpp; /* whether this is a DPP Config Response */
+	struct gas_resp resp;
+	size_t resp_pos; /* Offset of the next fragment in resp */
+	size_t mem;
+	struct os_reltime expire;
+};
+
+struct gas_dialog_table {
+	struct gas_dialog_info *hash[GAS_DIALOG_HASH_SIZE];
+	struct dl_list list;
+	unsigned int num;
+	size_t mem;
+	size_t mem_peak;
+
+	/* Statistics */
+	unsigned int created;
+	unsigned int completed;
+	unsigned int expired;
+	unsigned int rejected;
+	unsigned int aborted;
+	unsigned int frags;
+};
+
+
+static int gas_resp_init(struct gas_resp *resp, unsigned int max_seg,
+			 size_t own_len)
+{
+	os_memset(resp, 0, sizeof(*resp));
+	resp->seg = os_calloc(max_seg, sizeof(struct gas_resp_seg));
+	resp->own = wpabuf_alloc(own_len);
+	if (!resp->seg || !resp->own) {
+		os_free(resp->seg);
+		wpabuf_free(resp->own);
+		return -1;
 	}
+	resp->max_seg = max_seg;
+	return 0;
+}
 
-	wpa_msg(hapd->msg_ctx, MSG_ERROR, "ANQP: Could not create dialog for "
-		MACSTR " dialog_token %u. Consider increasing "
-		"GAS_DIALOG_MAX.", MAC2STR(addr), dialog_token);
 
-	return NULL;
+static void gas_resp_deinit(struct gas_resp *resp)
+{
+	os_free(resp->seg);
+	wpabuf_free(resp->own);
+	os_memset(resp, 0, sizeof(*resp));
 }
 
 
-struct gas_dialog_info *
-gas_serv_dialog_find(struct hostapd_data *hapd, const u8 *addr,
-		     u8 dialog_token)
+static void gas_resp_add(struct gas_resp *resp, const struct wpabuf *buf,
+			 size_t pos, size_t len)
 {
-	struct sta_info *sta;
-	int i;
+	struct gas_resp_seg *seg;
 
-	sta = ap_get_sta(hapd, addr);
-	if (!sta) {
-		wpa_printf(MSG_DEBUG, "ANQP: could not find STA " MACSTR,
-			   MAC2STR(addr));
-		return NULL;
+	if (!len)
+		return;
+	resp->len += len;
+	if (resp->num_seg) {
+		seg = &resp->seg[resp->num_seg - 1];
+		if (seg->buf == buf && seg->pos + seg->len == pos) {
+			seg->len += len;
+			return;
+		}
+	}
+	if (resp->num_seg == resp->max_seg) {
+		/* Not reached; max_seg covers all the parts */
+		resp->len -= len;
+		return;
 	}
-	for (i = 0; sta->gas_dialog && i < GAS_DIALOG_MAX; i++) {
-		if (sta->gas_dialog[i].dialog_token != dialog_token ||
-		    !sta->gas_dialog[i].valid)
+	seg = &resp->seg[resp->num_seg++];
+	seg->buf = buf;
+	seg->pos = pos;
+	seg->len = len;
+}
+
+
+#ifdef CONFIG_DPP
+/* Response with a single segment that covers buf; takes the ownership of buf
+ * on success */
+static int gas_resp_init_buf(struct gas_resp *resp, struct wpabuf *buf)
+{
+	os_memset(resp, 0, sizeof(*resp));
+	resp->seg = os_zalloc(sizeof(struct gas_resp_seg));
+	if (!resp->seg)
+		return -1;
+	resp->max_seg = 1;
+	resp->own = buf;
+	gas_resp_add(resp, buf, 0, wpabuf_len(buf));
+	return 0;
+}
+#endif /* CONFIG_DPP */
+
+
+static void gas_resp_add_own(struct gas_resp *resp, size_t start)
+{
+	gas_resp_add(resp, resp->own, start, wpabuf_len(resp->own) - start);
+}
+
+
+static void gas_resp_copy(const struct gas_resp *resp, size_t pos, size_t len,
+			  struct wpabuf *buf)
+{
+	const struct gas_resp_seg *seg;
+	unsigned int i;
+	size_t n;
+
+	for (i = 0; i < resp->num_seg && len; i++) {
+		seg = &resp->seg[i];
+		if (pos >= seg->len) {
+			pos -= seg->len;
 			continue;
-		ap_sta_replenish_timeout(hapd, sta, 5);
-		return &sta->gas_dialog[i];
+		}
+		n = seg->len - pos;
+		if (n > len)
+			n = len;
+		wpabuf_put_data(buf, wpabuf_head_u8(seg->buf) + seg->pos + pos,
+				n);
+		len -= n;
+		pos = 0;
 	}
-	wpa_printf(MSG_DEBUG, "ANQP: Could not find dialog for "
-		   MACSTR " dialog_token %u", MAC2STR(addr), dialog_token);
-	return NULL;
 }
 
 
-void gas_serv_dialog_clear(struct gas_dialog_info *dia)
+static struct wpabuf * gas_resp_get_buf(const struct gas_resp *resp)
 {
-	wpabuf_free(dia->sd_resp);
-	os_memset(dia, 0, sizeof(*dia));
+	struct wpabuf *buf;
+
+	buf = wpabuf_alloc(resp->len);
+	if (buf)
+		gas_resp_copy(resp, 0, resp->len, buf);
+	return buf;
 }
 
 
-static void gas_serv_free_dialogs(struct hostapd_data *hapd,
-				  const u8 *sta_addr)
+static size_t gas_resp_mem(const struct gas_resp *resp)
 {
-	struct sta_info *sta;
-	int i;
+	return resp->max_seg * sizeof(struct gas_resp_seg) +
+		wpabuf_size(resp->own);
+}
+
 
-	sta = ap_get_sta(hapd, sta_addr);
-	if (sta == NULL || sta->gas_dialog == NULL)
+static void gas_dialog_timeout(void *eloop_ctx, void *timeout_ctx);
+
+static void gas_dialog_schedule(struct hostapd_data *hapd)
+{
+	struct gas_dialog_info *dia;
+	struct os_reltime now, diff;
+
+	eloop_cancel_timeout(gas_dialog_timeout, hapd, NULL);
+	dia = dl_list_first(&hapd->gas_dialogs->list, struct gas_dialog_info,
+			    list);
+	if (!dia)
 		return;
+	os_get_reltime(&now);
+	if (os_reltime_before(&now, &dia->expire))
+		os_reltime_sub(&dia->expire, &now, &diff);
+	else
+		diff.sec = diff.usec = 0;
+	eloop_register_timeout(diff.sec, diff.usec, gas_dialog_timeout, hapd,
+			       NULL);
+}
 
-	for (i = 0; i < GAS_DIALOG_MAX; i++) {
-		if (sta->gas_dialog[i].valid)
+
+static void gas_dialog_set_expire(struct hostapd_data *hapd,
+				  struct gas_dialog_info *dia,
+				  unsigned int timeout)
+{
+	struct gas_dialog_table *table = hapd->gas_dialogs;
+	struct gas_dialog_info *pos;
+
+	os_get_reltime(&dia->expire);
+	dia->expire.sec += timeout;
+
+	/* Keep the list sorted; usually the new entry goes to the tail */
+	dl_list_for_each_reverse(pos, &table->list, struct gas_dialog_info,
+				 list) {
+		if (!os_reltime_before(&dia->expire, &pos->expire)) {
+			dl_list_add(&pos->list, &dia->list);
 			return;
+		}
+	}
+	dl_list_add(&table->list, &dia->list);
+	gas_dialog_schedule(hapd);
+}
+
+
+static void gas_dialog_free(struct hostapd_data *hapd,
+			    struct gas_dialog_info *dia)
+{
+	struct gas_dialog_table *table = hapd->gas_dialogs;
+	struct gas_dialog_info **pos;
+
+	for (pos = &table->hash[GAS_DIALOG_HASH(dia->addr)]; *pos;
+	     pos = &(*pos)->hnext) {
+		if (*pos == dia) {
+			*pos = dia->hnext;
+			break;
+		}
+	}
+	dl_list_del(&dia->list);
+	table->num--;
+	table->mem -= dia->mem;
+	gas_resp_deinit(&dia->resp);
+	os_free(dia);
+}
+
+
+static void gas_dialog_timeout(void *eloop_ctx, void *timeout_ctx)
+{
+	struct hostapd_data *hapd = eloop_ctx;
+	struct gas_dialog_info *dia;
+	struct os_reltime now;
+
+	os_get_reltime(&now);
+	while ((dia = dl_list_first(&hapd->gas_dialogs->list,
+				    struct gas_dialog_info, list)) &&
+	       !os_reltime_before(&now, &dia->expire)) {
+		wpa_printf(MSG_DEBUG,
+			   "GAS: Dialog for " MACSTR
+			   " (dialog token %u) timed out",
+			   MAC2STR(dia->addr), dia->dialog_token);
+		hapd->gas_dialogs->expired++;
+		gas_dialog_free(hapd, dia);
 	}
+	gas_dialog_schedule(hapd);
+}
+
+
+static struct gas_dialog_info *
+gas_dialog_find(struct hostapd_data *hapd, const u8 *addr, u8 dialog_token)
+{
+	struct gas_dialog_info *dia;
+
+	if (!hapd->gas_dialogs)
+		return NULL;
+	for (dia = hapd->gas_dialogs->hash[GAS_DIALOG_HASH(addr)]; dia;
+	     dia = dia->hnext) {
+		if (dia->dialog_token == dialog_token &&
+		    os_memcmp(dia->addr, addr, ETH_ALEN) == 0)
+			return dia;
+	}
+	return NULL;
+}
+
+
+static struct gas_dialog_info *
+gas_dialog_create(struct hostapd_data *hapd, const u8 *addr, u8 dialog_token,
+		  size_t resp_mem)
+{
+	struct gas_dialog_table *table = hapd->gas_dialogs;
+	struct gas_dialog_info *dia;
+	unsigned int count = 0;
+	size_t mem = sizeof(*dia) + resp_mem;
+
+	if (!table) {
+		table = os_zalloc(sizeof(*table));
+		if (!table)
+			return NULL;
+		dl_list_init(&table->list);
+		hapd->gas_dialogs = table;
+	}
+
+	dia = gas_dialog_find(hapd, addr, dialog_token);
+	if (dia) {
+		wpa_printf(MSG_DEBUG,
+			   "GAS: Replace pending dialog for " MACSTR
+			   " (dialog token %u)", MAC2STR(addr), dialog_token);
+		table->aborted++;
+		gas_dialog_free(hapd, dia);
+	}
+
+	for (dia = table->hash[GAS_DIALOG_HASH(addr)]; dia; dia = dia->hnext) {
+		if (os_memcmp(dia->addr, addr, ETH_ALEN) == 0)
+			count++;
+	}
+	if (count >= GAS_DIALOG_MAX) {
+		wpa_msg(hapd->msg_ctx, MSG_ERROR,
+			"ANQP: Could not create dialog for " MACSTR
+			" dialog_token %u. Consider increasing GAS_DIALOG_MAX.",
+			MAC2STR(addr), dialog_token);
+		table->rejected++;
+		return NULL;
+	}
+	if (table->mem + mem > hapd->conf->gas_dialog_mem_limit) {
+		wpa_printf(MSG_INFO,
+			   "GAS: Pending dialogs would use more than %zu bytes - reject dialog for "
+			   MACSTR " (dialog token %u)",
+			   hapd->conf->gas_dialog_mem_limit, MAC2STR(addr),
+			   dialog_token);
+		table->rejected++;
+		return NULL;
+	}
+
+	dia = os_zalloc(sizeof(*dia));
+	if (!dia)
+		return NULL;
+	os_memcpy(dia->addr, addr, ETH_ALEN);
+	dia->dialog_token = dialog_token;
+	dia->mem = mem;
+	dia->hnext = table->hash[GAS_DIALOG_HASH(addr)];
+	table->hash[GAS_DIALOG_HASH(addr)] = dia;
+	table->num++;
+	table->mem += mem;
+	if (table->mem > table->mem_peak)
+		table->mem_peak = table->mem;
+	table->created++;
+
+	/* Use five second timeout and increase this with the comeback_delay
+	 * for testing cases. */
+	gas_dialog_set_expire(hapd, dia, hapd->conf->gas_comeback_delay / 1024 +
+			      GAS_DIALOG_TIMEOUT);
+
+	return dia;
+}
+
 
-	os_free(sta->gas_dialog);
-	sta->gas_dialog = NULL;
+static void gas_dialog_free_all(struct hostapd_data *hapd, bool anqp_only)
+{
+	struct gas_dialog_info *dia, *n;
+
+	if (!hapd->gas_dialogs)
+		return;
+	dl_list_for_each_safe(dia, n, &hapd->gas_dialogs->list,
+			      struct gas_dialog_info, list) {
+		if (anqp_only && dia->dpp)
+			continue;
+		hapd->gas_dialogs->aborted++;
+		gas_dialog_free(hapd, dia);
+	}
 }
 
 
@@ -853,27 +1146,28 @@ static void anqp_add_osu_providers_nai_list(struct hostapd_data *hapd,
 }
 
 
-static void anqp_add_icon_binary_file(struct hostapd_data *hapd,
-				      struct wpabuf *buf,
-				      const u8 *name, size_t name_len)
+static struct wpabuf * anqp_build_icon_binary_file(struct hs20_icon *icon,
+						    bool *success)
 {
-	struct hs20_icon *icon;
-	size_t i;
+	struct wpabuf *buf;
+	char *data = NULL;
+	size_t data_len = 0;
 	u8 *len;
 
-	wpa_hexdump_ascii(MSG_DEBUG, "HS 2.0: Requested Icon Filename",
-			  name, name_len);
-	for (i = 0; i < hapd->conf->hs20_icons_count; i++) {
-		icon = &hapd->conf->hs20_icons[i];
-		if (name_len == os_strlen(icon->name) &&
-		    os_memcmp(name, icon->name, name_len) == 0)
-			break;
+	*success = false;
+	if (icon) {
+		data = os_readfile(icon->file, &data_len);
+		if (data && data_len > 65535) {
+			os_free(data);
+			data = NULL;
+		}
 	}
 
-	if (i < hapd->conf->hs20_icons_count)
-		icon = &hapd->conf->hs20_icons[i];
-	else
-		icon = NULL;
+	buf = wpabuf_alloc(20 + (data ? os_strlen(icon->type) + data_len : 0));
+	if (!buf) {
+		os_free(data);
+		return NULL;
+	}
 
 	len = gas_anqp_add_element(buf, ANQP_VENDOR_SPECIFIC);
 	wpabuf_put_be24(buf, OUI_WFA);
@@ -881,24 +1175,19 @@ static void anqp_add_icon_binary_file(struct hostapd_data *hapd,
 	wpabuf_put_u8(buf, HS20_STYPE_ICON_BINARY_FILE);
 	wpabuf_put_u8(buf, 0); /* Reserved */
 
-	if (icon) {
-		char *data;
-		size_t data_len;
-
-		data = os_readfile(icon->file, &data_len);
-		if (data == NULL || data_len > 65535) {
-			wpabuf_put_u8(buf, 2); /* Download Status:
-						* Unspecified file error */
-			wpabuf_put_u8(buf, 0);
-			wpabuf_put_le16(buf, 0);
-		} else {
-			wpabuf_put_u8(buf, 0); /* Download Status: Success */
-			wpabuf_put_u8(buf, os_strlen(icon->type));
-			wpabuf_put_str(buf, icon->type);
-			wpabuf_put_le16(buf, data_len);
-			wpabuf_put_data(buf, data, data_len);
-		}
+	if (data) {
+		wpabuf_put_u8(buf, 0); /* Download Status: Success */
+		wpabuf_put_u8(buf, os_strlen(icon->type));
+		wpabuf_put_str(buf, icon->type);
+		wpabuf_put_le16(buf, data_len);
+		wpabuf_put_data(buf, data, data_len);
 		os_free(data);
+		*success = true;
+	} else if (icon) {
+		wpabuf_put_u8(buf, 2); /* Download Status:
+					* Unspecified file error */
+		wpabuf_put_u8(buf, 0);
+		wpabuf_put_le16(buf, 0);
 	} else {
 		wpabuf_put_u8(buf, 1); /* Download Status: File not found */
 		wpabuf_put_u8(buf, 0);
@@ -906,6 +1195,58 @@ static void anqp_add_icon_binary_file(struct hostapd_data *hapd,
 	}
 
 	gas_anqp_set_element_len(buf, len);
+	return buf;
+}
+
+
+/* Returns the Icon Binary File element; if it is not from the icon cache, it
+ * is also returned in *tmp and the caller must free it */
+static const struct wpabuf *
+anqp_get_icon_binary_file(struct hostapd_data *hapd, const u8 *name,
+			  size_t name_len, struct wpabuf **tmp)
+{
+	struct anqp_cache *cache = hapd->anqp_cache;
+	struct hs20_icon *icon = NULL;
+	struct wpabuf *elem;
+	size_t i;
+	bool success;
+
+	*tmp = NULL;
+	wpa_hexdump_ascii(MSG_DEBUG, "HS 2.0: Requested Icon Filename",
+			  name, name_len);
+	for (i = 0; i < hapd->conf->hs20_icons_count; i++) {
+		if (name_len == os_strlen(hapd->conf->hs20_icons[i].name) &&
+		    os_memcmp(name, hapd->conf->hs20_icons[i].name,
+			      name_len) == 0) {
+			icon = &hapd->conf->hs20_icons[i];
+			break;
+		}
+	}
+
+	if (icon && i < cache->num_icons && cache->icons[i]) {
+		cache->icon_hits++;
+		return cache->icons[i];
+	}
+
+	elem = anqp_build_icon_binary_file(icon, &success);
+	if (!elem || !success)
+		goto out;
+
+	if (!cache->icons) {
+		cache->icons = os_calloc(hapd->conf->hs20_icons_count,
+					 sizeof(struct wpabuf *));
+		if (!cache->icons)
+			goto out;
+		cache->num_icons = hapd->conf->hs20_icons_count;
+	}
+	cache->icons[i] = elem;
+	cache->icon_loads++;
+	wpa_printf(MSG_DEBUG, "HS 2.0: Loaded icon %s (%zu bytes)",
+		   icon->file, wpabuf_len(elem));
+	return elem;
+out:
+	*tmp = elem;
+	return elem;
 }
 
 
@@ -969,107 +1310,274 @@ static size_t anqp_get_required_len(struct hostapd_data *hapd,
 }
 
 
-static struct wpabuf *
-gas_serv_build_gas_resp_payload(struct hostapd_data *hapd,
-				unsigned int request,
-				const u8 *home_realm, size_t home_realm_len,
-				const u8 *icon_name, size_t icon_name_len,
-				const u16 *extra_req,
-				unsigned int num_extra_req)
+static void anqp_build_cached_elem(struct hostapd_data *hapd,
+				   struct wpabuf *buf, unsigned int idx)
 {
-	struct wpabuf *buf;
-	size_t len;
-	unsigned int i;
-
-	len = 1400;
-	if (request & (ANQP_REQ_NAI_REALM | ANQP_REQ_NAI_HOME_REALM))
-		len += 1000;
-	if (request & ANQP_REQ_ICON_REQUEST)
-		len += 65536;
+	if (idx == ANQP_CACHE_VENUE_URL) {
+		anqp_add_venue_url(hapd, buf);
+		return;
+	}
 #ifdef CONFIG_FILS
-	if (request & ANQP_FILS_REALM_INFO)
-		len += 2 * dl_list_len(&hapd->conf->fils_realms);
+	if (idx == ANQP_CACHE_FILS_REALM_INFO) {
+		anqp_add_fils_realm_info(hapd, buf);
+		return;
+	}
 #endif /* CONFIG_FILS */
-	len += anqp_get_required_len(hapd, extra_req, num_extra_req);
-
-	buf = wpabuf_alloc(len);
-	if (buf == NULL)
-		return NULL;
+	if (idx >= 32)
+		return;
 
-	if (request & ANQP_REQ_CAPABILITY_LIST)
+	switch (BIT(idx)) {
+	case ANQP_REQ_CAPABILITY_LIST:
 		anqp_add_capab_list(hapd, buf);
-	if (request & ANQP_REQ_VENUE_NAME)
+		break;
+	case ANQP_REQ_VENUE_NAME:
 		anqp_add_venue_name(hapd, buf);
-	if (request & ANQP_REQ_EMERGENCY_CALL_NUMBER)
+		break;
+	case ANQP_REQ_EMERGENCY_CALL_NUMBER:
 		anqp_add_elem(hapd, buf, ANQP_EMERGENCY_CALL_NUMBER);
-	if (request & ANQP_REQ_NETWORK_AUTH_TYPE)
+		break;
+	case ANQP_REQ_NETWORK_AUTH_TYPE:
 		anqp_add_network_auth_type(hapd, buf);
-	if (request & ANQP_REQ_ROAMING_CONSORTIUM)
+		break;
+	case ANQP_REQ_ROAMING_CONSORTIUM:
 		anqp_add_roaming_consortium(hapd, buf);
-	if (request & ANQP_REQ_IP_ADDR_TYPE_AVAILABILITY)
+		break;
+	case ANQP_REQ_IP_ADDR_TYPE_AVAILABILITY:
 		anqp_add_ip_addr_type_availability(hapd, buf);
-	if (request & (ANQP_REQ_NAI_REALM | ANQP_REQ_NAI_HOME_REALM))
-		anqp_add_nai_realm(hapd, buf, home_realm, home_realm_len,
-				   request & ANQP_REQ_NAI_REALM,
-				   request & ANQP_REQ_NAI_HOME_REALM);
-	if (request & ANQP_REQ_3GPP_CELLULAR_NETWORK)
+		break;
+	case ANQP_REQ_NAI_REALM:
+		anqp_add_nai_realm(hapd, buf, NULL, 0, 1, 0);
+		break;
+	case ANQP_REQ_3GPP_CELLULAR_NETWORK:
 		anqp_add_3gpp_cellular_network(hapd, buf);
-	if (request & ANQP_REQ_AP_GEOSPATIAL_LOCATION)
+		break;
+	case ANQP_REQ_AP_GEOSPATIAL_LOCATION:
 		anqp_add_elem(hapd, buf, ANQP_AP_GEOSPATIAL_LOCATION);
-	if (request & ANQP_REQ_AP_CIVIC_LOCATION)
+		break;
+	case ANQP_REQ_AP_CIVIC_LOCATION:
 		anqp_add_elem(hapd, buf, ANQP_AP_CIVIC_LOCATION);
-	if (request & ANQP_REQ_AP_LOCATION_PUBLIC_URI)
+		break;
+	case ANQP_REQ_AP_LOCATION_PUBLIC_URI:
 		anqp_add_elem(hapd, buf, ANQP_AP_LOCATION_PUBLIC_URI);
-	if (request & ANQP_REQ_DOMAIN_NAME)
+		break;
+	case ANQP_REQ_DOMAIN_NAME:
 		anqp_add_domain_name(hapd, buf);
-	if (request & ANQP_REQ_EMERGENCY_ALERT_URI)
+		break;
+	case ANQP_REQ_EMERGENCY_ALERT_URI:
 		anqp_add_elem(hapd, buf, ANQP_EMERGENCY_ALERT_URI);
-	if (request & ANQP_REQ_TDLS_CAPABILITY)
+		break;
+	case ANQP_REQ_TDLS_CAPABILITY:
 		anqp_add_elem(hapd, buf, ANQP_TDLS_CAPABILITY);
-	if (request & ANQP_REQ_EMERGENCY_NAI)
+		break;
+	case ANQP_REQ_EMERGENCY_NAI:
 		anqp_add_elem(hapd, buf, ANQP_EMERGENCY_NAI);
+		break;
+#ifdef CONFIG_HS20
+	case ANQP_REQ_HS_CAPABILITY_LIST:
+		anqp_add_hs_capab_list(hapd, buf);
+		break;
+	case ANQP_REQ_OPERATOR_FRIENDLY_NAME:
+		anqp_add_operator_friendly_name(hapd, buf);
+		break;
+	case ANQP_REQ_WAN_METRICS:
+		anqp_add_wan_metrics(hapd, buf);
+		break;
+	case ANQP_REQ_CONNECTION_CAPABILITY:
+		anqp_add_connection_capability(hapd, buf);
+		break;
+	case ANQP_REQ_OPERATING_CLASS:
+		anqp_add_operating_class(hapd, buf);
+		break;
+	case ANQP_REQ_OSU_PROVIDERS_LIST:
+		anqp_add_osu_providers_list(hapd, buf);
+		break;
+	case ANQP_REQ_OPERATOR_ICON_METADATA:
+		anqp_add_operator_icon_metadata(hapd, buf);
+		break;
+	case ANQP_REQ_OSU_PROVIDERS_NAI_LIST:
+		anqp_add_osu_providers_nai_list(hapd, buf);
+		break;
+#endif /* CONFIG_HS20 */
+#ifdef CONFIG_MBO
+	case ANQP_REQ_MBO_CELL_DATA_CONN_PREF:
+		anqp_add_mbo_cell_data_conn_pref(hapd, buf);
+		break;
+#endif /* CONFIG_MBO */
+	}
+}
+
+
+static const struct wpabuf * anqp_cache_get(struct hostapd_data *hapd,
+					    unsigned int idx)
+{
+	struct anqp_cache *cache = hapd->anqp_cache;
+	struct wpabuf *buf;
+
+	if (cache->elem[idx]) {
+		cache->elem_hits++;
+		return cache->elem[idx];
+	}
+
+	buf = wpabuf_alloc(ANQP_CACHE_MAX_ELEM);
+	if (!buf)
+		return NULL;
+	anqp_build_cached_elem(hapd, buf, idx);
+	cache->elem[idx] = wpabuf_dup(buf);
+	wpabuf_free(buf);
+	if (cache->elem[idx])
+		cache->elem_builds++;
+
+	return cache->elem[idx];
+}
+
+
+static void anqp_put_cached_idx(struct hostapd_data *hapd,
+				struct gas_resp *resp, unsigned int idx)
+{
+	const struct wpabuf *elem = hapd->anqp_cache->elem[idx];
+
+	gas_resp_add(resp, elem, 0, wpabuf_len(elem));
+}
+
+
+static void anqp_put_cached(struct hostapd_data *hapd, struct gas_resp *resp,
+			    unsigned int request, unsigned int req)
+{
+	unsigned int idx;
+
+	if (!(request & req))
+		return;
+	for (idx = 0; !(req & BIT(idx)); idx++)
+		;
+	anqp_put_cached_idx(hapd, resp, idx);
+}
+
+
+/* Builds the response as segments of the cached elements and the query
+ * specific parts that are written into resp->own */
+static int gas_serv_build_resp(struct hostapd_data *hapd,
+			       unsigned int request,
+			       const u8 *home_realm, size_t home_realm_len,
+			       const u8 *icon_name, size_t icon_name_len,
+			       const u16 *extra_req,
+			       unsigned int num_extra_req,
+			       struct gas_resp *resp)
+{
+	struct wpabuf *icon_tmp = NULL;
+#ifdef CONFIG_HS20
+	const struct wpabuf *icon = NULL;
+#endif /* CONFIG_HS20 */
+	unsigned int cached, i, idx;
+	size_t len = 0, start;
+
+	/* Make sure all the cached elements are available and find out the
+	 * length of the query specific parts */
+	cached = request & ~(ANQP_REQ_NAI_HOME_REALM | ANQP_REQ_ICON_REQUEST);
+	if (request & ANQP_REQ_NAI_HOME_REALM) {
+		/* Built based on the query; same limit as the full response
+		 * without the cache */
+		cached &= ~ANQP_REQ_NAI_REALM;
+		len += 2400;
+	}
+	for (i = 0; i < 32; i++) {
+		if (!(cached & BIT(i)))
+			continue;
+		if (!anqp_cache_get(hapd, i))
+			return -1;
+	}
+	for (i = 0; i < num_extra_req; i++) {
+		if (extra_req[i] == ANQP_VENUE_URL)
+			idx = ANQP_CACHE_VENUE_URL;
+#ifdef CONFIG_FILS
+		else if (extra_req[i] == ANQP_FILS_REALM_INFO)
+			idx = ANQP_CACHE_FILS_REALM_INFO;
+#endif /* CONFIG_FILS */
+		else
+			continue;
+		if (!anqp_cache_get(hapd, idx))
+			return -1;
+	}
+	len += anqp_get_required_len(hapd, extra_req, num_extra_req);
+#ifdef CONFIG_HS20
+	if (request & ANQP_REQ_ICON_REQUEST) {
+		icon = anqp_get_icon_binary_file(hapd, icon_name,
+						 icon_name_len, &icon_tmp);
+		if (!icon)
+			return -1;
+		if (icon_tmp)
+			len += wpabuf_len(icon_tmp);
+	}
+#endif /* CONFIG_HS20 */
+
+	if (gas_resp_init(resp, 32 + 2 + num_extra_req, len) < 0) {
+		wpabuf_free(icon_tmp);
+		return -1;
+	}
+
+	anqp_put_cached(hapd, resp, cached, ANQP_REQ_CAPABILITY_LIST);
+	anqp_put_cached(hapd, resp, cached, ANQP_REQ_VENUE_NAME);
+	anqp_put_cached(hapd, resp, cached, ANQP_REQ_EMERGENCY_CALL_NUMBER);
+	anqp_put_cached(hapd, resp, cached, ANQP_REQ_NETWORK_AUTH_TYPE);
+	anqp_put_cached(hapd, resp, cached, ANQP_REQ_ROAMING_CONSORTIUM);
+	anqp_put_cached(hapd, resp, cached,
+			ANQP_REQ_IP_ADDR_TYPE_AVAILABILITY);
+	if (request & ANQP_REQ_NAI_HOME_REALM) {
+		start = wpabuf_len(resp->own);
+		anqp_add_nai_realm(hapd, resp->own, home_realm, home_realm_len,
+				   request & ANQP_REQ_NAI_REALM, 1);
+		gas_resp_add_own(resp, start);
+	} else
+		anqp_put_cached(hapd, resp, cached, ANQP_REQ_NAI_REALM);
+	anqp_put_cached(hapd, resp, cached, ANQP_REQ_3GPP_CELLULAR_NETWORK);
+	anqp_put_cached(hapd, resp, cached, ANQP_REQ_AP_GEOSPATIAL_LOCATION);
+	anqp_put_cached(hapd, resp, cached, ANQP_REQ_AP_CIVIC_LOCATION);
+	anqp_put_cached(hapd, resp, cached, ANQP_REQ_AP_LOCATION_PUBLIC_URI);
+	anqp_put_cached(hapd, resp, cached, ANQP_REQ_DOMAIN_NAME);
+	anqp_put_cached(hapd, resp, cached, ANQP_REQ_EMERGENCY_ALERT_URI);
+	anqp_put_cached(hapd, resp, cached, ANQP_REQ_TDLS_CAPABILITY);
+	anqp_put_cached(hapd, resp, cached, ANQP_REQ_EMERGENCY_NAI);
 
 	for (i = 0; i < num_extra_req; i++) {
 #ifdef CONFIG_FILS
 		if (extra_req[i] == ANQP_FILS_REALM_INFO) {
-			anqp_add_fils_realm_info(hapd, buf);
+			anqp_put_cached_idx(hapd, resp,
+					    ANQP_CACHE_FILS_REALM_INFO);
 			continue;
 		}
 #endif /* CONFIG_FILS */
 		if (extra_req[i] == ANQP_VENUE_URL) {
-			anqp_add_venue_url(hapd, buf);
+			anqp_put_cached_idx(hapd, resp, ANQP_CACHE_VENUE_URL);
 			continue;
 		}
-		anqp_add_elem(hapd, buf, extra_req[i]);
+		start = wpabuf_len(resp->own);
+		anqp_add_elem(hapd, resp->own, extra_req[i]);
+		gas_resp_add_own(resp, start);
 	}
 
 #ifdef CONFIG_HS20
-	if (request & ANQP_REQ_HS_CAPABILITY_LIST)
-		anqp_add_hs_capab_list(hapd, buf);
-	if (request & ANQP_REQ_OPERATOR_FRIENDLY_NAME)
-		anqp_add_operator_friendly_name(hapd, buf);
-	if (request & ANQP_REQ_WAN_METRICS)
-		anqp_add_wan_metrics(hapd, buf);
-	if (request & ANQP_REQ_CONNECTION_CAPABILITY)
-		anqp_add_connection_capability(hapd, buf);
-	if (request & ANQP_REQ_OPERATING_CLASS)
-		anqp_add_operating_class(hapd, buf);
-	if (request & ANQP_REQ_OSU_PROVIDERS_LIST)
-		anqp_add_osu_providers_list(hapd, buf);
-	if (request & ANQP_REQ_ICON_REQUEST)
-		anqp_add_icon_binary_file(hapd, buf, icon_name, icon_name_len);
-	if (request & ANQP_REQ_OPERATOR_ICON_METADATA)
-		anqp_add_operator_icon_metadata(hapd, buf);
-	if (request & ANQP_REQ_OSU_PROVIDERS_NAI_LIST)
-		anqp_add_osu_providers_nai_list(hapd, buf);
+	anqp_put_cached(hapd, resp, cached, ANQP_REQ_HS_CAPABILITY_LIST);
+	anqp_put_cached(hapd, resp, cached, ANQP_REQ_OPERATOR_FRIENDLY_NAME);
+	anqp_put_cached(hapd, resp, cached, ANQP_REQ_WAN_METRICS);
+	anqp_put_cached(hapd, resp, cached, ANQP_REQ_CONNECTION_CAPABILITY);
+	anqp_put_cached(hapd, resp, cached, ANQP_REQ_OPERATING_CLASS);
+	anqp_put_cached(hapd, resp, cached, ANQP_REQ_OSU_PROVIDERS_LIST);
+	if (icon_tmp) {
+		start = wpabuf_len(resp->own);
+		wpabuf_put_buf(resp->own, icon_tmp);
+		gas_resp_add_own(resp, start);
+	} else if (icon) {
+		gas_resp_add(resp, icon, 0, wpabuf_len(icon));
+	}
+	anqp_put_cached(hapd, resp, cached, ANQP_REQ_OPERATOR_ICON_METADATA);
+	anqp_put_cached(hapd, resp, cached, ANQP_REQ_OSU_PROVIDERS_NAI_LIST);
 #endif /* CONFIG_HS20 */
 
 #ifdef CONFIG_MBO
-	if (request & ANQP_REQ_MBO_CELL_DATA_CONN_PREF)
-		anqp_add_mbo_cell_data_conn_pref(hapd, buf);
+	anqp_put_cached(hapd, resp, cached, ANQP_REQ_MBO_CELL_DATA_CONN_PREF);
 #endif /* CONFIG_MBO */
 
-	return buf;
+	wpabuf_free(icon_tmp);
+	return 0;
 }
 
 
@@ -1445,32 +1953,49 @@ static void rx_anqp_vendor_specific(struct hostapd_data *hapd,
 }
 
 
+static void gas_serv_update_latency(struct hostapd_data *hapd,
+				    struct os_reltime *start)
+{
+	struct anqp_cache *cache = hapd->anqp_cache;
+	struct os_reltime now, diff;
+	unsigned int usec;
+
+	os_get_reltime(&now);
+	os_reltime_sub(&now, start, &diff);
+	usec = diff.sec > 1000 ? 1000000000 : diff.sec * 1000000 + diff.usec;
+	cache->queries++;
+	cache->latency_last = usec;
+	cache->latency_total += usec;
+	if (usec > cache->latency_max)
+		cache->latency_max = usec;
+}
+
+
 static void gas_serv_req_local_processing(struct hostapd_data *hapd,
 					  const u8 *sa, u8 dialog_token,
 					  struct anqp_query_info *qi, int prot,
 					  int std_addr3)
 {
 	struct wpabuf *buf, *tx_buf;
-
-	buf = gas_serv_build_gas_resp_payload(hapd, qi->request,
-					      qi->home_realm_query,
-					      qi->home_realm_query_len,
-					      qi->icon_name, qi->icon_name_len,
-					      qi->extra_req, qi->num_extra_req);
-	wpa_hexdump_buf(MSG_MSGDUMP, "ANQP: Locally generated ANQP responses",
-			buf);
-	if (!buf)
+	struct gas_resp resp;
+	struct os_reltime start;
+
+	os_get_reltime(&start);
+	if (gas_serv_build_resp(hapd, qi->request, qi->home_realm_query,
+				qi->home_realm_query_len,
+				qi->icon_name, qi->icon_name_len,
+				qi->extra_req, qi->num_extra_req, &resp) < 0)
 		return;
 #ifdef CONFIG_P2P
-	if (wpabuf_len(buf) == 0 && qi->p2p_sd) {
+	if (resp.len == 0 && qi->p2p_sd) {
 		wpa_printf(MSG_DEBUG,
 			   "ANQP: Do not send response to P2P SD from generic GAS service (P2P SD implementation will process this)");
-		wpabuf_free(buf);
+		gas_resp_deinit(&resp);
 		return;
 	}
 #endif /* CONFIG_P2P */
 
-	if (wpabuf_len(buf) > hapd->conf->gas_frag_limit ||
+	if (resp.len > hapd->conf->gas_frag_limit ||
 	    hapd->conf->gas_comeback_delay) {
 		struct gas_dialog_info *di;
 		u16 comeback_delay = 1;
@@ -1480,26 +2005,33 @@ static void gas_serv_req_local_processing(struct hostapd_data *hapd,
 			comeback_delay = hapd->conf->gas_comeback_delay;
 		}
 
-		wpa_printf(MSG_DEBUG, "ANQP: Too long response to fit in "
-			   "initial response - use GAS comeback");
-		di = gas_dialog_create(hapd, sa, dialog_token);
+		wpa_printf(MSG_DEBUG, "ANQP: Too long response (%zu octets) "
+			   "to fit in initial response - use GAS comeback",
+			   resp.len);
+		di = gas_dialog_create(hapd, sa, dialog_token,
+				       gas_resp_mem(&resp));
 		if (!di) {
 			wpa_printf(MSG_INFO, "ANQP: Could not create dialog "
 				   "for " MACSTR " (dialog token %u)",
 				   MAC2STR(sa), dialog_token);
-			wpabuf_free(buf);
+			gas_resp_deinit(&resp);
 			tx_buf = gas_anqp_build_initial_resp_buf(
 				dialog_token, WLAN_STATUS_UNSPECIFIED_FAILURE,
 				0, NULL);
 		} else {
 			di->prot = prot;
-			di->sd_resp = buf;
-			di->sd_resp_pos = 0;
+			di->resp = resp;
 			tx_buf = gas_anqp_build_initial_resp_buf(
 				dialog_token, WLAN_STATUS_SUCCESS,
 				comeback_delay, NULL);
 		}
 	} else {
+		buf = gas_resp_get_buf(&resp);
+		gas_resp_deinit(&resp);
+		wpa_hexdump_buf(MSG_MSGDUMP,
+				"ANQP: Locally generated ANQP responses", buf);
+		if (!buf)
+			return;
 		wpa_printf(MSG_DEBUG, "ANQP: Initial response (no comeback)");
 		tx_buf = gas_anqp_build_initial_resp_buf(
 			dialog_token, WLAN_STATUS_SUCCESS, 0, buf);
@@ -1518,6 +2050,7 @@ static void gas_serv_req_local_processing(struct hostapd_data *hapd,
 						 wpabuf_head(tx_buf),
 						 wpabuf_len(tx_buf));
 	wpabuf_free(tx_buf);
+	gas_serv_update_latency(hapd, &start);
 }
 
 
@@ -1527,6 +2060,7 @@ void gas_serv_req_dpp_processing(struct hostapd_data *hapd,
 				 int prot, struct wpabuf *buf)
 {
 	struct wpabuf *tx_buf;
+	struct gas_resp resp;
 
 	if (wpabuf_len(buf) > hapd->conf->gas_frag_limit ||
 	    hapd->conf->gas_comeback_delay) {
@@ -1540,12 +2074,19 @@ void gas_serv_req_dpp_processing(struct hostapd_data *hapd,
 
 		wpa_printf(MSG_DEBUG,
 			   "DPP: Too long response to fit in initial response - use GAS comeback");
-		di = gas_dialog_create(hapd, sa, dialog_token);
+		di = NULL;
+		if (gas_resp_init_buf(&resp, buf) < 0) {
+			wpabuf_free(buf);
+		} else {
+			di = gas_dialog_create(hapd, sa, dialog_token,
+					       gas_resp_mem(&resp));
+			if (!di)
+				gas_resp_deinit(&resp);
+		}
 		if (!di) {
 			wpa_printf(MSG_INFO, "DPP: Could not create dialog for "
 				   MACSTR " (dialog token %u)",
 				   MAC2STR(sa), dialog_token);
-			wpabuf_free(buf);
 			tx_buf = gas_build_initial_resp(
 				dialog_token, WLAN_STATUS_UNSPECIFIED_FAILURE,
 				0, 10);
@@ -1553,9 +2094,8 @@ void gas_serv_req_dpp_processing(struct hostapd_data *hapd,
 				gas_serv_write_dpp_adv_proto(tx_buf);
 		} else {
 			di->prot = prot;
-			di->sd_resp = buf;
-			di->sd_resp_pos = 0;
 			di->dpp = 1;
+			di->resp = resp;
 			tx_buf = gas_build_initial_resp(
 				dialog_token, WLAN_STATUS_SUCCESS,
 				comeback_delay, 10 + 2);
@@ -1749,7 +2289,7 @@ static void gas_serv_rx_gas_comeback_req(struct hostapd_data *hapd,
 	wpa_msg(hapd->msg_ctx, MSG_DEBUG, "GAS: Dialog Token: %u",
 		dialog_token);
 
-	dialog = gas_serv_dialog_find(hapd, sa, dialog_token);
+	dialog = gas_dialog_find(hapd, sa, dialog_token);
 	if (!dialog) {
 		wpa_msg(hapd->msg_ctx, MSG_DEBUG, "GAS: No pending SD "
 			"response fragment for " MACSTR " dialog token %u",
@@ -1765,26 +2305,27 @@ static void gas_serv_rx_gas_comeback_req(struct hostapd_data *hapd,
 		goto send_resp;
 	}
 
-	frag_len = wpabuf_len(dialog->sd_resp) - dialog->sd_resp_pos;
+	frag_len = dialog->resp.len - dialog->resp_pos;
 	if (frag_len > hapd->conf->gas_frag_limit) {
 		frag_len = hapd->conf->gas_frag_limit;
 		more = 1;
 	}
 	wpa_msg(hapd->msg_ctx, MSG_DEBUG, "GAS: resp frag_len %u",
 		(unsigned int) frag_len);
-	buf = wpabuf_alloc_copy(wpabuf_head_u8(dialog->sd_resp) +
-				dialog->sd_resp_pos, frag_len);
+	buf = wpabuf_alloc(frag_len);
 	if (buf == NULL) {
 		wpa_msg(hapd->msg_ctx, MSG_DEBUG, "GAS: Failed to allocate "
 			"buffer");
-		gas_serv_dialog_clear(dialog);
+		gas_dialog_free(hapd, dialog);
 		return;
 	}
+	gas_resp_copy(&dialog->resp, dialog->resp_pos, frag_len, buf);
+	wpa_hexdump_buf(MSG_MSGDUMP, "GAS: Response fragment", buf);
 #ifdef CONFIG_DPP
 	if (dialog->dpp) {
 		tx_buf = gas_build_comeback_resp(dialog_token,
 						 WLAN_STATUS_SUCCESS,
-						 dialog->sd_frag_id, more, 0,
+						 dialog->frag_id, more, 0,
 						 10 + 2 + frag_len);
 		if (tx_buf) {
 			gas_serv_write_dpp_adv_proto(tx_buf);
@@ -1795,24 +2336,26 @@ static void gas_serv_rx_gas_comeback_req(struct hostapd_data *hapd,
 #endif /* CONFIG_DPP */
 	tx_buf = gas_anqp_build_comeback_resp_buf(dialog_token,
 						  WLAN_STATUS_SUCCESS,
-						  dialog->sd_frag_id,
+						  dialog->frag_id,
 						  more, 0, buf);
 	wpabuf_free(buf);
 	if (tx_buf == NULL) {
-		gas_serv_dialog_clear(dialog);
+		gas_dialog_free(hapd, dialog);
 		return;
 	}
 	wpa_msg(hapd->msg_ctx, MSG_DEBUG, "GAS: Tx GAS Comeback Response "
 		"(frag_id %d more=%d frag_len=%d)",
-		dialog->sd_frag_id, more, (int) frag_len);
-	dialog->sd_frag_id++;
-	dialog->sd_resp_pos += frag_len;
+		dialog->frag_id, more, (int) frag_len);
+	dialog->frag_id++;
+	dialog->resp_pos += frag_len;
+	hapd->gas_dialogs->frags++;
 
 	if (more) {
 		wpa_msg(hapd->msg_ctx, MSG_DEBUG, "GAS: %d more bytes remain "
 			"to be sent",
-			(int) (wpabuf_len(dialog->sd_resp) -
-			       dialog->sd_resp_pos));
+			(int) (dialog->resp.len - dialog->resp_pos));
+		dl_list_del(&dialog->list);
+		gas_dialog_set_expire(hapd, dialog, GAS_DIALOG_TIMEOUT);
 	} else {
 		wpa_msg(hapd->msg_ctx, MSG_DEBUG, "GAS: All fragments of "
 			"SD response sent");
@@ -1820,8 +2363,8 @@ static void gas_serv_rx_gas_comeback_req(struct hostapd_data *hapd,
 		if (dialog->dpp)
 			hostapd_dpp_gas_status_handler(hapd, 1);
 #endif /* CONFIG_DPP */
-		gas_serv_dialog_clear(dialog);
-		gas_serv_free_dialogs(hapd, sa);
+		hapd->gas_dialogs->completed++;
+		gas_dialog_free(hapd, dialog);
 	}
 
 send_resp:
@@ -1883,6 +2426,9 @@ static void gas_serv_rx_public_action(void *ctx, const u8 *buf, size_t len,
 
 int gas_serv_init(struct hostapd_data *hapd)
 {
+	hapd->anqp_cache = os_zalloc(sizeof(*hapd->anqp_cache));
+	if (!hapd->anqp_cache)
+		return -1;
 	hapd->public_action_cb2 = gas_serv_rx_public_action;
 	hapd->public_action_cb2_ctx = hapd;
 	return 0;
@@ -1891,4 +2437,122 @@ int gas_serv_init(struct hostapd_data *hapd)
 
 void gas_serv_deinit(struct hostapd_data *hapd)
 {
+	if (hapd->gas_dialogs) {
+		gas_dialog_free_all(hapd, false);
+		eloop_cancel_timeout(gas_dialog_timeout, hapd, NULL);
+		os_free(hapd->gas_dialogs);
+		hapd->gas_dialogs = NULL;
+	}
+	gas_serv_flush_cache(hapd);
+	os_free(hapd->anqp_cache);
+	hapd->anqp_cache = NULL;
+}
+
+
+/**
+ * gas_serv_flush_cache - Flush the ANQP response cache
+ * @hapd: BSS data
+ *
+ * This needs to be called whenever the configuration of the BSS changes so
+ * that the following ANQP responses are built based on the new configuration.
+ * Pending ANQP dialogs refer to the cached elements and they are dropped.
+ */
+void gas_serv_flush_cache(struct hostapd_data *hapd)
+{
+	struct anqp_cache *cache = hapd->anqp_cache;
+	size_t i;
+
+	if (!cache)
+		return;
+
+	gas_dialog_free_all(hapd, true);
+
+	for (i = 0; i < ANQP_CACHE_ENTRIES; i++) {
+		wpabuf_free(cache->elem[i]);
+		cache->elem[i] = NULL;
+	}
+	for (i = 0; i < cache->num_icons; i++)
+		wpabuf_free(cache->icons[i]);
+	os_free(cache->icons);
+	cache->icons = NULL;
+	cache->num_icons = 0;
+	cache->flushes++;
+}
+
+
+static int gas_dialog_get_mib(struct hostapd_data *hapd, char *buf,
+			      size_t buflen)
+{
+	struct gas_dialog_table *table = hapd->gas_dialogs;
+	int ret;
+
+	if (!table)
+		return 0;
+
+	ret = os_snprintf(buf, buflen,
+			  "gas_dialogs_pending=%u\n"
+			  "gas_dialog_mem=%zu\n"
+			  "gas_dialog_mem_peak=%zu\n"
+			  "gas_dialogs_created=%u\n"
+			  "gas_dialogs_completed=%u\n"
+			  "gas_dialogs_expired=%u\n"
+			  "gas_dialogs_rejected=%u\n"
+			  "gas_dialogs_aborted=%u\n"
+			  "gas_comeback_frags=%u\n",
+			  table->num, table->mem, table->mem_peak,
+			  table->created, table->completed, table->expired,
+			  table->rejected, table->aborted, table->frags);
+	if (os_snprintf_error(buflen, ret))
+		return 0;
+	return ret;
+}
+
+
+int gas_serv_get_mib(struct hostapd_data *hapd, char *buf, size_t buflen)
+{
+	struct anqp_cache *cache = hapd->anqp_cache;
+	unsigned int entries = 0, icons = 0;
+	size_t i, bytes = 0;
+	int ret;
+
+	if (!cache)
+		return gas_dialog_get_mib(hapd, buf, buflen);
+
+	for (i = 0; i < ANQP_CACHE_ENTRIES; i++) {
+		if (cache->elem[i]) {
+			entries++;
+			bytes += wpabuf_len(cache->elem[i]);
+		}
+	}
+	for (i = 0; i < cache->num_icons; i++) {
+		if (cache->icons[i]) {
+			icons++;
+			bytes += wpabuf_len(cache->icons[i]);
+		}
+	}
+
+	ret = os_snprintf(buf, buflen,
+			  "anqp_queries=%u\n"
+			  "anqp_cache_entries=%u\n"
+			  "anqp_cache_icons=%u\n"
+			  "anqp_cache_bytes=%zu\n"
+			  "anqp_cache_hits=%u\n"
+			  "anqp_cache_builds=%u\n"
+			  "anqp_icon_hits=%u\n"
+			  "anqp_icon_loads=%u\n"
+			  "anqp_cache_flushes=%u\n"
+			  "anqp_latency_last=%u\n"
+			  "anqp_latency_avg=%u\n"
+			  "anqp_latency_max=%u\n",
+			  cache->queries, entries, icons, bytes,
+			  cache->elem_hits, cache->elem_builds,
+			  cache->icon_hits, cache->icon_loads, cache->flushes,
+			  cache->latency_last,
+			  cache->queries ?
+			  (unsigned int) (cache->latency_total /
+					  cache->queries) : 0,
+			  cache->latency_max);
+	if (os_snprintf_error(buflen, ret))
+		return 0;
+	return ret + gas_dialog_get_mib(hapd, buf + ret, buflen - ret);
 }
@@ -68,25 +68,12 @@
 #define ANQP_REQ_MBO_CELL_DATA_CONN_PREF \
 	(BIT(29) << MBO_ANQP_SUBTYPE_CELL_CONN_PREF)
 
-struct gas_dialog_info {
-	u8 valid;
-	struct wpabuf *sd_resp; /* Fragmented response */
-	u8 dialog_token;
-	size_t sd_resp_pos; /* Offset in sd_resp */
-	u8 sd_frag_id;
-	int prot; /* whether Protected Dual of Public Action frame is used */
-	int dpp; /* whether this is a DPP Config Response */
-};
-
 struct hostapd_data;
 
-struct gas_dialog_info *
-gas_serv_dialog_find(struct hostapd_data *hapd, const u8 *addr,
-		     u8 dialog_token);
-void gas_serv_dialog_clear(struct gas_dialog_info *dialog);
-
 int gas_serv_init(struct hostapd_data *hapd);
 void gas_serv_deinit(struct hostapd_data *hapd);
+void gas_serv_flush_cache(struct hostapd_data *hapd);
+int gas_serv_get_mib(struct hostapd_data *hapd, char *buf, size_t buflen);
 
 void gas_serv_req_dpp_processing(struct hostapd_data *hapd,
 				 const u8 *sa, u8 dialog_token,
@@ -14,6 +14,7 @@
 #include "utils/common.h"
 #include "utils/eloop.h"
 #include "utils/crc32.h"
+#include "utils/objpool.h"
 #include "common/ieee802_11_defs.h"
 #include "common/wpa_ctrl.h"
 #include "common/hw_features_common.h"
@@ -168,27 +169,64 @@ static void hostapd_reload_bss(struct hostapd_data *hapd)
 }
 
 
-static void hostapd_clear_old(struct hostapd_iface *iface)
+static void hostapd_clear_old_bss(struct hostapd_data *hapd)
 {
-	size_t j;
-
 	/*
 	 * Deauthenticate all stations since the new configuration may not
 	 * allow them to use the BSS anymore.
 	 */
-	for (j = 0; j < iface->num_bss; j++) {
-		hostapd_flush_old_stations(iface->bss[j],
-					   WLAN_REASON_PREV_AUTH_NOT_VALID);
+	hostapd_flush_old_stations(hapd, WLAN_REASON_PREV_AUTH_NOT_VALID);
 #ifdef CONFIG_WEP
-		hostapd_broadcast_wep_clear(iface->bss[j]);
+	hostapd_broadcast_wep_clear(hapd);
 #endif /* CONFIG_WEP */
 
 #ifndef CONFIG_NO_RADIUS
-		/* TODO: update dynamic data based on changed configuration
-		 * items (e.g., open/close sockets, etc.) */
-		radius_client_flush(iface->bss[j]->radius, 0);
+	/* TODO: The RADIUS client sockets are updated by
+	 * radius_client_reconfig(), but the RADIUS DAS and integrated RADIUS
+	 * server sockets are not reopened if their ports change. */
+	radius_client_flush(hapd->radius, 0);
 #endif /* CONFIG_NO_RADIUS */
+}
+
+
+static void hostapd_clear_old(struct hostapd_iface *iface)
+{
+	size_t j;
+
+	for (j = 0; j < iface->num_bss; j++)
+		hostapd_clear_old_bss(iface->bss[j]);
+}
+
+
+/*
+ * Apply a reloaded BSS configuration that hostapd_bss_config_diff() found to
+ * differ only in items that do not require the BSS to be reinitialized.
+ * Stations remain associated unless the new ACL rejects them.
+ */
+static void hostapd_reload_bss_changes(struct hostapd_data *hapd,
+				       struct hostapd_bss_config *oldconf,
+				       unsigned int changes)
+{
+	hostapd_bss_config_move_state(hapd->conf, oldconf);
+
+	if (hapd->conf->wmm_enabled < 0)
+		hapd->conf->wmm_enabled = hapd->iconf->ieee80211n |
+			hapd->iconf->ieee80211ax;
+
+#ifndef CONFIG_NO_RADIUS
+	radius_client_reconfig(hapd->radius, hapd->conf->radius);
+#endif /* CONFIG_NO_RADIUS */
+
+	if (hapd->wpa_auth)
+		hostapd_update_wpa_conf(hapd);
+
+	if (changes & HOSTAPD_BSS_CHANGE_ACL) {
+		hostapd_disassoc_accept_mac(hapd);
+		hostapd_disassoc_deny_mac(hapd);
 	}
+
+	if (changes & HOSTAPD_BSS_CHANGE_BEACON)
+		ieee802_11_set_beacon(hapd);
 }
 
 
@@ -215,6 +253,10 @@ int hostapd_reload_config(struct hostapd_iface *iface)
 	struct hapd_interfaces *interfaces = iface->interfaces;
 	struct hostapd_data *hapd = iface->bss[0];
 	struct hostapd_config *newconf, *oldconf;
+	struct os_reltime start, parsed, end, diff;
+	unsigned int *changes;
+	bool full;
+	char txt[100];
 	size_t j;
 
 	if (iface->config_fname == NULL) {
@@ -228,17 +270,19 @@ int hostapd_reload_config(struct hostapd_iface *iface)
 	if (iface->interfaces == NULL ||
 	    iface->interfaces->config_read_cb == NULL)
 		return -1;
+	os_get_reltime(&start);
 	newconf = iface->interfaces->config_read_cb(iface->config_fname);
 	if (newconf == NULL)
 		return -1;
-
-	hostapd_clear_old(iface);
+	os_get_reltime(&parsed);
 
 	oldconf = hapd->iconf;
 	if (hostapd_iface_conf_changed(newconf, oldconf)) {
 		char *fname;
 		int res;
 
+		hostapd_clear_old(iface);
+
 		wpa_printf(MSG_DEBUG,
 			   "Configuration changes include interface/BSS modification - force full disable+enable sequence");
 		fname = os_strdup(iface->config_fname);
@@ -264,6 +308,26 @@ int hostapd_reload_config(struct hostapd_iface *iface)
 				   "Failed to enable interface on config reload");
 		return res;
 	}
+
+	/*
+	 * Compare the configurations to find the BSSs that can be updated
+	 * without the full reload sequence. The first BSS includes the
+	 * interface parameters, so a full reload of it is needed for all BSSs.
+	 */
+	changes = os_calloc(iface->num_bss, sizeof(*changes));
+	for (j = 0; changes && j < iface->num_bss; j++)
+		changes[j] = hostapd_bss_config_diff(oldconf->bss[j],
+						     newconf->bss[j]);
+	full = !changes || (changes[0] & HOSTAPD_BSS_CHANGE_FULL);
+	if (full) {
+		hostapd_clear_old(iface);
+	} else {
+		for (j = 0; j < iface->num_bss; j++) {
+			if (changes[j] & HOSTAPD_BSS_CHANGE_FULL)
+				hostapd_clear_old_bss(iface->bss[j]);
+		}
+	}
+
 	iface->conf = newconf;
 
 	for (j = 0; j < iface->num_bss; j++) {
@@ -285,11 +349,36 @@ int hostapd_reload_config(struct hostapd_iface *iface)
 			hapd->iconf,
 			hostapd_get_oper_centr_freq_seg1_idx(oldconf));
 		hapd->conf = newconf->bss[j];
-		hostapd_reload_bss(hapd);
+#ifdef CONFIG_INTERWORKING
+		gas_serv_flush_cache(hapd);
+#endif /* CONFIG_INTERWORKING */
+		if (full) {
+			hostapd_reload_bss(hapd);
+			wpa_printf(MSG_INFO, "%s: Configuration reloaded: full",
+				   hapd->conf->iface);
+			continue;
+		}
+		if (changes[j] & HOSTAPD_BSS_CHANGE_FULL)
+			hostapd_reload_bss(hapd);
+		else if (hapd->started)
+			hostapd_reload_bss_changes(hapd, oldconf->bss[j],
+						   changes[j]);
+		hostapd_bss_changes_txt(changes[j], txt, sizeof(txt));
+		wpa_printf(MSG_INFO, "%s: Configuration reloaded: %s",
+			   hapd->conf->iface, txt);
 	}
 
 	hostapd_config_free(oldconf);
+	os_free(changes);
 
+	os_get_reltime(&end);
+	os_reltime_sub(&end, &start, &diff);
+	os_reltime_sub(&parsed, &start, &parsed);
+	wpa_printf(MSG_INFO,
+		   "%s: Configuration reload took %ld.%06ld s (parsing %ld.%06ld s)",
+		   iface->conf->bss[0]->iface,
+		   (long) diff.sec, (long) diff.usec,
+		   (long) parsed.sec, (long) parsed.usec);
 
 	return 0;
 }
@@ -418,9 +507,9 @@ void hostapd_free_hapd_data(struct hostapd_data *hapd)
 	wpabuf_free(hapd->time_adv);
 	hapd->time_adv = NULL;
 
-#ifdef CONFIG_INTERWORKING
+#if defined(CONFIG_INTERWORKING) || defined(CONFIG_DPP)
 	gas_serv_deinit(hapd);
-#endif /* CONFIG_INTERWORKING */
+#endif /* CONFIG_INTERWORKING || CONFIG_DPP */
 
 	bss_load_update_deinit(hapd);
 	ndisc_snoop_deinit(hapd);
@@ -428,11 +517,7 @@ void hostapd_free_hapd_data(struct hostapd_data *hapd)
 	x_snoop_deinit(hapd);
 
 #ifdef CONFIG_SQLITE
-	bin_clear_free(hapd->tmp_eap_user.identity,
-		       hapd->tmp_eap_user.identity_len);
-	bin_clear_free(hapd->tmp_eap_user.password,
-		       hapd->tmp_eap_user.password_len);
-	os_memset(&hapd->tmp_eap_user, 0, sizeof(hapd->tmp_eap_user));
+	hostapd_eap_user_db_deinit(hapd);
 #endif /* CONFIG_SQLITE */
 
 #ifdef CONFIG_MESH
@@ -462,6 +547,9 @@ void hostapd_free_hapd_data(struct hostapd_data *hapd)
 	}
 	eloop_cancel_timeout(auth_sae_process_commit, hapd, NULL);
 #endif /* CONFIG_SAE */
+
+	objpool_deinit(hapd->sta_pool);
+	hapd->sta_pool = NULL;
 }
 
 
@@ -1133,6 +1221,15 @@ static int hostapd_setup_bss(struct hostapd_data *hapd, int first)
 	}
 	hapd->started = 1;
 
+	if (!hapd->sta_pool) {
+		hapd->sta_pool = objpool_init("sta_info",
+					      sizeof(struct sta_info),
+					      conf->sta_pool_prealloc,
+					      conf->sta_pool_max);
+		if (!hapd->sta_pool)
+			return -1;
+	}
+
 	if (!first || first == -1) {
 		u8 *addr = hapd->own_addr;
 
@@ -1469,8 +1566,8 @@ static void hostapd_set_acl(struct hostapd_data *hapd)
 
 	if (conf->bss[0]->macaddr_acl == DENY_UNLESS_ACCEPTED) {
 		accept_acl = 1;
-		err = hostapd_set_acl_list(hapd, conf->bss[0]->accept_mac,
-					   conf->bss[0]->num_accept_mac,
+		err = hostapd_set_acl_list(hapd, conf->bss[0]->accept_mac.entries,
+					   conf->bss[0]->accept_mac.num,
 					   accept_acl);
 		if (err) {
 			wpa_printf(MSG_DEBUG, "Failed to set accept acl");
@@ -1478,8 +1575,8 @@ static void hostapd_set_acl(struct hostapd_data *hapd)
 		}
 	} else if (conf->bss[0]->macaddr_acl == ACCEPT_UNLESS_DENIED) {
 		accept_acl = 0;
-		err = hostapd_set_acl_list(hapd, conf->bss[0]->deny_mac,
-					   conf->bss[0]->num_deny_mac,
+		err = hostapd_set_acl_list(hapd, conf->bss[0]->deny_mac.entries,
+					   conf->bss[0]->deny_mac.num,
 					   accept_acl);
 		if (err) {
 			wpa_printf(MSG_DEBUG, "Failed to set deny acl");
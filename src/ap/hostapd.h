@@ -32,6 +32,9 @@ struct hostapd_data;
 struct sta_info;
 struct ieee80211_ht_capabilities;
 struct full_dynamic_vlan;
+struct objpool;
+struct anqp_cache;
+struct gas_dialog_table;
 enum wps_event;
 union wps_event_data;
 #ifdef CONFIG_MESH
@@ -168,6 +171,7 @@ struct hostapd_data {
 #define STA_HASH_SIZE 256
 #define STA_HASH(sta) (sta[5])
 	struct sta_info *sta_hash[STA_HASH_SIZE];
+	struct objpool *sta_pool; /* struct sta_info allocations */
 
 	/*
 	 * Bitfield for indicating which AIDs are allocated. Only AID values
@@ -190,8 +194,7 @@ struct hostapd_data {
 	u64 acct_session_id;
 	struct radius_das_data *radius_das;
 
-	struct hostapd_cached_radius_acl *acl_cache;
-	struct hostapd_acl_query_data *acl_queries;
+	struct hostapd_acl_cache *acl_cache;
 
 	struct wpa_authenticator *wpa_auth;
 	struct eapol_authenticator *eapol_auth;
@@ -259,6 +262,8 @@ struct hostapd_data {
 	void (*public_action_cb2)(void *ctx, const u8 *buf, size_t len,
 				  int freq);
 	void *public_action_cb2_ctx;
+	struct anqp_cache *anqp_cache; /* GAS server ANQP response cache */
+	struct gas_dialog_table *gas_dialogs; /* GAS server pending dialogs */
 
 	int (*vendor_action_cb)(void *ctx, const u8 *buf, size_t len,
 				int freq);
@@ -324,6 +329,7 @@ struct hostapd_data {
 
 #ifdef CONFIG_SQLITE
 	struct hostapd_eap_user tmp_eap_user;
+	struct eap_user_db *eap_user_db;
 #endif /* CONFIG_SQLITE */
 
 #ifdef CONFIG_SAE
@@ -680,6 +686,7 @@ void hostapd_acs_channel_selected(struct hostapd_data *hapd,
 const struct hostapd_eap_user *
 hostapd_get_eap_user(struct hostapd_data *hapd, const u8 *identity,
 		     size_t identity_len, int phase2);
+void hostapd_eap_user_db_deinit(struct hostapd_data *hapd);
 
 struct hostapd_data * hostapd_get_iface(struct hapd_interfaces *interfaces,
 					const char *ifname);
@@ -22,16 +22,21 @@
 #include "ap_drv_ops.h"
 #include "ieee802_11.h"
 #include "ieee802_1x.h"
+#include "sta_info.h"
+#include "vlan.h"
 #include "ieee802_11_auth.h"
 
 #define RADIUS_ACL_TIMEOUT 30
+#define RADIUS_ACL_HASH_SIZE 1024
+#define RADIUS_ACL_HASH(a) ((((a)[4] << 8) | (a)[5]) & \
+			    (RADIUS_ACL_HASH_SIZE - 1))
 
 
 struct hostapd_cached_radius_acl {
-	struct os_reltime timestamp;
+	struct os_reltime expires;
 	macaddr addr;
 	int accepted; /* HOSTAPD_ACL_* */
-	struct hostapd_cached_radius_acl *next;
+	struct hostapd_cached_radius_acl *next; /* next entry in hash bucket */
 	struct radius_sta info;
 };
 
@@ -42,7 +47,36 @@ struct hostapd_acl_query_data {
 	macaddr addr;
 	u8 *auth_msg; /* IEEE 802.11 authentication frame from station */
 	size_t auth_msg_len;
-	struct hostapd_acl_query_data *next;
+	struct hostapd_acl_query_data *next; /* next query in address bucket */
+	struct hostapd_acl_query_data *next_id; /* next query with same id */
+};
+
+
+/*
+ * RADIUS ACL query results and pending queries of a BSS. Both are hashed by
+ * the station address and pending queries are also indexed by RADIUS
+ * Identifier for matching the responses. Duplicate authentication attempts
+ * while a query is pending are coalesced into that query.
+ */
+struct hostapd_acl_cache {
+	struct hostapd_cached_radius_acl *entries[RADIUS_ACL_HASH_SIZE];
+	struct hostapd_acl_query_data *queries[RADIUS_ACL_HASH_SIZE];
+	struct hostapd_acl_query_data *queries_by_id[256];
+	unsigned int num_entries;
+	unsigned int num_queries;
+
+	/* Statistics */
+	unsigned int hits;
+	unsigned int negative_hits;
+	unsigned int misses;
+	unsigned int queries_sent;
+	unsigned int queries_coalesced;
+	unsigned int queries_expired;
+	unsigned int accepts;
+	unsigned int rejects;
+	unsigned int latency_last; /* ms */
+	unsigned int latency_max; /* ms */
+	u64 latency_total; /* ms */
 };
 
 
@@ -56,41 +90,109 @@ static void hostapd_acl_cache_free_entry(struct hostapd_cached_radius_acl *e)
 }
 
 
-static void hostapd_acl_cache_free(struct hostapd_cached_radius_acl *acl_cache)
+static struct hostapd_acl_cache * hostapd_acl_cache(struct hostapd_data *hapd)
 {
-	struct hostapd_cached_radius_acl *prev;
-
-	while (acl_cache) {
-		prev = acl_cache;
-		acl_cache = acl_cache->next;
-		hostapd_acl_cache_free_entry(prev);
-	}
+	if (!hapd->acl_cache)
+		hapd->acl_cache = os_zalloc(sizeof(*hapd->acl_cache));
+	return hapd->acl_cache;
 }
 
 
-static int hostapd_acl_cache_get(struct hostapd_data *hapd, const u8 *addr,
-				 struct radius_sta *out)
+static int hostapd_acl_cache_get(struct hostapd_acl_cache *cache,
+				 const u8 *addr, struct radius_sta *out)
 {
 	struct hostapd_cached_radius_acl *entry;
 	struct os_reltime now;
 
+	entry = cache->entries[RADIUS_ACL_HASH(addr)];
+	while (entry && os_memcmp(entry->addr, addr, ETH_ALEN) != 0)
+		entry = entry->next;
+	if (!entry)
+		return -1;
+
 	os_get_reltime(&now);
+	if (!os_reltime_before(&now, &entry->expires))
+		return -1; /* entry has expired */
+	*out = entry->info;
+
+	return entry->accepted;
+}
 
-	for (entry = hapd->acl_cache; entry; entry = entry->next) {
-		if (os_memcmp(entry->addr, addr, ETH_ALEN) != 0)
-			continue;
 
-		if (os_reltime_expired(&now, &entry->timestamp,
-				       RADIUS_ACL_TIMEOUT))
-			return -1; /* entry has expired */
-		*out = entry->info;
+static void hostapd_acl_cache_add(struct hostapd_acl_cache *cache,
+				  struct hostapd_cached_radius_acl *entry)
+{
+	struct hostapd_cached_radius_acl **pos;
+
+	/* Replace a previous (expired) result for the same station */
+	pos = &cache->entries[RADIUS_ACL_HASH(entry->addr)];
+	while (*pos) {
+		if (os_memcmp((*pos)->addr, entry->addr, ETH_ALEN) == 0) {
+			struct hostapd_cached_radius_acl *old = *pos;
 
-		return entry->accepted;
+			*pos = old->next;
+			hostapd_acl_cache_free_entry(old);
+			cache->num_entries--;
+			break;
+		}
+		pos = &(*pos)->next;
 	}
 
-	return -1;
+	pos = &cache->entries[RADIUS_ACL_HASH(entry->addr)];
+	entry->next = *pos;
+	*pos = entry;
+	cache->num_entries++;
+}
+
+
+static struct hostapd_acl_query_data *
+hostapd_acl_query_get(struct hostapd_acl_cache *cache, const u8 *addr)
+{
+	struct hostapd_acl_query_data *query;
+
+	query = cache->queries[RADIUS_ACL_HASH(addr)];
+	while (query && os_memcmp(query->addr, addr, ETH_ALEN) != 0)
+		query = query->next;
+	return query;
+}
+
+
+static void hostapd_acl_query_add(struct hostapd_acl_cache *cache,
+				  struct hostapd_acl_query_data *query)
+{
+	struct hostapd_acl_query_data **pos;
+
+	pos = &cache->queries[RADIUS_ACL_HASH(query->addr)];
+	query->next = *pos;
+	*pos = query;
+	pos = &cache->queries_by_id[query->radius_id];
+	query->next_id = *pos;
+	*pos = query;
+	cache->num_queries++;
+}
+
+
+static void hostapd_acl_query_unlink(struct hostapd_acl_cache *cache,
+				     struct hostapd_acl_query_data *query)
+{
+	struct hostapd_acl_query_data **pos;
+
+	for (pos = &cache->queries[RADIUS_ACL_HASH(query->addr)]; *pos;
+	     pos = &(*pos)->next) {
+		if (*pos == query) {
+			*pos = query->next;
+			break;
+		}
+	}
+	for (pos = &cache->queries_by_id[query->radius_id]; *pos;
+	     pos = &(*pos)->next_id) {
+		if (*pos == query) {
+			*pos = query->next_id;
+			break;
+		}
+	}
+	cache->num_queries--;
 }
-#endif /* CONFIG_NO_RADIUS */
 
 
 static void hostapd_acl_query_free(struct hostapd_acl_query_data *query)
@@ -102,7 +204,6 @@ static void hostapd_acl_query_free(struct hostapd_acl_query_data *query)
 }
 
 
-#ifndef CONFIG_NO_RADIUS
 static int hostapd_radius_acl_query(struct hostapd_data *hapd, const u8 *addr,
 				    struct hostapd_acl_query_data *query)
 {
@@ -174,12 +275,10 @@ static int hostapd_radius_acl_query(struct hostapd_data *hapd, const u8 *addr,
 int hostapd_check_acl(struct hostapd_data *hapd, const u8 *addr,
 		      struct vlan_description *vlan_id)
 {
-	if (hostapd_maclist_found(hapd->conf->accept_mac,
-				  hapd->conf->num_accept_mac, addr, vlan_id))
+	if (hostapd_maclist_found(&hapd->conf->accept_mac, addr, vlan_id))
 		return HOSTAPD_ACL_ACCEPT;
 
-	if (hostapd_maclist_found(hapd->conf->deny_mac,
-				  hapd->conf->num_deny_mac, addr, vlan_id))
+	if (hostapd_maclist_found(&hapd->conf->deny_mac, addr, vlan_id))
 		return HOSTAPD_ACL_REJECT;
 
 	if (hapd->conf->macaddr_acl == ACCEPT_UNLESS_DENIED)
@@ -227,6 +326,7 @@ int hostapd_allowed_address(struct hostapd_data *hapd, const u8 *addr,
 		return HOSTAPD_ACL_REJECT;
 #else /* CONFIG_NO_RADIUS */
 		struct hostapd_acl_query_data *query;
+		struct hostapd_acl_cache *cache;
 
 		if (is_probe_req) {
 			/* Skip RADIUS queries for Probe Request frames to avoid
@@ -237,23 +337,29 @@ int hostapd_allowed_address(struct hostapd_data *hapd, const u8 *addr,
 		if (hapd->conf->ssid.dynamic_vlan == DYNAMIC_VLAN_DISABLED)
 			os_memset(&out->vlan_id, 0, sizeof(out->vlan_id));
 
+		cache = hostapd_acl_cache(hapd);
+		if (!cache)
+			return HOSTAPD_ACL_REJECT;
+
 		/* Check whether ACL cache has an entry for this station */
-		res = hostapd_acl_cache_get(hapd, addr, out);
+		res = hostapd_acl_cache_get(cache, addr, out);
 		if (res == HOSTAPD_ACL_ACCEPT ||
-		    res == HOSTAPD_ACL_ACCEPT_TIMEOUT)
+		    res == HOSTAPD_ACL_ACCEPT_TIMEOUT) {
+			cache->hits++;
 			return res;
-		if (res == HOSTAPD_ACL_REJECT)
+		}
+		if (res == HOSTAPD_ACL_REJECT) {
+			cache->negative_hits++;
 			return HOSTAPD_ACL_REJECT;
+		}
 
-		query = hapd->acl_queries;
-		while (query) {
-			if (os_memcmp(query->addr, addr, ETH_ALEN) == 0) {
-				/* pending query in RADIUS retransmit queue;
-				 * do not generate a new one */
-				return HOSTAPD_ACL_PENDING;
-			}
-			query = query->next;
+		if (hostapd_acl_query_get(cache, addr)) {
+			/* pending query in RADIUS retransmit queue;
+			 * do not generate a new one */
+			cache->queries_coalesced++;
+			return HOSTAPD_ACL_PENDING;
 		}
+		cache->misses++;
 
 		if (!hapd->conf->radius->auth_server)
 			return HOSTAPD_ACL_REJECT;
@@ -281,8 +387,8 @@ int hostapd_allowed_address(struct hostapd_data *hapd, const u8 *addr,
 			return HOSTAPD_ACL_REJECT;
 		}
 		query->auth_msg_len = len;
-		query->next = hapd->acl_queries;
-		hapd->acl_queries = query;
+		hostapd_acl_query_add(cache, query);
+		cache->queries_sent++;
 
 		/* Queued data will be processed in hostapd_acl_recv_radius()
 		 * when RADIUS server replies to the sent Access-Request. */
@@ -298,29 +404,26 @@ int hostapd_allowed_address(struct hostapd_data *hapd, const u8 *addr,
 static void hostapd_acl_expire_cache(struct hostapd_data *hapd,
 				     struct os_reltime *now)
 {
-	struct hostapd_cached_radius_acl *prev, *entry, *tmp;
-
-	prev = NULL;
-	entry = hapd->acl_cache;
+	struct hostapd_acl_cache *cache = hapd->acl_cache;
+	struct hostapd_cached_radius_acl **pos, *entry;
+	unsigned int i;
+
+	for (i = 0; cache->num_entries && i < RADIUS_ACL_HASH_SIZE; i++) {
+		pos = &cache->entries[i];
+		while (*pos) {
+			entry = *pos;
+			if (os_reltime_before(now, &entry->expires)) {
+				pos = &entry->next;
+				continue;
+			}
 
-	while (entry) {
-		if (os_reltime_expired(now, &entry->timestamp,
-				       RADIUS_ACL_TIMEOUT)) {
 			wpa_printf(MSG_DEBUG, "Cached ACL entry for " MACSTR
 				   " has expired.", MAC2STR(entry->addr));
-			if (prev)
-				prev->next = entry->next;
-			else
-				hapd->acl_cache = entry->next;
+			*pos = entry->next;
+			cache->num_entries--;
 			hostapd_drv_set_radius_acl_expire(hapd, entry->addr);
-			tmp = entry;
-			entry = entry->next;
-			hostapd_acl_cache_free_entry(tmp);
-			continue;
+			hostapd_acl_cache_free_entry(entry);
 		}
-
-		prev = entry;
-		entry = entry->next;
 	}
 }
 
@@ -328,29 +431,23 @@ static void hostapd_acl_expire_cache(struct hostapd_data *hapd,
 static void hostapd_acl_expire_queries(struct hostapd_data *hapd,
 				       struct os_reltime *now)
 {
-	struct hostapd_acl_query_data *prev, *entry, *tmp;
+	struct hostapd_acl_cache *cache = hapd->acl_cache;
+	struct hostapd_acl_query_data *query, *next;
+	unsigned int i;
 
-	prev = NULL;
-	entry = hapd->acl_queries;
+	for (i = 0; cache->num_queries && i < RADIUS_ACL_HASH_SIZE; i++) {
+		for (query = cache->queries[i]; query; query = next) {
+			next = query->next;
+			if (!os_reltime_expired(now, &query->timestamp,
+						RADIUS_ACL_TIMEOUT))
+				continue;
 
-	while (entry) {
-		if (os_reltime_expired(now, &entry->timestamp,
-				       RADIUS_ACL_TIMEOUT)) {
 			wpa_printf(MSG_DEBUG, "ACL query for " MACSTR
-				   " has expired.", MAC2STR(entry->addr));
-			if (prev)
-				prev->next = entry->next;
-			else
-				hapd->acl_queries = entry->next;
-
-			tmp = entry;
-			entry = entry->next;
-			hostapd_acl_query_free(tmp);
-			continue;
+				   " has expired.", MAC2STR(query->addr));
+			hostapd_acl_query_unlink(cache, query);
+			cache->queries_expired++;
+			hostapd_acl_query_free(query);
 		}
-
-		prev = entry;
-		entry = entry->next;
 	}
 }
 
@@ -363,6 +460,9 @@ void hostapd_acl_expire(struct hostapd_data *hapd)
 {
 	struct os_reltime now;
 
+	if (!hapd->acl_cache)
+		return;
+
 	os_get_reltime(&now);
 	hostapd_acl_expire_cache(hapd, &now);
 	hostapd_acl_expire_queries(hapd, &now);
@@ -451,19 +551,19 @@ hostapd_acl_recv_radius(struct radius_msg *msg, struct radius_msg *req,
 			void *data)
 {
 	struct hostapd_data *hapd = data;
-	struct hostapd_acl_query_data *query, *prev;
+	struct hostapd_acl_query_data *query;
 	struct hostapd_cached_radius_acl *cache;
 	struct radius_sta *info;
 	struct radius_hdr *hdr = radius_msg_get_hdr(msg);
+	struct os_reltime now, diff;
+	unsigned int latency;
+	int ttl;
 
-	query = hapd->acl_queries;
-	prev = NULL;
-	while (query) {
-		if (query->radius_id == hdr->identifier)
-			break;
-		prev = query;
-		query = query->next;
-	}
+	if (!hapd->acl_cache)
+		return RADIUS_RX_UNKNOWN;
+	query = hapd->acl_cache->queries_by_id[hdr->identifier];
+	while (query && query->radius_id != hdr->identifier)
+		query = query->next_id;
 	if (query == NULL)
 		return RADIUS_RX_UNKNOWN;
 
@@ -483,13 +583,20 @@ hostapd_acl_recv_radius(struct radius_msg *msg, struct radius_msg *req,
 		return RADIUS_RX_UNKNOWN;
 	}
 
+	os_get_reltime(&now);
+	os_reltime_sub(&now, &query->timestamp, &diff);
+	latency = diff.sec * 1000 + diff.usec / 1000;
+	hapd->acl_cache->latency_last = latency;
+	hapd->acl_cache->latency_total += latency;
+	if (latency > hapd->acl_cache->latency_max)
+		hapd->acl_cache->latency_max = latency;
+
 	/* Insert Accept/Reject info into ACL cache */
 	cache = os_zalloc(sizeof(*cache));
 	if (cache == NULL) {
 		wpa_printf(MSG_DEBUG, "Failed to add ACL cache entry");
 		goto done;
 	}
-	os_get_reltime(&cache->timestamp);
 	os_memcpy(cache->addr, query->addr, sizeof(cache->addr));
 	info = &cache->info;
 	if (hdr->code == RADIUS_CODE_ACCESS_ACCEPT) {
@@ -554,8 +661,17 @@ hostapd_acl_recv_radius(struct radius_msg *msg, struct radius_msg *req,
 			cache->accepted = HOSTAPD_ACL_REJECT;
 	} else
 		cache->accepted = HOSTAPD_ACL_REJECT;
-	cache->next = hapd->acl_cache;
-	hapd->acl_cache = cache;
+
+	if (cache->accepted == HOSTAPD_ACL_REJECT) {
+		hapd->acl_cache->rejects++;
+		ttl = hapd->conf->radius_acl_negative_ttl;
+	} else {
+		hapd->acl_cache->accepts++;
+		ttl = hapd->conf->radius_acl_cache_ttl;
+	}
+	cache->expires = now;
+	cache->expires.sec += ttl;
+	hostapd_acl_cache_add(hapd->acl_cache, cache);
 
 #ifdef CONFIG_DRIVER_RADIUS_ACL
 	hostapd_drv_set_radius_acl_auth(hapd, query->addr, cache->accepted,
@@ -570,11 +686,7 @@ hostapd_acl_recv_radius(struct radius_msg *msg, struct radius_msg *req,
 #endif /* CONFIG_DRIVER_RADIUS_ACL */
 
  done:
-	if (prev == NULL)
-		hapd->acl_queries = query->next;
-	else
-		prev->next = query->next;
-
+	hostapd_acl_query_unlink(hapd->acl_cache, query);
 	hostapd_acl_query_free(query);
 
 	return RADIUS_RX_PROCESSED;
@@ -605,20 +717,84 @@ int hostapd_acl_init(struct hostapd_data *hapd)
  */
 void hostapd_acl_deinit(struct hostapd_data *hapd)
 {
+#ifndef CONFIG_NO_RADIUS
+	struct hostapd_acl_cache *cache = hapd->acl_cache;
+	struct hostapd_cached_radius_acl *entry, *prev_entry;
 	struct hostapd_acl_query_data *query, *prev;
+	unsigned int i;
 
-#ifndef CONFIG_NO_RADIUS
-	hostapd_acl_cache_free(hapd->acl_cache);
+	if (!cache)
+		return;
+
+	for (i = 0; i < RADIUS_ACL_HASH_SIZE; i++) {
+		entry = cache->entries[i];
+		while (entry) {
+			prev_entry = entry;
+			entry = entry->next;
+			hostapd_acl_cache_free_entry(prev_entry);
+		}
+
+		query = cache->queries[i];
+		while (query) {
+			prev = query;
+			query = query->next;
+			hostapd_acl_query_free(prev);
+		}
+	}
+
+	os_free(cache);
 	hapd->acl_cache = NULL;
 #endif /* CONFIG_NO_RADIUS */
+}
 
-	query = hapd->acl_queries;
-	hapd->acl_queries = NULL;
-	while (query) {
-		prev = query;
-		query = query->next;
-		hostapd_acl_query_free(prev);
-	}
+
+/**
+ * hostapd_acl_get_mib - Get RADIUS ACL cache statistics
+ * @hapd: hostapd BSS data
+ * @buf: Buffer for the text
+ * @buflen: Length of the buffer
+ * Returns: Number of octets written to buf
+ */
+int hostapd_acl_get_mib(struct hostapd_data *hapd, char *buf, size_t buflen)
+{
+	struct hostapd_acl_cache *cache = hapd->acl_cache;
+	u64 hits, lookups, responses;
+	int ret;
+
+	if (!cache)
+		return 0;
+
+	/* Sum the counters in u64 so that the hit ratio does not overflow */
+	hits = (u64) cache->hits + cache->negative_hits;
+	lookups = hits + cache->misses;
+	responses = (u64) cache->accepts + cache->rejects;
+	ret = os_snprintf(buf, buflen,
+			  "acl_cache_entries=%u\n"
+			  "acl_cache_hits=%u\n"
+			  "acl_cache_negative_hits=%u\n"
+			  "acl_cache_misses=%u\n"
+			  "acl_cache_hit_ratio=%u%%\n"
+			  "acl_queries_pending=%u\n"
+			  "acl_queries_sent=%u\n"
+			  "acl_queries_coalesced=%u\n"
+			  "acl_queries_expired=%u\n"
+			  "acl_responses_accept=%u\n"
+			  "acl_responses_reject=%u\n"
+			  "acl_latency_last=%u\n"
+			  "acl_latency_avg=%u\n"
+			  "acl_latency_max=%u\n",
+			  cache->num_entries, cache->hits,
+			  cache->negative_hits, cache->misses,
+			  lookups ? (unsigned int) (hits * 100 / lookups) : 0,
+			  cache->num_queries, cache->queries_sent,
+			  cache->queries_coalesced, cache->queries_expired,
+			  cache->accepts, cache->rejects, cache->latency_last,
+			  responses ?
+			  (unsigned int) (cache->latency_total / responses) : 0,
+			  cache->latency_max);
+	if (os_snprintf_error(buflen, ret))
+		return 0;
+	return ret;
 }
 
 
@@ -649,3 +825,38 @@ void hostapd_free_psk_list(struct hostapd_sta_wpa_psk_short *psk)
 		os_free(prev);
 	}
 }
+
+
+void hostapd_disassoc_accept_mac(struct hostapd_data *hapd)
+{
+	struct sta_info *sta;
+	struct vlan_description vlan_id;
+
+	if (hapd->conf->macaddr_acl != DENY_UNLESS_ACCEPTED)
+		return;
+
+	for (sta = hapd->sta_list; sta; sta = sta->next) {
+		if (!hostapd_maclist_found(&hapd->conf->accept_mac, sta->addr,
+					   &vlan_id) ||
+		    (vlan_id.notempty &&
+		     vlan_compare(&vlan_id, sta->vlan_desc)))
+			ap_sta_disconnect(hapd, sta, sta->addr,
+					  WLAN_REASON_UNSPECIFIED);
+	}
+}
+
+
+void hostapd_disassoc_deny_mac(struct hostapd_data *hapd)
+{
+	struct sta_info *sta;
+	struct vlan_description vlan_id;
+
+	for (sta = hapd->sta_list; sta; sta = sta->next) {
+		if (hostapd_maclist_found(&hapd->conf->deny_mac, sta->addr,
+					  &vlan_id) &&
+		    (!vlan_id.notempty ||
+		     !vlan_compare(&vlan_id, sta->vlan_desc)))
+			ap_sta_disconnect(hapd, sta, sta->addr,
+					  WLAN_REASON_UNSPECIFIED);
+	}
+}
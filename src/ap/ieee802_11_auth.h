@@ -34,7 +34,10 @@ int hostapd_acl_init(struct hostapd_data *hapd);
 void hostapd_acl_deinit(struct hostapd_data *hapd);
 void hostapd_free_psk_list(struct hostapd_sta_wpa_psk_short *psk);
 void hostapd_acl_expire(struct hostapd_data *hapd);
+int hostapd_acl_get_mib(struct hostapd_data *hapd, char *buf, size_t buflen);
 void hostapd_copy_psk_list(struct hostapd_sta_wpa_psk_short **psk,
 			   struct hostapd_sta_wpa_psk_short *src);
+void hostapd_disassoc_accept_mac(struct hostapd_data *hapd);
+void hostapd_disassoc_deny_mac(struct hostapd_data *hapd);
 
 #endif /* IEEE802_11_AUTH_H */
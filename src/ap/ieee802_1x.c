@@ -716,12 +716,12 @@ void ieee802_1x_encapsulate_radius(struct hostapd_data *hapd,
 	if (sta && add_sqlite_radius_attr(hapd, sta, msg, 0) < 0)
 		goto fail;
 
-	/* TODO: should probably check MTU from driver config; 2304 is max for
-	 * IEEE 802.11, but use 1400 to avoid problems with too large packets
-	 */
+	/* 2304 is max for IEEE 802.11, but use 1400 by default to avoid
+	 * problems with too large packets */
 	if (!hostapd_config_get_radius_attr(hapd->conf->radius_auth_req_attr,
 					    RADIUS_ATTR_FRAMED_MTU) &&
-	    !radius_msg_add_attr_int32(msg, RADIUS_ATTR_FRAMED_MTU, 1400)) {
+	    !radius_msg_add_attr_int32(msg, RADIUS_ATTR_FRAMED_MTU,
+				       hapd->conf->radius_framed_mtu)) {
 		wpa_printf(MSG_INFO, "Could not add Framed-MTU");
 		goto fail;
 	}
@@ -2448,6 +2448,8 @@ int ieee802_1x_init(struct hostapd_data *hapd)
 	conf.eap_req_id_text_len = hapd->conf->eap_req_id_text_len;
 	conf.erp_send_reauth_start = hapd->conf->erp_send_reauth_start;
 	conf.erp_domain = hapd->conf->erp_domain;
+	conf.sta_pool_prealloc = hapd->conf->sta_pool_prealloc;
+	conf.sta_pool_max = hapd->conf->sta_pool_max;
 
 	os_memset(&cb, 0, sizeof(cb));
 	cb.eapol_send = ieee802_1x_eapol_send;
@@ -0,0 +1,268 @@
+/*
+ * hostapd / MAC address access control lists
+ * Copyright (c) 2026, Infineon Technologies AG
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "ap_config.h"
+
+
+/*
+ * The ACL entries are stored in a dense array (in no particular order) that
+ * can be passed as-is to the driver. An open addressing hash table with
+ * linear probing maps MAC addresses to array positions. Each table slot holds
+ * the entry position + 1, zero for an empty slot, or MAC_ACL_DELETED for a
+ * slot whose entry was removed. Removal moves the last array entry into the
+ * freed position, so both additions and removals are O(1).
+ */
+
+#define MAC_ACL_DELETED ((u32) -1)
+#define MAC_ACL_MIN_TABLE 16
+
+
+static u32 mac_acl_hash(const u8 *addr)
+{
+	u64 val;
+
+	val = ((u64) WPA_GET_BE16(addr) << 32) | WPA_GET_BE32(addr + 2);
+	val *= 0x9e3779b97f4a7c15ULL;
+	return val >> 32;
+}
+
+
+/* Returns the slot containing addr or the empty slot that ends the probe */
+static unsigned int mac_acl_slot(const struct hostapd_mac_acl *acl,
+				 const u8 *addr)
+{
+	unsigned int mask = acl->table_size - 1;
+	unsigned int i = mac_acl_hash(addr) & mask;
+	u32 val;
+
+	for (;;) {
+		val = acl->table[i];
+		if (val == 0)
+			return i;
+		if (val != MAC_ACL_DELETED &&
+		    os_memcmp(acl->entries[val - 1].addr, addr, ETH_ALEN) == 0)
+			return i;
+		i = (i + 1) & mask;
+	}
+}
+
+
+static int mac_acl_rehash(struct hostapd_mac_acl *acl, unsigned int size)
+{
+	u32 *table;
+	unsigned int mask = size - 1, i, pos;
+
+	table = os_calloc(size, sizeof(*table));
+	if (!table)
+		return -1;
+
+	for (i = 0; i < (unsigned int) acl->num; i++) {
+		pos = mac_acl_hash(acl->entries[i].addr) & mask;
+		while (table[pos])
+			pos = (pos + 1) & mask;
+		table[pos] = i + 1;
+	}
+
+	os_free(acl->table);
+	acl->table = table;
+	acl->table_size = size;
+	acl->table_used = acl->num;
+	return 0;
+}
+
+
+/**
+ * hostapd_mac_acl_reserve - Reserve space for ACL entries
+ * @acl: MAC ACL
+ * @num: Total number of entries expected
+ * Returns: 0 on success or -1 on failure
+ */
+int hostapd_mac_acl_reserve(struct hostapd_mac_acl *acl, unsigned int num)
+{
+	struct mac_acl_entry *entries;
+	unsigned int size;
+
+	if (num > acl->entries_size) {
+		entries = os_realloc_array(acl->entries, num,
+					   sizeof(*entries));
+		if (!entries)
+			return -1;
+		acl->entries = entries;
+		acl->entries_size = num;
+	}
+
+	/* Keep the table at most 3/4 full, including deleted slots */
+	size = acl->table_size ? acl->table_size : MAC_ACL_MIN_TABLE;
+	while (size / 4 * 3 <= num)
+		size *= 2;
+	if (size > acl->table_size ||
+	    acl->table_used >= acl->table_size / 4 * 3)
+		return mac_acl_rehash(acl, size);
+
+	return 0;
+}
+
+
+/**
+ * hostapd_mac_acl_add - Add a MAC address to an ACL
+ * @acl: MAC ACL
+ * @addr: MAC address
+ * @vlan_id: VLAN ID to assign to the station or 0 for none
+ * Returns: 0 if the address was added, 1 if it was already in the list (the
+ * existing entry is not modified), or -1 on failure
+ */
+int hostapd_mac_acl_add(struct hostapd_mac_acl *acl, const u8 *addr,
+			int vlan_id)
+{
+	struct mac_acl_entry *entry;
+	unsigned int slot, num;
+
+	if (acl->table && acl->table[mac_acl_slot(acl, addr)])
+		return 1;
+
+	num = acl->num + 1;
+	if (num > acl->entries_size &&
+	    hostapd_mac_acl_reserve(acl, num > 8 ? num * 2 : 16) < 0) {
+		wpa_printf(MSG_ERROR, "MAC list reallocation failed");
+		return -1;
+	}
+	if ((acl->table_used + 1 >= acl->table_size / 4 * 3 ||
+	     !acl->table) &&
+	    hostapd_mac_acl_reserve(acl, num) < 0) {
+		wpa_printf(MSG_ERROR, "MAC list reallocation failed");
+		return -1;
+	}
+
+	entry = &acl->entries[acl->num];
+	os_memcpy(entry->addr, addr, ETH_ALEN);
+	os_memset(&entry->vlan_id, 0, sizeof(entry->vlan_id));
+	entry->vlan_id.untagged = vlan_id;
+	entry->vlan_id.notempty = !!vlan_id;
+
+	slot = mac_acl_slot(acl, addr);
+	acl->table[slot] = num;
+	acl->table_used++;
+	acl->num = num;
+
+	return 0;
+}
+
+
+/**
+ * hostapd_mac_acl_del - Remove a MAC address from an ACL
+ * @acl: MAC ACL
+ * @addr: MAC address
+ * Returns: 0 if the address was removed or -1 if it was not in the list
+ */
+int hostapd_mac_acl_del(struct hostapd_mac_acl *acl, const u8 *addr)
+{
+	unsigned int slot, pos, last;
+
+	if (!acl->table)
+		return -1;
+
+	slot = mac_acl_slot(acl, addr);
+	if (!acl->table[slot])
+		return -1;
+
+	pos = acl->table[slot] - 1;
+	acl->table[slot] = MAC_ACL_DELETED;
+	last = acl->num - 1;
+	if (pos != last) {
+		acl->entries[pos] = acl->entries[last];
+		acl->table[mac_acl_slot(acl, acl->entries[pos].addr)] =
+			pos + 1;
+	}
+	acl->num--;
+
+	return 0;
+}
+
+
+/**
+ * hostapd_mac_acl_get - Find a MAC address from an ACL
+ * @acl: MAC ACL
+ * @addr: MAC address
+ * Returns: Pointer to the ACL entry or %NULL if the address is not in the list
+ */
+const struct mac_acl_entry *
+hostapd_mac_acl_get(const struct hostapd_mac_acl *acl, const u8 *addr)
+{
+	u32 val;
+
+	if (!acl->num)
+		return NULL;
+
+	val = acl->table[mac_acl_slot(acl, addr)];
+	if (!val)
+		return NULL;
+	return &acl->entries[val - 1];
+}
+
+
+/**
+ * hostapd_mac_acl_clear - Remove all entries from an ACL
+ * @acl: MAC ACL
+ */
+void hostapd_mac_acl_clear(struct hostapd_mac_acl *acl)
+{
+	os_free(acl->entries);
+	os_free(acl->table);
+	os_memset(acl, 0, sizeof(*acl));
+}
+
+
+/**
+ * hostapd_mac_acl_equal - Compare two ACLs
+ * @a: MAC ACL
+ * @b: MAC ACL
+ * Returns: 1 if the ACLs contain the same addresses and VLAN IDs, 0 if not
+ */
+int hostapd_mac_acl_equal(const struct hostapd_mac_acl *a,
+			  const struct hostapd_mac_acl *b)
+{
+	const struct mac_acl_entry *entry;
+	int i;
+
+	if (a->num != b->num)
+		return 0;
+
+	for (i = 0; i < a->num; i++) {
+		entry = hostapd_mac_acl_get(b, a->entries[i].addr);
+		if (!entry ||
+		    os_memcmp(&entry->vlan_id, &a->entries[i].vlan_id,
+			      sizeof(entry->vlan_id)) != 0)
+			return 0;
+	}
+
+	return 1;
+}
+
+
+/**
+ * hostapd_maclist_found - Find a MAC address from an ACL
+ * @acl: MAC ACL
+ * @addr: Address to search for
+ * @vlan_id: Buffer for returning VLAN ID or %NULL if not needed
+ * Returns: 1 if address is in the list or 0 if not.
+ */
+int hostapd_maclist_found(const struct hostapd_mac_acl *acl, const u8 *addr,
+			  struct vlan_description *vlan_id)
+{
+	const struct mac_acl_entry *entry;
+
+	entry = hostapd_mac_acl_get(acl, addr);
+	if (!entry)
+		return 0;
+	if (vlan_id)
+		*vlan_id = entry->vlan_id;
+	return 1;
+}
@@ -10,6 +10,7 @@
 
 #include "utils/common.h"
 #include "utils/eloop.h"
+#include "utils/objpool.h"
 #include "common/ieee802_11_defs.h"
 #include "common/wpa_ctrl.h"
 #include "common/sae.h"
@@ -32,7 +33,6 @@
 #include "vlan_init.h"
 #include "p2p_hostapd.h"
 #include "ap_drv_ops.h"
-#include "gas_serv.h"
 #include "wnm_ap.h"
 #include "mbo_ap.h"
 #include "ndisc_snoop.h"
@@ -336,15 +336,6 @@ void ap_free_sta(struct hostapd_data *hapd, struct sta_info *sta)
 	p2p_group_notif_disassoc(hapd->p2p_group, sta->addr);
 #endif /* CONFIG_P2P */
 
-#ifdef CONFIG_INTERWORKING
-	if (sta->gas_dialog) {
-		int i;
-		for (i = 0; i < GAS_DIALOG_MAX; i++)
-			gas_serv_dialog_clear(&sta->gas_dialog[i]);
-		os_free(sta->gas_dialog);
-	}
-#endif /* CONFIG_INTERWORKING */
-
 	wpabuf_free(sta->wps_ie);
 	wpabuf_free(sta->p2p_ie);
 	wpabuf_free(sta->hs20_ie);
@@ -412,7 +403,7 @@ void ap_free_sta(struct hostapd_data *hapd, struct sta_info *sta)
 	os_free(sta->sae_postponed_commit);
 #endif /* CONFIG_TESTING_OPTIONS */
 
-	os_free(sta);
+	objpool_free(hapd->sta_pool, sta);
 }
 
 
@@ -627,14 +618,8 @@ static void ap_handle_session_timer(void *eloop_ctx, void *timeout_ctx)
 	wpa_printf(MSG_DEBUG, "%s: Session timer for STA " MACSTR,
 		   hapd->conf->iface, MAC2STR(sta->addr));
 	if (!(sta->flags & (WLAN_STA_AUTH | WLAN_STA_ASSOC |
-			    WLAN_STA_AUTHORIZED))) {
-		if (sta->flags & WLAN_STA_GAS) {
-			wpa_printf(MSG_DEBUG, "GAS: Remove temporary STA "
-				   "entry " MACSTR, MAC2STR(sta->addr));
-			ap_free_sta(hapd, sta);
-		}
+			    WLAN_STA_AUTHORIZED)))
 		return;
-	}
 
 	hostapd_drv_sta_deauth(hapd, sta->addr,
 			       WLAN_REASON_PREV_AUTH_NOT_VALID);
@@ -722,14 +707,20 @@ struct sta_info * ap_sta_add(struct hostapd_data *hapd, const u8 *addr)
 		return NULL;
 	}
 
-	sta = os_zalloc(sizeof(struct sta_info));
+	if (!hapd->sta_pool || !objpool_available(hapd->sta_pool)) {
+		wpa_printf(MSG_DEBUG,
+			   "no more room for new STAs (station pool exhausted)");
+		return NULL;
+	}
+
+	sta = objpool_alloc(hapd->sta_pool);
 	if (sta == NULL) {
 		wpa_printf(MSG_ERROR, "malloc failed");
 		return NULL;
 	}
 	sta->acct_interim_interval = hapd->conf->acct_interim_interval;
 	if (accounting_sta_get_id(hapd, sta) < 0) {
-		os_free(sta);
+		objpool_free(hapd->sta_pool, sta);
 		return NULL;
 	}
 
@@ -1461,7 +1452,7 @@ int ap_sta_flags_txt(u32 flags, char *buf, size_t buflen)
 
 	buf[0] = '\0';
 	res = os_snprintf(buf, buflen,
-			  "%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s",
+			  "%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s",
 			  (flags & WLAN_STA_AUTH ? "[AUTH]" : ""),
 			  (flags & WLAN_STA_ASSOC ? "[ASSOC]" : ""),
 			  (flags & WLAN_STA_AUTHORIZED ? "[AUTHORIZED]" : ""),
@@ -1477,7 +1468,6 @@ int ap_sta_flags_txt(u32 flags, char *buf, size_t buflen)
 			  (flags & WLAN_STA_WDS ? "[WDS]" : ""),
 			  (flags & WLAN_STA_NONERP ? "[NonERP]" : ""),
 			  (flags & WLAN_STA_WPS2 ? "[WPS2]" : ""),
-			  (flags & WLAN_STA_GAS ? "[GAS]" : ""),
 			  (flags & WLAN_STA_HT ? "[HT]" : ""),
 			  (flags & WLAN_STA_VHT ? "[VHT]" : ""),
 			  (flags & WLAN_STA_HE ? "[HE]" : ""),
@@ -12,6 +12,7 @@
 #include "utils/eloop.h"
 #include "utils/state_machine.h"
 #include "utils/bitfield.h"
+#include "utils/objpool.h"
 #include "common/ieee802_11_defs.h"
 #include "common/ocv.h"
 #include "common/dpp.h"
@@ -564,6 +565,15 @@ struct wpa_authenticator * wpa_init(const u8 *addr,
 	}
 #endif /* CONFIG_P2P */
 
+	wpa_auth->sm_pool = objpool_init("wpa_sm",
+					 sizeof(struct wpa_state_machine),
+					 conf->sta_pool_prealloc,
+					 conf->sta_pool_max);
+	if (!wpa_auth->sm_pool) {
+		wpa_deinit(wpa_auth);
+		return NULL;
+	}
+
 	return wpa_auth;
 }
 
@@ -616,6 +626,7 @@ void wpa_deinit(struct wpa_authenticator *wpa_auth)
 		os_free(prev);
 	}
 
+	objpool_deinit(wpa_auth->sm_pool);
 	os_free(wpa_auth);
 }
 
@@ -654,6 +665,22 @@ int wpa_reconfig(struct wpa_authenticator *wpa_auth,
 }
 
 
+/**
+ * wpa_auth_update_conf - Update configuration without rekeying
+ * @wpa_auth: Pointer to WPA authenticator data from wpa_init()
+ * @conf: Configuration for WPA authenticator
+ *
+ * This can be used when the configuration data was reallocated, but the
+ * parameters affecting the WPA/RSN IE and the group keys did not change.
+ */
+void wpa_auth_update_conf(struct wpa_authenticator *wpa_auth,
+			  struct wpa_auth_config *conf)
+{
+	if (wpa_auth)
+		os_memcpy(&wpa_auth->conf, conf, sizeof(*conf));
+}
+
+
 struct wpa_state_machine *
 wpa_auth_sta_init(struct wpa_authenticator *wpa_auth, const u8 *addr,
 		  const u8 *p2p_dev_addr)
@@ -663,7 +690,7 @@ wpa_auth_sta_init(struct wpa_authenticator *wpa_auth, const u8 *addr,
 	if (wpa_auth->group->wpa_group_state == WPA_GROUP_FATAL_FAILURE)
 		return NULL;
 
-	sm = os_zalloc(sizeof(struct wpa_state_machine));
+	sm = objpool_alloc(wpa_auth->sm_pool);
 	if (!sm)
 		return NULL;
 	os_memcpy(sm->addr, addr, ETH_ALEN);
@@ -784,7 +811,7 @@ static void wpa_free_sta_sm(struct wpa_state_machine *sm)
 #ifdef CONFIG_DPP2
 	wpabuf_clear_free(sm->dpp_z);
 #endif /* CONFIG_DPP2 */
-	bin_clear_free(sm, sizeof(*sm));
+	objpool_free(sm->wpa_auth->sm_pool, sm);
 }
 
 
@@ -4641,6 +4668,15 @@ int wpa_get_mib(struct wpa_authenticator *wpa_auth, char *buf, size_t buflen)
 }
 
 
+int wpa_get_pool_mib(struct wpa_authenticator *wpa_auth, char *buf,
+		     size_t buflen)
+{
+	if (!wpa_auth)
+		return 0;
+	return objpool_get_mib(wpa_auth->sm_pool, buf, buflen);
+}
+
+
 int wpa_get_mib_sta(struct wpa_state_machine *sm, char *buf, size_t buflen)
 {
 	int len = 0, ret;
@@ -278,6 +278,9 @@ struct wpa_auth_config {
 #ifdef CONFIG_SAE
 	int sae_offload;
 #endif /* CONFIG_SAE */
+
+	unsigned int sta_pool_prealloc;
+	unsigned int sta_pool_max;
 };
 
 typedef enum {
@@ -358,6 +361,8 @@ struct wpa_authenticator * wpa_init(const u8 *addr,
 				    void *cb_ctx);
 int wpa_init_keys(struct wpa_authenticator *wpa_auth);
 void wpa_deinit(struct wpa_authenticator *wpa_auth);
+void wpa_auth_update_conf(struct wpa_authenticator *wpa_auth,
+			  struct wpa_auth_config *conf);
 int wpa_reconfig(struct wpa_authenticator *wpa_auth,
 		 struct wpa_auth_config *conf);
 
@@ -401,6 +406,8 @@ int wpa_auth_sm_event(struct wpa_state_machine *sm, enum wpa_event event);
 void wpa_auth_sm_notify(struct wpa_state_machine *sm);
 void wpa_gtk_rekey(struct wpa_authenticator *wpa_auth);
 int wpa_get_mib(struct wpa_authenticator *wpa_auth, char *buf, size_t buflen);
+int wpa_get_pool_mib(struct wpa_authenticator *wpa_auth, char *buf,
+		     size_t buflen);
 int wpa_get_mib_sta(struct wpa_state_machine *sm, char *buf, size_t buflen);
 void wpa_auth_countermeasures_start(struct wpa_authenticator *wpa_auth);
 int wpa_auth_pairwise_set(struct wpa_state_machine *sm);
@@ -57,6 +57,8 @@ static void hostapd_wpa_auth_conf(struct hostapd_bss_config *conf,
 	wconf->rsn_pairwise = conf->rsn_pairwise;
 	wconf->rsn_preauth = conf->rsn_preauth;
 	wconf->eapol_version = conf->eapol_version;
+	wconf->sta_pool_prealloc = conf->sta_pool_prealloc;
+	wconf->sta_pool_max = conf->sta_pool_max;
 #ifdef CONFIG_MACSEC
 	if (wconf->eapol_version > 2)
 		wconf->eapol_version = 2;
@@ -1608,6 +1610,14 @@ void hostapd_reconfig_wpa(struct hostapd_data *hapd)
 }
 
 
+void hostapd_update_wpa_conf(struct hostapd_data *hapd)
+{
+	struct wpa_auth_config wpa_auth_conf;
+	hostapd_wpa_auth_conf(hapd->conf, hapd->iconf, &wpa_auth_conf);
+	wpa_auth_update_conf(hapd->wpa_auth, &wpa_auth_conf);
+}
+
+
 void hostapd_deinit_wpa(struct hostapd_data *hapd)
 {
 	ieee80211_tkip_countermeasures_deinit(hapd);
@@ -238,6 +238,8 @@ struct wpa_authenticator {
 	struct bitfield *ip_pool;
 #endif /* CONFIG_P2P */
 	unsigned int pmk_life_time;
+
+	struct objpool *sm_pool; /* struct wpa_state_machine allocations */
 };
 
 
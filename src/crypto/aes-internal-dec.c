@@ -68,7 +68,7 @@ void * aes_decrypt_init(const u8 *key, size_t len)
 		os_free(rk);
 		return NULL;
 	}
-	rk[AES_PRIV_NR_POS] = res;
+	rk[AES_PRIV_NR_POS] = aes_accel_prepare(rk, res);
 	return rk;
 }
 
@@ -151,7 +151,14 @@ d##3 = TD0(s##3) ^ TD1(s##2) ^ TD2(s##1) ^ TD3(s##0) ^ rk[4 * i + 3]
 int aes_decrypt(void *ctx, const u8 *crypt, u8 *plain)
 {
 	u32 *rk = ctx;
-	rijndaelDecrypt(ctx, rk[AES_PRIV_NR_POS], crypt, plain);
+	int nr = rk[AES_PRIV_NR_POS];
+
+	if (nr & AES_PRIV_ACCEL) {
+		crypto_accel_aes_decrypt((const u8 *) rk, nr & AES_PRIV_NR_MASK,
+					 crypt, plain);
+		return 0;
+	}
+	rijndaelDecrypt(ctx, nr, crypt, plain);
 	return 0;
 }
 
@@ -111,7 +111,7 @@ void * aes_encrypt_init(const u8 *key, size_t len)
 		os_free(rk);
 		return NULL;
 	}
-	rk[AES_PRIV_NR_POS] = res;
+	rk[AES_PRIV_NR_POS] = aes_accel_prepare(rk, res);
 	return rk;
 }
 
@@ -119,7 +119,14 @@ void * aes_encrypt_init(const u8 *key, size_t len)
 int aes_encrypt(void *ctx, const u8 *plain, u8 *crypt)
 {
 	u32 *rk = ctx;
-	rijndaelEncrypt(ctx, rk[AES_PRIV_NR_POS], plain, crypt);
+	int nr = rk[AES_PRIV_NR_POS];
+
+	if (nr & AES_PRIV_ACCEL) {
+		crypto_accel_aes_encrypt((const u8 *) rk, nr & AES_PRIV_NR_MASK,
+					 plain, crypt);
+		return 0;
+	}
+	rijndaelEncrypt(ctx, nr, plain, crypt);
 	return 0;
 }
 
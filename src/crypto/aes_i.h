@@ -10,6 +10,7 @@
 #define AES_I_H
 
 #include "aes.h"
+#include "crypto_accel.h"
 
 /* #define FULL_UNROLL */
 #define AES_SMALL_TABLES
@@ -119,7 +120,38 @@ static inline u32 rotr(u32 val, int bits)
 
 #define AES_PRIV_SIZE (4 * 4 * 15 + 4)
 #define AES_PRIV_NR_POS (4 * 15)
+/* Flag in rk[AES_PRIV_NR_POS] for round keys converted to byte order for
+ * crypto_accel_aes_*() */
+#define AES_PRIV_ACCEL 0x100
+#define AES_PRIV_NR_MASK 0xff
 
 int rijndaelKeySetupEnc(u32 rk[], const u8 cipherKey[], int keyBits);
 
+#ifdef CONFIG_INTERNAL_CRYPTO_ACCEL
+/*
+ * Convert an expanded key schedule to the byte order used by the AES
+ * instructions if the CPU supports them. The same conversion works for both
+ * the encryption schedule and the equivalent inverse cipher schedule used for
+ * decryption. Returns the value to store in rk[AES_PRIV_NR_POS].
+ */
+static inline int aes_accel_prepare(u32 rk[], int Nr)
+{
+	int i;
+
+	if (!(crypto_accel_get_caps() & CRYPTO_ACCEL_AES))
+		return Nr;
+	for (i = 0; i < 4 * (Nr + 1); i++) {
+		u32 v = rk[i];
+
+		PUTU32((u8 *) &rk[i], v);
+	}
+	return Nr | AES_PRIV_ACCEL;
+}
+#else /* CONFIG_INTERNAL_CRYPTO_ACCEL */
+static inline int aes_accel_prepare(u32 rk[], int Nr)
+{
+	return Nr;
+}
+#endif /* CONFIG_INTERNAL_CRYPTO_ACCEL */
+
 #endif /* AES_I_H */
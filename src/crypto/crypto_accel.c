@@ -0,0 +1,505 @@
+/*
+ * Hardware acceleration for internal crypto implementations
+ * Copyright (c) 2026, Infineon Technologies AG
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ *
+ * This provides AES block and SHA-1/SHA-256 compression functions using the
+ * x86 AES-NI and SHA extensions and the ARMv8 Cryptography Extensions. The
+ * internal implementations (aes-internal*.c, sha1-internal.c and
+ * sha256-internal.c) call these when the running CPU supports the
+ * instructions and fall back to the portable C code otherwise, so the same
+ * binary works on all CPUs of the architecture.
+ *
+ * On x86, the instructions are enabled per function with target attributes.
+ * On ARMv8, the code is included only when the compiler targets the
+ * Cryptography Extensions (e.g., -march=armv8-a+crypto) and the availability
+ * is checked from the Linux hwcaps at runtime.
+ */
+
+#include "includes.h"
+
+#include "common.h"
+#include "crypto_accel.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+	(defined(__GNUC__) || defined(__clang__))
+#define CRYPTO_ACCEL_X86
+#include <cpuid.h>
+#include <immintrin.h>
+#endif /* x86 */
+
+#if defined(__aarch64__) && \
+	(defined(__ARM_FEATURE_CRYPTO) || \
+	 (defined(__ARM_FEATURE_AES) && defined(__ARM_FEATURE_SHA2))) && \
+	defined(__linux__)
+#define CRYPTO_ACCEL_ARM
+#include <arm_neon.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif /* ARMv8 */
+
+
+static int caps_detected = 0;
+static unsigned int caps_hw = 0;
+static unsigned int caps_disabled = 0;
+
+
+#if defined(CRYPTO_ACCEL_X86) || defined(CRYPTO_ACCEL_ARM)
+static const u32 sha256_k[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+	0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+	0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+	0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+	0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+	0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+	0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+	0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+	0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+#endif /* CRYPTO_ACCEL_X86 || CRYPTO_ACCEL_ARM */
+
+
+#ifdef CRYPTO_ACCEL_X86
+
+static unsigned int crypto_accel_detect(void)
+{
+	unsigned int eax, ebx, ecx, edx;
+	unsigned int caps = 0;
+
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+		return 0;
+	/* AES-NI (ECX bit 25) */
+	if (ecx & BIT(25))
+		caps |= CRYPTO_ACCEL_AES;
+	/* SHA extensions (CPUID.7.0:EBX bit 29) with SSSE3 (ECX bit 9) and
+	 * SSE4.1 (ECX bit 19) for the byte shuffles and blends */
+	if ((ecx & BIT(9)) && (ecx & BIT(19)) &&
+	    __get_cpuid_max(0, NULL) >= 7) {
+		__cpuid_count(7, 0, eax, ebx, ecx, edx);
+		if (ebx & BIT(29))
+			caps |= CRYPTO_ACCEL_SHA1 | CRYPTO_ACCEL_SHA256;
+	}
+
+	return caps;
+}
+
+
+__attribute__((target("aes,sse2")))
+static void aes_encrypt_x86(const u8 *rk, int nr, const u8 *in, u8 *out)
+{
+	__m128i s;
+	int i;
+
+	s = _mm_loadu_si128((const __m128i *) in);
+	s = _mm_xor_si128(s, _mm_loadu_si128((const __m128i *) rk));
+	for (i = 1; i < nr; i++)
+		s = _mm_aesenc_si128(s, _mm_loadu_si128((const __m128i *)
+							(rk + 16 * i)));
+	s = _mm_aesenclast_si128(s, _mm_loadu_si128((const __m128i *)
+						    (rk + 16 * nr)));
+	_mm_storeu_si128((__m128i *) out, s);
+}
+
+
+__attribute__((target("aes,sse2")))
+static void aes_decrypt_x86(const u8 *rk, int nr, const u8 *in, u8 *out)
+{
+	__m128i s;
+	int i;
+
+	s = _mm_loadu_si128((const __m128i *) in);
+	s = _mm_xor_si128(s, _mm_loadu_si128((const __m128i *) rk));
+	for (i = 1; i < nr; i++)
+		s = _mm_aesdec_si128(s, _mm_loadu_si128((const __m128i *)
+							(rk + 16 * i)));
+	s = _mm_aesdeclast_si128(s, _mm_loadu_si128((const __m128i *)
+						    (rk + 16 * nr)));
+	_mm_storeu_si128((__m128i *) out, s);
+}
+
+
+#define SHA1_X86_ROUNDS(func)						\
+	for (j = 0; j < 5; j++, g++) {					\
+		if (g >= 4)						\
+			w[g & 3] = _mm_sha1msg2_epu32(			\
+				_mm_xor_si128(				\
+					_mm_sha1msg1_epu32(w[g & 3],	\
+							   w[(g + 1) & 3]), \
+					w[(g + 2) & 3]),		\
+				w[(g + 3) & 3]);			\
+		if (g == 0)						\
+			e = _mm_add_epi32(e_save, w[0]);		\
+		else							\
+			e = _mm_sha1nexte_epu32(prev, w[g & 3]);	\
+		prev = abcd;						\
+		abcd = _mm_sha1rnds4_epu32(abcd, e, func);		\
+	}
+
+__attribute__((target("sha,sse4.1,ssse3")))
+static void sha1_block_x86(u32 state[5], const u8 *data)
+{
+	const __m128i mask = _mm_set_epi64x(0x0001020304050607ULL,
+					    0x08090a0b0c0d0e0fULL);
+	__m128i abcd, abcd_save, e, e_save, prev, w[4];
+	int g = 0, j;
+
+	abcd = _mm_loadu_si128((const __m128i *) state);
+	abcd = _mm_shuffle_epi32(abcd, 0x1b);
+	e_save = _mm_set_epi32(state[4], 0, 0, 0);
+	abcd_save = abcd;
+
+	for (j = 0; j < 4; j++)
+		w[j] = _mm_shuffle_epi8(
+			_mm_loadu_si128((const __m128i *) (data + 16 * j)),
+			mask);
+
+	prev = abcd;
+	SHA1_X86_ROUNDS(0);
+	SHA1_X86_ROUNDS(1);
+	SHA1_X86_ROUNDS(2);
+	SHA1_X86_ROUNDS(3);
+
+	e = _mm_sha1nexte_epu32(prev, e_save);
+	abcd = _mm_add_epi32(abcd, abcd_save);
+
+	abcd = _mm_shuffle_epi32(abcd, 0x1b);
+	_mm_storeu_si128((__m128i *) state, abcd);
+	state[4] = _mm_extract_epi32(e, 3);
+}
+
+
+__attribute__((target("sha,sse4.1,ssse3")))
+static void sha256_block_x86(u32 state[8], const u8 *data)
+{
+	const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL,
+					    0x0405060700010203ULL);
+	__m128i state0, state1, abef_save, cdgh_save, msg, tmp, w[4];
+	int g;
+
+	/* Reorder the state into the ABEF/CDGH layout */
+	tmp = _mm_loadu_si128((const __m128i *) &state[0]);
+	state1 = _mm_loadu_si128((const __m128i *) &state[4]);
+	tmp = _mm_shuffle_epi32(tmp, 0xb1);
+	state1 = _mm_shuffle_epi32(state1, 0x1b);
+	state0 = _mm_alignr_epi8(tmp, state1, 8);
+	state1 = _mm_blend_epi16(state1, tmp, 0xf0);
+	abef_save = state0;
+	cdgh_save = state1;
+
+	for (g = 0; g < 4; g++)
+		w[g] = _mm_shuffle_epi8(
+			_mm_loadu_si128((const __m128i *) (data + 16 * g)),
+			mask);
+
+	for (g = 0; g < 16; g++) {
+		if (g >= 4) {
+			tmp = _mm_add_epi32(
+				_mm_sha256msg1_epu32(w[g & 3], w[(g + 1) & 3]),
+				_mm_alignr_epi8(w[(g + 3) & 3], w[(g + 2) & 3],
+						4));
+			w[g & 3] = _mm_sha256msg2_epu32(tmp, w[(g + 3) & 3]);
+		}
+		msg = _mm_add_epi32(w[g & 3],
+				    _mm_loadu_si128((const __m128i *)
+						    &sha256_k[4 * g]));
+		state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+		msg = _mm_shuffle_epi32(msg, 0x0e);
+		state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+	}
+
+	state0 = _mm_add_epi32(state0, abef_save);
+	state1 = _mm_add_epi32(state1, cdgh_save);
+
+	tmp = _mm_shuffle_epi32(state0, 0x1b);
+	state1 = _mm_shuffle_epi32(state1, 0xb1);
+	state0 = _mm_blend_epi16(tmp, state1, 0xf0);
+	state1 = _mm_alignr_epi8(state1, tmp, 8);
+	_mm_storeu_si128((__m128i *) &state[0], state0);
+	_mm_storeu_si128((__m128i *) &state[4], state1);
+}
+
+#define aes_encrypt_hw aes_encrypt_x86
+#define aes_decrypt_hw aes_decrypt_x86
+#define sha1_block_hw sha1_block_x86
+#define sha256_block_hw sha256_block_x86
+#define CRYPTO_ACCEL_ARCH "x86"
+
+#endif /* CRYPTO_ACCEL_X86 */
+
+
+#ifdef CRYPTO_ACCEL_ARM
+
+static unsigned int crypto_accel_detect(void)
+{
+	unsigned long hwcap = getauxval(AT_HWCAP);
+	unsigned int caps = 0;
+
+	if (hwcap & HWCAP_AES)
+		caps |= CRYPTO_ACCEL_AES;
+	if (hwcap & HWCAP_SHA1)
+		caps |= CRYPTO_ACCEL_SHA1;
+	if (hwcap & HWCAP_SHA2)
+		caps |= CRYPTO_ACCEL_SHA256;
+
+	return caps;
+}
+
+
+static void aes_encrypt_arm(const u8 *rk, int nr, const u8 *in, u8 *out)
+{
+	uint8x16_t s;
+	int i;
+
+	s = vld1q_u8(in);
+	for (i = 0; i < nr - 1; i++)
+		s = vaesmcq_u8(vaeseq_u8(s, vld1q_u8(rk + 16 * i)));
+	s = vaeseq_u8(s, vld1q_u8(rk + 16 * (nr - 1)));
+	s = veorq_u8(s, vld1q_u8(rk + 16 * nr));
+	vst1q_u8(out, s);
+}
+
+
+static void aes_decrypt_arm(const u8 *rk, int nr, const u8 *in, u8 *out)
+{
+	uint8x16_t s;
+	int i;
+
+	s = vld1q_u8(in);
+	for (i = 0; i < nr - 1; i++)
+		s = vaesimcq_u8(vaesdq_u8(s, vld1q_u8(rk + 16 * i)));
+	s = vaesdq_u8(s, vld1q_u8(rk + 16 * (nr - 1)));
+	s = veorq_u8(s, vld1q_u8(rk + 16 * nr));
+	vst1q_u8(out, s);
+}
+
+
+#define SHA1_ARM_ROUNDS(op, k)						\
+	for (j = 0; j < 5; j++, g++) {					\
+		if (g >= 4)						\
+			w[g & 3] = vsha1su1q_u32(			\
+				vsha1su0q_u32(w[g & 3], w[(g + 1) & 3], \
+					      w[(g + 2) & 3]),		\
+				w[(g + 3) & 3]);			\
+		tmp = vaddq_u32(w[g & 3], vdupq_n_u32(k));		\
+		e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));		\
+		abcd = op(abcd, e0, tmp);				\
+		e0 = e1;						\
+	}
+
+static void sha1_block_arm(u32 state[5], const u8 *data)
+{
+	uint32x4_t abcd, abcd_save, tmp, w[4];
+	u32 e0, e1, e0_save;
+	int g = 0, j;
+
+	abcd = vld1q_u32(state);
+	e0 = state[4];
+	abcd_save = abcd;
+	e0_save = e0;
+
+	for (j = 0; j < 4; j++)
+		w[j] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data +
+								16 * j)));
+
+	SHA1_ARM_ROUNDS(vsha1cq_u32, 0x5a827999);
+	SHA1_ARM_ROUNDS(vsha1pq_u32, 0x6ed9eba1);
+	SHA1_ARM_ROUNDS(vsha1mq_u32, 0x8f1bbcdc);
+	SHA1_ARM_ROUNDS(vsha1pq_u32, 0xca62c1d6);
+
+	abcd = vaddq_u32(abcd, abcd_save);
+	vst1q_u32(state, abcd);
+	state[4] = e0 + e0_save;
+}
+
+
+static void sha256_block_arm(u32 state[8], const u8 *data)
+{
+	uint32x4_t state0, state1, abef_save, cdgh_save, msg, tmp, w[4];
+	int g;
+
+	state0 = vld1q_u32(&state[0]);
+	state1 = vld1q_u32(&state[4]);
+	abef_save = state0;
+	cdgh_save = state1;
+
+	for (g = 0; g < 4; g++)
+		w[g] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data +
+								16 * g)));
+
+	for (g = 0; g < 16; g++) {
+		if (g >= 4)
+			w[g & 3] = vsha256su1q_u32(
+				vsha256su0q_u32(w[g & 3], w[(g + 1) & 3]),
+				w[(g + 2) & 3], w[(g + 3) & 3]);
+		msg = vaddq_u32(w[g & 3], vld1q_u32(&sha256_k[4 * g]));
+		tmp = state0;
+		state0 = vsha256hq_u32(state0, state1, msg);
+		state1 = vsha256h2q_u32(state1, tmp, msg);
+	}
+
+	vst1q_u32(&state[0], vaddq_u32(state0, abef_save));
+	vst1q_u32(&state[4], vaddq_u32(state1, cdgh_save));
+}
+
+#define aes_encrypt_hw aes_encrypt_arm
+#define aes_decrypt_hw aes_decrypt_arm
+#define sha1_block_hw sha1_block_arm
+#define sha256_block_hw sha256_block_arm
+#define CRYPTO_ACCEL_ARCH "armv8-ce"
+
+#endif /* CRYPTO_ACCEL_ARM */
+
+
+#if !defined(CRYPTO_ACCEL_X86) && !defined(CRYPTO_ACCEL_ARM)
+
+static unsigned int crypto_accel_detect(void)
+{
+	return 0;
+}
+
+static void aes_encrypt_hw(const u8 *rk, int nr, const u8 *in, u8 *out)
+{
+}
+
+static void aes_decrypt_hw(const u8 *rk, int nr, const u8 *in, u8 *out)
+{
+}
+
+static void sha1_block_hw(u32 state[5], const u8 *data)
+{
+}
+
+static void sha256_block_hw(u32 state[8], const u8 *data)
+{
+}
+
+#define CRYPTO_ACCEL_ARCH "none"
+
+#endif /* !CRYPTO_ACCEL_X86 && !CRYPTO_ACCEL_ARM */
+
+
+/**
+ * crypto_accel_get_caps - Get the usable hardware acceleration capabilities
+ * Returns: Bitfield of CRYPTO_ACCEL_* flags
+ */
+unsigned int crypto_accel_get_caps(void)
+{
+	if (!caps_detected) {
+		caps_hw = crypto_accel_detect();
+		caps_detected = 1;
+		wpa_printf(MSG_DEBUG,
+			   "crypto: Hardware acceleration (%s):%s%s%s",
+			   CRYPTO_ACCEL_ARCH,
+			   (caps_hw & CRYPTO_ACCEL_AES) ? " AES" : "",
+			   (caps_hw & CRYPTO_ACCEL_SHA1) ? " SHA-1" : "",
+			   (caps_hw & CRYPTO_ACCEL_SHA256) ? " SHA-256" : "");
+	}
+
+	return caps_hw & ~caps_disabled;
+}
+
+
+/**
+ * crypto_accel_set_mask - Disable hardware acceleration
+ * @disabled: Bitfield of CRYPTO_ACCEL_* flags to disable
+ *
+ * This can be used for testing the portable implementations on hardware that
+ * supports the accelerated ones. AES keys that have already been set up
+ * continue to use the implementation they were set up with.
+ */
+void crypto_accel_set_mask(unsigned int disabled)
+{
+	caps_disabled = disabled;
+}
+
+
+/**
+ * crypto_accel_get_info - Get hardware acceleration status in text format
+ * @buf: Buffer for the text
+ * @buflen: Length of the buffer
+ * Returns: Number of octets written to buf
+ */
+int crypto_accel_get_info(char *buf, size_t buflen)
+{
+	unsigned int caps = crypto_accel_get_caps();
+	int ret;
+
+	ret = os_snprintf(buf, buflen,
+			  "crypto_accel_arch=%s\n"
+			  "crypto_accel_aes=%d\n"
+			  "crypto_accel_sha1=%d\n"
+			  "crypto_accel_sha256=%d\n",
+			  CRYPTO_ACCEL_ARCH,
+			  !!(caps & CRYPTO_ACCEL_AES),
+			  !!(caps & CRYPTO_ACCEL_SHA1),
+			  !!(caps & CRYPTO_ACCEL_SHA256));
+	if (os_snprintf_error(buflen, ret))
+		return 0;
+	return ret;
+}
+
+
+/**
+ * crypto_accel_aes_encrypt - Encrypt one AES block
+ * @rk: Round keys (Nr + 1 16-octet keys in byte order)
+ * @nr: Number of rounds
+ * @in: Plaintext block
+ * @out: Buffer for the ciphertext block
+ *
+ * This must be called only if crypto_accel_get_caps() has reported
+ * CRYPTO_ACCEL_AES.
+ */
+void crypto_accel_aes_encrypt(const u8 *rk, int nr, const u8 *in, u8 *out)
+{
+	aes_encrypt_hw(rk, nr, in, out);
+}
+
+
+/**
+ * crypto_accel_aes_decrypt - Decrypt one AES block
+ * @rk: Round keys of the equivalent inverse cipher in byte order
+ * @nr: Number of rounds
+ * @in: Ciphertext block
+ * @out: Buffer for the plaintext block
+ *
+ * This must be called only if crypto_accel_get_caps() has reported
+ * CRYPTO_ACCEL_AES.
+ */
+void crypto_accel_aes_decrypt(const u8 *rk, int nr, const u8 *in, u8 *out)
+{
+	aes_decrypt_hw(rk, nr, in, out);
+}
+
+
+/**
+ * crypto_accel_sha1_block - Process one SHA-1 block
+ * @state: SHA-1 state
+ * @data: 64-octet block
+ * Returns: 0 if the block was processed, -1 if acceleration is not available
+ */
+int crypto_accel_sha1_block(u32 state[5], const u8 *data)
+{
+	if (!(crypto_accel_get_caps() & CRYPTO_ACCEL_SHA1))
+		return -1;
+	sha1_block_hw(state, data);
+	return 0;
+}
+
+
+/**
+ * crypto_accel_sha256_block - Process one SHA-256 block
+ * @state: SHA-256 state
+ * @data: 64-octet block
+ * Returns: 0 if the block was processed, -1 if acceleration is not available
+ */
+int crypto_accel_sha256_block(u32 state[8], const u8 *data)
+{
+	if (!(crypto_accel_get_caps() & CRYPTO_ACCEL_SHA256))
+		return -1;
+	sha256_block_hw(state, data);
+	return 0;
+}
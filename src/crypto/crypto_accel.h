@@ -0,0 +1,65 @@
+/*
+ * Hardware acceleration for internal crypto implementations
+ * Copyright (c) 2026, Infineon Technologies AG
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#ifndef CRYPTO_ACCEL_H
+#define CRYPTO_ACCEL_H
+
+#define CRYPTO_ACCEL_AES BIT(0)
+#define CRYPTO_ACCEL_SHA1 BIT(1)
+#define CRYPTO_ACCEL_SHA256 BIT(2)
+
+#ifdef CONFIG_INTERNAL_CRYPTO_ACCEL
+
+unsigned int crypto_accel_get_caps(void);
+void crypto_accel_set_mask(unsigned int disabled);
+int crypto_accel_get_info(char *buf, size_t buflen);
+
+void crypto_accel_aes_encrypt(const u8 *rk, int nr, const u8 *in, u8 *out);
+void crypto_accel_aes_decrypt(const u8 *rk, int nr, const u8 *in, u8 *out);
+int crypto_accel_sha1_block(u32 state[5], const u8 *data);
+int crypto_accel_sha256_block(u32 state[8], const u8 *data);
+
+#else /* CONFIG_INTERNAL_CRYPTO_ACCEL */
+
+static inline unsigned int crypto_accel_get_caps(void)
+{
+	return 0;
+}
+
+static inline void crypto_accel_set_mask(unsigned int disabled)
+{
+}
+
+static inline int crypto_accel_get_info(char *buf, size_t buflen)
+{
+	return 0;
+}
+
+static inline void crypto_accel_aes_encrypt(const u8 *rk, int nr,
+					    const u8 *in, u8 *out)
+{
+}
+
+static inline void crypto_accel_aes_decrypt(const u8 *rk, int nr,
+					    const u8 *in, u8 *out)
+{
+}
+
+static inline int crypto_accel_sha1_block(u32 state[5], const u8 *data)
+{
+	return -1;
+}
+
+static inline int crypto_accel_sha256_block(u32 state[8], const u8 *data)
+{
+	return -1;
+}
+
+#endif /* CONFIG_INTERNAL_CRYPTO_ACCEL */
+
+#endif /* CRYPTO_ACCEL_H */
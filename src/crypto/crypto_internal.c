@@ -9,6 +9,7 @@
 #include "includes.h"
 
 #include "common.h"
+#include "tls/bignum.h"
 #include "crypto.h"
 #include "sha256_i.h"
 #include "sha384_i.h"
@@ -325,4 +326,7 @@ int crypto_global_init(void)
 
 void crypto_global_deinit(void)
 {
+#ifdef CONFIG_INTERNAL_BIGNUM
+	bignum_global_deinit();
+#endif /* CONFIG_INTERNAL_BIGNUM */
 }
@@ -10,6 +10,7 @@
 #include <linux/if_alg.h>
 
 #include "common.h"
+#include "tls/bignum.h"
 #include "crypto.h"
 #include "md5.h"
 #include "sha1.h"
@@ -1006,4 +1007,7 @@ int crypto_global_init(void)
 
 void crypto_global_deinit(void)
 {
+#ifdef CONFIG_INTERNAL_BIGNUM
+	bignum_global_deinit();
+#endif /* CONFIG_INTERNAL_BIGNUM */
 }
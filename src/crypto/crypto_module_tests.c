@@ -15,6 +15,7 @@
 #include "crypto/aes.h"
 #include "crypto/ms_funcs.h"
 #include "crypto/crypto.h"
+#include "crypto/crypto_accel.h"
 #include "crypto/sha1.h"
 #include "crypto/sha256.h"
 #include "crypto/sha384.h"
@@ -2292,6 +2293,29 @@ static int test_ms_funcs(void)
 }
 
 
+static int test_crypto_accel(void)
+{
+	unsigned int caps = crypto_accel_get_caps();
+	int ret;
+
+	if (!caps) {
+		wpa_printf(MSG_INFO,
+			   "crypto_accel test cases skipped - no hardware acceleration");
+		return 0;
+	}
+
+	/* The test cases above used the accelerated implementations; repeat
+	 * the ones covering them with the portable implementations. */
+	wpa_printf(MSG_INFO, "crypto_accel: repeat tests without acceleration");
+	crypto_accel_set_mask(caps);
+	ret = test_omac1() || test_cbc() || test_ecb() || test_key_wrap() ||
+		test_sha1() || test_sha256() ? -1 : 0;
+	crypto_accel_set_mask(0);
+
+	return ret;
+}
+
+
 int crypto_module_tests(void)
 {
 	int ret = 0;
@@ -2310,7 +2334,8 @@ int crypto_module_tests(void)
 	    test_sha384() ||
 	    test_fips186_2_prf() ||
 	    test_extract_expand_hkdf() ||
-	    test_ms_funcs())
+	    test_ms_funcs() ||
+	    test_crypto_accel())
 		ret = -1;
 
 	return ret;
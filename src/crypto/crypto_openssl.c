@@ -1683,7 +1683,29 @@ fail:
 
 #ifdef CONFIG_ECC
 
+/*
+ * The EC_GROUP and the curve parameters are shared by all users of the same
+ * group. They are only read after creation, so a single reference counted
+ * entry per group is used instead of creating the group again for each SAE,
+ * DPP, OWE, or EAP-pwd exchange. Each crypto_ec_init() caller still gets its
+ * own BN_CTX, so the temporaries of the operations on secret values are freed
+ * (and cleared) with the user's context in crypto_ec_deinit().
+ */
+struct crypto_ec_group {
+	struct crypto_ec_group *next;
+	unsigned int refcount;
+	EC_GROUP *group;
+	int nid;
+	BIGNUM *prime;
+	BIGNUM *order;
+	BIGNUM *a;
+	BIGNUM *b;
+};
+
+static struct crypto_ec_group *crypto_ec_groups;
+
 struct crypto_ec {
+	struct crypto_ec_group *grp;
 	EC_GROUP *group;
 	int nid;
 	BN_CTX *bnctx;
@@ -1730,6 +1752,70 @@ static int crypto_ec_group_2_nid(int group)
 }
 
 
+static void crypto_ec_group_free(struct crypto_ec_group *grp)
+{
+	BN_clear_free(grp->b);
+	BN_clear_free(grp->a);
+	BN_clear_free(grp->order);
+	BN_clear_free(grp->prime);
+	EC_GROUP_free(grp->group);
+	os_free(grp);
+}
+
+
+static struct crypto_ec_group * crypto_ec_group_get(int nid, BN_CTX *bnctx)
+{
+	struct crypto_ec_group *grp;
+
+	for (grp = crypto_ec_groups; grp; grp = grp->next) {
+		if (grp->nid == nid) {
+			grp->refcount++;
+			return grp;
+		}
+	}
+
+	grp = os_zalloc(sizeof(*grp));
+	if (!grp)
+		return NULL;
+
+	grp->refcount = 1;
+	grp->nid = nid;
+	grp->group = EC_GROUP_new_by_curve_name(nid);
+	grp->prime = BN_new();
+	grp->order = BN_new();
+	grp->a = BN_new();
+	grp->b = BN_new();
+	if (!grp->group || !grp->prime || !grp->order || !grp->a || !grp->b ||
+	    !EC_GROUP_get_curve_GFp(grp->group, grp->prime, grp->a, grp->b,
+				    bnctx) ||
+	    !EC_GROUP_get_order(grp->group, grp->order, bnctx)) {
+		crypto_ec_group_free(grp);
+		return NULL;
+	}
+
+	grp->next = crypto_ec_groups;
+	crypto_ec_groups = grp;
+	return grp;
+}
+
+
+static void crypto_ec_group_put(struct crypto_ec_group *grp)
+{
+	struct crypto_ec_group **pos;
+
+	if (!grp || --grp->refcount > 0)
+		return;
+
+	for (pos = &crypto_ec_groups; *pos; pos = &(*pos)->next) {
+		if (*pos == grp) {
+			*pos = grp->next;
+			break;
+		}
+	}
+	crypto_ec_group_free(grp);
+}
+
+
 struct crypto_ec * crypto_ec_init(int group)
 {
 	struct crypto_ec *e;
@@ -1745,18 +1831,17 @@ struct crypto_ec * crypto_ec_init(int group)
 
 	e->nid = nid;
 	e->bnctx = BN_CTX_new();
-	e->group = EC_GROUP_new_by_curve_name(nid);
-	e->prime = BN_new();
-	e->order = BN_new();
-	e->a = BN_new();
-	e->b = BN_new();
-	if (e->group == NULL || e->bnctx == NULL || e->prime == NULL ||
-	    e->order == NULL || e->a == NULL || e->b == NULL ||
-	    !EC_GROUP_get_curve_GFp(e->group, e->prime, e->a, e->b, e->bnctx) ||
-	    !EC_GROUP_get_order(e->group, e->order, e->bnctx)) {
+	if (e->bnctx)
+		e->grp = crypto_ec_group_get(nid, e->bnctx);
+	if (!e->grp) {
 		crypto_ec_deinit(e);
-		e = NULL;
+		return NULL;
 	}
+	e->group = e->grp->group;
+	e->prime = e->grp->prime;
+	e->order = e->grp->order;
+	e->a = e->grp->a;
+	e->b = e->grp->b;
 
 	return e;
 }
@@ -1766,11 +1851,7 @@ void crypto_ec_deinit(struct crypto_ec *e)
 {
 	if (e == NULL)
 		return;
-	BN_clear_free(e->b);
-	BN_clear_free(e->a);
-	BN_clear_free(e->order);
-	BN_clear_free(e->prime);
-	EC_GROUP_free(e->group);
+	crypto_ec_group_put(e->grp);
 	BN_CTX_free(e->bnctx);
 	os_free(e);
 }
@@ -1864,8 +1945,9 @@ int crypto_ec_point_to_bin(struct crypto_ec *e,
 	if (TEST_FAIL())
 		return -1;
 
-	x_bn = BN_new();
-	y_bn = BN_new();
+	BN_CTX_start(e->bnctx);
+	x_bn = BN_CTX_get(e->bnctx);
+	y_bn = BN_CTX_get(e->bnctx);
 
 	if (x_bn && y_bn &&
 	    EC_POINT_get_affine_coordinates_GFp(e->group, (EC_POINT *) point,
@@ -1881,8 +1963,11 @@ int crypto_ec_point_to_bin(struct crypto_ec *e,
 		ret = 0;
 	}
 
-	BN_clear_free(x_bn);
-	BN_clear_free(y_bn);
+	if (x_bn)
+		BN_clear(x_bn);
+	if (y_bn)
+		BN_clear(y_bn);
+	BN_CTX_end(e->bnctx);
 	return ret;
 }
 
@@ -1897,24 +1982,23 @@ struct crypto_ec_point * crypto_ec_point_from_bin(struct crypto_ec *e,
 	if (TEST_FAIL())
 		return NULL;
 
-	x = BN_bin2bn(val, len, NULL);
-	y = BN_bin2bn(val + len, len, NULL);
+	BN_CTX_start(e->bnctx);
+	x = BN_CTX_get(e->bnctx);
+	y = BN_CTX_get(e->bnctx);
 	elem = EC_POINT_new(e->group);
-	if (x == NULL || y == NULL || elem == NULL) {
-		BN_clear_free(x);
-		BN_clear_free(y);
-		EC_POINT_clear_free(elem);
-		return NULL;
-	}
-
-	if (!EC_POINT_set_affine_coordinates_GFp(e->group, elem, x, y,
+	if (x == NULL || y == NULL || elem == NULL ||
+	    !BN_bin2bn(val, len, x) || !BN_bin2bn(val + len, len, y) ||
+	    !EC_POINT_set_affine_coordinates_GFp(e->group, elem, x, y,
 						 e->bnctx)) {
 		EC_POINT_clear_free(elem);
 		elem = NULL;
 	}
 
-	BN_clear_free(x);
-	BN_clear_free(y);
+	if (x)
+		BN_clear(x);
+	if (y)
+		BN_clear(y);
+	BN_CTX_end(e->bnctx);
 
 	return (struct crypto_ec_point *) elem;
 }
@@ -1937,6 +2021,15 @@ int crypto_ec_point_mul(struct crypto_ec *e, const struct crypto_ec_point *p,
 {
 	if (TEST_FAIL())
 		return -1;
+	if ((const EC_POINT *) p == EC_GROUP_get0_generator(e->group)) {
+		/* Use the fixed-base path for the generator. For the curves
+		 * that have one (e.g., P-256 and P-521 on 64-bit platforms),
+		 * OpenSSL uses constant-time precomputed tables for it instead
+		 * of the generic multiplication. */
+		return EC_POINT_mul(e->group, (EC_POINT *) res,
+				    (const BIGNUM *) b, NULL, NULL, e->bnctx)
+			? 0 : -1;
+	}
 	return EC_POINT_mul(e->group, (EC_POINT *) res, NULL,
 			    (const EC_POINT *) p, (const BIGNUM *) b, e->bnctx)
 		? 0 : -1;
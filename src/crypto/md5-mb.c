@@ -0,0 +1,353 @@
+/*
+ * Multi-buffer MD5 and HMAC-MD5
+ * Copyright (c) 2026, Infineon Technologies AG
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ *
+ * MD5 has a strictly serial dependency chain within a message, so a single
+ * hash cannot make use of SIMD units. Independent messages (e.g., RADIUS
+ * authenticators for a batch of received packets) can, however, be hashed in
+ * parallel by running the compression function over one 32-bit lane per
+ * message. With GCC and clang the lanes are processed with generic vector
+ * types which the compiler maps to the SIMD instructions of the target (SSE2,
+ * NEON, etc.). Other compilers use a single lane, i.e., hash the messages
+ * one by one.
+ */
+
+#include "includes.h"
+
+#include "common.h"
+#include "md5.h"
+#include "crypto.h"
+
+#define MD5_BLOCK_SIZE 64
+
+#if defined(__GNUC__) || defined(__clang__)
+#define MD5_MB_LANES 4
+typedef u32 md5_v __attribute__((vector_size(4 * MD5_MB_LANES)));
+#define MD5_V_LANE(v, i) ((v)[i])
+#else /* __GNUC__ || __clang__ */
+#define MD5_MB_LANES 1
+typedef u32 md5_v;
+#define MD5_V_LANE(v, i) (v)
+#endif /* __GNUC__ || __clang__ */
+
+
+struct md5_mb_lane {
+	const u8 *prefix; /* optional full block before the data vector */
+	size_t num_elem;
+	const u8 **addr;
+	const size_t *len;
+	size_t elem; /* current element in the data vector */
+	size_t off; /* offset within the current element */
+	u64 total; /* message length in octets */
+	size_t blocks; /* number of blocks including padding */
+	size_t block; /* next block to process */
+	int padded; /* 0x80 padding octet already added */
+};
+
+
+static void md5_mb_lane_init(struct md5_mb_lane *l, const u8 *prefix,
+			     size_t num_elem, const u8 **addr,
+			     const size_t *len)
+{
+	size_t i;
+
+	os_memset(l, 0, sizeof(*l));
+	l->prefix = prefix;
+	l->num_elem = num_elem;
+	l->addr = addr;
+	l->len = len;
+	l->total = prefix ? MD5_BLOCK_SIZE : 0;
+	for (i = 0; i < num_elem; i++)
+		l->total += len[i];
+	l->blocks = (l->total + 8) / MD5_BLOCK_SIZE + 1;
+}
+
+
+/* Copy the next 64-octet block of the padded message into blk */
+static void md5_mb_lane_fill(struct md5_mb_lane *l, u8 *blk)
+{
+	size_t used = 0, n;
+
+	if (l->block == 0 && l->prefix) {
+		os_memcpy(blk, l->prefix, MD5_BLOCK_SIZE);
+		used = MD5_BLOCK_SIZE;
+	}
+
+	while (used < MD5_BLOCK_SIZE && l->elem < l->num_elem) {
+		n = l->len[l->elem] - l->off;
+		if (n > MD5_BLOCK_SIZE - used)
+			n = MD5_BLOCK_SIZE - used;
+		os_memcpy(blk + used, l->addr[l->elem] + l->off, n);
+		used += n;
+		l->off += n;
+		if (l->off == l->len[l->elem]) {
+			l->elem++;
+			l->off = 0;
+		}
+	}
+
+	if (used < MD5_BLOCK_SIZE) {
+		if (!l->padded) {
+			blk[used++] = 0x80;
+			l->padded = 1;
+		}
+		os_memset(blk + used, 0, MD5_BLOCK_SIZE - used);
+		if (l->block == l->blocks - 1)
+			WPA_PUT_LE64(blk + 56, l->total << 3);
+	}
+
+	l->block++;
+}
+
+
+#define F1(x, y, z) (z ^ (x & (y ^ z)))
+#define F2(x, y, z) F1(z, x, y)
+#define F3(x, y, z) (x ^ y ^ z)
+#define F4(x, y, z) (y ^ (x | ~z))
+
+#define MD5STEP(f, w, x, y, z, data, s) \
+	(w += f(x, y, z) + data, w = w << s | w >> (32 - s), w += x)
+
+static void md5_mb_transform(md5_v st[4], const md5_v in[16])
+{
+	md5_v a, b, c, d;
+
+	a = st[0];
+	b = st[1];
+	c = st[2];
+	d = st[3];
+
+	MD5STEP(F1, a, b, c, d, in[0] + 0xd76aa478, 7);
+	MD5STEP(F1, d, a, b, c, in[1] + 0xe8c7b756, 12);
+	MD5STEP(F1, c, d, a, b, in[2] + 0x242070db, 17);
+	MD5STEP(F1, b, c, d, a, in[3] + 0xc1bdceee, 22);
+	MD5STEP(F1, a, b, c, d, in[4] + 0xf57c0faf, 7);
+	MD5STEP(F1, d, a, b, c, in[5] + 0x4787c62a, 12);
+	MD5STEP(F1, c, d, a, b, in[6] + 0xa8304613, 17);
+	MD5STEP(F1, b, c, d, a, in[7] + 0xfd469501, 22);
+	MD5STEP(F1, a, b, c, d, in[8] + 0x698098d8, 7);
+	MD5STEP(F1, d, a, b, c, in[9] + 0x8b44f7af, 12);
+	MD5STEP(F1, c, d, a, b, in[10] + 0xffff5bb1, 17);
+	MD5STEP(F1, b, c, d, a, in[11] + 0x895cd7be, 22);
+	MD5STEP(F1, a, b, c, d, in[12] + 0x6b901122, 7);
+	MD5STEP(F1, d, a, b, c, in[13] + 0xfd987193, 12);
+	MD5STEP(F1, c, d, a, b, in[14] + 0xa679438e, 17);
+	MD5STEP(F1, b, c, d, a, in[15] + 0x49b40821, 22);
+
+	MD5STEP(F2, a, b, c, d, in[1] + 0xf61e2562, 5);
+	MD5STEP(F2, d, a, b, c, in[6] + 0xc040b340, 9);
+	MD5STEP(F2, c, d, a, b, in[11] + 0x265e5a51, 14);
+	MD5STEP(F2, b, c, d, a, in[0] + 0xe9b6c7aa, 20);
+	MD5STEP(F2, a, b, c, d, in[5] + 0xd62f105d, 5);
+	MD5STEP(F2, d, a, b, c, in[10] + 0x02441453, 9);
+	MD5STEP(F2, c, d, a, b, in[15] + 0xd8a1e681, 14);
+	MD5STEP(F2, b, c, d, a, in[4] + 0xe7d3fbc8, 20);
+	MD5STEP(F2, a, b, c, d, in[9] + 0x21e1cde6, 5);
+	MD5STEP(F2, d, a, b, c, in[14] + 0xc33707d6, 9);
+	MD5STEP(F2, c, d, a, b, in[3] + 0xf4d50d87, 14);
+	MD5STEP(F2, b, c, d, a, in[8] + 0x455a14ed, 20);
+	MD5STEP(F2, a, b, c, d, in[13] + 0xa9e3e905, 5);
+	MD5STEP(F2, d, a, b, c, in[2] + 0xfcefa3f8, 9);
+	MD5STEP(F2, c, d, a, b, in[7] + 0x676f02d9, 14);
+	MD5STEP(F2, b, c, d, a, in[12] + 0x8d2a4c8a, 20);
+
+	MD5STEP(F3, a, b, c, d, in[5] + 0xfffa3942, 4);
+	MD5STEP(F3, d, a, b, c, in[8] + 0x8771f681, 11);
+	MD5STEP(F3, c, d, a, b, in[11] + 0x6d9d6122, 16);
+	MD5STEP(F3, b, c, d, a, in[14] + 0xfde5380c, 23);
+	MD5STEP(F3, a, b, c, d, in[1] + 0xa4beea44, 4);
+	MD5STEP(F3, d, a, b, c, in[4] + 0x4bdecfa9, 11);
+	MD5STEP(F3, c, d, a, b, in[7] + 0xf6bb4b60, 16);
+	MD5STEP(F3, b, c, d, a, in[10] + 0xbebfbc70, 23);
+	MD5STEP(F3, a, b, c, d, in[13] + 0x289b7ec6, 4);
+	MD5STEP(F3, d, a, b, c, in[0] + 0xeaa127fa, 11);
+	MD5STEP(F3, c, d, a, b, in[3] + 0xd4ef3085, 16);
+	MD5STEP(F3, b, c, d, a, in[6] + 0x04881d05, 23);
+	MD5STEP(F3, a, b, c, d, in[9] + 0xd9d4d039, 4);
+	MD5STEP(F3, d, a, b, c, in[12] + 0xe6db99e5, 11);
+	MD5STEP(F3, c, d, a, b, in[15] + 0x1fa27cf8, 16);
+	MD5STEP(F3, b, c, d, a, in[2] + 0xc4ac5665, 23);
+
+	MD5STEP(F4, a, b, c, d, in[0] + 0xf4292244, 6);
+	MD5STEP(F4, d, a, b, c, in[7] + 0x432aff97, 10);
+	MD5STEP(F4, c, d, a, b, in[14] + 0xab9423a7, 15);
+	MD5STEP(F4, b, c, d, a, in[5] + 0xfc93a039, 21);
+	MD5STEP(F4, a, b, c, d, in[12] + 0x655b59c3, 6);
+	MD5STEP(F4, d, a, b, c, in[3] + 0x8f0ccc92, 10);
+	MD5STEP(F4, c, d, a, b, in[10] + 0xffeff47d, 15);
+	MD5STEP(F4, b, c, d, a, in[1] + 0x85845dd1, 21);
+	MD5STEP(F4, a, b, c, d, in[8] + 0x6fa87e4f, 6);
+	MD5STEP(F4, d, a, b, c, in[15] + 0xfe2ce6e0, 10);
+	MD5STEP(F4, c, d, a, b, in[6] + 0xa3014314, 15);
+	MD5STEP(F4, b, c, d, a, in[13] + 0x4e0811a1, 21);
+	MD5STEP(F4, a, b, c, d, in[4] + 0xf7537e82, 6);
+	MD5STEP(F4, d, a, b, c, in[11] + 0xbd3af235, 10);
+	MD5STEP(F4, c, d, a, b, in[2] + 0x2ad7d2bb, 15);
+	MD5STEP(F4, b, c, d, a, in[9] + 0xeb86d391, 21);
+
+	st[0] += a;
+	st[1] += b;
+	st[2] += c;
+	st[3] += d;
+}
+
+
+/* Hash up to MD5_MB_LANES messages in parallel */
+static void md5_mb_lanes(struct md5_mb_lane *lanes, size_t num, u8 **mac)
+{
+	u8 blk[MD5_MB_LANES][MD5_BLOCK_SIZE];
+	md5_v st[4], in[16];
+	size_t i, j, max_blocks = 0, b;
+
+	for (i = 0; i < num; i++) {
+		if (lanes[i].blocks > max_blocks)
+			max_blocks = lanes[i].blocks;
+	}
+
+	for (i = 0; i < MD5_MB_LANES; i++) {
+		MD5_V_LANE(st[0], i) = 0x67452301;
+		MD5_V_LANE(st[1], i) = 0xefcdab89;
+		MD5_V_LANE(st[2], i) = 0x98badcfe;
+		MD5_V_LANE(st[3], i) = 0x10325476;
+	}
+	os_memset(blk, 0, sizeof(blk));
+
+	for (b = 0; b < max_blocks; b++) {
+		/* Lanes that have already completed (and unused lanes) keep
+		 * hashing their previous block; the result is not used. */
+		for (i = 0; i < num; i++) {
+			if (b < lanes[i].blocks)
+				md5_mb_lane_fill(&lanes[i], blk[i]);
+		}
+
+		for (j = 0; j < 16; j++) {
+			for (i = 0; i < MD5_MB_LANES; i++)
+				MD5_V_LANE(in[j], i) =
+					WPA_GET_LE32(&blk[i][j * 4]);
+		}
+
+		md5_mb_transform(st, in);
+
+		for (i = 0; i < num; i++) {
+			if (b + 1 != lanes[i].blocks)
+				continue;
+			for (j = 0; j < 4; j++)
+				WPA_PUT_LE32(mac[i] + j * 4,
+					     MD5_V_LANE(st[j], i));
+		}
+	}
+
+	forced_memzero(blk, sizeof(blk));
+	forced_memzero(in, sizeof(in));
+}
+
+/**
+ * md5_vector_mb - MD5 hash for multiple independent data vectors
+ * @jobs: Array of hash jobs; the key fields are ignored
+ * @num_jobs: Number of entries in jobs
+ * Returns: 0 on success, -1 on failure
+ *
+ * This computes the same result as calling md5_vector() separately for each
+ * job, but processes up to four jobs at a time in parallel.
+ */
+int md5_vector_mb(struct md5_mb_job *jobs, size_t num_jobs)
+{
+	struct md5_mb_lane lanes[MD5_MB_LANES];
+	u8 *mac[MD5_MB_LANES];
+	size_t i, n;
+
+	if (TEST_FAIL())
+		return -1;
+
+	while (num_jobs > 0) {
+		n = num_jobs > MD5_MB_LANES ? MD5_MB_LANES : num_jobs;
+		for (i = 0; i < n; i++) {
+			md5_mb_lane_init(&lanes[i], NULL, jobs[i].num_elem,
+					 jobs[i].addr, jobs[i].len);
+			mac[i] = jobs[i].mac;
+		}
+		md5_mb_lanes(lanes, n, mac);
+		jobs += n;
+		num_jobs -= n;
+	}
+
+	return 0;
+}
+
+
+/**
+ * hmac_md5_vector_mb - HMAC-MD5 over multiple independent data vectors
+ * @jobs: Array of HMAC jobs, each with its own key
+ * @num_jobs: Number of entries in jobs
+ * Returns: 0 on success, -1 on failure
+ *
+ * This computes the same result as calling hmac_md5_vector() separately for
+ * each job, but processes up to four jobs at a time in parallel.
+ */
+int hmac_md5_vector_mb(struct md5_mb_job *jobs, size_t num_jobs)
+{
+	struct md5_mb_lane lanes[MD5_MB_LANES];
+	u8 k_ipad[MD5_MB_LANES][MD5_BLOCK_SIZE];
+	u8 k_opad[MD5_MB_LANES][MD5_BLOCK_SIZE];
+	u8 tk[MD5_MAC_LEN];
+	u8 *mac[MD5_MB_LANES];
+	const u8 *_addr[MD5_MB_LANES][1];
+	size_t _len[MD5_MB_LANES][1];
+	size_t i, j, n;
+	int ret = 0;
+
+	if (TEST_FAIL())
+		return -1;
+
+	while (num_jobs > 0) {
+		n = num_jobs > MD5_MB_LANES ? MD5_MB_LANES : num_jobs;
+		for (i = 0; i < n; i++) {
+			const u8 *key = jobs[i].key;
+			size_t key_len = jobs[i].key_len;
+
+			/* if key is longer than 64 bytes reset it to
+			 * key = MD5(key) */
+			if (key_len > MD5_BLOCK_SIZE) {
+				if (md5_vector(1, &key, &key_len, tk)) {
+					ret = -1;
+					goto out;
+				}
+				key = tk;
+				key_len = MD5_MAC_LEN;
+			}
+			os_memset(k_ipad[i], 0, MD5_BLOCK_SIZE);
+			os_memcpy(k_ipad[i], key, key_len);
+			for (j = 0; j < MD5_BLOCK_SIZE; j++) {
+				k_opad[i][j] = k_ipad[i][j] ^ 0x5c;
+				k_ipad[i][j] ^= 0x36;
+			}
+
+			/* inner MD5 */
+			md5_mb_lane_init(&lanes[i], k_ipad[i], jobs[i].num_elem,
+					 jobs[i].addr, jobs[i].len);
+			mac[i] = jobs[i].mac;
+		}
+		md5_mb_lanes(lanes, n, mac);
+
+		/* outer MD5 */
+		for (i = 0; i < n; i++) {
+			_addr[i][0] = mac[i];
+			_len[i][0] = MD5_MAC_LEN;
+			md5_mb_lane_init(&lanes[i], k_opad[i], 1, _addr[i],
+					 _len[i]);
+		}
+		md5_mb_lanes(lanes, n, mac);
+
+		jobs += n;
+		num_jobs -= n;
+	}
+
+out:
+	forced_memzero(k_ipad, sizeof(k_ipad));
+	forced_memzero(k_opad, sizeof(k_opad));
+	forced_memzero(tk, sizeof(tk));
+	return ret;
+}
@@ -16,4 +16,25 @@ int hmac_md5_vector(const u8 *key, size_t key_len, size_t num_elem,
 int hmac_md5(const u8 *key, size_t key_len, const u8 *data, size_t data_len,
 	     u8 *mac);
 
+/**
+ * struct md5_mb_job - Hash job for multi-buffer MD5/HMAC-MD5
+ * @key: Key for HMAC operations (hmac_md5_vector_mb() only)
+ * @key_len: Length of the key in bytes
+ * @num_elem: Number of elements in the data vector
+ * @addr: Pointers to the data areas
+ * @len: Lengths of the data blocks
+ * @mac: Buffer for the hash (16 bytes)
+ */
+struct md5_mb_job {
+	const u8 *key;
+	size_t key_len;
+	size_t num_elem;
+	const u8 **addr;
+	const size_t *len;
+	u8 *mac;
+};
+
+int md5_vector_mb(struct md5_mb_job *jobs, size_t num_jobs);
+int hmac_md5_vector_mb(struct md5_mb_job *jobs, size_t num_jobs);
+
 #endif /* MD5_H */
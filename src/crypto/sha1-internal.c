@@ -13,6 +13,7 @@
 #include "sha1_i.h"
 #include "md5.h"
 #include "crypto.h"
+#include "crypto_accel.h"
 
 typedef struct SHA1Context SHA1_CTX;
 
@@ -183,6 +184,12 @@ void SHA1Transform(u32 state[5], const unsigned char buffer[64])
 	CHAR64LONG16* block;
 #ifdef SHA1HANDSOFF
 	CHAR64LONG16 workspace;
+#endif
+
+	if (crypto_accel_sha1_block(state, buffer) == 0)
+		return;
+
+#ifdef SHA1HANDSOFF
 	block = &workspace;
 	os_memcpy(block, buffer, 64);
 #else
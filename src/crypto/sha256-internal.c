@@ -12,6 +12,7 @@
 #include "sha256.h"
 #include "sha256_i.h"
 #include "crypto.h"
+#include "crypto_accel.h"
 
 
 /**
@@ -87,6 +88,9 @@ static int sha256_compress(struct sha256_state *md, unsigned char *buf)
 	u32 t;
 	int i;
 
+	if (crypto_accel_sha256_block(md->state, buf) == 0)
+		return 0;
+
 	/* copy state into S */
 	for (i = 0; i < 8; i++) {
 		S[i] = md->state[i];
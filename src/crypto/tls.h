@@ -88,6 +88,10 @@ struct tls_config {
 	unsigned int tls_session_lifetime;
 	unsigned int crl_reload_interval;
 	unsigned int tls_flags;
+	const char *tls_session_cache;
+	unsigned int tls_session_cache_size;
+	unsigned int tls_verify_cache_size;
+	unsigned int tls_verify_cache_lifetime;
 
 	void (*event_cb)(void *ctx, enum tls_event ev,
 			 union tls_event_data *data);
@@ -112,6 +116,7 @@ struct tls_config {
 #define TLS_CONN_ENABLE_TLSv1_1 BIT(15)
 #define TLS_CONN_ENABLE_TLSv1_2 BIT(16)
 #define TLS_CONN_TEAP_ANON_DH BIT(17)
+#define TLS_CONN_DISABLE_CERT_COMPRESSION BIT(18)
 
 /**
  * struct tls_connection_params - Parameters for TLS connection
@@ -165,6 +170,8 @@ struct tls_config {
  * @flags: Parameter options (TLS_CONN_*)
  * @ocsp_stapling_response: DER encoded file with cached OCSP stapling response
  *	or %NULL if OCSP is not enabled
+ * @ocsp_stapling_response2: DER encoded file with cached OCSP stapling
+ *	response for client_cert2 or %NULL if not used
  * @ocsp_stapling_response_multi: DER encoded file with cached OCSP stapling
  *	response list (OCSPResponseList for ocsp_multi in RFC 6961) or %NULL if
  *	ocsp_multi is not enabled
@@ -213,6 +220,7 @@ struct tls_connection_params {
 
 	unsigned int flags;
 	const char *ocsp_stapling_response;
+	const char *ocsp_stapling_response2;
 	const char *ocsp_stapling_response_multi;
 	const char *check_cert_subject;
 };
@@ -253,6 +261,75 @@ void tls_deinit(void *tls_ctx);
  */
 int tls_get_errors(void *tls_ctx);
 
+/**
+ * struct tls_session_stats - TLS server session resumption statistics
+ * @resumed: Number of resumed sessions (any mechanism)
+ * @misses: Number of session ID lookups that did not find a session
+ * @timeouts: Number of sessions found that had expired
+ * @shared_hits: Number of sessions found in the shared session cache
+ * @shared_misses: Number of lookups that did not find a session in the
+ *	shared session cache
+ * @shared_stores: Number of sessions stored in the shared session cache
+ * @ticket_hits: Number of accepted session tickets
+ * @ticket_misses: Number of session tickets that could not be decrypted or
+ *	that did not have cached application data
+ */
+struct tls_session_stats {
+	unsigned int resumed;
+	unsigned int misses;
+	unsigned int timeouts;
+	unsigned int shared_hits;
+	unsigned int shared_misses;
+	unsigned int shared_stores;
+	unsigned int ticket_hits;
+	unsigned int ticket_misses;
+};
+
+/**
+ * tls_get_session_stats - Get TLS server session resumption statistics
+ * @tls_ctx: TLS context data from tls_init()
+ * @stats: Buffer for returning the statistics
+ * Returns: 0 on success or -1 if not supported
+ */
+int tls_get_session_stats(void *tls_ctx, struct tls_session_stats *stats);
+
+/**
+ * struct tls_cert_cache_stats - Credential and verification cache statistics
+ * @cred_hits: Number of credential file loads served from the process-wide
+ *	credential cache
+ * @cred_misses: Number of credential files that were parsed because they
+ *	were not in the cache
+ * @cred_reloads: Number of cached credential files that were parsed again
+ *	because the file had changed
+ * @cred_entries: Number of credential files in the cache
+ * @verify_hits: Number of peer certificate chains accepted based on the
+ *	verification cache
+ * @verify_misses: Number of peer certificate chains that were verified in
+ *	full
+ * @verify_stores: Number of successful verifications added to the cache
+ * @verify_expired: Number of cached verifications that had expired
+ * @verify_entries: Number of cached verifications
+ */
+struct tls_cert_cache_stats {
+	unsigned int cred_hits;
+	unsigned int cred_misses;
+	unsigned int cred_reloads;
+	unsigned int cred_entries;
+	unsigned int verify_hits;
+	unsigned int verify_misses;
+	unsigned int verify_stores;
+	unsigned int verify_expired;
+	unsigned int verify_entries;
+};
+
+/**
+ * tls_get_cert_cache_stats - Get credential and verification cache statistics
+ * @tls_ctx: TLS context data from tls_init()
+ * @stats: Buffer for returning the statistics
+ * Returns: 0 on success or -1 if not supported
+ */
+int tls_get_cert_cache_stats(void *tls_ctx, struct tls_cert_cache_stats *stats);
+
 /**
  * tls_connection_init - Initialize a new TLS connection
  * @tls_ctx: TLS context data from tls_init()
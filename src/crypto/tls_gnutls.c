@@ -151,6 +151,19 @@ int tls_get_errors(void *ssl_ctx)
 }
 
 
+int tls_get_session_stats(void *ssl_ctx, struct tls_session_stats *stats)
+{
+	return -1;
+}
+
+
+int tls_get_cert_cache_stats(void *ssl_ctx,
+			     struct tls_cert_cache_stats *stats)
+{
+	return -1;
+}
+
+
 static ssize_t tls_pull_func(gnutls_transport_ptr_t ptr, void *buf,
 			     size_t len)
 {
@@ -28,6 +28,19 @@ int tls_get_errors(void *tls_ctx)
 }
 
 
+int tls_get_session_stats(void *tls_ctx, struct tls_session_stats *stats)
+{
+	return -1;
+}
+
+
+int tls_get_cert_cache_stats(void *tls_ctx,
+			     struct tls_cert_cache_stats *stats)
+{
+	return -1;
+}
+
+
 struct tls_connection * tls_connection_init(void *tls_ctx)
 {
 	return NULL;
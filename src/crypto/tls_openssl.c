@@ -61,10 +61,39 @@ typedef int stack_index_t;
 #ifdef SSL_set_tlsext_status_type
 #ifndef OPENSSL_NO_TLSEXT
 #define HAVE_OCSP
+#include <sys/stat.h>
 #include <openssl/ocsp.h>
 #endif /* OPENSSL_NO_TLSEXT */
 #endif /* SSL_set_tlsext_status_type */
 
+#if defined(CONFIG_TLS_SESSION_CACHE) && \
+	OPENSSL_VERSION_NUMBER >= 0x10101000L && \
+	!defined(LIBRESSL_VERSION_NUMBER) && !defined(OPENSSL_IS_BORINGSSL)
+#define TLS_SHARED_SESSION_CACHE
+#include "tls_session_cache.h"
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#else
+#include <openssl/hmac.h>
+#endif
+
+/* Prefixes for the shared session cache lookup keys */
+#define TLS_CACHE_KEY_SESSION_ID 1
+#define TLS_CACHE_KEY_TICKET 2
+
+/* Length of the random handle that is stored in session tickets to find the
+ * application data of the session from the shared session cache */
+#define TLS_TICKET_HANDLE_LEN 16
+#endif
+
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L && \
+	!defined(LIBRESSL_VERSION_NUMBER) && !defined(OPENSSL_IS_BORINGSSL) && \
+	!defined(OPENSSL_NO_STDIO)
+#define TLS_CRED_CACHE
+#include <sys/stat.h>
+#include "list.h"
+#endif
+
 #if (OPENSSL_VERSION_NUMBER < 0x10100000L || \
      (defined(LIBRESSL_VERSION_NUMBER) && \
       LIBRESSL_VERSION_NUMBER < 0x20700000L)) && \
@@ -212,12 +241,40 @@ struct tls_context {
 			 union tls_event_data *data);
 	void *cb_ctx;
 	int cert_in_cb;
-	char *ocsp_stapling_response;
 };
 
 static struct tls_context *tls_global = NULL;
 
 
+#ifdef HAVE_OCSP
+
+/* Number of cached OCSP stapling responses, one for each server certificate */
+#define TLS_OCSP_MAX_RESP 2
+
+/* Minimum interval (in seconds) between checks for an updated OCSP stapling
+ * response file */
+#define TLS_OCSP_RESP_CHECK_INTERVAL 10
+
+struct tls_ocsp_resp {
+	char *fname;
+	u8 *der;
+	size_t der_len;
+
+	/* Parsed response; NULL if the response could not be parsed, in which
+	 * case it is sent as-is */
+	OCSP_BASICRESP *basic;
+	ASN1_INTEGER *serial; /* certificate serial number (within basic) */
+	ASN1_GENERALIZEDTIME *next_update; /* within basic */
+
+	struct os_reltime last_check;
+	dev_t dev;
+	ino_t ino;
+	time_t mtime;
+	off_t size;
+};
+
+#endif /* HAVE_OCSP */
+
 struct tls_data {
 	SSL_CTX *ssl;
 	unsigned int tls_session_lifetime;
@@ -227,6 +284,19 @@ struct tls_data {
 	unsigned int crl_reload_interval;
 	struct os_reltime crl_last_reload;
 	char *check_cert_subject;
+#ifdef HAVE_OCSP
+	struct tls_ocsp_resp ocsp_resp[TLS_OCSP_MAX_RESP];
+#endif /* HAVE_OCSP */
+#ifdef TLS_SHARED_SESSION_CACHE
+	struct tls_session_cache *session_cache;
+	struct tls_session_stats stats;
+#endif /* TLS_SHARED_SESSION_CACHE */
+#ifdef TLS_CRED_CACHE
+	/* Identifies the contents of the certificate store of ssl; 0 if
+	 * unknown, in which case verification results are not cached */
+	unsigned int ca_set_id;
+	struct tls_verify_cache *verify_cache;
+#endif /* TLS_CRED_CACHE */
 };
 
 struct tls_connection {
@@ -250,6 +320,14 @@ struct tls_connection {
 	u8 *session_ticket;
 	size_t session_ticket_len;
 
+#ifdef TLS_SHARED_SESSION_CACHE
+	/* Handle in the session tickets issued on this connection */
+	u8 ticket_handle[TLS_TICKET_HANDLE_LEN];
+	bool ticket_handle_set;
+	/* Application data of a session resumed with a session ticket */
+	struct wpabuf *ticket_success_data;
+#endif /* TLS_SHARED_SESSION_CACHE */
+
 	unsigned int ca_cert_verify:1;
 	unsigned int cert_probe:1;
 	unsigned int server_cert_only:1;
@@ -863,91 +941,1084 @@ static int tls_engine_load_dynamic_generic(const char *pre[],
 }
 
 
-/**
- * tls_engine_load_dynamic_pkcs11 - load the pkcs11 engine provided by opensc
- * @pkcs11_so_path: pksc11_so_path from the configuration
- * @pcks11_module_path: pkcs11_module_path from the configuration
- */
-static int tls_engine_load_dynamic_pkcs11(const char *pkcs11_so_path,
-					  const char *pkcs11_module_path)
+/**
+ * tls_engine_load_dynamic_pkcs11 - load the pkcs11 engine provided by opensc
+ * @pkcs11_so_path: pksc11_so_path from the configuration
+ * @pcks11_module_path: pkcs11_module_path from the configuration
+ */
+static int tls_engine_load_dynamic_pkcs11(const char *pkcs11_so_path,
+					  const char *pkcs11_module_path)
+{
+	char *engine_id = "pkcs11";
+	const char *pre_cmd[] = {
+		"SO_PATH", NULL /* pkcs11_so_path */,
+		"ID", NULL /* engine_id */,
+		"LIST_ADD", "1",
+		/* "NO_VCHECK", "1", */
+		"LOAD", NULL,
+		NULL, NULL
+	};
+	const char *post_cmd[] = {
+		"MODULE_PATH", NULL /* pkcs11_module_path */,
+		NULL, NULL
+	};
+
+	if (!pkcs11_so_path)
+		return 0;
+
+	pre_cmd[1] = pkcs11_so_path;
+	pre_cmd[3] = engine_id;
+	if (pkcs11_module_path)
+		post_cmd[1] = pkcs11_module_path;
+	else
+		post_cmd[0] = NULL;
+
+	wpa_printf(MSG_DEBUG, "ENGINE: Loading pkcs11 Engine from %s",
+		   pkcs11_so_path);
+
+	return tls_engine_load_dynamic_generic(pre_cmd, post_cmd, engine_id);
+}
+
+
+/**
+ * tls_engine_load_dynamic_opensc - load the opensc engine provided by opensc
+ * @opensc_so_path: opensc_so_path from the configuration
+ */
+static int tls_engine_load_dynamic_opensc(const char *opensc_so_path)
+{
+	char *engine_id = "opensc";
+	const char *pre_cmd[] = {
+		"SO_PATH", NULL /* opensc_so_path */,
+		"ID", NULL /* engine_id */,
+		"LIST_ADD", "1",
+		"LOAD", NULL,
+		NULL, NULL
+	};
+
+	if (!opensc_so_path)
+		return 0;
+
+	pre_cmd[1] = opensc_so_path;
+	pre_cmd[3] = engine_id;
+
+	wpa_printf(MSG_DEBUG, "ENGINE: Loading OpenSC Engine from %s",
+		   opensc_so_path);
+
+	return tls_engine_load_dynamic_generic(pre_cmd, NULL, engine_id);
+}
+#endif /* OPENSSL_NO_ENGINE */
+
+
+static void remove_session_cb(SSL_CTX *ctx, SSL_SESSION *sess)
+{
+	struct wpabuf *buf;
+
+	if (tls_ex_idx_session < 0)
+		return;
+	buf = SSL_SESSION_get_ex_data(sess, tls_ex_idx_session);
+	if (!buf)
+		return;
+	wpa_printf(MSG_DEBUG,
+		   "OpenSSL: Free application session data %p (sess %p)",
+		   buf, sess);
+	wpabuf_free(buf);
+
+	SSL_SESSION_set_ex_data(sess, tls_ex_idx_session, NULL);
+}
+
+
+#ifdef TLS_SHARED_SESSION_CACHE
+
+/*
+ * The shared session cache makes session resumption work across processes
+ * and restarts. The OpenSSL internal cache is still used first. Sessions are
+ * added to the shared cache only when the EAP method has stored its success
+ * data since a session cannot be resumed without it. Session tickets are
+ * encrypted with keys from the shared cache and carry a random handle that is
+ * used to find the success data from the shared cache.
+ */
+
+static size_t tls_shared_cache_key(u8 *key, u8 type, const u8 *id,
+				   size_t id_len)
+{
+	key[0] = type;
+	os_memcpy(key + 1, id, id_len);
+	return 1 + id_len;
+}
+
+
+static SSL_SESSION * tls_shared_cache_get_cb(SSL *s, const unsigned char *id,
+					     int id_len, int *copy)
+{
+	struct tls_connection *conn = SSL_get_app_data(s);
+	struct tls_data *data = conn ? conn->data : NULL;
+	u8 key[1 + SSL_MAX_SSL_SESSION_ID_LENGTH], *der;
+	const unsigned char *pos;
+	size_t key_len, der_len;
+	struct wpabuf *app;
+	SSL_SESSION *sess;
+
+	*copy = 0;
+	if (!data || !data->session_cache || id_len <= 0 ||
+	    id_len > SSL_MAX_SSL_SESSION_ID_LENGTH)
+		return NULL;
+
+	key_len = tls_shared_cache_key(key, TLS_CACHE_KEY_SESSION_ID, id,
+				       id_len);
+	if (tls_session_cache_get(data->session_cache, key, key_len,
+				  &der, &der_len, &app) < 0 || !der) {
+		wpabuf_free(app);
+		data->stats.shared_misses++;
+		return NULL;
+	}
+
+	pos = der;
+	sess = d2i_SSL_SESSION(NULL, &pos, der_len);
+	bin_clear_free(der, der_len);
+	if (!sess) {
+		wpa_printf(MSG_INFO,
+			   "OpenSSL: Could not parse session from the shared session cache");
+		wpabuf_free(app);
+		data->stats.shared_misses++;
+		return NULL;
+	}
+	if (app && SSL_SESSION_set_ex_data(sess, tls_ex_idx_session, app) != 1)
+		wpabuf_free(app);
+
+	wpa_printf(MSG_DEBUG,
+		   "OpenSSL: Found session in the shared session cache");
+	data->stats.shared_hits++;
+	return sess;
+}
+
+
+static void tls_shared_cache_store(struct tls_connection *conn,
+				   SSL_SESSION *sess, const struct wpabuf *app)
+{
+	struct tls_data *data = conn->data;
+	u8 key[1 + SSL_MAX_SSL_SESSION_ID_LENGTH], *der, *pos;
+	const unsigned char *id;
+	unsigned int id_len;
+	size_t key_len;
+	int der_len;
+	bool stored = false;
+
+	if (!data->session_cache)
+		return;
+
+	/* TLS v1.3 sessions are resumed only with session tickets */
+	id = SSL_SESSION_get_id(sess, &id_len);
+	if (SSL_version(conn->ssl) < TLS1_3_VERSION && id_len > 0 &&
+	    (der_len = i2d_SSL_SESSION(sess, NULL)) > 0 &&
+	    (der = os_malloc(der_len)) != NULL) {
+		pos = der;
+		i2d_SSL_SESSION(sess, &pos);
+		key_len = tls_shared_cache_key(key, TLS_CACHE_KEY_SESSION_ID,
+					       id, id_len);
+		if (tls_session_cache_store(data->session_cache, key, key_len,
+					    der, der_len, wpabuf_head(app),
+					    wpabuf_len(app),
+					    data->tls_session_lifetime) == 0)
+			stored = true;
+		bin_clear_free(der, der_len);
+	}
+
+	if (conn->ticket_handle_set) {
+		key_len = tls_shared_cache_key(key, TLS_CACHE_KEY_TICKET,
+					       conn->ticket_handle,
+					       TLS_TICKET_HANDLE_LEN);
+		if (tls_session_cache_store(data->session_cache, key, key_len,
+					    NULL, 0, wpabuf_head(app),
+					    wpabuf_len(app),
+					    data->tls_session_lifetime) == 0)
+			stored = true;
+	}
+
+	if (stored) {
+		wpa_printf(MSG_DEBUG,
+			   "OpenSSL: Stored session in the shared session cache");
+		data->stats.shared_stores++;
+	}
+}
+
+
+static void tls_shared_cache_remove(struct tls_connection *conn,
+				    SSL_SESSION *sess)
+{
+	struct tls_data *data = conn->data;
+	u8 key[1 + SSL_MAX_SSL_SESSION_ID_LENGTH];
+	const unsigned char *id;
+	unsigned int id_len;
+	size_t key_len;
+
+	if (!data->session_cache)
+		return;
+
+	id = SSL_SESSION_get_id(sess, &id_len);
+	if (id_len > 0) {
+		key_len = tls_shared_cache_key(key, TLS_CACHE_KEY_SESSION_ID,
+					       id, id_len);
+		tls_session_cache_remove(data->session_cache, key, key_len);
+	}
+	if (conn->ticket_handle_set) {
+		key_len = tls_shared_cache_key(key, TLS_CACHE_KEY_TICKET,
+					       conn->ticket_handle,
+					       TLS_TICKET_HANDLE_LEN);
+		tls_session_cache_remove(data->session_cache, key, key_len);
+	}
+}
+
+
+static int tls_ticket_gen_cb(SSL *s, void *arg)
+{
+	struct tls_connection *conn = SSL_get_app_data(s);
+	SSL_SESSION *sess = SSL_get_session(s);
+
+	if (!conn || !sess)
+		return 1;
+
+	/* Resumed sessions keep the handle from the previous ticket */
+	if (!conn->ticket_handle_set) {
+		if (os_get_random(conn->ticket_handle,
+				  TLS_TICKET_HANDLE_LEN) < 0)
+			return 1;
+		conn->ticket_handle_set = true;
+	}
+
+	if (SSL_SESSION_set1_ticket_appdata(sess, conn->ticket_handle,
+					    TLS_TICKET_HANDLE_LEN) != 1)
+		wpa_printf(MSG_INFO,
+			   "OpenSSL: Failed to add handle to session ticket");
+	return 1;
+}
+
+
+static SSL_TICKET_RETURN tls_ticket_dec_cb(SSL *s, SSL_SESSION *ss,
+					   const unsigned char *keyname,
+					   size_t keyname_len,
+					   SSL_TICKET_STATUS status,
+					   void *arg)
+{
+	struct tls_data *data = arg;
+	struct tls_connection *conn = SSL_get_app_data(s);
+	u8 key[1 + TLS_TICKET_HANDLE_LEN], *der;
+	size_t handle_len, key_len, der_len;
+	struct wpabuf *app;
+	void *handle;
+
+	switch (status) {
+	case SSL_TICKET_SUCCESS:
+	case SSL_TICKET_SUCCESS_RENEW:
+		break;
+	case SSL_TICKET_NO_DECRYPT:
+		wpa_printf(MSG_DEBUG,
+			   "OpenSSL: Could not decrypt session ticket");
+		data->stats.ticket_misses++;
+		return SSL_TICKET_RETURN_IGNORE_RENEW;
+	case SSL_TICKET_EMPTY:
+		return SSL_TICKET_RETURN_IGNORE_RENEW;
+	default:
+		return SSL_TICKET_RETURN_ABORT;
+	}
+
+	/* The session cannot be resumed without the success data, so do a
+	 * full handshake if the ticket does not refer to cached success data.
+	 */
+	if (!conn ||
+	    SSL_SESSION_get0_ticket_appdata(ss, &handle, &handle_len) != 1 ||
+	    handle_len != TLS_TICKET_HANDLE_LEN) {
+		data->stats.ticket_misses++;
+		return SSL_TICKET_RETURN_IGNORE_RENEW;
+	}
+	key_len = tls_shared_cache_key(key, TLS_CACHE_KEY_TICKET, handle,
+				       handle_len);
+	if (tls_session_cache_get(data->session_cache, key, key_len,
+				  &der, &der_len, &app) < 0 || !app) {
+		wpa_printf(MSG_DEBUG,
+			   "OpenSSL: No success data for session ticket");
+		os_free(der);
+		data->stats.ticket_misses++;
+		return SSL_TICKET_RETURN_IGNORE_RENEW;
+	}
+	os_free(der);
+
+	wpabuf_free(conn->ticket_success_data);
+	conn->ticket_success_data = app;
+	os_memcpy(conn->ticket_handle, handle, TLS_TICKET_HANDLE_LEN);
+	conn->ticket_handle_set = true;
+	data->stats.ticket_hits++;
+	wpa_printf(MSG_DEBUG, "OpenSSL: Accepted session ticket");
+
+	if (status == SSL_TICKET_SUCCESS_RENEW)
+		return SSL_TICKET_RETURN_USE_RENEW;
+	return SSL_TICKET_RETURN_USE;
+}
+
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+static int tls_ticket_hmac_init(EVP_MAC_CTX *hctx, struct tls_ticket_key *key)
+{
+	OSSL_PARAM params[3];
+
+	params[0] = OSSL_PARAM_construct_octet_string(OSSL_MAC_PARAM_KEY,
+						      key->hmac_key,
+						      sizeof(key->hmac_key));
+	params[1] = OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST,
+						     "SHA256", 0);
+	params[2] = OSSL_PARAM_construct_end();
+	return EVP_MAC_CTX_set_params(hctx, params) == 1 ? 0 : -1;
+}
+#else /* OpenSSL 3.0 */
+static int tls_ticket_hmac_init(HMAC_CTX *hctx, struct tls_ticket_key *key)
+{
+	return HMAC_Init_ex(hctx, key->hmac_key, sizeof(key->hmac_key),
+			    EVP_sha256(), NULL) == 1 ? 0 : -1;
+}
+#endif /* OpenSSL 3.0 */
+
+
+/* Session ticket key callback (see SSL_CTX_set_tlsext_ticket_key_cb()) */
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+static int tls_ticket_key_cb(SSL *s, unsigned char *key_name,
+			     unsigned char *iv, EVP_CIPHER_CTX *ctx,
+			     EVP_MAC_CTX *hctx, int enc)
+#else /* OpenSSL 3.0 */
+static int tls_ticket_key_cb(SSL *s, unsigned char *key_name,
+			     unsigned char *iv, EVP_CIPHER_CTX *ctx,
+			     HMAC_CTX *hctx, int enc)
+#endif /* OpenSSL 3.0 */
+{
+	struct tls_connection *conn = SSL_get_app_data(s);
+	struct tls_ticket_key keys[2], *key = NULL;
+	int ret = -1;
+
+	if (!conn ||
+	    tls_session_cache_ticket_keys(conn->data->session_cache,
+					  conn->data->tls_session_lifetime,
+					  keys) < 0)
+		return -1;
+
+	if (enc) {
+		key = &keys[0];
+		os_memcpy(key_name, key->name, TLS_TICKET_KEY_NAME_LEN);
+		if (os_get_random(iv, 16) < 0 ||
+		    EVP_EncryptInit_ex(ctx, EVP_aes_256_cbc(), NULL,
+				       key->aes_key, iv) != 1 ||
+		    tls_ticket_hmac_init(hctx, key) < 0)
+			goto out;
+		ret = 1;
+		goto out;
+	}
+
+	if (os_memcmp(key_name, keys[0].name, TLS_TICKET_KEY_NAME_LEN) == 0)
+		key = &keys[0];
+	else if (keys[1].created &&
+		 os_memcmp(key_name, keys[1].name,
+			   TLS_TICKET_KEY_NAME_LEN) == 0)
+		key = &keys[1];
+	if (!key) {
+		/* Unknown or expired key - do a full handshake */
+		ret = 0;
+		goto out;
+	}
+	if (EVP_DecryptInit_ex(ctx, EVP_aes_256_cbc(), NULL, key->aes_key,
+			       iv) != 1 ||
+	    tls_ticket_hmac_init(hctx, key) < 0)
+		goto out;
+	/* Ask for a new ticket if the previous key was used */
+	ret = key == &keys[0] ? 1 : 2;
+out:
+	forced_memzero(keys, sizeof(keys));
+	return ret;
+}
+
+
+static int tls_shared_cache_init(struct tls_data *data,
+				 const struct tls_config *conf)
+{
+	SSL_CTX *ssl = data->ssl;
+
+	data->session_cache = tls_session_cache_open(
+		conf->tls_session_cache, conf->tls_session_cache_size);
+	if (!data->session_cache)
+		return -1;
+
+	SSL_CTX_sess_set_get_cb(ssl, tls_shared_cache_get_cb);
+	SSL_CTX_set_session_ticket_cb(ssl, tls_ticket_gen_cb,
+				      tls_ticket_dec_cb, data);
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+	SSL_CTX_set_tlsext_ticket_key_evp_cb(ssl, tls_ticket_key_cb);
+#else /* OpenSSL 3.0 */
+	SSL_CTX_set_tlsext_ticket_key_cb(ssl, tls_ticket_key_cb);
+#endif /* OpenSSL 3.0 */
+
+	wpa_printf(MSG_DEBUG, "OpenSSL: Using shared session cache %s",
+		   conf->tls_session_cache);
+	return 0;
+}
+
+#endif /* TLS_SHARED_SESSION_CACHE */
+
+
+#ifndef OPENSSL_NO_STDIO
+static int tls_passwd_cb(char *buf, int size, int rwflag, void *password)
+{
+	if (!password)
+		return 0;
+	os_strlcpy(buf, (const char *) password, size);
+	return os_strlen(buf);
+}
+
+
+static EVP_PKEY * tls_read_private_key_file(const char *private_key,
+					    const char *private_key_passwd)
+{
+	BIO *bio;
+	EVP_PKEY *pkey;
+
+	/* First try ASN.1 (DER). */
+	bio = BIO_new_file(private_key, "r");
+	if (!bio)
+		return NULL;
+	pkey = d2i_PrivateKey_bio(bio, NULL);
+	BIO_free(bio);
+
+	if (pkey) {
+		wpa_printf(MSG_DEBUG, "OpenSSL: %s (DER) --> loaded", __func__);
+		return pkey;
+	}
+
+	/* Try PEM with the provided password. */
+	bio = BIO_new_file(private_key, "r");
+	if (!bio)
+		return NULL;
+	pkey = PEM_read_bio_PrivateKey(bio, NULL, tls_passwd_cb,
+				       (void *) private_key_passwd);
+	BIO_free(bio);
+	if (!pkey)
+		return NULL;
+	wpa_printf(MSG_DEBUG, "OpenSSL: %s (PEM) --> loaded", __func__);
+	/* Clear errors from the previous failed load. */
+	ERR_clear_error();
+	return pkey;
+}
+#endif /* OPENSSL_NO_STDIO */
+
+
+#ifdef TLS_CRED_CACHE
+
+/*
+ * Process-wide cache of parsed credential files (CA certificates, own
+ * certificate chains, and private keys) shared by all TLS contexts. Entries
+ * are found by file name and validated against the file metadata, so a
+ * modified file is parsed again. The cached OpenSSL objects are reference
+ * counted, so contexts and connections that use them are not affected when an
+ * entry is replaced or removed.
+ */
+
+/* Maximum number of cached credential files */
+#define TLS_CRED_CACHE_MAX 32
+
+enum tls_cred_type {
+	TLS_CRED_CA,
+	TLS_CRED_CERT,
+	TLS_CRED_KEY,
+};
+
+struct tls_cred {
+	struct dl_list list; /* most recently used first */
+	enum tls_cred_type type;
+	char *fname;
+	/* SHA256 of the password for private keys */
+	u8 passwd_hash[SHA256_MAC_LEN];
+	unsigned int id;
+	dev_t dev;
+	ino_t ino;
+	time_t mtime;
+	off_t size;
+	STACK_OF(X509) *certs; /* CA certificates or own certificate + chain */
+	STACK_OF(X509_CRL) *crls;
+	EVP_PKEY *key;
+};
+
+static struct dl_list tls_creds = DL_LIST_HEAD_INIT(tls_creds);
+static unsigned int tls_cred_next_id;
+static struct tls_cert_cache_stats tls_cred_stats;
+
+
+static unsigned int tls_cred_new_id(void)
+{
+	tls_cred_next_id++;
+	if (tls_cred_next_id == 0)
+		tls_cred_next_id++;
+	return tls_cred_next_id;
+}
+
+
+static void tls_cred_free(struct tls_cred *cred)
+{
+	sk_X509_pop_free(cred->certs, X509_free);
+	sk_X509_CRL_pop_free(cred->crls, X509_CRL_free);
+	EVP_PKEY_free(cred->key);
+	os_free(cred->fname);
+	os_free(cred);
+}
+
+
+static void tls_cred_remove(struct tls_cred *cred)
+{
+	dl_list_del(&cred->list);
+	tls_cred_stats.cred_entries--;
+	tls_cred_free(cred);
+}
+
+
+static void tls_cred_flush(void)
+{
+	struct tls_cred *cred, *tmp;
+
+	dl_list_for_each_safe(cred, tmp, &tls_creds, struct tls_cred, list)
+		tls_cred_remove(cred);
+}
+
+
+static int tls_cred_load_ca(struct tls_cred *cred)
+{
+	STACK_OF(X509_INFO) *infos;
+	X509_INFO *info;
+	X509 *cert;
+	BIO *bio;
+	int i, ret = -1;
+
+	bio = BIO_new_file(cred->fname, "r");
+	cred->certs = sk_X509_new_null();
+	cred->crls = sk_X509_CRL_new_null();
+	if (!bio || !cred->certs || !cred->crls)
+		goto out;
+
+	/* Certificates and CRLs in PEM format like
+	 * SSL_CTX_load_verify_locations() or a single DER certificate */
+	infos = PEM_X509_INFO_read_bio(bio, NULL, NULL, NULL);
+	for (i = 0; infos && i < sk_X509_INFO_num(infos); i++) {
+		info = sk_X509_INFO_value(infos, i);
+		if (info->x509 && sk_X509_push(cred->certs, info->x509))
+			info->x509 = NULL;
+		if (info->crl && sk_X509_CRL_push(cred->crls, info->crl))
+			info->crl = NULL;
+	}
+	sk_X509_INFO_pop_free(infos, X509_INFO_free);
+
+	if (sk_X509_num(cred->certs) == 0 && sk_X509_CRL_num(cred->crls) == 0 &&
+	    BIO_reset(bio) == 0) {
+		cert = d2i_X509_bio(bio, NULL);
+		if (cert && !sk_X509_push(cred->certs, cert))
+			X509_free(cert);
+	}
+	ERR_clear_error();
+
+	if (sk_X509_num(cred->certs) > 0 || sk_X509_CRL_num(cred->crls) > 0)
+		ret = 0;
+out:
+	BIO_free(bio);
+	return ret;
+}
+
+
+static int tls_cred_load_cert(struct tls_cred *cred)
+{
+	X509 *cert;
+	BIO *bio;
+	int ret = -1;
+
+	bio = BIO_new_file(cred->fname, "r");
+	cred->certs = sk_X509_new_null();
+	if (!bio || !cred->certs)
+		goto out;
+
+	/* DER encoded certificate or a PEM encoded certificate followed by
+	 * the chain like SSL_use_certificate_chain_file() */
+	cert = d2i_X509_bio(bio, NULL);
+	if (!cert && BIO_reset(bio) == 0)
+		cert = PEM_read_bio_X509_AUX(bio, NULL, NULL, NULL);
+	while (cert) {
+		if (!sk_X509_push(cred->certs, cert)) {
+			X509_free(cert);
+			goto out;
+		}
+		cert = PEM_read_bio_X509(bio, NULL, NULL, NULL);
+	}
+	ERR_clear_error();
+
+	if (sk_X509_num(cred->certs) > 0)
+		ret = 0;
+out:
+	BIO_free(bio);
+	return ret;
+}
+
+
+static struct tls_cred * tls_cred_get(enum tls_cred_type type,
+				      const char *fname, const char *passwd)
+{
+	struct tls_cred *cred;
+	struct stat st;
+	u8 hash[SHA256_MAC_LEN];
+	const u8 *addr[1];
+	size_t len[1];
+	int reload = 0, res = -1;
+
+	if (stat(fname, &st) != 0 || !S_ISREG(st.st_mode))
+		return NULL;
+
+	os_memset(hash, 0, sizeof(hash));
+	if (type == TLS_CRED_KEY && passwd) {
+		addr[0] = (const u8 *) passwd;
+		len[0] = os_strlen(passwd);
+		if (sha256_vector(1, addr, len, hash) < 0)
+			return NULL;
+	}
+
+	dl_list_for_each(cred, &tls_creds, struct tls_cred, list) {
+		if (cred->type != type || os_strcmp(cred->fname, fname) != 0 ||
+		    os_memcmp_const(cred->passwd_hash, hash, sizeof(hash)) != 0)
+			continue;
+		if (cred->dev == st.st_dev && cred->ino == st.st_ino &&
+		    cred->mtime == st.st_mtime && cred->size == st.st_size) {
+			dl_list_del(&cred->list);
+			dl_list_add(&tls_creds, &cred->list);
+			tls_cred_stats.cred_hits++;
+			return cred;
+		}
+		wpa_printf(MSG_DEBUG, "OpenSSL: Credential file %s changed",
+			   fname);
+		tls_cred_remove(cred);
+		reload = 1;
+		break;
+	}
+
+	cred = os_zalloc(sizeof(*cred));
+	if (!cred)
+		return NULL;
+	cred->type = type;
+	cred->fname = os_strdup(fname);
+	if (!cred->fname) {
+		os_free(cred);
+		return NULL;
+	}
+
+	switch (type) {
+	case TLS_CRED_CA:
+		res = tls_cred_load_ca(cred);
+		break;
+	case TLS_CRED_CERT:
+		res = tls_cred_load_cert(cred);
+		break;
+	case TLS_CRED_KEY:
+		cred->key = tls_read_private_key_file(fname, passwd);
+		res = cred->key ? 0 : -1;
+		break;
+	}
+	if (res < 0) {
+		/* Leave the errors for the uncached fallback to report */
+		ERR_clear_error();
+		tls_cred_free(cred);
+		return NULL;
+	}
+
+	cred->id = tls_cred_new_id();
+	os_memcpy(cred->passwd_hash, hash, sizeof(hash));
+	cred->dev = st.st_dev;
+	cred->ino = st.st_ino;
+	cred->mtime = st.st_mtime;
+	cred->size = st.st_size;
+	dl_list_add(&tls_creds, &cred->list);
+	tls_cred_stats.cred_entries++;
+	if (reload)
+		tls_cred_stats.cred_reloads++;
+	else
+		tls_cred_stats.cred_misses++;
+	if (tls_cred_stats.cred_entries > TLS_CRED_CACHE_MAX)
+		tls_cred_remove(dl_list_last(&tls_creds, struct tls_cred,
+					     list));
+	wpa_printf(MSG_DEBUG, "OpenSSL: Cached credential file %s", fname);
+
+	return cred;
+}
+
+
+static int tls_cred_name_cmp(const X509_NAME * const *a,
+			     const X509_NAME * const *b)
+{
+	return X509_NAME_cmp(*a, *b);
+}
+
+
+/* Add cached CA certificates and CRLs to the certificate store of ssl_ctx */
+static int tls_cred_add_ca(SSL_CTX *ssl_ctx, const char *ca_cert,
+			   int client_ca_list, unsigned int *id)
+{
+	struct tls_cred *cred;
+	X509_STORE *store = SSL_CTX_get_cert_store(ssl_ctx);
+	STACK_OF(X509_NAME) *names = NULL;
+	X509_NAME *name;
+	X509 *cert;
+	int i;
+
+	cred = tls_cred_get(TLS_CRED_CA, ca_cert, NULL);
+	if (!cred)
+		return -1;
+
+	for (i = 0; i < sk_X509_num(cred->certs); i++) {
+		if (X509_STORE_add_cert(store,
+					sk_X509_value(cred->certs, i)) != 1)
+			return -1;
+	}
+	for (i = 0; i < sk_X509_CRL_num(cred->crls); i++) {
+		if (X509_STORE_add_crl(store,
+				       sk_X509_CRL_value(cred->crls, i)) != 1)
+			return -1;
+	}
+
+	if (client_ca_list) {
+		/* Same as SSL_load_client_CA_file() */
+		names = sk_X509_NAME_new(tls_cred_name_cmp);
+		if (!names)
+			return -1;
+		for (i = 0; i < sk_X509_num(cred->certs); i++) {
+			cert = sk_X509_value(cred->certs, i);
+			if (sk_X509_NAME_find(names,
+					      X509_get_subject_name(cert)) >= 0)
+				continue;
+			name = X509_NAME_dup(X509_get_subject_name(cert));
+			if (!name || !sk_X509_NAME_push(names, name)) {
+				X509_NAME_free(name);
+				sk_X509_NAME_pop_free(names, X509_NAME_free);
+				return -1;
+			}
+		}
+		SSL_CTX_set_client_CA_list(ssl_ctx, names);
+	}
+
+	wpa_printf(MSG_DEBUG,
+		   "TLS: Trusted root certificate(s) loaded from cache");
+	*id = cred->id;
+	return 0;
+}
+
+
+static int tls_cred_use_cert(SSL *ssl, SSL_CTX *ssl_ctx, const char *fname)
+{
+	struct tls_cred *cred;
+	STACK_OF(X509) *chain;
+	X509 *cert;
+	int i, ret;
+
+	cred = tls_cred_get(TLS_CRED_CERT, fname, NULL);
+	if (!cred)
+		return -1;
+
+	cert = sk_X509_value(cred->certs, 0);
+	chain = sk_X509_new_null();
+	if (!chain)
+		return -1;
+	for (i = 1; i < sk_X509_num(cred->certs); i++) {
+		if (!sk_X509_push(chain, sk_X509_value(cred->certs, i))) {
+			sk_X509_free(chain);
+			return -1;
+		}
+	}
+
+	if (ssl)
+		ret = SSL_use_certificate(ssl, cert) == 1 &&
+			SSL_set1_chain(ssl, chain) == 1;
+	else
+		ret = SSL_CTX_use_certificate(ssl_ctx, cert) == 1 &&
+			SSL_CTX_set1_chain(ssl_ctx, chain) == 1;
+	sk_X509_free(chain);
+	if (!ret)
+		return -1;
+
+	wpa_printf(MSG_DEBUG,
+		   "OpenSSL: Certificate chain (%d) loaded from cache",
+		   sk_X509_num(cred->certs));
+	return 0;
+}
+
+
+/*
+ * Optional per-context cache of successful peer certificate chain
+ * verifications. The lookup key covers the peer certificate and the
+ * intermediate certificates it sent, the trusted CA set, and the verification
+ * parameters. A cached result is used for at most the configured lifetime and
+ * never beyond the expiration of a certificate in the verified chain or the
+ * next update of a CRL when CRL checking is enabled. The verify callback is
+ * still called for each certificate of the chain, so the configured subject
+ * and domain constraints and certificate events are handled as in a full
+ * verification.
+ */
+
+#define TLS_VERIFY_CACHE_HASH_SIZE 256
+
+/* Maximum number of certificates sent by the peer for cached results */
+#define TLS_VERIFY_CACHE_MAX_CHAIN 10
+
+struct tls_verify_entry {
+	struct tls_verify_entry *hnext;
+	struct dl_list list; /* ordered by expiration */
+	u8 key[SHA256_MAC_LEN];
+	struct os_reltime expire;
+	STACK_OF(X509) *chain; /* verified chain including the trust anchor */
+};
+
+struct tls_verify_cache {
+	struct tls_verify_entry *hash[TLS_VERIFY_CACHE_HASH_SIZE];
+	struct dl_list list;
+	unsigned int size;
+	unsigned int lifetime;
+	struct tls_cert_cache_stats stats;
+};
+
+
+static struct tls_verify_cache * tls_verify_cache_init(unsigned int size,
+						       unsigned int lifetime)
+{
+	struct tls_verify_cache *cache;
+
+	cache = os_zalloc(sizeof(*cache));
+	if (!cache)
+		return NULL;
+	dl_list_init(&cache->list);
+	cache->size = size;
+	cache->lifetime = lifetime;
+	return cache;
+}
+
+
+static void tls_verify_cache_remove(struct tls_verify_cache *cache,
+				    struct tls_verify_entry *entry)
+{
+	struct tls_verify_entry **pos;
+
+	for (pos = &cache->hash[entry->key[0]]; *pos; pos = &(*pos)->hnext) {
+		if (*pos == entry) {
+			*pos = entry->hnext;
+			break;
+		}
+	}
+	dl_list_del(&entry->list);
+	cache->stats.verify_entries--;
+	sk_X509_pop_free(entry->chain, X509_free);
+	os_free(entry);
+}
+
+
+static void tls_verify_cache_deinit(struct tls_verify_cache *cache)
+{
+	struct tls_verify_entry *entry, *tmp;
+
+	if (!cache)
+		return;
+	dl_list_for_each_safe(entry, tmp, &cache->list,
+			      struct tls_verify_entry, list)
+		tls_verify_cache_remove(cache, entry);
+	os_free(cache);
+}
+
+
+static int tls_verify_cache_key(struct tls_data *data, SSL *ssl,
+				X509_STORE_CTX *ctx, u8 *key)
+{
+	STACK_OF(X509) *untrusted = X509_STORE_CTX_get0_untrusted(ctx);
+	X509_VERIFY_PARAM *param = X509_STORE_CTX_get0_param(ctx);
+	u8 hdr[16], md[TLS_VERIFY_CACHE_MAX_CHAIN + 1][SHA256_MAC_LEN];
+	const u8 *addr[TLS_VERIFY_CACHE_MAX_CHAIN + 2];
+	size_t len[TLS_VERIFY_CACHE_MAX_CHAIN + 2];
+	X509 *cert = X509_STORE_CTX_get0_cert(ctx);
+	unsigned int md_len;
+	int i, num = 0;
+
+	if (!data->ca_set_id || !cert ||
+	    sk_X509_num(untrusted) > TLS_VERIFY_CACHE_MAX_CHAIN)
+		return -1;
+
+	WPA_PUT_BE32(hdr, data->ca_set_id);
+	WPA_PUT_BE32(&hdr[4], X509_VERIFY_PARAM_get_flags(param));
+	WPA_PUT_BE32(&hdr[8], X509_VERIFY_PARAM_get_depth(param));
+	WPA_PUT_BE32(&hdr[12], SSL_is_server(ssl));
+	addr[0] = hdr;
+	len[0] = sizeof(hdr);
+
+	/* The peer certificate followed by the other certificates it sent
+	 * (which may include the peer certificate again) */
+	for (i = -1; i < sk_X509_num(untrusted); i++) {
+		if (X509_digest(i < 0 ? cert : sk_X509_value(untrusted, i),
+				EVP_sha256(), md[num], &md_len) != 1 ||
+		    md_len != SHA256_MAC_LEN)
+			return -1;
+		addr[num + 1] = md[num];
+		len[num + 1] = SHA256_MAC_LEN;
+		num++;
+	}
+
+	return sha256_vector(num + 1, addr, len, key);
+}
+
+
+static int tls_verify_cache_limit(long *lifetime, const ASN1_TIME *t)
+{
+	int days, secs;
+
+	if (!ASN1_TIME_diff(&days, &secs, NULL, t) || days < 0 || secs < 0)
+		return -1;
+	/* Compare the days first since days * 86400 does not fit in a 32-bit
+	 * long for times more than about 68 years in the future */
+	if (days <= *lifetime / 86400 && days * 86400L + secs < *lifetime)
+		*lifetime = days * 86400L + secs;
+	return 0;
+}
+
+
+static void tls_verify_cache_add(struct tls_verify_cache *cache,
+				 X509_STORE_CTX *ctx, const u8 *key)
 {
-	char *engine_id = "pkcs11";
-	const char *pre_cmd[] = {
-		"SO_PATH", NULL /* pkcs11_so_path */,
-		"ID", NULL /* engine_id */,
-		"LIST_ADD", "1",
-		/* "NO_VCHECK", "1", */
-		"LOAD", NULL,
-		NULL, NULL
-	};
-	const char *post_cmd[] = {
-		"MODULE_PATH", NULL /* pkcs11_module_path */,
-		NULL, NULL
-	};
+	STACK_OF(X509) *chain = X509_STORE_CTX_get0_chain(ctx);
+	struct tls_verify_entry *entry, *pos;
+	STACK_OF(X509_OBJECT) *objs;
+	X509_OBJECT *obj;
+	const ASN1_TIME *t;
+	long lifetime = cache->lifetime;
+	int i;
 
-	if (!pkcs11_so_path)
-		return 0;
+	/* Limit the lifetime to the validity of the chain and the CRLs */
+	for (i = 0; i < sk_X509_num(chain); i++) {
+		t = X509_get0_notAfter(sk_X509_value(chain, i));
+		if (tls_verify_cache_limit(&lifetime, t) < 0)
+			return;
+	}
+	if (X509_VERIFY_PARAM_get_flags(X509_STORE_CTX_get0_param(ctx)) &
+	    X509_V_FLAG_CRL_CHECK) {
+		objs = X509_STORE_get0_objects(X509_STORE_CTX_get0_store(ctx));
+		for (i = 0; i < sk_X509_OBJECT_num(objs); i++) {
+			obj = sk_X509_OBJECT_value(objs, i);
+			if (X509_OBJECT_get_type(obj) != X509_LU_CRL)
+				continue;
+			t = X509_CRL_get0_nextUpdate(
+				X509_OBJECT_get0_X509_CRL(obj));
+			if (!t)
+				continue;
+			if (tls_verify_cache_limit(&lifetime, t) < 0)
+				return;
+		}
+	}
+	if (lifetime <= 0)
+		return;
 
-	pre_cmd[1] = pkcs11_so_path;
-	pre_cmd[3] = engine_id;
-	if (pkcs11_module_path)
-		post_cmd[1] = pkcs11_module_path;
-	else
-		post_cmd[0] = NULL;
+	if (cache->stats.verify_entries >= cache->size)
+		tls_verify_cache_remove(cache,
+					dl_list_first(&cache->list,
+						      struct tls_verify_entry,
+						      list));
 
-	wpa_printf(MSG_DEBUG, "ENGINE: Loading pkcs11 Engine from %s",
-		   pkcs11_so_path);
+	entry = os_zalloc(sizeof(*entry));
+	if (!entry)
+		return;
+	entry->chain = X509_chain_up_ref(chain);
+	if (!entry->chain) {
+		os_free(entry);
+		return;
+	}
+	os_memcpy(entry->key, key, SHA256_MAC_LEN);
+	os_get_reltime(&entry->expire);
+	entry->expire.sec += lifetime;
 
-	return tls_engine_load_dynamic_generic(pre_cmd, post_cmd, engine_id);
+	dl_list_for_each_reverse(pos, &cache->list, struct tls_verify_entry,
+				 list) {
+		if (!os_reltime_before(&entry->expire, &pos->expire))
+			break;
+	}
+	dl_list_add(&pos->list, &entry->list);
+	entry->hnext = cache->hash[key[0]];
+	cache->hash[key[0]] = entry;
+	cache->stats.verify_entries++;
+	cache->stats.verify_stores++;
 }
 
 
-/**
- * tls_engine_load_dynamic_opensc - load the opensc engine provided by opensc
- * @opensc_so_path: opensc_so_path from the configuration
- */
-static int tls_engine_load_dynamic_opensc(const char *opensc_so_path)
+static int tls_verify_cache_replay(X509_STORE_CTX *ctx,
+				   STACK_OF(X509) *chain)
 {
-	char *engine_id = "opensc";
-	const char *pre_cmd[] = {
-		"SO_PATH", NULL /* opensc_so_path */,
-		"ID", NULL /* engine_id */,
-		"LIST_ADD", "1",
-		"LOAD", NULL,
-		NULL, NULL
-	};
-
-	if (!opensc_so_path)
-		return 0;
-
-	pre_cmd[1] = opensc_so_path;
-	pre_cmd[3] = engine_id;
+	int (*verify_cb)(int ok, X509_STORE_CTX *ctx);
+	STACK_OF(X509) *verified;
+	int i;
 
-	wpa_printf(MSG_DEBUG, "ENGINE: Loading OpenSC Engine from %s",
-		   opensc_so_path);
+	verified = X509_chain_up_ref(chain);
+	if (!verified)
+		return X509_verify_cert(ctx);
+	X509_STORE_CTX_set0_verified_chain(ctx, verified);
+
+	/* Call the verify callback from the trust anchor to the peer
+	 * certificate like a full verification does */
+	verify_cb = X509_STORE_CTX_get_verify_cb(ctx);
+	for (i = sk_X509_num(verified) - 1; i >= 0; i--) {
+		X509_STORE_CTX_set_error_depth(ctx, i);
+		X509_STORE_CTX_set_current_cert(ctx,
+						sk_X509_value(verified, i));
+		X509_STORE_CTX_set_error(ctx, X509_V_OK);
+		if (verify_cb && !verify_cb(1, ctx)) {
+			if (X509_STORE_CTX_get_error(ctx) == X509_V_OK)
+				X509_STORE_CTX_set_error(
+					ctx, X509_V_ERR_APPLICATION_VERIFICATION);
+			return 0;
+		}
+	}
 
-	return tls_engine_load_dynamic_generic(pre_cmd, NULL, engine_id);
+	return 1;
 }
-#endif /* OPENSSL_NO_ENGINE */
 
 
-static void remove_session_cb(SSL_CTX *ctx, SSL_SESSION *sess)
+static int tls_verify_cache_cb(X509_STORE_CTX *ctx, void *arg)
 {
-	struct wpabuf *buf;
+	struct tls_data *data = arg;
+	struct tls_verify_cache *cache = data->verify_cache;
+	struct tls_verify_entry *entry;
+	struct os_reltime now;
+	u8 key[SHA256_MAC_LEN];
+	SSL *ssl;
+	int ret;
 
-	if (tls_ex_idx_session < 0)
-		return;
-	buf = SSL_SESSION_get_ex_data(sess, tls_ex_idx_session);
-	if (!buf)
-		return;
-	wpa_printf(MSG_DEBUG,
-		   "OpenSSL: Free application session data %p (sess %p)",
-		   buf, sess);
-	wpabuf_free(buf);
+	ssl = X509_STORE_CTX_get_ex_data(ctx,
+					 SSL_get_ex_data_X509_STORE_CTX_idx());
+	if (!ssl || tls_verify_cache_key(data, ssl, ctx, key) < 0)
+		return X509_verify_cert(ctx);
 
-	SSL_SESSION_set_ex_data(sess, tls_ex_idx_session, NULL);
+	for (entry = cache->hash[key[0]]; entry; entry = entry->hnext) {
+		if (os_memcmp(entry->key, key, SHA256_MAC_LEN) == 0)
+			break;
+	}
+	if (entry) {
+		os_get_reltime(&now);
+		if (os_reltime_before(&entry->expire, &now)) {
+			cache->stats.verify_expired++;
+			tls_verify_cache_remove(cache, entry);
+		} else {
+			cache->stats.verify_hits++;
+			wpa_printf(MSG_DEBUG,
+				   "OpenSSL: Peer certificate chain found in verification cache");
+			return tls_verify_cache_replay(ctx, entry->chain);
+		}
+	}
+
+	cache->stats.verify_misses++;
+	ret = X509_verify_cert(ctx);
+	/* Do not cache results where the verify callback accepted an error,
+	 * e.g., with TLS_CONN_DISABLE_TIME_CHECKS */
+	if (ret == 1 && X509_STORE_CTX_get_error(ctx) == X509_V_OK)
+		tls_verify_cache_add(cache, ctx, key);
+	return ret;
 }
 
+#endif /* TLS_CRED_CACHE */
+
 
 void * tls_init(const struct tls_config *conf)
 {
@@ -1084,6 +2155,40 @@ void * tls_init(const struct tls_config *conf)
 		}
 	}
 
+	if (conf && conf->tls_session_cache) {
+#ifdef TLS_SHARED_SESSION_CACHE
+		if (data->tls_session_lifetime == 0) {
+			wpa_printf(MSG_INFO,
+				   "OpenSSL: Shared session cache not used since session resumption is disabled");
+		} else if (tls_shared_cache_init(data, conf) < 0) {
+			tls_deinit(data);
+			return NULL;
+		}
+#else /* TLS_SHARED_SESSION_CACHE */
+		wpa_printf(MSG_ERROR,
+			   "OpenSSL: Shared session cache not supported in this build");
+		tls_deinit(data);
+		return NULL;
+#endif /* TLS_SHARED_SESSION_CACHE */
+	}
+
+	if (conf && conf->tls_verify_cache_size) {
+#ifdef TLS_CRED_CACHE
+		data->verify_cache = tls_verify_cache_init(
+			conf->tls_verify_cache_size,
+			conf->tls_verify_cache_lifetime);
+		if (!data->verify_cache) {
+			tls_deinit(data);
+			return NULL;
+		}
+		SSL_CTX_set_cert_verify_callback(ssl, tls_verify_cache_cb,
+						 data);
+#else /* TLS_CRED_CACHE */
+		wpa_printf(MSG_INFO,
+			   "OpenSSL: Certificate verification cache not supported in this build");
+#endif /* TLS_CRED_CACHE */
+	}
+
 #ifndef OPENSSL_NO_ENGINE
 	wpa_printf(MSG_DEBUG, "ENGINE: Loading builtin engines");
 	ENGINE_load_builtin_engines();
@@ -1116,16 +2221,54 @@ void * tls_init(const struct tls_config *conf)
 }
 
 
+#ifdef HAVE_OCSP
+
+static void tls_ocsp_resp_clear(struct tls_ocsp_resp *resp)
+{
+	OCSP_BASICRESP_free(resp->basic);
+	resp->basic = NULL;
+	resp->serial = NULL;
+	resp->next_update = NULL;
+	os_free(resp->der);
+	resp->der = NULL;
+	resp->der_len = 0;
+}
+
+
+static void tls_ocsp_resp_free(struct tls_ocsp_resp *resp)
+{
+	tls_ocsp_resp_clear(resp);
+	os_free(resp->fname);
+	os_memset(resp, 0, sizeof(*resp));
+}
+
+#endif /* HAVE_OCSP */
+
+
 void tls_deinit(void *ssl_ctx)
 {
 	struct tls_data *data = ssl_ctx;
 	SSL_CTX *ssl = data->ssl;
 	struct tls_context *context = SSL_CTX_get_app_data(ssl);
+#ifdef HAVE_OCSP
+	int i;
+#endif /* HAVE_OCSP */
+
 	if (context != tls_global)
 		os_free(context);
 	if (data->tls_session_lifetime > 0)
 		SSL_CTX_flush_sessions(ssl, 0);
 	os_free(data->ca_cert);
+#ifdef HAVE_OCSP
+	for (i = 0; i < TLS_OCSP_MAX_RESP; i++)
+		tls_ocsp_resp_free(&data->ocsp_resp[i]);
+#endif /* HAVE_OCSP */
+#ifdef TLS_SHARED_SESSION_CACHE
+	tls_session_cache_close(data->session_cache);
+#endif /* TLS_SHARED_SESSION_CACHE */
+#ifdef TLS_CRED_CACHE
+	tls_verify_cache_deinit(data->verify_cache);
+#endif /* TLS_CRED_CACHE */
 	SSL_CTX_free(ssl);
 
 	tls_openssl_ref_count--;
@@ -1141,8 +2284,9 @@ void tls_deinit(void *ssl_ctx)
 		ERR_free_strings();
 		EVP_cleanup();
 #endif /* < 1.1.0 */
-		os_free(tls_global->ocsp_stapling_response);
-		tls_global->ocsp_stapling_response = NULL;
+#ifdef TLS_CRED_CACHE
+		tls_cred_flush();
+#endif /* TLS_CRED_CACHE */
 		os_free(tls_global);
 		tls_global = NULL;
 	}
@@ -1327,6 +2471,46 @@ int tls_get_errors(void *ssl_ctx)
 }
 
 
+int tls_get_session_stats(void *tls_ctx, struct tls_session_stats *stats)
+{
+	struct tls_data *data = tls_ctx;
+
+#ifdef TLS_SHARED_SESSION_CACHE
+	*stats = data->stats;
+#else /* TLS_SHARED_SESSION_CACHE */
+	os_memset(stats, 0, sizeof(*stats));
+#endif /* TLS_SHARED_SESSION_CACHE */
+	stats->resumed = SSL_CTX_sess_hits(data->ssl);
+	stats->misses = SSL_CTX_sess_misses(data->ssl);
+	stats->timeouts = SSL_CTX_sess_timeouts(data->ssl);
+	return 0;
+}
+
+
+int tls_get_cert_cache_stats(void *tls_ctx, struct tls_cert_cache_stats *stats)
+{
+#ifdef TLS_CRED_CACHE
+	struct tls_data *data = tls_ctx;
+
+	*stats = tls_cred_stats;
+	stats->verify_hits = stats->verify_misses = stats->verify_stores = 0;
+	stats->verify_expired = stats->verify_entries = 0;
+	if (data->verify_cache) {
+		stats->verify_hits = data->verify_cache->stats.verify_hits;
+		stats->verify_misses = data->verify_cache->stats.verify_misses;
+		stats->verify_stores = data->verify_cache->stats.verify_stores;
+		stats->verify_expired =
+			data->verify_cache->stats.verify_expired;
+		stats->verify_entries =
+			data->verify_cache->stats.verify_entries;
+	}
+	return 0;
+#else /* TLS_CRED_CACHE */
+	return -1;
+#endif /* TLS_CRED_CACHE */
+}
+
+
 static const char * openssl_content_type(int content_type)
 {
 	switch (content_type) {
@@ -1559,6 +2743,9 @@ struct tls_connection * tls_connection_init(void *ssl_ctx)
 			/* Replace old store */
 			SSL_CTX_set_cert_store(ssl, new_cert_store);
 			data->crl_last_reload = now;
+#ifdef TLS_CRED_CACHE
+			data->ca_set_id = tls_cred_new_id();
+#endif /* TLS_CRED_CACHE */
 		}
 	}
 
@@ -1636,6 +2823,9 @@ void tls_connection_deinit(void *ssl_ctx, struct tls_connection *conn)
 	os_free(conn->domain_match);
 	os_free(conn->check_cert_subject);
 	os_free(conn->session_ticket);
+#ifdef TLS_SHARED_SESSION_CACHE
+	wpabuf_free(conn->ticket_success_data);
+#endif /* TLS_SHARED_SESSION_CACHE */
 	os_free(conn->peer_subject);
 	os_free(conn);
 }
@@ -2648,6 +3838,9 @@ static int tls_connection_ca_cert(struct tls_data *data,
 		return -1;
 	}
 	SSL_CTX_set_cert_store(ssl_ctx, store);
+#ifdef TLS_CRED_CACHE
+	data->ca_set_id = 0;
+#endif /* TLS_CRED_CACHE */
 
 	SSL_set_verify(conn->ssl, SSL_VERIFY_PEER, tls_verify_cb);
 	conn->ca_cert_verify = 1;
@@ -2788,6 +3981,11 @@ static int tls_connection_ca_cert(struct tls_data *data,
 
 	if (ca_cert || ca_path) {
 #ifndef OPENSSL_NO_STDIO
+#ifdef TLS_CRED_CACHE
+		if (ca_cert && !ca_path &&
+		    tls_cred_add_ca(ssl_ctx, ca_cert, 0, &data->ca_set_id) == 0)
+			return 0;
+#endif /* TLS_CRED_CACHE */
 		if (SSL_CTX_load_verify_locations(ssl_ctx, ca_cert, ca_path) !=
 		    1) {
 			tls_show_errors(MSG_WARNING, __func__,
@@ -2824,6 +4022,11 @@ static int tls_global_ca_cert(struct tls_data *data, const char *ca_cert)
 	SSL_CTX *ssl_ctx = data->ssl;
 
 	if (ca_cert) {
+#ifdef TLS_CRED_CACHE
+		if (tls_cred_add_ca(ssl_ctx, ca_cert, 1, &data->ca_set_id) == 0)
+			goto loaded;
+		data->ca_set_id = tls_cred_new_id();
+#endif /* TLS_CRED_CACHE */
 		if (SSL_CTX_load_verify_locations(ssl_ctx, ca_cert, NULL) != 1)
 		{
 			tls_show_errors(MSG_WARNING, __func__,
@@ -2840,6 +4043,9 @@ static int tls_global_ca_cert(struct tls_data *data, const char *ca_cert)
 					   SSL_load_client_CA_file(ca_cert));
 #endif /* OPENSSL_NO_STDIO */
 
+#ifdef TLS_CRED_CACHE
+	loaded:
+#endif /* TLS_CRED_CACHE */
 		os_free(data->ca_cert);
 		data->ca_cert = os_strdup(ca_cert);
 	}
@@ -2993,6 +4199,12 @@ static int tls_set_conn_flags(struct tls_connection *conn, unsigned int flags,
 	else
 		SSL_clear_options(ssl, SSL_OP_NO_TLSv1_3);
 #endif /* SSL_OP_NO_TLSv1_3 */
+#ifdef SSL_OP_NO_TX_CERTIFICATE_COMPRESSION
+	if (flags & TLS_CONN_DISABLE_CERT_COMPRESSION)
+		SSL_set_options(ssl, SSL_OP_NO_TX_CERTIFICATE_COMPRESSION);
+	else
+		SSL_clear_options(ssl, SSL_OP_NO_TX_CERTIFICATE_COMPRESSION);
+#endif /* SSL_OP_NO_TX_CERTIFICATE_COMPRESSION */
 #if OPENSSL_VERSION_NUMBER >= 0x10100000L
 	if (flags & (TLS_CONN_ENABLE_TLSv1_0 |
 		     TLS_CONN_ENABLE_TLSv1_1 |
@@ -3225,6 +4437,16 @@ int tls_connection_set_verify(void *ssl_ctx, struct tls_connection *conn,
 		SSL_set_verify(conn->ssl, SSL_VERIFY_NONE, NULL);
 	}
 
+#ifdef TLS_SHARED_SESSION_CACHE
+	/*
+	 * The EAP server disables session tickets since a ticket cannot carry
+	 * the success data. With the shared cache, the data is found based on
+	 * the handle in the ticket, so tickets can be used for resumption.
+	 */
+	if (data->session_cache)
+		flags &= ~TLS_CONN_DISABLE_SESSION_TICKET;
+#endif /* TLS_SHARED_SESSION_CACHE */
+
 	if (tls_set_conn_flags(conn, flags, NULL) < 0)
 		return -1;
 	conn->flags = flags;
@@ -3340,6 +4562,10 @@ static int tls_connection_client_cert(struct tls_connection *conn,
 	}
 #endif /* ANDROID */
 
+#ifdef TLS_CRED_CACHE
+	if (tls_cred_use_cert(conn->ssl, NULL, client_cert) == 0)
+		return 0;
+#endif /* TLS_CRED_CACHE */
 #ifndef OPENSSL_NO_STDIO
 	if (SSL_use_certificate_file(conn->ssl, client_cert,
 				     SSL_FILETYPE_ASN1) == 1) {
@@ -3385,6 +4611,10 @@ static int tls_global_client_cert(struct tls_data *data,
 	if (client_cert == NULL)
 		return 0;
 
+#ifdef TLS_CRED_CACHE
+	if (tls_cred_use_cert(NULL, ssl_ctx, client_cert) == 0)
+		return 0;
+#endif /* TLS_CRED_CACHE */
 	if (SSL_CTX_use_certificate_file(ssl_ctx, client_cert,
 					 SSL_FILETYPE_ASN1) != 1 &&
 	    SSL_CTX_use_certificate_chain_file(ssl_ctx, client_cert) != 1 &&
@@ -3722,49 +4952,30 @@ static int tls_connection_engine_private_key(struct tls_connection *conn)
 }
 
 
-#ifndef OPENSSL_NO_STDIO
-static int tls_passwd_cb(char *buf, int size, int rwflag, void *password)
-{
-	if (!password)
-		return 0;
-	os_strlcpy(buf, (const char *) password, size);
-	return os_strlen(buf);
-}
-#endif /* OPENSSL_NO_STDIO */
-
-
 static int tls_use_private_key_file(struct tls_data *data, SSL *ssl,
 				    const char *private_key,
 				    const char *private_key_passwd)
 {
 #ifndef OPENSSL_NO_STDIO
-	BIO *bio;
 	EVP_PKEY *pkey;
 	int ret;
+#ifdef TLS_CRED_CACHE
+	struct tls_cred *cred;
 
-	/* First try ASN.1 (DER). */
-	bio = BIO_new_file(private_key, "r");
-	if (!bio)
-		return -1;
-	pkey = d2i_PrivateKey_bio(bio, NULL);
-	BIO_free(bio);
-
-	if (pkey) {
-		wpa_printf(MSG_DEBUG, "OpenSSL: %s (DER) --> loaded", __func__);
-	} else {
-		/* Try PEM with the provided password. */
-		bio = BIO_new_file(private_key, "r");
-		if (!bio)
-			return -1;
-		pkey = PEM_read_bio_PrivateKey(bio, NULL, tls_passwd_cb,
-					       (void *) private_key_passwd);
-		BIO_free(bio);
-		if (!pkey)
-			return -1;
-		wpa_printf(MSG_DEBUG, "OpenSSL: %s (PEM) --> loaded", __func__);
-		/* Clear errors from the previous failed load. */
-		ERR_clear_error();
+	cred = tls_cred_get(TLS_CRED_KEY, private_key, private_key_passwd);
+	if (cred) {
+		wpa_printf(MSG_DEBUG, "OpenSSL: Private key loaded from cache");
+		if (ssl)
+			ret = SSL_use_PrivateKey(ssl, cred->key);
+		else
+			ret = SSL_CTX_use_PrivateKey(data->ssl, cred->key);
+		return ret == 1 ? 0 : -1;
 	}
+#endif /* TLS_CRED_CACHE */
+
+	pkey = tls_read_private_key_file(private_key, private_key_passwd);
+	if (!pkey)
+		return -1;
 
 	if (ssl)
 		ret = SSL_use_PrivateKey(ssl, pkey);
@@ -4979,34 +6190,183 @@ static int ocsp_resp_cb(SSL *s, void *arg)
 }
 
 
+/* Find the certificate and the validity period of a cached OCSP response */
+static void tls_ocsp_resp_parse(struct tls_ocsp_resp *resp)
+{
+	const unsigned char *p = resp->der;
+	OCSP_RESPONSE *rsp;
+	OCSP_SINGLERESP *single;
+	ASN1_GENERALIZEDTIME *this_update = NULL, *next_update = NULL;
+	int status, reason;
+
+	rsp = d2i_OCSP_RESPONSE(NULL, &p, resp->der_len);
+	if (!rsp) {
+		wpa_printf(MSG_INFO,
+			   "OpenSSL: Could not parse cached OCSP response %s",
+			   resp->fname);
+		return;
+	}
+
+	status = OCSP_response_status(rsp);
+	if (status != OCSP_RESPONSE_STATUS_SUCCESSFUL) {
+		wpa_printf(MSG_INFO,
+			   "OpenSSL: Cached OCSP response %s: responder error %d (%s)",
+			   resp->fname, status,
+			   OCSP_response_status_str(status));
+		OCSP_RESPONSE_free(rsp);
+		return;
+	}
+
+	resp->basic = OCSP_response_get1_basic(rsp);
+	OCSP_RESPONSE_free(rsp);
+	single = resp->basic ? OCSP_resp_get0(resp->basic, 0) : NULL;
+	if (!single) {
+		wpa_printf(MSG_INFO,
+			   "OpenSSL: No certificate status in cached OCSP response %s",
+			   resp->fname);
+		OCSP_BASICRESP_free(resp->basic);
+		resp->basic = NULL;
+		return;
+	}
+
+	status = OCSP_single_get0_status(single, &reason, NULL, &this_update,
+					 &next_update);
+	if (!OCSP_check_validity(this_update, next_update, 5 * 60, -1))
+		tls_show_errors(MSG_INFO, __func__,
+				"OpenSSL: Cached OCSP response not valid at this time");
+	resp->next_update = next_update;
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L && \
+	(!defined(LIBRESSL_VERSION_NUMBER) || \
+	 LIBRESSL_VERSION_NUMBER >= 0x20700000L)
+	OCSP_id_get0_info(NULL, NULL, NULL, &resp->serial,
+			  (OCSP_CERTID *) OCSP_SINGLERESP_get0_id(single));
+#endif
+
+	wpa_printf(MSG_DEBUG,
+		   "OpenSSL: Loaded cached OCSP response %s (certificate status: %s)",
+		   resp->fname, OCSP_cert_status_str(status));
+}
+
+
+/* Reload a cached OCSP response if the file has been replaced or modified
+ * since the previous check */
+static void tls_ocsp_resp_check(struct tls_ocsp_resp *resp)
+{
+	struct os_reltime now;
+	struct stat st;
+	char *buf;
+	size_t len;
+
+	os_get_reltime(&now);
+	if (resp->last_check.sec &&
+	    !os_reltime_expired(&now, &resp->last_check,
+				TLS_OCSP_RESP_CHECK_INTERVAL))
+		return;
+	resp->last_check = now;
+
+	if (stat(resp->fname, &st) != 0) {
+		if (resp->der)
+			wpa_printf(MSG_INFO,
+				   "OpenSSL: OCSP response file %s removed",
+				   resp->fname);
+		tls_ocsp_resp_clear(resp);
+		return;
+	}
+	if (resp->der && st.st_dev == resp->dev && st.st_ino == resp->ino &&
+	    st.st_mtime == resp->mtime && st.st_size == resp->size)
+		return;
+
+	tls_ocsp_resp_clear(resp);
+	buf = os_readfile(resp->fname, &len);
+	if (!buf) {
+		wpa_printf(MSG_INFO,
+			   "OpenSSL: Could not read OCSP response file %s",
+			   resp->fname);
+		return;
+	}
+	resp->der = (u8 *) buf;
+	resp->der_len = len;
+	resp->dev = st.st_dev;
+	resp->ino = st.st_ino;
+	resp->mtime = st.st_mtime;
+	resp->size = st.st_size;
+	tls_ocsp_resp_parse(resp);
+}
+
+
+static int tls_ocsp_resp_set(struct tls_ocsp_resp *resp, const char *fname)
+{
+	tls_ocsp_resp_free(resp);
+	if (!fname)
+		return 0;
+
+	resp->fname = os_strdup(fname);
+	if (!resp->fname)
+		return -1;
+	/* The file is allowed to be missing at this point; it is checked
+	 * again when a response is needed. */
+	tls_ocsp_resp_check(resp);
+	return 0;
+}
+
+
+static struct tls_ocsp_resp * tls_ocsp_resp_get(struct tls_data *data,
+						X509 *cert)
+{
+	struct tls_ocsp_resp *resp, *only = NULL;
+	int i, num = 0;
+
+	for (i = 0; i < TLS_OCSP_MAX_RESP; i++) {
+		resp = &data->ocsp_resp[i];
+		if (!resp->fname)
+			continue;
+		num++;
+		only = resp;
+		tls_ocsp_resp_check(resp);
+		if (cert && resp->serial &&
+		    ASN1_INTEGER_cmp(resp->serial,
+				     X509_get_serialNumber(cert)) == 0)
+			return resp;
+	}
+
+	/* A single configured response is used for any server certificate to
+	 * allow responses that could not be matched to a certificate. */
+	return num == 1 ? only : NULL;
+}
+
+
 static int ocsp_status_cb(SSL *s, void *arg)
 {
+	struct tls_data *data = arg;
+	struct tls_ocsp_resp *resp;
 	char *tmp;
-	char *resp;
-	size_t len;
 
-	if (tls_global->ocsp_stapling_response == NULL) {
+	if (!data->ocsp_resp[0].fname && !data->ocsp_resp[1].fname) {
 		wpa_printf(MSG_DEBUG, "OpenSSL: OCSP status callback - no response configured");
 		return SSL_TLSEXT_ERR_OK;
 	}
 
-	resp = os_readfile(tls_global->ocsp_stapling_response, &len);
-	if (resp == NULL) {
-		wpa_printf(MSG_DEBUG, "OpenSSL: OCSP status callback - could not read response file");
+	resp = tls_ocsp_resp_get(data, SSL_get_certificate(s));
+	if (!resp || !resp->der) {
+		wpa_printf(MSG_DEBUG, "OpenSSL: OCSP status callback - no cached response available for the server certificate");
 		/* TODO: Build OCSPResponse with responseStatus = internalError
 		 */
 		return SSL_TLSEXT_ERR_OK;
 	}
+	if (resp->next_update &&
+	    X509_cmp_current_time(resp->next_update) < 0) {
+		wpa_printf(MSG_INFO,
+			   "OpenSSL: Cached OCSP response %s has expired - not sent",
+			   resp->fname);
+		return SSL_TLSEXT_ERR_OK;
+	}
 	wpa_printf(MSG_DEBUG, "OpenSSL: OCSP status callback - send cached response");
-	tmp = OPENSSL_malloc(len);
-	if (tmp == NULL) {
-		os_free(resp);
+	tmp = OPENSSL_malloc(resp->der_len);
+	if (tmp == NULL)
 		return SSL_TLSEXT_ERR_ALERT_FATAL;
-	}
 
-	os_memcpy(tmp, resp, len);
-	os_free(resp);
-	SSL_set_tlsext_status_ocsp_resp(s, tmp, len);
+	os_memcpy(tmp, resp->der, resp->der_len);
+	SSL_set_tlsext_status_ocsp_resp(s, tmp, resp->der_len);
 
 	return SSL_TLSEXT_ERR_OK;
 }
@@ -5517,15 +6877,24 @@ int tls_global_set_params(void *tls_ctx,
 		SSL_CTX_clear_options(ssl_ctx, SSL_OP_NO_TICKET);
 #endif /*  SSL_OP_NO_TICKET */
 
+#ifdef SSL_OP_NO_TX_CERTIFICATE_COMPRESSION
+	/* Compress the certificate chain once here instead of separately for
+	 * each TLSv1.3 handshake with a peer that supports RFC 8879. */
+	if ((params->client_cert || params->client_cert2) &&
+	    !(params->flags & TLS_CONN_DISABLE_CERT_COMPRESSION) &&
+	    SSL_CTX_compress_certs(ssl_ctx, 0) != 1)
+		wpa_printf(MSG_DEBUG,
+			   "OpenSSL: Certificate compression not available");
+#endif /* SSL_OP_NO_TX_CERTIFICATE_COMPRESSION */
+
 #ifdef HAVE_OCSP
 	SSL_CTX_set_tlsext_status_cb(ssl_ctx, ocsp_status_cb);
-	SSL_CTX_set_tlsext_status_arg(ssl_ctx, ssl_ctx);
-	os_free(tls_global->ocsp_stapling_response);
-	if (params->ocsp_stapling_response)
-		tls_global->ocsp_stapling_response =
-			os_strdup(params->ocsp_stapling_response);
-	else
-		tls_global->ocsp_stapling_response = NULL;
+	SSL_CTX_set_tlsext_status_arg(ssl_ctx, data);
+	if (tls_ocsp_resp_set(&data->ocsp_resp[0],
+			      params->ocsp_stapling_response) < 0 ||
+	    tls_ocsp_resp_set(&data->ocsp_resp[1],
+			      params->ocsp_stapling_response2) < 0)
+		return -1;
 #endif /* HAVE_OCSP */
 
 	openssl_debug_dump_ctx(ssl_ctx);
@@ -5682,6 +7051,9 @@ void tls_connection_set_success_data(struct tls_connection *conn,
 
 	wpa_printf(MSG_DEBUG, "OpenSSL: Stored success data %p", data);
 	conn->success_data = 1;
+#ifdef TLS_SHARED_SESSION_CACHE
+	tls_shared_cache_store(conn, sess, data);
+#endif /* TLS_SHARED_SESSION_CACHE */
 	return;
 
 fail:
@@ -5702,11 +7074,17 @@ const struct wpabuf *
 tls_connection_get_success_data(struct tls_connection *conn)
 {
 	SSL_SESSION *sess;
+	const struct wpabuf *data;
 
 	if (tls_ex_idx_session < 0 ||
 	    !(sess = SSL_get_session(conn->ssl)))
 		return NULL;
-	return SSL_SESSION_get_ex_data(sess, tls_ex_idx_session);
+	data = SSL_SESSION_get_ex_data(sess, tls_ex_idx_session);
+#ifdef TLS_SHARED_SESSION_CACHE
+	if (!data)
+		data = conn->ticket_success_data;
+#endif /* TLS_SHARED_SESSION_CACHE */
+	return data;
 }
 
 
@@ -5718,6 +7096,9 @@ void tls_connection_remove_session(struct tls_connection *conn)
 	if (!sess)
 		return;
 
+#ifdef TLS_SHARED_SESSION_CACHE
+	tls_shared_cache_remove(conn, sess);
+#endif /* TLS_SHARED_SESSION_CACHE */
 	if (SSL_CTX_remove_session(conn->ssl_ctx, sess) != 1)
 		wpa_printf(MSG_DEBUG,
 			   "OpenSSL: Session was not cached");
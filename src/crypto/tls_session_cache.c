@@ -0,0 +1,481 @@
+/*
+ * Shared TLS session cache
+ * Copyright (c) 2026, Infineon Technologies AG
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "includes.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "common.h"
+#include "tls_session_cache.h"
+
+/*
+ * The cache is a memory mapped file that can be shared by multiple processes
+ * (e.g., one hostapd process per radio and a separate RADIUS server) and that
+ * persists over restarts. The file starts with a header that holds the
+ * session ticket encryption keys and it is followed by a fixed number of
+ * fixed size slots. A slot is found by hashing the lookup key (e.g., TLS
+ * session ID) and probing a small number of slots after that. Each operation
+ * is done while holding an fcntl() lock on the file.
+ *
+ * The file contains session secrets, so it is created with permissions that
+ * allow only the owner to access it.
+ */
+
+#define TLS_SESSION_CACHE_MAGIC 0x68534331 /* "hSC1" */
+#define TLS_SESSION_CACHE_VERSION 1
+#define TLS_SESSION_CACHE_HDR_SIZE 4096
+#define TLS_SESSION_CACHE_SLOT_SIZE 4096
+#define TLS_SESSION_CACHE_PROBE 8
+#define TLS_SESSION_CACHE_DEFAULT_ENTRIES 1024
+
+struct tls_session_cache_hdr {
+	u32 magic;
+	u32 version;
+	u32 slot_size;
+	u32 num_slots;
+	struct tls_ticket_key keys[2]; /* current and previous key */
+};
+
+struct tls_session_cache_slot {
+	u64 expires; /* os_get_time() seconds; 0 = unused */
+	u16 sess_len;
+	u16 app_len;
+	u8 key_len;
+	u8 key[TLS_SESSION_CACHE_MAX_KEY];
+	u8 data[]; /* session followed by application data */
+};
+
+#define TLS_SESSION_CACHE_MAX_DATA \
+	(TLS_SESSION_CACHE_SLOT_SIZE - sizeof(struct tls_session_cache_slot))
+
+struct tls_session_cache {
+	int fd;
+	u8 *map;
+	size_t map_len;
+	struct tls_session_cache_hdr *hdr;
+	unsigned int num_slots;
+};
+
+
+static int tls_session_cache_lock(struct tls_session_cache *cache, short type)
+{
+	struct flock fl;
+
+	os_memset(&fl, 0, sizeof(fl));
+	fl.l_type = type;
+	fl.l_whence = SEEK_SET;
+	while (fcntl(cache->fd, type == F_UNLCK ? F_SETLK : F_SETLKW,
+		     &fl) < 0) {
+		if (errno != EINTR) {
+			wpa_printf(MSG_INFO,
+				   "TLS: Failed to lock session cache: %s",
+				   strerror(errno));
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+
+static void tls_session_cache_unlock(struct tls_session_cache *cache)
+{
+	tls_session_cache_lock(cache, F_UNLCK);
+}
+
+
+static int tls_session_cache_new_key(struct tls_ticket_key *key,
+				     os_time_t now)
+{
+	if (os_get_random(key->name, sizeof(key->name)) < 0 ||
+	    os_get_random(key->aes_key, sizeof(key->aes_key)) < 0 ||
+	    os_get_random(key->hmac_key, sizeof(key->hmac_key)) < 0)
+		return -1;
+	key->created = now;
+	return 0;
+}
+
+
+static int tls_session_cache_init_hdr(struct tls_session_cache *cache)
+{
+	struct tls_session_cache_hdr *hdr = cache->hdr;
+	struct os_time now;
+
+	os_memset(cache->map, 0, cache->map_len);
+	os_get_time(&now);
+	/* The previous key is left unused (created = 0) */
+	if (tls_session_cache_new_key(&hdr->keys[0], now.sec) < 0)
+		return -1;
+	hdr->version = TLS_SESSION_CACHE_VERSION;
+	hdr->slot_size = TLS_SESSION_CACHE_SLOT_SIZE;
+	hdr->num_slots = cache->num_slots;
+	hdr->magic = TLS_SESSION_CACHE_MAGIC;
+	return 0;
+}
+
+
+/* Take the number of slots from an existing, valid cache file */
+static int tls_session_cache_read_geometry(struct tls_session_cache *cache,
+					   const struct stat *st)
+{
+	struct tls_session_cache_hdr hdr;
+
+	if (pread(cache->fd, &hdr, sizeof(hdr), 0) != sizeof(hdr) ||
+	    hdr.magic != TLS_SESSION_CACHE_MAGIC ||
+	    hdr.version != TLS_SESSION_CACHE_VERSION ||
+	    hdr.slot_size != TLS_SESSION_CACHE_SLOT_SIZE ||
+	    hdr.num_slots == 0 ||
+	    hdr.num_slots > TLS_SESSION_CACHE_MAX_ENTRIES ||
+	    (size_t) st->st_size != TLS_SESSION_CACHE_HDR_SIZE +
+	    (size_t) hdr.num_slots * TLS_SESSION_CACHE_SLOT_SIZE)
+		return -1;
+
+	if (hdr.num_slots != cache->num_slots)
+		wpa_printf(MSG_INFO,
+			   "TLS: Session cache file has %u entries (configured %u); using the existing file",
+			   hdr.num_slots, cache->num_slots);
+	cache->num_slots = hdr.num_slots;
+	cache->map_len = st->st_size;
+	return 0;
+}
+
+
+/**
+ * tls_session_cache_open - Open or create a shared TLS session cache
+ * @fname: Cache file
+ * @num_entries: Number of entries in the cache or 0 for the default
+ * Returns: Cache or %NULL on failure
+ *
+ * @num_entries is used only when the file is created. An existing file may be
+ * mapped by other processes, so it is never resized or reinitialized; its
+ * number of entries is used instead, and a file that is not a valid cache is
+ * rejected.
+ */
+struct tls_session_cache * tls_session_cache_open(const char *fname,
+						  unsigned int num_entries)
+{
+	struct tls_session_cache *cache;
+	struct stat st;
+	bool init = false;
+
+	if (!num_entries)
+		num_entries = TLS_SESSION_CACHE_DEFAULT_ENTRIES;
+	if (num_entries > TLS_SESSION_CACHE_MAX_ENTRIES)
+		return NULL;
+
+	cache = os_zalloc(sizeof(*cache));
+	if (!cache)
+		return NULL;
+	cache->num_slots = num_entries;
+	cache->map_len = TLS_SESSION_CACHE_HDR_SIZE +
+		(size_t) num_entries * TLS_SESSION_CACHE_SLOT_SIZE;
+	cache->fd = open(fname, O_RDWR | O_CREAT | O_NOFOLLOW, 0600);
+	if (cache->fd < 0) {
+		wpa_printf(MSG_ERROR, "TLS: Could not open session cache %s: %s",
+			   fname, strerror(errno));
+		os_free(cache);
+		return NULL;
+	}
+
+	if (tls_session_cache_lock(cache, F_WRLCK) < 0)
+		goto fail;
+
+	if (fstat(cache->fd, &st) < 0)
+		goto fail_unlock;
+	if (S_ISREG(st.st_mode) && st.st_size == 0) {
+		if (ftruncate(cache->fd, cache->map_len) < 0) {
+			wpa_printf(MSG_ERROR,
+				   "TLS: Could not resize session cache %s: %s",
+				   fname, strerror(errno));
+			goto fail_unlock;
+		}
+		init = true;
+	} else if (!S_ISREG(st.st_mode) ||
+		   tls_session_cache_read_geometry(cache, &st) < 0) {
+		wpa_printf(MSG_ERROR,
+			   "TLS: %s is not a valid session cache file; remove it to create a new cache",
+			   fname);
+		goto fail_unlock;
+	}
+
+	cache->map = mmap(NULL, cache->map_len, PROT_READ | PROT_WRITE,
+			  MAP_SHARED, cache->fd, 0);
+	if (cache->map == MAP_FAILED) {
+		wpa_printf(MSG_ERROR, "TLS: Could not map session cache %s: %s",
+			   fname, strerror(errno));
+		cache->map = NULL;
+		goto fail_unlock;
+	}
+	cache->hdr = (struct tls_session_cache_hdr *) cache->map;
+
+	if (init) {
+		wpa_printf(MSG_DEBUG,
+			   "TLS: Initialize session cache %s with %u entries",
+			   fname, cache->num_slots);
+		if (tls_session_cache_init_hdr(cache) < 0)
+			goto fail_unlock;
+	} else {
+		wpa_printf(MSG_DEBUG, "TLS: Opened session cache %s", fname);
+	}
+
+	tls_session_cache_unlock(cache);
+	return cache;
+
+fail_unlock:
+	tls_session_cache_unlock(cache);
+fail:
+	tls_session_cache_close(cache);
+	return NULL;
+}
+
+
+void tls_session_cache_close(struct tls_session_cache *cache)
+{
+	if (!cache)
+		return;
+	if (cache->map)
+		munmap(cache->map, cache->map_len);
+	close(cache->fd);
+	os_free(cache);
+}
+
+
+static struct tls_session_cache_slot *
+tls_session_cache_slot(struct tls_session_cache *cache, unsigned int i)
+{
+	return (struct tls_session_cache_slot *)
+		(cache->map + TLS_SESSION_CACHE_HDR_SIZE +
+		 (size_t) i * TLS_SESSION_CACHE_SLOT_SIZE);
+}
+
+
+static unsigned int tls_session_cache_hash(const u8 *key, size_t len)
+{
+	u32 h = 2166136261U;
+	size_t i;
+
+	/* FNV-1a */
+	for (i = 0; i < len; i++) {
+		h ^= key[i];
+		h *= 16777619U;
+	}
+
+	return h;
+}
+
+
+/* Find the slot with the key or, if @victim is not %NULL, the slot to use for
+ * a new entry with the key */
+static struct tls_session_cache_slot *
+tls_session_cache_find(struct tls_session_cache *cache, const u8 *key,
+		       size_t key_len, os_time_t now,
+		       struct tls_session_cache_slot **victim)
+{
+	struct tls_session_cache_slot *slot;
+	unsigned int start, i;
+
+	start = tls_session_cache_hash(key, key_len) % cache->num_slots;
+	for (i = 0; i < TLS_SESSION_CACHE_PROBE && i < cache->num_slots; i++) {
+		slot = tls_session_cache_slot(cache,
+					      (start + i) % cache->num_slots);
+		if (slot->expires > (u64) now && slot->key_len == key_len &&
+		    os_memcmp(slot->key, key, key_len) == 0)
+			return slot;
+		/* Use an unused or expired slot or the one that expires
+		 * first */
+		if (victim && (!*victim || slot->expires < (*victim)->expires))
+			*victim = slot;
+	}
+
+	return NULL;
+}
+
+
+/**
+ * tls_session_cache_store - Add or replace a cache entry
+ * @cache: Cache from tls_session_cache_open()
+ * @key: Lookup key
+ * @key_len: Length of @key (at most TLS_SESSION_CACHE_MAX_KEY)
+ * @sess: Serialized session or %NULL
+ * @sess_len: Length of @sess
+ * @app: Application data or %NULL
+ * @app_len: Length of @app
+ * @lifetime: Lifetime of the entry in seconds
+ * Returns: 0 on success or -1 if the entry could not be stored
+ */
+int tls_session_cache_store(struct tls_session_cache *cache,
+			    const u8 *key, size_t key_len,
+			    const u8 *sess, size_t sess_len,
+			    const u8 *app, size_t app_len,
+			    unsigned int lifetime)
+{
+	struct tls_session_cache_slot *slot, *victim = NULL;
+	struct os_time now;
+
+	if (key_len > TLS_SESSION_CACHE_MAX_KEY ||
+	    sess_len > TLS_SESSION_CACHE_MAX_DATA ||
+	    app_len > TLS_SESSION_CACHE_MAX_DATA - sess_len)
+		return -1;
+
+	if (tls_session_cache_lock(cache, F_WRLCK) < 0)
+		return -1;
+	os_get_time(&now);
+	slot = tls_session_cache_find(cache, key, key_len, now.sec, &victim);
+	if (!slot)
+		slot = victim;
+	slot->expires = 0;
+	slot->key_len = key_len;
+	os_memcpy(slot->key, key, key_len);
+	slot->sess_len = sess_len;
+	if (sess_len)
+		os_memcpy(slot->data, sess, sess_len);
+	slot->app_len = app_len;
+	if (app_len)
+		os_memcpy(slot->data + sess_len, app, app_len);
+	slot->expires = now.sec + lifetime;
+	tls_session_cache_unlock(cache);
+
+	return 0;
+}
+
+
+/**
+ * tls_session_cache_get - Fetch a cache entry
+ * @cache: Cache from tls_session_cache_open()
+ * @key: Lookup key
+ * @key_len: Length of @key
+ * @sess: Buffer for returning a copy of the serialized session (to be freed
+ *	with os_free()); %NULL if the entry has no session
+ * @sess_len: Buffer for returning the length of the session
+ * @app: Buffer for returning a copy of the application data or %NULL
+ * Returns: 0 if the entry was found or -1 if not
+ */
+int tls_session_cache_get(struct tls_session_cache *cache,
+			  const u8 *key, size_t key_len,
+			  u8 **sess, size_t *sess_len, struct wpabuf **app)
+{
+	struct tls_session_cache_slot *slot;
+	struct os_time now;
+	int ret = -1;
+
+	*sess = NULL;
+	*sess_len = 0;
+	*app = NULL;
+	if (key_len > TLS_SESSION_CACHE_MAX_KEY ||
+	    tls_session_cache_lock(cache, F_RDLCK) < 0)
+		return -1;
+	os_get_time(&now);
+	slot = tls_session_cache_find(cache, key, key_len, now.sec, NULL);
+	if (!slot || slot->sess_len > TLS_SESSION_CACHE_MAX_DATA ||
+	    slot->app_len > TLS_SESSION_CACHE_MAX_DATA - slot->sess_len)
+		goto out;
+
+	if (slot->sess_len) {
+		*sess = os_memdup(slot->data, slot->sess_len);
+		if (!*sess)
+			goto out;
+		*sess_len = slot->sess_len;
+	}
+	if (slot->app_len) {
+		*app = wpabuf_alloc_copy(slot->data + slot->sess_len,
+					 slot->app_len);
+		if (!*app) {
+			os_free(*sess);
+			*sess = NULL;
+			*sess_len = 0;
+			goto out;
+		}
+	}
+	ret = 0;
+out:
+	tls_session_cache_unlock(cache);
+	return ret;
+}
+
+
+/**
+ * tls_session_cache_remove - Remove a cache entry
+ * @cache: Cache from tls_session_cache_open()
+ * @key: Lookup key
+ * @key_len: Length of @key
+ */
+void tls_session_cache_remove(struct tls_session_cache *cache,
+			      const u8 *key, size_t key_len)
+{
+	struct tls_session_cache_slot *slot;
+	struct os_time now;
+
+	if (key_len > TLS_SESSION_CACHE_MAX_KEY ||
+	    tls_session_cache_lock(cache, F_WRLCK) < 0)
+		return;
+	os_get_time(&now);
+	slot = tls_session_cache_find(cache, key, key_len, now.sec, NULL);
+	if (slot)
+		slot->expires = 0;
+	tls_session_cache_unlock(cache);
+}
+
+
+static bool tls_session_cache_rotate_needed(struct tls_session_cache *cache,
+					    unsigned int rotation,
+					    os_time_t now)
+{
+	u64 created = cache->hdr->keys[0].created;
+
+	return rotation && ((u64) now < created ||
+			    (u64) now - created >= rotation);
+}
+
+
+/**
+ * tls_session_cache_ticket_keys - Get the session ticket keys
+ * @cache: Cache from tls_session_cache_open()
+ * @rotation: Key rotation interval in seconds or 0 to not rotate keys
+ * @keys: Buffer for returning the current and the previous key; the previous
+ *	key is unused if its created time is 0
+ * Returns: 0 on success or -1 on failure
+ *
+ * A new key is generated when the current key is older than @rotation. The
+ * keys are shared by all users of the cache file.
+ */
+int tls_session_cache_ticket_keys(struct tls_session_cache *cache,
+				  unsigned int rotation,
+				  struct tls_ticket_key *keys)
+{
+	struct tls_session_cache_hdr *hdr = cache->hdr;
+	struct tls_ticket_key key;
+	struct os_time now;
+	int ret = 0;
+
+	os_get_time(&now);
+	if (tls_session_cache_lock(cache, F_RDLCK) < 0)
+		return -1;
+	if (tls_session_cache_rotate_needed(cache, rotation, now.sec)) {
+		/* fcntl() locks cannot be upgraded atomically, so check
+		 * again with the write lock held */
+		tls_session_cache_unlock(cache);
+		if (tls_session_cache_lock(cache, F_WRLCK) < 0)
+			return -1;
+		if (tls_session_cache_rotate_needed(cache, rotation, now.sec)) {
+			if (tls_session_cache_new_key(&key, now.sec) < 0) {
+				ret = -1;
+				goto out;
+			}
+			hdr->keys[1] = hdr->keys[0];
+			hdr->keys[0] = key;
+			forced_memzero(&key, sizeof(key));
+			wpa_printf(MSG_DEBUG,
+				   "TLS: Rotated session ticket key");
+		}
+	}
+	os_memcpy(keys, hdr->keys, sizeof(hdr->keys));
+out:
+	tls_session_cache_unlock(cache);
+	return ret;
+}
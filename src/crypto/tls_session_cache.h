@@ -0,0 +1,49 @@
+/*
+ * Shared TLS session cache
+ * Copyright (c) 2026, Infineon Technologies AG
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#ifndef TLS_SESSION_CACHE_H
+#define TLS_SESSION_CACHE_H
+
+#define TLS_SESSION_CACHE_MAX_KEY 48
+#define TLS_TICKET_KEY_NAME_LEN 16
+#define TLS_SESSION_CACHE_MAX_ENTRIES 65536
+
+/**
+ * struct tls_ticket_key - Session ticket encryption key
+ * @name: Key name sent in the ticket
+ * @aes_key: AES-256-CBC key for the ticket encryption
+ * @hmac_key: HMAC-SHA256 key for the ticket integrity protection
+ * @created: Time (os_get_time()) when the key was generated
+ */
+struct tls_ticket_key {
+	u8 name[TLS_TICKET_KEY_NAME_LEN];
+	u8 aes_key[32];
+	u8 hmac_key[32];
+	u64 created;
+};
+
+struct tls_session_cache;
+
+struct tls_session_cache * tls_session_cache_open(const char *fname,
+						  unsigned int num_entries);
+void tls_session_cache_close(struct tls_session_cache *cache);
+int tls_session_cache_store(struct tls_session_cache *cache,
+			    const u8 *key, size_t key_len,
+			    const u8 *sess, size_t sess_len,
+			    const u8 *app, size_t app_len,
+			    unsigned int lifetime);
+int tls_session_cache_get(struct tls_session_cache *cache,
+			  const u8 *key, size_t key_len,
+			  u8 **sess, size_t *sess_len, struct wpabuf **app);
+void tls_session_cache_remove(struct tls_session_cache *cache,
+			      const u8 *key, size_t key_len);
+int tls_session_cache_ticket_keys(struct tls_session_cache *cache,
+				  unsigned int rotation,
+				  struct tls_ticket_key *keys);
+
+#endif /* TLS_SESSION_CACHE_H */
@@ -258,12 +258,45 @@ struct eap_config {
 
 	unsigned int max_auth_rounds;
 	unsigned int max_auth_rounds_short;
+
+	/**
+	 * stats - Per-method statistics of completed authentications
+	 *
+	 * This is allocated by the owner of the configuration, if statistics
+	 * are needed, and freed with eap_server_config_free().
+	 */
+	struct eap_server_stats *stats;
+};
+
+#define EAP_SERVER_STATS_METHODS 16
+
+/**
+ * struct eap_server_method_stats - Statistics for a single EAP method
+ */
+struct eap_server_method_stats {
+	int vendor;
+	u32 method;
+	unsigned int success;
+	unsigned int failure;
+	/* EAP-Request/EAP-Response round trips while the method was used */
+	unsigned long rounds;
+	unsigned int max_rounds;
+	/* Total length of the EAP-Request packets built by the method */
+	unsigned long long req_octets;
+};
+
+struct eap_server_stats {
+	unsigned int num_methods;
+	struct eap_server_method_stats methods[EAP_SERVER_STATS_METHODS];
 };
 
 struct eap_session_data {
 	const struct wpabuf *assoc_wps_ie;
 	const struct wpabuf *assoc_p2p_ie;
 	const u8 *peer_addr;
+	/* Fragment size for the TLS-based methods in this session or 0 to use
+	 * the eap_config value */
+	int tls_fragment_size;
 #ifdef CONFIG_TESTING_OPTIONS
 	u32 tls_test_flags;
 #endif /* CONFIG_TESTING_OPTIONS */
@@ -291,5 +324,6 @@ void eap_server_mschap_rx_callback(struct eap_sm *sm, const char *source,
 void eap_erp_update_identity(struct eap_sm *sm, const u8 *eap, size_t len);
 void eap_user_free(struct eap_user *user);
 void eap_server_config_free(struct eap_config *cfg);
+int eap_server_get_mib(const struct eap_config *cfg, char *buf, size_t buflen);
 
 #endif /* EAP_H */
@@ -172,6 +172,10 @@ struct eap_sm {
 
 	unsigned int num_rounds;
 	unsigned int num_rounds_short;
+	/* Round trips and request octets with the current method */
+	unsigned int method_rounds;
+	size_t method_req_octets;
+	int tls_fragment_size;
 	enum {
 		METHOD_PENDING_NONE, METHOD_PENDING_WAIT, METHOD_PENDING_CONT
 	} method_pending;
@@ -210,6 +210,47 @@ void eap_log_msg(struct eap_sm *sm, const char *fmt, ...)
 }
 
 
+static void eap_sm_update_stats(struct eap_sm *sm, int success)
+{
+	struct eap_server_stats *stats = sm->cfg->stats;
+	struct eap_server_method_stats *m;
+	unsigned int i;
+
+	if (!sm->m || sm->currentMethod == EAP_TYPE_IDENTITY ||
+	    sm->currentMethod == EAP_TYPE_NOTIFICATION)
+		return;
+
+	wpa_printf(MSG_DEBUG,
+		   "EAP: Method %s %s after %u round trips (%zu request octets)",
+		   sm->m->name, success ? "succeeded" : "failed",
+		   sm->method_rounds, sm->method_req_octets);
+
+	if (!stats)
+		return;
+	for (i = 0; i < stats->num_methods; i++) {
+		m = &stats->methods[i];
+		if (m->vendor == sm->m->vendor && m->method == sm->m->method)
+			break;
+	}
+	if (i == stats->num_methods) {
+		if (i == EAP_SERVER_STATS_METHODS)
+			return;
+		m = &stats->methods[stats->num_methods++];
+		m->vendor = sm->m->vendor;
+		m->method = sm->m->method;
+	}
+
+	if (success)
+		m->success++;
+	else
+		m->failure++;
+	m->rounds += sm->method_rounds;
+	if (sm->method_rounds > m->max_rounds)
+		m->max_rounds = sm->method_rounds;
+	m->req_octets += sm->method_req_octets;
+}
+
+
 SM_STATE(EAP, DISABLED)
 {
 	SM_ENTRY(EAP, DISABLED);
@@ -266,6 +307,8 @@ SM_STATE(EAP, INITIALIZE)
 	}
 	sm->num_rounds = 0;
 	sm->num_rounds_short = 0;
+	sm->method_rounds = 0;
+	sm->method_req_octets = 0;
 	sm->method_pending = METHOD_PENDING_NONE;
 
 	wpa_msg(sm->cfg->msg_ctx, MSG_INFO, WPA_EVENT_EAP_STARTED
@@ -360,6 +403,12 @@ SM_STATE(EAP, SEND_REQUEST)
 	if (sm->eap_if.eapReqData) {
 		if (wpabuf_len(sm->eap_if.eapReqData) >= 20)
 			sm->num_rounds_short = 0;
+		if (sm->currentMethod != EAP_TYPE_IDENTITY &&
+		    sm->currentMethod != EAP_TYPE_NOTIFICATION) {
+			sm->method_rounds++;
+			sm->method_req_octets +=
+				wpabuf_len(sm->eap_if.eapReqData);
+		}
 		if (eap_copy_buf(&sm->lastReqData, sm->eap_if.eapReqData) == 0)
 		{
 			sm->eap_if.eapResp = false;
@@ -553,6 +602,8 @@ SM_STATE(EAP, PROPOSE_METHOD)
 	SM_ENTRY(EAP, PROPOSE_METHOD);
 
 	sm->try_initiate_reauth = false;
+	sm->method_rounds = 0;
+	sm->method_req_octets = 0;
 try_another_method:
 	type = eap_sm_Policy_getNextMethod(sm, &vendor);
 	if (vendor == EAP_VENDOR_IETF)
@@ -656,6 +707,7 @@ SM_STATE(EAP, FAILURE)
 	wpabuf_free(sm->lastReqData);
 	sm->lastReqData = NULL;
 	sm->eap_if.eapFail = true;
+	eap_sm_update_stats(sm, 0);
 
 	wpa_msg(sm->cfg->msg_ctx, MSG_INFO, WPA_EVENT_EAP_FAILURE
 		MACSTR, MAC2STR(sm->peer_addr));
@@ -673,6 +725,7 @@ SM_STATE(EAP, SUCCESS)
 	if (sm->eap_if.eapKeyData)
 		sm->eap_if.eapKeyAvailable = true;
 	sm->eap_if.eapSuccess = true;
+	eap_sm_update_stats(sm, 1);
 
 	wpa_msg(sm->cfg->msg_ctx, MSG_INFO, WPA_EVENT_EAP_SUCCESS
 		MACSTR, MAC2STR(sm->peer_addr));
@@ -1870,6 +1923,8 @@ struct eap_sm * eap_server_sm_init(void *eapol_ctx,
 		sm->assoc_p2p_ie = wpabuf_dup(sess->assoc_p2p_ie);
 	if (sess->peer_addr)
 		os_memcpy(sm->peer_addr, sess->peer_addr, ETH_ALEN);
+	sm->tls_fragment_size = sess->tls_fragment_size > 0 ?
+		sess->tls_fragment_size : conf->fragment_size;
 #ifdef CONFIG_TESTING_OPTIONS
 	sm->tls_test_flags = sess->tls_test_flags;
 #endif /* CONFIG_TESTING_OPTIONS */
@@ -2100,5 +2155,49 @@ void eap_server_config_free(struct eap_config *cfg)
 	os_free(cfg->eap_fast_a_id);
 	os_free(cfg->eap_fast_a_id_info);
 	os_free(cfg->server_id);
+	os_free(cfg->stats);
 	os_free(cfg);
 }
+
+
+/**
+ * eap_server_get_mib - Get per-method EAP server statistics
+ * @cfg: EAP configuration
+ * @buf: Buffer for the statistics
+ * @buflen: Size of the buffer
+ * Returns: Number of bytes written to buf
+ */
+int eap_server_get_mib(const struct eap_config *cfg, char *buf, size_t buflen)
+{
+	const struct eap_server_method_stats *m;
+	char *pos = buf, *end = buf + buflen;
+	unsigned int i, count;
+	const char *name;
+	int ret;
+
+	if (!cfg || !cfg->stats || buflen == 0)
+		return 0;
+
+	for (i = 0; i < cfg->stats->num_methods; i++) {
+		m = &cfg->stats->methods[i];
+		name = eap_server_get_name(m->vendor, m->method);
+		count = m->success + m->failure;
+		ret = os_snprintf(pos, end - pos,
+				  "eap_%s_success=%u\n"
+				  "eap_%s_failure=%u\n"
+				  "eap_%s_rounds_avg=%lu\n"
+				  "eap_%s_rounds_max=%u\n"
+				  "eap_%s_req_octets_avg=%llu\n",
+				  name, m->success, name, m->failure,
+				  name, count ? m->rounds / count : 0,
+				  name, m->max_rounds,
+				  name, count ? m->req_octets / count : 0);
+		if (os_snprintf_error(end - pos, ret)) {
+			*pos = '\0';
+			break;
+		}
+		pos += ret;
+	}
+
+	return pos - buf;
+}
@@ -85,8 +85,8 @@ int eap_server_tls_ssl_init(struct eap_sm *sm, struct eap_ssl_data *data,
 		return -1;
 	}
 
-	data->tls_out_limit = sm->cfg->fragment_size > 0 ?
-		sm->cfg->fragment_size : 1398;
+	data->tls_out_limit = sm->tls_fragment_size > 0 ?
+		sm->tls_fragment_size : 1398;
 	if (data->phase2) {
 		/* Limit the fragment size in the inner TLS authentication
 		 * since the outer authentication with EAP-PEAP does not yet
@@ -22,6 +22,7 @@
 #endif /* CONFIG_SQLITE */
 
 #include "common.h"
+#include "list.h"
 #include "crypto/random.h"
 #include "eap_common/eap_sim_common.h"
 #include "eap_server/eap_sim_db.h"
@@ -33,12 +34,27 @@ struct eap_sim_pseudonym {
 	char *pseudonym; /* pseudonym username */
 };
 
+#define EAP_SIM_DB_HASH_SIZE 256
+#define EAP_SIM_DB_MAX_ENTRIES 10000
+#define EAP_SIM_DB_MAX_QUEUED 1000
+#define EAP_SIM_DB_MAX_RECV 64
+
+/*
+ * Authentication data query or spare authentication vector for an IMSI. The
+ * external server protocol does not have request identifiers, so the entries
+ * are indexed by IMSI and method and there is at most one entry per pair.
+ */
 struct eap_sim_db_pending {
-	struct eap_sim_db_pending *next;
+	struct eap_sim_db_pending *hnext;
+	struct dl_list list; /* in data->pending_list sorted by expiration */
 	char imsi[20];
-	enum { PENDING, SUCCESS, FAILURE } state;
-	void *cb_session_ctx;
+	enum { PENDING, SUCCESS, FAILURE, IDLE } state;
+	void *cb_session_ctx; /* NULL for a prefetch */
 	int aka;
+	int max_chal;
+	unsigned int discard; /* number of stale responses to drop */
+	struct os_reltime expire;
+	struct os_reltime last_auth; /* previous full authentication */
 	union {
 		struct {
 			u8 kc[EAP_SIM_MAX_CHAL][EAP_SIM_KC_LEN];
@@ -57,6 +73,13 @@ struct eap_sim_db_pending {
 	} u;
 };
 
+/* Request waiting for room in the socket send buffer */
+struct eap_sim_db_msg {
+	struct dl_list list;
+	size_t len;
+	char buf[];
+};
+
 struct eap_sim_db_data {
 	int sock;
 	char *fname;
@@ -65,8 +88,14 @@ struct eap_sim_db_data {
 	void *ctx;
 	struct eap_sim_pseudonym *pseudonyms;
 	struct eap_sim_reauth *reauths;
-	struct eap_sim_db_pending *pending;
+	struct eap_sim_db_pending *pending[EAP_SIM_DB_HASH_SIZE];
+	struct dl_list pending_list;
+	unsigned int num_pending;
+	struct dl_list send_queue;
+	unsigned int num_queued;
+	int write_registered;
 	unsigned int eap_sim_db_timeout;
+	unsigned int prefetch; /* seconds; 0 = no prefetch */
 #ifdef CONFIG_SQLITE
 	sqlite3 *sqlite_db;
 	char db_tmp_identity[100];
@@ -77,8 +106,10 @@ struct eap_sim_db_data {
 };
 
 
-static void eap_sim_db_del_timeout(void *eloop_ctx, void *user_ctx);
-static void eap_sim_db_query_timeout(void *eloop_ctx, void *user_ctx);
+static void eap_sim_db_expire_timeout(void *eloop_ctx, void *user_ctx);
+static int eap_sim_db_open_socket(struct eap_sim_db_data *data);
+static int eap_sim_db_send(struct eap_sim_db_data *data, const char *msg,
+			   size_t len);
 
 
 #ifdef CONFIG_SQLITE
@@ -373,83 +404,249 @@ static void db_remove_reauth(struct eap_sim_db_data *data,
 #endif /* CONFIG_SQLITE */
 
 
+static unsigned int eap_sim_db_hash(const char *imsi, int aka)
+{
+	unsigned int hash = 2166136261U;
+
+	while (*imsi)
+		hash = (hash ^ (u8) *imsi++) * 16777619U;
+	return (hash ^ aka) & (EAP_SIM_DB_HASH_SIZE - 1);
+}
+
+
 static struct eap_sim_db_pending *
 eap_sim_db_get_pending(struct eap_sim_db_data *data, const char *imsi, int aka)
 {
-	struct eap_sim_db_pending *entry, *prev = NULL;
+	struct eap_sim_db_pending *entry;
 
-	entry = data->pending;
-	while (entry) {
-		if (entry->aka == aka && os_strcmp(entry->imsi, imsi) == 0) {
-			if (prev)
-				prev->next = entry->next;
-			else
-				data->pending = entry->next;
+	for (entry = data->pending[eap_sim_db_hash(imsi, aka)]; entry;
+	     entry = entry->hnext) {
+		if (entry->aka == aka && os_strcmp(entry->imsi, imsi) == 0)
 			break;
-		}
-		prev = entry;
-		entry = entry->next;
 	}
 	return entry;
 }
 
 
-static void eap_sim_db_add_pending(struct eap_sim_db_data *data,
-				   struct eap_sim_db_pending *entry)
+static void eap_sim_db_schedule(struct eap_sim_db_data *data)
 {
-	entry->next = data->pending;
-	data->pending = entry;
+	struct eap_sim_db_pending *entry;
+	struct os_reltime now, diff;
+
+	eloop_cancel_timeout(eap_sim_db_expire_timeout, data, NULL);
+	entry = dl_list_first(&data->pending_list, struct eap_sim_db_pending,
+			      list);
+	if (!entry)
+		return;
+	os_get_reltime(&now);
+	if (os_reltime_before(&now, &entry->expire))
+		os_reltime_sub(&entry->expire, &now, &diff);
+	else
+		diff.sec = diff.usec = 0;
+	eloop_register_timeout(diff.sec, diff.usec, eap_sim_db_expire_timeout,
+			       data, NULL);
 }
 
 
-static void eap_sim_db_free_pending(struct eap_sim_db_data *data,
-				    struct eap_sim_db_pending *entry)
+static void eap_sim_db_set_expire(struct eap_sim_db_data *data,
+				  struct eap_sim_db_pending *entry,
+				  unsigned int timeout)
 {
-	eloop_cancel_timeout(eap_sim_db_query_timeout, data, entry);
-	eloop_cancel_timeout(eap_sim_db_del_timeout, data, entry);
-	os_free(entry);
+	struct eap_sim_db_pending *pos;
+
+	dl_list_del(&entry->list);
+	os_get_reltime(&entry->expire);
+	entry->expire.sec += timeout;
+
+	/* Keep the list sorted; usually the entry goes to the tail */
+	dl_list_for_each_reverse(pos, &data->pending_list,
+				 struct eap_sim_db_pending, list) {
+		if (!os_reltime_before(&entry->expire, &pos->expire)) {
+			dl_list_add(&pos->list, &entry->list);
+			return;
+		}
+	}
+	dl_list_add(&data->pending_list, &entry->list);
+	eap_sim_db_schedule(data);
 }
 
 
-static void eap_sim_db_del_pending(struct eap_sim_db_data *data,
-				   struct eap_sim_db_pending *entry)
+static struct eap_sim_db_pending *
+eap_sim_db_add_pending(struct eap_sim_db_data *data, const char *imsi, int aka)
 {
-	struct eap_sim_db_pending **pp = &data->pending;
+	struct eap_sim_db_pending *entry;
+	unsigned int hash = eap_sim_db_hash(imsi, aka);
 
-	while (*pp != NULL) {
+	entry = os_zalloc(sizeof(*entry));
+	if (entry == NULL)
+		return NULL;
+	os_strlcpy(entry->imsi, imsi, sizeof(entry->imsi));
+	entry->aka = aka;
+	dl_list_init(&entry->list);
+	entry->hnext = data->pending[hash];
+	data->pending[hash] = entry;
+	data->num_pending++;
+	return entry;
+}
+
+
+static void eap_sim_db_free_pending(struct eap_sim_db_data *data,
+				    struct eap_sim_db_pending *entry)
+{
+	struct eap_sim_db_pending **pp;
+
+	for (pp = &data->pending[eap_sim_db_hash(entry->imsi, entry->aka)];
+	     *pp; pp = &(*pp)->hnext) {
 		if (*pp == entry) {
-			*pp = entry->next;
-			eap_sim_db_free_pending(data, entry);
-			return;
+			*pp = entry->hnext;
+			break;
 		}
-		pp = &(*pp)->next;
 	}
+	dl_list_del(&entry->list);
+	data->num_pending--;
+	bin_clear_free(entry, sizeof(*entry));
 }
 
 
-static void eap_sim_db_del_timeout(void *eloop_ctx, void *user_ctx)
+static void eap_sim_db_expire_timeout(void *eloop_ctx, void *user_ctx)
 {
 	struct eap_sim_db_data *data = eloop_ctx;
-	struct eap_sim_db_pending *entry = user_ctx;
+	struct eap_sim_db_pending *entry;
+	struct os_reltime now;
+
+	os_get_reltime(&now);
+	while ((entry = dl_list_first(&data->pending_list,
+				      struct eap_sim_db_pending, list)) &&
+	       !os_reltime_before(&now, &entry->expire)) {
+		if (entry->state != PENDING || !entry->cb_session_ctx) {
+			wpa_printf(MSG_DEBUG, "EAP-SIM DB: Delete entry %p",
+				   entry);
+			eap_sim_db_free_pending(data, entry);
+			continue;
+		}
 
-	wpa_printf(MSG_DEBUG, "EAP-SIM DB: Delete query timeout for %p", entry);
-	eap_sim_db_del_pending(data, entry);
+		/*
+		 * Report failure and allow some time for EAP server to process
+		 * it before deleting the query.
+		 */
+		wpa_printf(MSG_DEBUG, "EAP-SIM DB: Query timeout for %p",
+			   entry);
+		entry->state = FAILURE;
+		eap_sim_db_set_expire(data, entry, 1);
+		data->get_complete_cb(data->ctx, entry->cb_session_ctx);
+	}
+	eap_sim_db_schedule(data);
 }
 
 
-static void eap_sim_db_query_timeout(void *eloop_ctx, void *user_ctx)
+static int eap_sim_db_request(struct eap_sim_db_data *data,
+			      struct eap_sim_db_pending *entry)
 {
-	struct eap_sim_db_data *data = eloop_ctx;
-	struct eap_sim_db_pending *entry = user_ctx;
+	char msg[40];
+	int len, ret;
+	size_t imsi_len;
 
-	/*
-	 * Report failure and allow some time for EAP server to process it
-	 * before deleting the query.
-	 */
-	wpa_printf(MSG_DEBUG, "EAP-SIM DB: Query timeout for %p", entry);
-	entry->state = FAILURE;
+	if (data->sock < 0) {
+		if (eap_sim_db_open_socket(data) < 0)
+			return -1;
+	}
+
+	imsi_len = os_strlen(entry->imsi);
+	len = os_snprintf(msg, sizeof(msg), "%s ",
+			  entry->aka ? "AKA-REQ-AUTH" : "SIM-REQ-AUTH");
+	if (os_snprintf_error(sizeof(msg), len) ||
+	    len + imsi_len >= sizeof(msg))
+		return -1;
+	os_memcpy(msg + len, entry->imsi, imsi_len);
+	len += imsi_len;
+	if (!entry->aka) {
+		ret = os_snprintf(msg + len, sizeof(msg) - len, " %d",
+				  entry->max_chal);
+		if (os_snprintf_error(sizeof(msg) - len, ret))
+			return -1;
+		len += ret;
+	}
+
+	wpa_printf(MSG_DEBUG, "EAP-SIM DB: requesting %s authentication "
+		   "data for IMSI '%s'%s", entry->aka ? "AKA" : "SIM",
+		   entry->imsi, entry->cb_session_ctx ? "" : " (prefetch)");
+	if (eap_sim_db_send(data, msg, len) < 0)
+		return -1;
+
+	entry->state = PENDING;
+	eap_sim_db_set_expire(data, entry, data->eap_sim_db_timeout);
+	return 0;
+}
+
+
+/*
+ * Authentication data from the entry has been given to the EAP method. Without
+ * prefetch, the entry is not needed anymore. With prefetch, the time of the
+ * full authentication is remembered and a spare vector is requested if the
+ * previous full authentication for the same IMSI is recent enough.
+ */
+static void eap_sim_db_used(struct eap_sim_db_data *data,
+			    struct eap_sim_db_pending *entry)
+{
+	struct os_reltime now;
+	int returning;
+
+	if (!data->prefetch || data->num_pending > EAP_SIM_DB_MAX_ENTRIES) {
+		eap_sim_db_free_pending(data, entry);
+		return;
+	}
+
+	os_get_reltime(&now);
+	returning = os_reltime_initialized(&entry->last_auth) &&
+		!os_reltime_expired(&now, &entry->last_auth, data->prefetch);
+	entry->last_auth = now;
+	entry->cb_session_ctx = NULL;
+	os_memset(&entry->u, 0, sizeof(entry->u));
+	if (returning && eap_sim_db_request(data, entry) == 0)
+		return;
+	entry->state = IDLE;
+	eap_sim_db_set_expire(data, entry, data->prefetch);
+}
+
+
+static struct eap_sim_db_pending *
+eap_sim_db_get_resp_entry(struct eap_sim_db_data *data, const char *imsi,
+			  int aka)
+{
+	struct eap_sim_db_pending *entry;
+
+	entry = eap_sim_db_get_pending(data, imsi, aka);
+	if (entry == NULL || entry->state != PENDING) {
+		wpa_printf(MSG_DEBUG, "EAP-SIM DB: No pending entry for the "
+			   "received message found");
+		return NULL;
+	}
+	if (entry->discard) {
+		/* Requested before AKA resynchronization */
+		wpa_printf(MSG_DEBUG, "EAP-SIM DB: Drop stale response");
+		entry->discard--;
+		return NULL;
+	}
+	return entry;
+}
+
+
+static void eap_sim_db_resp_done(struct eap_sim_db_data *data,
+				 struct eap_sim_db_pending *entry, int success)
+{
+	entry->state = success ? SUCCESS : FAILURE;
+	if (!entry->cb_session_ctx) {
+		/* Prefetch: keep a spare vector, but not a failure */
+		wpa_printf(MSG_DEBUG, "EAP-SIM DB: Prefetch for IMSI '%s' %s",
+			   entry->imsi, success ? "completed" : "failed");
+		if (success)
+			eap_sim_db_set_expire(data, entry, data->prefetch);
+		else
+			eap_sim_db_free_pending(data, entry);
+		return;
+	}
+	eap_sim_db_set_expire(data, entry, data->eap_sim_db_timeout);
 	data->get_complete_cb(data->ctx, entry->cb_session_ctx);
-	eloop_register_timeout(1, 0, eap_sim_db_del_timeout, data, entry);
 }
 
 
@@ -466,20 +663,15 @@ static void eap_sim_db_sim_resp_auth(struct eap_sim_db_data *data,
 	 * (IMSI = ASCII string, Kc/SRES/RAND = hex string)
 	 */
 
-	entry = eap_sim_db_get_pending(data, imsi, 0);
-	if (entry == NULL) {
-		wpa_printf(MSG_DEBUG, "EAP-SIM DB: No pending entry for the "
-			   "received message found");
+	entry = eap_sim_db_get_resp_entry(data, imsi, 0);
+	if (entry == NULL)
 		return;
-	}
 
 	start = buf;
 	if (os_strncmp(start, "FAILURE", 7) == 0) {
 		wpa_printf(MSG_DEBUG, "EAP-SIM DB: External server reported "
 			   "failure");
-		entry->state = FAILURE;
-		eap_sim_db_add_pending(data, entry);
-		data->get_complete_cb(data->ctx, entry->cb_session_ctx);
+		eap_sim_db_resp_done(data, entry, 0);
 		return;
 	}
 
@@ -519,16 +711,14 @@ static void eap_sim_db_sim_resp_auth(struct eap_sim_db_data *data,
 	}
 	entry->u.sim.num_chal = num_chal;
 
-	entry->state = SUCCESS;
 	wpa_printf(MSG_DEBUG, "EAP-SIM DB: Authentication data parsed "
 		   "successfully - callback");
-	eap_sim_db_add_pending(data, entry);
-	data->get_complete_cb(data->ctx, entry->cb_session_ctx);
+	eap_sim_db_resp_done(data, entry, 1);
 	return;
 
 parse_fail:
 	wpa_printf(MSG_DEBUG, "EAP-SIM DB: Failed to parse response string");
-	eap_sim_db_free_pending(data, entry);
+	eap_sim_db_resp_done(data, entry, 0);
 }
 
 
@@ -544,20 +734,15 @@ static void eap_sim_db_aka_resp_auth(struct eap_sim_db_data *data,
 	 * (IMSI = ASCII string, RAND/AUTN/IK/CK/RES = hex string)
 	 */
 
-	entry = eap_sim_db_get_pending(data, imsi, 1);
-	if (entry == NULL) {
-		wpa_printf(MSG_DEBUG, "EAP-SIM DB: No pending entry for the "
-			   "received message found");
+	entry = eap_sim_db_get_resp_entry(data, imsi, 1);
+	if (entry == NULL)
 		return;
-	}
 
 	start = buf;
 	if (os_strncmp(start, "FAILURE", 7) == 0) {
 		wpa_printf(MSG_DEBUG, "EAP-SIM DB: External server reported "
 			   "failure");
-		entry->state = FAILURE;
-		eap_sim_db_add_pending(data, entry);
-		data->get_complete_cb(data->ctx, entry->cb_session_ctx);
+		eap_sim_db_resp_done(data, entry, 0);
 		return;
 	}
 
@@ -610,29 +795,22 @@ static void eap_sim_db_aka_resp_auth(struct eap_sim_db_data *data,
 	if (hexstr2bin(start, entry->u.aka.res, entry->u.aka.res_len))
 		goto parse_fail;
 
-	entry->state = SUCCESS;
 	wpa_printf(MSG_DEBUG, "EAP-SIM DB: Authentication data parsed "
 		   "successfully - callback");
-	eap_sim_db_add_pending(data, entry);
-	data->get_complete_cb(data->ctx, entry->cb_session_ctx);
+	eap_sim_db_resp_done(data, entry, 1);
 	return;
 
 parse_fail:
 	wpa_printf(MSG_DEBUG, "EAP-SIM DB: Failed to parse response string");
-	eap_sim_db_free_pending(data, entry);
+	eap_sim_db_resp_done(data, entry, 0);
 }
 
 
-static void eap_sim_db_receive(int sock, void *eloop_ctx, void *sock_ctx)
+static void eap_sim_db_process(struct eap_sim_db_data *data, char *buf,
+			       int res)
 {
-	struct eap_sim_db_data *data = eloop_ctx;
-	char buf[1000], *pos, *cmd, *imsi;
-	int res;
+	char *pos, *cmd, *imsi;
 
-	res = recv(sock, buf, sizeof(buf) - 1, 0);
-	if (res < 0)
-		return;
-	buf[res] = '\0';
 	wpa_hexdump_ascii_key(MSG_MSGDUMP, "EAP-SIM DB: Received from an "
 			      "external source", (u8 *) buf, res);
 	if (res == 0)
@@ -673,6 +851,27 @@ parse_fail:
 }
 
 
+static void eap_sim_db_receive(int sock, void *eloop_ctx, void *sock_ctx)
+{
+	struct eap_sim_db_data *data = eloop_ctx;
+	char buf[1000];
+	int res, i;
+
+	/*
+	 * Handle all responses that are already available for pipelined
+	 * requests. The callbacks may reconnect, so stop if the socket
+	 * changes.
+	 */
+	for (i = 0; i < EAP_SIM_DB_MAX_RECV && data->sock == sock; i++) {
+		res = recv(sock, buf, sizeof(buf) - 1, MSG_DONTWAIT);
+		if (res < 0)
+			return;
+		buf[res] = '\0';
+		eap_sim_db_process(data, buf, res);
+	}
+}
+
+
 static int eap_sim_db_open_socket(struct eap_sim_db_data *data)
 {
 	struct sockaddr_un addr;
@@ -732,6 +931,9 @@ static void eap_sim_db_close_socket(struct eap_sim_db_data *data)
 {
 	if (data->sock >= 0) {
 		eloop_unregister_read_sock(data->sock);
+		if (data->write_registered)
+			eloop_unregister_sock(data->sock, EVENT_TYPE_WRITE);
+		data->write_registered = 0;
 		close(data->sock);
 		data->sock = -1;
 	}
@@ -743,6 +945,19 @@ static void eap_sim_db_close_socket(struct eap_sim_db_data *data)
 }
 
 
+static void eap_sim_db_free_queue(struct eap_sim_db_data *data)
+{
+	struct eap_sim_db_msg *msg, *prev;
+
+	dl_list_for_each_safe(msg, prev, &data->send_queue,
+			      struct eap_sim_db_msg, list) {
+		dl_list_del(&msg->list);
+		os_free(msg);
+	}
+	data->num_queued = 0;
+}
+
+
 /**
  * eap_sim_db_init - Initialize EAP-SIM DB / authentication gateway interface
  * @config: Configuration data (e.g., file name)
@@ -767,9 +982,22 @@ eap_sim_db_init(const char *config, unsigned int db_timeout,
 	data->get_complete_cb = get_complete_cb;
 	data->ctx = ctx;
 	data->eap_sim_db_timeout = db_timeout;
+	dl_list_init(&data->pending_list);
+	dl_list_init(&data->send_queue);
 	data->fname = os_strdup(config);
 	if (data->fname == NULL)
 		goto fail;
+	pos = os_strstr(data->fname, " prefetch=");
+	if (pos) {
+		char *end;
+
+		data->prefetch = atoi(pos + 10);
+		end = os_strchr(pos + 1, ' ');
+		if (end)
+			os_memmove(pos, end, os_strlen(end) + 1);
+		else
+			*pos = '\0';
+	}
 	pos = os_strstr(data->fname, " db=");
 	if (pos) {
 		*pos = '\0';
@@ -824,7 +1052,8 @@ void eap_sim_db_deinit(void *priv)
 	struct eap_sim_db_data *data = priv;
 	struct eap_sim_pseudonym *p, *prev;
 	struct eap_sim_reauth *r, *prevr;
-	struct eap_sim_db_pending *pending, *prev_pending;
+	struct eap_sim_db_pending *pending;
+	unsigned int i;
 
 #ifdef CONFIG_SQLITE
 	if (data->sqlite_db) {
@@ -850,24 +1079,87 @@ void eap_sim_db_deinit(void *priv)
 		eap_sim_db_free_reauth(prevr);
 	}
 
-	pending = data->pending;
-	while (pending) {
-		prev_pending = pending;
-		pending = pending->next;
-		eap_sim_db_free_pending(data, prev_pending);
+	for (i = 0; i < EAP_SIM_DB_HASH_SIZE; i++) {
+		while ((pending = data->pending[i]))
+			eap_sim_db_free_pending(data, pending);
 	}
+	eloop_cancel_timeout(eap_sim_db_expire_timeout, data, NULL);
+	eap_sim_db_free_queue(data);
 
 	os_free(data);
 }
 
 
+static void eap_sim_db_writable(int sock, void *eloop_ctx, void *sock_ctx)
+{
+	struct eap_sim_db_data *data = eloop_ctx;
+	struct eap_sim_db_msg *msg;
+
+	while ((msg = dl_list_first(&data->send_queue, struct eap_sim_db_msg,
+				    list))) {
+		if (send(sock, msg->buf, msg->len, MSG_DONTWAIT) < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK ||
+			    errno == ENOBUFS)
+				return;
+			/* The query will time out */
+			wpa_printf(MSG_INFO, "send[EAP-SIM DB UNIX]: %s",
+				   strerror(errno));
+		}
+		dl_list_del(&msg->list);
+		os_free(msg);
+		data->num_queued--;
+	}
+
+	eloop_unregister_sock(sock, EVENT_TYPE_WRITE);
+	data->write_registered = 0;
+}
+
+
+static int eap_sim_db_queue(struct eap_sim_db_data *data, const char *buf,
+			    size_t len)
+{
+	struct eap_sim_db_msg *msg;
+
+	if (data->num_queued >= EAP_SIM_DB_MAX_QUEUED) {
+		wpa_printf(MSG_INFO, "EAP-SIM DB: Too many queued requests");
+		return -1;
+	}
+	msg = os_malloc(sizeof(*msg) + len);
+	if (!msg)
+		return -1;
+	msg->len = len;
+	os_memcpy(msg->buf, buf, len);
+	dl_list_add_tail(&data->send_queue, &msg->list);
+	data->num_queued++;
+
+	if (!data->write_registered) {
+		if (eloop_register_sock(data->sock, EVENT_TYPE_WRITE,
+					eap_sim_db_writable, data, NULL) < 0)
+			return -1;
+		data->write_registered = 1;
+	}
+	return 0;
+}
+
+
 static int eap_sim_db_send(struct eap_sim_db_data *data, const char *msg,
 			   size_t len)
 {
 	int _errno = 0;
 
-	if (send(data->sock, msg, len, 0) < 0) {
+	/*
+	 * The external server may get requests faster than it can process
+	 * them. Do not block the event loop when its receive queue is full;
+	 * keep the requests in order until there is room.
+	 */
+	if (data->num_queued)
+		return eap_sim_db_queue(data, msg, len);
+
+	if (send(data->sock, msg, len, MSG_DONTWAIT) < 0) {
 		_errno = errno;
+		if (_errno == EAGAIN || _errno == EWOULDBLOCK ||
+		    _errno == ENOBUFS)
+			return eap_sim_db_queue(data, msg, len);
 		wpa_printf(MSG_INFO, "send[EAP-SIM DB UNIX]: %s",
 			   strerror(errno));
 	}
@@ -880,7 +1172,10 @@ static int eap_sim_db_send(struct eap_sim_db_data *data, const char *msg,
 			return -1;
 		wpa_printf(MSG_DEBUG, "EAP-SIM DB: Reconnected to the "
 			   "external server");
-		if (send(data->sock, msg, len, 0) < 0) {
+		if (send(data->sock, msg, len, MSG_DONTWAIT) < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK ||
+			    errno == ENOBUFS)
+				return eap_sim_db_queue(data, msg, len);
 			wpa_printf(MSG_INFO, "send[EAP-SIM DB UNIX]: %s",
 				   strerror(errno));
 			return -1;
@@ -891,14 +1186,6 @@ static int eap_sim_db_send(struct eap_sim_db_data *data, const char *msg,
 }
 
 
-static void eap_sim_db_expire_pending(struct eap_sim_db_data *data,
-				      struct eap_sim_db_pending *entry)
-{
-	eloop_register_timeout(data->eap_sim_db_timeout, 0,
-			       eap_sim_db_query_timeout, data, entry);
-}
-
-
 /**
  * eap_sim_db_get_gsm_triplets - Get GSM triplets
  * @data: Private data pointer from eap_sim_db_init()
@@ -928,10 +1215,7 @@ int eap_sim_db_get_gsm_triplets(struct eap_sim_db_data *data,
 				void *cb_session_ctx)
 {
 	struct eap_sim_db_pending *entry;
-	int len, ret;
-	char msg[40];
 	const char *imsi;
-	size_t imsi_len;
 
 	if (username == NULL || username[0] != EAP_SIM_PERMANENT_PREFIX ||
 	    username[1] == '\0' || os_strlen(username) > sizeof(entry->imsi)) {
@@ -944,24 +1228,27 @@ int eap_sim_db_get_gsm_triplets(struct eap_sim_db_data *data,
 		   imsi);
 
 	entry = eap_sim_db_get_pending(data, imsi, 0);
-	if (entry) {
-		int num_chal;
-		if (entry->state == FAILURE) {
-			wpa_printf(MSG_DEBUG, "EAP-SIM DB: Pending entry -> "
-				   "failure");
-			eap_sim_db_free_pending(data, entry);
-			return EAP_SIM_DB_FAILURE;
-		}
+	if (entry && entry->state == FAILURE) {
+		wpa_printf(MSG_DEBUG, "EAP-SIM DB: Pending entry -> failure");
+		eap_sim_db_free_pending(data, entry);
+		return EAP_SIM_DB_FAILURE;
+	}
 
-		if (entry->state == PENDING) {
-			wpa_printf(MSG_DEBUG, "EAP-SIM DB: Pending entry -> "
-				   "still pending");
-			eap_sim_db_add_pending(data, entry);
-			return EAP_SIM_DB_PENDING;
-		}
+	if (entry && entry->state == PENDING) {
+		wpa_printf(MSG_DEBUG, "EAP-SIM DB: Pending entry -> "
+			   "still pending%s",
+			   entry->cb_session_ctx ? "" : " (prefetch)");
+		if (!entry->cb_session_ctx)
+			entry->cb_session_ctx = cb_session_ctx;
+		return EAP_SIM_DB_PENDING;
+	}
+
+	if (entry && entry->state == SUCCESS) {
+		int num_chal;
 
 		wpa_printf(MSG_DEBUG, "EAP-SIM DB: Pending entry -> "
-			   "%d challenges", entry->u.sim.num_chal);
+			   "%d challenges%s", entry->u.sim.num_chal,
+			   entry->cb_session_ctx ? "" : " (prefetched)");
 		num_chal = entry->u.sim.num_chal;
 		if (num_chal > max_chal)
 			num_chal = max_chal;
@@ -969,41 +1256,21 @@ int eap_sim_db_get_gsm_triplets(struct eap_sim_db_data *data,
 		os_memcpy(sres, entry->u.sim.sres,
 			  num_chal * EAP_SIM_SRES_LEN);
 		os_memcpy(kc, entry->u.sim.kc, num_chal * EAP_SIM_KC_LEN);
-		eap_sim_db_free_pending(data, entry);
+		eap_sim_db_used(data, entry);
 		return num_chal;
 	}
 
-	if (data->sock < 0) {
-		if (eap_sim_db_open_socket(data) < 0)
+	if (!entry) {
+		entry = eap_sim_db_add_pending(data, imsi, 0);
+		if (entry == NULL)
 			return EAP_SIM_DB_FAILURE;
 	}
-
-	imsi_len = os_strlen(imsi);
-	len = os_snprintf(msg, sizeof(msg), "SIM-REQ-AUTH ");
-	if (os_snprintf_error(sizeof(msg), len) ||
-	    len + imsi_len >= sizeof(msg))
-		return EAP_SIM_DB_FAILURE;
-	os_memcpy(msg + len, imsi, imsi_len);
-	len += imsi_len;
-	ret = os_snprintf(msg + len, sizeof(msg) - len, " %d", max_chal);
-	if (os_snprintf_error(sizeof(msg) - len, ret))
-		return EAP_SIM_DB_FAILURE;
-	len += ret;
-
-	wpa_printf(MSG_DEBUG, "EAP-SIM DB: requesting SIM authentication "
-		   "data for IMSI '%s'", imsi);
-	if (eap_sim_db_send(data, msg, len) < 0)
-		return EAP_SIM_DB_FAILURE;
-
-	entry = os_zalloc(sizeof(*entry));
-	if (entry == NULL)
-		return EAP_SIM_DB_FAILURE;
-
-	os_strlcpy(entry->imsi, imsi, sizeof(entry->imsi));
 	entry->cb_session_ctx = cb_session_ctx;
-	entry->state = PENDING;
-	eap_sim_db_add_pending(data, entry);
-	eap_sim_db_expire_pending(data, entry);
+	entry->max_chal = max_chal;
+	if (eap_sim_db_request(data, entry) < 0) {
+		eap_sim_db_free_pending(data, entry);
+		return EAP_SIM_DB_FAILURE;
+	}
 	wpa_printf(MSG_DEBUG, "EAP-SIM DB: Added query %p", entry);
 
 	return EAP_SIM_DB_PENDING;
@@ -1395,10 +1662,7 @@ int eap_sim_db_get_aka_auth(struct eap_sim_db_data *data, const char *username,
 			    u8 *res, size_t *res_len, void *cb_session_ctx)
 {
 	struct eap_sim_db_pending *entry;
-	int len;
-	char msg[40];
 	const char *imsi;
-	size_t imsi_len;
 
 	if (username == NULL ||
 	    (username[0] != EAP_AKA_PERMANENT_PREFIX &&
@@ -1413,59 +1677,44 @@ int eap_sim_db_get_aka_auth(struct eap_sim_db_data *data, const char *username,
 		   imsi);
 
 	entry = eap_sim_db_get_pending(data, imsi, 1);
-	if (entry) {
-		if (entry->state == FAILURE) {
-			eap_sim_db_free_pending(data, entry);
-			wpa_printf(MSG_DEBUG, "EAP-SIM DB: Failure");
-			return EAP_SIM_DB_FAILURE;
-		}
+	if (entry && entry->state == FAILURE) {
+		eap_sim_db_free_pending(data, entry);
+		wpa_printf(MSG_DEBUG, "EAP-SIM DB: Failure");
+		return EAP_SIM_DB_FAILURE;
+	}
 
-		if (entry->state == PENDING) {
-			eap_sim_db_add_pending(data, entry);
-			wpa_printf(MSG_DEBUG, "EAP-SIM DB: Pending");
-			return EAP_SIM_DB_PENDING;
-		}
+	if (entry && entry->state == PENDING) {
+		wpa_printf(MSG_DEBUG, "EAP-SIM DB: Pending%s",
+			   entry->cb_session_ctx ? "" : " (prefetch)");
+		if (!entry->cb_session_ctx)
+			entry->cb_session_ctx = cb_session_ctx;
+		return EAP_SIM_DB_PENDING;
+	}
 
+	if (entry && entry->state == SUCCESS) {
 		wpa_printf(MSG_DEBUG, "EAP-SIM DB: Returning successfully "
-			   "received authentication data");
+			   "received authentication data%s",
+			   entry->cb_session_ctx ? "" : " (prefetched)");
 		os_memcpy(_rand, entry->u.aka.rand, EAP_AKA_RAND_LEN);
 		os_memcpy(autn, entry->u.aka.autn, EAP_AKA_AUTN_LEN);
 		os_memcpy(ik, entry->u.aka.ik, EAP_AKA_IK_LEN);
 		os_memcpy(ck, entry->u.aka.ck, EAP_AKA_CK_LEN);
 		os_memcpy(res, entry->u.aka.res, EAP_AKA_RES_MAX_LEN);
 		*res_len = entry->u.aka.res_len;
-		eap_sim_db_free_pending(data, entry);
+		eap_sim_db_used(data, entry);
 		return 0;
 	}
 
-	if (data->sock < 0) {
-		if (eap_sim_db_open_socket(data) < 0)
+	if (!entry) {
+		entry = eap_sim_db_add_pending(data, imsi, 1);
+		if (entry == NULL)
 			return EAP_SIM_DB_FAILURE;
 	}
-
-	imsi_len = os_strlen(imsi);
-	len = os_snprintf(msg, sizeof(msg), "AKA-REQ-AUTH ");
-	if (os_snprintf_error(sizeof(msg), len) ||
-	    len + imsi_len >= sizeof(msg))
-		return EAP_SIM_DB_FAILURE;
-	os_memcpy(msg + len, imsi, imsi_len);
-	len += imsi_len;
-
-	wpa_printf(MSG_DEBUG, "EAP-SIM DB: requesting AKA authentication "
-		    "data for IMSI '%s'", imsi);
-	if (eap_sim_db_send(data, msg, len) < 0)
-		return EAP_SIM_DB_FAILURE;
-
-	entry = os_zalloc(sizeof(*entry));
-	if (entry == NULL)
-		return EAP_SIM_DB_FAILURE;
-
-	entry->aka = 1;
-	os_strlcpy(entry->imsi, imsi, sizeof(entry->imsi));
 	entry->cb_session_ctx = cb_session_ctx;
-	entry->state = PENDING;
-	eap_sim_db_add_pending(data, entry);
-	eap_sim_db_expire_pending(data, entry);
+	if (eap_sim_db_request(data, entry) < 0) {
+		eap_sim_db_free_pending(data, entry);
+		return EAP_SIM_DB_FAILURE;
+	}
 	wpa_printf(MSG_DEBUG, "EAP-SIM DB: Added query %p", entry);
 
 	return EAP_SIM_DB_PENDING;
@@ -1490,6 +1739,7 @@ int eap_sim_db_resynchronize(struct eap_sim_db_data *data,
 			     const char *username,
 			     const u8 *auts, const u8 *_rand)
 {
+	struct eap_sim_db_pending *entry;
 	const char *imsi;
 	size_t imsi_len;
 
@@ -1533,6 +1783,21 @@ int eap_sim_db_resynchronize(struct eap_sim_db_data *data,
 			   "IMSI '%s'", imsi);
 		if (eap_sim_db_send(data, msg, len) < 0)
 			return -1;
+
+		/*
+		 * A vector requested before the AUTS was generated with the
+		 * old SQN. Drop it and request a new one after the AUTS.
+		 */
+		entry = eap_sim_db_get_pending(data, imsi, 1);
+		if (entry &&
+		    (entry->state == PENDING || entry->state == SUCCESS)) {
+			if (entry->state == PENDING)
+				entry->discard++;
+			os_memset(&entry->u, 0, sizeof(entry->u));
+			if (eap_sim_db_request(data, entry) < 0 &&
+			    !entry->cb_session_ctx)
+				eap_sim_db_free_pending(data, entry);
+		}
 	}
 
 	return 0;
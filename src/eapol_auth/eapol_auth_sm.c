@@ -11,6 +11,7 @@
 #include "common.h"
 #include "eloop.h"
 #include "state_machine.h"
+#include "objpool.h"
 #include "common/eapol_common.h"
 #include "eap_common/eap_defs.h"
 #include "eap_common/eap_common.h"
@@ -785,7 +786,7 @@ eapol_auth_alloc(struct eapol_authenticator *eapol, const u8 *addr,
 	if (eapol == NULL)
 		return NULL;
 
-	sm = os_zalloc(sizeof(*sm));
+	sm = objpool_alloc(eapol->sm_pool);
 	if (sm == NULL) {
 		wpa_printf(MSG_DEBUG, "IEEE 802.1X state machine allocation "
 			   "failed");
@@ -877,7 +878,7 @@ void eapol_auth_free(struct eapol_state_machine *sm)
 
 	wpabuf_free(sm->radius_cui);
 	os_free(sm->identity);
-	os_free(sm);
+	objpool_free(sm->eapol->sm_pool, sm);
 }
 
 
@@ -1232,6 +1233,16 @@ struct eapol_authenticator * eapol_auth_init(struct eapol_auth_config *conf,
 		return NULL;
 	}
 
+	eapol->sm_pool = objpool_init("eapol_sm",
+				      sizeof(struct eapol_state_machine),
+				      conf->sta_pool_prealloc,
+				      conf->sta_pool_max);
+	if (!eapol->sm_pool) {
+		eapol_auth_conf_free(&eapol->conf);
+		os_free(eapol);
+		return NULL;
+	}
+
 #ifdef CONFIG_WEP
 	if (conf->individual_wep_key_len > 0) {
 		/* use key0 in individual key and key1 in broadcast key */
@@ -1265,5 +1276,15 @@ void eapol_auth_deinit(struct eapol_authenticator *eapol)
 #ifdef CONFIG_WEP
 	os_free(eapol->default_wep_key);
 #endif /* CONFIG_WEP */
+	objpool_deinit(eapol->sm_pool);
 	os_free(eapol);
 }
+
+
+int eapol_auth_get_pool_mib(struct eapol_authenticator *eapol, char *buf,
+			    size_t buflen)
+{
+	if (!eapol)
+		return 0;
+	return objpool_get_mib(eapol->sm_pool, buf, buflen);
+}
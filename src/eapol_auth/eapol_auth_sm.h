@@ -23,6 +23,8 @@ struct eapol_auth_config {
 	size_t eap_req_id_text_len;
 	int erp_send_reauth_start;
 	char *erp_domain; /* a copy of this will be allocated */
+	unsigned int sta_pool_prealloc;
+	unsigned int sta_pool_max;
 
 	/* Opaque context pointer to owner data for callback functions */
 	void *ctx;
@@ -72,6 +74,8 @@ eapol_auth_alloc(struct eapol_authenticator *eapol, const u8 *addr,
 		 const char *identity, const char *radius_cui);
 void eapol_auth_free(struct eapol_state_machine *sm);
 void eapol_auth_step(struct eapol_state_machine *sm);
+int eapol_auth_get_pool_mib(struct eapol_authenticator *eapol, char *buf,
+			    size_t buflen);
 int eapol_auth_dump_state(struct eapol_state_machine *sm, char *buf,
 			  size_t buflen);
 int eapol_auth_eap_pending_cb(struct eapol_state_machine *sm, void *ctx);
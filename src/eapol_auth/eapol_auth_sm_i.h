@@ -30,6 +30,8 @@ struct eapol_authenticator {
 
 	u8 *default_wep_key;
 	u8 default_wep_key_idx;
+
+	struct objpool *sm_pool; /* struct eapol_state_machine allocations */
 };
 
 
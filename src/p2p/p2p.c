@@ -50,23 +50,156 @@ static void p2p_scan_timeout(void *eloop_ctx, void *timeout_ctx);
 #endif /* P2P_PEER_EXPIRATION_AGE */
 
 
+/*
+ * The expiry heap is ordered by the last_seen value of each peer at the time
+ * the peer was last positioned in the heap (expire_key). last_seen is updated
+ * in many places without touching the heap, so the heap is corrected lazily:
+ * when the top entry's key no longer matches its last_seen, it is updated and
+ * moved down before the top is used. This relies on last_seen only moving
+ * forward, so the places that may set an older last_seen (e.g., from a delayed
+ * scan result) call p2p_expire_heap_update() to move the entry up.
+ */
+
+static void p2p_expire_heap_set(struct p2p_data *p2p, size_t pos,
+				struct p2p_device *dev)
+{
+	p2p->expire_heap[pos] = dev;
+	dev->expire_pos = pos;
+}
+
+
+static void p2p_expire_heap_up(struct p2p_data *p2p, size_t pos)
+{
+	struct p2p_device *dev = p2p->expire_heap[pos];
+	size_t parent;
+
+	while (pos > 0) {
+		parent = (pos - 1) / 2;
+		if (!os_reltime_before(&dev->expire_key,
+				       &p2p->expire_heap[parent]->expire_key))
+			break;
+		p2p_expire_heap_set(p2p, pos, p2p->expire_heap[parent]);
+		pos = parent;
+	}
+	p2p_expire_heap_set(p2p, pos, dev);
+}
+
+
+static void p2p_expire_heap_down(struct p2p_data *p2p, size_t pos)
+{
+	struct p2p_device *dev = p2p->expire_heap[pos], **heap;
+	size_t child, len = p2p->expire_heap_len;
+
+	heap = p2p->expire_heap;
+	for (;;) {
+		child = 2 * pos + 1;
+		if (child >= len)
+			break;
+		if (child + 1 < len &&
+		    os_reltime_before(&heap[child + 1]->expire_key,
+				      &heap[child]->expire_key))
+			child++;
+		if (!os_reltime_before(&heap[child]->expire_key,
+				       &dev->expire_key))
+			break;
+		p2p_expire_heap_set(p2p, pos, heap[child]);
+		pos = child;
+	}
+	p2p_expire_heap_set(p2p, pos, dev);
+}
+
+
+static int p2p_expire_heap_add(struct p2p_data *p2p, struct p2p_device *dev)
+{
+	struct p2p_device **heap;
+	size_t size;
+
+	if (p2p->expire_heap_len == p2p->expire_heap_size) {
+		size = p2p->expire_heap_size ? p2p->expire_heap_size * 2 : 16;
+		heap = os_realloc_array(p2p->expire_heap, size, sizeof(*heap));
+		if (!heap)
+			return -1;
+		p2p->expire_heap = heap;
+		p2p->expire_heap_size = size;
+	}
+
+	dev->expire_key = dev->last_seen;
+	p2p_expire_heap_set(p2p, p2p->expire_heap_len++, dev);
+	p2p_expire_heap_up(p2p, dev->expire_pos);
+	return 0;
+}
+
+
+static void p2p_expire_heap_del(struct p2p_data *p2p, struct p2p_device *dev)
+{
+	struct p2p_device *last;
+	size_t pos = dev->expire_pos;
+
+	if (pos >= p2p->expire_heap_len || p2p->expire_heap[pos] != dev)
+		return;
+
+	last = p2p->expire_heap[--p2p->expire_heap_len];
+	if (last == dev)
+		return;
+	p2p_expire_heap_set(p2p, pos, last);
+	p2p_expire_heap_up(p2p, pos);
+	p2p_expire_heap_down(p2p, last->expire_pos);
+}
+
+
+/* Reposition a peer whose last_seen may have moved backwards */
+static void p2p_expire_heap_update(struct p2p_data *p2p,
+				   struct p2p_device *dev)
+{
+	size_t pos = dev->expire_pos;
+
+	if (pos >= p2p->expire_heap_len || p2p->expire_heap[pos] != dev ||
+	    !os_reltime_before(&dev->last_seen, &dev->expire_key))
+		return;
+
+	dev->expire_key = dev->last_seen;
+	p2p_expire_heap_up(p2p, pos);
+}
+
+
+/* Get the peer with the oldest last_seen value */
+static struct p2p_device * p2p_expire_heap_oldest(struct p2p_data *p2p)
+{
+	struct p2p_device *dev;
+
+	while (p2p->expire_heap_len) {
+		dev = p2p->expire_heap[0];
+		if (dev->expire_key.sec == dev->last_seen.sec &&
+		    dev->expire_key.usec == dev->last_seen.usec)
+			return dev;
+		dev->expire_key = dev->last_seen;
+		p2p_expire_heap_down(p2p, 0);
+	}
+
+	return NULL;
+}
+
+
 void p2p_expire_peers(struct p2p_data *p2p)
 {
-	struct p2p_device *dev, *n;
+	struct p2p_device *dev, *go_neg_peer = NULL;
 	struct os_reltime now;
 	size_t i;
 
 	os_get_reltime(&now);
-	dl_list_for_each_safe(dev, n, &p2p->devices, struct p2p_device, list) {
+	while ((dev = p2p_expire_heap_oldest(p2p))) {
 		if (dev->last_seen.sec + P2P_PEER_EXPIRATION_AGE >= now.sec)
-			continue;
+			break;
 
 		if (dev == p2p->go_neg_peer) {
 			/*
 			 * GO Negotiation is in progress with the peer, so
 			 * don't expire the peer entry until GO Negotiation
-			 * fails or times out.
+			 * fails or times out. Take it out of the heap for
+			 * now to get to the other peers.
 			 */
+			p2p_expire_heap_del(p2p, dev);
+			go_neg_peer = dev;
 			continue;
 		}
 
@@ -100,6 +233,13 @@ void p2p_expire_peers(struct p2p_data *p2p)
 		dl_list_del(&dev->list);
 		p2p_device_free(p2p, dev);
 	}
+
+	/*
+	 * The heap had room for this entry before it was taken out, so this
+	 * cannot fail.
+	 */
+	if (go_neg_peer)
+		p2p_expire_heap_add(p2p, go_neg_peer);
 }
 
 
@@ -376,7 +516,8 @@ static void p2p_device_clear_reported(struct p2p_data *p2p)
 struct p2p_device * p2p_get_device(struct p2p_data *p2p, const u8 *addr)
 {
 	struct p2p_device *dev;
-	dl_list_for_each(dev, &p2p->devices, struct p2p_device, list) {
+
+	for (dev = p2p->dev_hash[P2P_DEV_HASH(addr)]; dev; dev = dev->hnext) {
 		if (os_memcmp(dev->info.p2p_device_addr, addr, ETH_ALEN) == 0)
 			return dev;
 	}
@@ -393,12 +534,73 @@ struct p2p_device * p2p_get_device(struct p2p_data *p2p, const u8 *addr)
 struct p2p_device * p2p_get_device_interface(struct p2p_data *p2p,
 					     const u8 *addr)
 {
-	struct p2p_device *dev;
-	dl_list_for_each(dev, &p2p->devices, struct p2p_device, list) {
-		if (os_memcmp(dev->interface_addr, addr, ETH_ALEN) == 0)
-			return dev;
+	struct p2p_device *dev, *found = NULL;
+
+	if (is_zero_ether_addr(addr)) {
+		/* Peers without an interface address are not hashed */
+		dl_list_for_each(dev, &p2p->devices, struct p2p_device, list) {
+			if (is_zero_ether_addr(dev->interface_addr))
+				return dev;
+		}
+		return NULL;
+	}
+
+	/*
+	 * More than one peer may use the same interface address. Return the
+	 * newest one, i.e., the first one in p2p->devices.
+	 */
+	for (dev = p2p->iface_hash[P2P_DEV_HASH(addr)]; dev;
+	     dev = dev->iface_hnext) {
+		if (os_memcmp(dev->interface_addr, addr, ETH_ALEN) == 0 &&
+		    (!found || (int) (dev->seq - found->seq) > 0))
+			found = dev;
+	}
+	return found;
+}
+
+
+static void p2p_device_iface_hash_del(struct p2p_data *p2p,
+				      struct p2p_device *dev)
+{
+	struct p2p_device **pos;
+
+	if (is_zero_ether_addr(dev->interface_addr))
+		return;
+
+	for (pos = &p2p->iface_hash[P2P_DEV_HASH(dev->interface_addr)]; *pos;
+	     pos = &(*pos)->iface_hnext) {
+		if (*pos == dev) {
+			*pos = dev->iface_hnext;
+			break;
+		}
 	}
-	return NULL;
+}
+
+
+/**
+ * p2p_device_set_interface_addr - Set the P2P Interface Address of a peer
+ * @p2p: P2P module context from p2p_init()
+ * @dev: Peer entry
+ * @addr: P2P Interface Address
+ *
+ * This must be used instead of writing dev->interface_addr directly to keep
+ * the peer lookup by interface address up to date.
+ */
+void p2p_device_set_interface_addr(struct p2p_data *p2p,
+				   struct p2p_device *dev, const u8 *addr)
+{
+	u8 hash;
+
+	if (os_memcmp(dev->interface_addr, addr, ETH_ALEN) == 0)
+		return;
+
+	p2p_device_iface_hash_del(p2p, dev);
+	os_memcpy(dev->interface_addr, addr, ETH_ALEN);
+	if (is_zero_ether_addr(addr))
+		return;
+	hash = P2P_DEV_HASH(addr);
+	dev->iface_hnext = p2p->iface_hash[hash];
+	p2p->iface_hash[hash] = dev;
 }
 
 
@@ -414,32 +616,38 @@ struct p2p_device * p2p_get_device_interface(struct p2p_data *p2p,
 static struct p2p_device * p2p_create_device(struct p2p_data *p2p,
 					     const u8 *addr)
 {
-	struct p2p_device *dev, *oldest = NULL;
-	size_t count = 0;
+	struct p2p_device *dev, *oldest;
+	u8 hash;
 
 	dev = p2p_get_device(p2p, addr);
 	if (dev)
 		return dev;
 
-	dl_list_for_each(dev, &p2p->devices, struct p2p_device, list) {
-		count++;
-		if (oldest == NULL ||
-		    os_reltime_before(&dev->last_seen, &oldest->last_seen))
-			oldest = dev;
-	}
-	if (count + 1 > p2p->cfg->max_peers && oldest) {
-		p2p_dbg(p2p,
-			"Remove oldest peer entry to make room for a new peer "
-			MACSTR, MAC2STR(oldest->info.p2p_device_addr));
-		dl_list_del(&oldest->list);
-		p2p_device_free(p2p, oldest);
+	/* Each peer is in the expiry heap, so its size is the peer count */
+	if (p2p->expire_heap_len + 1 > p2p->cfg->max_peers) {
+		oldest = p2p_expire_heap_oldest(p2p);
+		if (oldest) {
+			p2p_dbg(p2p,
+				"Remove oldest peer entry to make room for a new peer "
+				MACSTR, MAC2STR(oldest->info.p2p_device_addr));
+			dl_list_del(&oldest->list);
+			p2p_device_free(p2p, oldest);
+		}
 	}
 
 	dev = os_zalloc(sizeof(*dev));
 	if (dev == NULL)
 		return NULL;
+	if (p2p_expire_heap_add(p2p, dev) < 0) {
+		os_free(dev);
+		return NULL;
+	}
 	dl_list_add(&p2p->devices, &dev->list);
 	os_memcpy(dev->info.p2p_device_addr, addr, ETH_ALEN);
+	dev->seq = p2p->dev_seq++;
+	hash = P2P_DEV_HASH(addr);
+	dev->hnext = p2p->dev_hash[hash];
+	p2p->dev_hash[hash] = dev;
 
 	return dev;
 }
@@ -531,9 +739,10 @@ static int p2p_add_group_clients(struct p2p_data *p2p, const u8 *go_dev_addr,
 			dev->flags |= P2P_DEV_REPORTED | P2P_DEV_REPORTED_ONCE;
 		}
 
-		os_memcpy(dev->interface_addr, cli->p2p_interface_addr,
-			  ETH_ALEN);
+		p2p_device_set_interface_addr(p2p, dev,
+					      cli->p2p_interface_addr);
 		os_memcpy(&dev->last_seen, rx_time, sizeof(struct os_reltime));
+		p2p_expire_heap_update(p2p, dev);
 		os_memcpy(dev->member_in_go_dev, go_dev_addr, ETH_ALEN);
 		os_memcpy(dev->member_in_go_iface, go_interface_addr,
 			  ETH_ALEN);
@@ -780,12 +989,13 @@ int p2p_add_device(struct p2p_data *p2p, const u8 *addr, int freq,
 	}
 
 	os_memcpy(&dev->last_seen, rx_time, sizeof(struct os_reltime));
+	p2p_expire_heap_update(p2p, dev);
 
 	dev->flags &= ~(P2P_DEV_PROBE_REQ_ONLY | P2P_DEV_GROUP_CLIENT_ONLY |
 			P2P_DEV_LAST_SEEN_AS_GROUP_CLIENT);
 
 	if (os_memcmp(addr, p2p_dev_addr, ETH_ALEN) != 0)
-		os_memcpy(dev->interface_addr, addr, ETH_ALEN);
+		p2p_device_set_interface_addr(p2p, dev, addr);
 	if (msg.ssid &&
 	    msg.ssid[1] <= sizeof(dev->oper_ssid) &&
 	    (msg.ssid[1] != P2P_WILDCARD_SSID_LEN ||
@@ -915,8 +1125,19 @@ int p2p_add_device(struct p2p_data *p2p, const u8 *addr, int freq,
 
 static void p2p_device_free(struct p2p_data *p2p, struct p2p_device *dev)
 {
+	struct p2p_device **pos;
 	int i;
 
+	for (pos = &p2p->dev_hash[P2P_DEV_HASH(dev->info.p2p_device_addr)];
+	     *pos; pos = &(*pos)->hnext) {
+		if (*pos == dev) {
+			*pos = dev->hnext;
+			break;
+		}
+	}
+	p2p_device_iface_hash_del(p2p, dev);
+	p2p_expire_heap_del(p2p, dev);
+
 	if (p2p->go_neg_peer == dev) {
 		/*
 		 * If GO Negotiation is in progress, report that it has failed.
@@ -3022,6 +3243,7 @@ void p2p_deinit(struct p2p_data *p2p)
 	eloop_cancel_timeout(p2p_go_neg_start, p2p, NULL);
 	eloop_cancel_timeout(p2p_go_neg_wait_timeout, p2p, NULL);
 	p2p_flush(p2p);
+	os_free(p2p->expire_heap);
 	p2p_free_req_dev_types(p2p);
 	os_free(p2p->cfg->dev_name);
 	os_free(p2p->cfg->manufacturer);
@@ -29,6 +29,9 @@ enum p2p_role_indication;
 #define MAX_SVC_ADV_LEN	600
 #define MAX_SVC_ADV_IE_LEN (9 + MAX_SVC_ADV_LEN + (5 * (MAX_SVC_ADV_LEN / 240)))
 
+#define P2P_DEV_HASH_SIZE 256
+#define P2P_DEV_HASH(a) ((a)[5])
+
 enum p2p_go_state {
 	UNKNOWN_GO,
 	LOCAL_GO,
@@ -40,7 +43,18 @@ enum p2p_go_state {
  */
 struct p2p_device {
 	struct dl_list list;
+	struct p2p_device *hnext; /* next entry in p2p->dev_hash */
+	struct p2p_device *iface_hnext; /* next entry in p2p->iface_hash */
+	unsigned int seq; /* creation order */
 	struct os_reltime last_seen;
+
+	/*
+	 * Position in p2p->expire_heap and the last_seen value the position
+	 * is based on.
+	 */
+	size_t expire_pos;
+	struct os_reltime expire_key;
+
 	int listen_freq;
 	int oob_go_neg_freq;
 	enum p2p_wps_method wps_method;
@@ -260,6 +274,33 @@ struct p2p_data {
 	 */
 	struct dl_list devices;
 
+	/**
+	 * dev_hash - Peers hashed by P2P Device Address
+	 */
+	struct p2p_device *dev_hash[P2P_DEV_HASH_SIZE];
+
+	/**
+	 * iface_hash - Peers hashed by P2P Interface Address
+	 *
+	 * Only peers with a non-zero interface_addr are included.
+	 */
+	struct p2p_device *iface_hash[P2P_DEV_HASH_SIZE];
+
+	/**
+	 * dev_seq - Sequence number for the next peer entry
+	 */
+	unsigned int dev_seq;
+
+	/**
+	 * expire_heap - Peers in a min-heap ordered by last_seen
+	 *
+	 * This is used for finding the peers to expire and the oldest peer
+	 * without going through all peers. Each peer is in the heap.
+	 */
+	struct p2p_device **expire_heap;
+	size_t expire_heap_len;
+	size_t expire_heap_size;
+
 	/**
 	 * go_neg_peer - Pointer to GO Negotiation peer
 	 */
@@ -872,6 +913,8 @@ int p2p_add_device(struct p2p_data *p2p, const u8 *addr, int freq,
 struct p2p_device * p2p_get_device(struct p2p_data *p2p, const u8 *addr);
 struct p2p_device * p2p_get_device_interface(struct p2p_data *p2p,
 					     const u8 *addr);
+void p2p_device_set_interface_addr(struct p2p_data *p2p,
+				   struct p2p_device *dev, const u8 *addr);
 void p2p_go_neg_failed(struct p2p_data *p2p, int status);
 void p2p_go_complete(struct p2p_data *p2p, struct p2p_device *peer);
 int p2p_match_dev_type(struct p2p_data *p2p, struct wpabuf *wps);
@@ -46,6 +46,27 @@ struct radius_msg {
 	 * attr_used - Total number of attributes in the array
 	 */
 	size_t attr_used;
+
+	/**
+	 * attr_first - Per-type index to the first attribute of that type
+	 *
+	 * The values are indexes to attr_pos plus one; 0 = no attribute of the
+	 * type in the message.
+	 */
+	u16 attr_first[256];
+
+	/**
+	 * attr_last - Per-type index to the last attribute of that type
+	 */
+	u16 attr_last[256];
+
+	/**
+	 * attr_next - Index to the next attribute of the same type
+	 *
+	 * This array is allocated with the same size as attr_pos and uses the
+	 * same index plus one encoding as attr_first.
+	 */
+	u16 *attr_next;
 };
 
 
@@ -69,6 +90,20 @@ radius_get_attr_hdr(struct radius_msg *msg, int idx)
 }
 
 
+/* Iterate over the attributes of a specific type in message order using the
+ * per-type index; these return -1 when there are no more attributes. */
+static int radius_msg_first_attr(struct radius_msg *msg, u8 type)
+{
+	return (int) msg->attr_first[type] - 1;
+}
+
+
+static int radius_msg_next_attr(struct radius_msg *msg, int idx)
+{
+	return (int) msg->attr_next[idx] - 1;
+}
+
+
 static void radius_msg_set_hdr(struct radius_msg *msg, u8 code, u8 identifier)
 {
 	msg->hdr->code = code;
@@ -80,7 +115,9 @@ static int radius_msg_initialize(struct radius_msg *msg)
 {
 	msg->attr_pos = os_calloc(RADIUS_DEFAULT_ATTR_COUNT,
 				  sizeof(*msg->attr_pos));
-	if (msg->attr_pos == NULL)
+	msg->attr_next = os_calloc(RADIUS_DEFAULT_ATTR_COUNT,
+				   sizeof(*msg->attr_next));
+	if (msg->attr_pos == NULL || msg->attr_next == NULL)
 		return -1;
 
 	msg->attr_size = RADIUS_DEFAULT_ATTR_COUNT;
@@ -131,6 +168,7 @@ void radius_msg_free(struct radius_msg *msg)
 
 	wpabuf_free(msg->buf);
 	os_free(msg->attr_pos);
+	os_free(msg->attr_next);
 	os_free(msg);
 }
 
@@ -539,6 +577,112 @@ int radius_msg_verify_acct_req(struct radius_msg *msg, const u8 *secret,
 }
 
 
+/**
+ * radius_msg_finish_acct_resp_batch - Finish a batch of Accounting-Responses
+ * @msgs: RADIUS messages to finish
+ * @secret: Shared secret for each message
+ * @secret_len: Length of each shared secret
+ * @req_authenticator: Request Authenticator for each message
+ * @num: Number of messages (at most RADIUS_MSG_BATCH_MAX)
+ * Returns: 0 on success, -1 on failure
+ *
+ * This is equivalent to calling radius_msg_finish_acct_resp() for each
+ * message, but computes the Response Authenticators with multi-buffer MD5.
+ */
+int radius_msg_finish_acct_resp_batch(struct radius_msg *msgs[],
+				      const u8 *secret[],
+				      const size_t secret_len[],
+				      const u8 *req_authenticator[], size_t num)
+{
+	struct md5_mb_job jobs[RADIUS_MSG_BATCH_MAX];
+	const u8 *addr[RADIUS_MSG_BATCH_MAX][2];
+	size_t len[RADIUS_MSG_BATCH_MAX][2];
+	size_t i;
+
+	if (num > RADIUS_MSG_BATCH_MAX)
+		return -1;
+
+	for (i = 0; i < num; i++) {
+		struct radius_msg *msg = msgs[i];
+
+		if (wpabuf_len(msg->buf) > 0xffff) {
+			wpa_printf(MSG_WARNING, "RADIUS: Too long messages (%lu)",
+				   (unsigned long) wpabuf_len(msg->buf));
+		}
+		msg->hdr->length = host_to_be16(wpabuf_len(msg->buf));
+		os_memcpy(msg->hdr->authenticator, req_authenticator[i],
+			  MD5_MAC_LEN);
+		addr[i][0] = wpabuf_head(msg->buf);
+		len[i][0] = wpabuf_len(msg->buf);
+		addr[i][1] = secret[i];
+		len[i][1] = secret_len[i];
+		jobs[i].num_elem = 2;
+		jobs[i].addr = addr[i];
+		jobs[i].len = len[i];
+		jobs[i].mac = msg->hdr->authenticator;
+	}
+
+	return md5_vector_mb(jobs, num);
+}
+
+
+/**
+ * radius_msg_verify_acct_req_batch - Verify a batch of Accounting-Requests
+ * @msgs: Received RADIUS messages
+ * @secret: Shared secret for each message
+ * @secret_len: Length of each shared secret
+ * @num: Number of messages (at most RADIUS_MSG_BATCH_MAX)
+ * @res: Buffer for the result of each message: 0 = valid Request
+ *	Authenticator, 1 = invalid
+ * Returns: 0 on success, -1 on failure
+ *
+ * This is equivalent to calling radius_msg_verify_acct_req() for each
+ * message, but computes the authenticators with multi-buffer MD5.
+ */
+int radius_msg_verify_acct_req_batch(struct radius_msg *msgs[],
+				     const u8 *secret[],
+				     const size_t secret_len[], size_t num,
+				     int res[])
+{
+	struct md5_mb_job jobs[RADIUS_MSG_BATCH_MAX];
+	const u8 *addr[RADIUS_MSG_BATCH_MAX][4];
+	size_t len[RADIUS_MSG_BATCH_MAX][4];
+	u8 hash[RADIUS_MSG_BATCH_MAX][MD5_MAC_LEN];
+	u8 zero[MD5_MAC_LEN];
+	size_t i;
+
+	if (num > RADIUS_MSG_BATCH_MAX)
+		return -1;
+
+	os_memset(zero, 0, sizeof(zero));
+	for (i = 0; i < num; i++) {
+		struct radius_msg *msg = msgs[i];
+
+		addr[i][0] = (u8 *) msg->hdr;
+		len[i][0] = sizeof(struct radius_hdr) - MD5_MAC_LEN;
+		addr[i][1] = zero;
+		len[i][1] = MD5_MAC_LEN;
+		addr[i][2] = (u8 *) (msg->hdr + 1);
+		len[i][2] = wpabuf_len(msg->buf) - sizeof(struct radius_hdr);
+		addr[i][3] = secret[i];
+		len[i][3] = secret_len[i];
+		jobs[i].num_elem = 4;
+		jobs[i].addr = addr[i];
+		jobs[i].len = len[i];
+		jobs[i].mac = hash[i];
+	}
+
+	if (md5_vector_mb(jobs, num))
+		return -1;
+
+	for (i = 0; i < num; i++)
+		res[i] = os_memcmp_const(msgs[i]->hdr->authenticator, hash[i],
+					 MD5_MAC_LEN) != 0;
+
+	return 0;
+}
+
+
 int radius_msg_verify_das_req(struct radius_msg *msg, const u8 *secret,
 			      size_t secret_len,
 			      int require_message_authenticator)
@@ -550,8 +694,8 @@ int radius_msg_verify_das_req(struct radius_msg *msg, const u8 *secret,
 	u8 auth[MD5_MAC_LEN], orig[MD5_MAC_LEN];
 	u8 orig_authenticator[16];
 
-	struct radius_attr_hdr *attr = NULL, *tmp;
-	size_t i;
+	struct radius_attr_hdr *attr = NULL;
+	int idx;
 
 	os_memset(zero, 0, sizeof(zero));
 	addr[0] = (u8 *) msg->hdr;
@@ -566,17 +710,15 @@ int radius_msg_verify_das_req(struct radius_msg *msg, const u8 *secret,
 	if (os_memcmp_const(msg->hdr->authenticator, hash, MD5_MAC_LEN) != 0)
 		return 1;
 
-	for (i = 0; i < msg->attr_used; i++) {
-		tmp = radius_get_attr_hdr(msg, i);
-		if (tmp->type == RADIUS_ATTR_MESSAGE_AUTHENTICATOR) {
-			if (attr != NULL) {
-				wpa_printf(MSG_WARNING, "Multiple "
-					   "Message-Authenticator attributes "
-					   "in RADIUS message");
-				return 1;
-			}
-			attr = tmp;
+	idx = radius_msg_first_attr(msg, RADIUS_ATTR_MESSAGE_AUTHENTICATOR);
+	if (idx >= 0) {
+		if (radius_msg_next_attr(msg, idx) >= 0) {
+			wpa_printf(MSG_WARNING, "Multiple "
+				   "Message-Authenticator attributes "
+				   "in RADIUS message");
+			return 1;
 		}
+		attr = radius_get_attr_hdr(msg, idx);
 	}
 
 	if (attr == NULL) {
@@ -607,21 +749,39 @@ int radius_msg_verify_das_req(struct radius_msg *msg, const u8 *secret,
 static int radius_msg_add_attr_to_array(struct radius_msg *msg,
 					struct radius_attr_hdr *attr)
 {
+	size_t idx;
+
 	if (msg->attr_used >= msg->attr_size) {
 		size_t *nattr_pos;
+		u16 *nattr_next;
 		size_t nlen = msg->attr_size * 2;
 
+		if (nlen > 0xffff)
+			return -1;
+
 		nattr_pos = os_realloc_array(msg->attr_pos, nlen,
 					     sizeof(*msg->attr_pos));
 		if (nattr_pos == NULL)
 			return -1;
-
 		msg->attr_pos = nattr_pos;
+
+		nattr_next = os_realloc_array(msg->attr_next, nlen,
+					      sizeof(*msg->attr_next));
+		if (nattr_next == NULL)
+			return -1;
+		msg->attr_next = nattr_next;
+
 		msg->attr_size = nlen;
 	}
 
-	msg->attr_pos[msg->attr_used++] =
-		(unsigned char *) attr - wpabuf_head_u8(msg->buf);
+	idx = msg->attr_used++;
+	msg->attr_pos[idx] = (unsigned char *) attr - wpabuf_head_u8(msg->buf);
+	msg->attr_next[idx] = 0;
+	if (msg->attr_last[attr->type])
+		msg->attr_next[msg->attr_last[attr->type] - 1] = idx + 1;
+	else
+		msg->attr_first[attr->type] = idx + 1;
+	msg->attr_last[attr->type] = idx + 1;
 
 	return 0;
 }
@@ -664,48 +824,55 @@ struct radius_attr_hdr *radius_msg_add_attr(struct radius_msg *msg, u8 type,
 
 
 /**
- * radius_msg_parse - Parse a RADIUS message
- * @data: RADIUS message to be parsed
- * @len: Length of data buffer in octets
+ * radius_msg_parse_buf - Parse a RADIUS message in place
+ * @buf: Received RADIUS message; this is freed on failure
  * Returns: Parsed RADIUS message or %NULL on failure
  *
- * This parses a RADIUS message and makes a copy of its data. The caller is
- * responsible for freeing the returned data with radius_msg_free().
+ * This parses a RADIUS message without copying its data. On success, the
+ * returned message takes over the ownership of buf and the caller is
+ * responsible for freeing the returned data with radius_msg_free(). This
+ * allows the receive paths to parse the datagram directly from the buffer it
+ * was received into.
  */
-struct radius_msg * radius_msg_parse(const u8 *data, size_t len)
+struct radius_msg * radius_msg_parse_buf(struct wpabuf *buf)
 {
 	struct radius_msg *msg;
 	struct radius_hdr *hdr;
 	struct radius_attr_hdr *attr;
-	size_t msg_len;
+	size_t msg_len, len;
 	unsigned char *pos, *end;
 
-	if (data == NULL || len < sizeof(*hdr))
+	if (buf == NULL)
 		return NULL;
 
-	hdr = (struct radius_hdr *) data;
+	len = wpabuf_len(buf);
+	if (len < sizeof(*hdr))
+		goto fail_buf;
+
+	hdr = wpabuf_mhead(buf);
 
 	msg_len = be_to_host16(hdr->length);
 	if (msg_len < sizeof(*hdr) || msg_len > len) {
 		wpa_printf(MSG_INFO, "RADIUS: Invalid message length");
-		return NULL;
+		goto fail_buf;
 	}
 
 	if (msg_len < len) {
 		wpa_printf(MSG_DEBUG, "RADIUS: Ignored %lu extra bytes after "
 			   "RADIUS message", (unsigned long) len - msg_len);
+		buf->used = msg_len;
 	}
 
 	msg = os_zalloc(sizeof(*msg));
 	if (msg == NULL)
-		return NULL;
+		goto fail_buf;
 
-	msg->buf = wpabuf_alloc_copy(data, msg_len);
-	if (msg->buf == NULL || radius_msg_initialize(msg)) {
+	msg->buf = buf;
+	if (radius_msg_initialize(msg)) {
 		radius_msg_free(msg);
 		return NULL;
 	}
-	msg->hdr = wpabuf_mhead(msg->buf);
+	msg->hdr = hdr;
 
 	/* parse attributes */
 	pos = wpabuf_mhead_u8(msg->buf) + sizeof(struct radius_hdr);
@@ -732,6 +899,39 @@ struct radius_msg * radius_msg_parse(const u8 *data, size_t len)
  fail:
 	radius_msg_free(msg);
 	return NULL;
+ fail_buf:
+	wpabuf_free(buf);
+	return NULL;
+}
+
+
+/**
+ * radius_msg_parse - Parse a RADIUS message
+ * @data: RADIUS message to be parsed
+ * @len: Length of data buffer in octets
+ * Returns: Parsed RADIUS message or %NULL on failure
+ *
+ * This parses a RADIUS message and makes a copy of its data. The caller is
+ * responsible for freeing the returned data with radius_msg_free().
+ */
+struct radius_msg * radius_msg_parse(const u8 *data, size_t len)
+{
+	const struct radius_hdr *hdr;
+	size_t msg_len;
+
+	if (data == NULL || len < sizeof(*hdr))
+		return NULL;
+
+	/* Copy only the RADIUS message itself and not any trailing data */
+	hdr = (const struct radius_hdr *) data;
+	msg_len = be_to_host16(hdr->length);
+	if (msg_len >= sizeof(*hdr) && msg_len < len) {
+		wpa_printf(MSG_DEBUG, "RADIUS: Ignored %lu extra bytes after "
+			   "RADIUS message", (unsigned long) len - msg_len);
+		len = msg_len;
+	}
+
+	return radius_msg_parse_buf(wpabuf_alloc_copy(data, len));
 }
 
 
@@ -762,17 +962,21 @@ int radius_msg_add_eap(struct radius_msg *msg, const u8 *data, size_t data_len)
 struct wpabuf * radius_msg_get_eap(struct radius_msg *msg)
 {
 	struct wpabuf *eap;
-	size_t len, i;
+	size_t len;
+	int first, idx;
 	struct radius_attr_hdr *attr;
 
 	if (msg == NULL)
 		return NULL;
 
+	/* Gather the EAP-Message fragments directly from the message buffer
+	 * into a single exactly sized buffer; only the EAP-Message attributes
+	 * are visited through the per-type index. */
+	first = radius_msg_first_attr(msg, RADIUS_ATTR_EAP_MESSAGE);
 	len = 0;
-	for (i = 0; i < msg->attr_used; i++) {
-		attr = radius_get_attr_hdr(msg, i);
-		if (attr->type == RADIUS_ATTR_EAP_MESSAGE &&
-		    attr->length > sizeof(struct radius_attr_hdr))
+	for (idx = first; idx >= 0; idx = radius_msg_next_attr(msg, idx)) {
+		attr = radius_get_attr_hdr(msg, idx);
+		if (attr->length > sizeof(struct radius_attr_hdr))
 			len += attr->length - sizeof(struct radius_attr_hdr);
 	}
 
@@ -783,10 +987,9 @@ struct wpabuf * radius_msg_get_eap(struct radius_msg *msg)
 	if (eap == NULL)
 		return NULL;
 
-	for (i = 0; i < msg->attr_used; i++) {
-		attr = radius_get_attr_hdr(msg, i);
-		if (attr->type == RADIUS_ATTR_EAP_MESSAGE &&
-		    attr->length > sizeof(struct radius_attr_hdr)) {
+	for (idx = first; idx >= 0; idx = radius_msg_next_attr(msg, idx)) {
+		attr = radius_get_attr_hdr(msg, idx);
+		if (attr->length > sizeof(struct radius_attr_hdr)) {
 			int flen = attr->length - sizeof(*attr);
 			wpabuf_put_data(eap, attr + 1, flen);
 		}
@@ -801,18 +1004,16 @@ int radius_msg_verify_msg_auth(struct radius_msg *msg, const u8 *secret,
 {
 	u8 auth[MD5_MAC_LEN], orig[MD5_MAC_LEN];
 	u8 orig_authenticator[16];
-	struct radius_attr_hdr *attr = NULL, *tmp;
-	size_t i;
+	struct radius_attr_hdr *attr = NULL;
+	int idx;
 
-	for (i = 0; i < msg->attr_used; i++) {
-		tmp = radius_get_attr_hdr(msg, i);
-		if (tmp->type == RADIUS_ATTR_MESSAGE_AUTHENTICATOR) {
-			if (attr != NULL) {
-				wpa_printf(MSG_INFO, "Multiple Message-Authenticator attributes in RADIUS message");
-				return 1;
-			}
-			attr = tmp;
+	idx = radius_msg_first_attr(msg, RADIUS_ATTR_MESSAGE_AUTHENTICATOR);
+	if (idx >= 0) {
+		if (radius_msg_next_attr(msg, idx) >= 0) {
+			wpa_printf(MSG_INFO, "Multiple Message-Authenticator attributes in RADIUS message");
+			return 1;
 		}
+		attr = radius_get_attr_hdr(msg, idx);
 	}
 
 	if (attr == NULL) {
@@ -924,19 +1125,20 @@ static u8 *radius_msg_get_vendor_attr(struct radius_msg *msg, u32 vendor,
 				      u8 subtype, size_t *alen)
 {
 	u8 *data, *pos;
-	size_t i, len;
+	size_t len;
+	int idx;
 
 	if (msg == NULL)
 		return NULL;
 
-	for (i = 0; i < msg->attr_used; i++) {
-		struct radius_attr_hdr *attr = radius_get_attr_hdr(msg, i);
+	for (idx = radius_msg_first_attr(msg, RADIUS_ATTR_VENDOR_SPECIFIC);
+	     idx >= 0; idx = radius_msg_next_attr(msg, idx)) {
+		struct radius_attr_hdr *attr = radius_get_attr_hdr(msg, idx);
 		size_t left;
 		u32 vendor_id;
 		struct radius_attr_vendor *vhdr;
 
-		if (attr->type != RADIUS_ATTR_VENDOR_SPECIFIC ||
-		    attr->length < sizeof(*attr))
+		if (attr->length < sizeof(*attr))
 			continue;
 
 		left = attr->length - sizeof(*attr);
@@ -1358,16 +1560,13 @@ radius_msg_add_attr_user_password(struct radius_msg *msg,
 
 int radius_msg_get_attr(struct radius_msg *msg, u8 type, u8 *buf, size_t len)
 {
-	struct radius_attr_hdr *attr = NULL, *tmp;
-	size_t i, dlen;
+	struct radius_attr_hdr *attr = NULL;
+	size_t dlen;
+	int idx;
 
-	for (i = 0; i < msg->attr_used; i++) {
-		tmp = radius_get_attr_hdr(msg, i);
-		if (tmp->type == type) {
-			attr = tmp;
-			break;
-		}
-	}
+	idx = radius_msg_first_attr(msg, type);
+	if (idx >= 0)
+		attr = radius_get_attr_hdr(msg, idx);
 
 	if (!attr || attr->length < sizeof(*attr))
 		return -1;
@@ -1382,13 +1581,13 @@ int radius_msg_get_attr(struct radius_msg *msg, u8 type, u8 *buf, size_t len)
 int radius_msg_get_attr_ptr(struct radius_msg *msg, u8 type, u8 **buf,
 			    size_t *len, const u8 *start)
 {
-	size_t i;
+	int idx;
 	struct radius_attr_hdr *attr = NULL, *tmp;
 
-	for (i = 0; i < msg->attr_used; i++) {
-		tmp = radius_get_attr_hdr(msg, i);
-		if (tmp->type == type &&
-		    (start == NULL || (u8 *) tmp > start)) {
+	for (idx = radius_msg_first_attr(msg, type); idx >= 0;
+	     idx = radius_msg_next_attr(msg, idx)) {
+		tmp = radius_get_attr_hdr(msg, idx);
+		if (start == NULL || (u8 *) tmp > start) {
 			attr = tmp;
 			break;
 		}
@@ -1405,13 +1604,12 @@ int radius_msg_get_attr_ptr(struct radius_msg *msg, u8 type, u8 **buf,
 
 int radius_msg_count_attr(struct radius_msg *msg, u8 type, int min_len)
 {
-	size_t i;
-	int count;
+	int idx, count = 0;
 
-	for (count = 0, i = 0; i < msg->attr_used; i++) {
-		struct radius_attr_hdr *attr = radius_get_attr_hdr(msg, i);
-		if (attr->type == type &&
-		    attr->length >= sizeof(struct radius_attr_hdr) + min_len)
+	for (idx = radius_msg_first_attr(msg, type); idx >= 0;
+	     idx = radius_msg_next_attr(msg, idx)) {
+		struct radius_attr_hdr *attr = radius_get_attr_hdr(msg, idx);
+		if (attr->length >= sizeof(struct radius_attr_hdr) + min_len)
 			count++;
 	}
 
@@ -1565,6 +1763,7 @@ char * radius_msg_get_tunnel_password(struct radius_msg *msg, int *keylen,
 	u8 hash[16];
 	u8 *pos;
 	size_t i, j = 0;
+	int idx;
 	struct radius_attr_hdr *attr;
 	const u8 *data;
 	size_t dlen;
@@ -1573,12 +1772,9 @@ char * radius_msg_get_tunnel_password(struct radius_msg *msg, int *keylen,
 	char *ret = NULL;
 
 	/* find n-th valid Tunnel-Password attribute */
-	for (i = 0; i < msg->attr_used; i++) {
-		attr = radius_get_attr_hdr(msg, i);
-		if (attr == NULL ||
-		    attr->type != RADIUS_ATTR_TUNNEL_PASSWORD) {
-			continue;
-		}
+	for (idx = radius_msg_first_attr(msg, RADIUS_ATTR_TUNNEL_PASSWORD);
+	     idx >= 0; idx = radius_msg_next_attr(msg, idx)) {
+		attr = radius_get_attr_hdr(msg, idx);
 		if (attr->length <= 5)
 			continue;
 		data = (const u8 *) (attr + 1);
@@ -229,6 +229,9 @@ struct radius_msg;
  * Section 3 ("Packet Format").*/
 #define RADIUS_MAX_MSG_LEN 4096
 
+/* Maximum number of messages in radius_msg_*_batch() calls */
+#define RADIUS_MSG_BATCH_MAX 16
+
 /* MAC address ASCII format for IEEE 802.1X use
  * (draft-congdon-radius-8021x-20.txt) */
 #define RADIUS_802_1X_ADDR_FORMAT "%02X-%02X-%02X-%02X-%02X-%02X"
@@ -254,12 +257,23 @@ void radius_msg_finish_acct_resp(struct radius_msg *msg, const u8 *secret,
 				 const u8 *req_authenticator);
 int radius_msg_verify_acct_req(struct radius_msg *msg, const u8 *secret,
 			       size_t secret_len);
+
+int radius_msg_finish_acct_resp_batch(struct radius_msg *msgs[],
+				      const u8 *secret[],
+				      const size_t secret_len[],
+				      const u8 *req_authenticator[],
+				      size_t num);
+int radius_msg_verify_acct_req_batch(struct radius_msg *msgs[],
+				     const u8 *secret[],
+				     const size_t secret_len[], size_t num,
+				     int res[]);
 int radius_msg_verify_das_req(struct radius_msg *msg, const u8 *secret,
 			      size_t secret_len,
 			      int require_message_authenticator);
 struct radius_attr_hdr * radius_msg_add_attr(struct radius_msg *msg, u8 type,
 					     const u8 *data, size_t data_len);
 struct radius_msg * radius_msg_parse(const u8 *data, size_t len);
+struct radius_msg * radius_msg_parse_buf(struct wpabuf *buf);
 int radius_msg_add_eap(struct radius_msg *msg, const u8 *data,
 		       size_t data_len);
 struct wpabuf * radius_msg_get_eap(struct radius_msg *msg);
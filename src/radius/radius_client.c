@@ -1720,9 +1720,152 @@ int radius_client_get_mib(struct radius_client_data *radius, char *buf,
 }
 
 
+static int radius_ip_addr_equal(const struct hostapd_ip_addr *a,
+				const struct hostapd_ip_addr *b)
+{
+	if (a->af != b->af)
+		return 0;
+#ifdef CONFIG_IPV6
+	if (a->af == AF_INET6)
+		return os_memcmp(&a->u.v6, &b->u.v6, sizeof(a->u.v6)) == 0;
+#endif /* CONFIG_IPV6 */
+	return a->u.v4.s_addr == b->u.v4.s_addr;
+}
+
+
+static int radius_servers_equal(const struct hostapd_radius_server *a,
+				int num_a,
+				const struct hostapd_radius_server *b,
+				int num_b)
+{
+	int i;
+
+	if (num_a != num_b)
+		return 0;
+
+	for (i = 0; i < num_a; i++) {
+		if (!radius_ip_addr_equal(&a[i].addr, &b[i].addr) ||
+		    a[i].port != b[i].port ||
+		    a[i].shared_secret_len != b[i].shared_secret_len ||
+		    os_memcmp(a[i].shared_secret, b[i].shared_secret,
+			      a[i].shared_secret_len) != 0)
+			return 0;
+	}
+
+	return 1;
+}
+
+
+/*
+ * Move the current server selection, the MIB counters, and the pending
+ * messages from the old configuration to an identical new server list.
+ */
+static struct hostapd_radius_server *
+radius_client_move_servers(struct radius_client_data *radius,
+			   struct hostapd_radius_server *oservers,
+			   struct hostapd_radius_server *nservers, int num,
+			   struct hostapd_radius_server *current, int auth)
+{
+	struct radius_msg_list *entry;
+	int i;
+
+	for (entry = radius->msgs; entry; entry = entry->next) {
+		if ((auth && entry->msg_type != RADIUS_AUTH) ||
+		    (!auth && entry->msg_type == RADIUS_AUTH))
+			continue;
+		for (i = 0; i < num; i++) {
+			if (entry->shared_secret == oservers[i].shared_secret) {
+				entry->shared_secret =
+					nservers[i].shared_secret;
+				break;
+			}
+		}
+	}
+
+	for (i = 0; i < num; i++) {
+		u8 *shared_secret = nservers[i].shared_secret;
+
+		nservers[i] = oservers[i];
+		nservers[i].shared_secret = shared_secret;
+	}
+
+	if (!current)
+		return NULL;
+	return &nservers[current - oservers];
+}
+
+
+/**
+ * radius_client_reconfig - Update RADIUS client configuration
+ * @radius: RADIUS client context from radius_client_init()
+ * @conf: New RADIUS client configuration (RADIUS servers)
+ *
+ * The previous configuration must still be valid when this is called. If the
+ * server lists did not change, the current servers, sockets, pending messages,
+ * and MIB counters are retained. Otherwise, pending authentication messages
+ * are flushed and the client connects to the new primary servers.
+ */
 void radius_client_reconfig(struct radius_client_data *radius,
 			    struct hostapd_radius_servers *conf)
 {
-	if (radius)
-		radius->conf = conf;
+	struct hostapd_radius_servers *old;
+	int same_client;
+
+	if (!radius)
+		return;
+
+	old = radius->conf;
+	radius->conf = conf;
+	if (old == conf)
+		return;
+
+	same_client = old->force_client_addr == conf->force_client_addr &&
+		(!conf->force_client_addr ||
+		 radius_ip_addr_equal(&old->client_addr, &conf->client_addr)) &&
+		os_strcmp(old->force_client_dev ? old->force_client_dev : "",
+			  conf->force_client_dev ? conf->force_client_dev : "") ==
+		0;
+
+	if (same_client &&
+	    radius_servers_equal(old->auth_servers, old->num_auth_servers,
+				 conf->auth_servers, conf->num_auth_servers)) {
+		conf->auth_server = radius_client_move_servers(
+			radius, old->auth_servers, conf->auth_servers,
+			conf->num_auth_servers, old->auth_server, 1);
+	} else {
+		wpa_printf(MSG_DEBUG,
+			   "RADIUS: Authentication servers changed");
+		radius_client_flush(radius, 1);
+		if (conf->auth_server)
+			radius_client_init_auth(radius);
+		else
+			radius_close_auth_sockets(radius);
+	}
+
+	if (same_client &&
+	    radius_servers_equal(old->acct_servers, old->num_acct_servers,
+				 conf->acct_servers, conf->num_acct_servers)) {
+		conf->acct_server = radius_client_move_servers(
+			radius, old->acct_servers, conf->acct_servers,
+			conf->num_acct_servers, old->acct_server, 0);
+	} else {
+		wpa_printf(MSG_DEBUG, "RADIUS: Accounting servers changed");
+		if (conf->acct_server) {
+			radius_client_update_acct_msgs(
+				radius, conf->acct_server->shared_secret,
+				conf->acct_server->shared_secret_len);
+			radius_client_init_acct(radius);
+		} else {
+			radius_close_acct_sockets(radius);
+			radius_client_flush(radius, 0);
+		}
+	}
+
+	if (old->retry_primary_interval != conf->retry_primary_interval) {
+		eloop_cancel_timeout(radius_retry_primary_timer, radius, NULL);
+		if (conf->retry_primary_interval)
+			eloop_register_timeout(conf->retry_primary_interval, 0,
+					       radius_retry_primary_timer,
+					       radius, NULL);
+	}
 }
@@ -35,6 +35,22 @@
  */
 #define RADIUS_MAX_SESSION 1000
 
+/**
+ * RADIUS_FRAGMENT_OVERHEAD - EAP header octets on top of the fragment size
+ *
+ * EAP header (4), Type (1), Flags (1), and TLS Message Length (4) in
+ * EAP-TLS/TTLS/PEAP/FAST/TEAP fragments.
+ */
+#define RADIUS_FRAGMENT_OVERHEAD 10
+
+/**
+ * RADIUS_MAX_FRAGMENT_SIZE - Maximum fragment size derived from Framed-MTU
+ *
+ * This keeps Access-Challenge messages with State and Message-Authenticator
+ * well below the 4096 octet RADIUS message limit.
+ */
+#define RADIUS_MAX_FRAGMENT_SIZE 3000
+
 static const struct eapol_callbacks radius_server_eapol_cb;
 
 struct radius_client;
@@ -77,7 +93,7 @@ struct radius_session {
 	char *nas_ip;
 	u8 mac_addr[ETH_ALEN]; /* from Calling-Station-Id attribute */
 
-	struct radius_msg *last_msg;
+	struct wpabuf *last_msg; /* pending request; parsed again when resumed */
 	char *last_from_addr;
 	int last_from_port;
 	struct sockaddr_storage last_from;
@@ -389,7 +405,7 @@ static void radius_server_session_free(struct radius_server_data *data,
 	eloop_cancel_timeout(radius_server_session_timeout, data, sess);
 	eloop_cancel_timeout(radius_server_session_remove_timeout, data, sess);
 	eap_server_sm_deinit(sess->eap);
-	radius_msg_free(sess->last_msg);
+	wpabuf_free(sess->last_msg);
 	os_free(sess->last_from_addr);
 	radius_msg_free(sess->last_reply);
 	os_free(sess->username);
@@ -538,6 +554,30 @@ static void radius_server_testing_options(struct radius_session *sess,
 }
 
 
+static int radius_server_fragment_size(struct radius_session *sess,
+				       struct radius_msg *msg)
+{
+	int frag, conf = sess->server->eap_cfg->fragment_size;
+	u32 mtu;
+
+	/* RFC 3579, 2.4: Framed-MTU is the maximum size of the EAP packets
+	 * that the NAS can deliver to the peer */
+	if (radius_msg_get_attr_int32(msg, RADIUS_ATTR_FRAMED_MTU, &mtu) < 0)
+		return 0;
+	if (mtu < 64 + RADIUS_FRAGMENT_OVERHEAD) {
+		srv_log(sess, "Ignore too small Framed-MTU %u", mtu);
+		return 0;
+	}
+	frag = mtu - RADIUS_FRAGMENT_OVERHEAD;
+	if (mtu > RADIUS_MAX_FRAGMENT_SIZE + RADIUS_FRAGMENT_OVERHEAD)
+		frag = RADIUS_MAX_FRAGMENT_SIZE;
+	if (conf > 0 && conf < frag)
+		frag = conf;
+	RADIUS_DEBUG("Framed-MTU %u: use TLS fragment size %d", mtu, frag);
+	return frag;
+}
+
+
 #ifdef CONFIG_ERP
 static struct eap_server_erp_key *
 radius_server_erp_find_key(struct radius_server_data *data, const char *keyname)
@@ -642,6 +682,7 @@ radius_server_get_new_session(struct radius_server_data *data,
 	srv_log(sess, "New session created");
 
 	os_memset(&eap_sess, 0, sizeof(eap_sess));
+	eap_sess.tls_fragment_size = radius_server_fragment_size(sess, msg);
 	radius_server_testing_options(sess, &eap_sess);
 	sess->eap = eap_server_sm_init(sess, &radius_server_eapol_cb,
 				       data->eap_cfg, &eap_sess);
@@ -1450,8 +1491,14 @@ static int radius_server_request(struct radius_server_data *data,
 		RADIUS_DEBUG("No EAP data from the state machine, but eapFail "
 			     "set");
 	} else if (eap_sm_method_pending(sess->eap)) {
-		radius_msg_free(sess->last_msg);
-		sess->last_msg = msg;
+		/*
+		 * Keep only a copy of the message since the received message
+		 * holds a maximum size receive buffer and the attribute index.
+		 */
+		wpabuf_free(sess->last_msg);
+		sess->last_msg = wpabuf_dup(radius_msg_get_buf(msg));
+		if (!sess->last_msg)
+			return -1;
 		sess->last_from_port = from_port;
 		os_free(sess->last_from_addr);
 		sess->last_from_addr = os_strdup(from_addr);
@@ -1654,7 +1701,7 @@ static void radius_server_receive_auth(int sock, void *eloop_ctx,
 				       void *sock_ctx)
 {
 	struct radius_server_data *data = eloop_ctx;
-	u8 *buf = NULL;
+	struct wpabuf *buf = NULL;
 	union {
 		struct sockaddr_storage ss;
 		struct sockaddr_in sin;
@@ -1669,13 +1716,13 @@ static void radius_server_receive_auth(int sock, void *eloop_ctx,
 	char abuf[50];
 	int from_port = 0;
 
-	buf = os_malloc(RADIUS_MAX_MSG_LEN);
+	buf = wpabuf_alloc(RADIUS_MAX_MSG_LEN);
 	if (buf == NULL) {
 		goto fail;
 	}
 
 	fromlen = sizeof(from);
-	len = recvfrom(sock, buf, RADIUS_MAX_MSG_LEN, 0,
+	len = recvfrom(sock, wpabuf_mhead(buf), RADIUS_MAX_MSG_LEN, 0,
 		       (struct sockaddr *) &from.ss, &fromlen);
 	if (len < 0) {
 		wpa_printf(MSG_INFO, "recvfrom[radius_server]: %s",
@@ -1707,7 +1754,8 @@ static void radius_server_receive_auth(int sock, void *eloop_ctx,
 		client = radius_server_get_client(data, &from.sin.sin_addr, 0);
 	}
 
-	RADIUS_DUMP("Received data", buf, len);
+	wpabuf_put(buf, len);
+	RADIUS_DUMP("Received data", wpabuf_head(buf), len);
 
 	if (client == NULL) {
 		RADIUS_DEBUG("Unknown client %s - packet ignored", abuf);
@@ -1715,7 +1763,9 @@ static void radius_server_receive_auth(int sock, void *eloop_ctx,
 		goto fail;
 	}
 
-	msg = radius_msg_parse(buf, len);
+	/* Parse the message in place; msg takes over the receive buffer */
+	msg = radius_msg_parse_buf(buf);
+	buf = NULL;
 	if (msg == NULL) {
 		RADIUS_DEBUG("Parsing incoming RADIUS frame failed");
 		data->counters.malformed_access_requests++;
@@ -1723,9 +1773,6 @@ static void radius_server_receive_auth(int sock, void *eloop_ctx,
 		goto fail;
 	}
 
-	os_free(buf);
-	buf = NULL;
-
 	if (wpa_debug_level <= MSG_MSGDUMP) {
 		radius_msg_dump(msg);
 	}
@@ -1769,22 +1816,27 @@ static void radius_server_receive_auth(int sock, void *eloop_ctx,
 		goto fail;
 	}
 
-	if (radius_server_request(data, msg, (struct sockaddr *) &from,
-				  fromlen, client, abuf, from_port, NULL) ==
-	    -2)
-		return; /* msg was stored with the session */
+	radius_server_request(data, msg, (struct sockaddr *) &from, fromlen,
+			      client, abuf, from_port, NULL);
 
 fail:
 	radius_msg_free(msg);
-	os_free(buf);
+	wpabuf_free(buf);
 }
 
 
-static void radius_server_receive_acct(int sock, void *eloop_ctx,
-				       void *sock_ctx)
-{
-	struct radius_server_data *data = eloop_ctx;
-	u8 *buf = NULL;
+#ifdef MSG_DONTWAIT
+/* Maximum number of Accounting-Request datagrams processed per socket event;
+ * the authenticators of the batch are computed with multi-buffer MD5. */
+#define RADIUS_SERVER_ACCT_BATCH 8
+#else /* MSG_DONTWAIT */
+#define RADIUS_SERVER_ACCT_BATCH 1
+#define MSG_DONTWAIT 0
+#endif /* MSG_DONTWAIT */
+
+struct radius_server_acct_req {
+	struct radius_msg *msg;
+	struct radius_client *client;
 	union {
 		struct sockaddr_storage ss;
 		struct sockaddr_in sin;
@@ -1793,71 +1845,84 @@ static void radius_server_receive_acct(int sock, void *eloop_ctx,
 #endif /* CONFIG_IPV6 */
 	} from;
 	socklen_t fromlen;
-	int len, res;
-	struct radius_client *client = NULL;
-	struct radius_msg *msg = NULL, *resp = NULL;
 	char abuf[50];
-	int from_port = 0;
-	struct radius_hdr *hdr;
-	struct wpabuf *rbuf;
+	int from_port;
+};
 
-	buf = os_malloc(RADIUS_MAX_MSG_LEN);
-	if (buf == NULL) {
-		goto fail;
-	}
 
-	fromlen = sizeof(from);
-	len = recvfrom(sock, buf, RADIUS_MAX_MSG_LEN, 0,
-		       (struct sockaddr *) &from.ss, &fromlen);
+/* Returns 1 if a valid Accounting-Request was received into req, 0 if a
+ * datagram was received and dropped, or -1 if no more datagrams are
+ * available */
+static int radius_server_recv_acct_req(struct radius_server_data *data,
+				       int sock, int flags,
+				       struct radius_server_acct_req *req)
+{
+	struct wpabuf *buf;
+	struct radius_client *client = NULL;
+	struct radius_msg *msg;
+	int len;
+
+	buf = wpabuf_alloc(RADIUS_MAX_MSG_LEN);
+	if (buf == NULL)
+		return -1;
+
+	req->fromlen = sizeof(req->from);
+	len = recvfrom(sock, wpabuf_mhead(buf), RADIUS_MAX_MSG_LEN, flags,
+		       (struct sockaddr *) &req->from.ss, &req->fromlen);
 	if (len < 0) {
-		wpa_printf(MSG_INFO, "recvfrom[radius_server]: %s",
-			   strerror(errno));
-		goto fail;
+		if (!(flags & MSG_DONTWAIT) ||
+		    (errno != EAGAIN && errno != EWOULDBLOCK))
+			wpa_printf(MSG_INFO, "recvfrom[radius_server]: %s",
+				   strerror(errno));
+		wpabuf_free(buf);
+		return -1;
 	}
 
 #ifdef CONFIG_IPV6
 	if (data->ipv6) {
-		if (inet_ntop(AF_INET6, &from.sin6.sin6_addr, abuf,
-			      sizeof(abuf)) == NULL)
-			abuf[0] = '\0';
-		from_port = ntohs(from.sin6.sin6_port);
+		if (inet_ntop(AF_INET6, &req->from.sin6.sin6_addr, req->abuf,
+			      sizeof(req->abuf)) == NULL)
+			req->abuf[0] = '\0';
+		req->from_port = ntohs(req->from.sin6.sin6_port);
 		RADIUS_DEBUG("Received %d bytes from %s:%d",
-			     len, abuf, from_port);
+			     len, req->abuf, req->from_port);
 
 		client = radius_server_get_client(data,
 						  (struct in_addr *)
-						  &from.sin6.sin6_addr, 1);
+						  &req->from.sin6.sin6_addr, 1);
 	}
 #endif /* CONFIG_IPV6 */
 
 	if (!data->ipv6) {
-		os_strlcpy(abuf, inet_ntoa(from.sin.sin_addr), sizeof(abuf));
-		from_port = ntohs(from.sin.sin_port);
+		os_strlcpy(req->abuf, inet_ntoa(req->from.sin.sin_addr),
+			   sizeof(req->abuf));
+		req->from_port = ntohs(req->from.sin.sin_port);
 		RADIUS_DEBUG("Received %d bytes from %s:%d",
-			     len, abuf, from_port);
+			     len, req->abuf, req->from_port);
 
-		client = radius_server_get_client(data, &from.sin.sin_addr, 0);
+		client = radius_server_get_client(data,
+						  &req->from.sin.sin_addr, 0);
 	}
 
-	RADIUS_DUMP("Received data", buf, len);
+	wpabuf_put(buf, len);
+	RADIUS_DUMP("Received data", wpabuf_head(buf), len);
 
 	if (client == NULL) {
-		RADIUS_DEBUG("Unknown client %s - packet ignored", abuf);
+		RADIUS_DEBUG("Unknown client %s - packet ignored", req->abuf);
 		data->counters.invalid_acct_requests++;
-		goto fail;
+		wpabuf_free(buf);
+		return 0;
 	}
 
-	msg = radius_msg_parse(buf, len);
+	/* Parse the message in place; msg takes over the receive buffer */
+	msg = radius_msg_parse_buf(buf);
 	if (msg == NULL) {
 		RADIUS_DEBUG("Parsing incoming RADIUS frame failed");
 		data->counters.malformed_acct_requests++;
 		client->counters.malformed_acct_requests++;
-		goto fail;
+		return 0;
 	}
 
-	os_free(buf);
-	buf = NULL;
-
 	if (wpa_debug_level <= MSG_MSGDUMP) {
 		radius_msg_dump(msg);
 	}
@@ -1867,50 +1932,112 @@ static void radius_server_receive_acct(int sock, void *eloop_ctx,
 			     radius_msg_get_hdr(msg)->code);
 		data->counters.unknown_acct_types++;
 		client->counters.unknown_acct_types++;
-		goto fail;
+		radius_msg_free(msg);
+		return 0;
 	}
 
 	data->counters.acct_requests++;
 	client->counters.acct_requests++;
 
-	if (radius_msg_verify_acct_req(msg, (u8 *) client->shared_secret,
-				       client->shared_secret_len)) {
-		RADIUS_DEBUG("Invalid Authenticator from %s", abuf);
-		data->counters.acct_bad_authenticators++;
-		client->counters.acct_bad_authenticators++;
-		goto fail;
-	}
+	req->msg = msg;
+	req->client = client;
+	return 1;
+}
 
-	/* TODO: Write accounting information to a file or database */
 
-	hdr = radius_msg_get_hdr(msg);
+static void radius_server_receive_acct(int sock, void *eloop_ctx,
+				       void *sock_ctx)
+{
+	struct radius_server_data *data = eloop_ctx;
+	struct radius_server_acct_req req[RADIUS_SERVER_ACCT_BATCH];
+	struct radius_msg *msgs[RADIUS_SERVER_ACCT_BATCH];
+	struct radius_msg *resp[RADIUS_SERVER_ACCT_BATCH];
+	const u8 *secret[RADIUS_SERVER_ACCT_BATCH];
+	size_t secret_len[RADIUS_SERVER_ACCT_BATCH];
+	const u8 *req_auth[RADIUS_SERVER_ACCT_BATCH];
+	int bad[RADIUS_SERVER_ACCT_BATCH];
+	size_t i, num = 0, num_resp = 0;
+	struct wpabuf *rbuf;
+	int res;
+
+	/* Drain up to a batch of pending requests; only the first receive is
+	 * expected to find data since the socket was reported readable. */
+	for (i = 0; i < RADIUS_SERVER_ACCT_BATCH; i++) {
+		res = radius_server_recv_acct_req(data, sock,
+						  i ? MSG_DONTWAIT : 0,
+						  &req[num]);
+		if (res < 0)
+			break;
+		if (res == 0)
+			continue;
+		msgs[num] = req[num].msg;
+		secret[num] = (const u8 *) req[num].client->shared_secret;
+		secret_len[num] = req[num].client->shared_secret_len;
+		num++;
+	}
 
-	resp = radius_msg_new(RADIUS_CODE_ACCOUNTING_RESPONSE, hdr->identifier);
-	if (resp == NULL)
+	if (num == 0)
+		return;
+
+	if (radius_msg_verify_acct_req_batch(msgs, secret, secret_len, num,
+					     bad) < 0)
 		goto fail;
 
-	radius_msg_finish_acct_resp(resp, (u8 *) client->shared_secret,
-				    client->shared_secret_len,
-				    hdr->authenticator);
+	for (i = 0; i < num; i++) {
+		struct radius_client *client = req[i].client;
+		struct radius_hdr *hdr;
 
-	RADIUS_DEBUG("Reply to %s:%d", abuf, from_port);
-	if (wpa_debug_level <= MSG_MSGDUMP) {
-		radius_msg_dump(resp);
-	}
-	rbuf = radius_msg_get_buf(resp);
-	data->counters.acct_responses++;
-	client->counters.acct_responses++;
-	res = sendto(data->acct_sock, wpabuf_head(rbuf), wpabuf_len(rbuf), 0,
-		     (struct sockaddr *) &from.ss, fromlen);
-	if (res < 0) {
-		wpa_printf(MSG_INFO, "sendto[RADIUS SRV]: %s",
-			   strerror(errno));
+		if (bad[i]) {
+			RADIUS_DEBUG("Invalid Authenticator from %s",
+				     req[i].abuf);
+			data->counters.acct_bad_authenticators++;
+			client->counters.acct_bad_authenticators++;
+			continue;
+		}
+
+		/* TODO: Write accounting information to a file or database */
+
+		hdr = radius_msg_get_hdr(msgs[i]);
+		resp[num_resp] = radius_msg_new(RADIUS_CODE_ACCOUNTING_RESPONSE,
+						hdr->identifier);
+		if (resp[num_resp] == NULL)
+			continue;
+		req[num_resp] = req[i];
+		secret[num_resp] = secret[i];
+		secret_len[num_resp] = secret_len[i];
+		req_auth[num_resp] = hdr->authenticator;
+		num_resp++;
+	}
+
+	if (num_resp &&
+	    radius_msg_finish_acct_resp_batch(resp, secret, secret_len,
+					      req_auth, num_resp) < 0)
+		goto fail_resp;
+
+	for (i = 0; i < num_resp; i++) {
+		RADIUS_DEBUG("Reply to %s:%d", req[i].abuf, req[i].from_port);
+		if (wpa_debug_level <= MSG_MSGDUMP) {
+			radius_msg_dump(resp[i]);
+		}
+		rbuf = radius_msg_get_buf(resp[i]);
+		data->counters.acct_responses++;
+		req[i].client->counters.acct_responses++;
+		res = sendto(data->acct_sock, wpabuf_head(rbuf),
+			     wpabuf_len(rbuf), 0,
+			     (struct sockaddr *) &req[i].from.ss,
+			     req[i].fromlen);
+		if (res < 0) {
+			wpa_printf(MSG_INFO, "sendto[RADIUS SRV]: %s",
+				   strerror(errno));
+		}
 	}
 
+fail_resp:
+	for (i = 0; i < num_resp; i++)
+		radius_msg_free(resp[i]);
 fail:
-	radius_msg_free(resp);
-	radius_msg_free(msg);
-	os_free(buf);
+	for (i = 0; i < num; i++)
+		radius_msg_free(msgs[i]);
 }
 
 
@@ -2374,6 +2501,8 @@ int radius_server_get_mib(struct radius_server_data *data, char *buf,
 	char *end, *pos;
 	struct os_reltime now;
 	struct radius_client *cli;
+	struct tls_session_stats tls_stats;
+	struct tls_cert_cache_stats cert_stats;
 
 	/* RFC 2619 - RADIUS Authentication Server MIB */
 
@@ -2438,6 +2567,63 @@ int radius_server_get_mib(struct radius_server_data *data, char *buf,
 	}
 	pos += ret;
 
+	/* TLS session resumption for the EAP server (not in RFC 2619) */
+	if (data->eap_cfg->ssl_ctx &&
+	    tls_get_session_stats(data->eap_cfg->ssl_ctx, &tls_stats) == 0) {
+		ret = os_snprintf(pos, end - pos,
+				  "radiusAuthServTlsSessionResumptions=%u\n"
+				  "radiusAuthServTlsSessionMisses=%u\n"
+				  "radiusAuthServTlsSessionTimeouts=%u\n"
+				  "radiusAuthServTlsSharedCacheHits=%u\n"
+				  "radiusAuthServTlsSharedCacheMisses=%u\n"
+				  "radiusAuthServTlsSharedCacheStores=%u\n"
+				  "radiusAuthServTlsTicketHits=%u\n"
+				  "radiusAuthServTlsTicketMisses=%u\n",
+				  tls_stats.resumed,
+				  tls_stats.misses,
+				  tls_stats.timeouts,
+				  tls_stats.shared_hits,
+				  tls_stats.shared_misses,
+				  tls_stats.shared_stores,
+				  tls_stats.ticket_hits,
+				  tls_stats.ticket_misses);
+		if (os_snprintf_error(end - pos, ret)) {
+			*pos = '\0';
+			return pos - buf;
+		}
+		pos += ret;
+	}
+
+	/* TLS credential and certificate verification caches */
+	if (data->eap_cfg->ssl_ctx &&
+	    tls_get_cert_cache_stats(data->eap_cfg->ssl_ctx,
+				     &cert_stats) == 0) {
+		ret = os_snprintf(pos, end - pos,
+				  "radiusAuthServTlsCredHits=%u\n"
+				  "radiusAuthServTlsCredMisses=%u\n"
+				  "radiusAuthServTlsCredReloads=%u\n"
+				  "radiusAuthServTlsCredEntries=%u\n"
+				  "radiusAuthServTlsVerifyHits=%u\n"
+				  "radiusAuthServTlsVerifyMisses=%u\n"
+				  "radiusAuthServTlsVerifyStores=%u\n"
+				  "radiusAuthServTlsVerifyExpired=%u\n"
+				  "radiusAuthServTlsVerifyEntries=%u\n",
+				  cert_stats.cred_hits,
+				  cert_stats.cred_misses,
+				  cert_stats.cred_reloads,
+				  cert_stats.cred_entries,
+				  cert_stats.verify_hits,
+				  cert_stats.verify_misses,
+				  cert_stats.verify_stores,
+				  cert_stats.verify_expired,
+				  cert_stats.verify_entries);
+		if (os_snprintf_error(end - pos, ret)) {
+			*pos = '\0';
+			return pos - buf;
+		}
+		pos += ret;
+	}
+
 	for (cli = data->clients, idx = 0; cli; cli = cli->next, idx++) {
 		char abuf[50], mbuf[50];
 #ifdef CONFIG_IPV6
@@ -2623,16 +2809,16 @@ void radius_server_eap_pending_cb(struct radius_server_data *data, void *ctx)
 		return;
 	}
 
-	msg = sess->last_msg;
+	msg = radius_msg_parse_buf(sess->last_msg);
 	sess->last_msg = NULL;
+	if (!msg) {
+		RADIUS_DEBUG("Could not parse the pending message");
+		return;
+	}
 	eap_sm_pending_cb(sess->eap);
-	if (radius_server_request(data, msg,
-				  (struct sockaddr *) &sess->last_from,
-				  sess->last_fromlen, cli,
-				  sess->last_from_addr,
-				  sess->last_from_port, sess) == -2)
-		return; /* msg was stored with the session */
-
+	radius_server_request(data, msg, (struct sockaddr *) &sess->last_from,
+			      sess->last_fromlen, cli, sess->last_from_addr,
+			      sess->last_from_port, sess);
 	radius_msg_free(msg);
 }
 
@@ -222,3 +222,17 @@ int bignum_exptmod(const struct bignum *a, const struct bignum *b,
 	}
 	return 0;
 }
+
+
+/**
+ * bignum_global_deinit - Free global bignum data
+ *
+ * This frees the tables that LibTomMath keeps for exponentiation with the most
+ * recently used DH generators. They are built again on the next use.
+ */
+void bignum_global_deinit(void)
+{
+#if defined(CONFIG_INTERNAL_LIBTOMMATH) && defined(BN_MP_EXPTMOD_FIXED_BASE_C)
+	mp_fb_cache_clear();
+#endif /* CONFIG_INTERNAL_LIBTOMMATH && BN_MP_EXPTMOD_FIXED_BASE_C */
+}
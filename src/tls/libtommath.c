@@ -45,6 +45,11 @@
 /* About 0.25 kB of code, but ~1.7kB of stack space! */
 #define BN_FAST_S_MP_MUL_DIGS_C
 
+/* Faster exponentiation with small bases (DH generators) at the cost of about
+ * 1.5 kB in code and a precomputed table of 32 values per cached (base,
+ * modulus) pair (e.g., about 13 kB for a 2048-bit modulus) */
+#define BN_MP_EXPTMOD_FIXED_BASE_C
+
 #else /* LTM_FAST */
 
 #define BN_MP_DIV_SMALL
@@ -69,7 +74,8 @@
 
 #define  OPT_CAST(x)
 
-#ifdef __x86_64__
+#if defined(__x86_64__) || (defined(__SIZEOF_INT128__) && defined(__LP64__))
+/* 64-bit digits on 64-bit targets where the compiler has a 128-bit type */
 typedef unsigned long mp_digit;
 typedef unsigned long mp_word __attribute__((mode(TI)));
 
@@ -186,6 +192,10 @@ static int mp_init_size(mp_int * a, int size);
 #ifdef BN_MP_EXPTMOD_FAST_C
 static int mp_exptmod_fast (mp_int * G, mp_int * X, mp_int * P, mp_int * Y, int redmode);
 #endif /* BN_MP_EXPTMOD_FAST_C */
+#ifdef BN_MP_EXPTMOD_FIXED_BASE_C
+static int mp_exptmod_fixed_base (mp_int * G, mp_int * X, mp_int * P, mp_int * Y);
+static void mp_fb_cache_clear (void);
+#endif /* BN_MP_EXPTMOD_FIXED_BASE_C */
 #ifdef BN_FAST_S_MP_SQR_C
 static int fast_s_mp_sqr (mp_int * a, mp_int * b);
 #endif /* BN_FAST_S_MP_SQR_C */
@@ -659,6 +669,16 @@ static int mp_exptmod (mp_int * G, mp_int * X, mp_int * P, mp_int * Y)
   }
 #endif
 
+#ifdef BN_MP_EXPTMOD_FIXED_BASE_C
+  /* use the precomputed table for small bases if possible */
+  if (dr == 0) {
+    int err = mp_exptmod_fixed_base (G, X, P, Y);
+    if (err != MP_VAL) {
+      return err;
+    }
+  }
+#endif
+
   /* if the modulus is odd or dr != 0 use the montgomery method */
 #ifdef BN_MP_EXPTMOD_FAST_C
   if (mp_isodd (P) == 1 || dr !=  0) {
@@ -3244,6 +3264,232 @@ LBL_M:
 #endif
 
 
+#ifdef BN_MP_EXPTMOD_FIXED_BASE_C
+/* Fixed-base exponentiation for small bases like the generators of the
+ * DH groups (Lim-Lee comb with a single table, HAC pp.625, Algorithm 14.117).
+ *
+ * The exponent is split into LTM_FB_TEETH blocks of "spacing" bits and the
+ * table has the products of g**(2**(i*spacing)) for all subsets of the
+ * blocks, so each step takes one squaring and at most one multiplication.
+ * That is about 1/LTM_FB_TEETH of the squarings of mp_exptmod_fast(). The
+ * tables are built on the first use and kept for the most recently used
+ * (base, modulus) pairs, so other bases use the sliding window method.
+ */
+
+#define LTM_FB_TEETH 5
+#define LTM_FB_CACHE 2
+
+struct mp_fb_table {
+  mp_int G, P;
+  mp_digit rho;
+  int spacing;
+  unsigned int last_used;
+  mp_int T[1 << LTM_FB_TEETH]; /* T[0] is unused */
+};
+
+static struct mp_fb_table *mp_fb_cache[LTM_FB_CACHE];
+static unsigned int mp_fb_counter;
+
+
+static void mp_fb_free (struct mp_fb_table *t)
+{
+  int x;
+
+  if (t == NULL) {
+    return;
+  }
+  mp_clear (&t->G);
+  mp_clear (&t->P);
+  for (x = 1; x < (1 << LTM_FB_TEETH); x++) {
+    mp_clear (&t->T[x]);
+  }
+  XFREE (t);
+}
+
+
+/* frees all cached tables */
+static void mp_fb_cache_clear (void)
+{
+  int x;
+
+  for (x = 0; x < LTM_FB_CACHE; x++) {
+    mp_fb_free (mp_fb_cache[x]);
+    mp_fb_cache[x] = NULL;
+  }
+  mp_fb_counter = 0;
+}
+
+
+static struct mp_fb_table * mp_fb_build (mp_int * G, mp_int * P)
+{
+  struct mp_fb_table *t;
+  mp_int  tmp;
+  int     err, x, y;
+
+  t = XMALLOC (sizeof (*t));
+  if (t == NULL) {
+    return NULL;
+  }
+  os_memset (t, 0, sizeof (*t));
+  t->spacing = (mp_count_bits (P) + LTM_FB_TEETH - 1) / LTM_FB_TEETH;
+
+  if (mp_init (&tmp) != MP_OKAY) {
+    XFREE (t);
+    return NULL;
+  }
+  if ((err = mp_init_copy (&t->G, G)) != MP_OKAY ||
+      (err = mp_init_copy (&t->P, P)) != MP_OKAY ||
+      (err = mp_montgomery_setup (P, &t->rho)) != MP_OKAY ||
+      (err = mp_montgomery_calc_normalization (&tmp, P)) != MP_OKAY ||
+      (err = mp_mulmod (G, &tmp, P, &tmp)) != MP_OKAY ||
+      (err = mp_init_copy (&t->T[1], &tmp)) != MP_OKAY) {
+    goto LBL_ERR;
+  }
+
+  /* T[2**i] = g**(2**(i*spacing)) in Montgomery form */
+  for (x = 1; x < LTM_FB_TEETH; x++) {
+    for (y = 0; y < t->spacing; y++) {
+      if ((err = mp_sqr (&tmp, &tmp)) != MP_OKAY ||
+          (err = fast_mp_montgomery_reduce (&tmp, P, t->rho)) != MP_OKAY) {
+        goto LBL_ERR;
+      }
+    }
+    if ((err = mp_init_copy (&t->T[1 << x], &tmp)) != MP_OKAY) {
+      goto LBL_ERR;
+    }
+  }
+
+  /* the other entries are products of these */
+  for (x = 3; x < (1 << LTM_FB_TEETH); x++) {
+    if ((x & (x - 1)) == 0) {
+      continue;
+    }
+    if ((err = mp_mul (&t->T[x & (x - 1)], &t->T[x & -x], &tmp)) != MP_OKAY ||
+        (err = fast_mp_montgomery_reduce (&tmp, P, t->rho)) != MP_OKAY ||
+        (err = mp_init_copy (&t->T[x], &tmp)) != MP_OKAY) {
+      goto LBL_ERR;
+    }
+  }
+
+  mp_clear (&tmp);
+  return t;
+
+LBL_ERR:
+  mp_clear (&tmp);
+  mp_fb_free (t);
+  return NULL;
+}
+
+
+/* get the table for G and P, building it if needed */
+static struct mp_fb_table * mp_fb_get (mp_int * G, mp_int * P)
+{
+  struct mp_fb_table *t;
+  int     x, lru = 0;
+
+  for (x = 0; x < LTM_FB_CACHE; x++) {
+    t = mp_fb_cache[x];
+    if (t == NULL) {
+      lru = x;
+      break;
+    }
+    if (mp_cmp (&t->P, P) == MP_EQ && mp_cmp (&t->G, G) == MP_EQ) {
+      t->last_used = ++mp_fb_counter;
+      return t;
+    }
+    if (t->last_used < mp_fb_cache[lru]->last_used) {
+      lru = x;
+    }
+  }
+
+  t = mp_fb_build (G, P);
+  if (t == NULL) {
+    return NULL;
+  }
+  mp_fb_free (mp_fb_cache[lru]);
+  mp_fb_cache[lru] = t;
+  t->last_used = ++mp_fb_counter;
+  return t;
+}
+
+
+/* returns MP_VAL if the fixed-base method cannot be used for these values */
+static int mp_exptmod_fixed_base (mp_int * G, mp_int * X, mp_int * P, mp_int * Y)
+{
+  struct mp_fb_table *t;
+  mp_int  res;
+  int     err, i, k, n, idx, started = 0;
+
+  /* only for small bases with an odd modulus that is small enough for the
+   * comba Montgomery reduction; the exponent must fit in the table */
+  if (G->used != 1 || G->sign == MP_NEG || X->sign == MP_NEG ||
+      mp_iseven (P) == MP_YES || mp_cmp_mag (G, P) != MP_LT ||
+      (P->used * 2 + 1) >= MP_WARRAY ||
+      P->used >= (1 << ((CHAR_BIT * sizeof (mp_word)) - (2 * DIGIT_BIT))) ||
+      mp_count_bits (X) > mp_count_bits (P)) {
+    return MP_VAL;
+  }
+
+  t = mp_fb_get (G, P);
+  if (t == NULL) {
+    return MP_VAL;
+  }
+
+  if ((err = mp_init (&res)) != MP_OKAY) {
+    return err;
+  }
+  if ((err = mp_montgomery_calc_normalization (&res, P)) != MP_OKAY) {
+    goto LBL_RES;
+  }
+
+  for (k = t->spacing - 1; k >= 0; k--) {
+    if (started) {
+      if ((err = mp_sqr (&res, &res)) != MP_OKAY ||
+          (err = fast_mp_montgomery_reduce (&res, P, t->rho)) != MP_OKAY) {
+        goto LBL_RES;
+      }
+    }
+
+    /* bit k of each block of the exponent */
+    idx = 0;
+    for (i = 0; i < LTM_FB_TEETH; i++) {
+      n = i * t->spacing + k;
+      if (n / DIGIT_BIT < X->used &&
+          ((X->dp[n / DIGIT_BIT] >> (n % DIGIT_BIT)) & 1)) {
+        idx |= 1 << i;
+      }
+    }
+    if (idx == 0) {
+      continue;
+    }
+
+    if (!started) {
+      if ((err = mp_copy (&t->T[idx], &res)) != MP_OKAY) {
+        goto LBL_RES;
+      }
+      started = 1;
+      continue;
+    }
+    if ((err = mp_mul (&res, &t->T[idx], &res)) != MP_OKAY ||
+        (err = fast_mp_montgomery_reduce (&res, P, t->rho)) != MP_OKAY) {
+      goto LBL_RES;
+    }
+  }
+
+  /* leave the Montgomery form */
+  if ((err = fast_mp_montgomery_reduce (&res, P, t->rho)) != MP_OKAY) {
+    goto LBL_RES;
+  }
+
+  mp_exch (&res, Y);
+  err = MP_OKAY;
+LBL_RES:
+  mp_clear (&res);
+  return err;
+}
+#endif /* BN_MP_EXPTMOD_FIXED_BASE_C */
+
+
 #ifdef BN_FAST_S_MP_SQR_C
 /* the jist of squaring...
  * you do like mult except the offset of the tmpx [one that
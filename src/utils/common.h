@@ -571,6 +571,22 @@ int is_ctrl_char(char c);
 
 int str_starts(const char *str, const char *start);
 
+/*
+ * Keyword matching for long if-else chains of string comparisons.
+ * STR_HASH_KEY() reduces a string of known length to a 32-bit value (the
+ * length and three of the characters). For string literals, the compiler
+ * computes the value at build time, so STR_HASH_MATCH() does an integer
+ * comparison and calls os_strcmp() only for keywords that have the same key as
+ * the string.
+ */
+#define STR_HASH_KEY(s, len) \
+	((u32) (len) ^ ((u32) (u8) (s)[0] << 8) ^ \
+	 ((u32) (u8) (s)[(len) / 2] << 16) ^ \
+	 ((u32) (u8) (s)[(len) > 0 ? (len) - 1 : 0] << 24))
+#define STR_HASH_MATCH(key, str, lit) \
+	((key) == STR_HASH_KEY(lit, sizeof(lit) - 1) && \
+	 os_strcmp((str), (lit)) == 0)
+
 u8 rssi_to_rcpi(int rssi);
 char * get_param(const char *cmd, const char *param);
 
@@ -0,0 +1,262 @@
+/*
+ * Fixed-size object pool
+ * Copyright (c) 2026, Infineon Technologies AG
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ *
+ * The pool preallocates a single contiguous slab of objects so that the
+ * steady-state number of per-station objects does not need to go through the
+ * heap allocator at all. Objects beyond the preallocated count are allocated
+ * from the heap (up to the optional maximum) and returned there when freed.
+ * All objects are zeroed when handed out and cleared when released since the
+ * users of this store key material in them.
+ */
+
+#include "includes.h"
+
+#include "common.h"
+#include "objpool.h"
+
+
+struct objpool_entry {
+	struct objpool_entry *next;
+};
+
+struct objpool {
+	char name[32];
+	size_t obj_size;
+	unsigned int prealloc; /* number of objects in the slab */
+	unsigned int max; /* maximum number of objects in use; 0 = no limit */
+
+	u8 *slab;
+	struct objpool_entry *free_list;
+	unsigned int num_free;
+
+	unsigned int in_use;
+	unsigned int peak;
+	unsigned int heap_in_use;
+	unsigned int alloc_count;
+	unsigned int alloc_fail;
+};
+
+
+/**
+ * objpool_init - Allocate a fixed-size object pool
+ * @name: Name of the pool (used in debug and MIB output)
+ * @obj_size: Size of each object in octets
+ * @prealloc: Number of objects to preallocate into the slab
+ * @max: Maximum number of objects in use at a time or 0 for no limit
+ * Returns: Pointer to the pool or %NULL on failure
+ */
+struct objpool * objpool_init(const char *name, size_t obj_size,
+			      unsigned int prealloc, unsigned int max)
+{
+	struct objpool *pool;
+	unsigned int i;
+
+	if (obj_size < sizeof(struct objpool_entry))
+		obj_size = sizeof(struct objpool_entry);
+	/* Keep slab entries aligned for any of the pooled structures */
+	obj_size = (obj_size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+
+	if (max && prealloc > max)
+		prealloc = max;
+
+	pool = os_zalloc(sizeof(*pool));
+	if (!pool)
+		return NULL;
+	os_strlcpy(pool->name, name, sizeof(pool->name));
+	pool->obj_size = obj_size;
+	pool->max = max;
+
+	if (prealloc) {
+		pool->slab = os_calloc(prealloc, obj_size);
+		if (!pool->slab) {
+			wpa_printf(MSG_ERROR,
+				   "objpool: Failed to preallocate %u objects for %s",
+				   prealloc, name);
+			os_free(pool);
+			return NULL;
+		}
+		pool->prealloc = prealloc;
+		for (i = prealloc; i > 0; i--) {
+			struct objpool_entry *e;
+
+			e = (struct objpool_entry *)
+				(pool->slab + (i - 1) * obj_size);
+			e->next = pool->free_list;
+			pool->free_list = e;
+		}
+		pool->num_free = prealloc;
+	}
+
+	wpa_printf(MSG_DEBUG,
+		   "objpool: Initialized %s (obj_size=%u prealloc=%u max=%u)",
+		   pool->name, (unsigned int) obj_size, prealloc, max);
+
+	return pool;
+}
+
+
+/**
+ * objpool_deinit - Free an object pool
+ * @pool: Pool from objpool_init()
+ *
+ * All objects must have been returned to the pool with objpool_free() before
+ * calling this function.
+ */
+void objpool_deinit(struct objpool *pool)
+{
+	if (!pool)
+		return;
+
+	if (pool->in_use) {
+		/* Freeing the slab would leave dangling pointers in the users
+		 * of the objects, so leak the pool instead. */
+		wpa_printf(MSG_ERROR,
+			   "objpool: %s deinit with %u object(s) still in use",
+			   pool->name, pool->in_use);
+		return;
+	}
+
+	bin_clear_free(pool->slab, pool->prealloc * pool->obj_size);
+	os_free(pool);
+}
+
+
+static int objpool_in_slab(const struct objpool *pool, const void *obj)
+{
+	const u8 *pos = obj;
+
+	return pool->slab && pos >= pool->slab &&
+		pos < pool->slab + pool->prealloc * pool->obj_size;
+}
+
+
+/**
+ * objpool_alloc - Allocate a zeroed object from the pool
+ * @pool: Pool from objpool_init()
+ * Returns: Pointer to the object or %NULL if the pool is exhausted or memory
+ * allocation failed
+ */
+void * objpool_alloc(struct objpool *pool)
+{
+	void *obj;
+
+	if (pool->max && pool->in_use >= pool->max) {
+		pool->alloc_fail++;
+		wpa_printf(MSG_DEBUG, "objpool: %s exhausted (%u/%u in use)",
+			   pool->name, pool->in_use, pool->max);
+		return NULL;
+	}
+
+	if (pool->free_list) {
+		struct objpool_entry *e = pool->free_list;
+
+		pool->free_list = e->next;
+		pool->num_free--;
+		e->next = NULL;
+		obj = e;
+	} else {
+		obj = os_zalloc(pool->obj_size);
+		if (!obj) {
+			pool->alloc_fail++;
+			return NULL;
+		}
+		pool->heap_in_use++;
+	}
+
+	pool->in_use++;
+	if (pool->in_use > pool->peak)
+		pool->peak = pool->in_use;
+	pool->alloc_count++;
+
+	return obj;
+}
+
+
+/**
+ * objpool_free - Return an object to the pool
+ * @pool: Pool from objpool_init()
+ * @obj: Object from objpool_alloc() or %NULL
+ */
+void objpool_free(struct objpool *pool, void *obj)
+{
+	struct objpool_entry *e;
+
+	if (!obj)
+		return;
+
+	pool->in_use--;
+	if (!objpool_in_slab(pool, obj)) {
+		pool->heap_in_use--;
+		bin_clear_free(obj, pool->obj_size);
+		return;
+	}
+
+	forced_memzero(obj, pool->obj_size);
+	e = obj;
+	e->next = pool->free_list;
+	pool->free_list = e;
+	pool->num_free++;
+}
+
+
+/**
+ * objpool_in_use - Get the number of objects currently allocated
+ * @pool: Pool from objpool_init()
+ * Returns: Number of objects in use
+ */
+unsigned int objpool_in_use(const struct objpool *pool)
+{
+	return pool->in_use;
+}
+
+
+/**
+ * objpool_available - Check whether the pool can provide another object
+ * @pool: Pool from objpool_init()
+ * Returns: 1 if objpool_alloc() is expected to succeed, 0 if not
+ */
+int objpool_available(const struct objpool *pool)
+{
+	return !pool->max || pool->in_use < pool->max;
+}
+
+
+/**
+ * objpool_get_mib - Get pool occupancy in text format
+ * @pool: Pool from objpool_init()
+ * @buf: Buffer for the text
+ * @buflen: Length of the buffer
+ * Returns: Number of octets written to buf
+ */
+int objpool_get_mib(const struct objpool *pool, char *buf, size_t buflen)
+{
+	int ret;
+
+	if (!pool)
+		return 0;
+
+	ret = os_snprintf(buf, buflen,
+			  "%s_in_use=%u\n"
+			  "%s_free=%u\n"
+			  "%s_prealloc=%u\n"
+			  "%s_max=%u\n"
+			  "%s_peak=%u\n"
+			  "%s_heap_in_use=%u\n"
+			  "%s_alloc=%u\n"
+			  "%s_alloc_fail=%u\n",
+			  pool->name, pool->in_use,
+			  pool->name, pool->num_free,
+			  pool->name, pool->prealloc,
+			  pool->name, pool->max,
+			  pool->name, pool->peak,
+			  pool->name, pool->heap_in_use,
+			  pool->name, pool->alloc_count,
+			  pool->name, pool->alloc_fail);
+	if (os_snprintf_error(buflen, ret))
+		return 0;
+	return ret;
+}
@@ -0,0 +1,23 @@
+/*
+ * Fixed-size object pool
+ * Copyright (c) 2026, Infineon Technologies AG
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#ifndef OBJPOOL_H
+#define OBJPOOL_H
+
+struct objpool;
+
+struct objpool * objpool_init(const char *name, size_t obj_size,
+			      unsigned int prealloc, unsigned int max);
+void objpool_deinit(struct objpool *pool);
+void * objpool_alloc(struct objpool *pool);
+void objpool_free(struct objpool *pool, void *obj);
+unsigned int objpool_in_use(const struct objpool *pool);
+int objpool_available(const struct objpool *pool);
+int objpool_get_mib(const struct objpool *pool, char *buf, size_t buflen);
+
+#endif /* OBJPOOL_H */
@@ -18,6 +18,7 @@
 #include "utils/ip_addr.h"
 #include "utils/eloop.h"
 #include "utils/json.h"
+#include "utils/objpool.h"
 #include "utils/module_tests.h"
 
 
@@ -219,6 +220,82 @@ static int bitfield_tests(void)
 }
 
 
+static int objpool_tests(void)
+{
+	struct objpool *pool;
+	u8 *obj[5];
+	char buf[500];
+	int errors = 0;
+	unsigned int i;
+
+	wpa_printf(MSG_INFO, "objpool tests");
+
+	pool = objpool_init("test", 40, 2, 4);
+	if (!pool)
+		return -1;
+
+	for (i = 0; i < 4; i++) {
+		obj[i] = objpool_alloc(pool);
+		if (!obj[i]) {
+			errors++;
+			continue;
+		}
+		if (obj[i][0] || obj[i][39])
+			errors++;
+		os_memset(obj[i], 0xaa, 40);
+	}
+	if (objpool_in_use(pool) != 4 || objpool_available(pool))
+		errors++;
+
+	/* The pool is limited to four objects */
+	obj[4] = objpool_alloc(pool);
+	if (obj[4])
+		errors++;
+
+	/* Objects returned to the slab must be handed out cleared */
+	objpool_free(pool, obj[0]);
+	objpool_free(pool, obj[3]);
+	if (objpool_in_use(pool) != 2 || !objpool_available(pool))
+		errors++;
+	obj[0] = objpool_alloc(pool);
+	if (!obj[0] || obj[0][0] || obj[0][sizeof(void *)] || obj[0][39])
+		errors++;
+
+	if (objpool_get_mib(pool, buf, sizeof(buf)) <= 0 ||
+	    !os_strstr(buf, "test_in_use=3\n") ||
+	    !os_strstr(buf, "test_alloc_fail=1\n") ||
+	    !os_strstr(buf, "test_peak=4\n"))
+		errors++;
+
+	objpool_free(pool, obj[0]);
+	objpool_free(pool, obj[1]);
+	objpool_free(pool, obj[2]);
+	if (objpool_in_use(pool) != 0)
+		errors++;
+	objpool_deinit(pool);
+
+	/* Pool without preallocation or limit uses the heap only */
+	pool = objpool_init("heap", 1, 0, 0);
+	if (!pool)
+		return -1;
+	obj[0] = objpool_alloc(pool);
+	obj[1] = objpool_alloc(pool);
+	if (!obj[0] || !obj[1] || objpool_in_use(pool) != 2)
+		errors++;
+	objpool_free(pool, obj[0]);
+	objpool_free(pool, obj[1]);
+	objpool_free(pool, NULL);
+	objpool_deinit(pool);
+
+	if (errors) {
+		wpa_printf(MSG_ERROR, "%d objpool test(s) failed", errors);
+		return -1;
+	}
+
+	return 0;
+}
+
+
 static int int_array_tests(void)
 {
 	int test1[] = { 1, 2, 3, 4, 5, 6, 0 };
@@ -1219,6 +1296,7 @@ int utils_module_tests(void)
 	    ext_password_tests() < 0 ||
 	    trace_tests() < 0 ||
 	    bitfield_tests() < 0 ||
+	    objpool_tests() < 0 ||
 	    base64_tests() < 0 ||
 	    common_tests() < 0 ||
 	    os_tests() < 0 ||
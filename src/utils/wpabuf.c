@@ -27,6 +27,208 @@ static struct wpabuf_trace * wpabuf_get_trace(const struct wpabuf *buf)
 #endif /* WPA_TRACE */
 
 
+#if defined(CONFIG_WPABUF_POOL) && !defined(WPA_TRACE)
+/*
+ * Recycling of wpabuf allocations
+ *
+ * Buffers with a requested length that fits in one of the size classes are
+ * allocated with the full size class capacity and returned into a per-class
+ * free list when freed. This allows the frequently used EAPOL/EAP/RADIUS
+ * buffers to be reused without going through the heap allocator and allows
+ * wpabuf_resize() to grow a buffer in place within its capacity. The event
+ * loop is single threaded, so the free lists do not need locking.
+ */
+#define WPABUF_POOL
+
+#define WPABUF_POOL_DEFAULT_MAX 32
+
+static const size_t wpabuf_pool_sizes[] = {
+	64, 128, 256, 512, 1024, 2048, 4096
+};
+
+#define WPABUF_POOL_NUM_CLASSES ARRAY_SIZE(wpabuf_pool_sizes)
+
+static struct wpabuf_pool {
+	struct wpabuf *free_list[WPABUF_POOL_NUM_CLASSES];
+	unsigned int num_free[WPABUF_POOL_NUM_CLASSES];
+	unsigned int max_cached;
+
+	unsigned int alloc;
+	unsigned int hit;
+	unsigned int miss;
+	unsigned int heap;
+	unsigned int resize_in_place;
+	unsigned int resize_moved;
+} wpabuf_pool = {
+	.max_cached = WPABUF_POOL_DEFAULT_MAX,
+};
+
+
+static int wpabuf_pool_class(size_t len)
+{
+	unsigned int i;
+
+	for (i = 0; i < WPABUF_POOL_NUM_CLASSES; i++) {
+		if (len <= wpabuf_pool_sizes[i])
+			return i;
+	}
+
+	return -1;
+}
+
+
+static unsigned int wpabuf_pool_buf_class(const struct wpabuf *buf)
+{
+	return (buf->flags >> WPABUF_POOL_CLASS_SHIFT) &
+		WPABUF_POOL_CLASS_MASK;
+}
+
+
+static struct wpabuf * wpabuf_pool_get(int cls, size_t len)
+{
+	struct wpabuf *buf;
+
+	buf = wpabuf_pool.free_list[cls];
+	if (buf) {
+		/* Free list entries are linked through wpabuf::buf */
+		wpabuf_pool.free_list[cls] = (struct wpabuf *) buf->buf;
+		wpabuf_pool.num_free[cls]--;
+		wpabuf_pool.hit++;
+	} else {
+		buf = os_malloc(sizeof(struct wpabuf) + wpabuf_pool_sizes[cls]);
+		if (!buf)
+			return NULL;
+		wpabuf_pool.miss++;
+	}
+
+	buf->size = len;
+	buf->used = 0;
+	buf->buf = (u8 *) (buf + 1);
+	buf->flags = WPABUF_FLAG_POOLED | (cls << WPABUF_POOL_CLASS_SHIFT);
+	os_memset(buf->buf, 0, len);
+
+	return buf;
+}
+
+
+static void wpabuf_pool_put(struct wpabuf *buf)
+{
+	unsigned int cls = wpabuf_pool_buf_class(buf);
+
+	if (wpabuf_pool.num_free[cls] >= wpabuf_pool.max_cached) {
+		os_free(buf);
+		return;
+	}
+
+	buf->buf = (u8 *) wpabuf_pool.free_list[cls];
+	wpabuf_pool.free_list[cls] = buf;
+	wpabuf_pool.num_free[cls]++;
+}
+
+
+/* Returns 1 if the resize was completed, 0 if the buffer needs to be
+ * reallocated from the heap, or -1 on allocation failure. */
+static int wpabuf_pool_resize(struct wpabuf **_buf, size_t add_len)
+{
+	struct wpabuf *buf = *_buf, *nbuf;
+	size_t len = buf->used + add_len;
+	int cls;
+
+	if (len <= wpabuf_pool_sizes[wpabuf_pool_buf_class(buf)]) {
+		os_memset(buf->buf + buf->used, 0, add_len);
+		buf->size = len;
+		wpabuf_pool.resize_in_place++;
+		return 1;
+	}
+
+	cls = wpabuf_pool_class(len);
+	if (cls < 0) {
+		/* Too large for the pool, so continue as a heap buffer */
+		buf->flags &= ~(WPABUF_FLAG_POOLED |
+				(WPABUF_POOL_CLASS_MASK <<
+				 WPABUF_POOL_CLASS_SHIFT));
+		return 0;
+	}
+
+	nbuf = wpabuf_pool_get(cls, len);
+	if (!nbuf)
+		return -1;
+	os_memcpy(nbuf->buf, buf->buf, buf->used);
+	nbuf->used = buf->used;
+	wpabuf_pool_put(buf);
+	*_buf = nbuf;
+	wpabuf_pool.resize_moved++;
+
+	return 1;
+}
+
+
+/**
+ * wpabuf_pool_set_max - Set the maximum number of cached buffers per class
+ * @max_cached: Maximum number of free buffers to keep in each size class;
+ *	0 disables caching
+ */
+void wpabuf_pool_set_max(unsigned int max_cached)
+{
+	unsigned int i;
+
+	wpabuf_pool.max_cached = max_cached;
+	for (i = 0; i < WPABUF_POOL_NUM_CLASSES; i++) {
+		while (wpabuf_pool.num_free[i] > max_cached) {
+			struct wpabuf *buf = wpabuf_pool.free_list[i];
+
+			wpabuf_pool.free_list[i] = (struct wpabuf *) buf->buf;
+			wpabuf_pool.num_free[i]--;
+			os_free(buf);
+		}
+	}
+}
+
+
+/**
+ * wpabuf_pool_flush - Release all cached buffers back to the heap
+ */
+void wpabuf_pool_flush(void)
+{
+	unsigned int max_cached = wpabuf_pool.max_cached;
+
+	wpabuf_pool_set_max(0);
+	wpabuf_pool.max_cached = max_cached;
+}
+
+
+/**
+ * wpabuf_pool_get_stats - Get wpabuf allocation counters in text format
+ * @buf: Buffer for the text
+ * @buflen: Length of the buffer
+ * Returns: Number of octets written to buf
+ */
+int wpabuf_pool_get_stats(char *buf, size_t buflen)
+{
+	unsigned int i, cached = 0;
+	int ret;
+
+	for (i = 0; i < WPABUF_POOL_NUM_CLASSES; i++)
+		cached += wpabuf_pool.num_free[i];
+
+	ret = os_snprintf(buf, buflen,
+			  "wpabuf_alloc=%u\n"
+			  "wpabuf_pool_hit=%u\n"
+			  "wpabuf_pool_miss=%u\n"
+			  "wpabuf_heap_alloc=%u\n"
+			  "wpabuf_resize_in_place=%u\n"
+			  "wpabuf_resize_moved=%u\n"
+			  "wpabuf_pool_cached=%u\n",
+			  wpabuf_pool.alloc, wpabuf_pool.hit, wpabuf_pool.miss,
+			  wpabuf_pool.heap, wpabuf_pool.resize_in_place,
+			  wpabuf_pool.resize_moved, cached);
+	if (os_snprintf_error(buflen, ret))
+		return 0;
+	return ret;
+}
+#endif /* CONFIG_WPABUF_POOL && !WPA_TRACE */
+
+
 static void wpabuf_overflow(const struct wpabuf *buf, size_t len)
 {
 #ifdef WPA_TRACE
@@ -68,6 +270,14 @@ int wpabuf_resize(struct wpabuf **_buf, size_t add_len)
 
 	if (buf->used + add_len > buf->size) {
 		unsigned char *nbuf;
+#ifdef WPABUF_POOL
+		if (buf->flags & WPABUF_FLAG_POOLED) {
+			int res = wpabuf_pool_resize(_buf, add_len);
+
+			if (res)
+				return res < 0 ? -1 : 0;
+		}
+#endif /* WPABUF_POOL */
 		if (buf->flags & WPABUF_FLAG_EXT_DATA) {
 			nbuf = os_realloc(buf->buf, buf->used + add_len);
 			if (nbuf == NULL)
@@ -121,7 +331,17 @@ struct wpabuf * wpabuf_alloc(size_t len)
 	trace->magic = WPABUF_MAGIC;
 	buf = (struct wpabuf *) (trace + 1);
 #else /* WPA_TRACE */
-	struct wpabuf *buf = os_zalloc(sizeof(struct wpabuf) + len);
+	struct wpabuf *buf;
+#ifdef WPABUF_POOL
+	int cls = wpabuf_pool_class(len);
+
+	wpabuf_pool.alloc++;
+	if (cls >= 0)
+		return wpabuf_pool_get(cls, len);
+	wpabuf_pool.heap++;
+#endif /* WPABUF_POOL */
+
+	buf = os_zalloc(sizeof(struct wpabuf) + len);
 	if (buf == NULL)
 		return NULL;
 #endif /* WPA_TRACE */
@@ -198,6 +418,12 @@ void wpabuf_free(struct wpabuf *buf)
 #else /* WPA_TRACE */
 	if (buf == NULL)
 		return;
+#ifdef WPABUF_POOL
+	if (buf->flags & WPABUF_FLAG_POOLED) {
+		wpabuf_pool_put(buf);
+		return;
+	}
+#endif /* WPABUF_POOL */
 	if (buf->flags & WPABUF_FLAG_EXT_DATA)
 		os_free(buf->buf);
 	os_free(buf);
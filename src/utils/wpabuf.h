@@ -11,6 +11,10 @@
 
 /* wpabuf::buf is a pointer to external data */
 #define WPABUF_FLAG_EXT_DATA BIT(0)
+/* wpabuf was allocated with a size class capacity (CONFIG_WPABUF_POOL) */
+#define WPABUF_FLAG_POOLED BIT(1)
+#define WPABUF_POOL_CLASS_SHIFT 8
+#define WPABUF_POOL_CLASS_MASK 0x0f
 
 /*
  * Internal data structure for wpabuf. Please do not touch this directly from
@@ -39,6 +43,25 @@ struct wpabuf * wpabuf_zeropad(struct wpabuf *buf, size_t len);
 void wpabuf_printf(struct wpabuf *buf, char *fmt, ...) PRINTF_FORMAT(2, 3);
 struct wpabuf * wpabuf_parse_bin(const char *buf);
 
+#if defined(CONFIG_WPABUF_POOL) && !defined(WPA_TRACE)
+void wpabuf_pool_set_max(unsigned int max_cached);
+void wpabuf_pool_flush(void);
+int wpabuf_pool_get_stats(char *buf, size_t buflen);
+#else /* CONFIG_WPABUF_POOL && !WPA_TRACE */
+static inline void wpabuf_pool_set_max(unsigned int max_cached)
+{
+}
+
+static inline void wpabuf_pool_flush(void)
+{
+}
+
+static inline int wpabuf_pool_get_stats(char *buf, size_t buflen)
+{
+	return 0;
+}
+#endif /* CONFIG_WPABUF_POOL && !WPA_TRACE */
+
 
 /**
  * wpabuf_size - Get the currently allocated size of a wpabuf buffer
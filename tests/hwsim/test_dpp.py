@@ -2697,6 +2697,34 @@ def test_dpp_hostapd_configurator_fragmentation(dev, apdev):
     wait_auth_success(dev[0], hapd, configurator=hapd, enrollee=dev[0],
                       stop_responder=True)
 
+def test_dpp_hostapd_configurator_comeback(dev, apdev):
+    """DPP with hostapd as configurator using GAS comeback delay"""
+    check_dpp_capab(dev[0])
+    hapd = hostapd.add_ap(apdev[0], {"ssid": "unconfigured",
+                                     "channel": "1",
+                                     "gas_comeback_delay": "500"})
+    check_dpp_capab(hapd)
+    conf_id = hapd.dpp_configurator_add()
+    id0 = dev[0].dpp_bootstrap_gen(chan="81/1", mac=True)
+    uri0 = dev[0].request("DPP_BOOTSTRAP_GET_URI %d" % id0)
+    id1 = hapd.dpp_qr_code(uri0)
+    dev[0].dpp_listen(2412)
+    conf = '{"wi-fi_tech":"infra", "discovery":{"ssid":"test"},"cred":{"akm":"psk","pass":"secret passphrase"}}' + 3000*' '
+    hapd.set("dpp_config_obj_override", conf)
+    hapd.dpp_auth_init(peer=id1, configurator=conf_id, conf="sta-dpp")
+    wait_auth_success(dev[0], hapd, configurator=hapd, enrollee=dev[0],
+                      stop_responder=True)
+
+    mib = hapd.get_mib("anqp")
+    logger.info("GAS dialog MIB: " + str(mib))
+    if mib["gas_dialogs_created"] != "1" or \
+       mib["gas_dialogs_completed"] != "1":
+        raise Exception("DPP GAS dialog not completed")
+    if int(mib["gas_comeback_frags"]) < 3:
+        raise Exception("Configuration Response not fragmented")
+    if mib["gas_dialogs_pending"] != "0" or mib["gas_dialog_mem"] != "0":
+        raise Exception("DPP GAS dialog not freed")
+
 def test_dpp_hostapd_enrollee_fragmentation(dev, apdev):
     """DPP and hostapd as Enrollee with GAS fragmentation"""
     check_dpp_capab(dev[0])
@@ -7,6 +7,8 @@
 import logging
 logger = logging.getLogger()
 import os
+import binascii
+import time
 
 from wpasupplicant import WpaSupplicant
 import hostapd
@@ -661,3 +663,77 @@ def test_wpas_config_update_without_file(dev, apdev):
     wpas.set("update_config", "1")
     if "FAIL" not in wpas.request("SAVE_CONFIG"):
         raise Exception("SAVE_CONFIG accepted unexpectedly")
+
+def test_wpas_config_update_delay(dev, apdev, params):
+    """wpa_supplicant delayed configuration updates"""
+    config = os.path.join(params['logdir'], 'wpas_config_update_delay.conf')
+    if os.path.exists(config):
+        os.remove(config)
+
+    with open(config, "w") as f:
+        f.write("update_config=1\n")
+        f.write("update_config_delay=2000\n")
+        f.write("dpp_config_processing=1\n")
+
+    wpas = WpaSupplicant(global_iface='/tmp/wpas-wlan5')
+    wpas.interface_add("wlan5", config=config)
+
+    from test_dpp import check_dpp_capab
+    check_dpp_capab(wpas)
+    conf_id = wpas.dpp_configurator_add()
+
+    def add_network(name):
+        # Self-configuration adds a network and triggers a delayed update
+        ssid = binascii.hexlify(name.encode()).decode()
+        cmd = "DPP_CONFIGURATOR_SIGN conf=sta-dpp ssid=%s configurator=%d" % (ssid, conf_id)
+        if "FAIL" in wpas.request(cmd):
+            raise Exception("DPP_CONFIGURATOR_SIGN failed")
+        ev = wpas.wait_event(["DPP-NETWORK-ID"], timeout=1)
+        if ev is None:
+            raise Exception("DPP network not added")
+
+    def in_config(name):
+        with open(config, "r") as f:
+            return binascii.hexlify(name.encode()).decode() in f.read()
+
+    add_network("delay-1")
+    if in_config("delay-1"):
+        raise Exception("Configuration written without delay")
+    time.sleep(2.5)
+    if not in_config("delay-1"):
+        raise Exception("Delayed configuration update not written")
+
+    # Changes within the delay are covered by the first scheduled update
+    add_network("delay-2")
+    time.sleep(1)
+    add_network("delay-3")
+    if in_config("delay-2") or in_config("delay-3"):
+        raise Exception("Configuration written without delay")
+    time.sleep(1.5)
+    if not in_config("delay-2") or not in_config("delay-3"):
+        raise Exception("Changes not written with the first update")
+
+    # A pending update is written before the configuration is reloaded
+    add_network("delay-4")
+    if "OK" not in wpas.request("RECONFIGURE"):
+        raise Exception("RECONFIGURE failed")
+    if not in_config("delay-4"):
+        raise Exception("Pending update not written before reload")
+    if binascii.hexlify(b"delay-4").decode() not in wpas.request("LIST_NETWORKS"):
+        raise Exception("Network lost in reload")
+
+    # A pending update is written before the interface is removed
+    add_network("delay-5")
+    wpas.interface_remove("wlan5")
+    if not in_config("delay-5"):
+        raise Exception("Pending update not written before interface removal")
+
+    # An unchanged configuration does not replace the file
+    wpas.interface_add("wlan5", config=config)
+    st = os.stat(config)
+    wpas.save_config()
+    st2 = os.stat(config)
+    if st.st_ino != st2.st_ino or st.st_mtime != st2.st_mtime:
+        raise Exception("Unchanged configuration file was replaced")
+    if os.path.exists(config + ".tmp"):
+        raise Exception("Temporary file left behind")
@@ -314,6 +314,149 @@ def test_wpas_ctrl_many_networks(dev, apdev):
     # with the test case failing and following reset operation timing out.
     dev[0].request("REMOVE_NETWORK all", timeout=60)
 
+def add_networks_block(i, extra=""):
+    return 'network={\n\tssid="add-networks-%d"\n\tpsk="passphrase-%d"\n\tkey_mgmt=WPA-PSK\n\tpriority=%d\n%s}\n' % (i, i, i % 3, extra)
+
+def count_networks(dev, ids):
+    return len([i for i in ids if dev.get_network(i, "ssid") is not None])
+
+@remote_compatible
+def test_wpas_ctrl_add_networks(dev):
+    """wpa_supplicant ctrl_iface ADD_NETWORKS"""
+    first = dev[0].add_network()
+    dev[0].remove_network(first)
+
+    res = dev[0].request("ADD_NETWORKS\n# comment\n" +
+                         "".join(add_networks_block(i) for i in range(5)))
+    if "FAIL" in res:
+        raise Exception("ADD_NETWORKS failed")
+    ids = [int(i) for i in res.split()]
+    if ids != list(range(first + 1, first + 6)):
+        raise Exception("Unexpected network ids: " + str(ids))
+    for i in range(5):
+        if dev[0].get_network(ids[i], "ssid") != '"add-networks-%d"' % i:
+            raise Exception("Unexpected ssid for network %d" % ids[i])
+        if dev[0].get_network(ids[i], "priority") != str(i % 3):
+            raise Exception("Unexpected priority for network %d" % ids[i])
+        if dev[0].get_network(ids[i], "disabled") != "1":
+            raise Exception("New network %d not disabled" % ids[i])
+
+    tests = ["ADD_NETWORKS\n",
+             "ADD_NETWORKS\nssid=\"foo\"\n",
+             "ADD_NETWORKS\n" + add_networks_block(10) + "network={\n",
+             "ADD_NETWORKS\n" + add_networks_block(10) + add_networks_block(11, "\tfoo\n"),
+             "ADD_NETWORKS\n" + add_networks_block(10) + add_networks_block(11, "\tkey_mgmt=FOO\n"),
+             "ADD_NETWORKS\n" + add_networks_block(10) + add_networks_block(11, "\tunknown=1\n")]
+    for t in tests:
+        if "FAIL" not in dev[0].request(t):
+            raise Exception("Invalid ADD_NETWORKS accepted: " + t)
+
+    # The invalid batches must not leave any networks behind
+    next_id = dev[0].add_network()
+    if count_networks(dev[0], range(first, next_id)) != 5:
+        raise Exception("Networks from a failed ADD_NETWORKS were not removed")
+    dev[0].request("REMOVE_NETWORK all")
+
+def wpa_cli_add_networks(dev, fname, test_params):
+    prg = os.path.join(test_params['logdir'],
+                       'alt-wpa_supplicant/wpa_supplicant/wpa_cli')
+    if not os.path.exists(prg):
+        prg = '../../wpa_supplicant/wpa_cli'
+    cmd = subprocess.Popen([prg, '-i', dev.ifname, 'add_networks', fname],
+                           stdout=subprocess.PIPE)
+    out = cmd.communicate()[0].decode()
+    return cmd.returncode, out
+
+def test_wpas_ctrl_add_networks_wpa_cli(dev, apdev, test_params):
+    """wpa_cli add_networks with more than one command worth of networks"""
+    fname = os.path.join(test_params['logdir'], 'add_networks.conf')
+    max_len = int(dev[0].request("GET max_command_len"))
+    first = dev[0].add_network()
+    dev[0].remove_network(first)
+
+    with open(fname, 'w') as f:
+        f.write("# batch\n")
+        for i in range(300):
+            f.write(add_networks_block(i))
+    if os.path.getsize(fname) < 3 * max_len:
+        raise Exception("Test file too small")
+    res, out = wpa_cli_add_networks(dev[0], fname, test_params)
+    if res != 0:
+        raise Exception("wpa_cli add_networks failed: " + out)
+    ids = [int(i) for i in out.split()]
+    if ids != list(range(first + 1, first + 301)):
+        raise Exception("Unexpected network ids: " + str(ids))
+    if dev[0].get_network(ids[299], "ssid") != '"add-networks-299"':
+        raise Exception("Unexpected ssid for the last network")
+
+    # An invalid block in the last command removes the networks added by
+    # the earlier commands
+    with open(fname, 'w') as f:
+        for i in range(300, 600):
+            f.write(add_networks_block(i))
+        f.write(add_networks_block(600, "\tkey_mgmt=FOO\n"))
+    res, out = wpa_cli_add_networks(dev[0], fname, test_params)
+    if res == 0 or "FAIL" not in out:
+        raise Exception("Invalid network block accepted: " + out)
+    next_id = dev[0].add_network()
+    if count_networks(dev[0], range(first, next_id)) != 300:
+        raise Exception("Networks were not removed after a failed command")
+
+    # A single block that does not fit in one command is rejected
+    with open(fname, 'w') as f:
+        f.write(add_networks_block(700))
+        f.write(add_networks_block(701, "\tpriority=1\n" * (max_len // 10)))
+    res, out = wpa_cli_add_networks(dev[0], fname, test_params)
+    if res == 0 or "command limit" not in out:
+        raise Exception("Oversized network block accepted: " + out)
+    if count_networks(dev[0], range(next_id, next_id + 10)) != 1:
+        raise Exception("Networks were not removed after an oversized block")
+    dev[0].request("REMOVE_NETWORK all", timeout=60)
+
+@remote_compatible
+def test_wpas_ctrl_network_index(dev):
+    """wpa_supplicant network and credential id lookup after removals"""
+    ids = [dev[0].add_network() for i in range(200)]
+    for i in ids:
+        dev[0].set_network_quoted(i, "ssid", "index-%d" % i)
+    for i in ids[::2]:
+        dev[0].remove_network(i)
+    for i in ids:
+        ssid = dev[0].get_network(i, "ssid")
+        if i in ids[::2]:
+            if ssid is not None:
+                raise Exception("Removed network %d still found" % i)
+            if "FAIL" not in dev[0].request("SET_NETWORK %d priority 1" % i):
+                raise Exception("SET_NETWORK accepted for removed network")
+            if "FAIL" not in dev[0].request("ENABLE_NETWORK %d no-connect" % i):
+                raise Exception("ENABLE_NETWORK accepted for removed network")
+        elif ssid != '"index-%d"' % i:
+            raise Exception("Unexpected ssid for network %d: %s" % (i, ssid))
+    if "FAIL" not in dev[0].request("GET_NETWORK %d ssid" % (ids[-1] + 1)):
+        raise Exception("GET_NETWORK accepted for an unused id")
+    new = dev[0].add_network()
+    if new != ids[-1] + 1:
+        raise Exception("Unexpected id for a new network: %d" % new)
+    dev[0].request("REMOVE_NETWORK all")
+    if dev[0].get_network(ids[1], "ssid") is not None:
+        raise Exception("Network found after REMOVE_NETWORK all")
+
+    creds = [dev[0].add_cred() for i in range(50)]
+    for i in creds:
+        dev[0].set_cred_quoted(i, "realm", "realm-%d" % i)
+    for i in creds[1::2]:
+        dev[0].remove_cred(i)
+    for i in creds:
+        realm = dev[0].request("GET_CRED %d realm" % i)
+        if i in creds[1::2]:
+            if "FAIL" not in realm:
+                raise Exception("Removed cred %d still found" % i)
+        elif realm != '"realm-%d"' % i:
+            raise Exception("Unexpected realm for cred %d: %s" % (i, realm))
+    dev[0].request("REMOVE_CRED all")
+    if "FAIL" not in dev[0].request("GET_CRED %d realm" % creds[0]):
+        raise Exception("Cred found after REMOVE_CRED all")
+
 @remote_compatible
 def test_wpas_ctrl_dup_network(dev, apdev):
     """wpa_supplicant ctrl_iface DUP_NETWORK"""
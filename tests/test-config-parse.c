@@ -0,0 +1,161 @@
+/*
+ * hostapd configuration file parsing benchmark
+ * Copyright (c) 2026, Infineon Technologies AG
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ *
+ * Writes a configuration file with 100 BSSs into a temporary file, parses it
+ * with hostapd_config_read() the requested number of times, and reports the
+ * average time per parse. The parameters of each BSS are spread over the
+ * keyword list of hostapd_config_fill() so that the cost of finding the
+ * matching keyword is included.
+ *
+ * usage: test-config-parse [rounds]
+ */
+
+#include "utils/includes.h"
+#include <time.h>
+
+#include "utils/common.h"
+#include "ap/ap_config.h"
+#include "config_file.h"
+
+#define NUM_BSS 100
+
+static const char *bss_params[] = {
+	"wpa=2",
+	"wpa_key_mgmt=WPA-PSK WPA-PSK-SHA256",
+	"rsn_pairwise=CCMP",
+	"ieee80211w=1",
+	"sae_require_mfp=1",
+	"ap_isolate=1",
+	"max_num_sta=64",
+	"ignore_broadcast_ssid=0",
+	"macaddr_acl=0",
+	"auth_algs=1",
+	"wpa_group_rekey=3600",
+	"eapol_key_index_workaround=0",
+	"logger_syslog=-1",
+	"logger_syslog_level=2",
+	"logger_stdout=-1",
+	"logger_stdout_level=2",
+	"utf8_ssid=1",
+	"bss_load_update_period=50",
+	"okc=1",
+	"disable_pmksa_caching=0",
+	"wpa_disable_eapol_key_retries=0",
+	"rrm_neighbor_report=1",
+	"rrm_beacon_report=1",
+	"multicast_to_unicast=0",
+	"ap_max_inactivity=300",
+	"skip_inactivity_poll=0",
+	"time_advertisement=0",
+	"interworking=0",
+	"hs20=0",
+	"mobility_domain=a1b2",
+	"nas_identifier=ap.example.com",
+	"send_probe_response=1",
+	NULL
+};
+
+
+static u64 now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u64) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+
+static int write_config(const char *fname, unsigned int *lines)
+{
+	FILE *f;
+	int i, j;
+
+	f = fopen(fname, "w");
+	if (!f)
+		return -1;
+
+	fprintf(f, "driver=none\ninterface=wlan0\nhw_mode=g\nchannel=6\n"
+		"country_code=US\nieee80211n=1\nieee80211d=1\n"
+		"beacon_int=100\ndtim_period=2\nwmm_enabled=1\n");
+	*lines = 10;
+	for (i = 0; i < NUM_BSS; i++) {
+		if (i > 0) {
+			fprintf(f, "bss=wlan0_%d\nbssid=02:00:00:00:%02x:00\n",
+				i, i);
+			*lines += 2;
+		}
+		fprintf(f, "ssid=test-%d\nwpa_passphrase=passphrase-%d\n",
+			i, i);
+		*lines += 2;
+		for (j = 0; bss_params[j]; j++) {
+			fprintf(f, "%s\n", bss_params[j]);
+			(*lines)++;
+		}
+	}
+
+	fclose(f);
+	return 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+	char fname[] = "/tmp/test-config-parse.XXXXXX", ssid[20];
+	struct hostapd_config *conf;
+	unsigned int rounds = 100, lines, i;
+	u64 start, total = 0;
+	int fd, ret = -1;
+
+	if (argc > 1)
+		rounds = atoi(argv[1]);
+	if (rounds == 0)
+		rounds = 1;
+
+	wpa_debug_level = MSG_ERROR;
+	if (os_program_init())
+		return -1;
+
+	fd = mkstemp(fname);
+	if (fd < 0) {
+		perror("mkstemp");
+		goto out;
+	}
+	close(fd);
+	os_snprintf(ssid, sizeof(ssid), "test-%d", NUM_BSS - 1);
+	if (write_config(fname, &lines) < 0) {
+		printf("Failed to write %s\n", fname);
+		goto fail;
+	}
+
+	for (i = 0; i < rounds; i++) {
+		start = now_ns();
+		conf = hostapd_config_read(fname);
+		total += now_ns() - start;
+		if (!conf) {
+			printf("Failed to parse the configuration\n");
+			goto fail;
+		}
+		if (conf->num_bss != NUM_BSS ||
+		    conf->bss[NUM_BSS - 1]->ssid.ssid_len != os_strlen(ssid) ||
+		    os_memcmp(conf->bss[NUM_BSS - 1]->ssid.ssid, ssid,
+			      os_strlen(ssid)) != 0) {
+			printf("Unexpected configuration after parsing\n");
+			hostapd_config_free(conf);
+			goto fail;
+		}
+		hostapd_config_free(conf);
+	}
+
+	printf("%d BSSs, %u lines: %.3f ms per parse\n", NUM_BSS, lines,
+	       total / 1000000.0 / rounds);
+	ret = 0;
+fail:
+	unlink(fname);
+out:
+	os_program_deinit();
+	return ret;
+}
@@ -0,0 +1,226 @@
+/*
+ * Hardware accelerated internal crypto - test and benchmark program
+ * Copyright (c) 2026, Infineon Technologies AG
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "includes.h"
+
+#include "common.h"
+#include "crypto/crypto.h"
+#include "crypto/crypto_accel.h"
+#include "crypto/aes.h"
+#include "crypto/aes_wrap.h"
+#include "crypto/sha1.h"
+#include "crypto/sha256.h"
+
+#define ALL_CAPS (CRYPTO_ACCEL_AES | CRYPTO_ACCEL_SHA1 | CRYPTO_ACCEL_SHA256)
+
+static u32 prng_state = 0x12345678;
+
+
+static void prng_fill(u8 *buf, size_t len)
+{
+	while (len--) {
+		prng_state = prng_state * 1103515245 + 12345;
+		*buf++ = prng_state >> 16;
+	}
+}
+
+
+static int check_aes(size_t key_len)
+{
+	u8 key[32], in[16], hw[16], sw[16], dec[16];
+	void *ehw, *esw, *dhw, *dsw;
+	int i, ret = 0;
+
+	prng_fill(key, key_len);
+	crypto_accel_set_mask(0);
+	ehw = aes_encrypt_init(key, key_len);
+	dhw = aes_decrypt_init(key, key_len);
+	crypto_accel_set_mask(ALL_CAPS);
+	esw = aes_encrypt_init(key, key_len);
+	dsw = aes_decrypt_init(key, key_len);
+	crypto_accel_set_mask(0);
+	if (!ehw || !dhw || !esw || !dsw) {
+		ret = -1;
+		goto out;
+	}
+
+	for (i = 0; i < 1000; i++) {
+		prng_fill(in, sizeof(in));
+		aes_encrypt(ehw, in, hw);
+		aes_encrypt(esw, in, sw);
+		if (os_memcmp(hw, sw, 16) != 0) {
+			printf("AES-%d encrypt mismatch\n", (int) key_len * 8);
+			ret = -1;
+			break;
+		}
+		aes_decrypt(dhw, hw, dec);
+		aes_decrypt(dsw, in, sw);
+		aes_decrypt(dhw, in, hw);
+		if (os_memcmp(dec, in, 16) != 0 || os_memcmp(hw, sw, 16) != 0) {
+			printf("AES-%d decrypt mismatch\n", (int) key_len * 8);
+			ret = -1;
+			break;
+		}
+	}
+
+out:
+	aes_encrypt_deinit(ehw);
+	aes_encrypt_deinit(esw);
+	aes_decrypt_deinit(dhw);
+	aes_decrypt_deinit(dsw);
+	return ret;
+}
+
+
+static int check_sha(void)
+{
+	u8 data[300], hw[32], sw[32];
+	const u8 *addr[1] = { data };
+	size_t len;
+
+	prng_fill(data, sizeof(data));
+	for (len = 0; len <= sizeof(data); len++) {
+		crypto_accel_set_mask(0);
+		sha1_vector(1, addr, &len, hw);
+		crypto_accel_set_mask(ALL_CAPS);
+		sha1_vector(1, addr, &len, sw);
+		if (os_memcmp(hw, sw, SHA1_MAC_LEN) != 0) {
+			printf("SHA-1 mismatch for length %u\n",
+			       (unsigned int) len);
+			return -1;
+		}
+
+		crypto_accel_set_mask(0);
+		sha256_vector(1, addr, &len, hw);
+		crypto_accel_set_mask(ALL_CAPS);
+		sha256_vector(1, addr, &len, sw);
+		if (os_memcmp(hw, sw, SHA256_MAC_LEN) != 0) {
+			printf("SHA-256 mismatch for length %u\n",
+			       (unsigned int) len);
+			return -1;
+		}
+	}
+	crypto_accel_set_mask(0);
+
+	return 0;
+}
+
+
+enum bench_op {
+	BENCH_AES_BLOCK,
+	BENCH_AES_WRAP,
+	BENCH_OMAC1,
+	BENCH_SHA256,
+	BENCH_PBKDF2,
+};
+
+
+static int run_op(enum bench_op op, unsigned int rounds)
+{
+	u8 key[16], data[1500], out[1500 + 8];
+	const u8 *addr[1] = { data };
+	size_t len = sizeof(data);
+	unsigned int i;
+	void *ctx;
+
+	os_memset(key, 0x11, sizeof(key));
+	os_memset(data, 0x22, sizeof(data));
+
+	switch (op) {
+	case BENCH_AES_BLOCK:
+		ctx = aes_encrypt_init(key, sizeof(key));
+		if (!ctx)
+			return -1;
+		for (i = 0; i < rounds * 100; i++)
+			aes_encrypt(ctx, data + (i & 0xff), out);
+		aes_encrypt_deinit(ctx);
+		return 0;
+	case BENCH_AES_WRAP:
+		for (i = 0; i < rounds; i++) {
+			if (aes_wrap(key, sizeof(key), 4, data, out) ||
+			    aes_unwrap(key, sizeof(key), 4, out, data))
+				return -1;
+		}
+		return 0;
+	case BENCH_OMAC1:
+		for (i = 0; i < rounds; i++)
+			if (omac1_aes_128(key, data, sizeof(data), out))
+				return -1;
+		return 0;
+	case BENCH_SHA256:
+		for (i = 0; i < rounds; i++)
+			if (sha256_vector(1, addr, &len, out))
+				return -1;
+		return 0;
+	case BENCH_PBKDF2:
+		for (i = 0; i < rounds / 100 + 1; i++)
+			if (pbkdf2_sha1("passphrase", (const u8 *) "ssid", 4,
+					4096, out, 32))
+				return -1;
+		return 0;
+	}
+
+	return -1;
+}
+
+
+static int run_bench(const char *title, enum bench_op op, unsigned int rounds)
+{
+	struct os_reltime start, end, diff[2];
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		crypto_accel_set_mask(i == 0 ? ALL_CAPS : 0);
+		os_get_reltime(&start);
+		if (run_op(op, rounds) < 0) {
+			printf("%s: failed\n", title);
+			crypto_accel_set_mask(0);
+			return -1;
+		}
+		os_get_reltime(&end);
+		os_reltime_sub(&end, &start, &diff[i]);
+	}
+	crypto_accel_set_mask(0);
+
+	printf("%-12s portable %ld.%06ld s  accelerated %ld.%06ld s\n", title,
+	       (long) diff[0].sec, (long) diff[0].usec,
+	       (long) diff[1].sec, (long) diff[1].usec);
+	return 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+	unsigned int rounds = 10000;
+	char info[200];
+	int ret = 0;
+
+	if (argc > 1)
+		rounds = atoi(argv[1]);
+
+	crypto_accel_get_info(info, sizeof(info));
+	printf("%s", info);
+	if (!crypto_accel_get_caps())
+		printf("No hardware acceleration available - comparing the portable implementation with itself\n");
+
+	if (check_aes(16) < 0 || check_aes(24) < 0 || check_aes(32) < 0 ||
+	    check_sha() < 0) {
+		printf("Accelerated and portable implementations differ\n");
+		return -1;
+	}
+	printf("Accelerated and portable implementations match\n");
+
+	if (run_bench("AES block", BENCH_AES_BLOCK, rounds) < 0 ||
+	    run_bench("AES wrap", BENCH_AES_WRAP, rounds) < 0 ||
+	    run_bench("OMAC1", BENCH_OMAC1, rounds) < 0 ||
+	    run_bench("SHA-256", BENCH_SHA256, rounds) < 0 ||
+	    run_bench("PBKDF2-SHA1", BENCH_PBKDF2, rounds) < 0)
+		ret = -1;
+
+	return ret;
+}
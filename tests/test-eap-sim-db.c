@@ -0,0 +1,511 @@
+/*
+ * EAP-SIM/AKA DB client - test and benchmark program
+ * Copyright (c) 2026, Infineon Technologies AG
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ *
+ * Without arguments, eap_sim_db is tested against a gateway emulated in this
+ * process. With arguments, full authentications of returning subscribers are
+ * timed against a running hlr_auc_gw with and without vector prefetch:
+ *
+ * usage: test-eap-sim-db <socket path> <first IMSI> <num IMSIs> [rounds]
+ *        [prefetch]
+ */
+
+#include "utils/includes.h"
+#include <sys/un.h>
+
+#include "utils/common.h"
+#include "utils/eloop.h"
+#include "utils/list.h"
+#include "eap_server/eap_sim_db.h"
+
+#define NUM_PIPELINED 500
+#define NUM_BENCH_MAX 10000
+
+
+struct gw_resp {
+	struct dl_list list;
+	struct sockaddr_un peer;
+	socklen_t peer_len;
+	size_t len;
+	char buf[300];
+};
+
+/* Emulated HLR/AuC gateway */
+static struct {
+	int sock;
+	char path[64];
+	struct sockaddr_un peer;
+	socklen_t peer_len;
+	struct dl_list queue;
+	int write_registered;
+	unsigned int requests;
+	unsigned int auts;
+	int drop;
+} gw;
+
+static unsigned int completed;
+static unsigned int expected;
+static int sessions[NUM_BENCH_MAX];
+
+
+static void gw_writable(int sock, void *eloop_ctx, void *sock_ctx)
+{
+	struct gw_resp *resp;
+
+	while ((resp = dl_list_first(&gw.queue, struct gw_resp, list))) {
+		if (sendto(sock, resp->buf, resp->len, MSG_DONTWAIT,
+			   (struct sockaddr *) &resp->peer,
+			   resp->peer_len) < 0 && errno == EAGAIN)
+			return;
+		dl_list_del(&resp->list);
+		os_free(resp);
+	}
+	eloop_unregister_sock(sock, EVENT_TYPE_WRITE);
+	gw.write_registered = 0;
+}
+
+
+static void gw_send(const char *buf, size_t len)
+{
+	struct gw_resp *resp;
+
+	if (dl_list_empty(&gw.queue) &&
+	    (sendto(gw.sock, buf, len, MSG_DONTWAIT,
+		    (struct sockaddr *) &gw.peer, gw.peer_len) >= 0 ||
+	     errno != EAGAIN))
+		return;
+
+	resp = os_zalloc(sizeof(*resp));
+	if (!resp || len > sizeof(resp->buf)) {
+		os_free(resp);
+		return;
+	}
+	os_memcpy(resp->buf, buf, len);
+	resp->len = len;
+	resp->peer = gw.peer;
+	resp->peer_len = gw.peer_len;
+	dl_list_add_tail(&gw.queue, &resp->list);
+	if (!gw.write_registered) {
+		eloop_register_sock(gw.sock, EVENT_TYPE_WRITE, gw_writable,
+				    NULL, NULL);
+		gw.write_registered = 1;
+	}
+}
+
+
+/*
+ * RAND is <number of AUTS> | <request number> | IMSI so that the tests can see
+ * which request the vector came from.
+ */
+static void gw_rand(u8 *_rand, const char *imsi, unsigned int chal)
+{
+	WPA_PUT_BE32(_rand, gw.auts);
+	WPA_PUT_BE32(_rand + 4, gw.requests);
+	WPA_PUT_BE32(_rand + 8, chal);
+	WPA_PUT_BE32(_rand + 12, atoi(imsi + os_strlen(imsi) - 6));
+}
+
+
+static void gw_receive(int sock, void *eloop_ctx, void *sock_ctx)
+{
+	char buf[200], resp[300], *imsi, *pos, *end;
+	u8 _rand[16], val[16];
+	unsigned int i;
+	int res;
+
+	gw.peer_len = sizeof(gw.peer);
+	res = recvfrom(sock, buf, sizeof(buf) - 1, 0,
+		       (struct sockaddr *) &gw.peer, &gw.peer_len);
+	if (res <= 0)
+		return;
+	buf[res] = '\0';
+
+	imsi = os_strchr(buf, ' ');
+	if (!imsi)
+		return;
+	*imsi++ = '\0';
+	end = os_strchr(imsi, ' ');
+	if (end)
+		*end = '\0';
+
+	if (os_strcmp(buf, "AKA-AUTS") == 0) {
+		gw.auts++;
+		return;
+	}
+	gw.requests++;
+	if (gw.drop)
+		return;
+
+	os_memset(val, 0x11, sizeof(val));
+	pos = resp;
+	end = resp + sizeof(resp);
+	if (os_strcmp(buf, "AKA-REQ-AUTH") == 0) {
+		gw_rand(_rand, imsi, 0);
+		pos += os_snprintf(pos, end - pos, "AKA-RESP-AUTH %s ", imsi);
+		pos += wpa_snprintf_hex(pos, end - pos, _rand, 16);
+		for (i = 0; i < 3; i++) {
+			*pos++ = ' ';
+			pos += wpa_snprintf_hex(pos, end - pos, val, 16);
+		}
+		*pos++ = ' ';
+		pos += wpa_snprintf_hex(pos, end - pos, val, 8);
+	} else if (os_strcmp(buf, "SIM-REQ-AUTH") == 0) {
+		pos += os_snprintf(pos, end - pos, "SIM-RESP-AUTH %s", imsi);
+		for (i = 0; i < 3; i++) {
+			gw_rand(_rand, imsi, i);
+			*pos++ = ' ';
+			pos += wpa_snprintf_hex(pos, end - pos, val, 8);
+			*pos++ = ':';
+			pos += wpa_snprintf_hex(pos, end - pos, val, 4);
+			*pos++ = ':';
+			pos += wpa_snprintf_hex(pos, end - pos, _rand, 16);
+		}
+	} else {
+		return;
+	}
+	gw_send(resp, pos - resp);
+}
+
+
+static int gw_init(void)
+{
+	struct sockaddr_un addr;
+
+	os_memset(&gw, 0, sizeof(gw));
+	dl_list_init(&gw.queue);
+	os_snprintf(gw.path, sizeof(gw.path), "/tmp/test-eap-sim-db-%d",
+		    getpid());
+	unlink(gw.path);
+	gw.sock = socket(PF_UNIX, SOCK_DGRAM, 0);
+	if (gw.sock < 0)
+		return -1;
+	os_memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	os_strlcpy(addr.sun_path, gw.path, sizeof(addr.sun_path));
+	if (bind(gw.sock, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+		close(gw.sock);
+		return -1;
+	}
+	eloop_register_read_sock(gw.sock, gw_receive, NULL, NULL);
+	return 0;
+}
+
+
+static void gw_deinit(void)
+{
+	struct gw_resp *resp, *prev;
+
+	dl_list_for_each_safe(resp, prev, &gw.queue, struct gw_resp, list) {
+		dl_list_del(&resp->list);
+		os_free(resp);
+	}
+	if (gw.write_registered)
+		eloop_unregister_sock(gw.sock, EVENT_TYPE_WRITE);
+	eloop_unregister_read_sock(gw.sock);
+	close(gw.sock);
+	unlink(gw.path);
+}
+
+
+static void get_complete_cb(void *ctx, void *session_ctx)
+{
+	completed++;
+	if (completed >= expected)
+		eloop_terminate();
+}
+
+
+static void run_timeout(void *eloop_ctx, void *user_ctx)
+{
+	eloop_terminate();
+}
+
+
+/* Run the event loop until the expected number of callbacks or timeout */
+static void run(unsigned int callbacks, unsigned int timeout_ms)
+{
+	completed = 0;
+	expected = callbacks;
+	eloop_register_timeout(timeout_ms / 1000, (timeout_ms % 1000) * 1000,
+			       run_timeout, NULL, NULL);
+	eloop_run();
+	eloop_cancel_timeout(run_timeout, NULL, NULL);
+}
+
+
+static void make_username(char *buf, size_t len, char prefix,
+			  unsigned long long imsi)
+{
+	os_snprintf(buf, len, "%c%llu", prefix, imsi);
+}
+
+
+static int get_aka(struct eap_sim_db_data *db, const char *username,
+		   void *session, u8 *_rand)
+{
+	u8 autn[EAP_AKA_AUTN_LEN], ik[EAP_AKA_IK_LEN], ck[EAP_AKA_CK_LEN];
+	u8 res[EAP_AKA_RES_MAX_LEN];
+	size_t res_len;
+
+	return eap_sim_db_get_aka_auth(db, username, _rand, autn, ik, ck,
+				       res, &res_len, session);
+}
+
+
+static int test_pipelined(void)
+{
+	struct eap_sim_db_data *db;
+	char cfg[100], username[30];
+	u8 _rand[EAP_AKA_RAND_LEN];
+	unsigned int i, requests;
+	int ret = -1;
+
+	os_snprintf(cfg, sizeof(cfg), "unix:%s", gw.path);
+	db = eap_sim_db_init(cfg, 5, get_complete_cb, NULL);
+	if (!db)
+		return -1;
+
+	/* More requests than the gateway socket can queue */
+	for (i = 0; i < NUM_PIPELINED; i++) {
+		make_username(username, sizeof(username),
+			      EAP_AKA_PERMANENT_PREFIX, 232010000000000ULL + i);
+		if (get_aka(db, username, &sessions[i], _rand) !=
+		    EAP_SIM_DB_PENDING) {
+			printf("Request %u not pending\n", i);
+			goto out;
+		}
+	}
+	requests = gw.requests;
+	run(NUM_PIPELINED, 5000);
+	if (completed != NUM_PIPELINED) {
+		printf("Pipelined: %u/%u callbacks (%u requests before the "
+		       "event loop)\n", completed, NUM_PIPELINED, requests);
+		goto out;
+	}
+	for (i = 0; i < NUM_PIPELINED; i++) {
+		make_username(username, sizeof(username),
+			      EAP_AKA_PERMANENT_PREFIX, 232010000000000ULL + i);
+		if (get_aka(db, username, &sessions[i], _rand) != 0 ||
+		    WPA_GET_BE32(_rand + 12) != i) {
+			printf("Pipelined: wrong result for %u\n", i);
+			goto out;
+		}
+	}
+	ret = 0;
+out:
+	eap_sim_db_deinit(db);
+	return ret;
+}
+
+
+static int test_prefetch(void)
+{
+	struct eap_sim_db_data *db;
+	char cfg[100], aka[30], sim[30];
+	u8 _rand[EAP_AKA_RAND_LEN], rand1[EAP_AKA_RAND_LEN];
+	u8 sim_rand[EAP_SIM_MAX_CHAL * GSM_RAND_LEN];
+	u8 kc[EAP_SIM_MAX_CHAL * EAP_SIM_KC_LEN];
+	u8 sres[EAP_SIM_MAX_CHAL * EAP_SIM_SRES_LEN];
+	unsigned int i, requests;
+	int ret = -1;
+
+	os_snprintf(cfg, sizeof(cfg), "unix:%s prefetch=60", gw.path);
+	db = eap_sim_db_init(cfg, 1, get_complete_cb, NULL);
+	if (!db)
+		return -1;
+	make_username(aka, sizeof(aka), EAP_AKA_PERMANENT_PREFIX,
+		      232010000000001ULL);
+	make_username(sim, sizeof(sim), EAP_SIM_PERMANENT_PREFIX,
+		      232010000000002ULL);
+
+	/* The first two authentications have to wait for the gateway */
+	for (i = 0; i < 2; i++) {
+		if (get_aka(db, aka, &sessions[0], _rand) !=
+		    EAP_SIM_DB_PENDING ||
+		    eap_sim_db_get_gsm_triplets(db, sim, EAP_SIM_MAX_CHAL,
+						sim_rand, kc, sres,
+						&sessions[1]) !=
+		    EAP_SIM_DB_PENDING) {
+			printf("Prefetch: authentication %u not pending\n", i);
+			goto out;
+		}
+		run(2, 1000);
+		if (completed != 2 ||
+		    get_aka(db, aka, &sessions[0], _rand) != 0 ||
+		    eap_sim_db_get_gsm_triplets(db, sim, EAP_SIM_MAX_CHAL,
+						sim_rand, kc, sres,
+						&sessions[1]) !=
+		    EAP_SIM_MAX_CHAL) {
+			printf("Prefetch: authentication %u failed\n", i);
+			goto out;
+		}
+	}
+
+	/* Returning subscribers: spare vectors were requested for the next
+	 * authentication */
+	requests = gw.requests;
+	run(1, 100);
+	if (completed != 0 || gw.requests != requests + 2) {
+		printf("Prefetch: %u spare vectors requested\n",
+		       gw.requests - requests);
+		goto out;
+	}
+	os_memcpy(rand1, _rand, sizeof(_rand));
+	if (get_aka(db, aka, &sessions[0], _rand) != 0 ||
+	    WPA_GET_BE32(_rand + 4) <= WPA_GET_BE32(rand1 + 4) ||
+	    eap_sim_db_get_gsm_triplets(db, sim, EAP_SIM_MAX_CHAL, sim_rand,
+					kc, sres, &sessions[1]) !=
+	    EAP_SIM_MAX_CHAL) {
+		printf("Prefetch: spare vector not used\n");
+		goto out;
+	}
+
+	/* A spare vector from before AKA resynchronization is not used */
+	run(1, 100);
+	if (eap_sim_db_resynchronize(db, aka, _rand, _rand) < 0 ||
+	    get_aka(db, aka, &sessions[0], _rand) != EAP_SIM_DB_PENDING) {
+		printf("Prefetch: spare vector used after AUTS\n");
+		goto out;
+	}
+	run(1, 1000);
+	if (get_aka(db, aka, &sessions[0], _rand) != 0 ||
+	    WPA_GET_BE32(_rand) != gw.auts) {
+		printf("Prefetch: vector not requested after AUTS\n");
+		goto out;
+	}
+
+	/* Neither is a response to a prefetch that was in progress */
+	if (eap_sim_db_resynchronize(db, aka, _rand, _rand) < 0 ||
+	    get_aka(db, aka, &sessions[0], _rand) != EAP_SIM_DB_PENDING) {
+		printf("Prefetch: resynchronization during prefetch failed\n");
+		goto out;
+	}
+	run(1, 1000);
+	if (completed != 1 || get_aka(db, aka, &sessions[0], _rand) != 0 ||
+	    WPA_GET_BE32(_rand) != gw.auts) {
+		printf("Prefetch: stale response used after AUTS\n");
+		goto out;
+	}
+
+	/* Query timeout */
+	gw.drop = 1;
+	run(1, 100);
+	if (get_aka(db, aka, &sessions[0], _rand) != EAP_SIM_DB_PENDING) {
+		printf("Prefetch: no new request\n");
+		goto out;
+	}
+	run(1, 3000);
+	if (completed != 1 ||
+	    get_aka(db, aka, &sessions[0], _rand) != EAP_SIM_DB_FAILURE) {
+		printf("Prefetch: query did not time out\n");
+		goto out;
+	}
+	ret = 0;
+out:
+	gw.drop = 0;
+	eap_sim_db_deinit(db);
+	return ret;
+}
+
+
+/*
+ * Returning subscribers authenticate one after another. The time a session
+ * waits for its vector is measured; with prefetch, the spare vector requested
+ * after the previous authentication is used if it is already available.
+ */
+static void bench(const char *path, unsigned long long first_imsi,
+		  unsigned int num, unsigned int rounds, int prefetch)
+{
+	struct eap_sim_db_data *db;
+	char cfg[100], username[30];
+	u8 _rand[EAP_AKA_RAND_LEN];
+	struct os_reltime start, end, diff;
+	unsigned int r, i, immediate = 0, failed = 0;
+	u64 wait = 0;
+	int res;
+
+	if (prefetch)
+		os_snprintf(cfg, sizeof(cfg), "unix:%s prefetch=3600", path);
+	else
+		os_snprintf(cfg, sizeof(cfg), "unix:%s", path);
+	db = eap_sim_db_init(cfg, 5, get_complete_cb, NULL);
+	if (!db)
+		return;
+
+	for (r = 0; r < rounds; r++) {
+		for (i = 0; i < num; i++) {
+			make_username(username, sizeof(username),
+				      EAP_AKA_PERMANENT_PREFIX,
+				      first_imsi + i);
+			os_get_reltime(&start);
+			res = get_aka(db, username, &sessions[i], _rand);
+			if (res == EAP_SIM_DB_PENDING) {
+				run(1, 5000);
+				res = get_aka(db, username, &sessions[i],
+					      _rand);
+			} else if (res == 0) {
+				immediate++;
+			}
+			os_get_reltime(&end);
+			if (res != 0)
+				failed++;
+			os_reltime_sub(&end, &start, &diff);
+			wait += diff.sec * 1000000 + diff.usec;
+			/* The rest of the EAP exchange takes at least a few
+			 * round trips to the station */
+			run(1, 1);
+		}
+	}
+
+	printf("%s: %u authentications (%u failed), %u without waiting, "
+	       "average wait %llu usec\n",
+	       prefetch ? "prefetch" : "no prefetch", rounds * num, failed,
+	       immediate, (unsigned long long) (wait / (rounds * num)));
+	eap_sim_db_deinit(db);
+}
+
+
+int main(int argc, char *argv[])
+{
+	int ret = -1;
+
+	if (os_program_init())
+		return -1;
+	if (eloop_init())
+		goto out;
+
+	if (argc > 3) {
+		unsigned int num = atoi(argv[3]), rounds = 3;
+
+		if (argc > 4)
+			rounds = atoi(argv[4]);
+		if (num == 0 || num > NUM_BENCH_MAX || rounds == 0) {
+			printf("Invalid arguments\n");
+			goto out;
+		}
+		bench(argv[1], strtoull(argv[2], NULL, 10), num, rounds,
+		      argc > 5 && os_strcmp(argv[5], "prefetch") == 0);
+		ret = 0;
+		goto out;
+	}
+
+	if (gw_init() < 0) {
+		printf("Could not create the gateway socket\n");
+		goto out;
+	}
+	if (test_pipelined() < 0 || test_prefetch() < 0) {
+		printf("EAP-SIM DB tests failed\n");
+		gw_deinit();
+		goto out;
+	}
+	gw_deinit();
+	printf("EAP-SIM DB tests passed\n");
+	ret = 0;
+out:
+	eloop_destroy();
+	os_program_deinit();
+	return ret;
+}
@@ -0,0 +1,230 @@
+/*
+ * EAP user lookup index - test and benchmark program
+ * Copyright (c) 2026, Infineon Technologies AG
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "ap/ap_config.h"
+
+#define NUM_USERS 100000
+#define NUM_PREFIXES 100
+
+
+static void free_users(struct hostapd_eap_user *user)
+{
+	struct hostapd_eap_user *prev;
+
+	while (user) {
+		prev = user;
+		user = user->next;
+		os_free(prev->identity);
+		os_free(prev);
+	}
+}
+
+
+static struct hostapd_eap_user * add_user(struct hostapd_eap_user **tail,
+					  const char *identity, int phase2,
+					  int wildcard_prefix)
+{
+	struct hostapd_eap_user *user;
+
+	user = os_zalloc(sizeof(*user));
+	if (!user)
+		return NULL;
+	if (identity) {
+		user->identity = (u8 *) os_strdup(identity);
+		if (!user->identity) {
+			os_free(user);
+			return NULL;
+		}
+		user->identity_len = os_strlen(identity);
+	}
+	user->phase2 = phase2;
+	user->wildcard_prefix = wildcard_prefix;
+	(*tail)->next = user;
+	*tail = user;
+	return user;
+}
+
+
+/*
+ * Build a user list corresponding to an eap_user file with per-device
+ * identities: Phase 1 and Phase 2 entries for each device, wildcard prefixes
+ * for device classes (some of which shadow later exact entries), duplicates,
+ * and a final "*" entry.
+ */
+static struct hostapd_eap_user * build_users(unsigned int num)
+{
+	struct hostapd_eap_user head, *tail = &head;
+	char id[100];
+	unsigned int i;
+
+	os_memset(&head, 0, sizeof(head));
+
+	for (i = 0; i < NUM_PREFIXES; i++) {
+		os_snprintf(id, sizeof(id), "class%02u-", i);
+		if (!add_user(&tail, id, i & 1, 1))
+			goto fail;
+	}
+	/* Shadows user0000010..user0000019 */
+	if (!add_user(&tail, "user000001", 0, 1))
+		goto fail;
+
+	for (i = 0; i < num / 2; i++) {
+		os_snprintf(id, sizeof(id), "user%07u@example.com", i);
+		if (!add_user(&tail, id, 0, 0) ||
+		    !add_user(&tail, id, 1, 0))
+			goto fail;
+		if (i % 1000 == 0 && !add_user(&tail, id, 0, 0))
+			goto fail;
+	}
+
+	if (!add_user(&tail, "", 1, 0) ||
+	    !add_user(&tail, "anon", 0, 1) ||
+	    !add_user(&tail, NULL, 0, 0))
+		goto fail;
+
+	return head.next;
+
+fail:
+	free_users(head.next);
+	return NULL;
+}
+
+
+static void query_id(char *buf, size_t len, unsigned int i, unsigned int num)
+{
+	switch (i % 5) {
+	case 0:
+	case 1:
+		os_snprintf(buf, len, "user%07u@example.com",
+			    (i * 7919) % (num / 2));
+		break;
+	case 2:
+		os_snprintf(buf, len, "class%02u-device%u", i % NUM_PREFIXES,
+			    i);
+		break;
+	case 3:
+		os_snprintf(buf, len, "unknown%u@example.org", i);
+		break;
+	default:
+		os_snprintf(buf, len, "user%07u@example.com", i % 20);
+		break;
+	}
+}
+
+
+static int check(struct hostapd_eap_user *users,
+		 struct hostapd_eap_user_index *idx, unsigned int num)
+{
+	static const char *special[] = {
+		"", "anon", "anonymous@example.com", "class", "class0",
+		"class99-", "user000001", "user0000015@example.com", NULL
+	};
+	char id[100];
+	unsigned int i;
+	int phase2;
+
+	for (i = 0; i < 2000 + ARRAY_SIZE(special); i++) {
+		if (i < ARRAY_SIZE(special)) {
+			if (!special[i])
+				continue;
+			os_strlcpy(id, special[i], sizeof(id));
+		} else {
+			query_id(id, sizeof(id), i, num);
+		}
+		for (phase2 = 0; phase2 < 2; phase2++) {
+			const u8 *q = (const u8 *) id;
+			size_t len = os_strlen(id);
+
+			if (hostapd_eap_user_find(users, q, len, phase2) !=
+			    hostapd_eap_user_index_lookup(idx, q, len,
+							  phase2)) {
+				printf("Mismatch for '%s' phase2=%d\n",
+				       id, phase2);
+				return -1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+
+static void bench(const char *title, struct hostapd_eap_user *users,
+		  struct hostapd_eap_user_index *idx, unsigned int num,
+		  unsigned int rounds)
+{
+	struct os_reltime start, end, diff;
+	unsigned int i, found = 0;
+	char id[100];
+
+	os_get_reltime(&start);
+	for (i = 0; i < rounds; i++) {
+		const u8 *q = (const u8 *) id;
+		size_t len;
+
+		query_id(id, sizeof(id), i, num);
+		len = os_strlen(id);
+		if (idx)
+			found += !!hostapd_eap_user_index_lookup(idx, q, len,
+								 i & 1);
+		else
+			found += !!hostapd_eap_user_find(users, q, len,
+							 i & 1);
+	}
+	os_get_reltime(&end);
+	os_reltime_sub(&end, &start, &diff);
+	printf("%s: %u lookups (%u found) in %ld.%06ld s\n", title, rounds,
+	       found, (long) diff.sec, (long) diff.usec);
+}
+
+
+int main(int argc, char *argv[])
+{
+	struct hostapd_eap_user *users;
+	struct hostapd_eap_user_index *idx;
+	struct os_reltime start, end, diff;
+	unsigned int rounds = 2000;
+	int ret = 0;
+
+	if (argc > 1)
+		rounds = atoi(argv[1]);
+
+	users = build_users(NUM_USERS);
+	if (!users) {
+		printf("Failed to build user list\n");
+		return -1;
+	}
+
+	os_get_reltime(&start);
+	idx = hostapd_eap_user_index_build(users);
+	os_get_reltime(&end);
+	os_reltime_sub(&end, &start, &diff);
+	if (!idx) {
+		printf("Failed to build index\n");
+		free_users(users);
+		return -1;
+	}
+	printf("Index for %u users built in %ld.%06ld s\n", NUM_USERS,
+	       (long) diff.sec, (long) diff.usec);
+
+	if (check(users, idx, NUM_USERS) < 0)
+		ret = -1;
+	else
+		printf("Index matches the linear search\n");
+
+	bench("linear", users, NULL, NUM_USERS, rounds);
+	bench("index", users, idx, NUM_USERS, rounds);
+
+	hostapd_eap_user_index_free(idx);
+	free_users(users);
+
+	return ret;
+}
@@ -0,0 +1,196 @@
+/*
+ * Benchmark client for hlr_auc_gw
+ * Copyright (c) 2026, Infineon Technologies AG
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ *
+ * Sends AKA-REQ-AUTH (or SIM-REQ-AUTH) requests to a running hlr_auc_gw over
+ * its UNIX domain socket and reports the request rate. The requests cycle
+ * through <num IMSIs> numeric IMSIs starting from <first IMSI> and up to
+ * <window> requests are outstanding at a time. Each outstanding request uses
+ * a different IMSI so that the responses can be matched with the requests.
+ *
+ * usage: test-hlr-auc-gw <socket path> <first IMSI> <num IMSIs>
+ *        [requests] [window] [sim]
+ */
+
+#include "includes.h"
+#include <fcntl.h>
+#include <sys/un.h>
+
+#include "common.h"
+
+#define MAX_WINDOW 256
+
+
+struct pending_req {
+	unsigned long long imsi;
+	struct os_reltime sent;
+	int used;
+};
+
+static unsigned long long first_imsi;
+static unsigned int num_imsi;
+static int sim;
+
+
+static int send_req(int s, const struct sockaddr_un *addr,
+		    unsigned long long imsi)
+{
+	char buf[100];
+	int len;
+
+	len = os_snprintf(buf, sizeof(buf), "%s %llu%s",
+			  sim ? "SIM-REQ-AUTH" : "AKA-REQ-AUTH", imsi,
+			  sim ? " 3" : "");
+	if (sendto(s, buf, len, 0, (const struct sockaddr *) addr,
+		   sizeof(*addr)) < 0) {
+		if (errno == EAGAIN)
+			return 1;
+		perror("sendto");
+		return -1;
+	}
+	return 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+	struct sockaddr_un addr, local;
+	struct pending_req pending[MAX_WINDOW];
+	unsigned int requests = 10000, window = 1, sent = 0, done = 0;
+	unsigned int failures = 0, i, next = 0;
+	struct os_reltime start, end, now, diff;
+	u64 lat_total = 0, lat_max = 0;
+	char buf[1000];
+	int s, ret = -1;
+
+	if (argc < 4) {
+		printf("usage: test-hlr-auc-gw <socket path> <first IMSI> "
+		       "<num IMSIs> [requests] [window] [sim]\n");
+		return -1;
+	}
+	first_imsi = strtoull(argv[2], NULL, 10);
+	num_imsi = atoi(argv[3]);
+	if (argc > 4)
+		requests = atoi(argv[4]);
+	if (argc > 5)
+		window = atoi(argv[5]);
+	if (argc > 6)
+		sim = os_strcmp(argv[6], "sim") == 0;
+	if (num_imsi == 0 || window == 0 || window > MAX_WINDOW ||
+	    window > num_imsi) {
+		printf("Invalid arguments\n");
+		return -1;
+	}
+
+	if (os_program_init())
+		return -1;
+
+	s = socket(PF_UNIX, SOCK_DGRAM, 0);
+	if (s < 0) {
+		perror("socket");
+		goto out;
+	}
+	os_memset(&local, 0, sizeof(local));
+	local.sun_family = AF_UNIX;
+	os_snprintf(local.sun_path, sizeof(local.sun_path),
+		    "/tmp/test-hlr-auc-gw-%d", getpid());
+	unlink(local.sun_path);
+	if (bind(s, (struct sockaddr *) &local, sizeof(local)) < 0) {
+		perror("bind");
+		goto out;
+	}
+	/* The server blocks when sending to a full receive queue, so do not
+	 * block here when its receive queue is full */
+	if (fcntl(s, F_SETFL, O_NONBLOCK) < 0) {
+		perror("fcntl");
+		goto out;
+	}
+	os_memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	os_strlcpy(addr.sun_path, argv[1], sizeof(addr.sun_path));
+
+	os_memset(pending, 0, sizeof(pending));
+	os_get_reltime(&start);
+	while (done < requests) {
+		fd_set rfds;
+		struct timeval tv;
+		char *pos;
+		unsigned long long imsi;
+		ssize_t res;
+
+		while (sent < requests && sent - done < window) {
+			for (i = 0; pending[i].used; i++)
+				;
+			pending[i].imsi = first_imsi + next;
+			os_get_reltime(&pending[i].sent);
+			res = send_req(s, &addr, pending[i].imsi);
+			if (res < 0)
+				goto out;
+			if (res > 0)
+				break; /* server queue full */
+			pending[i].used = 1;
+			next = (next + 1) % num_imsi;
+			sent++;
+		}
+
+		FD_ZERO(&rfds);
+		FD_SET(s, &rfds);
+		tv.tv_sec = 5;
+		tv.tv_usec = 0;
+		if (select(s + 1, &rfds, NULL, NULL, &tv) <= 0) {
+			printf("No response from hlr_auc_gw (%u/%u done)\n",
+			       done, requests);
+			goto out;
+		}
+		res = recv(s, buf, sizeof(buf) - 1, 0);
+		if (res < 0 && errno == EAGAIN)
+			continue;
+		if (res < 0) {
+			perror("recv");
+			goto out;
+		}
+		buf[res] = '\0';
+		os_get_reltime(&now);
+
+		pos = os_strchr(buf, ' ');
+		if (!pos)
+			continue;
+		imsi = strtoull(pos + 1, &pos, 10);
+		for (i = 0; i < window; i++) {
+			if (pending[i].used && pending[i].imsi == imsi)
+				break;
+		}
+		if (i == window) {
+			printf("Unexpected response: %s\n", buf);
+			continue;
+		}
+		pending[i].used = 0;
+		done++;
+		if (os_strstr(pos, "FAILURE"))
+			failures++;
+		os_reltime_sub(&now, &pending[i].sent, &diff);
+		lat_total += diff.sec * 1000000 + diff.usec;
+		if ((u64) (diff.sec * 1000000 + diff.usec) > lat_max)
+			lat_max = diff.sec * 1000000 + diff.usec;
+	}
+	os_get_reltime(&end);
+	os_reltime_sub(&end, &start, &diff);
+
+	printf("%u requests (%u failures) with window %u in %ld.%06ld s: "
+	       "%.0f requests/s, latency avg %llu usec max %llu usec\n",
+	       done, failures, window, (long) diff.sec, (long) diff.usec,
+	       done / (diff.sec + diff.usec / 1000000.0),
+	       (unsigned long long) (lat_total / done),
+	       (unsigned long long) lat_max);
+	ret = failures ? -1 : 0;
+out:
+	if (s >= 0) {
+		close(s);
+		unlink(local.sun_path);
+	}
+	os_program_deinit();
+	return ret;
+}
@@ -0,0 +1,253 @@
+/*
+ * MAC address ACL - test and benchmark program
+ * Copyright (c) 2026, Infineon Technologies AG
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "ap/ap_config.h"
+
+#define NUM_ENTRIES 100000
+
+static u32 prng_state = 0x12345678;
+
+
+static u32 prng(void)
+{
+	/* xorshift32 */
+	prng_state ^= prng_state << 13;
+	prng_state ^= prng_state >> 17;
+	prng_state ^= prng_state << 5;
+	return prng_state;
+}
+
+
+static void make_addr(u8 *addr, unsigned int i)
+{
+	/* Sequential addresses within a few OUIs, like a device inventory */
+	addr[0] = 0x02;
+	addr[1] = 0x00;
+	addr[2] = i % 4;
+	WPA_PUT_BE24(addr + 3, i / 4);
+}
+
+
+/*
+ * Sorted array with binary search, as used for the ACLs before the hash
+ * table. Insertion and removal move the tail of the array.
+ */
+struct sorted_acl {
+	struct mac_acl_entry *entries;
+	int num;
+};
+
+
+static int sorted_find(const struct sorted_acl *acl, const u8 *addr,
+		       int *pos)
+{
+	int start = 0, end = acl->num - 1, middle, res;
+
+	while (start <= end) {
+		middle = (start + end) / 2;
+		res = os_memcmp(acl->entries[middle].addr, addr, ETH_ALEN);
+		if (res == 0) {
+			*pos = middle;
+			return 1;
+		}
+		if (res < 0)
+			start = middle + 1;
+		else
+			end = middle - 1;
+	}
+
+	*pos = start;
+	return 0;
+}
+
+
+static int sorted_add(struct sorted_acl *acl, const u8 *addr, int vlan_id)
+{
+	struct mac_acl_entry *entry;
+	int pos;
+
+	if (sorted_find(acl, addr, &pos))
+		return 1;
+	os_memmove(&acl->entries[pos + 1], &acl->entries[pos],
+		   (acl->num - pos) * sizeof(*entry));
+	entry = &acl->entries[pos];
+	os_memset(entry, 0, sizeof(*entry));
+	os_memcpy(entry->addr, addr, ETH_ALEN);
+	entry->vlan_id.untagged = vlan_id;
+	entry->vlan_id.notempty = !!vlan_id;
+	acl->num++;
+	return 0;
+}
+
+
+static int sorted_del(struct sorted_acl *acl, const u8 *addr)
+{
+	int pos;
+
+	if (!sorted_find(acl, addr, &pos))
+		return -1;
+	acl->num--;
+	os_memmove(&acl->entries[pos], &acl->entries[pos + 1],
+		   (acl->num - pos) * sizeof(acl->entries[0]));
+	return 0;
+}
+
+
+static int check(struct hostapd_mac_acl *acl, struct sorted_acl *ref,
+		 unsigned int num, unsigned int rounds)
+{
+	struct vlan_description vlan_id;
+	u8 addr[ETH_ALEN];
+	unsigned int i, idx;
+	int pos, r1, r2;
+
+	for (i = 0; i < rounds; i++) {
+		idx = prng() % (num * 2);
+		make_addr(addr, idx);
+
+		switch (prng() % 3) {
+		case 0:
+			r1 = hostapd_mac_acl_add(acl, addr, idx % 4095);
+			r2 = sorted_add(ref, addr, idx % 4095);
+			break;
+		case 1:
+			r1 = hostapd_mac_acl_del(acl, addr);
+			r2 = sorted_del(ref, addr);
+			break;
+		default:
+			r1 = hostapd_maclist_found(acl, addr, &vlan_id);
+			r2 = sorted_find(ref, addr, &pos);
+			if (r1 && r2 &&
+			    os_memcmp(&vlan_id, &ref->entries[pos].vlan_id,
+				      sizeof(vlan_id)) != 0)
+				r1 = !r2;
+			break;
+		}
+
+		if (r1 != r2 || acl->num != ref->num) {
+			printf("Mismatch at round %u for " MACSTR "\n",
+			       i, MAC2STR(addr));
+			return -1;
+		}
+	}
+
+	/* Every entry in the dense array must be found from its own slot */
+	for (i = 0; i < (unsigned int) acl->num; i++) {
+		if (hostapd_mac_acl_get(acl, acl->entries[i].addr) !=
+		    &acl->entries[i] ||
+		    !sorted_find(ref, acl->entries[i].addr, &pos)) {
+			printf("Inconsistent entry " MACSTR "\n",
+			       MAC2STR(acl->entries[i].addr));
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+
+static void bench(const char *title, struct hostapd_mac_acl *acl,
+		  struct sorted_acl *ref, unsigned int num, unsigned int rounds)
+{
+	struct os_reltime start, end, diff;
+	unsigned int i, found = 0;
+	u8 addr[ETH_ALEN];
+	int pos;
+
+	prng_state = 0xabcdef;
+	os_get_reltime(&start);
+	for (i = 0; i < rounds; i++) {
+		make_addr(addr, prng() % (num * 2));
+		/* 10% additions, 10% removals, 80% lookups */
+		switch (i % 10) {
+		case 0:
+			if (acl)
+				hostapd_mac_acl_add(acl, addr, 0);
+			else
+				sorted_add(ref, addr, 0);
+			break;
+		case 5:
+			if (acl)
+				hostapd_mac_acl_del(acl, addr);
+			else
+				sorted_del(ref, addr);
+			break;
+		default:
+			if (acl)
+				found += hostapd_maclist_found(acl, addr, NULL);
+			else
+				found += sorted_find(ref, addr, &pos);
+			break;
+		}
+	}
+	os_get_reltime(&end);
+	os_reltime_sub(&end, &start, &diff);
+	printf("%s: %u operations (%u found) in %ld.%06ld s\n", title, rounds,
+	       found, (long) diff.sec, (long) diff.usec);
+}
+
+
+int main(int argc, char *argv[])
+{
+	struct hostapd_mac_acl acl;
+	struct sorted_acl ref;
+	struct os_reltime start, end, diff;
+	unsigned int rounds = 100000, i;
+	u8 addr[ETH_ALEN];
+	int ret = 0;
+
+	if (argc > 1)
+		rounds = atoi(argv[1]);
+
+	os_memset(&acl, 0, sizeof(acl));
+	ref.num = 0;
+	ref.entries = os_calloc(NUM_ENTRIES * 2, sizeof(ref.entries[0]));
+	if (!ref.entries)
+		return -1;
+
+	if (check(&acl, &ref, 1000, 100000) < 0) {
+		ret = -1;
+		goto out;
+	}
+	printf("Hash table matches the sorted array\n");
+
+	hostapd_mac_acl_clear(&acl);
+	ref.num = 0;
+
+	os_get_reltime(&start);
+	for (i = 0; i < NUM_ENTRIES; i++) {
+		make_addr(addr, i * 2);
+		if (hostapd_mac_acl_add(&acl, addr, 0) < 0) {
+			ret = -1;
+			goto out;
+		}
+	}
+	os_get_reltime(&end);
+	os_reltime_sub(&end, &start, &diff);
+	printf("%u entries added in %ld.%06ld s\n", NUM_ENTRIES,
+	       (long) diff.sec, (long) diff.usec);
+	for (i = 0; i < NUM_ENTRIES; i++) {
+		make_addr(addr, i * 2);
+		sorted_add(&ref, addr, 0);
+	}
+
+	bench("sorted array", NULL, &ref, NUM_ENTRIES, rounds);
+	bench("hash table", &acl, NULL, NUM_ENTRIES, rounds);
+	if (acl.num != ref.num) {
+		printf("Entry count mismatch after churn\n");
+		ret = -1;
+	}
+
+out:
+	hostapd_mac_acl_clear(&acl);
+	os_free(ref.entries);
+	return ret;
+}
@@ -0,0 +1,372 @@
+/*
+ * Multi-buffer MD5 - test and benchmark program
+ * Copyright (c) 2026, Infineon Technologies AG
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "crypto/crypto.h"
+#include "crypto/md5.h"
+#include "radius/radius.h"
+
+#define BATCH 8
+
+static const u8 secret[] = "accounting secret";
+
+
+struct md5_test {
+	const char *key;
+	const char *data;
+	const char *hash;
+};
+
+/* RFC 1321, A.5 */
+static const struct md5_test md5_tests[] = {
+	{ NULL, "", "d41d8cd98f00b204e9800998ecf8427e" },
+	{ NULL, "a", "0cc175b9c0f1b6a831c399e269772661" },
+	{ NULL, "abc", "900150983cd24fb0d6963f7d28e17f72" },
+	{ NULL, "message digest", "f96b697d7cb7938d525a2f31aaf161d0" },
+	{ NULL, "abcdefghijklmnopqrstuvwxyz",
+	  "c3fcd3d76192e4007dfb496cca67e13b" },
+	{ NULL,
+	  "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789",
+	  "d174ab98d277d9f5a5611c2c9f419d9f" },
+	{ NULL,
+	  "1234567890123456789012345678901234567890"
+	  "1234567890123456789012345678901234567890",
+	  "57edf4a22be3c955ac49da2e2107b67a" },
+};
+
+/* RFC 2202, 2 */
+static const struct md5_test hmac_tests[] = {
+	{ "Jefe", "what do ya want for nothing?",
+	  "750c783e6ab0b503eaa86e310a5db738" },
+	{ "\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b",
+	  "Hi There", "9294727a3638bb1c13f48ef8158bfc9d" },
+	{ "\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa"
+	  "\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa"
+	  "\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa"
+	  "\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa"
+	  "\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa",
+	  "Test Using Larger Than Block-Size Key - Hash Key First",
+	  "6b1ab7fe4bd7bf8f0b62e6ce61b9d0cd" },
+};
+
+
+static int test_kat(void)
+{
+	const size_t num_md5 = ARRAY_SIZE(md5_tests);
+	const size_t num_hmac = ARRAY_SIZE(hmac_tests);
+	struct md5_mb_job jobs[ARRAY_SIZE(md5_tests)];
+	const u8 *addr[ARRAY_SIZE(md5_tests)];
+	size_t len[ARRAY_SIZE(md5_tests)];
+	u8 mac[ARRAY_SIZE(md5_tests)][MD5_MAC_LEN], hash[MD5_MAC_LEN];
+	size_t i;
+	int ret = 0;
+
+	os_memset(jobs, 0, sizeof(jobs));
+	for (i = 0; i < num_md5; i++) {
+		addr[i] = (const u8 *) md5_tests[i].data;
+		len[i] = os_strlen(md5_tests[i].data);
+		jobs[i].num_elem = 1;
+		jobs[i].addr = &addr[i];
+		jobs[i].len = &len[i];
+		jobs[i].mac = mac[i];
+	}
+	if (md5_vector_mb(jobs, num_md5) < 0)
+		return -1;
+	for (i = 0; i < num_md5; i++) {
+		if (hexstr2bin(md5_tests[i].hash, hash, MD5_MAC_LEN) ||
+		    os_memcmp(hash, mac[i], MD5_MAC_LEN) != 0) {
+			printf("MD5 test vector %u failed\n", (unsigned int) i);
+			ret = -1;
+		}
+	}
+
+	os_memset(jobs, 0, sizeof(jobs));
+	for (i = 0; i < num_hmac; i++) {
+		jobs[i].key = (const u8 *) hmac_tests[i].key;
+		jobs[i].key_len = os_strlen(hmac_tests[i].key);
+		addr[i] = (const u8 *) hmac_tests[i].data;
+		len[i] = os_strlen(hmac_tests[i].data);
+		jobs[i].num_elem = 1;
+		jobs[i].addr = &addr[i];
+		jobs[i].len = &len[i];
+		jobs[i].mac = mac[i];
+	}
+	if (hmac_md5_vector_mb(jobs, num_hmac) < 0)
+		return -1;
+	for (i = 0; i < num_hmac; i++) {
+		if (hexstr2bin(hmac_tests[i].hash, hash, MD5_MAC_LEN) ||
+		    os_memcmp(hash, mac[i], MD5_MAC_LEN) != 0) {
+			printf("HMAC-MD5 test vector %u failed\n",
+			       (unsigned int) i);
+			ret = -1;
+		}
+	}
+
+	return ret;
+}
+
+
+/* Compare against md5_vector()/hmac_md5_vector() with lanes of different
+ * lengths around the block and padding boundaries. */
+static int test_lanes(void)
+{
+	u8 data[300], mac[5][MD5_MAC_LEN], ref[MD5_MAC_LEN];
+	struct md5_mb_job jobs[5];
+	const u8 *addr[5][3];
+	size_t len[5][3];
+	size_t i, l;
+
+	for (i = 0; i < sizeof(data); i++)
+		data[i] = i * 13 + 1;
+
+	for (l = 0; l < 200; l++) {
+		os_memset(jobs, 0, sizeof(jobs));
+		for (i = 0; i < 5; i++) {
+			/* split into three elements, one of them empty */
+			addr[i][0] = data;
+			len[i][0] = (l + i * 17) / 3;
+			addr[i][1] = data + len[i][0];
+			len[i][1] = 0;
+			addr[i][2] = data + len[i][0];
+			len[i][2] = l + i * 17 - len[i][0];
+			jobs[i].key = data + 100;
+			jobs[i].key_len = (l * 7 + i) % 80;
+			jobs[i].num_elem = 3;
+			jobs[i].addr = addr[i];
+			jobs[i].len = len[i];
+			jobs[i].mac = mac[i];
+		}
+
+		if (md5_vector_mb(jobs, 5) < 0)
+			return -1;
+		for (i = 0; i < 5; i++) {
+			if (md5_vector(3, addr[i], len[i], ref) < 0 ||
+			    os_memcmp(ref, mac[i], MD5_MAC_LEN) != 0) {
+				printf("MD5 mismatch (len=%u lane=%u)\n",
+				       (unsigned int) l, (unsigned int) i);
+				return -1;
+			}
+		}
+
+		if (hmac_md5_vector_mb(jobs, 5) < 0)
+			return -1;
+		for (i = 0; i < 5; i++) {
+			if (hmac_md5_vector(jobs[i].key, jobs[i].key_len, 3,
+					    addr[i], len[i], ref) < 0 ||
+			    os_memcmp(ref, mac[i], MD5_MAC_LEN) != 0) {
+				printf("HMAC-MD5 mismatch (len=%u lane=%u)\n",
+				       (unsigned int) l, (unsigned int) i);
+				return -1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+
+/* Interim-Update as sent by hostapd accounting */
+static struct radius_msg * build_acct_req(u8 id)
+{
+	struct radius_msg *msg, *parsed;
+	struct wpabuf *buf;
+
+	msg = radius_msg_new(RADIUS_CODE_ACCOUNTING_REQUEST, id);
+	if (!msg ||
+	    !radius_msg_add_attr_int32(msg, RADIUS_ATTR_ACCT_STATUS_TYPE,
+				       RADIUS_ACCT_STATUS_TYPE_INTERIM_UPDATE) ||
+	    !radius_msg_add_attr(msg, RADIUS_ATTR_USER_NAME,
+				 (const u8 *) "user@example.com", 16) ||
+	    !radius_msg_add_attr(msg, RADIUS_ATTR_ACCT_SESSION_ID,
+				 (const u8 *) "0123456789ABCDEF", 16) ||
+	    !radius_msg_add_attr(msg, RADIUS_ATTR_NAS_IDENTIFIER,
+				 (const u8 *) "ap1.example.com", 15) ||
+	    !radius_msg_add_attr(msg, RADIUS_ATTR_CALLED_STATION_ID,
+				 (const u8 *) "02-00-00-00-03-00:test", 22) ||
+	    !radius_msg_add_attr(msg, RADIUS_ATTR_CALLING_STATION_ID,
+				 (const u8 *) "02-00-00-00-00-00", 17) ||
+	    !radius_msg_add_attr_int32(msg, RADIUS_ATTR_ACCT_SESSION_TIME,
+				       3600) ||
+	    !radius_msg_add_attr_int32(msg, RADIUS_ATTR_ACCT_INPUT_OCTETS,
+				       123456) ||
+	    !radius_msg_add_attr_int32(msg, RADIUS_ATTR_ACCT_OUTPUT_OCTETS,
+				       654321) ||
+	    !radius_msg_add_attr_int32(msg, RADIUS_ATTR_ACCT_INPUT_PACKETS,
+				       1000) ||
+	    !radius_msg_add_attr_int32(msg, RADIUS_ATTR_ACCT_OUTPUT_PACKETS,
+				       2000)) {
+		radius_msg_free(msg);
+		return NULL;
+	}
+	radius_msg_finish_acct(msg, secret, sizeof(secret) - 1);
+
+	/* Use a parsed copy like the server does */
+	buf = radius_msg_get_buf(msg);
+	parsed = radius_msg_parse(wpabuf_head(buf), wpabuf_len(buf));
+	radius_msg_free(msg);
+	return parsed;
+}
+
+
+/* Verify a batch of Accounting-Requests and build the responses */
+static int acct_round(struct radius_msg **req, int batch)
+{
+	struct radius_msg *resp[BATCH];
+	const u8 *sec[BATCH], *auth[BATCH];
+	size_t sec_len[BATCH];
+	int bad[BATCH], ret = 0;
+	size_t i;
+
+	for (i = 0; i < BATCH; i++) {
+		sec[i] = secret;
+		sec_len[i] = sizeof(secret) - 1;
+		auth[i] = radius_msg_get_hdr(req[i])->authenticator;
+		bad[i] = 1;
+		resp[i] = radius_msg_new(RADIUS_CODE_ACCOUNTING_RESPONSE,
+					 radius_msg_get_hdr(req[i])->identifier);
+		if (!resp[i])
+			ret = -1;
+	}
+	if (ret)
+		goto out;
+
+	if (batch) {
+		if (radius_msg_verify_acct_req_batch(req, sec, sec_len, BATCH,
+						     bad) < 0 ||
+		    radius_msg_finish_acct_resp_batch(resp, sec, sec_len, auth,
+						      BATCH) < 0)
+			ret = -1;
+	} else {
+		for (i = 0; i < BATCH; i++) {
+			bad[i] = radius_msg_verify_acct_req(req[i], sec[i],
+							    sec_len[i]);
+			radius_msg_finish_acct_resp(resp[i], sec[i],
+						    sec_len[i], auth[i]);
+		}
+	}
+
+	for (i = 0; i < BATCH; i++) {
+		if (bad[i])
+			ret = -1;
+	}
+
+out:
+	for (i = 0; i < BATCH; i++)
+		radius_msg_free(resp[i]);
+	return ret;
+}
+
+
+static int test_acct(struct radius_msg **req)
+{
+	struct radius_msg *resp[2];
+	const u8 *sec[1], *auth[1];
+	size_t sec_len[1];
+	int bad[1];
+	int ret = 0;
+
+	/* Batch and single message processing give the same result */
+	sec[0] = secret;
+	sec_len[0] = sizeof(secret) - 1;
+	auth[0] = radius_msg_get_hdr(req[0])->authenticator;
+	resp[0] = radius_msg_new(RADIUS_CODE_ACCOUNTING_RESPONSE, 1);
+	resp[1] = radius_msg_new(RADIUS_CODE_ACCOUNTING_RESPONSE, 1);
+	if (!resp[0] || !resp[1])
+		ret = -1;
+	if (!ret) {
+		radius_msg_finish_acct_resp(resp[0], sec[0], sec_len[0],
+					    auth[0]);
+		if (radius_msg_finish_acct_resp_batch(&resp[1], sec, sec_len,
+						      auth, 1) < 0 ||
+		    wpabuf_len(radius_msg_get_buf(resp[0])) !=
+		    wpabuf_len(radius_msg_get_buf(resp[1])) ||
+		    os_memcmp(wpabuf_head(radius_msg_get_buf(resp[0])),
+			      wpabuf_head(radius_msg_get_buf(resp[1])),
+			      wpabuf_len(radius_msg_get_buf(resp[0]))) != 0) {
+			printf("Accounting-Response mismatch\n");
+			ret = -1;
+		}
+	}
+	radius_msg_free(resp[0]);
+	radius_msg_free(resp[1]);
+
+	/* Wrong shared secret is detected */
+	sec_len[0] = sizeof(secret) - 2;
+	if (radius_msg_verify_acct_req_batch(req, sec, sec_len, 1, bad) < 0 ||
+	    !bad[0]) {
+		printf("Invalid Request Authenticator accepted\n");
+		ret = -1;
+	}
+
+	if (acct_round(req, 1) < 0) {
+		printf("Batch verification failed\n");
+		ret = -1;
+	}
+
+	return ret;
+}
+
+
+static int run_bench(const char *title, struct radius_msg **req,
+		     unsigned int rounds, int batch)
+{
+	struct os_reltime start, end, diff;
+	unsigned int i;
+
+	os_get_reltime(&start);
+	for (i = 0; i < rounds; i++) {
+		if (acct_round(req, batch) < 0) {
+			printf("%s: round %u failed\n", title, i);
+			return -1;
+		}
+	}
+	os_get_reltime(&end);
+	os_reltime_sub(&end, &start, &diff);
+	printf("%s: %u Accounting-Requests in %ld.%06ld s\n", title,
+	       rounds * BATCH, (long) diff.sec, (long) diff.usec);
+
+	return 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+	struct radius_msg *req[BATCH];
+	unsigned int rounds = 50000;
+	int ret = 0;
+	size_t i;
+
+	if (argc > 1)
+		rounds = atoi(argv[1]);
+
+	if (test_kat() < 0 || test_lanes() < 0)
+		ret = -1;
+
+	for (i = 0; i < BATCH; i++) {
+		req[i] = build_acct_req(i);
+		if (!req[i]) {
+			printf("Failed to build RADIUS message\n");
+			ret = -1;
+		}
+	}
+
+	if (!ret && test_acct(req) < 0)
+		ret = -1;
+
+	if (!ret &&
+	    (run_bench("md5_vector", req, rounds, 0) < 0 ||
+	     run_bench("md5_vector_mb", req, rounds, 1) < 0))
+		ret = -1;
+
+	for (i = 0; i < BATCH; i++)
+		radius_msg_free(req[i]);
+
+	return ret;
+}
@@ -0,0 +1,520 @@
+/*
+ * P2P peer table - test and benchmark program
+ * Copyright (c) 2026, Infineon Technologies AG
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "utils/eloop.h"
+#include "common/ieee802_11_defs.h"
+#include "wps/wps_defs.h"
+#include "p2p/p2p_i.h"
+
+#define CORPUS_DIR "fuzzing/p2p/corpus/"
+#define MAX_FRAME 2000
+
+/* Discovery frames from the P2P fuzzer corpus */
+struct test_frame {
+	const char *name;
+	u8 data[MAX_FRAME];
+	size_t len;
+	size_t ie_offset; /* start of the IEs */
+	size_t addr_pos; /* offset of the P2P Device Address in the IEs */
+};
+
+static struct test_frame frames[] = {
+	{ CORPUS_DIR "proberesp.dat" },
+	{ CORPUS_DIR "proberesp-go.dat" },
+	{ CORPUS_DIR "go-neg-req.dat" },
+};
+
+#define FRAME_PROBE_RESP 0
+#define FRAME_PROBE_RESP_GO 1
+#define FRAME_GO_NEG_REQ 2
+
+static u32 prng_state = 0x12345678;
+
+
+static u32 prng(void)
+{
+	/* xorshift32 */
+	prng_state ^= prng_state << 13;
+	prng_state ^= prng_state >> 17;
+	prng_state ^= prng_state << 5;
+	return prng_state;
+}
+
+
+static void debug_print(void *ctx, int level, const char *msg)
+{
+}
+
+
+static void find_stopped(void *ctx)
+{
+}
+
+
+static int start_listen(void *ctx, unsigned int freq,
+			unsigned int duration,
+			const struct wpabuf *probe_resp_ie)
+{
+	return 0;
+}
+
+
+static void stop_listen(void *ctx)
+{
+}
+
+
+static void dev_found(void *ctx, const u8 *addr,
+		      const struct p2p_peer_info *info,
+		      int new_device)
+{
+}
+
+
+static unsigned int lost;
+
+static void dev_lost(void *ctx, const u8 *dev_addr)
+{
+	lost++;
+}
+
+
+static int send_action(void *ctx, unsigned int freq, const u8 *dst,
+		       const u8 *src, const u8 *bssid, const u8 *buf,
+		       size_t len, unsigned int wait_time, int *scheduled)
+{
+	*scheduled = 0;
+	return 0;
+}
+
+
+static void send_action_done(void *ctx)
+{
+}
+
+
+static void go_neg_req_rx(void *ctx, const u8 *src, u16 dev_passwd_id,
+			  u8 go_intent)
+{
+}
+
+
+static struct p2p_data * init_p2p(unsigned int max_peers, int debug)
+{
+	struct p2p_config p2p;
+
+	os_memset(&p2p, 0, sizeof(p2p));
+	p2p.max_peers = max_peers;
+	p2p.passphrase_len = 8;
+	p2p.channels.reg_classes = 1;
+	p2p.channels.reg_class[0].reg_class = 81;
+	p2p.channels.reg_class[0].channel[0] = 1;
+	p2p.channels.reg_class[0].channel[1] = 2;
+	p2p.channels.reg_class[0].channels = 2;
+	/* The debug prints would dominate the benchmark */
+	if (debug)
+		p2p.debug_print = debug_print;
+	p2p.find_stopped = find_stopped;
+	p2p.start_listen = start_listen;
+	p2p.stop_listen = stop_listen;
+	p2p.dev_found = dev_found;
+	p2p.dev_lost = dev_lost;
+	p2p.send_action = send_action;
+	p2p.send_action_done = send_action_done;
+	p2p.go_neg_req_rx = go_neg_req_rx;
+
+	return p2p_init(&p2p);
+}
+
+
+static int read_frame(struct test_frame *frame)
+{
+	struct p2p_message msg;
+	const u8 *ies;
+	size_t ies_len, i;
+	char *data;
+	size_t len;
+	int ret = -1;
+
+	data = os_readfile(frame->name, &len);
+	if (!data || len > MAX_FRAME) {
+		printf("Could not read %s\n", frame->name);
+		os_free(data);
+		return -1;
+	}
+	os_memcpy(frame->data, data, len);
+	frame->len = len;
+	os_free(data);
+
+	if (frame == &frames[FRAME_GO_NEG_REQ])
+		frame->ie_offset = IEEE80211_HDRLEN + 8;
+	ies = frame->data + frame->ie_offset;
+	ies_len = frame->len - frame->ie_offset;
+
+	/* Find the P2P Device Address so that it can be replaced */
+	if (p2p_parse_ies(ies, ies_len, &msg) < 0)
+		return -1;
+	if (msg.p2p_device_addr) {
+		for (i = 0; i + ETH_ALEN <= ies_len; i++) {
+			if (os_memcmp(ies + i, msg.p2p_device_addr,
+				      ETH_ALEN) == 0) {
+				frame->addr_pos = i;
+				ret = 0;
+				break;
+			}
+		}
+	}
+	p2p_parse_free(&msg);
+
+	if (ret < 0)
+		printf("No P2P Device Address in %s\n", frame->name);
+	return ret;
+}
+
+
+static void peer_addr(u8 *addr, unsigned int i)
+{
+	addr[0] = 0x02;
+	addr[1] = 0x00;
+	WPA_PUT_BE32(&addr[2], i);
+}
+
+
+static void go_iface_addr(u8 *addr, unsigned int i)
+{
+	peer_addr(addr, i);
+	addr[0] = 0x06;
+}
+
+
+/* Peers with an odd index are GOs that use their own interface address */
+static void rx_probe_resp(struct p2p_data *p2p, unsigned int i,
+			  struct os_reltime *rx_time)
+{
+	struct test_frame *frame = &frames[i & 1];
+	u8 bssid[ETH_ALEN];
+	u8 *ies = frame->data + frame->ie_offset;
+
+	peer_addr(ies + frame->addr_pos, i);
+	if (i & 1)
+		go_iface_addr(bssid, i);
+	else
+		peer_addr(bssid, i);
+	p2p_scan_res_handler(p2p, bssid, 2412, rx_time, -50, ies,
+			     frame->len - frame->ie_offset);
+}
+
+
+/* Probe Response from GO i with a P2P Group Info attribute listing client */
+static void rx_probe_resp_client(struct p2p_data *p2p, unsigned int i,
+				 unsigned int client,
+				 struct os_reltime *rx_time)
+{
+	struct test_frame *frame = &frames[FRAME_PROBE_RESP_GO];
+	u8 ies[MAX_FRAME + 50], *pos, bssid[ETH_ALEN];
+	size_t ies_len = frame->len - frame->ie_offset;
+
+	os_memcpy(ies, frame->data + frame->ie_offset, ies_len);
+	peer_addr(ies + frame->addr_pos, i);
+	pos = ies + ies_len;
+	*pos++ = WLAN_EID_VENDOR_SPECIFIC;
+	*pos++ = 4 + 3 + 30;
+	WPA_PUT_BE32(pos, P2P_IE_VENDOR_TYPE);
+	pos += 4;
+	*pos++ = P2P_ATTR_GROUP_INFO;
+	WPA_PUT_LE16(pos, 30);
+	pos += 2;
+	/* P2P Client Info Descriptor */
+	*pos++ = 29;
+	peer_addr(pos, client);
+	pos += ETH_ALEN;
+	peer_addr(pos, client);
+	pos += ETH_ALEN;
+	*pos++ = 0; /* Device Capability Bitmap */
+	WPA_PUT_BE16(pos, 0); /* Config Methods */
+	pos += 2;
+	os_memset(pos, 0, 8); /* Primary Device Type */
+	pos += 8;
+	*pos++ = 0; /* Number of Secondary Device Types */
+	WPA_PUT_BE16(pos, ATTR_DEV_NAME);
+	pos += 2;
+	WPA_PUT_BE16(pos, 1);
+	pos += 2;
+	*pos++ = 'C';
+
+	go_iface_addr(bssid, i);
+	p2p_scan_res_handler(p2p, bssid, 2412, rx_time, -50, ies, pos - ies);
+}
+
+
+static void rx_probe_req(struct p2p_data *p2p, unsigned int i)
+{
+	struct test_frame *frame = &frames[FRAME_PROBE_RESP];
+	u8 addr[ETH_ALEN];
+	u8 *ies = frame->data + frame->ie_offset;
+
+	peer_addr(addr, i);
+	peer_addr(ies + frame->addr_pos, i);
+	p2p_probe_req_rx(p2p, addr, broadcast_ether_addr, broadcast_ether_addr,
+			 ies, frame->len - frame->ie_offset, 2412, 0);
+}
+
+
+static void rx_go_neg_req(struct p2p_data *p2p, unsigned int i)
+{
+	struct test_frame *frame = &frames[FRAME_GO_NEG_REQ];
+	struct ieee80211_mgmt *mgmt = (struct ieee80211_mgmt *) frame->data;
+
+	peer_addr(mgmt->sa, i);
+	peer_addr(frame->data + frame->ie_offset + frame->addr_pos, i);
+	p2p_rx_action(p2p, mgmt->da, mgmt->sa, mgmt->bssid,
+		      mgmt->u.action.category,
+		      frame->data + IEEE80211_HDRLEN + 1,
+		      frame->len - IEEE80211_HDRLEN - 1, 2412);
+}
+
+
+static unsigned int count_peers(struct p2p_data *p2p)
+{
+	const struct p2p_peer_info *info;
+	unsigned int count = 0;
+
+	for (info = p2p_get_peer_info(p2p, NULL, 0); info;
+	     info = p2p_get_peer_info(p2p, info->p2p_device_addr, 1))
+		count++;
+
+	return count;
+}
+
+
+static int check_peers(struct p2p_data *p2p, unsigned int num,
+		       unsigned int skip_mod)
+{
+	u8 addr[ETH_ALEN], dev_addr[ETH_ALEN];
+	unsigned int i;
+	int known;
+
+	for (i = 0; i < num; i++) {
+		peer_addr(addr, i);
+		known = p2p_peer_known(p2p, addr);
+		if (known != !(skip_mod && i % skip_mod == 0)) {
+			printf("Peer %u: known=%d\n", i, known);
+			return -1;
+		}
+		if (!known || !(i & 1))
+			continue;
+		go_iface_addr(addr, i);
+		if (p2p_get_dev_addr(p2p, addr, dev_addr) < 0 ||
+		    WPA_GET_BE32(&dev_addr[2]) != i) {
+			printf("Peer %u not found by interface address\n", i);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+
+static int test_peers(unsigned int num)
+{
+	struct p2p_data *p2p;
+	struct os_reltime now, old;
+	u8 addr[ETH_ALEN];
+	unsigned int i;
+	int ret = -1;
+
+	p2p = init_p2p(num, 1);
+	if (!p2p)
+		return -1;
+
+	os_get_reltime(&now);
+	old = now;
+	old.sec -= 120;
+	for (i = 0; i < num; i++)
+		rx_probe_resp(p2p, i, i % 4 == 0 ? &old : &now);
+	if (count_peers(p2p) != num || check_peers(p2p, num, 0) < 0)
+		goto out;
+
+	/* Every fourth peer is older than the expiration age */
+	lost = 0;
+	p2p_expire_peers(p2p);
+	if (count_peers(p2p) != num - (num + 3) / 4 ||
+	    lost != (num + 3) / 4 || check_peers(p2p, num, 4) < 0) {
+		printf("Expiration failed (%u peers lost)\n", lost);
+		goto out;
+	}
+
+	/* Fill the table and make the next new peer replace the oldest one */
+	for (i = 0; i < num; i += 4) {
+		old.sec++;
+		rx_probe_resp(p2p, i, i == 8 ? &now : &old);
+	}
+	rx_probe_resp(p2p, num, &now);
+	peer_addr(addr, 0);
+	if (count_peers(p2p) != num || p2p_peer_known(p2p, addr)) {
+		printf("Oldest peer was not replaced\n");
+		goto out;
+	}
+	peer_addr(addr, 4);
+	if (!p2p_peer_known(p2p, addr)) {
+		printf("Wrong peer replaced\n");
+		goto out;
+	}
+
+	p2p_flush(p2p);
+	if (count_peers(p2p) != 0 || p2p_peer_known(p2p, addr))
+		goto out;
+	ret = 0;
+out:
+	p2p_deinit(p2p);
+	return ret;
+}
+
+
+/*
+ * A delayed scan result from a GO can move the last_seen value of a known
+ * client backwards. The peer has to expire based on the older value.
+ */
+static int test_delayed_scan_res(void)
+{
+	struct p2p_data *p2p;
+	struct os_reltime now, old, recent;
+	u8 addr[ETH_ALEN];
+	int ret = -1;
+
+	p2p = init_p2p(10, 1);
+	if (!p2p)
+		return -1;
+
+	os_get_reltime(&now);
+	old = recent = now;
+	old.sec -= 120;
+	recent.sec -= 30;
+	rx_probe_resp(p2p, 0, &now);
+	rx_probe_resp(p2p, 2, &recent);
+	/* Position the peers in the heap based on their last_seen values */
+	lost = 0;
+	p2p_expire_peers(p2p);
+	if (lost) {
+		printf("Peer expired too early\n");
+		goto out;
+	}
+	rx_probe_resp_client(p2p, 3, 0, &old);
+	peer_addr(addr, 0);
+	if (count_peers(p2p) != 3 || !p2p_peer_known(p2p, addr)) {
+		printf("Group client not added\n");
+		goto out;
+	}
+
+	p2p_expire_peers(p2p);
+	peer_addr(addr, 2);
+	if (lost != 2 || count_peers(p2p) != 1 ||
+	    !p2p_peer_known(p2p, addr)) {
+		printf("Peer with older last_seen not expired (%u peers lost)\n",
+		       lost);
+		goto out;
+	}
+	ret = 0;
+out:
+	p2p_deinit(p2p);
+	return ret;
+}
+
+
+static void bench(unsigned int num, unsigned int rounds)
+{
+	struct p2p_data *p2p;
+	struct os_reltime start, end, diff, now;
+	u8 addr[ETH_ALEN], dev_addr[ETH_ALEN];
+	unsigned int i, peer, found = 0;
+
+	p2p = init_p2p(num + 1, 0);
+	if (!p2p)
+		return;
+
+	os_get_reltime(&now);
+	for (i = 0; i < num; i++)
+		rx_probe_resp(p2p, i, &now);
+
+	os_get_reltime(&start);
+	for (i = 0; i < rounds; i++) {
+		peer = prng() % num;
+		switch (i % 8) {
+		case 0:
+		case 1:
+			rx_probe_req(p2p, peer);
+			break;
+		case 2:
+			rx_go_neg_req(p2p, peer);
+			break;
+		case 3:
+			go_iface_addr(addr, peer | 1);
+			if (p2p_get_dev_addr(p2p, addr, dev_addr) == 0)
+				found++;
+			break;
+		default:
+			rx_probe_resp(p2p, peer, &now);
+			break;
+		}
+	}
+	os_get_reltime(&end);
+	os_reltime_sub(&end, &start, &diff);
+	printf("%u peers: %u frames/lookups in %ld.%06ld s (%u peers, %u found by interface address)\n",
+	       num, rounds, (long) diff.sec, (long) diff.usec,
+	       count_peers(p2p), found);
+
+	/* Periodic expiration when no peer has expired */
+	os_get_reltime(&start);
+	for (i = 0; i < rounds / 100; i++)
+		p2p_expire_peers(p2p);
+	os_get_reltime(&end);
+	os_reltime_sub(&end, &start, &diff);
+	printf("%u peers: %u expiration checks in %ld.%06ld s\n",
+	       num, rounds / 100, (long) diff.sec, (long) diff.usec);
+
+	p2p_deinit(p2p);
+}
+
+
+int main(int argc, char *argv[])
+{
+	unsigned int rounds = 100000, i;
+	int ret = -1;
+
+	if (argc > 1)
+		rounds = atoi(argv[1]);
+
+	if (os_program_init())
+		return -1;
+	if (eloop_init())
+		goto out;
+
+	for (i = 0; i < ARRAY_SIZE(frames); i++) {
+		if (read_frame(&frames[i]) < 0)
+			goto out;
+	}
+
+	if (test_peers(100) < 0 || test_peers(1000) < 0 ||
+	    test_delayed_scan_res() < 0) {
+		printf("Peer table test failed\n");
+		goto out;
+	}
+	printf("Peer table tests passed\n");
+
+	bench(50, rounds);
+	bench(500, rounds);
+	bench(2000, rounds);
+	ret = 0;
+out:
+	eloop_destroy();
+	os_program_deinit();
+	return ret;
+}
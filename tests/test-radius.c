@@ -0,0 +1,234 @@
+/*
+ * RADIUS message parsing - test and benchmark program
+ * Copyright (c) 2026, Infineon Technologies AG
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "radius/radius.h"
+
+#define EAP_LEN 1400
+
+static const u8 secret[] = "radius";
+static u8 eap_data[EAP_LEN];
+
+
+/* Build an Access-Request similar to what an authenticator sends in the
+ * middle of an EAP-TLS exchange. */
+static struct wpabuf * build_request(void)
+{
+	struct radius_msg *msg;
+	struct wpabuf *buf;
+	u8 state[16];
+	size_t i;
+
+	for (i = 0; i < sizeof(eap_data); i++)
+		eap_data[i] = i * 7;
+	os_memset(state, 0x55, sizeof(state));
+
+	msg = radius_msg_new(RADIUS_CODE_ACCESS_REQUEST, 17);
+	if (!msg ||
+	    !radius_msg_add_attr(msg, RADIUS_ATTR_USER_NAME,
+				 (const u8 *) "user@example.com", 16) ||
+	    !radius_msg_add_attr(msg, RADIUS_ATTR_NAS_IDENTIFIER,
+				 (const u8 *) "ap1.example.com", 15) ||
+	    !radius_msg_add_attr_int32(msg, RADIUS_ATTR_NAS_PORT_TYPE, 19) ||
+	    !radius_msg_add_attr_int32(msg, RADIUS_ATTR_FRAMED_MTU, 1400) ||
+	    !radius_msg_add_attr(msg, RADIUS_ATTR_CALLED_STATION_ID,
+				 (const u8 *) "02-00-00-00-03-00:test", 22) ||
+	    !radius_msg_add_attr(msg, RADIUS_ATTR_CALLING_STATION_ID,
+				 (const u8 *) "02-00-00-00-00-00", 17) ||
+	    !radius_msg_add_attr(msg, RADIUS_ATTR_CONNECT_INFO,
+				 (const u8 *) "CONNECT 54Mbps 802.11g", 22) ||
+	    !radius_msg_add_eap(msg, eap_data, sizeof(eap_data)) ||
+	    !radius_msg_add_attr(msg, RADIUS_ATTR_STATE, state,
+				 sizeof(state)) ||
+	    radius_msg_finish(msg, secret, sizeof(secret) - 1) < 0) {
+		radius_msg_free(msg);
+		return NULL;
+	}
+
+	buf = wpabuf_dup(radius_msg_get_buf(msg));
+	radius_msg_free(msg);
+	return buf;
+}
+
+
+/* Lookups done by the RADIUS server for each received Access-Request */
+static int process(struct radius_msg *msg)
+{
+	struct wpabuf *eap;
+	u8 user[64], *state;
+	size_t state_len;
+	u32 mtu;
+	int ret = 0;
+
+	if (radius_msg_verify_msg_auth(msg, secret, sizeof(secret) - 1, NULL) ||
+	    radius_msg_get_attr(msg, RADIUS_ATTR_USER_NAME, user,
+				sizeof(user)) != 16 ||
+	    radius_msg_get_attr_ptr(msg, RADIUS_ATTR_STATE, &state, &state_len,
+				    NULL) ||
+	    state_len != 16 ||
+	    radius_msg_get_attr_int32(msg, RADIUS_ATTR_FRAMED_MTU, &mtu) ||
+	    mtu != 1400 ||
+	    radius_msg_count_attr(msg, RADIUS_ATTR_EAP_MESSAGE, 1) !=
+	    (EAP_LEN + RADIUS_MAX_ATTR_LEN - 1) / RADIUS_MAX_ATTR_LEN)
+		return -1;
+
+	eap = radius_msg_get_eap(msg);
+	if (!eap || wpabuf_len(eap) != EAP_LEN ||
+	    os_memcmp(wpabuf_head(eap), eap_data, EAP_LEN) != 0)
+		ret = -1;
+	wpabuf_free(eap);
+
+	return ret;
+}
+
+
+static int check_parse(const struct wpabuf *req)
+{
+	struct radius_msg *msg;
+	struct wpabuf *buf;
+	u8 *pos;
+	size_t len;
+	int ret = 0;
+
+	/* Trailing data after the message is ignored */
+	buf = wpabuf_alloc(wpabuf_len(req) + 10);
+	if (!buf)
+		return -1;
+	wpabuf_put_buf(buf, req);
+	os_memset(wpabuf_put(buf, 10), 0xaa, 10);
+	msg = radius_msg_parse_buf(buf);
+	if (!msg || process(msg) < 0 ||
+	    wpabuf_len(radius_msg_get_buf(msg)) != wpabuf_len(req)) {
+		printf("In-place parse failed\n");
+		ret = -1;
+	}
+
+	/* Attributes of the same type are returned in message order */
+	if (msg) {
+		u8 *prev = NULL;
+		size_t total = 0;
+
+		while (radius_msg_get_attr_ptr(msg, RADIUS_ATTR_EAP_MESSAGE,
+					       &pos, &len, prev) == 0) {
+			if (prev && pos <= prev)
+				break;
+			if (os_memcmp(pos, eap_data + total, len) != 0)
+				break;
+			total += len;
+			prev = pos;
+		}
+		if (total != EAP_LEN) {
+			printf("EAP-Message attribute order not preserved\n");
+			ret = -1;
+		}
+	}
+
+	/* Attributes added after parsing are indexed as well */
+	if (msg &&
+	    (!radius_msg_add_attr(msg, RADIUS_ATTR_EAP_MESSAGE,
+				  (const u8 *) "x", 1) ||
+	     radius_msg_count_attr(msg, RADIUS_ATTR_EAP_MESSAGE, 0) !=
+	     (EAP_LEN + RADIUS_MAX_ATTR_LEN - 1) / RADIUS_MAX_ATTR_LEN + 1 ||
+	     radius_msg_get_attr(msg, RADIUS_ATTR_NAS_IDENTIFIER, NULL, 0) !=
+	     15)) {
+		printf("Attribute index not updated\n");
+		ret = -1;
+	}
+	radius_msg_free(msg);
+
+	/* Truncated message */
+	buf = wpabuf_alloc_copy(wpabuf_head(req), wpabuf_len(req) - 1);
+	msg = radius_msg_parse_buf(buf);
+	if (msg) {
+		printf("Truncated message accepted\n");
+		radius_msg_free(msg);
+		ret = -1;
+	}
+
+	/* Duplicate Message-Authenticator */
+	msg = radius_msg_parse(wpabuf_head(req), wpabuf_len(req));
+	if (!msg ||
+	    !radius_msg_add_attr(msg, RADIUS_ATTR_MESSAGE_AUTHENTICATOR,
+				 (const u8 *) "0123456789abcdef", 16) ||
+	    radius_msg_verify_msg_auth(msg, secret, sizeof(secret) - 1,
+				       NULL) == 0) {
+		printf("Duplicate Message-Authenticator accepted\n");
+		ret = -1;
+	}
+	radius_msg_free(msg);
+
+	return ret;
+}
+
+
+static int run_bench(const char *title, const struct wpabuf *req,
+		     unsigned int rounds, int in_place)
+{
+	struct os_reltime start, end, diff;
+	struct radius_msg *msg;
+	struct wpabuf *buf;
+	u8 rx[RADIUS_MAX_MSG_LEN];
+	unsigned int i;
+
+	os_get_reltime(&start);
+	for (i = 0; i < rounds; i++) {
+		/* Simulate the receive into a buffer of the maximum size */
+		if (in_place) {
+			buf = wpabuf_alloc(RADIUS_MAX_MSG_LEN);
+			if (!buf)
+				return -1;
+			wpabuf_put_buf(buf, req);
+			msg = radius_msg_parse_buf(buf);
+		} else {
+			os_memcpy(rx, wpabuf_head(req), wpabuf_len(req));
+			msg = radius_msg_parse(rx, wpabuf_len(req));
+		}
+		if (!msg || process(msg) < 0) {
+			printf("%s: round %u failed\n", title, i);
+			radius_msg_free(msg);
+			return -1;
+		}
+		radius_msg_free(msg);
+	}
+	os_get_reltime(&end);
+	os_reltime_sub(&end, &start, &diff);
+	printf("%s: %u messages in %ld.%06ld s\n", title, rounds,
+	       (long) diff.sec, (long) diff.usec);
+
+	return 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+	unsigned int rounds = 100000;
+	struct wpabuf *req;
+	int ret = 0;
+
+	if (argc > 1)
+		rounds = atoi(argv[1]);
+
+	req = build_request();
+	if (!req) {
+		printf("Failed to build RADIUS message\n");
+		return -1;
+	}
+
+	if (check_parse(req) < 0)
+		ret = -1;
+
+	if (run_bench("copy", req, rounds, 0) < 0 ||
+	    run_bench("in-place", req, rounds, 1) < 0)
+		ret = -1;
+
+	wpabuf_free(req);
+
+	return ret;
+}
@@ -4,14 +4,19 @@
  *
  * This software may be distributed under the terms of the BSD license.
  * See README for more details.
+ *
+ * "test-rsa-sig-ver bench [rounds]" benchmarks RSA-2048 signature verification
+ * and the FFC DH groups with the internal bignum implementation.
  */
 
 #include "utils/includes.h"
 
 #include "utils/common.h"
 #include "crypto/crypto.h"
+#include "crypto/dh_groups.h"
 #include "tls/rsa.h"
 #include "tls/asn1.h"
+#include "tls/bignum.h"
 #include "tls/pkcs1.h"
 
 
@@ -184,6 +189,216 @@ static int cavp_rsa_sig_ver(const char *fname)
 }
 
 
+/* RSA-2048 (e = 65537) PKCS #1 v1.5 signature over bench_msg with SHA-256 */
+static const char *bench_msg = "wpa_supplicant bignum benchmark";
+static const char *bench_n =
+	"bb9f0b00927c2bebdaae61877ae6bb610293c6dd74be03324e8df1a07e4d7aaf"
+	"bb4c97565212ecb3ac7530b34479ae1e6dcb553ba353240a51f0a74466191532"
+	"75f6e67cf993beb7be0e5c4fbebafee7a104a9c7af669c11d07e401ced08c2d7"
+	"23915b48e036eba23bd63951bd0995d2a8b377368eeee0922251876beb241b8f"
+	"5d59482deb656ab6f3a96dcc093aa75db08f6c8e0d9a7c3f33698b81b9d0ea8d"
+	"fc05b395f4d4bd168ca704d3f7534edfd28b850327078fcf1c7bbf3c81d3b3e8"
+	"84dbd47318972f98963528a0366020cf80cde3113bc3599e55831568fdb883cf"
+	"a342526d5ce64ef99f525f4680dc271a5feb0e9f1bc08ac3a33224c8e920d0b1";
+static const char *bench_s =
+	"84e7d7bb703df27a906d873e2f499881d86160a17831875a46ed9e6e3ddda38a"
+	"0cf86f24d316de68cf07cfce35c2169fb8f50ba8e5405686a0726dfc02d83ada"
+	"9e8c33dcd7699965eebdb90dff8c909ef605959f6233355afff16af0a74c067b"
+	"b4ccb4731414b37cc7ed2ed4a729b44d41b92410423af59d356ceb7c0790fee8"
+	"8511f53ca2b2ad3f03f7674bd92fa11c79a9ba91758482f68818b992934978f8"
+	"3e575f68219c199cdda5b886100be3d915a4c0969e523f84d8c3fde7bb3a032e"
+	"9be263f4b2201cbabb73d06b130747bf672bbd05c5dc1ee80304ff0184b29599"
+	"4fdce9d1785a70c67995e5cf3c17fb3744e50d20e563c9dce9fc209719057492";
+
+/* FFC groups as used for SAE, EAP-pwd, IKEv2, and WPS */
+static const int ffc_groups[] = { 5, 14, 15, 22, 23, 24 };
+
+
+static struct crypto_public_key * rsa_bench_key(u8 *s, size_t *s_len,
+						u8 *hash)
+{
+	u8 n[256], e[3] = { 0x01, 0x00, 0x01 };
+	const u8 *addr[1];
+	size_t len[1];
+
+	if (hexstr2bin(bench_n, n, sizeof(n)) < 0 ||
+	    hexstr2bin(bench_s, s, 256) < 0)
+		return NULL;
+	*s_len = 256;
+	addr[0] = (const u8 *) bench_msg;
+	len[0] = os_strlen(bench_msg);
+	if (sha256_vector(1, addr, len, hash) < 0)
+		return NULL;
+	return crypto_public_key_import_parts(n, sizeof(n), e, sizeof(e));
+}
+
+
+static int rsa_test(unsigned int rounds)
+{
+	struct crypto_public_key *pk;
+	struct os_reltime start, end, diff;
+	u8 s[256], hash[32];
+	size_t s_len;
+	unsigned int i;
+	int ret = -1;
+
+	pk = rsa_bench_key(s, &s_len, hash);
+	if (!pk) {
+		printf("Failed to import RSA-2048 public key\n");
+		return -1;
+	}
+
+	if (pkcs1_v15_sig_ver(pk, s, s_len, &asn1_sha256_oid, hash, 32) < 0) {
+		printf("RSA-2048 signature verification failed\n");
+		goto out;
+	}
+	s[100] ^= 0x01;
+	if (pkcs1_v15_sig_ver(pk, s, s_len, &asn1_sha256_oid, hash, 32) == 0) {
+		printf("Modified RSA-2048 signature accepted\n");
+		goto out;
+	}
+	s[100] ^= 0x01;
+
+	if (rounds) {
+		os_get_reltime(&start);
+		for (i = 0; i < rounds; i++)
+			pkcs1_v15_sig_ver(pk, s, s_len, &asn1_sha256_oid,
+					  hash, 32);
+		os_get_reltime(&end);
+		os_reltime_sub(&end, &start, &diff);
+		printf("RSA-2048 signature verification: %u in %ld.%06ld s "
+		       "(%.0f usec each)\n", rounds, (long) diff.sec,
+		       (long) diff.usec,
+		       (diff.sec * 1000000.0 + diff.usec) / rounds);
+	}
+
+	ret = 0;
+out:
+	crypto_public_key_free(pk);
+	return ret;
+}
+
+
+static int ffc_keygen(const struct dh_group *dh, u8 *priv, size_t priv_len,
+		      u8 *pub)
+{
+	size_t pub_len = dh->prime_len;
+
+	if (os_get_random(priv, priv_len) < 0)
+		return -1;
+	priv[0] &= 0x7f; /* smaller than the order */
+	if (crypto_mod_exp(dh->generator, dh->generator_len, priv, priv_len,
+			   dh->prime, dh->prime_len, pub, &pub_len) < 0)
+		return -1;
+	if (pub_len < dh->prime_len) {
+		os_memmove(pub + dh->prime_len - pub_len, pub, pub_len);
+		os_memset(pub, 0, dh->prime_len - pub_len);
+	}
+	return 0;
+}
+
+
+static int ffc_test(const struct dh_group *dh, unsigned int rounds)
+{
+	u8 priv_a[384], priv_b[384], pub_a[384], pub_b[384];
+	u8 ss_a[384], ss_b[384];
+	size_t priv_len, ss_a_len, ss_b_len;
+	struct os_reltime start, mid, end, diff, diff2;
+	unsigned int i;
+
+	/* Both sides of a DH exchange derive the same shared secret. This
+	 * covers exponentiation with the group generator and with an
+	 * arbitrary group element, including the order check like in SAE
+	 * for the groups that have a known order. */
+	priv_len = dh->order ? dh->order_len : dh->prime_len;
+	ss_a_len = ss_b_len = dh->prime_len;
+	if (ffc_keygen(dh, priv_a, priv_len, pub_a) < 0 ||
+	    ffc_keygen(dh, priv_b, priv_len, pub_b) < 0 ||
+	    crypto_dh_derive_secret(0, dh->prime, dh->prime_len,
+				    dh->order, dh->order_len,
+				    priv_a, priv_len, pub_b, dh->prime_len,
+				    ss_a, &ss_a_len) < 0 ||
+	    crypto_dh_derive_secret(0, dh->prime, dh->prime_len,
+				    dh->order, dh->order_len,
+				    priv_b, priv_len, pub_a, dh->prime_len,
+				    ss_b, &ss_b_len) < 0 ||
+	    ss_a_len != ss_b_len || os_memcmp(ss_a, ss_b, ss_a_len) != 0) {
+		printf("DH group %d: shared secret mismatch\n", dh->id);
+		return -1;
+	}
+
+	/* g^(p-1) = 1 and g^1 = g with an exponent as long as the prime */
+	os_memcpy(priv_a, dh->prime, dh->prime_len);
+	priv_a[dh->prime_len - 1] ^= 0x01;
+	ss_a_len = dh->prime_len;
+	if (crypto_mod_exp(dh->generator, dh->generator_len,
+			   priv_a, dh->prime_len, dh->prime, dh->prime_len,
+			   ss_a, &ss_a_len) < 0 ||
+	    ss_a_len != 1 || ss_a[0] != 1) {
+		printf("DH group %d: g^(p-1) != 1\n", dh->id);
+		return -1;
+	}
+	os_memset(priv_a, 0, dh->prime_len);
+	priv_a[dh->prime_len - 1] = 0x01;
+	ss_a_len = dh->prime_len;
+	if (crypto_mod_exp(dh->generator, dh->generator_len,
+			   priv_a, dh->prime_len, dh->prime, dh->prime_len,
+			   ss_a, &ss_a_len) < 0 ||
+	    ss_a_len != dh->generator_len ||
+	    os_memcmp(ss_a, dh->generator, ss_a_len) != 0) {
+		printf("DH group %d: g^1 != g\n", dh->id);
+		return -1;
+	}
+
+	if (!rounds)
+		return 0;
+
+	os_get_reltime(&start);
+	for (i = 0; i < rounds; i++)
+		ffc_keygen(dh, priv_b, priv_len, pub_b);
+	os_get_reltime(&mid);
+	for (i = 0; i < rounds; i++) {
+		ss_b_len = dh->prime_len;
+		crypto_dh_derive_secret(0, dh->prime, dh->prime_len,
+					dh->order, dh->order_len,
+					priv_b, priv_len, pub_a, dh->prime_len,
+					ss_b, &ss_b_len);
+	}
+	os_get_reltime(&end);
+	os_reltime_sub(&mid, &start, &diff);
+	os_reltime_sub(&end, &mid, &diff2);
+	printf("DH group %d (%d bits): %.0f usec per key generation, "
+	       "%.0f usec per shared secret\n",
+	       dh->id, (int) dh->prime_len * 8,
+	       (diff.sec * 1000000.0 + diff.usec) / rounds,
+	       (diff2.sec * 1000000.0 + diff2.usec) / rounds);
+	return 0;
+}
+
+
+static int bignum_tests(unsigned int rounds)
+{
+	const struct dh_group *dh;
+	size_t i;
+	int ret = 0;
+
+	if (rsa_test(rounds * 10) < 0)
+		ret++;
+	for (i = 0; i < ARRAY_SIZE(ffc_groups); i++) {
+		dh = dh_groups_get(ffc_groups[i]);
+		if (!dh) {
+			printf("DH group %d not included in the build\n",
+			       ffc_groups[i]);
+			continue;
+		}
+		if (ffc_test(dh, rounds) < 0)
+			ret++;
+	}
+
+	return ret;
+}
+
+
 int main(int argc, char *argv[])
 {
 	int ret = 0;
@@ -192,6 +407,16 @@ int main(int argc, char *argv[])
 	wpa_debug_level = 0;
 	wpa_debug_show_keys = 1;
 
+	if (argc > 1 && os_strcmp(argv[1], "bench") == 0) {
+		wpa_debug_level = MSG_ERROR;
+		ret = bignum_tests(argc > 2 ? atoi(argv[2]) : 100);
+		bignum_global_deinit();
+		return ret;
+	}
+
+	if (bignum_tests(0))
+		ret++;
+
 	for (i = 1; i < argc; i++) {
 		if (cavp_rsa_sig_ver(argv[i]))
 			ret++;
@@ -202,5 +427,6 @@ int main(int argc, char *argv[])
 	if (argc < 2 && cavp_rsa_sig_ver("CAVP/SigVer15EMTest.txt"))
 		ret++;
 
+	bignum_global_deinit();
 	return ret;
 }
@@ -0,0 +1,291 @@
+/*
+ * SAE commit/confirm test and benchmark
+ * Copyright (c) 2026, Infineon Technologies AG
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ *
+ * Runs SAE exchanges between two local instances with hunting-and-pecking and
+ * hash-to-element for the ECC groups and one FFC group, verifies that both
+ * ends derive the same PMK, and reports the average time of each commit and
+ * confirm operation. In addition, generator multiplications through the
+ * fixed-base path are compared against the same multiplication with a copy of
+ * the generator.
+ *
+ * usage: test-sae [rounds]
+ */
+
+#include "utils/includes.h"
+#include <time.h>
+
+#include "utils/common.h"
+#include "crypto/crypto.h"
+#include "common/ieee802_11_defs.h"
+#include "common/sae.h"
+
+enum sae_op {
+	OP_PREPARE_COMMIT, OP_WRITE_COMMIT, OP_PARSE_COMMIT, OP_PROCESS_COMMIT,
+	OP_WRITE_CONFIRM, OP_CHECK_CONFIRM, NUM_OPS
+};
+
+static const char *op_txt[NUM_OPS] = {
+	"prepare_commit", "write_commit", "parse_commit", "process_commit",
+	"write_confirm", "check_confirm"
+};
+
+static u64 op_ns[NUM_OPS];
+static unsigned int op_count[NUM_OPS];
+
+static const u8 addr_sta[ETH_ALEN] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+static const u8 addr_ap[ETH_ALEN] = { 0x02, 0x00, 0x00, 0x00, 0x01, 0x00 };
+static const char *ssid = "test-sae";
+static const char *password = "12345678";
+
+
+static u64 now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u64) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+
+static u64 op_start;
+
+static void op_begin(void)
+{
+	op_start = now_ns();
+}
+
+
+static int op_end(enum sae_op op, int res)
+{
+	op_ns[op] += now_ns() - op_start;
+	op_count[op]++;
+	return res;
+}
+
+#define TIMED(op, expr) op_end((op), (op_begin(), (expr)))
+
+
+static int prepare_commit(struct sae_data *sae, int group,
+			  const struct sae_pt *pt,
+			  const u8 *own_addr, const u8 *peer_addr)
+{
+	if (sae_set_group(sae, group) < 0)
+		return -1;
+	if (pt)
+		return sae_prepare_commit_pt(sae, pt, own_addr, peer_addr,
+					     NULL, NULL);
+	return sae_prepare_commit(own_addr, peer_addr, (const u8 *) password,
+				  os_strlen(password), sae);
+}
+
+
+static int parse_commit(struct sae_data *sae, struct wpabuf *buf,
+			int *groups)
+{
+	return sae_parse_commit(sae, wpabuf_head(buf), wpabuf_len(buf), NULL,
+				NULL, groups, sae->h2e) == WLAN_STATUS_SUCCESS ?
+		0 : -1;
+}
+
+
+static int sae_exchange(int group, const struct sae_pt *pt)
+{
+	struct sae_data sta, ap;
+	struct wpabuf *sta_buf = NULL, *ap_buf = NULL;
+	int groups[2] = { group, 0 };
+	int ret = -1;
+
+	os_memset(&sta, 0, sizeof(sta));
+	os_memset(&ap, 0, sizeof(ap));
+	sta_buf = wpabuf_alloc(1000);
+	ap_buf = wpabuf_alloc(1000);
+	if (!sta_buf || !ap_buf)
+		goto fail;
+
+	if (TIMED(OP_PREPARE_COMMIT,
+		  prepare_commit(&sta, group, pt, addr_sta, addr_ap)) < 0 ||
+	    TIMED(OP_PREPARE_COMMIT,
+		  prepare_commit(&ap, group, pt, addr_ap, addr_sta)) < 0 ||
+	    TIMED(OP_WRITE_COMMIT,
+		  sae_write_commit(&sta, sta_buf, NULL, NULL)) < 0 ||
+	    TIMED(OP_WRITE_COMMIT,
+		  sae_write_commit(&ap, ap_buf, NULL, NULL)) < 0 ||
+	    TIMED(OP_PARSE_COMMIT, parse_commit(&ap, sta_buf, groups)) < 0 ||
+	    TIMED(OP_PARSE_COMMIT, parse_commit(&sta, ap_buf, groups)) < 0 ||
+	    TIMED(OP_PROCESS_COMMIT, sae_process_commit(&ap)) < 0 ||
+	    TIMED(OP_PROCESS_COMMIT, sae_process_commit(&sta)) < 0) {
+		printf("SAE group %d: commit exchange failed\n", group);
+		goto fail;
+	}
+
+	wpabuf_free(sta_buf);
+	wpabuf_free(ap_buf);
+	sta_buf = wpabuf_alloc(1000);
+	ap_buf = wpabuf_alloc(1000);
+	if (!sta_buf || !ap_buf)
+		goto fail;
+	if (TIMED(OP_WRITE_CONFIRM, sae_write_confirm(&sta, sta_buf)) < 0 ||
+	    TIMED(OP_WRITE_CONFIRM, sae_write_confirm(&ap, ap_buf)) < 0 ||
+	    TIMED(OP_CHECK_CONFIRM,
+		  sae_check_confirm(&ap, wpabuf_head(sta_buf),
+				    wpabuf_len(sta_buf))) < 0 ||
+	    TIMED(OP_CHECK_CONFIRM,
+		  sae_check_confirm(&sta, wpabuf_head(ap_buf),
+				    wpabuf_len(ap_buf))) < 0) {
+		printf("SAE group %d: confirm exchange failed\n", group);
+		goto fail;
+	}
+
+	if (os_memcmp(sta.pmk, ap.pmk, SAE_PMK_LEN) != 0 ||
+	    os_memcmp(sta.pmkid, ap.pmkid, SAE_PMKID_LEN) != 0) {
+		printf("SAE group %d: PMK mismatch\n", group);
+		goto fail;
+	}
+
+	ret = 0;
+fail:
+	wpabuf_free(sta_buf);
+	wpabuf_free(ap_buf);
+	sae_clear_data(&sta);
+	sae_clear_data(&ap);
+	return ret;
+}
+
+
+static int sae_group_test(int group, int h2e, unsigned int rounds)
+{
+	int groups[2] = { group, 0 };
+	struct sae_pt *pt = NULL;
+	unsigned int i;
+	int op, ret = -1;
+
+	if (h2e) {
+		pt = sae_derive_pt(groups, (const u8 *) ssid, os_strlen(ssid),
+				   (const u8 *) password, os_strlen(password),
+				   NULL);
+		if (!pt) {
+			printf("SAE group %d: failed to derive PT\n", group);
+			return -1;
+		}
+	}
+
+	os_memset(op_ns, 0, sizeof(op_ns));
+	os_memset(op_count, 0, sizeof(op_count));
+	for (i = 0; i < rounds; i++) {
+		if (sae_exchange(group, pt) < 0)
+			goto fail;
+	}
+
+	printf("SAE group %d %s:", group, h2e ? "H2E" : "HnP");
+	for (op = 0; op < NUM_OPS; op++)
+		printf(" %s %.1f", op_txt[op],
+		       op_ns[op] / 1000.0 / op_count[op]);
+	printf(" usec\n");
+	ret = 0;
+fail:
+	sae_deinit_pt(pt);
+	return ret;
+}
+
+
+static int ec_generator_test(int group, unsigned int rounds)
+{
+	struct crypto_ec *ec;
+	struct crypto_ec_point *gen_copy = NULL, *res1 = NULL, *res2 = NULL;
+	struct crypto_bignum *scalar = NULL;
+	const struct crypto_ec_point *gen;
+	u8 bin[2 * 66];
+	unsigned int i;
+	u64 start, fixed_ns = 0, var_ns = 0, init_ns;
+	int ret = -1;
+
+	start = now_ns();
+	for (i = 0; i < rounds; i++)
+		crypto_ec_deinit(crypto_ec_init(group));
+	init_ns = now_ns() - start;
+
+	ec = crypto_ec_init(group);
+	if (!ec)
+		return -1;
+	gen = crypto_ec_get_generator(ec);
+	scalar = crypto_bignum_init();
+	res1 = crypto_ec_point_init(ec);
+	res2 = crypto_ec_point_init(ec);
+	if (!gen || !scalar || !res1 || !res2 ||
+	    crypto_ec_point_to_bin(ec, gen, bin, bin + crypto_ec_prime_len(ec))
+	    < 0)
+		goto fail;
+	gen_copy = crypto_ec_point_from_bin(ec, bin);
+	if (!gen_copy)
+		goto fail;
+
+	for (i = 0; i < rounds; i++) {
+		if (crypto_bignum_rand(scalar, crypto_ec_get_order(ec)) < 0)
+			goto fail;
+
+		start = now_ns();
+		if (crypto_ec_point_mul(ec, gen, scalar, res1) < 0)
+			goto fail;
+		fixed_ns += now_ns() - start;
+
+		start = now_ns();
+		if (crypto_ec_point_mul(ec, gen_copy, scalar, res2) < 0)
+			goto fail;
+		var_ns += now_ns() - start;
+
+		if (crypto_ec_point_cmp(ec, res1, res2) != 0) {
+			printf("EC group %d: generator multiplication mismatch\n",
+			       group);
+			goto fail;
+		}
+	}
+
+	printf("EC group %d: crypto_ec_init %.1f usec, generator "
+	       "multiplication %.1f usec (%.1f usec with a copy of the "
+	       "generator)\n", group, init_ns / 1000.0 / rounds,
+	       fixed_ns / 1000.0 / rounds, var_ns / 1000.0 / rounds);
+	ret = 0;
+fail:
+	crypto_bignum_deinit(scalar, 1);
+	crypto_ec_point_deinit(gen_copy, 0);
+	crypto_ec_point_deinit(res1, 1);
+	crypto_ec_point_deinit(res2, 1);
+	crypto_ec_deinit(ec);
+	return ret;
+}
+
+
+int main(int argc, char *argv[])
+{
+	static const int ecc_groups[] = { 19, 20, 21 };
+	unsigned int rounds = 10, i;
+	int ret = 0;
+
+	if (argc > 1)
+		rounds = atoi(argv[1]);
+	if (rounds == 0)
+		rounds = 1;
+
+	wpa_debug_level = MSG_ERROR;
+	if (os_program_init())
+		return -1;
+
+	for (i = 0; i < ARRAY_SIZE(ecc_groups); i++) {
+		if (ec_generator_test(ecc_groups[i], rounds) < 0 ||
+		    sae_group_test(ecc_groups[i], 0, rounds) < 0 ||
+		    sae_group_test(ecc_groups[i], 1, rounds) < 0)
+			ret = -1;
+	}
+	if (sae_group_test(15, 0, rounds) < 0 ||
+	    sae_group_test(15, 1, rounds) < 0)
+		ret = -1;
+
+	os_program_deinit();
+	if (ret == 0)
+		printf("All SAE tests passed\n");
+	return ret;
+}
@@ -0,0 +1,307 @@
+/*
+ * wpa_supplicant SSID index - test and benchmark program
+ * Copyright (c) 2026, Infineon Technologies AG
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "config_ssid.h"
+#include "ssid_index.h"
+
+#define NUM_NETWORKS 500
+#define NUM_BSS 300
+#define NUM_PRIO 5
+#define MAX_BSS 2000
+
+struct test_bss {
+	u8 bssid[ETH_ALEN];
+	u8 ssid[SSID_MAX_LEN];
+	size_t ssid_len;
+};
+
+static struct test_bss bss_list[MAX_BSS];
+static unsigned int num_bss;
+
+
+/*
+ * Read scan results in the format printed by "wpa_cli scan_results":
+ * bssid / frequency / signal level / flags / ssid
+ */
+static int read_scan_dump(const char *fname)
+{
+	FILE *f;
+	char buf[512], *pos, *end;
+	int i;
+
+	f = fopen(fname, "r");
+	if (!f) {
+		printf("Could not open '%s'\n", fname);
+		return -1;
+	}
+
+	while (num_bss < MAX_BSS && fgets(buf, sizeof(buf), f)) {
+		struct test_bss *bss = &bss_list[num_bss];
+
+		pos = os_strchr(buf, '\n');
+		if (pos)
+			*pos = '\0';
+		if (hwaddr_aton(buf, bss->bssid))
+			continue;
+		/* SSID is the fifth tab separated field */
+		pos = buf;
+		for (i = 0; pos && i < 4; i++) {
+			pos = os_strchr(pos, '\t');
+			if (pos)
+				pos++;
+		}
+		if (!pos)
+			continue;
+		end = pos + os_strlen(pos);
+		bss->ssid_len = printf_decode(bss->ssid, sizeof(bss->ssid),
+					      pos);
+		if (end == pos || bss->ssid_len == 0)
+			continue;
+		num_bss++;
+	}
+
+	fclose(f);
+	printf("Read %u BSSes from %s\n", num_bss, fname);
+	return num_bss ? 0 : -1;
+}
+
+
+static void generate_scan(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < NUM_BSS; i++) {
+		struct test_bss *bss = &bss_list[i];
+
+		bss->bssid[0] = 0x02;
+		WPA_PUT_BE32(&bss->bssid[2], i);
+		/* A third of the BSSes belong to saved networks */
+		bss->ssid_len = os_snprintf((char *) bss->ssid,
+					    sizeof(bss->ssid), "%s%u",
+					    i % 3 ? "venue-" : "net-",
+					    i % 3 ? i : (i * 7) % NUM_NETWORKS);
+	}
+	num_bss = NUM_BSS;
+}
+
+
+static void free_networks(struct wpa_ssid *ssid)
+{
+	struct wpa_ssid *next;
+
+	while (ssid) {
+		next = ssid->next;
+		os_free(ssid->ssid);
+		os_free(ssid);
+		ssid = next;
+	}
+}
+
+
+/*
+ * Build saved networks in NUM_PRIO priority groups: SSIDs of the scan dump
+ * (every other one) and of the synthetic scan, unrelated SSIDs, and a few
+ * networks without an SSID that match a BSSID.
+ */
+static struct wpa_ssid * build_networks(struct wpa_ssid **pssid)
+{
+	struct wpa_ssid *head = NULL, *ssid, **tail[NUM_PRIO];
+	unsigned int i, prio;
+	char buf[SSID_MAX_LEN + 1];
+
+	for (prio = 0; prio < NUM_PRIO; prio++) {
+		pssid[prio] = NULL;
+		tail[prio] = &pssid[prio];
+	}
+
+	for (i = 0; i < NUM_NETWORKS; i++) {
+		ssid = os_zalloc(sizeof(*ssid));
+		if (!ssid) {
+			free_networks(head);
+			return NULL;
+		}
+		ssid->id = i;
+		ssid->next = head;
+		head = ssid;
+
+		if (i % 50 == 49) {
+			/* BSSID-only network */
+			ssid->bssid_set = 1;
+			os_memcpy(ssid->bssid, bss_list[i % num_bss].bssid,
+				  ETH_ALEN);
+		} else if (i % 2 == 0 && i / 2 < num_bss) {
+			ssid->ssid = os_memdup(bss_list[i / 2].ssid,
+					       bss_list[i / 2].ssid_len);
+			ssid->ssid_len = bss_list[i / 2].ssid_len;
+		} else {
+			os_snprintf(buf, sizeof(buf), "net-%u", i);
+			ssid->ssid = (u8 *) os_strdup(buf);
+			ssid->ssid_len = os_strlen(buf);
+		}
+		if ((ssid->ssid_len && !ssid->ssid) || i % 17 == 0)
+			ssid->disabled = 1;
+
+		prio = (i * 7) % NUM_PRIO;
+		ssid->priority = NUM_PRIO - prio;
+		*tail[prio] = ssid;
+		tail[prio] = &ssid->pnext;
+	}
+
+	return head;
+}
+
+
+/* Simplified version of the network/BSS compatibility check */
+static int network_ok(struct wpa_ssid *ssid, const struct test_bss *bss)
+{
+	if (ssid->disabled)
+		return 0;
+	if (ssid->ssid_len &&
+	    (ssid->ssid_len != bss->ssid_len ||
+	     os_memcmp(ssid->ssid, bss->ssid, bss->ssid_len) != 0))
+		return 0;
+	if (ssid->bssid_set &&
+	    os_memcmp(ssid->bssid, bss->bssid, ETH_ALEN) != 0)
+		return 0;
+	return 1;
+}
+
+
+static struct wpa_ssid * match_list(struct wpa_ssid *group,
+				    const struct test_bss *bss)
+{
+	struct wpa_ssid *ssid;
+
+	for (ssid = group; ssid; ssid = ssid->pnext) {
+		if (network_ok(ssid, bss))
+			return ssid;
+	}
+	return NULL;
+}
+
+
+static struct wpa_ssid * match_index(struct wpa_ssid_index *idx, int group,
+				     const struct test_bss *bss)
+{
+	struct wpa_ssid_index_iter iter;
+	struct wpa_ssid *ssid;
+
+	wpa_ssid_index_iter_init(&iter, idx, group, bss->ssid, bss->ssid_len);
+	while ((ssid = wpa_ssid_index_iter_next(&iter))) {
+		if (network_ok(ssid, bss))
+			return ssid;
+	}
+	return NULL;
+}
+
+
+static unsigned int select_all(struct wpa_ssid **pssid,
+			       struct wpa_ssid_index *idx,
+			       struct wpa_ssid **selected)
+{
+	unsigned int prio, i, found = 0;
+	struct wpa_ssid *ssid;
+
+	for (prio = 0; prio < NUM_PRIO; prio++) {
+		for (i = 0; i < num_bss; i++) {
+			if (idx)
+				ssid = match_index(idx, prio, &bss_list[i]);
+			else
+				ssid = match_list(pssid[prio], &bss_list[i]);
+			if (selected)
+				selected[prio * num_bss + i] = ssid;
+			if (ssid)
+				found++;
+		}
+	}
+
+	return found;
+}
+
+
+static void bench(const char *title, struct wpa_ssid **pssid, int use_index,
+		  unsigned int rounds)
+{
+	struct os_reltime start, end, diff;
+	struct wpa_ssid_index *idx = NULL;
+	unsigned int i, found = 0;
+
+	os_get_reltime(&start);
+	for (i = 0; i < rounds; i++) {
+		/* The index is built for each selection as in events.c */
+		if (use_index) {
+			idx = wpa_ssid_index_build(pssid, NUM_PRIO);
+			if (!idx)
+				return;
+		}
+		found = select_all(pssid, idx, NULL);
+		wpa_ssid_index_free(idx);
+	}
+	os_get_reltime(&end);
+	os_reltime_sub(&end, &start, &diff);
+	printf("%s: %u selections (%u matches each) in %ld.%06ld s\n", title,
+	       rounds, found, (long) diff.sec, (long) diff.usec);
+}
+
+
+int main(int argc, char *argv[])
+{
+	struct wpa_ssid *networks, *pssid[NUM_PRIO];
+	struct wpa_ssid **sel_list = NULL, **sel_index = NULL;
+	struct wpa_ssid_index *idx = NULL;
+	unsigned int rounds = 100, found;
+	int ret = -1;
+
+	if (argc > 1)
+		rounds = atoi(argv[1]);
+	if (argc > 2) {
+		if (read_scan_dump(argv[2]) < 0)
+			return -1;
+	} else {
+		generate_scan();
+	}
+
+	networks = build_networks(pssid);
+	if (!networks)
+		return -1;
+
+	idx = wpa_ssid_index_build(pssid, NUM_PRIO);
+	sel_list = os_calloc(NUM_PRIO * num_bss, sizeof(struct wpa_ssid *));
+	sel_index = os_calloc(NUM_PRIO * num_bss, sizeof(struct wpa_ssid *));
+	if (!idx || !sel_list || !sel_index)
+		goto out;
+
+	if (wpa_ssid_index_group(idx, pssid[2]) != 2) {
+		printf("Priority group not found\n");
+		goto out;
+	}
+
+	found = select_all(pssid, NULL, sel_list);
+	if (select_all(pssid, idx, sel_index) != found ||
+	    os_memcmp(sel_list, sel_index,
+		      NUM_PRIO * num_bss * sizeof(struct wpa_ssid *)) != 0) {
+		printf("Index selection differs from the network list\n");
+		goto out;
+	}
+	printf("Index matches the network list (%u networks, %u BSSes, %u matches)\n",
+	       NUM_NETWORKS, num_bss, found);
+
+	bench("network list", pssid, 0, rounds);
+	bench("index", pssid, 1, rounds);
+	ret = 0;
+
+out:
+	wpa_ssid_index_free(idx);
+	os_free(sel_list);
+	os_free(sel_index);
+	free_networks(networks);
+	return ret;
+}
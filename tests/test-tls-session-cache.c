@@ -0,0 +1,315 @@
+/*
+ * Shared TLS session cache - test and benchmark program
+ * Copyright (c) 2026, Infineon Technologies AG
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+#include <sys/stat.h>
+
+#include "utils/common.h"
+#include "crypto/tls_session_cache.h"
+
+#define SESS_LEN 1500 /* roughly a serialized session with a client cert */
+#define APP_LEN 40
+
+
+static void make_key(u8 *key, unsigned int i)
+{
+	os_memset(key, 0, 32);
+	key[0] = 1;
+	WPA_PUT_BE32(&key[1], i);
+}
+
+
+static void make_data(u8 *buf, size_t len, unsigned int i)
+{
+	size_t j;
+
+	for (j = 0; j < len; j++)
+		buf[j] = i + j;
+}
+
+
+static int check_entry(struct tls_session_cache *cache, unsigned int i,
+		       size_t sess_len, size_t app_len)
+{
+	u8 key[32], data[SESS_LEN], *sess;
+	size_t len;
+	struct wpabuf *app;
+	int ret = -1;
+
+	make_key(key, i);
+	if (tls_session_cache_get(cache, key, sizeof(key), &sess, &len,
+				  &app) < 0)
+		return -1;
+	make_data(data, sess_len, i);
+	if (len != sess_len || (sess_len && os_memcmp(sess, data, len) != 0))
+		goto out;
+	make_data(data, app_len, i + 1);
+	if ((app_len && (!app || wpabuf_len(app) != app_len ||
+			 os_memcmp(wpabuf_head(app), data, app_len) != 0)) ||
+	    (!app_len && app))
+		goto out;
+	ret = 0;
+out:
+	os_free(sess);
+	wpabuf_free(app);
+	return ret;
+}
+
+
+static int store_entry(struct tls_session_cache *cache, unsigned int i,
+		       size_t sess_len, size_t app_len, unsigned int lifetime)
+{
+	u8 key[32], sess[SESS_LEN], app[APP_LEN];
+
+	make_key(key, i);
+	make_data(sess, sess_len, i);
+	make_data(app, app_len, i + 1);
+	return tls_session_cache_store(cache, key, sizeof(key),
+				       sess_len ? sess : NULL, sess_len,
+				       app_len ? app : NULL, app_len, lifetime);
+}
+
+
+static int test_entries(const char *fname)
+{
+	struct tls_session_cache *cache, *cache2 = NULL;
+	u8 key[32], big[4096];
+	unsigned int i, found;
+	int ret = -1;
+
+	cache = tls_session_cache_open(fname, 16);
+	if (!cache)
+		return -1;
+
+	if (store_entry(cache, 1, SESS_LEN, APP_LEN, 60) < 0 ||
+	    check_entry(cache, 1, SESS_LEN, APP_LEN) < 0 ||
+	    check_entry(cache, 2, SESS_LEN, APP_LEN) == 0) {
+		printf("Store/get failed\n");
+		goto out;
+	}
+
+	/* Replace with an entry that has only application data */
+	if (store_entry(cache, 1, 0, APP_LEN, 60) < 0 ||
+	    check_entry(cache, 1, 0, APP_LEN) < 0) {
+		printf("Replace failed\n");
+		goto out;
+	}
+
+	/* Entries are shared with other users of the same file */
+	cache2 = tls_session_cache_open(fname, 16);
+	if (!cache2 || check_entry(cache2, 1, 0, APP_LEN) < 0) {
+		printf("Entry not found with another handle\n");
+		goto out;
+	}
+	tls_session_cache_remove(cache2, (u8 *) "unknown", 7);
+	make_key(key, 1);
+	tls_session_cache_remove(cache2, key, sizeof(key));
+	if (check_entry(cache, 1, 0, APP_LEN) == 0) {
+		printf("Remove failed\n");
+		goto out;
+	}
+
+	/* Expired and too large entries */
+	os_memset(big, 0, sizeof(big));
+	if (store_entry(cache, 3, SESS_LEN, 0, 0) < 0 ||
+	    check_entry(cache, 3, SESS_LEN, 0) == 0 ||
+	    tls_session_cache_store(cache, key, sizeof(key), big, sizeof(big),
+				    NULL, 0, 60) == 0 ||
+	    tls_session_cache_store(cache, big, TLS_SESSION_CACHE_MAX_KEY + 1,
+				    NULL, 0, NULL, 0, 60) == 0) {
+		printf("Expired or too large entry accepted\n");
+		goto out;
+	}
+
+	/* The entries that expire first are replaced when the cache is full */
+	for (i = 0; i < 100; i++) {
+		if (store_entry(cache, 100 + i, SESS_LEN, APP_LEN,
+				1000 + i) < 0 ||
+		    check_entry(cache, 100 + i, SESS_LEN, APP_LEN) < 0) {
+			printf("Entry %u not stored\n", i);
+			goto out;
+		}
+	}
+	found = 0;
+	for (i = 0; i < 100; i++) {
+		if (check_entry(cache2, 100 + i, SESS_LEN, APP_LEN) == 0)
+			found++;
+	}
+	if (found == 0 || found > 16 ||
+	    check_entry(cache2, 199, SESS_LEN, APP_LEN) < 0) {
+		printf("Eviction failed (%u entries found)\n", found);
+		goto out;
+	}
+
+	/* Other processes may have the file mapped, so an existing file keeps
+	 * its size and contents even if a different size is requested */
+	tls_session_cache_close(cache2);
+	cache2 = tls_session_cache_open(fname, 32);
+	if (!cache2 || check_entry(cache2, 199, SESS_LEN, APP_LEN) < 0 ||
+	    check_entry(cache, 199, SESS_LEN, APP_LEN) < 0) {
+		printf("Existing cache was reinitialized\n");
+		goto out;
+	}
+
+	ret = 0;
+out:
+	tls_session_cache_close(cache);
+	tls_session_cache_close(cache2);
+	return ret;
+}
+
+
+static int test_ticket_keys(const char *fname)
+{
+	struct tls_session_cache *cache, *cache2 = NULL;
+	struct tls_ticket_key keys[2], keys2[2];
+	int ret = -1;
+
+	cache = tls_session_cache_open(fname, 16);
+	if (!cache)
+		return -1;
+	cache2 = tls_session_cache_open(fname, 16);
+	if (!cache2 ||
+	    tls_session_cache_ticket_keys(cache, 3600, keys) < 0 ||
+	    tls_session_cache_ticket_keys(cache2, 3600, keys2) < 0 ||
+	    os_memcmp(keys, keys2, sizeof(keys)) != 0 ||
+	    keys[0].created == 0 || keys[1].created != 0) {
+		printf("Ticket keys not shared\n");
+		goto out;
+	}
+
+	/* Rotation moves the current key to the previous one */
+	os_sleep(1, 100000);
+	if (tls_session_cache_ticket_keys(cache2, 1, keys2) < 0 ||
+	    os_memcmp(&keys2[1], &keys[0], sizeof(keys[0])) != 0 ||
+	    os_memcmp(keys2[0].name, keys[0].name,
+		      TLS_TICKET_KEY_NAME_LEN) == 0 ||
+	    tls_session_cache_ticket_keys(cache, 3600, keys) < 0 ||
+	    os_memcmp(keys, keys2, sizeof(keys)) != 0) {
+		printf("Ticket key rotation failed\n");
+		goto out;
+	}
+
+	ret = 0;
+out:
+	forced_memzero(keys, sizeof(keys));
+	forced_memzero(keys2, sizeof(keys2));
+	tls_session_cache_close(cache);
+	tls_session_cache_close(cache2);
+	return ret;
+}
+
+
+static int test_invalid_files(const char *fname)
+{
+	struct tls_session_cache *cache;
+	char path[100];
+	struct stat st;
+	FILE *f;
+	int ret = -1;
+
+	/* A file that is not a session cache is neither used nor modified */
+	os_snprintf(path, sizeof(path), "%s.bad", fname);
+	f = fopen(path, "w");
+	if (!f)
+		return -1;
+	fprintf(f, "not a session cache\n");
+	fclose(f);
+	cache = tls_session_cache_open(path, 16);
+	if (cache || stat(path, &st) < 0 || st.st_size != 20) {
+		printf("Invalid cache file accepted or modified\n");
+		tls_session_cache_close(cache);
+		goto out;
+	}
+	unlink(path);
+
+	/* Symbolic links are not followed */
+	os_snprintf(path, sizeof(path), "%s.link", fname);
+	if (symlink(fname, path) < 0)
+		return -1;
+	cache = tls_session_cache_open(path, 16);
+	if (cache) {
+		printf("Symbolic link followed\n");
+		tls_session_cache_close(cache);
+		goto out;
+	}
+
+	ret = 0;
+out:
+	unlink(path);
+	return ret;
+}
+
+
+static void bench(const char *fname, unsigned int num, unsigned int rounds)
+{
+	struct tls_session_cache *cache;
+	struct os_reltime start, end, diff;
+	unsigned int i, found = 0;
+
+	/* An existing file keeps its size, so start with a new one */
+	unlink(fname);
+	cache = tls_session_cache_open(fname, num);
+	if (!cache)
+		return;
+
+	os_get_reltime(&start);
+	for (i = 0; i < rounds; i++)
+		store_entry(cache, i % num, SESS_LEN, APP_LEN, 3600);
+	os_get_reltime(&end);
+	os_reltime_sub(&end, &start, &diff);
+	printf("%u entries: %u stores in %ld.%06ld s\n",
+	       num, rounds, (long) diff.sec, (long) diff.usec);
+
+	os_get_reltime(&start);
+	for (i = 0; i < rounds; i++) {
+		if (check_entry(cache, (i * 7) % num, SESS_LEN, APP_LEN) == 0)
+			found++;
+	}
+	os_get_reltime(&end);
+	os_reltime_sub(&end, &start, &diff);
+	printf("%u entries: %u lookups (%u found) in %ld.%06ld s\n",
+	       num, rounds, found, (long) diff.sec, (long) diff.usec);
+
+	tls_session_cache_close(cache);
+}
+
+
+int main(int argc, char *argv[])
+{
+	char fname[] = "/tmp/test-tls-session-cache.XXXXXX";
+	unsigned int rounds = 10000;
+	int fd, ret = -1;
+
+	if (argc > 1)
+		rounds = atoi(argv[1]);
+
+	if (os_program_init())
+		return -1;
+	fd = mkstemp(fname);
+	if (fd < 0) {
+		printf("Could not create a temporary file\n");
+		goto out;
+	}
+	close(fd);
+
+	if (test_entries(fname) < 0 || test_ticket_keys(fname) < 0 ||
+	    test_invalid_files(fname) < 0) {
+		printf("Session cache test failed\n");
+		goto out;
+	}
+	printf("Session cache tests passed\n");
+
+	bench(fname, 1024, rounds);
+	bench(fname, 16384, rounds);
+	ret = 0;
+out:
+	unlink(fname);
+	os_program_deinit();
+	return ret;
+}
@@ -0,0 +1,485 @@
+/*
+ * TLS peer certificate verification cache test
+ * Copyright (c) 2026, Infineon Technologies AG
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ *
+ * Generates a small PKI in a temporary directory and runs in-process TLS
+ * handshakes between a client and a server that verifies the client
+ * certificate with the verification cache enabled. The cache statistics are
+ * used to check that the lookup key covers the peer certificate, the trusted
+ * CA set and the verification flags, that cached results expire after the
+ * configured lifetime and at the next update of a CRL, and that results
+ * where an error was accepted by the verify callback are not cached.
+ *
+ * usage: test-tls-verify-cache
+ */
+
+#include "utils/includes.h"
+#include <openssl/pem.h>
+#include <openssl/x509v3.h>
+
+#include "utils/common.h"
+#include "crypto/tls.h"
+
+static char tmp_dir[] = "/tmp/test-tls-verify-cache.XXXXXX";
+static const char *files[] = {
+	"ca.pem", "ca2.pem", "ca-crl.pem",
+	"server.pem", "server.key", "user.pem", "user.key",
+	"user2.pem", "user2.key", "future.pem", "future.key", NULL
+};
+static void *client_ctx;
+static long serial = 1;
+
+
+static void file_path(char *buf, size_t len, const char *name)
+{
+	os_snprintf(buf, len, "%s/%s", tmp_dir, name);
+}
+
+
+static EVP_PKEY * gen_key(void)
+{
+	EVP_PKEY_CTX *pctx;
+	EVP_PKEY *key = NULL;
+
+	pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, NULL);
+	if (!pctx || EVP_PKEY_keygen_init(pctx) != 1 ||
+	    EVP_PKEY_CTX_set_ec_paramgen_curve_nid(pctx,
+						   NID_X9_62_prime256v1) != 1 ||
+	    EVP_PKEY_keygen(pctx, &key) != 1)
+		key = NULL;
+	EVP_PKEY_CTX_free(pctx);
+	return key;
+}
+
+
+static int add_ext(X509 *cert, int nid, const char *value)
+{
+	X509_EXTENSION *ext;
+	int ret;
+
+	ext = X509V3_EXT_conf_nid(NULL, NULL, nid, value);
+	if (!ext)
+		return -1;
+	ret = X509_add_ext(cert, ext, -1) == 1 ? 0 : -1;
+	X509_EXTENSION_free(ext);
+	return ret;
+}
+
+
+/* Generate a certificate that is valid from now + not_before days until now +
+ * not_after days. Certificates without an issuer are self-signed CA
+ * certificates. */
+static X509 * gen_cert(const char *cn, EVP_PKEY *key, X509 *issuer,
+		       EVP_PKEY *issuer_key, int not_before, int not_after)
+{
+	X509 *cert;
+	X509_NAME *name;
+
+	cert = X509_new();
+	name = X509_NAME_new();
+	if (!cert || !name ||
+	    X509_set_version(cert, 2) != 1 ||
+	    ASN1_INTEGER_set(X509_get_serialNumber(cert), serial++) != 1 ||
+	    !X509_time_adj_ex(X509_getm_notBefore(cert), not_before, 0, NULL) ||
+	    !X509_time_adj_ex(X509_getm_notAfter(cert), not_after, 0, NULL) ||
+	    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+				       (const unsigned char *) cn, -1, -1,
+				       0) != 1 ||
+	    X509_set_subject_name(cert, name) != 1 ||
+	    X509_set_issuer_name(cert, issuer ? X509_get_subject_name(issuer) :
+				 name) != 1 ||
+	    X509_set_pubkey(cert, key) != 1 ||
+	    (!issuer &&
+	     (add_ext(cert, NID_basic_constraints, "critical,CA:TRUE") < 0 ||
+	      add_ext(cert, NID_key_usage, "critical,keyCertSign,cRLSign") <
+	      0)) ||
+	    X509_sign(cert, issuer ? issuer_key : key, EVP_sha256()) <= 0) {
+		X509_free(cert);
+		cert = NULL;
+	}
+	X509_NAME_free(name);
+	return cert;
+}
+
+
+static X509_CRL * gen_crl(X509 *ca, EVP_PKEY *ca_key, long next_update)
+{
+	X509_CRL *crl;
+	ASN1_TIME *last = NULL, *next = NULL;
+
+	crl = X509_CRL_new();
+	last = X509_time_adj_ex(NULL, 0, -60, NULL);
+	next = X509_time_adj_ex(NULL, 0, next_update, NULL);
+	if (!crl || !last || !next ||
+	    X509_CRL_set_version(crl, 1) != 1 ||
+	    X509_CRL_set_issuer_name(crl, X509_get_subject_name(ca)) != 1 ||
+	    X509_CRL_set1_lastUpdate(crl, last) != 1 ||
+	    X509_CRL_set1_nextUpdate(crl, next) != 1 ||
+	    X509_CRL_sign(crl, ca_key, EVP_sha256()) <= 0) {
+		X509_CRL_free(crl);
+		crl = NULL;
+	}
+	ASN1_TIME_free(last);
+	ASN1_TIME_free(next);
+	return crl;
+}
+
+
+static int write_pem(const char *name, X509 *cert, X509 *cert2,
+		     X509_CRL *crl, EVP_PKEY *key)
+{
+	char path[256];
+	FILE *f;
+	int ok;
+
+	file_path(path, sizeof(path), name);
+	f = fopen(path, "w");
+	if (!f)
+		return -1;
+	ok = (!cert || PEM_write_X509(f, cert)) &&
+		(!cert2 || PEM_write_X509(f, cert2)) &&
+		(!crl || PEM_write_X509_CRL(f, crl)) &&
+		(!key || PEM_write_PrivateKey(f, key, NULL, NULL, 0, NULL,
+					      NULL));
+	fclose(f);
+	return ok ? 0 : -1;
+}
+
+
+static int write_leaf(const char *name, X509 *ca, EVP_PKEY *ca_key,
+		      int not_before, int not_after)
+{
+	EVP_PKEY *key;
+	X509 *cert = NULL;
+	char fname[20];
+	int ret = -1;
+
+	key = gen_key();
+	if (key)
+		cert = gen_cert(name, key, ca, ca_key, not_before, not_after);
+	if (!cert)
+		goto fail;
+	os_snprintf(fname, sizeof(fname), "%s.pem", name);
+	if (write_pem(fname, cert, NULL, NULL, NULL) < 0)
+		goto fail;
+	os_snprintf(fname, sizeof(fname), "%s.key", name);
+	if (write_pem(fname, NULL, NULL, NULL, key) < 0)
+		goto fail;
+	ret = 0;
+fail:
+	X509_free(cert);
+	EVP_PKEY_free(key);
+	return ret;
+}
+
+
+static int gen_pki(void)
+{
+	EVP_PKEY *ca_key, *ca2_key;
+	X509 *ca = NULL, *ca2 = NULL;
+	X509_CRL *crl = NULL;
+	int ret = -1;
+
+	ca_key = gen_key();
+	ca2_key = gen_key();
+	if (ca_key && ca2_key) {
+		ca = gen_cert("Test CA", ca_key, NULL, NULL, -1, 3650);
+		ca2 = gen_cert("Test CA 2", ca2_key, NULL, NULL, -1, 3650);
+	}
+	/* The CRL needs to be updated in 2 seconds, so verification results
+	 * with CRL checking must not be cached for longer than that */
+	if (ca)
+		crl = gen_crl(ca, ca_key, 2);
+	if (!ca || !ca2 || !crl ||
+	    write_pem("ca.pem", ca, NULL, NULL, NULL) < 0 ||
+	    write_pem("ca2.pem", ca, ca2, NULL, NULL) < 0 ||
+	    write_pem("ca-crl.pem", ca, NULL, crl, NULL) < 0 ||
+	    write_leaf("server", ca, ca_key, -1, 365) < 0 ||
+	    /* Valid for about 80 years, so the remaining time in seconds does
+	     * not fit in a 32-bit long */
+	    write_leaf("user", ca, ca_key, -1, 80 * 365) < 0 ||
+	    write_leaf("user2", ca, ca_key, -1, 365) < 0 ||
+	    /* Not valid yet, but would otherwise be cacheable */
+	    write_leaf("future", ca, ca_key, 1, 365) < 0)
+		goto fail;
+	ret = 0;
+fail:
+	X509_free(ca);
+	X509_free(ca2);
+	X509_CRL_free(crl);
+	EVP_PKEY_free(ca_key);
+	EVP_PKEY_free(ca2_key);
+	return ret;
+}
+
+
+static void remove_pki(void)
+{
+	char path[256];
+	int i;
+
+	for (i = 0; files[i]; i++) {
+		file_path(path, sizeof(path), files[i]);
+		unlink(path);
+	}
+	rmdir(tmp_dir);
+}
+
+
+static int set_ca(void *server, const char *ca)
+{
+	struct tls_connection_params params;
+	char ca_cert[256], server_cert[256], server_key[256];
+
+	file_path(ca_cert, sizeof(ca_cert), ca);
+	file_path(server_cert, sizeof(server_cert), "server.pem");
+	file_path(server_key, sizeof(server_key), "server.key");
+	os_memset(&params, 0, sizeof(params));
+	params.ca_cert = ca_cert;
+	params.client_cert = server_cert;
+	params.private_key = server_key;
+	return tls_global_set_params(server, &params);
+}
+
+
+static void * server_init(unsigned int lifetime)
+{
+	struct tls_config conf;
+	void *server;
+
+	os_memset(&conf, 0, sizeof(conf));
+	conf.tls_verify_cache_size = 10;
+	conf.tls_verify_cache_lifetime = lifetime;
+	server = tls_init(&conf);
+	if (server && set_ca(server, "ca.pem") < 0) {
+		tls_deinit(server);
+		server = NULL;
+	}
+	return server;
+}
+
+
+static int handshake(void *server, const char *user, unsigned int flags)
+{
+	struct tls_connection_params params;
+	struct tls_connection *client, *conn;
+	struct wpabuf *in = NULL, *out = NULL;
+	char cert[256], key[256], name[20];
+	int i, ret = -1;
+
+	os_snprintf(name, sizeof(name), "%s.pem", user);
+	file_path(cert, sizeof(cert), name);
+	os_snprintf(name, sizeof(name), "%s.key", user);
+	file_path(key, sizeof(key), name);
+	os_memset(&params, 0, sizeof(params));
+	params.client_cert = cert;
+	params.private_key = key;
+
+	client = tls_connection_init(client_ctx);
+	conn = tls_connection_init(server);
+	if (!client || !conn ||
+	    tls_connection_set_params(client_ctx, client, &params) < 0 ||
+	    tls_connection_set_verify(server, conn, 1, flags, NULL, 0) < 0)
+		goto fail;
+
+	for (i = 0; i < 10; i++) {
+		out = tls_connection_handshake(client_ctx, client, in, NULL);
+		wpabuf_free(in);
+		in = NULL;
+		if (!out || wpabuf_len(out) == 0 ||
+		    tls_connection_get_failed(client_ctx, client))
+			break;
+		in = tls_connection_server_handshake(server, conn, out, NULL);
+		wpabuf_free(out);
+		out = NULL;
+		if (tls_connection_get_failed(server, conn))
+			break;
+		if (tls_connection_established(server, conn)) {
+			ret = 0;
+			break;
+		}
+		if (!in)
+			break;
+	}
+
+fail:
+	wpabuf_free(in);
+	wpabuf_free(out);
+	tls_connection_deinit(client_ctx, client);
+	tls_connection_deinit(server, conn);
+	return ret;
+}
+
+
+static int check_stats(void *server, const char *step, unsigned int hits,
+		       unsigned int misses, unsigned int stores,
+		       unsigned int expired)
+{
+	struct tls_cert_cache_stats stats;
+
+	if (tls_get_cert_cache_stats(server, &stats) < 0) {
+		printf("%s: failed to get cache statistics\n", step);
+		return -1;
+	}
+	if (stats.verify_hits != hits || stats.verify_misses != misses ||
+	    stats.verify_stores != stores || stats.verify_expired != expired) {
+		printf("%s: hits %u misses %u stores %u expired %u (expected %u %u %u %u)\n",
+		       step, stats.verify_hits, stats.verify_misses,
+		       stats.verify_stores, stats.verify_expired,
+		       hits, misses, stores, expired);
+		return -1;
+	}
+	return 0;
+}
+
+
+static int test_key(void)
+{
+	void *server;
+	int ret = -1;
+
+	server = server_init(300);
+	if (!server)
+		return -1;
+
+	if (handshake(server, "user", 0) < 0 ||
+	    check_stats(server, "key: first handshake", 0, 1, 1, 0) < 0 ||
+	    handshake(server, "user", 0) < 0 ||
+	    check_stats(server, "key: same peer", 1, 1, 1, 0) < 0 ||
+	    handshake(server, "user2", 0) < 0 ||
+	    check_stats(server, "key: other peer", 1, 2, 2, 0) < 0 ||
+	    set_ca(server, "ca2.pem") < 0 ||
+	    handshake(server, "user", 0) < 0 ||
+	    check_stats(server, "key: other CA set", 1, 3, 3, 0) < 0 ||
+	    handshake(server, "user", 0) < 0 ||
+	    check_stats(server, "key: same CA set", 2, 3, 3, 0) < 0)
+		goto fail;
+
+	ret = 0;
+fail:
+	tls_deinit(server);
+	return ret;
+}
+
+
+static int test_expiry(void)
+{
+	void *server;
+	int ret = -1;
+
+	server = server_init(1);
+	if (!server)
+		return -1;
+
+	if (handshake(server, "user", 0) < 0 ||
+	    handshake(server, "user", 0) < 0 ||
+	    check_stats(server, "expiry: before", 1, 1, 1, 0) < 0)
+		goto fail;
+	sleep(2);
+	if (handshake(server, "user", 0) < 0 ||
+	    check_stats(server, "expiry: after", 1, 2, 2, 1) < 0)
+		goto fail;
+
+	ret = 0;
+fail:
+	tls_deinit(server);
+	return ret;
+}
+
+
+static int test_crl(void)
+{
+	void *server;
+	int ret = -1;
+
+	server = server_init(300);
+	if (!server)
+		return -1;
+
+	/* Enabling CRL checking changes the key, and the CRL limits the
+	 * lifetime of the result. The expired CRL is accepted since strict
+	 * CRL checking is not enabled, but that result is not cached. */
+	if (set_ca(server, "ca-crl.pem") < 0 ||
+	    handshake(server, "user", 0) < 0 ||
+	    check_stats(server, "CRL: no check", 0, 1, 1, 0) < 0 ||
+	    tls_global_set_verify(server, 1, 0) < 0 ||
+	    handshake(server, "user", 0) < 0 ||
+	    handshake(server, "user", 0) < 0 ||
+	    check_stats(server, "CRL: check", 1, 2, 2, 0) < 0)
+		goto fail;
+	sleep(3);
+	if (handshake(server, "user", 0) < 0 ||
+	    check_stats(server, "CRL: next update", 1, 3, 2, 1) < 0 ||
+	    handshake(server, "user", 0) < 0 ||
+	    check_stats(server, "CRL: expired", 1, 4, 2, 1) < 0)
+		goto fail;
+
+	ret = 0;
+fail:
+	tls_deinit(server);
+	return ret;
+}
+
+
+static int test_override(void)
+{
+	void *server;
+	int ret = -1;
+
+	server = server_init(300);
+	if (!server)
+		return -1;
+
+	if (handshake(server, "future", 0) == 0) {
+		printf("override: certificate that is not yet valid accepted\n");
+		goto fail;
+	}
+	if (check_stats(server, "override: rejected", 0, 1, 0, 0) < 0 ||
+	    handshake(server, "future", TLS_CONN_DISABLE_TIME_CHECKS) < 0 ||
+	    handshake(server, "future", TLS_CONN_DISABLE_TIME_CHECKS) < 0 ||
+	    check_stats(server, "override: accepted", 0, 3, 0, 0) < 0)
+		goto fail;
+
+	ret = 0;
+fail:
+	tls_deinit(server);
+	return ret;
+}
+
+
+int main(int argc, char *argv[])
+{
+	int ret = -1;
+
+	wpa_debug_level = MSG_ERROR;
+	if (os_program_init())
+		return -1;
+
+	if (!mkdtemp(tmp_dir)) {
+		perror("mkdtemp");
+		goto out;
+	}
+	client_ctx = tls_init(NULL);
+	if (!client_ctx || gen_pki() < 0) {
+		printf("Failed to initialize the test PKI\n");
+		goto done;
+	}
+
+	/* The CRL test is run first since the CRL expires soon */
+	if (test_crl() < 0 || test_key() < 0 || test_expiry() < 0 ||
+	    test_override() < 0)
+		goto done;
+
+	ret = 0;
+	printf("All TLS verification cache tests passed\n");
+done:
+	if (client_ctx)
+		tls_deinit(client_ctx);
+	remove_pki();
+out:
+	os_program_deinit();
+	return ret;
+}
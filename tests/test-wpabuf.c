@@ -0,0 +1,172 @@
+/*
+ * wpabuf allocation - test and benchmark program
+ * Copyright (c) 2026, Infineon Technologies AG
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+
+
+/* Typical EAP-TLS server round: RADIUS Access-Request parsing, EAP message
+ * reassembly, TLS record fragment, and EAP-Request/RADIUS Access-Challenge
+ * building with incremental growth. */
+static int run_round(void)
+{
+	struct wpabuf *req, *eap, *frag, *resp, *tmp;
+	int i;
+
+	req = wpabuf_alloc(4096);
+	if (!req)
+		return -1;
+	os_memset(wpabuf_put(req, 1200), 0x11, 1200);
+
+	eap = NULL;
+	for (i = 0; i < 5; i++) {
+		tmp = wpabuf_alloc_copy(wpabuf_head_u8(req) + i * 240, 240);
+		if (!tmp)
+			goto fail;
+		eap = wpabuf_concat(eap, tmp);
+		if (!eap)
+			goto fail;
+	}
+	if (wpabuf_len(eap) != 1200 ||
+	    os_memcmp(wpabuf_head(eap), wpabuf_head(req), 1200) != 0)
+		goto fail;
+
+	frag = wpabuf_dup(eap);
+	if (!frag)
+		goto fail;
+
+	resp = wpabuf_alloc(20);
+	if (!resp) {
+		wpabuf_free(frag);
+		goto fail;
+	}
+	wpabuf_put_data(resp, "01234567890123456789", 20);
+	for (i = 0; i < 8; i++) {
+		if (wpabuf_resize(&resp, 180) < 0) {
+			wpabuf_free(frag);
+			wpabuf_free(resp);
+			goto fail;
+		}
+		os_memset(wpabuf_put(resp, 180), i, 180);
+	}
+	if (wpabuf_len(resp) != 20 + 8 * 180 ||
+	    os_memcmp(wpabuf_head(resp), "01234567890123456789", 20) != 0 ||
+	    wpabuf_head_u8(resp)[20 + 7 * 180] != 7) {
+		wpabuf_free(frag);
+		wpabuf_free(resp);
+		goto fail;
+	}
+
+	wpabuf_clear_free(frag);
+	wpabuf_free(resp);
+	wpabuf_free(eap);
+	wpabuf_free(req);
+	return 0;
+fail:
+	wpabuf_free(eap);
+	wpabuf_free(req);
+	return -1;
+}
+
+
+static int check_zeroed(void)
+{
+	struct wpabuf *buf;
+	size_t i;
+
+	buf = wpabuf_alloc(100);
+	if (!buf)
+		return -1;
+	os_memset(wpabuf_put(buf, 100), 0xff, 100);
+	wpabuf_free(buf);
+
+	/* A recycled buffer must be handed out zeroed and must grow in place
+	 * with a zeroed tail */
+	buf = wpabuf_alloc(90);
+	if (!buf)
+		return -1;
+	for (i = 0; i < 90; i++) {
+		if (wpabuf_mhead_u8(buf)[i]) {
+			wpabuf_free(buf);
+			return -1;
+		}
+	}
+	wpabuf_put(buf, 90);
+	if (wpabuf_resize(&buf, 10) < 0) {
+		wpabuf_free(buf);
+		return -1;
+	}
+	for (i = 90; i < 100; i++) {
+		if (wpabuf_mhead_u8(buf)[i]) {
+			wpabuf_free(buf);
+			return -1;
+		}
+	}
+
+	/* Growing beyond the largest size class continues on the heap */
+	if (wpabuf_resize(&buf, 10000) < 0) {
+		wpabuf_free(buf);
+		return -1;
+	}
+	wpabuf_put(buf, 10000);
+	wpabuf_free(buf);
+
+	return 0;
+}
+
+
+static int run_bench(const char *title, unsigned int rounds)
+{
+	struct os_reltime start, end, diff;
+	unsigned int i;
+
+	os_get_reltime(&start);
+	for (i = 0; i < rounds; i++) {
+		if (run_round() < 0) {
+			printf("%s: round %u failed\n", title, i);
+			return -1;
+		}
+	}
+	os_get_reltime(&end);
+	os_reltime_sub(&end, &start, &diff);
+	printf("%s: %u rounds in %ld.%06ld s\n", title, rounds,
+	       (long) diff.sec, (long) diff.usec);
+
+	return 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+	unsigned int rounds = 100000;
+	char buf[500];
+	int ret = 0;
+
+	if (argc > 1)
+		rounds = atoi(argv[1]);
+
+	if (check_zeroed() < 0) {
+		printf("wpabuf zeroing test failed\n");
+		ret = -1;
+	}
+
+	wpabuf_pool_set_max(0);
+	if (run_bench("heap", rounds) < 0)
+		ret = -1;
+
+	wpabuf_pool_set_max(32);
+	if (run_bench("pool", rounds) < 0)
+		ret = -1;
+
+	if (wpabuf_pool_get_stats(buf, sizeof(buf)) > 0)
+		printf("%s", buf);
+	wpabuf_pool_flush();
+
+	return ret;
+}
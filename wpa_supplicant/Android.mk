@@ -98,6 +98,7 @@ OBJS += src/utils/config.c
 OBJS += src/utils/wpa_debug.c
 OBJS += src/utils/wpabuf.c
 OBJS += src/utils/bitfield.c
+OBJS += src/utils/objpool.c
 OBJS += src/utils/ip_addr.c
 OBJS += src/utils/crc32.c
 OBJS += wmm_ac.c
@@ -161,6 +162,10 @@ ifdef CONFIG_ELOOP_EPOLL
 L_CFLAGS += -DCONFIG_ELOOP_EPOLL
 endif
 
+ifdef CONFIG_WPABUF_POOL
+L_CFLAGS += -DCONFIG_WPABUF_POOL
+endif
+
 ifdef CONFIG_EAPOL_TEST
 L_CFLAGS += -Werror -DEAPOL_TEST
 endif
@@ -906,6 +911,8 @@ OBJS += src/ap/ap_drv_ops.c
 OBJS += src/ap/beacon.c
 OBJS += src/ap/bss_load.c
 OBJS += src/ap/eap_user_db.c
+OBJS += src/ap/eap_user_index.c
+OBJS += src/ap/mac_acl.c
 OBJS += src/ap/neighbor_db.c
 OBJS += src/ap/rrm.c
 OBJS += src/ap/ieee802_11_ht.c
@@ -1157,6 +1164,7 @@ endif
 ifdef NEED_MODEXP
 OBJS += src/crypto/crypto_internal-modexp.c
 OBJS += src/tls/bignum.c
+L_CFLAGS += -DCONFIG_INTERNAL_BIGNUM
 endif
 ifeq ($(CONFIG_CRYPTO), libtomcrypt)
 OBJS += src/crypto/crypto_libtomcrypt.c
@@ -1587,6 +1595,12 @@ OBJS += $(SHA1OBJS) $(DESOBJS)
 OBJS_p += $(SHA1OBJS)
 OBJS_p += $(SHA256OBJS)
 
+ifdef CONFIG_INTERNAL_CRYPTO_ACCEL
+L_CFLAGS += -DCONFIG_INTERNAL_CRYPTO_ACCEL
+OBJS += src/crypto/crypto_accel.c
+OBJS_p += src/crypto/crypto_accel.c
+endif
+
 ifdef CONFIG_BGSCAN_SIMPLE
 L_CFLAGS += -DCONFIG_BGSCAN_SIMPLE
 OBJS += bgscan_simple.c
@@ -1663,10 +1677,11 @@ endif
 
 OBJS += src/drivers/driver_common.c
 
-OBJS += wpa_supplicant.c events.c bssid_ignore.c wpas_glue.c scan.c
+OBJS += wpa_supplicant.c events.c bssid_ignore.c ssid_index.c wpas_glue.c scan.c
 OBJS_t := $(OBJS) $(OBJS_l2) eapol_test.c
 OBJS_t += src/radius/radius_client.c
 OBJS_t += src/radius/radius.c
+OBJS_t += src/crypto/md5-mb.c
 OBJS_t2 := $(OBJS) $(OBJS_l2) preauth_test.c
 OBJS += $(CONFIG_MAIN).c
 
@@ -2661,6 +2661,77 @@ static const struct parse_data ssid_fields[] = {
 #define NUM_SSID_FIELDS ARRAY_SIZE(ssid_fields)
 
 
+/*
+ * Network and credential ids are allocated sequentially, so the id lookup
+ * tables are plain arrays. Ids above this limit are not indexed and are found
+ * by searching the list.
+ */
+#define WPA_CONFIG_MAX_INDEXED_ID 65535
+
+
+static int wpa_config_grow_id_table(void **table, size_t *len, size_t elem,
+				    int id)
+{
+	size_t new_len;
+	u8 *ntable;
+
+	new_len = *len ? *len : 16;
+	while (new_len <= (size_t) id)
+		new_len *= 2;
+	ntable = os_realloc_array(*table, new_len, elem);
+	if (!ntable)
+		return -1;
+	os_memset(ntable + *len * elem, 0, (new_len - *len) * elem);
+	*table = ntable;
+	*len = new_len;
+	return 0;
+}
+
+
+/*
+ * Add a network to the id lookup table unless another network with the same id
+ * is already there. Networks are indexed in list order, so the table returns
+ * the first network with the id like a search of the list would.
+ */
+static void wpa_config_index_network(struct wpa_config *config,
+				     struct wpa_ssid *ssid)
+{
+	void *table = config->ssid_by_id;
+
+	if (ssid->id < 0 || ssid->id > WPA_CONFIG_MAX_INDEXED_ID)
+		return;
+	if ((size_t) ssid->id >= config->ssid_by_id_len) {
+		/* On failure, lookups fall back to searching the list */
+		if (wpa_config_grow_id_table(&table, &config->ssid_by_id_len,
+					     sizeof(struct wpa_ssid *),
+					     ssid->id) < 0)
+			return;
+		config->ssid_by_id = table;
+	}
+	if (!config->ssid_by_id[ssid->id])
+		config->ssid_by_id[ssid->id] = ssid;
+}
+
+
+static void wpa_config_index_cred(struct wpa_config *config,
+				  struct wpa_cred *cred)
+{
+	void *table = config->cred_by_id;
+
+	if (cred->id < 0 || cred->id > WPA_CONFIG_MAX_INDEXED_ID)
+		return;
+	if ((size_t) cred->id >= config->cred_by_id_len) {
+		if (wpa_config_grow_id_table(&table, &config->cred_by_id_len,
+					     sizeof(struct wpa_cred *),
+					     cred->id) < 0)
+			return;
+		config->cred_by_id = table;
+	}
+	if (!config->cred_by_id[cred->id])
+		config->cred_by_id[cred->id] = cred;
+}
+
+
 /**
  * wpa_config_add_prio_network - Add a network to priority lists
  * @config: Configuration data from wpa_config_read()
@@ -2726,21 +2797,48 @@ int wpa_config_add_prio_network(struct wpa_config *config,
  */
 int wpa_config_update_prio_list(struct wpa_config *config)
 {
-	struct wpa_ssid *ssid;
+	struct wpa_ssid *ssid, **tail = NULL, **ntail;
+	size_t prio;
 	int ret = 0;
 
 	os_free(config->pssid);
 	config->pssid = NULL;
 	config->num_prio = 0;
 
-	ssid = config->ssid;
-	while (ssid) {
+	/*
+	 * Track the last network of each priority list to avoid walking the
+	 * lists when appending. tail[] is kept in the same order as pssid[].
+	 */
+	for (ssid = config->ssid; ssid; ssid = ssid->next) {
 		ssid->pnext = NULL;
-		if (wpa_config_add_prio_network(config, ssid) < 0)
+		for (prio = 0; prio < config->num_prio; prio++) {
+			if (config->pssid[prio]->priority == ssid->priority)
+				break;
+		}
+		if (prio < config->num_prio) {
+			tail[prio]->pnext = ssid;
+			tail[prio] = ssid;
+			continue;
+		}
+
+		ntail = os_realloc_array(tail, config->num_prio + 1,
+					 sizeof(struct wpa_ssid *));
+		if (!ntail || wpa_config_add_prio_network(config, ssid) < 0) {
+			if (ntail)
+				tail = ntail;
 			ret = -1;
-		ssid = ssid->next;
+			continue;
+		}
+		tail = ntail;
+		for (prio = 0; config->pssid[prio] != ssid; prio++)
+			;
+		os_memmove(&tail[prio + 1], &tail[prio],
+			   (config->num_prio - 1 - prio) *
+			   sizeof(struct wpa_ssid *));
+		tail[prio] = ssid;
 	}
 
+	os_free(tail);
 	return ret;
 }
 
@@ -2924,6 +3022,8 @@ void wpa_config_free(struct wpa_config *config)
 		wpa_config_free_cred(cprev);
 	}
 
+	os_free(config->ssid_by_id);
+	os_free(config->cred_by_id);
 	wpa_config_flush_blobs(config);
 
 	wpabuf_free(config->wps_vendor_ext_m1);
@@ -3006,16 +3106,23 @@ void wpa_config_foreach_network(struct wpa_config *config,
  */
 struct wpa_ssid * wpa_config_get_network(struct wpa_config *config, int id)
 {
-	struct wpa_ssid *ssid;
+	struct wpa_ssid *ssid, *found = NULL;
 
-	ssid = config->ssid;
-	while (ssid) {
-		if (id == ssid->id)
-			break;
-		ssid = ssid->next;
+	if (id >= 0 && (size_t) id < config->ssid_by_id_len &&
+	    config->ssid_by_id[id])
+		return config->ssid_by_id[id];
+
+	/*
+	 * Not in the lookup table, so search the list and add the networks
+	 * that were linked to it directly to the table on the way.
+	 */
+	for (ssid = config->ssid; ssid; ssid = ssid->next) {
+		wpa_config_index_network(config, ssid);
+		if (!found && id == ssid->id)
+			found = ssid;
 	}
 
-	return ssid;
+	return found;
 }
 
 
@@ -3049,7 +3156,14 @@ struct wpa_ssid * wpa_config_add_network(struct wpa_config *config)
 	else
 		config->ssid = ssid;
 
-	wpa_config_update_prio_list(config);
+	wpa_config_index_network(config, ssid);
+	/*
+	 * The new network is the last one in the list, so it goes to the end
+	 * of its priority list, which is where a full rebuild of the priority
+	 * lists would put it.
+	 */
+	if (wpa_config_add_prio_network(config, ssid) < 0)
+		wpa_config_update_prio_list(config);
 
 	return ssid;
 }
@@ -3081,6 +3195,9 @@ int wpa_config_remove_network(struct wpa_config *config, int id)
 	else
 		config->ssid = ssid->next;
 
+	if ((size_t) id < config->ssid_by_id_len &&
+	    config->ssid_by_id[id] == ssid)
+		config->ssid_by_id[id] = NULL;
 	wpa_config_update_prio_list(config);
 	wpa_config_free_ssid(ssid);
 	return 0;
@@ -4196,16 +4313,19 @@ char * wpa_config_get_cred_no_key(struct wpa_cred *cred, const char *var)
 
 struct wpa_cred * wpa_config_get_cred(struct wpa_config *config, int id)
 {
-	struct wpa_cred *cred;
+	struct wpa_cred *cred, *found = NULL;
 
-	cred = config->cred;
-	while (cred) {
-		if (id == cred->id)
-			break;
-		cred = cred->next;
+	if (id >= 0 && (size_t) id < config->cred_by_id_len &&
+	    config->cred_by_id[id])
+		return config->cred_by_id[id];
+
+	for (cred = config->cred; cred; cred = cred->next) {
+		wpa_config_index_cred(config, cred);
+		if (!found && id == cred->id)
+			found = cred;
 	}
 
-	return cred;
+	return found;
 }
 
 
@@ -4234,6 +4354,8 @@ struct wpa_cred * wpa_config_add_cred(struct wpa_config *config)
 	else
 		config->cred = cred;
 
+	wpa_config_index_cred(config, cred);
+
 	return cred;
 }
 
@@ -4258,6 +4380,9 @@ int wpa_config_remove_cred(struct wpa_config *config, int id)
 	else
 		config->cred = cred->next;
 
+	if ((size_t) id < config->cred_by_id_len &&
+	    config->cred_by_id[id] == cred)
+		config->cred_by_id[id] = NULL;
 	wpa_config_free_cred(cred);
 	return 0;
 }
@@ -5120,6 +5245,7 @@ static const struct global_parse_data global_fields[] = {
 	{ INT(dot11RSNAConfigSATimeout), 0 },
 #ifndef CONFIG_NO_CONFIG_WRITE
 	{ INT(update_config), 0 },
+	{ INT_RANGE(update_config_delay, 0, 60000), 0 },
 #endif /* CONFIG_NO_CONFIG_WRITE */
 	{ FUNC_NO_VAR(load_dynamic_eap), 0 },
 #ifdef CONFIG_WPS
@@ -441,6 +441,31 @@ struct wpa_config {
 	 */
 	struct wpa_cred *cred;
 
+	/**
+	 * ssid_by_id - Lookup table of networks indexed by network id
+	 *
+	 * This is maintained by wpa_config_add_network() and
+	 * wpa_config_remove_network(). Networks that have been linked to the
+	 * ssid list directly (e.g., when reading the configuration) are added
+	 * to the table on the first lookup that misses.
+	 */
+	struct wpa_ssid **ssid_by_id;
+
+	/**
+	 * ssid_by_id_len - Number of entries allocated for ssid_by_id
+	 */
+	size_t ssid_by_id_len;
+
+	/**
+	 * cred_by_id - Lookup table of credentials indexed by credential id
+	 */
+	struct wpa_cred **cred_by_id;
+
+	/**
+	 * cred_by_id_len - Number of entries allocated for cred_by_id
+	 */
+	size_t cred_by_id_len;
+
 	/**
 	 * eapol_version - IEEE 802.1X/EAPOL version number
 	 *
@@ -695,6 +720,17 @@ struct wpa_config {
 	 */
 	int update_config;
 
+	/**
+	 * update_config_delay - Delay for configuration updates in ms
+	 *
+	 * If this is non-zero, configuration updates triggered by internal
+	 * state changes (e.g., P2P persistent groups, WPS, DPP) are delayed by
+	 * this many milliseconds and the changes made within that time are
+	 * written with a single update. Explicit SAVE_CONFIG requests are
+	 * written immediately.
+	 */
+	int update_config_delay;
+
 	/**
 	 * blobs - Configuration blobs
 	 */
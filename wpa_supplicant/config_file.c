@@ -1121,6 +1121,9 @@ static void wpa_config_write_global(FILE *f, struct wpa_config *config)
 			config->dot11RSNAConfigSATimeout);
 	if (config->update_config)
 		fprintf(f, "update_config=%d\n", config->update_config);
+	if (config->update_config_delay)
+		fprintf(f, "update_config_delay=%d\n",
+			config->update_config_delay);
 #ifdef CONFIG_WPS
 	if (!is_nil_uuid(config->uuid)) {
 		char buf[40];
@@ -1561,43 +1564,15 @@ static void wpa_config_write_global(FILE *f, struct wpa_config *config)
 			config->wowlan_disconnect_on_deinit);
 }
 
-#endif /* CONFIG_NO_CONFIG_WRITE */
-
 
-int wpa_config_write(const char *name, struct wpa_config *config)
+static int wpa_config_write_all(FILE *f, struct wpa_config *config)
 {
-#ifndef CONFIG_NO_CONFIG_WRITE
-	FILE *f;
 	struct wpa_ssid *ssid;
 	struct wpa_cred *cred;
 #ifndef CONFIG_NO_CONFIG_BLOBS
 	struct wpa_config_blob *blob;
 #endif /* CONFIG_NO_CONFIG_BLOBS */
 	int ret = 0;
-	const char *orig_name = name;
-	int tmp_len;
-	char *tmp_name;
-
-	if (!name) {
-		wpa_printf(MSG_ERROR, "No configuration file for writing");
-		return -1;
-	}
-
-	tmp_len = os_strlen(name) + 5; /* allow space for .tmp suffix */
-	tmp_name = os_malloc(tmp_len);
-	if (tmp_name) {
-		os_snprintf(tmp_name, tmp_len, "%s.tmp", name);
-		name = tmp_name;
-	}
-
-	wpa_printf(MSG_DEBUG, "Writing configuration file '%s'", name);
-
-	f = fopen(name, "w");
-	if (f == NULL) {
-		wpa_printf(MSG_DEBUG, "Failed to open '%s' for writing", name);
-		os_free(tmp_name);
-		return -1;
-	}
 
 	wpa_config_write_global(f, config);
 
@@ -1631,6 +1606,88 @@ int wpa_config_write(const char *name, struct wpa_config *config)
 	}
 #endif /* CONFIG_NO_CONFIG_BLOBS */
 
+	return ret;
+}
+
+
+/*
+ * Serialize the configuration into memory and compare it with the current
+ * file so that an unchanged file does not need to be written, synced, and
+ * replaced.
+ */
+static bool wpa_config_file_unchanged(const char *name,
+				      struct wpa_config *config)
+{
+#ifdef _WIN32
+	return false;
+#else /* _WIN32 */
+	FILE *f;
+	char *new_data = NULL, *old_data;
+	size_t new_len = 0, old_len = 0;
+	bool same = false;
+	int ret;
+
+	f = open_memstream(&new_data, &new_len);
+	if (!f)
+		return false;
+	ret = wpa_config_write_all(f, config);
+	if (fclose(f) == 0 && ret == 0 && new_data) {
+		old_data = os_readfile(name, &old_len);
+		same = old_data && new_len == old_len &&
+			os_memcmp(new_data, old_data, new_len) == 0;
+		bin_clear_free(old_data, old_len);
+	}
+	if (new_data) {
+		/* Allocated by the C library, not with os_malloc() */
+		forced_memzero(new_data, new_len);
+		free(new_data);
+	}
+
+	return same;
+#endif /* _WIN32 */
+}
+
+#endif /* CONFIG_NO_CONFIG_WRITE */
+
+
+int wpa_config_write(const char *name, struct wpa_config *config)
+{
+#ifndef CONFIG_NO_CONFIG_WRITE
+	FILE *f;
+	int ret;
+	const char *orig_name = name;
+	int tmp_len;
+	char *tmp_name;
+
+	if (!name) {
+		wpa_printf(MSG_ERROR, "No configuration file for writing");
+		return -1;
+	}
+
+	if (wpa_config_file_unchanged(name, config)) {
+		wpa_printf(MSG_DEBUG, "Configuration file '%s' unchanged",
+			   name);
+		return 0;
+	}
+
+	tmp_len = os_strlen(name) + 5; /* allow space for .tmp suffix */
+	tmp_name = os_malloc(tmp_len);
+	if (tmp_name) {
+		os_snprintf(tmp_name, tmp_len, "%s.tmp", name);
+		name = tmp_name;
+	}
+
+	wpa_printf(MSG_DEBUG, "Writing configuration file '%s'", name);
+
+	f = fopen(name, "w");
+	if (f == NULL) {
+		wpa_printf(MSG_DEBUG, "Failed to open '%s' for writing", name);
+		os_free(tmp_name);
+		return -1;
+	}
+
+	ret = wpa_config_write_all(f, config);
+
 	os_fdatasync(f);
 
 	fclose(f);
@@ -3590,13 +3590,37 @@ static int wpa_supplicant_ctrl_iface_update_network(
 }
 
 
+static int wpa_supplicant_ctrl_iface_set_network_var(
+	struct wpa_supplicant *wpa_s, struct wpa_ssid *ssid,
+	char *name, char *value)
+{
+	int ret, prev_bssid_set, prev_disabled;
+	u8 prev_bssid[ETH_ALEN];
+
+	prev_bssid_set = ssid->bssid_set;
+	prev_disabled = ssid->disabled;
+	os_memcpy(prev_bssid, ssid->bssid, ETH_ALEN);
+	ret = wpa_supplicant_ctrl_iface_update_network(wpa_s, ssid, name,
+						       value);
+	if (ret == 0 &&
+	    (ssid->bssid_set != prev_bssid_set ||
+	     os_memcmp(ssid->bssid, prev_bssid, ETH_ALEN) != 0))
+		wpas_notify_network_bssid_set_changed(wpa_s, ssid);
+
+	if (prev_disabled != ssid->disabled &&
+	    (prev_disabled == 2 || ssid->disabled == 2))
+		wpas_notify_network_type_changed(wpa_s, ssid);
+
+	return ret;
+}
+
+
 static int wpa_supplicant_ctrl_iface_set_network(
 	struct wpa_supplicant *wpa_s, char *cmd)
 {
-	int id, ret, prev_bssid_set, prev_disabled;
+	int id;
 	struct wpa_ssid *ssid;
 	char *name, *value;
-	u8 prev_bssid[ETH_ALEN];
 
 	/* cmd: "<network id> <variable name> <value>" */
 	name = os_strchr(cmd, ' ');
@@ -3622,21 +3646,98 @@ static int wpa_supplicant_ctrl_iface_set_network(
 		return -1;
 	}
 
-	prev_bssid_set = ssid->bssid_set;
-	prev_disabled = ssid->disabled;
-	os_memcpy(prev_bssid, ssid->bssid, ETH_ALEN);
-	ret = wpa_supplicant_ctrl_iface_update_network(wpa_s, ssid, name,
-						       value);
-	if (ret == 0 &&
-	    (ssid->bssid_set != prev_bssid_set ||
-	     os_memcmp(ssid->bssid, prev_bssid, ETH_ALEN) != 0))
-		wpas_notify_network_bssid_set_changed(wpa_s, ssid);
+	return wpa_supplicant_ctrl_iface_set_network_var(wpa_s, ssid, name,
+							 value);
+}
 
-	if (prev_disabled != ssid->disabled &&
-	    (prev_disabled == 2 || ssid->disabled == 2))
-		wpas_notify_network_type_changed(wpa_s, ssid);
 
-	return ret;
+/*
+ * Add a batch of networks in one command. The networks are given as
+ * configuration file network blocks separated by newlines:
+ * network={
+ *	<variable>=<value>
+ *	...
+ * }
+ * The ids of the new networks are returned one per line. If any of the blocks
+ * is invalid, all networks added by the command are removed.
+ */
+static int wpa_supplicant_ctrl_iface_add_networks(
+	struct wpa_supplicant *wpa_s, char *cmd, char *buf, size_t buflen)
+{
+	struct wpa_ssid *ssid = NULL;
+	int *ids = NULL, *nids, num = 0, line = 0, i, ret;
+	char *pos, *end, *value, *rpos = buf;
+
+	for (pos = cmd; pos; pos = end) {
+		end = os_strchr(pos, '\n');
+		if (end)
+			*end++ = '\0';
+		line++;
+
+		while (*pos == ' ' || *pos == '\t')
+			pos++;
+		i = os_strlen(pos);
+		while (i > 0 && (pos[i - 1] == ' ' || pos[i - 1] == '\t' ||
+				 pos[i - 1] == '\r'))
+			pos[--i] = '\0';
+		if (*pos == '\0' || *pos == '#')
+			continue;
+
+		if (!ssid) {
+			if (os_strcmp(pos, "network={") != 0)
+				goto invalid;
+			nids = os_realloc_array(ids, num + 1, sizeof(int));
+			if (!nids)
+				goto fail;
+			ids = nids;
+			ssid = wpa_supplicant_add_network(wpa_s);
+			if (!ssid)
+				goto fail;
+			ids[num++] = ssid->id;
+			continue;
+		}
+
+		if (os_strcmp(pos, "}") == 0) {
+			ssid = NULL;
+			continue;
+		}
+
+		value = os_strchr(pos, '=');
+		if (!value)
+			goto invalid;
+		*value++ = '\0';
+		wpa_printf(MSG_DEBUG, "CTRL_IFACE: ADD_NETWORKS id=%d name='%s'",
+			   ssid->id, pos);
+		if (wpa_supplicant_ctrl_iface_set_network_var(wpa_s, ssid, pos,
+							      value) < 0)
+			goto invalid;
+	}
+
+	if (ssid || num == 0) {
+		wpa_printf(MSG_DEBUG,
+			   "CTRL_IFACE: ADD_NETWORKS: Incomplete network block");
+		goto fail;
+	}
+
+	for (i = 0; i < num; i++) {
+		ret = os_snprintf(rpos, buf + buflen - rpos, "%d\n", ids[i]);
+		if (os_snprintf_error(buf + buflen - rpos, ret))
+			goto fail;
+		rpos += ret;
+	}
+
+	wpa_printf(MSG_DEBUG, "CTRL_IFACE: ADD_NETWORKS added %d networks", num);
+	os_free(ids);
+	return rpos - buf;
+
+invalid:
+	wpa_printf(MSG_DEBUG, "CTRL_IFACE: ADD_NETWORKS: Invalid line %d",
+		   line);
+fail:
+	for (i = 0; i < num; i++)
+		wpa_supplicant_remove_network(wpa_s, ids[i]);
+	os_free(ids);
+	return -1;
 }
 
 
@@ -3949,7 +4050,7 @@ static int wpa_supplicant_ctrl_iface_save_config(struct wpa_supplicant *wpa_s)
 		return -1;
 	}
 
-	ret = wpa_config_write(wpa_s->confname, wpa_s->conf);
+	ret = wpas_save_config_now(wpa_s);
 	if (ret) {
 		wpa_printf(MSG_DEBUG, "CTRL_IFACE: SAVE_CONFIG - Failed to "
 			   "update configuration");
@@ -11769,15 +11870,22 @@ static int wpas_ctrl_iface_send_dscp_query(struct wpa_supplicant *wpa_s,
 }
 
 
+/* Compare the command in buf against a command name literal */
+#define CTRL_CMD(s) STR_HASH_MATCH(cmd_key, buf, s)
+
+
 char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 					 char *buf, size_t *resp_len)
 {
 	char *reply;
 	const int reply_size = 4096;
 	int reply_len;
+	size_t cmd_len = os_strlen(buf);
+	u32 cmd_key = STR_HASH_KEY(buf, cmd_len);
 
 	if (os_strncmp(buf, WPA_CTRL_RSP, os_strlen(WPA_CTRL_RSP)) == 0 ||
 	    os_strncmp(buf, "SET_NETWORK ", 12) == 0 ||
+	    os_strncmp(buf, "ADD_NETWORKS", 12) == 0 ||
 	    os_strncmp(buf, "PMKSA_ADD ", 10) == 0 ||
 	    os_strncmp(buf, "MESH_PMKSA_ADD ", 15) == 0) {
 		if (wpa_debug_show_keys)
@@ -11790,7 +11898,9 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 					   os_strlen(WPA_CTRL_RSP)) == 0 ?
 				WPA_CTRL_RSP :
 				(os_strncmp(buf, "SET_NETWORK ", 12) == 0 ?
-				 "SET_NETWORK" : "key-add"));
+				 "SET_NETWORK" :
+				 (os_strncmp(buf, "ADD_NETWORKS", 12) == 0 ?
+				  "ADD_NETWORKS" : "key-add")));
 	} else if (os_strncmp(buf, "WPS_NFC_TAG_READ", 16) == 0 ||
 		   os_strncmp(buf, "NFC_REPORT_HANDOVER", 19) == 0) {
 		wpa_hexdump_ascii_key(MSG_DEBUG, "RX ctrl_iface",
@@ -11809,10 +11919,10 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	os_memcpy(reply, "OK\n", 3);
 	reply_len = 3;
 
-	if (os_strcmp(buf, "PING") == 0) {
+	if (CTRL_CMD("PING")) {
 		os_memcpy(reply, "PONG\n", 5);
 		reply_len = 5;
-	} else if (os_strcmp(buf, "IFNAME") == 0) {
+	} else if (CTRL_CMD("IFNAME")) {
 		reply_len = os_strlen(wpa_s->ifname);
 		os_memcpy(reply, wpa_s->ifname, reply_len);
 	} else if (os_strncmp(buf, "RELOG", 5) == 0) {
@@ -11820,7 +11930,7 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 			reply_len = -1;
 	} else if (os_strncmp(buf, "NOTE ", 5) == 0) {
 		wpa_printf(MSG_INFO, "NOTE: %s", buf + 5);
-	} else if (os_strcmp(buf, "MIB") == 0) {
+	} else if (CTRL_CMD("MIB")) {
 		reply_len = wpa_sm_get_mib(wpa_s->wpa, reply, reply_size);
 		if (reply_len >= 0) {
 			reply_len += eapol_sm_get_mib(wpa_s->eapol,
@@ -11835,9 +11945,9 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	} else if (os_strncmp(buf, "STATUS", 6) == 0) {
 		reply_len = wpa_supplicant_ctrl_iface_status(
 			wpa_s, buf + 6, reply, reply_size);
-	} else if (os_strcmp(buf, "PMKSA") == 0) {
+	} else if (CTRL_CMD("PMKSA")) {
 		reply_len = wpas_ctrl_iface_pmksa(wpa_s, reply, reply_size);
-	} else if (os_strcmp(buf, "PMKSA_FLUSH") == 0) {
+	} else if (CTRL_CMD("PMKSA_FLUSH")) {
 		wpas_ctrl_iface_pmksa_flush(wpa_s);
 #ifdef CONFIG_PMKSA_CACHE_EXTERNAL
 	} else if (os_strncmp(buf, "PMKSA_GET ", 10) == 0) {
@@ -11864,16 +11974,16 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	} else if (os_strncmp(buf, "GET ", 4) == 0) {
 		reply_len = wpa_supplicant_ctrl_iface_get(wpa_s, buf + 4,
 							  reply, reply_size);
-	} else if (os_strcmp(buf, "LOGON") == 0) {
+	} else if (CTRL_CMD("LOGON")) {
 		eapol_sm_notify_logoff(wpa_s->eapol, false);
-	} else if (os_strcmp(buf, "LOGOFF") == 0) {
+	} else if (CTRL_CMD("LOGOFF")) {
 		eapol_sm_notify_logoff(wpa_s->eapol, true);
-	} else if (os_strcmp(buf, "REASSOCIATE") == 0) {
+	} else if (CTRL_CMD("REASSOCIATE")) {
 		if (wpa_s->wpa_state == WPA_INTERFACE_DISABLED)
 			reply_len = -1;
 		else
 			wpas_request_connection(wpa_s);
-	} else if (os_strcmp(buf, "REATTACH") == 0) {
+	} else if (CTRL_CMD("REATTACH")) {
 		if (wpa_s->wpa_state == WPA_INTERFACE_DISABLED ||
 		    !wpa_s->current_ssid)
 			reply_len = -1;
@@ -11881,7 +11991,7 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 			wpa_s->reattach = 1;
 			wpas_request_connection(wpa_s);
 		}
-	} else if (os_strcmp(buf, "RECONNECT") == 0) {
+	} else if (CTRL_CMD("RECONNECT")) {
 		if (wpa_s->wpa_state == WPA_INTERFACE_DISABLED)
 			reply_len = -1;
 		else if (wpa_s->disconnected)
@@ -11897,7 +12007,7 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 			reply_len = -1;
 #endif /* CONFIG_IEEE80211R */
 #ifdef CONFIG_WPS
-	} else if (os_strcmp(buf, "WPS_PBC") == 0) {
+	} else if (CTRL_CMD("WPS_PBC")) {
 		int res = wpa_supplicant_ctrl_iface_wps_pbc(wpa_s, NULL);
 		if (res == -2) {
 			os_memcpy(reply, "FAIL-PBC-OVERLAP\n", 17);
@@ -11918,11 +12028,11 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	} else if (os_strncmp(buf, "WPS_CHECK_PIN ", 14) == 0) {
 		reply_len = wpa_supplicant_ctrl_iface_wps_check_pin(
 			wpa_s, buf + 14, reply, reply_size);
-	} else if (os_strcmp(buf, "WPS_CANCEL") == 0) {
+	} else if (CTRL_CMD("WPS_CANCEL")) {
 		if (wpas_wps_cancel(wpa_s))
 			reply_len = -1;
 #ifdef CONFIG_WPS_NFC
-	} else if (os_strcmp(buf, "WPS_NFC") == 0) {
+	} else if (CTRL_CMD("WPS_NFC")) {
 		if (wpa_supplicant_ctrl_iface_wps_nfc(wpa_s, NULL))
 			reply_len = -1;
 	} else if (os_strncmp(buf, "WPS_NFC ", 8) == 0) {
@@ -11957,13 +12067,13 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 			wpa_s, buf + 11, reply, reply_size);
 #endif /* CONFIG_AP */
 #ifdef CONFIG_WPS_ER
-	} else if (os_strcmp(buf, "WPS_ER_START") == 0) {
+	} else if (CTRL_CMD("WPS_ER_START")) {
 		if (wpas_wps_er_start(wpa_s, NULL))
 			reply_len = -1;
 	} else if (os_strncmp(buf, "WPS_ER_START ", 13) == 0) {
 		if (wpas_wps_er_start(wpa_s, buf + 13))
 			reply_len = -1;
-	} else if (os_strcmp(buf, "WPS_ER_STOP") == 0) {
+	} else if (CTRL_CMD("WPS_ER_STOP")) {
 		wpas_wps_er_stop(wpa_s);
 	} else if (os_strncmp(buf, "WPS_ER_PIN ", 11) == 0) {
 		if (wpa_supplicant_ctrl_iface_wps_er_pin(wpa_s, buf + 11))
@@ -12007,7 +12117,7 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	} else if (os_strncmp(buf, "MESH_INTERFACE_ADD ", 19) == 0) {
 		reply_len = wpa_supplicant_ctrl_iface_mesh_interface_add(
 			wpa_s, buf + 19, reply, reply_size);
-	} else if (os_strcmp(buf, "MESH_INTERFACE_ADD") == 0) {
+	} else if (CTRL_CMD("MESH_INTERFACE_ADD")) {
 		reply_len = wpa_supplicant_ctrl_iface_mesh_interface_add(
 			wpa_s, "", reply, reply_size);
 	} else if (os_strncmp(buf, "MESH_GROUP_ADD ", 15) == 0) {
@@ -12031,10 +12141,10 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	} else if (os_strncmp(buf, "P2P_FIND ", 9) == 0) {
 		if (p2p_ctrl_find(wpa_s, buf + 8))
 			reply_len = -1;
-	} else if (os_strcmp(buf, "P2P_FIND") == 0) {
+	} else if (CTRL_CMD("P2P_FIND")) {
 		if (p2p_ctrl_find(wpa_s, ""))
 			reply_len = -1;
-	} else if (os_strcmp(buf, "P2P_STOP_FIND") == 0) {
+	} else if (CTRL_CMD("P2P_STOP_FIND")) {
 		wpas_p2p_stop_find(wpa_s);
 	} else if (os_strncmp(buf, "P2P_ASP_PROVISION ", 18) == 0) {
 		if (p2p_ctrl_asp_provision(wpa_s, buf + 18))
@@ -12048,13 +12158,13 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	} else if (os_strncmp(buf, "P2P_LISTEN ", 11) == 0) {
 		if (p2p_ctrl_listen(wpa_s, buf + 11))
 			reply_len = -1;
-	} else if (os_strcmp(buf, "P2P_LISTEN") == 0) {
+	} else if (CTRL_CMD("P2P_LISTEN")) {
 		if (p2p_ctrl_listen(wpa_s, ""))
 			reply_len = -1;
 	} else if (os_strncmp(buf, "P2P_GROUP_REMOVE ", 17) == 0) {
 		if (wpas_p2p_group_remove(wpa_s, buf + 17))
 			reply_len = -1;
-	} else if (os_strcmp(buf, "P2P_GROUP_ADD") == 0) {
+	} else if (CTRL_CMD("P2P_GROUP_ADD")) {
 		if (p2p_ctrl_group_add(wpa_s, ""))
 			reply_len = -1;
 	} else if (os_strncmp(buf, "P2P_GROUP_ADD ", 14) == 0) {
@@ -12066,7 +12176,7 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	} else if (os_strncmp(buf, "P2P_PROV_DISC ", 14) == 0) {
 		if (p2p_ctrl_prov_disc(wpa_s, buf + 14))
 			reply_len = -1;
-	} else if (os_strcmp(buf, "P2P_GET_PASSPHRASE") == 0) {
+	} else if (CTRL_CMD("P2P_GET_PASSPHRASE")) {
 		reply_len = p2p_get_passphrase(wpa_s, reply, reply_size);
 	} else if (os_strncmp(buf, "P2P_SERV_DISC_REQ ", 18) == 0) {
 		reply_len = p2p_ctrl_serv_disc_req(wpa_s, buf + 18, reply,
@@ -12077,12 +12187,12 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	} else if (os_strncmp(buf, "P2P_SERV_DISC_RESP ", 19) == 0) {
 		if (p2p_ctrl_serv_disc_resp(wpa_s, buf + 19) < 0)
 			reply_len = -1;
-	} else if (os_strcmp(buf, "P2P_SERVICE_UPDATE") == 0) {
+	} else if (CTRL_CMD("P2P_SERVICE_UPDATE")) {
 		wpas_p2p_sd_service_update(wpa_s);
 	} else if (os_strncmp(buf, "P2P_SERV_DISC_EXTERNAL ", 23) == 0) {
 		if (p2p_ctrl_serv_disc_external(wpa_s, buf + 23) < 0)
 			reply_len = -1;
-	} else if (os_strcmp(buf, "P2P_SERVICE_FLUSH") == 0) {
+	} else if (CTRL_CMD("P2P_SERVICE_FLUSH")) {
 		wpas_p2p_service_flush(wpa_s);
 	} else if (os_strncmp(buf, "P2P_SERVICE_ADD ", 16) == 0) {
 		if (p2p_ctrl_service_add(wpa_s, buf + 16) < 0)
@@ -12105,24 +12215,24 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	} else if (os_strncmp(buf, "P2P_SET ", 8) == 0) {
 		if (p2p_ctrl_set(wpa_s, buf + 8) < 0)
 			reply_len = -1;
-	} else if (os_strcmp(buf, "P2P_FLUSH") == 0) {
+	} else if (CTRL_CMD("P2P_FLUSH")) {
 		p2p_ctrl_flush(wpa_s);
 	} else if (os_strncmp(buf, "P2P_UNAUTHORIZE ", 16) == 0) {
 		if (wpas_p2p_unauthorize(wpa_s, buf + 16) < 0)
 			reply_len = -1;
-	} else if (os_strcmp(buf, "P2P_CANCEL") == 0) {
+	} else if (CTRL_CMD("P2P_CANCEL")) {
 		if (wpas_p2p_cancel(wpa_s))
 			reply_len = -1;
 	} else if (os_strncmp(buf, "P2P_PRESENCE_REQ ", 17) == 0) {
 		if (p2p_ctrl_presence_req(wpa_s, buf + 17) < 0)
 			reply_len = -1;
-	} else if (os_strcmp(buf, "P2P_PRESENCE_REQ") == 0) {
+	} else if (CTRL_CMD("P2P_PRESENCE_REQ")) {
 		if (p2p_ctrl_presence_req(wpa_s, "") < 0)
 			reply_len = -1;
 	} else if (os_strncmp(buf, "P2P_EXT_LISTEN ", 15) == 0) {
 		if (p2p_ctrl_ext_listen(wpa_s, buf + 15) < 0)
 			reply_len = -1;
-	} else if (os_strcmp(buf, "P2P_EXT_LISTEN") == 0) {
+	} else if (CTRL_CMD("P2P_EXT_LISTEN")) {
 		if (p2p_ctrl_ext_listen(wpa_s, "") < 0)
 			reply_len = -1;
 	} else if (os_strncmp(buf, "P2P_REMOVE_CLIENT ", 18) == 0) {
@@ -12131,7 +12241,7 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	} else if (os_strncmp(buf, "P2P_LO_START ", 13) == 0) {
 		if (p2p_ctrl_iface_p2p_lo_start(wpa_s, buf + 13))
 			reply_len = -1;
-	} else if (os_strcmp(buf, "P2P_LO_STOP") == 0) {
+	} else if (CTRL_CMD("P2P_LO_STOP")) {
 		if (wpas_p2p_lo_stop(wpa_s))
 			reply_len = -1;
 #endif /* CONFIG_P2P */
@@ -12144,12 +12254,12 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 						     reply, reply_size);
 #endif /* CONFIG_WIFI_DISPLAY */
 #ifdef CONFIG_INTERWORKING
-	} else if (os_strcmp(buf, "FETCH_ANQP") == 0) {
+	} else if (CTRL_CMD("FETCH_ANQP")) {
 		if (interworking_fetch_anqp(wpa_s) < 0)
 			reply_len = -1;
-	} else if (os_strcmp(buf, "STOP_FETCH_ANQP") == 0) {
+	} else if (CTRL_CMD("STOP_FETCH_ANQP")) {
 		interworking_stop_fetch_anqp(wpa_s);
-	} else if (os_strcmp(buf, "INTERWORKING_SELECT") == 0) {
+	} else if (CTRL_CMD("INTERWORKING_SELECT")) {
 		if (ctrl_interworking_select(wpa_s, NULL) < 0)
 			reply_len = -1;
 	} else if (os_strncmp(buf, "INTERWORKING_SELECT ", 20) == 0) {
@@ -12197,13 +12307,13 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	} else if (os_strncmp(buf, "DEL_HS20_ICON ", 14) == 0) {
 		if (del_hs20_icon(wpa_s, buf + 14) < 0)
 			reply_len = -1;
-	} else if (os_strcmp(buf, "FETCH_OSU") == 0) {
+	} else if (CTRL_CMD("FETCH_OSU")) {
 		if (hs20_fetch_osu(wpa_s, 0) < 0)
 			reply_len = -1;
-	} else if (os_strcmp(buf, "FETCH_OSU no-scan") == 0) {
+	} else if (CTRL_CMD("FETCH_OSU no-scan")) {
 		if (hs20_fetch_osu(wpa_s, 1) < 0)
 			reply_len = -1;
-	} else if (os_strcmp(buf, "CANCEL_FETCH_OSU") == 0) {
+	} else if (CTRL_CMD("CANCEL_FETCH_OSU")) {
 		hs20_cancel_fetch_osu(wpa_s);
 #endif /* CONFIG_HS20 */
 	} else if (os_strncmp(buf, WPA_CTRL_RSP, os_strlen(WPA_CTRL_RSP)) == 0)
@@ -12219,10 +12329,10 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 			eloop_register_timeout(0, 0, wpas_ctrl_eapol_response,
 					       wpa_s, NULL);
 		}
-	} else if (os_strcmp(buf, "RECONFIGURE") == 0) {
+	} else if (CTRL_CMD("RECONFIGURE")) {
 		if (wpa_supplicant_reload_configuration(wpa_s))
 			reply_len = -1;
-	} else if (os_strcmp(buf, "TERMINATE") == 0) {
+	} else if (CTRL_CMD("TERMINATE")) {
 		wpa_supplicant_terminate_proc(wpa_s->global);
 	} else if (os_strncmp(buf, "BSSID ", 6) == 0) {
 		if (wpa_supplicant_ctrl_iface_bssid(wpa_s, buf + 6))
@@ -12240,19 +12350,19 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	} else if (os_strncmp(buf, "LIST_NETWORKS ", 14) == 0) {
 		reply_len = wpa_supplicant_ctrl_iface_list_networks(
 			wpa_s, buf + 14, reply, reply_size);
-	} else if (os_strcmp(buf, "LIST_NETWORKS") == 0) {
+	} else if (CTRL_CMD("LIST_NETWORKS")) {
 		reply_len = wpa_supplicant_ctrl_iface_list_networks(
 			wpa_s, NULL, reply, reply_size);
-	} else if (os_strcmp(buf, "DISCONNECT") == 0) {
+	} else if (CTRL_CMD("DISCONNECT")) {
 		wpas_request_disconnection(wpa_s);
-	} else if (os_strcmp(buf, "SCAN") == 0) {
+	} else if (CTRL_CMD("SCAN")) {
 		wpas_ctrl_scan(wpa_s, NULL, reply, reply_size, &reply_len);
 	} else if (os_strncmp(buf, "SCAN ", 5) == 0) {
 		wpas_ctrl_scan(wpa_s, buf + 5, reply, reply_size, &reply_len);
-	} else if (os_strcmp(buf, "SCAN_RESULTS") == 0) {
+	} else if (CTRL_CMD("SCAN_RESULTS")) {
 		reply_len = wpa_supplicant_ctrl_iface_scan_results(
 			wpa_s, reply, reply_size);
-	} else if (os_strcmp(buf, "ABORT_SCAN") == 0) {
+	} else if (CTRL_CMD("ABORT_SCAN")) {
 		if (wpas_abort_ongoing_scan(wpa_s) < 0)
 			reply_len = -1;
 	} else if (os_strncmp(buf, "SELECT_NETWORK ", 15) == 0) {
@@ -12264,9 +12374,13 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	} else if (os_strncmp(buf, "DISABLE_NETWORK ", 16) == 0) {
 		if (wpa_supplicant_ctrl_iface_disable_network(wpa_s, buf + 16))
 			reply_len = -1;
-	} else if (os_strcmp(buf, "ADD_NETWORK") == 0) {
+	} else if (CTRL_CMD("ADD_NETWORK")) {
 		reply_len = wpa_supplicant_ctrl_iface_add_network(
 			wpa_s, reply, reply_size);
+	} else if (os_strncmp(buf, "ADD_NETWORKS", 12) == 0 &&
+		   (buf[12] == ' ' || buf[12] == '\n')) {
+		reply_len = wpa_supplicant_ctrl_iface_add_networks(
+			wpa_s, buf + 13, reply, reply_size);
 	} else if (os_strncmp(buf, "REMOVE_NETWORK ", 15) == 0) {
 		if (wpa_supplicant_ctrl_iface_remove_network(wpa_s, buf + 15))
 			reply_len = -1;
@@ -12280,10 +12394,10 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 		if (wpa_supplicant_ctrl_iface_dup_network(wpa_s, buf + 12,
 							  wpa_s))
 			reply_len = -1;
-	} else if (os_strcmp(buf, "LIST_CREDS") == 0) {
+	} else if (CTRL_CMD("LIST_CREDS")) {
 		reply_len = wpa_supplicant_ctrl_iface_list_creds(
 			wpa_s, reply, reply_size);
-	} else if (os_strcmp(buf, "ADD_CRED") == 0) {
+	} else if (CTRL_CMD("ADD_CRED")) {
 		reply_len = wpa_supplicant_ctrl_iface_add_cred(
 			wpa_s, reply, reply_size);
 	} else if (os_strncmp(buf, "REMOVE_CRED ", 12) == 0) {
@@ -12297,7 +12411,7 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 							       reply,
 							       reply_size);
 #ifndef CONFIG_NO_CONFIG_WRITE
-	} else if (os_strcmp(buf, "SAVE_CONFIG") == 0) {
+	} else if (CTRL_CMD("SAVE_CONFIG")) {
 		if (wpa_supplicant_ctrl_iface_save_config(wpa_s))
 			reply_len = -1;
 #endif /* CONFIG_NO_CONFIG_WRITE */
@@ -12310,7 +12424,7 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	} else if (os_strncmp(buf, "SCAN_INTERVAL ", 14) == 0) {
 		if (wpa_supplicant_ctrl_iface_scan_interval(wpa_s, buf + 14))
 			reply_len = -1;
-	} else if (os_strcmp(buf, "INTERFACE_LIST") == 0) {
+	} else if (CTRL_CMD("INTERFACE_LIST")) {
 		reply_len = wpa_supplicant_global_iface_list(
 			wpa_s->global, reply, reply_size);
 	} else if (os_strncmp(buf, "INTERFACES", 10) == 0) {
@@ -12320,7 +12434,7 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 		reply_len = wpa_supplicant_ctrl_iface_bss(
 			wpa_s, buf + 4, reply, reply_size);
 #ifdef CONFIG_AP
-	} else if (os_strcmp(buf, "STA-FIRST") == 0) {
+	} else if (CTRL_CMD("STA-FIRST")) {
 		reply_len = ap_ctrl_iface_sta_first(wpa_s, reply, reply_size);
 	} else if (os_strncmp(buf, "STA ", 4) == 0) {
 		reply_len = ap_ctrl_iface_sta(wpa_s, buf + 4, reply,
@@ -12337,19 +12451,19 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	} else if (os_strncmp(buf, "CHAN_SWITCH ", 12) == 0) {
 		if (ap_ctrl_iface_chanswitch(wpa_s, buf + 12))
 			reply_len = -1;
-	} else if (os_strcmp(buf, "STOP_AP") == 0) {
+	} else if (CTRL_CMD("STOP_AP")) {
 		if (wpas_ap_stop_ap(wpa_s))
 			reply_len = -1;
-	} else if (os_strcmp(buf, "UPDATE_BEACON") == 0) {
+	} else if (CTRL_CMD("UPDATE_BEACON")) {
 		if (wpas_ap_update_beacon(wpa_s))
 			reply_len = -1;
 #endif /* CONFIG_AP */
-	} else if (os_strcmp(buf, "SUSPEND") == 0) {
+	} else if (CTRL_CMD("SUSPEND")) {
 		wpas_notify_suspend(wpa_s->global);
-	} else if (os_strcmp(buf, "RESUME") == 0) {
+	} else if (CTRL_CMD("RESUME")) {
 		wpas_notify_resume(wpa_s->global);
 #ifdef CONFIG_TESTING_OPTIONS
-	} else if (os_strcmp(buf, "DROP_SA") == 0) {
+	} else if (CTRL_CMD("DROP_SA")) {
 		wpa_supplicant_ctrl_iface_drop_sa(wpa_s);
 #endif /* CONFIG_TESTING_OPTIONS */
 	} else if (os_strncmp(buf, "ROAM ", 5) == 0) {
@@ -12388,7 +12502,7 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 		reply_len = wpa_supplicant_ctrl_iface_tdls_link_status(
 			wpa_s, buf + 17, reply, reply_size);
 #endif /* CONFIG_TDLS */
-	} else if (os_strcmp(buf, "WMM_AC_STATUS") == 0) {
+	} else if (CTRL_CMD("WMM_AC_STATUS")) {
 		reply_len = wpas_wmm_ac_status(wpa_s, reply, reply_size);
 	} else if (os_strncmp(buf, "WMM_AC_ADDTS ", 13) == 0) {
 		if (wmm_ac_ctrl_addts(wpa_s, buf + 13))
@@ -12410,10 +12524,10 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 		if (wpa_supplicant_ctrl_iface_autoscan(wpa_s, buf + 9))
 			reply_len = -1;
 #endif /* CONFIG_AUTOSCAN */
-	} else if (os_strcmp(buf, "DRIVER_FLAGS") == 0) {
+	} else if (CTRL_CMD("DRIVER_FLAGS")) {
 		reply_len = wpas_ctrl_iface_driver_flags(wpa_s, reply,
 							 reply_size);
-	} else if (os_strcmp(buf, "DRIVER_FLAGS2") == 0) {
+	} else if (CTRL_CMD("DRIVER_FLAGS2")) {
 		reply_len = wpas_ctrl_iface_driver_flags2(wpa_s, reply,
 							  reply_size);
 #ifdef ANDROID
@@ -12429,7 +12543,7 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	} else if (os_strncmp(buf, "VENDOR ", 7) == 0) {
 		reply_len = wpa_supplicant_vendor_cmd(wpa_s, buf + 7, reply,
 						      reply_size);
-	} else if (os_strcmp(buf, "REAUTHENTICATE") == 0) {
+	} else if (CTRL_CMD("REAUTHENTICATE")) {
 		pmksa_cache_clear_current(wpa_s->wpa);
 		eapol_sm_request_reauth(wpa_s->eapol);
 #ifdef CONFIG_WNM
@@ -12443,7 +12557,7 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 		if (wpas_ctrl_iface_coloc_intf_report(wpa_s, buf + 18))
 			reply_len = -1;
 #endif /* CONFIG_WNM */
-	} else if (os_strcmp(buf, "FLUSH") == 0) {
+	} else if (CTRL_CMD("FLUSH")) {
 		wpa_supplicant_ctrl_iface_flush(wpa_s);
 	} else if (os_strncmp(buf, "RADIO_WORK ", 11) == 0) {
 		reply_len = wpas_ctrl_radio_work(wpa_s, buf + 11, reply,
@@ -12452,7 +12566,7 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	} else if (os_strncmp(buf, "MGMT_TX ", 8) == 0) {
 		if (wpas_ctrl_iface_mgmt_tx(wpa_s, buf + 8) < 0)
 			reply_len = -1;
-	} else if (os_strcmp(buf, "MGMT_TX_DONE") == 0) {
+	} else if (CTRL_CMD("MGMT_TX_DONE")) {
 		wpas_ctrl_iface_mgmt_tx_done(wpa_s);
 	} else if (os_strncmp(buf, "MGMT_RX_PROCESS ", 16) == 0) {
 		if (wpas_ctrl_iface_mgmt_rx_process(wpa_s, buf + 16) < 0)
@@ -12478,12 +12592,12 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	} else if (os_strncmp(buf, "TEST_ALLOC_FAIL ", 16) == 0) {
 		if (wpas_ctrl_test_alloc_fail(wpa_s, buf + 16) < 0)
 			reply_len = -1;
-	} else if (os_strcmp(buf, "GET_ALLOC_FAIL") == 0) {
+	} else if (CTRL_CMD("GET_ALLOC_FAIL")) {
 		reply_len = wpas_ctrl_get_alloc_fail(wpa_s, reply, reply_size);
 	} else if (os_strncmp(buf, "TEST_FAIL ", 10) == 0) {
 		if (wpas_ctrl_test_fail(wpa_s, buf + 10) < 0)
 			reply_len = -1;
-	} else if (os_strcmp(buf, "GET_FAIL") == 0) {
+	} else if (CTRL_CMD("GET_FAIL")) {
 		reply_len = wpas_ctrl_get_fail(wpa_s, reply, reply_size);
 	} else if (os_strncmp(buf, "EVENT_TEST ", 11) == 0) {
 		if (wpas_ctrl_event_test(wpa_s, buf + 11) < 0)
@@ -12491,16 +12605,16 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	} else if (os_strncmp(buf, "TEST_ASSOC_IE ", 14) == 0) {
 		if (wpas_ctrl_test_assoc_ie(wpa_s, buf + 14) < 0)
 			reply_len = -1;
-	} else if (os_strcmp(buf, "RESET_PN") == 0) {
+	} else if (CTRL_CMD("RESET_PN")) {
 		if (wpas_ctrl_reset_pn(wpa_s) < 0)
 			reply_len = -1;
 	} else if (os_strncmp(buf, "KEY_REQUEST ", 12) == 0) {
 		if (wpas_ctrl_key_request(wpa_s, buf + 12) < 0)
 			reply_len = -1;
-	} else if (os_strcmp(buf, "RESEND_ASSOC") == 0) {
+	} else if (CTRL_CMD("RESEND_ASSOC")) {
 		if (wpas_ctrl_resend_assoc(wpa_s) < 0)
 			reply_len = -1;
-	} else if (os_strcmp(buf, "UNPROT_DEAUTH") == 0) {
+	} else if (CTRL_CMD("UNPROT_DEAUTH")) {
 		sme_event_unprot_disconnect(
 			wpa_s, wpa_s->bssid, NULL,
 			WLAN_REASON_CLASS2_FRAME_FROM_NONAUTH_STA);
@@ -12508,7 +12622,7 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	} else if (os_strncmp(buf, "TWT_SETUP ", 10) == 0) {
 		if (wpas_ctrl_iface_send_twt_setup(wpa_s, buf + 9))
 			reply_len = -1;
-	} else if (os_strcmp(buf, "TWT_SETUP") == 0) {
+	} else if (CTRL_CMD("TWT_SETUP")) {
 		if (wpas_ctrl_iface_send_twt_setup(wpa_s, ""))
 			reply_len = -1;
 #ifdef CONFIG_DRIVER_NL80211_IFX
@@ -12517,13 +12631,13 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 			reply_len = -1;
 	} else if (os_strncmp(buf, "WNM_MAXIDLE ", 12) == 0) {
 		reply_len = wpas_ctrl_iface_send_wnm_maxidle(wpa_s, buf + 11, reply, reply_size);
-	} else if (os_strcmp(buf, "WNM_MAXIDLE") == 0) {
+	} else if (CTRL_CMD("WNM_MAXIDLE")) {
 		reply_len = wpas_ctrl_iface_send_wnm_maxidle(wpa_s, NULL, reply, reply_size);
 #endif /* CONFIG_DRIVER_NL80211_IFX */
 	} else if (os_strncmp(buf, "TWT_TEARDOWN ", 13) == 0) {
 		if (wpas_ctrl_iface_send_twt_teardown(wpa_s, buf + 12))
 			reply_len = -1;
-	} else if (os_strcmp(buf, "TWT_TEARDOWN") == 0) {
+	} else if (CTRL_CMD("TWT_TEARDOWN")) {
 		if (wpas_ctrl_iface_send_twt_teardown(wpa_s, ""))
 			reply_len = -1;
 	} else if (os_strncmp(buf, "VENDOR_ELEM_ADD ", 16) == 0) {
@@ -12538,7 +12652,7 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	} else if (os_strncmp(buf, "NEIGHBOR_REP_REQUEST", 20) == 0) {
 		if (wpas_ctrl_iface_send_neighbor_rep(wpa_s, buf + 20))
 			reply_len = -1;
-	} else if (os_strcmp(buf, "ERP_FLUSH") == 0) {
+	} else if (CTRL_CMD("ERP_FLUSH")) {
 		wpas_ctrl_iface_erp_flush(wpa_s);
 	} else if (os_strncmp(buf, "MAC_RAND_SCAN ", 14) == 0) {
 		if (wpas_ctrl_iface_mac_rand_scan(wpa_s, buf + 14))
@@ -12550,7 +12664,7 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	} else if (os_strncmp(buf, "FILS_HLP_REQ_ADD ", 17) == 0) {
 		if (wpas_ctrl_iface_fils_hlp_req_add(wpa_s, buf + 17))
 			reply_len = -1;
-	} else if (os_strcmp(buf, "FILS_HLP_REQ_FLUSH") == 0) {
+	} else if (CTRL_CMD("FILS_HLP_REQ_FLUSH")) {
 		wpas_flush_fils_hlp_req(wpa_s);
 #endif /* CONFIG_FILS */
 #ifdef CONFIG_DPP
@@ -12636,7 +12750,7 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	} else if (os_strncmp(buf, "DPP_LISTEN ", 11) == 0) {
 		if (wpas_dpp_listen(wpa_s, buf + 11) < 0)
 			reply_len = -1;
-	} else if (os_strcmp(buf, "DPP_STOP_LISTEN") == 0) {
+	} else if (CTRL_CMD("DPP_STOP_LISTEN")) {
 		wpas_dpp_stop(wpa_s);
 		wpas_dpp_listen_stop(wpa_s);
 	} else if (os_strncmp(buf, "DPP_CONFIGURATOR_ADD", 20) == 0) {
@@ -12678,15 +12792,15 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	} else if (os_strncmp(buf, "DPP_CONTROLLER_START ", 21) == 0) {
 		if (wpas_dpp_controller_start(wpa_s, buf + 20) < 0)
 			reply_len = -1;
-	} else if (os_strcmp(buf, "DPP_CONTROLLER_START") == 0) {
+	} else if (CTRL_CMD("DPP_CONTROLLER_START")) {
 		if (wpas_dpp_controller_start(wpa_s, NULL) < 0)
 			reply_len = -1;
-	} else if (os_strcmp(buf, "DPP_CONTROLLER_STOP") == 0) {
+	} else if (CTRL_CMD("DPP_CONTROLLER_STOP")) {
 		dpp_controller_stop(wpa_s->dpp);
 	} else if (os_strncmp(buf, "DPP_CHIRP ", 10) == 0) {
 		if (wpas_dpp_chirp(wpa_s, buf + 9) < 0)
 			reply_len = -1;
-	} else if (os_strcmp(buf, "DPP_STOP_CHIRP") == 0) {
+	} else if (CTRL_CMD("DPP_STOP_CHIRP")) {
 		wpas_dpp_chirp_stop(wpa_s);
 	} else if (os_strncmp(buf, "DPP_RECONFIG ", 13) == 0) {
 		if (wpas_dpp_reconfig(wpa_s, buf + 13) < 0)
@@ -12703,9 +12817,9 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	} else if (os_strncmp(buf, "PASN_START ", 11) == 0) {
 		if (wpas_ctrl_iface_pasn_start(wpa_s, buf + 11) < 0)
 			reply_len = -1;
-	} else if (os_strcmp(buf, "PASN_STOP") == 0) {
+	} else if (CTRL_CMD("PASN_STOP")) {
 		wpas_pasn_auth_stop(wpa_s);
-	} else if (os_strcmp(buf, "PTKSA_CACHE_LIST") == 0) {
+	} else if (CTRL_CMD("PTKSA_CACHE_LIST")) {
 		reply_len = ptksa_cache_list(wpa_s->ptksa, reply, reply_size);
 	} else if (os_strncmp(buf, "PASN_DEAUTH ", 12) == 0) {
 		if (wpas_ctrl_iface_pasn_deauthenticate(wpa_s, buf + 12) < 0)
@@ -13204,7 +13318,7 @@ static int wpas_global_ctrl_iface_save_config(struct wpa_global *global)
 			continue;
 		}
 
-		if (wpa_config_write(wpa_s->confname, wpa_s->conf)) {
+		if (wpas_save_config_now(wpa_s)) {
 			wpa_dbg(wpa_s, MSG_DEBUG, "CTRL_IFACE: SAVE_CONFIG - Failed to update configuration");
 			ret = 1;
 		} else {
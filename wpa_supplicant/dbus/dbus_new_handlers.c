@@ -2888,7 +2888,7 @@ DBusMessage * wpas_dbus_handler_save_config(DBusMessage *message,
 			"Not allowed to update configuration (update_config=0)");
 	}
 
-	ret = wpa_config_write(wpa_s->confname, wpa_s->conf);
+	ret = wpas_save_config_now(wpa_s);
 	if (ret)
 		return wpas_dbus_error_unknown_error(
 			message, "Failed to update configuration");
@@ -33,6 +33,7 @@
 #include "common/ptksa_cache.h"
 #include "crypto/random.h"
 #include "bssid_ignore.h"
+#include "ssid_index.h"
 #include "wpas_glue.h"
 #include "wps_supplicant.h"
 #include "ibss_rsn.h"
@@ -1469,10 +1470,11 @@ skip_assoc_disallow:
 }
 
 
-struct wpa_ssid * wpa_scan_res_match(struct wpa_supplicant *wpa_s,
-				     int i, struct wpa_bss *bss,
-				     struct wpa_ssid *group,
-				     int only_first_ssid, int debug_print)
+static struct wpa_ssid *
+wpa_scan_res_match_index(struct wpa_supplicant *wpa_s, int i,
+			 struct wpa_bss *bss, struct wpa_ssid *group,
+			 int only_first_ssid, int debug_print,
+			 const struct wpa_ssid_index *idx, int idx_group)
 {
 	u8 wpa_ie_len, rsn_ie_len;
 	const u8 *ie;
@@ -1558,6 +1560,21 @@ struct wpa_ssid * wpa_scan_res_match(struct wpa_supplicant *wpa_s,
 		return NULL;
 	}
 
+	if (idx && idx_group >= 0 && !only_first_ssid) {
+		struct wpa_ssid_index_iter iter;
+
+		/* Only check the networks that could match the SSID */
+		wpa_ssid_index_iter_init(&iter, idx, idx_group, match_ssid,
+					 match_ssid_len);
+		while ((ssid = wpa_ssid_index_iter_next(&iter))) {
+			if (wpa_scan_res_ok(wpa_s, ssid, match_ssid,
+					    match_ssid_len, bss,
+					    bssid_ignore_count, debug_print))
+				return ssid;
+		}
+		return NULL;
+	}
+
 	for (ssid = group; ssid; ssid = only_first_ssid ? NULL : ssid->pnext) {
 		if (wpa_scan_res_ok(wpa_s, ssid, match_ssid, match_ssid_len,
 				    bss, bssid_ignore_count, debug_print))
@@ -1569,13 +1586,25 @@ struct wpa_ssid * wpa_scan_res_match(struct wpa_supplicant *wpa_s,
 }
 
 
+struct wpa_ssid * wpa_scan_res_match(struct wpa_supplicant *wpa_s,
+				     int i, struct wpa_bss *bss,
+				     struct wpa_ssid *group,
+				     int only_first_ssid, int debug_print)
+{
+	return wpa_scan_res_match_index(wpa_s, i, bss, group, only_first_ssid,
+					debug_print, NULL, -1);
+}
+
+
 static struct wpa_bss *
 wpa_supplicant_select_bss(struct wpa_supplicant *wpa_s,
 			  struct wpa_ssid *group,
 			  struct wpa_ssid **selected_ssid,
-			  int only_first_ssid)
+			  int only_first_ssid,
+			  const struct wpa_ssid_index *idx)
 {
 	unsigned int i;
+	int idx_group = idx ? wpa_ssid_index_group(idx, group) : -1;
 
 	if (wpa_s->current_ssid) {
 		struct wpa_ssid *ssid;
@@ -1585,8 +1614,9 @@ wpa_supplicant_select_bss(struct wpa_supplicant *wpa_s,
 		for (i = 0; i < wpa_s->last_scan_res_used; i++) {
 			struct wpa_bss *bss = wpa_s->last_scan_res[i];
 
-			ssid = wpa_scan_res_match(wpa_s, i, bss, group,
-						  only_first_ssid, 0);
+			ssid = wpa_scan_res_match_index(wpa_s, i, bss, group,
+							only_first_ssid, 0,
+							idx, idx_group);
 			if (ssid != wpa_s->current_ssid)
 				continue;
 			wpa_dbg(wpa_s, MSG_DEBUG, "%u: " MACSTR
@@ -1607,8 +1637,9 @@ wpa_supplicant_select_bss(struct wpa_supplicant *wpa_s,
 		struct wpa_bss *bss = wpa_s->last_scan_res[i];
 
 		wpa_s->owe_transition_select = 1;
-		*selected_ssid = wpa_scan_res_match(wpa_s, i, bss, group,
-						    only_first_ssid, 1);
+		*selected_ssid = wpa_scan_res_match_index(wpa_s, i, bss, group,
+							  only_first_ssid, 1,
+							  idx, idx_group);
 		wpa_s->owe_transition_select = 0;
 		if (!*selected_ssid)
 			continue;
@@ -1631,11 +1662,21 @@ struct wpa_bss * wpa_supplicant_pick_network(struct wpa_supplicant *wpa_s,
 	size_t prio;
 	struct wpa_ssid *next_ssid = NULL;
 	struct wpa_ssid *ssid;
+	struct wpa_ssid_index *idx;
 
 	if (wpa_s->last_scan_res == NULL ||
 	    wpa_s->last_scan_res_used == 0)
 		return NULL; /* no scan results from last update */
 
+	/*
+	 * Networks can be modified in many places without going through
+	 * wpa_config_update_prio_list(), so the index is built for each
+	 * selection. This is linear in the number of networks while the
+	 * matching below would otherwise be O(BSSes * networks). The full
+	 * list is walked if the index cannot be allocated.
+	 */
+	idx = wpa_ssid_index_build(wpa_s->conf->pssid, wpa_s->conf->num_prio);
+
 	if (wpa_s->next_ssid) {
 		/* check that next_ssid is still valid */
 		for (ssid = wpa_s->conf->ssid; ssid; ssid = ssid->next) {
@@ -1651,13 +1692,14 @@ struct wpa_bss * wpa_supplicant_pick_network(struct wpa_supplicant *wpa_s,
 			if (next_ssid && next_ssid->priority ==
 			    wpa_s->conf->pssid[prio]->priority) {
 				selected = wpa_supplicant_select_bss(
-					wpa_s, next_ssid, selected_ssid, 1);
+					wpa_s, next_ssid, selected_ssid, 1,
+					NULL);
 				if (selected)
 					break;
 			}
 			selected = wpa_supplicant_select_bss(
 				wpa_s, wpa_s->conf->pssid[prio],
-				selected_ssid, 0);
+				selected_ssid, 0, idx);
 			if (selected)
 				break;
 		}
@@ -1672,6 +1714,8 @@ struct wpa_bss * wpa_supplicant_pick_network(struct wpa_supplicant *wpa_s,
 			break;
 	}
 
+	wpa_ssid_index_free(idx);
+
 	ssid = *selected_ssid;
 	if (selected && ssid && ssid->mem_only_psk && !ssid->psk_set &&
 	    !ssid->passphrase && !ssid->ext_psk) {
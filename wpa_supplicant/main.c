@@ -403,6 +403,7 @@ out:
 #endif /* CONFIG_MATCH_IFACE */
 	os_free(params.pid_file);
 
+	wpabuf_pool_flush();
 	os_program_deinit();
 
 	return exitcode;
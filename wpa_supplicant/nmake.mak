@@ -115,6 +115,7 @@ OBJS = \
 	$(OBJDIR)\scan_helpers.obj \
 	$(OBJDIR)\events.obj \
 	$(OBJDIR)\bssid_ignore.obj \
+	$(OBJDIR)\ssid_index.obj \
 	$(OBJDIR)\scan.obj \
 	$(OBJDIR)\wpas_glue.obj \
 	$(OBJDIR)\eap_register.obj \
@@ -1230,7 +1230,7 @@ static int wpas_p2p_store_persistent_group(struct wpa_supplicant *wpa_s,
 	}
 
 	if (changed && wpa_s->conf->update_config &&
-	    wpa_config_write(wpa_s->confname, wpa_s->conf)) {
+	    wpas_save_config(wpa_s)) {
 		wpa_printf(MSG_DEBUG, "P2P: Failed to update configuration");
 	}
 
@@ -1312,7 +1312,7 @@ static void wpas_p2p_add_persistent_group_client(struct wpa_supplicant *wpa_s,
 	}
 
 	if (p2p_wpa_s->conf->update_config &&
-	    wpa_config_write(p2p_wpa_s->confname, p2p_wpa_s->conf))
+	    wpas_save_config(p2p_wpa_s))
 		wpa_printf(MSG_DEBUG, "P2P: Failed to update configuration");
 }
 
@@ -1825,7 +1825,7 @@ static void p2p_config_write(struct wpa_supplicant *wpa_s)
 {
 #ifndef CONFIG_NO_CONFIG_WRITE
 	if (wpa_s->p2pdev->conf->update_config &&
-	    wpa_config_write(wpa_s->p2pdev->confname, wpa_s->p2pdev->conf))
+	    wpas_save_config(wpa_s->p2pdev))
 		wpa_printf(MSG_DEBUG, "P2P: Failed to update configuration");
 #endif /* CONFIG_NO_CONFIG_WRITE */
 }
@@ -3352,7 +3352,7 @@ static void wpas_remove_persistent_peer(struct wpa_supplicant *wpa_s,
 		   (ssid->num_p2p_clients - i - 1) * 2 * ETH_ALEN);
 	ssid->num_p2p_clients--;
 	if (p2p_wpa_s->conf->update_config &&
-	    wpa_config_write(p2p_wpa_s->confname, p2p_wpa_s->conf))
+	    wpas_save_config(p2p_wpa_s))
 		wpa_printf(MSG_DEBUG, "P2P: Failed to update configuration");
 }
 
@@ -8778,7 +8778,7 @@ void wpas_p2p_new_psk_cb(struct wpa_supplicant *wpa_s, const u8 *mac_addr,
 	dl_list_add(&persistent->psk_list, &p->list);
 
 	if (wpa_s->p2pdev->conf->update_config &&
-	    wpa_config_write(wpa_s->p2pdev->confname, wpa_s->p2pdev->conf))
+	    wpas_save_config(wpa_s->p2pdev))
 		wpa_printf(MSG_DEBUG, "P2P: Failed to update configuration");
 }
 
@@ -8791,7 +8791,7 @@ static void wpas_p2p_remove_psk(struct wpa_supplicant *wpa_s,
 
 	res = wpas_p2p_remove_psk_entry(wpa_s, s, addr, iface_addr);
 	if (res > 0 && wpa_s->conf->update_config &&
-	    wpa_config_write(wpa_s->confname, wpa_s->conf))
+	    wpas_save_config(wpa_s))
 		wpa_dbg(wpa_s, MSG_DEBUG,
 			"P2P: Failed to update configuration");
 }
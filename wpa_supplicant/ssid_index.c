@@ -0,0 +1,246 @@
+/*
+ * wpa_supplicant - SSID index for network selection
+ * Copyright (c) 2026, Infineon Technologies AG
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "config_ssid.h"
+#include "ssid_index.h"
+
+
+/*
+ * Network selection goes through the priority groups (config->pssid) and
+ * within each group through the networks in pnext order, picking the first
+ * network that accepts a BSS. A network with an SSID can only accept BSSes
+ * with that SSID, so only the networks without an SSID (wildcard networks,
+ * e.g., WPS or BSSID-only entries) need to be checked for every BSS.
+ *
+ * The index stores the networks with an SSID in a hash table and the wildcard
+ * networks in a separate list, both with the position of the network in the
+ * priority list order. The iterator merges the two in that order, so the
+ * candidates are returned in the same order as the full list would be walked.
+ */
+
+struct wpa_ssid_index_entry {
+	struct wpa_ssid *ssid;
+	unsigned int group;
+	unsigned int pos;
+	int next; /* next entry in the hash bucket or -1 */
+};
+
+struct wpa_ssid_index {
+	int *hash;
+	unsigned int hash_mask;
+	struct wpa_ssid_index_entry *entries;
+	struct wpa_ssid_index_entry *wildcard;
+	unsigned int *wildcard_start; /* per group, num_groups + 1 entries */
+	struct wpa_ssid **groups;
+	unsigned int num_groups;
+};
+
+
+static unsigned int wpa_ssid_index_hash(const u8 *ssid, size_t len)
+{
+	u32 h = 2166136261U;
+	size_t i;
+
+	/* FNV-1a */
+	for (i = 0; i < len; i++) {
+		h ^= ssid[i];
+		h *= 16777619U;
+	}
+
+	return h;
+}
+
+
+void wpa_ssid_index_free(struct wpa_ssid_index *idx)
+{
+	if (!idx)
+		return;
+	os_free(idx->hash);
+	os_free(idx->entries);
+	os_free(idx->wildcard);
+	os_free(idx->wildcard_start);
+	os_free(idx->groups);
+	os_free(idx);
+}
+
+
+/**
+ * wpa_ssid_index_build - Build SSID index for network selection
+ * @pssid: Per-priority network lists (struct wpa_config::pssid)
+ * @num_prio: Number of entries in @pssid
+ * Returns: Index or %NULL on failure
+ *
+ * The index refers to the networks of @pssid, so it must not be used after
+ * the networks or their SSIDs have been modified.
+ */
+struct wpa_ssid_index * wpa_ssid_index_build(struct wpa_ssid **pssid,
+					     size_t num_prio)
+{
+	struct wpa_ssid_index *idx;
+	struct wpa_ssid_index_entry *e;
+	struct wpa_ssid *ssid;
+	unsigned int num = 0, num_wildcard = 0, size = 16, pos = 0, g, bucket;
+	unsigned int w = 0;
+
+	for (g = 0; g < num_prio; g++) {
+		for (ssid = pssid[g]; ssid; ssid = ssid->pnext) {
+			if (ssid->ssid_len)
+				num++;
+			else
+				num_wildcard++;
+		}
+	}
+
+	idx = os_zalloc(sizeof(*idx));
+	if (!idx)
+		return NULL;
+	while (size < num)
+		size <<= 1;
+	idx->hash_mask = size - 1;
+	idx->num_groups = num_prio;
+	idx->hash = os_malloc(size * sizeof(int));
+	idx->entries = os_calloc(num + 1, sizeof(*idx->entries));
+	idx->wildcard = os_calloc(num_wildcard + 1, sizeof(*idx->wildcard));
+	idx->wildcard_start = os_calloc(num_prio + 1, sizeof(unsigned int));
+	idx->groups = os_calloc(num_prio + 1, sizeof(struct wpa_ssid *));
+	if (!idx->hash || !idx->entries || !idx->wildcard ||
+	    !idx->wildcard_start || !idx->groups) {
+		wpa_ssid_index_free(idx);
+		return NULL;
+	}
+	os_memset(idx->hash, 0xff, size * sizeof(int));
+
+	num = 0;
+	for (g = 0; g < num_prio; g++) {
+		idx->groups[g] = pssid[g];
+		idx->wildcard_start[g] = w;
+		for (ssid = pssid[g]; ssid; ssid = ssid->pnext, pos++) {
+			if (!ssid->ssid_len) {
+				e = &idx->wildcard[w++];
+				e->ssid = ssid;
+				e->group = g;
+				e->pos = pos;
+				continue;
+			}
+			e = &idx->entries[num];
+			e->ssid = ssid;
+			e->group = g;
+			e->pos = pos;
+			e->next = -1;
+			num++;
+		}
+	}
+	idx->wildcard_start[num_prio] = w;
+
+	/* Add in reverse order to keep the bucket lists in position order */
+	while (num--) {
+		e = &idx->entries[num];
+		bucket = wpa_ssid_index_hash(e->ssid->ssid, e->ssid->ssid_len) &
+			idx->hash_mask;
+		e->next = idx->hash[bucket];
+		idx->hash[bucket] = num;
+	}
+
+	return idx;
+}
+
+
+/**
+ * wpa_ssid_index_group - Find the index of a priority group
+ * @idx: SSID index from wpa_ssid_index_build()
+ * @group: First network of the priority group
+ * Returns: Group index or -1 if @group is not the head of an indexed group
+ */
+int wpa_ssid_index_group(const struct wpa_ssid_index *idx,
+			 const struct wpa_ssid *group)
+{
+	unsigned int g;
+
+	for (g = 0; g < idx->num_groups; g++) {
+		if (idx->groups[g] == group)
+			return g;
+	}
+
+	return -1;
+}
+
+
+static int wpa_ssid_index_next_exact(const struct wpa_ssid_index_iter *iter,
+				     int i)
+{
+	const struct wpa_ssid_index_entry *e;
+
+	while (i >= 0) {
+		e = &iter->idx->entries[i];
+		if (e->group == iter->group &&
+		    e->ssid->ssid_len == iter->ssid_len &&
+		    os_memcmp(e->ssid->ssid, iter->ssid, iter->ssid_len) == 0)
+			break;
+		i = e->next;
+	}
+
+	return i;
+}
+
+
+/**
+ * wpa_ssid_index_iter_init - Start iterating candidate networks for a BSS
+ * @iter: Iterator to initialize
+ * @idx: SSID index from wpa_ssid_index_build()
+ * @group: Group index from wpa_ssid_index_group()
+ * @ssid: SSID of the BSS
+ * @ssid_len: Length of the SSID
+ *
+ * The candidates are the networks of the group that have the same SSID and
+ * the networks of the group that do not have an SSID.
+ */
+void wpa_ssid_index_iter_init(struct wpa_ssid_index_iter *iter,
+			      const struct wpa_ssid_index *idx,
+			      unsigned int group, const u8 *ssid,
+			      size_t ssid_len)
+{
+	unsigned int bucket;
+
+	iter->idx = idx;
+	iter->ssid = ssid;
+	iter->ssid_len = ssid_len;
+	iter->group = group;
+	bucket = wpa_ssid_index_hash(ssid, ssid_len) & idx->hash_mask;
+	iter->exact = wpa_ssid_index_next_exact(iter, idx->hash[bucket]);
+	iter->wildcard = idx->wildcard_start[group];
+	iter->wildcard_end = idx->wildcard_start[group + 1];
+}
+
+
+/**
+ * wpa_ssid_index_iter_next - Get the next candidate network
+ * @iter: Iterator from wpa_ssid_index_iter_init()
+ * Returns: Next candidate network in priority list order or %NULL if none
+ */
+struct wpa_ssid * wpa_ssid_index_iter_next(struct wpa_ssid_index_iter *iter)
+{
+	const struct wpa_ssid_index *idx = iter->idx;
+	const struct wpa_ssid_index_entry *e;
+
+	if (iter->exact >= 0 &&
+	    (iter->wildcard == iter->wildcard_end ||
+	     idx->entries[iter->exact].pos <
+	     idx->wildcard[iter->wildcard].pos)) {
+		e = &idx->entries[iter->exact];
+		iter->exact = wpa_ssid_index_next_exact(iter, e->next);
+		return e->ssid;
+	}
+
+	if (iter->wildcard < iter->wildcard_end)
+		return idx->wildcard[iter->wildcard++].ssid;
+
+	return NULL;
+}
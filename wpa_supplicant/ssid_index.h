@@ -0,0 +1,42 @@
+/*
+ * wpa_supplicant - SSID index for network selection
+ * Copyright (c) 2026, Infineon Technologies AG
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#ifndef SSID_INDEX_H
+#define SSID_INDEX_H
+
+struct wpa_ssid;
+struct wpa_ssid_index;
+
+/**
+ * struct wpa_ssid_index_iter - Candidate network iterator
+ *
+ * This is initialized with wpa_ssid_index_iter_init() and the fields are
+ * internal to ssid_index.c.
+ */
+struct wpa_ssid_index_iter {
+	const struct wpa_ssid_index *idx;
+	const u8 *ssid;
+	size_t ssid_len;
+	unsigned int group;
+	int exact;
+	unsigned int wildcard;
+	unsigned int wildcard_end;
+};
+
+struct wpa_ssid_index * wpa_ssid_index_build(struct wpa_ssid **pssid,
+					     size_t num_prio);
+void wpa_ssid_index_free(struct wpa_ssid_index *idx);
+int wpa_ssid_index_group(const struct wpa_ssid_index *idx,
+			 const struct wpa_ssid *group);
+void wpa_ssid_index_iter_init(struct wpa_ssid_index_iter *iter,
+			      const struct wpa_ssid_index *idx,
+			      unsigned int group, const u8 *ssid,
+			      size_t ssid_len);
+struct wpa_ssid * wpa_ssid_index_iter_next(struct wpa_ssid_index_iter *iter);
+
+#endif /* SSID_INDEX_H */
@@ -1342,6 +1342,169 @@ static int wpa_cli_cmd_add_network(struct wpa_ctrl *ctrl, int argc,
 }
 
 
+static int wpa_cli_add_networks_request(struct wpa_ctrl *ctrl,
+					const char *cmd, size_t cmd_len,
+					char *reply, size_t *reply_len)
+{
+	int ret;
+
+	ret = wpa_ctrl_request(ctrl, cmd, cmd_len, reply, reply_len,
+			       wpa_cli_msg_cb);
+	if (ret == -2) {
+		printf("'ADD_NETWORKS' command timed out.\n");
+		return -2;
+	} else if (ret < 0) {
+		printf("'ADD_NETWORKS' command failed.\n");
+		return -1;
+	}
+	reply[*reply_len] = '\0';
+	return 0;
+}
+
+
+static void wpa_cli_add_networks_rollback(struct wpa_ctrl *ctrl,
+					  const char *prefix,
+					  const char *ids)
+{
+	char cmd[100], reply[100];
+	size_t len;
+
+	while (*ids) {
+		os_snprintf(cmd, sizeof(cmd), "%sREMOVE_NETWORK %d", prefix,
+			    atoi(ids));
+		len = sizeof(reply) - 1;
+		wpa_ctrl_request(ctrl, cmd, os_strlen(cmd), reply, &len, NULL);
+		ids = os_strchr(ids, '\n');
+		if (!ids)
+			break;
+		ids++;
+	}
+}
+
+
+/*
+ * The ctrl_iface drops commands that are longer than the receive buffer of
+ * wpa_supplicant without a reply, so a large file is split at the network
+ * blocks into several ADD_NETWORKS commands. If one of the commands fails,
+ * the networks added by the earlier ones are removed.
+ */
+static int wpa_cli_cmd_add_networks(struct wpa_ctrl *ctrl, int argc,
+				    char *argv[])
+{
+	char prefix[100], reply[4096], *data, *cmd = NULL, *pos, *line;
+	char *block_end, *ids = NULL, *nids;
+	size_t len, max_len, hdr_len, cmd_len, reply_len, ids_len = 0;
+	int res = -1;
+
+	if (argc != 1) {
+		printf("Invalid ADD_NETWORKS command: needs one argument "
+		       "(file with network blocks)\n");
+		return -1;
+	}
+
+	if (!ctrl_conn) {
+		printf("Not connected to wpa_supplicant - command dropped.\n");
+		return -1;
+	}
+
+	data = os_readfile(argv[0], &len);
+	if (!data) {
+		printf("Could not read '%s'\n", argv[0]);
+		return -1;
+	}
+
+	if (ifname_prefix)
+		os_snprintf(prefix, sizeof(prefix), "IFNAME=%s ",
+			    ifname_prefix);
+	else
+		prefix[0] = '\0';
+
+	/* Older versions do not report the limit, but accept 4096 octets */
+	os_snprintf(reply, sizeof(reply), "%sGET max_command_len", prefix);
+	reply_len = sizeof(reply) - 1;
+	max_len = 4096;
+	if (wpa_ctrl_request(ctrl, reply, os_strlen(reply), reply,
+			     &reply_len, NULL) == 0) {
+		reply[reply_len] = '\0';
+		if (atoi(reply) > 0)
+			max_len = atoi(reply);
+	}
+
+	cmd = os_malloc(max_len + 1);
+	if (!cmd)
+		goto out;
+	hdr_len = os_snprintf(cmd, max_len + 1, "%sADD_NETWORKS\n", prefix);
+
+	pos = data;
+	do {
+		/* Collect whole network blocks that fit in one command */
+		block_end = pos;
+		for (line = pos; line < data + len; ) {
+			char *next = line, *tmp = line;
+
+			while (next < data + len && *next++ != '\n')
+				;
+			while (tmp < next && (*tmp == ' ' || *tmp == '\t'))
+				tmp++;
+			if (line > pos && next - tmp >= 9 &&
+			    os_memcmp(tmp, "network={", 9) == 0) {
+				if ((size_t) (line - pos) + hdr_len > max_len)
+					break;
+				block_end = line;
+			}
+			line = next;
+		}
+		if (line >= data + len &&
+		    (size_t) (data + len - pos) + hdr_len <= max_len)
+			block_end = data + len;
+		if (block_end == pos && pos < data + len) {
+			printf("ADD_NETWORKS: a network block in '%s' is longer "
+			       "than the %u octet command limit\n", argv[0],
+			       (unsigned int) max_len);
+			goto rollback;
+		}
+
+		cmd_len = hdr_len + (block_end - pos);
+		os_memcpy(cmd + hdr_len, pos, block_end - pos);
+		cmd[cmd_len] = '\0';
+		pos = block_end;
+
+		reply_len = sizeof(reply) - 1;
+		if (wpa_cli_add_networks_request(ctrl, cmd, cmd_len, reply,
+						 &reply_len) < 0)
+			goto rollback;
+		if (os_strncmp(reply, "FAIL", 4) == 0 ||
+		    os_strncmp(reply, "UNKNOWN COMMAND", 15) == 0) {
+			printf("%s", reply);
+			goto rollback;
+		}
+
+		nids = os_realloc(ids, ids_len + reply_len + 1);
+		if (!nids)
+			goto rollback;
+		ids = nids;
+		os_memcpy(ids + ids_len, reply, reply_len + 1);
+		ids_len += reply_len;
+	} while (pos < data + len);
+
+	if (ids)
+		printf("%s", ids);
+	res = 0;
+	goto out;
+
+rollback:
+	if (ids)
+		wpa_cli_add_networks_rollback(ctrl, prefix, ids);
+out:
+	os_free(ids);
+	bin_clear_free(cmd, max_len + 1);
+	bin_clear_free(data, len);
+	if (interactive)
+		update_networks(ctrl);
+	return res;
+}
+
+
 static int wpa_cli_cmd_remove_network(struct wpa_ctrl *ctrl, int argc,
 				      char *argv[])
 {
@@ -3433,6 +3596,9 @@ static const struct wpa_cli_cmd wpa_cli_commands[] = {
 	{ "add_network", wpa_cli_cmd_add_network, NULL,
 	  cli_cmd_flag_none,
 	  "= add a network" },
+	{ "add_networks", wpa_cli_cmd_add_networks, NULL,
+	  cli_cmd_flag_sensitive,
+	  "<file> = add the network blocks in a file" },
 	{ "remove_network", wpa_cli_cmd_remove_network,
 	  wpa_cli_complete_network_id,
 	  cli_cmd_flag_none,
@@ -556,6 +556,8 @@ static void wpa_supplicant_cleanup(struct wpa_supplicant *wpa_s)
 		struct wpa_ssid *ssid;
 		for (ssid = wpa_s->conf->ssid; ssid; ssid = ssid->next)
 			wpas_notify_network_removed(wpa_s, ssid);
+		/* Complete a delayed write while the file name is known */
+		wpas_save_config_flush(wpa_s);
 	}
 
 	os_free(wpa_s->confname);
@@ -1132,6 +1134,70 @@ void wpa_supplicant_clear_status(struct wpa_supplicant *wpa_s)
 }
 
 
+static void wpas_save_config_timeout(void *eloop_ctx, void *timeout_ctx)
+{
+	struct wpa_supplicant *wpa_s = eloop_ctx;
+
+	if (wpa_config_write(wpa_s->confname, wpa_s->conf))
+		wpa_printf(MSG_DEBUG, "Failed to update configuration");
+}
+
+
+/**
+ * wpas_save_config - Write configuration after an internal change
+ * @wpa_s: Pointer to wpa_supplicant data
+ * Returns: 0 on success or when the write was scheduled, -1 on failure
+ *
+ * The configuration is written immediately unless update_config_delay is set,
+ * in which case the write is scheduled to happen once the delay has passed.
+ * Further calls before that are covered by the same write.
+ */
+int wpas_save_config(struct wpa_supplicant *wpa_s)
+{
+	int delay = wpa_s->conf->update_config_delay;
+
+	if (!delay) {
+		eloop_cancel_timeout(wpas_save_config_timeout, wpa_s, NULL);
+		return wpa_config_write(wpa_s->confname, wpa_s->conf);
+	}
+
+	if (!eloop_is_timeout_registered(wpas_save_config_timeout, wpa_s,
+					 NULL)) {
+		wpa_printf(MSG_DEBUG,
+			   "Configuration update scheduled in %d ms", delay);
+		eloop_register_timeout(delay / 1000, (delay % 1000) * 1000,
+				       wpas_save_config_timeout, wpa_s, NULL);
+	}
+
+	return 0;
+}
+
+
+/**
+ * wpas_save_config_now - Write configuration immediately
+ * @wpa_s: Pointer to wpa_supplicant data
+ * Returns: 0 on success, -1 on failure
+ *
+ * This cancels any pending delayed write since it is covered by this write.
+ */
+int wpas_save_config_now(struct wpa_supplicant *wpa_s)
+{
+	eloop_cancel_timeout(wpas_save_config_timeout, wpa_s, NULL);
+	return wpa_config_write(wpa_s->confname, wpa_s->conf);
+}
+
+
+/**
+ * wpas_save_config_flush - Complete a pending delayed configuration write
+ * @wpa_s: Pointer to wpa_supplicant data
+ */
+void wpas_save_config_flush(struct wpa_supplicant *wpa_s)
+{
+	if (eloop_cancel_timeout(wpas_save_config_timeout, wpa_s, NULL) > 0)
+		wpas_save_config_timeout(wpa_s, NULL);
+}
+
+
 /**
  * wpa_supplicant_reload_configuration - Reload configuration data
  * @wpa_s: Pointer to wpa_supplicant data
@@ -1151,6 +1217,7 @@ int wpa_supplicant_reload_configuration(struct wpa_supplicant *wpa_s)
 
 	if (wpa_s->confname == NULL)
 		return -1;
+	wpas_save_config_flush(wpa_s);
 	conf = wpa_config_read(wpa_s->confname, NULL);
 	if (conf == NULL) {
 		wpa_msg(wpa_s, MSG_ERROR, "Failed to parse the configuration "
@@ -7009,6 +7076,7 @@ static void wpa_supplicant_deinit_iface(struct wpa_supplicant *wpa_s,
 #endif /* CONFIG_MESH */
 
 	if (wpa_s->conf != NULL) {
+		wpas_save_config_flush(wpa_s);
 		wpa_config_free(wpa_s->conf);
 		wpa_s->conf = NULL;
 	}
@@ -1540,6 +1540,9 @@ int wpa_supplicant_set_wpa_none_key(struct wpa_supplicant *wpa_s,
 				    struct wpa_ssid *ssid);
 
 int wpa_supplicant_reload_configuration(struct wpa_supplicant *wpa_s);
+int wpas_save_config(struct wpa_supplicant *wpa_s);
+int wpas_save_config_now(struct wpa_supplicant *wpa_s);
+void wpas_save_config_flush(struct wpa_supplicant *wpa_s);
 
 const char * wpa_supplicant_state_txt(enum wpa_states state);
 int wpa_supplicant_update_mac_addr(struct wpa_supplicant *wpa_s);
@@ -40,7 +40,7 @@ static void wpa_supplicant_set_config_blob(void *ctx,
 	struct wpa_supplicant *wpa_s = ctx;
 	wpa_config_set_blob(wpa_s->conf, blob);
 	if (wpa_s->conf->update_config) {
-		int ret = wpa_config_write(wpa_s->confname, wpa_s->conf);
+		int ret = wpas_save_config(wpa_s);
 		if (ret) {
 			wpa_printf(MSG_DEBUG, "Failed to update config after "
 				   "blob set");
@@ -1157,7 +1157,7 @@ static void wpa_supplicant_set_anon_id(void *ctx, const u8 *id, size_t len)
 	}
 
 	if (wpa_s->conf->update_config) {
-		res = wpa_config_write(wpa_s->confname, wpa_s->conf);
+		res = wpas_save_config(wpa_s);
 		if (res) {
 			wpa_printf(MSG_DEBUG, "Failed to update config after "
 				   "anonymous_id update");
@@ -1358,7 +1358,7 @@ static void wpa_supplicant_transition_disable(void *_wpa_s, u8 bitmap)
 
 #ifndef CONFIG_NO_CONFIG_WRITE
 	if (wpa_s->conf->update_config &&
-	    wpa_config_write(wpa_s->confname, wpa_s->conf))
+	    wpas_save_config(wpa_s))
 		wpa_printf(MSG_DEBUG, "Failed to update configuration");
 #endif /* CONFIG_NO_CONFIG_WRITE */
 }
@@ -583,7 +583,7 @@ static int wpa_supplicant_wps_cred(void *ctx,
 
 #ifndef CONFIG_NO_CONFIG_WRITE
 	if (wpa_s->conf->update_config &&
-	    wpa_config_write(wpa_s->confname, wpa_s->conf)) {
+	    wpas_save_config(wpa_s)) {
 		wpa_printf(MSG_DEBUG, "WPS: Failed to update configuration");
 		return -1;
 	}
@@ -694,7 +694,7 @@ static void wpas_wps_reenable_networks(struct wpa_supplicant *wpa_s)
 	if (changed) {
 #ifndef CONFIG_NO_CONFIG_WRITE
 		if (wpa_s->conf->update_config &&
-		    wpa_config_write(wpa_s->confname, wpa_s->conf)) {
+		    wpas_save_config(wpa_s)) {
 			wpa_printf(MSG_DEBUG, "WPS: Failed to update "
 				   "configuration");
 		}